@@ -98,6 +98,8 @@ Bool TAppDecCfg::parseCfg( Int argc, TChar* argv[] )
 #endif
   ("OutputDecodedSEIMessagesFilename",  m_outputDecodedSEIMessagesFilename,    string(""), "When non empty, output decoded SEI messages to the indicated file. If file is '-', then output to stdout\n")
   ("ClipOutputVideoToRec709Range",      m_bClipOutputVideoToRec709Range,  false, "If true then clip output video to the Rec. 709 Range on saving")
+  ("CtuThreads",                m_numCtuThreads,                       1,          "Number of threads decoding the CTU rows of WPP slices or the tiles of a slice in parallel (1: single thread)")
+  ("PipelineDepth",             m_pipelineDepth,                       0,          "Number of pictures that are filtered and written on separate threads while the next pictures are decoded (0: no pipelining)")
 #if MCTS_ENC_CHECK
   ("TMCTSCheck",                  m_tmctsCheck,                          false,    "If enabled, the decoder checks for violations of mc_exact_sample_value_match_flag in Temporal MCTS ")
 #endif
@@ -140,6 +142,18 @@ Bool TAppDecCfg::parseCfg( Int argc, TChar* argv[] )
     return false;
   }
 
+  if (m_numCtuThreads < 1)
+  {
+    fprintf(stderr, "CtuThreads must be at least 1, aborting\n");
+    return false;
+  }
+
+  if (m_pipelineDepth < 0)
+  {
+    fprintf(stderr, "PipelineDepth must not be negative, aborting\n");
+    return false;
+  }
+
   if ( !cfg_TargetDecLayerIdSetFile.empty() )
   {
     FILE* targetDecLayerIdSetFile = fopen ( cfg_TargetDecLayerIdSetFile.c_str(), "r" );
@@ -80,6 +80,8 @@ protected:
 #endif
   std::string   m_outputDecodedSEIMessagesFilename;   ///< filename to output decoded SEI messages to. If '-', then use stdout. If empty, do not output details.
   Bool          m_bClipOutputVideoToRec709Range;      ///< If true, clip the output video to the Rec 709 range on saving.
+  Int           m_numCtuThreads;                      ///< number of threads decoding the CTU rows or tiles of a slice segment in parallel
+  Int           m_pipelineDepth;                      ///< number of pictures in the in-loop filtering and in the output stages of the pipelined decoder (0: no pipelining)
 #if MCTS_ENC_CHECK
   Bool          m_tmctsCheck;
 #endif
@@ -109,6 +111,8 @@ public:
 #endif
   , m_outputDecodedSEIMessagesFilename()
   , m_bClipOutputVideoToRec709Range(false)
+  , m_numCtuThreads(1)
+  , m_pipelineDepth(0)
 #if MCTS_ENC_CHECK
   , m_tmctsCheck(false)
 #endif
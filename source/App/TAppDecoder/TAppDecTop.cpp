@@ -58,6 +58,7 @@
 TAppDecTop::TAppDecTop()
 : m_iPOCLastDisplay(-MAX_INT)
  ,m_pcSeiColourRemappingInfoPrevious(NULL)
+ ,m_bOutputThreadStop(false)
 {
 }
 
@@ -372,6 +373,8 @@ Void TAppDecTop::xCreateDecLib()
 
 Void TAppDecTop::xDestroyDecLib()
 {
+  xStopOutputThread();
+
   if ( !m_reconFileName.empty() )
   {
     m_cTVideoIOYuvReconFile.close();
@@ -404,6 +407,8 @@ Void TAppDecTop::xDestroyDecLib()
 Void TAppDecTop::xInitDecLib()
 {
   // initialize decoder class
+  m_cTDecTop.setNumCtuThreads(m_numCtuThreads);
+  m_cTDecTop.setPipelineDepth(m_pipelineDepth);
   m_cTDecTop.init();
   m_cTDecTop.setDecodedPictureHashSEIEnabled(m_decodedPictureHashSEIEnabled);
 #if MCTS_ENC_CHECK
@@ -498,10 +503,6 @@ Void TAppDecTop::xWriteOutput( TComList<TComPic*>* pcListPic, UInt tId )
         numPicsNotYetDisplayed = numPicsNotYetDisplayed-2;
         if ( !m_reconFileName.empty() )
         {
-          const Window &conf = pcPicTop->getConformanceWindow();
-          const Window  defDisp = m_respectDefDispWindow ? pcPicTop->getDefDisplayWindow() : Window();
-          const Bool isTff = pcPicTop->isTopField();
-
           Bool display = true;
           if( m_decodedNoDisplaySEIEnabled )
           {
@@ -515,12 +516,7 @@ Void TAppDecTop::xWriteOutput( TComList<TComPic*>* pcListPic, UInt tId )
 
           if (display)
           {
-            m_cTVideoIOYuvReconFile.write( pcPicTop->getPicYuvRec(), pcPicBottom->getPicYuvRec(),
-                                           m_outputColourSpaceConvert,
-                                           conf.getWindowLeftOffset() + defDisp.getWindowLeftOffset(),
-                                           conf.getWindowRightOffset() + defDisp.getWindowRightOffset(),
-                                           conf.getWindowTopOffset() + defDisp.getWindowTopOffset(),
-                                           conf.getWindowBottomOffset() + defDisp.getWindowBottomOffset(), NUM_CHROMA_FORMAT, isTff );
+            xWriteReconPic( pcPicTop, pcPicBottom );
           }
         }
 
@@ -567,22 +563,14 @@ Void TAppDecTop::xWriteOutput( TComList<TComPic*>* pcListPic, UInt tId )
 
         if ( !m_reconFileName.empty() )
         {
-          const Window &conf    = pcPic->getConformanceWindow();
-          const Window  defDisp = m_respectDefDispWindow ? pcPic->getDefDisplayWindow() : Window();
-
-          m_cTVideoIOYuvReconFile.write( pcPic->getPicYuvRec(),
-                                         m_outputColourSpaceConvert,
-                                         conf.getWindowLeftOffset() + defDisp.getWindowLeftOffset(),
-                                         conf.getWindowRightOffset() + defDisp.getWindowRightOffset(),
-                                         conf.getWindowTopOffset() + defDisp.getWindowTopOffset(),
-                                         conf.getWindowBottomOffset() + defDisp.getWindowBottomOffset(),
-                                         NUM_CHROMA_FORMAT, m_bClipOutputVideoToRec709Range  );
+          xWriteReconPic( pcPic, NULL );
         }
 
 #if JVET_X0048_X0103_FILM_GRAIN
         // Perform FGS on decoded frame and write to output FGS file
         if (!m_SEIFGSFileName.empty())
         {
+          pcPic->waitForFinishedCtuRows( pcPic->getFrameHeightInCtus() );
           const Window &conf = pcPic->getConformanceWindow();
           const Window  defDisp = m_respectDefDispWindow ? pcPic->getDefDisplayWindow() : Window();
           m_cTVideoIOYuvSEIFGSFile.write(pcPic->getPicYuvDisp(),
@@ -670,15 +658,7 @@ Void TAppDecTop::xFlushOutput( TComList<TComPic*>* pcListPic )
         // write to file
         if ( !m_reconFileName.empty() )
         {
-          const Window &conf = pcPicTop->getConformanceWindow();
-          const Window  defDisp = m_respectDefDispWindow ? pcPicTop->getDefDisplayWindow() : Window();
-          const Bool isTff = pcPicTop->isTopField();
-          m_cTVideoIOYuvReconFile.write( pcPicTop->getPicYuvRec(), pcPicBottom->getPicYuvRec(),
-                                         m_outputColourSpaceConvert,
-                                         conf.getWindowLeftOffset() + defDisp.getWindowLeftOffset(),
-                                         conf.getWindowRightOffset() + defDisp.getWindowRightOffset(),
-                                         conf.getWindowTopOffset() + defDisp.getWindowTopOffset(),
-                                         conf.getWindowBottomOffset() + defDisp.getWindowBottomOffset(), NUM_CHROMA_FORMAT, isTff );
+          xWriteReconPic( pcPicTop, pcPicBottom );
         }
 
         // update POC of display order
@@ -704,6 +684,7 @@ Void TAppDecTop::xFlushOutput( TComList<TComPic*>* pcListPic )
 
         if(pcPicTop)
         {
+          pcPicTop->waitForPipeline();
           pcPicTop->destroy();
           delete pcPicTop;
           pcPicTop = NULL;
@@ -712,6 +693,7 @@ Void TAppDecTop::xFlushOutput( TComList<TComPic*>* pcListPic )
     }
     if(pcPicBottom)
     {
+      pcPicBottom->waitForPipeline();
       pcPicBottom->destroy();
       delete pcPicBottom;
       pcPicBottom = NULL;
@@ -728,22 +710,14 @@ Void TAppDecTop::xFlushOutput( TComList<TComPic*>* pcListPic )
         // write to file
         if ( !m_reconFileName.empty() )
         {
-          const Window &conf    = pcPic->getConformanceWindow();
-          const Window  defDisp = m_respectDefDispWindow ? pcPic->getDefDisplayWindow() : Window();
-
-          m_cTVideoIOYuvReconFile.write( pcPic->getPicYuvRec(),
-                                         m_outputColourSpaceConvert,
-                                         conf.getWindowLeftOffset() + defDisp.getWindowLeftOffset(),
-                                         conf.getWindowRightOffset() + defDisp.getWindowRightOffset(),
-                                         conf.getWindowTopOffset() + defDisp.getWindowTopOffset(),
-                                         conf.getWindowBottomOffset() + defDisp.getWindowBottomOffset(),
-                                         NUM_CHROMA_FORMAT, m_bClipOutputVideoToRec709Range );
+          xWriteReconPic( pcPic, NULL );
         }
 
 #if JVET_X0048_X0103_FILM_GRAIN
         // Perform FGS on decoded frame and write to output FGS file
         if (!m_SEIFGSFileName.empty())
         {
+          pcPic->waitForFinishedCtuRows( pcPic->getFrameHeightInCtus() );
           const Window &conf = pcPic->getConformanceWindow();
           const Window  defDisp = m_respectDefDispWindow ? pcPic->getDefDisplayWindow() : Window();
           m_cTVideoIOYuvSEIFGSFile.write(pcPic->getPicYuvDisp(),
@@ -802,6 +776,7 @@ Void TAppDecTop::xFlushOutput( TComList<TComPic*>* pcListPic )
       if(pcPic != NULL)
 #endif
       {
+        pcPic->waitForPipeline();
         pcPic->destroy();
         delete pcPic;
         pcPic = NULL;
@@ -817,6 +792,7 @@ Void TAppDecTop::xFlushOutput( TComList<TComPic*>* pcListPic )
         pcPic = *(iterPic);
         if (pcPic != NULL)
         {
+          pcPic->waitForPipeline();
           pcPic->destroy();
           delete pcPic;
           pcPic = NULL;
@@ -830,6 +806,115 @@ Void TAppDecTop::xFlushOutput( TComList<TComPic*>* pcListPic )
   m_iPOCLastDisplay = -MAX_INT;
 }
 
+/** Write a frame or a field pair to the reconstruction file.
+ * When the decoder is pipelined, the pictures are queued for the output thread, which writes them once they are completely filtered.
+ * \param pcPic       frame or top field
+ * \param pcPicBottom bottom field, NULL for a frame
+ */
+Void TAppDecTop::xWriteReconPic( TComPic* pcPic, TComPic* pcPicBottom )
+{
+  if ( m_pipelineDepth == 0 )
+  {
+    xWriteReconFile( pcPic, pcPicBottom );
+    return;
+  }
+
+  pcPic->setOutputPending( true );
+  if ( pcPicBottom )
+  {
+    pcPicBottom->setOutputPending( true );
+  }
+  {
+    std::unique_lock<std::mutex> lock( m_outputQueueMutex );
+    m_outputQueueCond.wait( lock, [&]{ return (Int)m_outputQueue.size() < m_pipelineDepth; } );
+    m_outputQueue.push_back( std::make_pair( pcPic, pcPicBottom ) );
+  }
+  m_outputQueueCond.notify_all();
+
+  if ( !m_outputThread.joinable() )
+  {
+    m_outputThread = std::thread( &TAppDecTop::xWritePictures, this );
+  }
+}
+
+Void TAppDecTop::xWriteReconFile( TComPic* pcPic, TComPic* pcPicBottom )
+{
+  const Window &conf    = pcPic->getConformanceWindow();
+  const Window  defDisp = m_respectDefDispWindow ? pcPic->getDefDisplayWindow() : Window();
+
+  if ( pcPicBottom )
+  {
+    const Bool isTff = pcPic->isTopField();
+    m_cTVideoIOYuvReconFile.write( pcPic->getPicYuvRec(), pcPicBottom->getPicYuvRec(),
+                                   m_outputColourSpaceConvert,
+                                   conf.getWindowLeftOffset() + defDisp.getWindowLeftOffset(),
+                                   conf.getWindowRightOffset() + defDisp.getWindowRightOffset(),
+                                   conf.getWindowTopOffset() + defDisp.getWindowTopOffset(),
+                                   conf.getWindowBottomOffset() + defDisp.getWindowBottomOffset(), NUM_CHROMA_FORMAT, isTff );
+  }
+  else
+  {
+    m_cTVideoIOYuvReconFile.write( pcPic->getPicYuvRec(),
+                                   m_outputColourSpaceConvert,
+                                   conf.getWindowLeftOffset() + defDisp.getWindowLeftOffset(),
+                                   conf.getWindowRightOffset() + defDisp.getWindowRightOffset(),
+                                   conf.getWindowTopOffset() + defDisp.getWindowTopOffset(),
+                                   conf.getWindowBottomOffset() + defDisp.getWindowBottomOffset(),
+                                   NUM_CHROMA_FORMAT, m_bClipOutputVideoToRec709Range );
+  }
+}
+
+/** Output thread of the pipelined decoder: writes the queued pictures in output order.
+ */
+Void TAppDecTop::xWritePictures()
+{
+  while ( true )
+  {
+    std::pair<TComPic*, TComPic*> job;
+    {
+      std::unique_lock<std::mutex> lock( m_outputQueueMutex );
+      m_outputQueueCond.wait( lock, [&]{ return !m_outputQueue.empty() || m_bOutputThreadStop; } );
+      if ( m_outputQueue.empty() )
+      {
+        return;
+      }
+      job = m_outputQueue.front();
+    }
+
+    job.first->waitForFinishedCtuRows( job.first->getFrameHeightInCtus() );
+    if ( job.second )
+    {
+      job.second->waitForFinishedCtuRows( job.second->getFrameHeightInCtus() );
+    }
+    xWriteReconFile( job.first, job.second );
+    job.first->setOutputPending( false );
+    if ( job.second )
+    {
+      job.second->setOutputPending( false );
+    }
+
+    {
+      std::lock_guard<std::mutex> lock( m_outputQueueMutex );
+      m_outputQueue.pop_front();
+    }
+    m_outputQueueCond.notify_all();
+  }
+}
+
+Void TAppDecTop::xStopOutputThread()
+{
+  if ( m_outputThread.joinable() )
+  {
+    {
+      std::lock_guard<std::mutex> lock( m_outputQueueMutex );
+      m_bOutputThreadStop = true;
+    }
+    m_outputQueueCond.notify_all();
+    m_outputThread.join();
+    m_bOutputThreadStop = false;
+  }
+}
+
 /** \param nalu Input nalu to check whether its LayerId is within targetDecLayerIdSet
  */
 Bool TAppDecTop::isNaluWithinTargetDecLayerIdSet( InputNALUnit* nalu )
@@ -850,6 +935,7 @@ Bool TAppDecTop::isNaluWithinTargetDecLayerIdSet( InputNALUnit* nalu )
 
 Void TAppDecTop::xOutputColourRemapPic(TComPic* pcPic)
 {
+  pcPic->waitForFinishedCtuRows( pcPic->getFrameHeightInCtus() );
   const TComSPS &sps=pcPic->getPicSym()->getSPS();
   SEIMessages colourRemappingInfo = getSeisByType(pcPic->getSEIs(), SEI::COLOUR_REMAPPING_INFO );
   SEIColourRemappingInfo *seiColourRemappingInfo = ( colourRemappingInfo.size() > 0 ) ? (SEIColourRemappingInfo*) *(colourRemappingInfo.begin()) : NULL;
@@ -42,6 +42,11 @@
 #pragma once
 #endif // _MSC_VER > 1000
 
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+
 #include "Utilities/TVideoIOYuv.h"
 #include "TLibCommon/TComList.h"
 #include "TLibCommon/TComPicYuv.h"
@@ -80,6 +85,13 @@ private:
   std::map<UInt, SEIAnnotatedRegions::AnnotatedRegionObject> m_arObjects;
   std::map<UInt, std::string>                                m_arLabels;
 
+  // output stage of the pipelined decoder
+  std::thread                     m_outputThread;                 ///< thread writing the reconstruction file
+  std::mutex                      m_outputQueueMutex;
+  std::condition_variable         m_outputQueueCond;
+  std::deque<std::pair<TComPic*, TComPic*> > m_outputQueue;       ///< frames (first) or field pairs (first, second) waiting for or being written
+  Bool                            m_bOutputThreadStop;
+
 public:
   TAppDecTop();
   virtual ~TAppDecTop() {}
@@ -101,6 +113,10 @@ protected:
 
   Void  xWriteOutput      ( TComList<TComPic*>* pcListPic , UInt tId); ///< write YUV to file
   Void  xFlushOutput      ( TComList<TComPic*>* pcListPic ); ///< flush all remaining decoded pictures to file
+  Void  xWriteReconPic    ( TComPic* pcPic, TComPic* pcPicBottom ); ///< write a frame or a field pair to the reconstruction file, on the output thread if pipelined
+  Void  xWriteReconFile   ( TComPic* pcPic, TComPic* pcPicBottom ); ///< write a frame or a field pair to the reconstruction file
+  Void  xWritePictures    ();                                       ///< output thread of the pipelined decoder
+  Void  xStopOutputThread ();
   Bool  isNaluWithinTargetDecLayerIdSet ( InputNALUnit* nalu ); ///< check whether given Nalu is within targetDecLayerIdSet
 
 private:
@@ -45,6 +45,7 @@
 #include <map>
 
 #include "TLibCommon/TComRom.h"
+#include "TLibCommon/x86/CommonDefX86.h"
 #if DPB_ENCODER_USAGE_CHECK
 #include "TLibCommon/ProfileLevelTierFeatures.h"
 #endif
@@ -128,6 +129,7 @@ TAppEncCfg::TAppEncCfg()
 , m_ext360(*this)
 #endif
 {
+  m_isChunkEncoder = false;
   m_aidQP = NULL;
   m_startOfCodedInterval = NULL;
   m_codedPivotValue = NULL;
@@ -670,6 +672,7 @@ Bool TAppEncCfg::parseCfg( Int argc, TChar* argv[] )
   Int tmpWeightedPredictionMethod;
   Int tmpFastInterSearchMode;
   Int tmpMotionEstimationSearchMethod;
+  Int tmpRoiMaskFormat;
   Int tmpSliceMode;
   Int tmpSliceSegmentMode;
   Int tmpDecodedPictureHashSEIMappedType;
@@ -693,6 +696,12 @@ Bool TAppEncCfg::parseCfg( Int argc, TChar* argv[] )
   SMultiValueInput<Int>  cfg_lumaLeveltoDQPMappingLuma       (0, std::numeric_limits<Int>::max(), 0, LUMA_LEVEL_TO_DQP_LUT_MAXSIZE, defaultLumaLevelTodQp_LumaChangePoints, sizeof(defaultLumaLevelTodQp_LumaChangePoints)/sizeof(Int));
   UInt lumaLevelToDeltaQPMode;
 
+  const Int defaultRoiLevelTodQp_QpChangePoints[]    =  { 0,  -2,  -4,  -6};
+  const Int defaultRoiLevelTodQp_LevelChangePoints[] =  { 0,  64, 128, 192};
+  SMultiValueInput<Int>  cfg_roiLeveltoDQPMappingQP          (-MAX_QP, MAX_QP, 0, ROI_LEVEL_TO_DQP_LUT_SIZE, defaultRoiLevelTodQp_QpChangePoints,    sizeof(defaultRoiLevelTodQp_QpChangePoints   )/sizeof(Int));
+  SMultiValueInput<Int>  cfg_roiLeveltoDQPMappingLevel       (0, ROI_LEVEL_TO_DQP_LUT_SIZE-1,  0, ROI_LEVEL_TO_DQP_LUT_SIZE, defaultRoiLevelTodQp_LevelChangePoints, sizeof(defaultRoiLevelTodQp_LevelChangePoints)/sizeof(Int));
+  UInt roiLevelToDeltaQPMode;
+
   const UInt defaultInputKneeCodes[3]  = { 600, 800, 900 };
   const UInt defaultOutputKneeCodes[3] = { 100, 250, 450 };
   Int cfg_kneeSEINumKneePointsMinus1=0;
@@ -779,7 +788,16 @@ Bool TAppEncCfg::parseCfg( Int argc, TChar* argv[] )
   ("InputPathPrefix,-ipp",                            inputPathPrefix,                             string(""), "pathname to prepend to input filename")
   ("BitstreamFile,b",                                 m_bitstreamFileName,                         string(""), "Bitstream output file name")
   ("ReconFile,o",                                     m_reconFileName,                             string(""), "Reconstructed YUV output file name")
-  ("InputMaskPath,-mi",                                m_inputMaskPath,                             string(""), "Mask Path for ROI-based coding")
+  ("InputMaskPath,-mi",                                m_inputMaskPath,                             string(""), "Mask Path for ROI-based coding: image, printf-style numbered image pattern (e.g. mask_%04d.png) or mask video")
+  ("InputMaskFormat",                                 tmpRoiMaskFormat,         Int(ROI_MASK_FORMAT_AUTO), "ROI mask format: 0:auto (from file name) 1:image(s) 2:raw 8-bit YUV400 3:Y4M 4:packed 1 bit per sample")
+  ("RoiMaskInterval",                                 m_roiMaskInterval,                                   1, "Number of input frames per frame of the ROI mask sequence; the masks of the frames in between are propagated with the motion of the input")
+  ("RoiMaskDilation",                                 m_roiMaskDilation,                                   8, "Margin in luma samples added around propagated ROI masks")
+  ("RoiStatsFile",                                    m_roiStatsFileName,                          string(""), "Per-picture and average foreground/background statistics of the ROI mask, JSON if the name ends in .json, otherwise CSV")
+  ("RoiBackgroundFastDecision",                       m_roiBackgroundFastDecision,                      false, "Reduced mode decision for CUs entirely outside the ROI mask: early skip/CU termination, no AMP, no split to the minimum CU size")
+  ("RoiBackgroundIntraModes",                         m_roiBackgroundIntraModes,                            2, "Number of intra modes given a full RD check in ROI background CUs when RoiBackgroundFastDecision is enabled")
+  ("RoiBackgroundSearchRange",                        m_roiBackgroundSearchRange,                           0, "Motion search range of PUs entirely outside the ROI mask (0: same as SearchRange)")
+  ("RoiBackgroundFracSkipThreshold",                  m_roiBackgroundFracSkipThreshold,                    0u, "Integer-pel ME cost per luma sample below which ROI background PUs skip fractional refinement (0: never skip)")
+  ("RoiForegroundExtendedSearch",                     m_roiForegroundExtendedSearch,                    false, "Use the extended TZ search settings (as MESearch 3) for PUs touching the ROI mask when MESearch is 1")
 
 #if SHUTTER_INTERVAL_SEI_PROCESSING
   ("SEIShutterIntervalPreFilename,-sii",              m_shutterIntervalPreFileName,                string(""), "File name of Pre-Filtering video. If empty, not output video\n")
@@ -910,6 +928,10 @@ Bool TAppEncCfg::parseCfg( Int argc, TChar* argv[] )
   ("LumaLevelToDeltaQPMaxValWeight",                  m_lumaLevelToDeltaQPMapping.maxMethodWeight,        1.0, "Weight of block max luma val when LumaLevelToDeltaQPMode = 2")
   ("LumaLevelToDeltaQPMappingLuma",                   cfg_lumaLeveltoDQPMappingLuma,  cfg_lumaLeveltoDQPMappingLuma, "Luma to Delta QP Mapping - luma thresholds")
   ("LumaLevelToDeltaQPMappingDQP",                    cfg_lumaLeveltoDQPMappingQP,  cfg_lumaLeveltoDQPMappingQP, "Luma to Delta QP Mapping - DQP values")
+  ("RoiLevelToDeltaQPMode",                           roiLevelToDeltaQPMode,                               0u, "ROI importance based Delta QP 0(default): binary mask with QPForeground. 1: Based on max importance in CU, 2: Based on mean importance in CU")
+  ("RoiLevelToDeltaQPInterpolate",                    m_roiLevelToDeltaQPMapping.interpolate,           false, "Interpolate linearly between ROI importance to Delta QP mapping points instead of holding the last value")
+  ("RoiLevelToDeltaQPMappingLevel",                   cfg_roiLeveltoDQPMappingLevel, cfg_roiLeveltoDQPMappingLevel, "ROI importance to Delta QP Mapping - importance levels (0..255), increasing")
+  ("RoiLevelToDeltaQPMappingDQP",                     cfg_roiLeveltoDQPMappingQP,  cfg_roiLeveltoDQPMappingQP, "ROI importance to Delta QP Mapping - DQP values, relative to the slice QP")
   ("CbQpOffset,-cbqpofs",                             m_cbQpOffset,                                         0, "Chroma Cb QP Offset")
   ("CrQpOffset,-crqpofs",                             m_crQpOffset,                                         0, "Chroma Cr QP Offset")
   ("WCGPPSEnable",                                    m_wcgChromaQpControl.enabled,                     false, "1: Enable the WCG PPS chroma modulation scheme. 0 (default) disabled")
@@ -1008,7 +1030,18 @@ Bool TAppEncCfg::parseCfg( Int argc, TChar* argv[] )
   ("TileColumnWidthArray",                            cfg_ColumnWidth,                        cfg_ColumnWidth, "Array containing tile column width values in units of CTU")
   ("TileRowHeightArray",                              cfg_RowHeight,                            cfg_RowHeight, "Array containing tile row height values in units of CTU")
   ("LFCrossTileBoundaryFlag",                         m_bLFCrossTileBoundaryFlag,                        true, "1: cross-tile-boundary loop filtering. 0:non-cross-tile-boundary loop filtering")
+  ("TileThreads",                                     m_numTileThreads,                                     1, "Number of threads compressing and entropy coding the tiles of a slice in parallel (1: single thread)")
   ("WaveFrontSynchro",                                m_entropyCodingSyncEnabledFlag,                   false, "0: entropy coding sync disabled; 1 entropy coding sync enabled")
+  ("WaveFrontThreads",                                m_numWaveFrontThreads,                                1, "Number of threads compressing the CTU rows of a slice in parallel when WaveFrontSynchro is enabled (1: single thread)")
+  ("FrameThreads",                                    m_numFrameThreads,                                    1, "Number of threads compressing pictures of a GOP that do not reference each other in parallel (1: single thread)")
+  ("LoopFilterThread",                                m_loopFilterThread,                               false, "Deblock and SAO process the CTU rows of a picture on a separate thread while the picture is compressed")
+  ("LookaheadThreads",                                m_lookaheadThreads,                                   0, "Number of threads analysing the received pictures (adaptive QP activities, picture statistics) before they are compressed (0: analysis on the encoding thread)")
+  ("LookaheadDepth",                                  m_lookaheadDepth,                                     0, "Maximum number of received pictures waiting for analysis by the lookahead threads (0: no limit)")
+  ("SceneCutDetection",                               m_sceneCutDetection,                              false, "Insert an IDR picture and restart the intra period and the GOP at scene cuts found by the lookahead")
+  ("SceneCutThreshold",                               m_sceneCutThreshold,                               0.85, "Ratio of the inter to the intra SATD estimate of a picture from which it is a scene cut")
+  ("SceneCutMinDistance",                             m_sceneCutMinDistance,                                8, "Minimum distance in pictures between a scene cut and the previous IRAP picture")
+  ("ParallelChunks",                                  m_parallelChunks,                                     1, "Number of chunks of whole intra periods encoded in parallel and concatenated into one bitstream (1: single chunk)")
+  ("SIMD",                                            m_simdExtension,                             string(""), "Most capable x86 vector extension used by the kernels of TLibCommon/x86: SCALAR, SSE41, SSE42, AVX, AVX2 or AVX512 (empty: the best one the CPU supports)")
   ("ScalingList",                                     m_useScalingListId,                    SCALING_LIST_OFF, "0/off: no scaling list, 1/default: default scaling lists, 2/file: scaling lists specified in ScalingListFile")
   ("ScalingListFile",                                 m_scalingListFileName,                       string(""), "Scaling list file name. Use an empty string to produce help.")
   ("SignHideFlag,-SBH",                               m_signDataHidingEnabledFlag,                                    true)
@@ -1035,6 +1068,8 @@ Bool TAppEncCfg::parseCfg( Int argc, TChar* argv[] )
   ( "RCCpbSaturation",                                m_RCCpbSaturationEnabled,                         false, "Rate control: enable target bits saturation to avoid CPB overflow and underflow" )
   ( "RCCpbSize",                                      m_RCCpbSize,                                         0u, "Rate control: CPB size" )
   ( "RCInitialCpbFullness",                           m_RCInitialCpbFullness,                             0.9, "Rate control: initial CPB fullness" )
+  ( "RCRoiForegroundBitShare",                        m_RCRoiForegroundBitShare,                          0.0, "Rate control: share of the picture data bits given to the ROI foreground (0: off)" )
+  ( "RCRoiLambdaRatio",                               m_RCRoiLambdaRatio,                                 0.0, "Rate control: ratio of the ROI foreground lambda to the background lambda (0: off)" )
   ("TransquantBypassEnable",                          m_TransquantBypassEnabledFlag,                    false, "transquant_bypass_enabled_flag indicator in PPS")
   ("TransquantBypassEnableFlag",                      m_TransquantBypassEnabledFlag,                    false, "deprecated alias for TransquantBypassEnable")
   ("CUTransquantBypassFlagForce",                     m_CUTransquantBypassFlagForce,                    false, "Force transquant bypass mode, when transquant_bypass_enabled_flag is enabled")
@@ -1334,6 +1369,7 @@ Bool TAppEncCfg::parseCfg( Int argc, TChar* argv[] )
   ("SEIFviPolynomialCoeff",                           cfg_fviSEIFisheyePolynomialCoeff,         cfg_fviSEIFisheyePolynomialCoeff,        "Specifies the j-th polynomial coefficient value of the curve function that maps the normalized distance of a luma sample from the centre of the circular region corresponding to the i-th active area to the angular value of a sphere coordinate from the normal vector of a nominal imaging plane that passes through the centre of the sphere coordinate system for the i-th active region.")
   ("SEIRegionalNestingFileRoot,-rns",                 m_regionalNestingSEIFileRoot,                    string(""), "Regional nesting SEI parameters root file name (wo num ext); only the file name base is to be added. Underscore and POC would be automatically addded to . E.g. \"-rns rns\" will search for files rns_0.txt, rns_1.txt, ...")
   ("SEIAnnotatedRegionsFileRoot,-ar",                 m_arSEIFileRoot,                                 string(""), "Annotated region SEI parameters root file name (wo num ext); only the file name base is to be added. Underscore and POC would be automatically addded to . E.g. \"-ar ar\" will search for files ar_0.txt, ar_1.txt, ...")
+  ("SEIAnnotatedRegionsFromMask",                     m_arSEIFromRoiMask,                                   false, "Annotated region SEI with the bounding boxes of the connected regions of the ROI mask, updated when they change")
 #if JCTVC_AD0021_SEI_MANIFEST
   ("SEISEIManifestEnabled",                           m_SEIManifestSEIEnabled,                  false,                                   "Controls if SEI Manifest SEI messages enabled")
 #endif
@@ -1346,6 +1382,8 @@ Bool TAppEncCfg::parseCfg( Int argc, TChar* argv[] )
     ("TemporalFilter", m_gopBasedTemporalFilterEnabled, false, "Enable GOP based temporal filter. Disabled per default")
     ("TemporalFilterPastRefs", m_gopBasedTemporalFilterPastRefs, TF_DEFAULT_REFS, "Number of past references for temporal prefilter")
     ("TemporalFilterFutureRefs", m_gopBasedTemporalFilterFutureRefs, TF_DEFAULT_REFS, "Number of future references for temporal prefilter")
+    ("TemporalFilterThreads", m_gopBasedTemporalFilterThreads, 1, "Number of threads of the motion estimation and filtering of the temporal prefilter (1: single thread)")
+    ("TemporalFilterLookahead", m_gopBasedTemporalFilterLookahead, 0, "Number of frames ahead of the input frame that the temporal prefilter may filter on a background thread (0: filter the input frame when it is read)")
     ("FirstValidFrame", m_firstValidFrame, 0, "First valid frame")
     ("LastValidFrame", m_lastValidFrame, MAX_INT, "Last valid frame")
     ("TemporalFilterStrengthFrame*", m_gopBasedTemporalFilterStrengths, std::map<Int, Double>(), "Strength for every * frame in GOP based temporal filter, where * is an integer."
@@ -1365,6 +1403,7 @@ Bool TAppEncCfg::parseCfg( Int argc, TChar* argv[] )
   po::setDefaults(opts);
   po::ErrorReporter err;
   const list<const TChar*>& argv_unhandled = po::scanArgv(opts, argc, (const TChar**) argv, err);
+  m_cmdLineArgs.assign(argv, argv + argc);
 
   for (list<const TChar*>::const_iterator it = argv_unhandled.begin(); it != argv_unhandled.end(); it++)
   {
@@ -1530,6 +1569,13 @@ Bool TAppEncCfg::parseCfg( Int argc, TChar* argv[] )
   }
   m_motionEstimationSearchMethod=MESearchMethod(tmpMotionEstimationSearchMethod);
 
+  if (tmpRoiMaskFormat<0 || tmpRoiMaskFormat>=ROI_MASK_FORMAT_NUMBER_OF_FORMATS)
+  {
+    printf("Unsupported InputMaskFormat %d\n", tmpRoiMaskFormat);
+    exit(EXIT_FAILURE);
+  }
+  m_roiMaskFormat=RoiMaskFormat(tmpRoiMaskFormat);
+
   switch (UIProfile)
   {
     case UI_NONE:
@@ -1855,6 +1901,27 @@ Bool TAppEncCfg::parseCfg( Int argc, TChar* argv[] )
     }
   }
 
+  if (roiLevelToDeltaQPMode>=ROI_LEVEL_TO_DQP_NUM_MODES)
+  {
+    printf("Unsupported RoiLevelToDeltaQPMode %d\n", roiLevelToDeltaQPMode);
+    exit(EXIT_FAILURE);
+  }
+  m_roiLevelToDeltaQPMapping.mode=RoiLevelToDQPMode(roiLevelToDeltaQPMode);
+
+  if (m_roiLevelToDeltaQPMapping.mode)
+  {
+    if (cfg_roiLeveltoDQPMappingLevel.values.size() != cfg_roiLeveltoDQPMappingQP.values.size())
+    {
+      printf("RoiLevelToDeltaQPMappingLevel and RoiLevelToDeltaQPMappingDQP must have the same number of entries\n");
+      exit(EXIT_FAILURE);
+    }
+    m_roiLevelToDeltaQPMapping.mapping.resize(cfg_roiLeveltoDQPMappingLevel.values.size());
+    for(UInt i=0; i<cfg_roiLeveltoDQPMappingLevel.values.size(); i++)
+    {
+      m_roiLevelToDeltaQPMapping.mapping[i]=std::pair<Int,Int>(cfg_roiLeveltoDQPMappingLevel.values[i], cfg_roiLeveltoDQPMappingQP.values[i]);
+    }
+  }
+
   // reading external dQP description from file
   if ( !m_dQPFileName.empty() )
   {
@@ -2195,6 +2262,16 @@ Bool TAppEncCfg::parseCfg( Int argc, TChar* argv[] )
   // check validity of input parameters
   xCheckParameter();
 
+#if VECTOR_CODING__X86_DISPATCH
+  // cap the vector extension of the encoder objects, which are all created after this point
+  X86_VEXT simdExtension = X86_AVX512;
+  if (!m_simdExtension.empty())
+  {
+    parseX86ExtensionName(m_simdExtension, simdExtension);
+  }
+  setX86ExtensionLimit(simdExtension);
+#endif
+
   // compute actual CU depth with respect to config depth and max transform size
   UInt uiAddCUDepth  = 0;
   while( (m_uiMaxCUWidth>>m_uiMaxCUDepth) > ( 1 << ( m_uiQuadtreeTULog2MinSize + uiAddCUDepth )  ) )
@@ -2206,7 +2283,10 @@ Bool TAppEncCfg::parseCfg( Int argc, TChar* argv[] )
   m_uiLog2DiffMaxMinCodingBlockSize = m_uiMaxCUDepth - 1;
 
   // print-out parameters
-  xPrintParameter();
+  if (!m_isChunkEncoder)
+  {
+    xPrintParameter();
+  }
 
   return true;
 }
@@ -2481,6 +2561,26 @@ Void TAppEncCfg::xCheckParameter()
   xConfirmPara( m_iQP_fg !=  0 && m_bUseAdaptQpSelect == true,                                         "Must use AdaptiveQpSelection when using 2 different QPs" );
   xConfirmPara( m_iQP_fg !=  0 && m_inputMaskPath == "",                                               "Must have a mask to use 2 different QPs" );
 #endif
+  xConfirmPara( !m_roiStatsFileName.empty() && m_inputMaskPath == "",                                 "RoiStatsFile requires an InputMaskPath" );
+  xConfirmPara( !m_roiStatsFileName.empty() && !m_bUseAdaptiveQP,                                     "RoiStatsFile requires AdaptiveQP" );
+  xConfirmPara( m_roiMaskInterval < 1,                                                                "RoiMaskInterval must be at least 1" );
+  xConfirmPara( m_roiMaskDilation < 0 || m_roiMaskDilation > 64,                                      "RoiMaskDilation must be in the range 0 to 64" );
+  xConfirmPara( m_roiBackgroundFastDecision && m_inputMaskPath == "",                                 "RoiBackgroundFastDecision requires an InputMaskPath" );
+  xConfirmPara( m_roiBackgroundFastDecision && !m_bUseAdaptiveQP,                                     "RoiBackgroundFastDecision requires AdaptiveQP" );
+  xConfirmPara( m_arSEIFromRoiMask && m_inputMaskPath == "",                                          "SEIAnnotatedRegionsFromMask requires an InputMaskPath" );
+  xConfirmPara( m_arSEIFromRoiMask && !m_bUseAdaptiveQP,                                              "SEIAnnotatedRegionsFromMask requires AdaptiveQP" );
+  xConfirmPara( m_arSEIFromRoiMask && !m_arSEIFileRoot.empty(),                                       "SEIAnnotatedRegionsFromMask cannot be used together with SEIAnnotatedRegionsFileRoot" );
+  xConfirmPara( m_roiBackgroundSearchRange < 0,                                                       "RoiBackgroundSearchRange must be more than or equal to 0" );
+  xConfirmPara( (m_roiBackgroundSearchRange > 0 || m_roiBackgroundFracSkipThreshold > 0 || m_roiForegroundExtendedSearch) && m_inputMaskPath == "", "ROI motion search settings require an InputMaskPath" );
+  xConfirmPara( (m_roiBackgroundSearchRange > 0 || m_roiBackgroundFracSkipThreshold > 0 || m_roiForegroundExtendedSearch) && !m_bUseAdaptiveQP,     "ROI motion search settings require AdaptiveQP" );
+  xConfirmPara( m_roiBackgroundIntraModes < 1 || m_roiBackgroundIntraModes > FAST_UDI_MAX_RDMODE_NUM,  "RoiBackgroundIntraModes must be in the range 1 to FAST_UDI_MAX_RDMODE_NUM" );
+  xConfirmPara( m_roiLevelToDeltaQPMapping.mode && m_inputMaskPath == "",                              "RoiLevelToDeltaQPMode requires an InputMaskPath" );
+  xConfirmPara( m_roiLevelToDeltaQPMapping.mode && m_iQP_fg != 0,                                     "QPForeground cannot be used together with RoiLevelToDeltaQPMode" );
+  xConfirmPara( m_roiLevelToDeltaQPMapping.mode && !m_bUseAdaptiveQP,                                 "RoiLevelToDeltaQPMode requires AdaptiveQP" );
+  for (UInt i=1; i<m_roiLevelToDeltaQPMapping.mapping.size(); i++)
+  {
+    xConfirmPara( m_roiLevelToDeltaQPMapping.mapping[i].first <= m_roiLevelToDeltaQPMapping.mapping[i-1].first, "RoiLevelToDeltaQPMappingLevel must be strictly increasing" );
+  }
 
   if( m_usePCM)
   {
@@ -2508,6 +2608,43 @@ Void TAppEncCfg::xCheckParameter()
   {
     xConfirmPara( tileFlag && m_entropyCodingSyncEnabledFlag, "Tiles and entropy-coding-sync (Wavefronts) can not be applied together, except in the High Throughput Intra 4:4:4 16 profile");
   }
+  xConfirmPara( m_numWaveFrontThreads < 1, "WaveFrontThreads must be at least 1" );
+  xConfirmPara( m_numTileThreads < 1, "TileThreads must be at least 1" );
+  xConfirmPara( m_numFrameThreads < 1, "FrameThreads must be at least 1" );
+  xConfirmPara( m_numFrameThreads > 1 && m_RCEnableRateControl, "FrameThreads cannot be used with rate control, which updates its models in coding order" );
+  xConfirmPara( m_lookaheadThreads < 0, "LookaheadThreads must not be negative" );
+  xConfirmPara( m_lookaheadDepth < 0, "LookaheadDepth must not be negative" );
+  xConfirmPara( m_parallelChunks < 1, "ParallelChunks must be at least 1" );
+#if VECTOR_CODING__X86_DISPATCH
+  X86_VEXT simdExtension;
+  xConfirmPara( !m_simdExtension.empty() && !parseX86ExtensionName( m_simdExtension, simdExtension ), "SIMD must be one of SCALAR, SSE41, SSE42, AVX, AVX2 and AVX512" );
+#endif
+  if (m_sceneCutDetection)
+  {
+    xConfirmPara( m_sceneCutThreshold <= 0.0 || m_sceneCutThreshold > 1.0, "SceneCutThreshold must be in the range (0, 1]" );
+    xConfirmPara( m_sceneCutMinDistance < 1, "SceneCutMinDistance must be at least 1" );
+    xConfirmPara( m_isField, "SceneCutDetection is not supported with field coding" );
+    xConfirmPara( m_parallelChunks > 1, "SceneCutDetection is not supported with ParallelChunks" );
+  }
+  if (m_parallelChunks > 1)
+  {
+    xConfirmPara( m_iIntraPeriod <= 0,                    "ParallelChunks requires a positive IntraPeriod" );
+    xConfirmPara( m_iDecodingRefreshType != 1,            "ParallelChunks requires CRA pictures (DecodingRefreshType=1)" );
+    xConfirmPara( m_isField,                              "ParallelChunks cannot be used with field coding" );
+    xConfirmPara( m_RCEnableRateControl,                  "ParallelChunks cannot be used with rate control" );
+    xConfirmPara( !m_dQPFileName.empty(),                 "ParallelChunks cannot be used with a dQP file" );
+    xConfirmPara( !m_summaryOutFilename.empty() || !m_summaryPicFilenameBase.empty(), "ParallelChunks cannot be used with summary output files" );
+    xConfirmPara( !m_roiStatsFileName.empty(),            "ParallelChunks cannot be used with RoiStatsFile" );
+    xConfirmPara( m_arSEIFromRoiMask,                     "ParallelChunks cannot be used with SEIAnnotatedRegionsFromMask" );
+#if JVET_X0048_X0103_FILM_GRAIN
+    xConfirmPara( m_fgcSEIAnalysisEnabled,                "ParallelChunks cannot be used with film grain analysis" );
+#endif
+#if SHUTTER_INTERVAL_SEI_PROCESSING
+    xConfirmPara( !m_shutterIntervalPreFileName.empty(),  "ParallelChunks cannot be used with a shutter interval pre-filtered output file" );
+#endif
+    xConfirmPara( m_roiMaskInterval > 1 && ( ( m_iIntraPeriod * m_temporalSubsampleRatio ) % m_roiMaskInterval != 0 || m_FrameSkip % m_roiMaskInterval != 0 ),
+                  "With ParallelChunks, IntraPeriod and FrameSkip must be multiples of RoiMaskInterval" );
+  }
 
   xConfirmPara( m_sourceWidth  % TComSPS::getWinUnitX(m_chromaFormatIDC) != 0, "Picture width must be an integer multiple of the specified chroma subsampling");
   xConfirmPara( m_sourceHeight % TComSPS::getWinUnitY(m_chromaFormatIDC) != 0, "Picture height must be an integer multiple of the specified chroma subsampling");
@@ -3030,10 +3167,20 @@ Void TAppEncCfg::xCheckParameter()
 #endif
       xConfirmPara(m_RCInitialCpbFullness > 1, "RCInitialCpbFullness should be smaller than or equal to 1");
     }
+    xConfirmPara( m_RCRoiForegroundBitShare < 0 || m_RCRoiForegroundBitShare >= 1,             "RCRoiForegroundBitShare must be in the range of 0 to 1 (exclusive)" );
+    xConfirmPara( m_RCRoiLambdaRatio < 0,                                                        "RCRoiLambdaRatio must not be negative" );
+    xConfirmPara( m_RCRoiForegroundBitShare > 0 && m_RCRoiLambdaRatio > 0,                       "RCRoiForegroundBitShare and RCRoiLambdaRatio cannot be used together" );
+    if ( m_RCRoiForegroundBitShare > 0 || m_RCRoiLambdaRatio > 0 )
+    {
+      xConfirmPara( m_inputMaskPath == "" || !m_bUseAdaptiveQP,                                  "ROI rate control requires an InputMaskPath and AdaptiveQP" );
+      xConfirmPara( m_roiLevelToDeltaQPMapping.mode,                                             "ROI rate control cannot be used together with RoiLevelToDeltaQPMode" );
+      xConfirmPara( m_iQP_fg != 0,                                                               "QPForeground cannot be used together with ROI rate control" );
+    }
   }
   else
   {
     xConfirmPara( m_RCCpbSaturationEnabled != 0, "Target bits saturation cannot be processed without Rate control" );
+    xConfirmPara( m_RCRoiForegroundBitShare != 0 || m_RCRoiLambdaRatio != 0, "ROI rate control cannot be processed without Rate control" );
   }
   if (m_vuiParametersPresentFlag)
   {
@@ -3126,6 +3273,8 @@ Void TAppEncCfg::xCheckParameter()
     }
   }
 
+  xConfirmPara(m_gopBasedTemporalFilterThreads < 1, "TemporalFilterThreads must be at least 1");
+  xConfirmPara(m_gopBasedTemporalFilterLookahead < 0, "TemporalFilterLookahead must not be negative");
   if (m_gopBasedTemporalFilterEnabled)
   {
     xConfirmPara(m_temporalSubsampleRatio != 1, "GOP Based Temporal Filter only support Temporal sub-sample ratio 1");
@@ -3261,6 +3410,14 @@ Void TAppEncCfg::xPrintParameter()
   printf("Bitstream      File                    : %s\n", m_bitstreamFileName.c_str()      );
   printf("Reconstruction File                    : %s\n", m_reconFileName.c_str()          );
   printf("Mask File                    : %s\n", m_inputMaskPath.c_str()          );
+  if (!m_roiStatsFileName.empty())
+  {
+    printf("ROI Statistics File                    : %s\n", m_roiStatsFileName.c_str()       );
+  }
+  if (m_roiMaskInterval > 1)
+  {
+    printf("ROI mask interval                      : %d (dilation %d)\n", m_roiMaskInterval, m_roiMaskDilation);
+  }
 
 #if SHUTTER_INTERVAL_SEI_PROCESSING
   if (m_ShutterFilterEnable && !m_shutterIntervalPreFileName.empty())
@@ -3355,6 +3512,27 @@ Void TAppEncCfg::xPrintParameter()
     printf("QP                                     : %d\n", m_iQP );
     printf("Foreground QP                          : %d\n", m_iQP_fg);
   }
+  if (m_roiLevelToDeltaQPMapping.isEnabled())
+  {
+    printf("ROI level to delta QP mapping          : %s,%s", m_roiLevelToDeltaQPMapping.mode == ROI_LEVEL_TO_DQP_MAX_METHOD ? "max" : "mean", m_roiLevelToDeltaQPMapping.interpolate ? "linear" : "step");
+    for (UInt i=0; i<m_roiLevelToDeltaQPMapping.mapping.size(); i++)
+    {
+      printf(" %d:%d", m_roiLevelToDeltaQPMapping.mapping[i].first, m_roiLevelToDeltaQPMapping.mapping[i].second);
+    }
+    printf("\n");
+  }
+  if (m_roiBackgroundFastDecision)
+  {
+    printf("ROI background fast decision           : intra modes=%d\n", m_roiBackgroundIntraModes);
+  }
+  if (m_roiBackgroundSearchRange > 0 || m_roiBackgroundFracSkipThreshold > 0 || m_roiForegroundExtendedSearch)
+  {
+    printf("ROI motion search                      : background range=%d, frac skip threshold=%u, foreground extended=%d\n", m_roiBackgroundSearchRange, m_roiBackgroundFracSkipThreshold, m_roiForegroundExtendedSearch);
+  }
+  if (m_arSEIFromRoiMask)
+  {
+    printf("ROI annotated regions SEI              : Enabled\n");
+  }
   
   printf("Max dQP signaling depth                : %d\n", m_iMaxCuDQPDepth);
 
@@ -3410,6 +3588,14 @@ Void TAppEncCfg::xPrintParameter()
       printf("CpbSize                                : %d\n", m_RCCpbSize);
       printf("InitalCpbFullness                      : %.2f\n", m_RCInitialCpbFullness);
     }
+    if (m_RCRoiForegroundBitShare > 0)
+    {
+      printf("RoiForegroundBitShare                  : %.2f\n", m_RCRoiForegroundBitShare);
+    }
+    if (m_RCRoiLambdaRatio > 0)
+    {
+      printf("RoiLambdaRatio                         : %.3f\n", m_RCRoiLambdaRatio);
+    }
   }
 
   printf("Max Num Merge Candidates               : %d\n", m_maxNumMergeCand);
@@ -3463,6 +3649,53 @@ Void TAppEncCfg::xPrintParameter()
   printf("PME:%d ", m_log2ParallelMergeLevel);
   const Int iWaveFrontSubstreams = m_entropyCodingSyncEnabledFlag ? (m_sourceHeight + m_uiMaxCUHeight - 1) / m_uiMaxCUHeight : 1;
   printf(" WaveFrontSynchro:%d WaveFrontSubstreams:%d", m_entropyCodingSyncEnabledFlag?1:0, iWaveFrontSubstreams);
+  if (m_entropyCodingSyncEnabledFlag && m_numWaveFrontThreads > 1)
+  {
+    printf(" WaveFrontThreads:%d", m_numWaveFrontThreads);
+  }
+  if ((m_numTileColumnsMinus1 > 0 || m_numTileRowsMinus1 > 0) && m_numTileThreads > 1)
+  {
+    printf(" TileThreads:%d", m_numTileThreads);
+  }
+  if (m_numFrameThreads > 1)
+  {
+    printf(" FrameThreads:%d", m_numFrameThreads);
+  }
+  if (m_loopFilterThread)
+  {
+    printf(" LoopFilterThread:1");
+  }
+  if (m_lookaheadThreads > 0)
+  {
+    printf(" LookaheadThreads:%d LookaheadDepth:%d", m_lookaheadThreads, m_lookaheadDepth);
+  }
+  if (m_sceneCutDetection)
+  {
+    printf(" SceneCutDetection:1 (threshold %.2f, min. distance %d)", m_sceneCutThreshold, m_sceneCutMinDistance);
+  }
+#if VECTOR_CODING__X86_DISPATCH
+  printf(" SIMD:%s", getX86ExtensionName(getX86Extension()));
+#endif
+#if JVET_Y0077_BIM
+  if ((m_gopBasedTemporalFilterEnabled || m_bimEnabled) && m_gopBasedTemporalFilterThreads > 1)
+#else
+  if (m_gopBasedTemporalFilterEnabled && m_gopBasedTemporalFilterThreads > 1)
+#endif
+  {
+    printf(" TemporalFilterThreads:%d", m_gopBasedTemporalFilterThreads);
+  }
+#if JVET_Y0077_BIM
+  if ((m_gopBasedTemporalFilterEnabled || m_bimEnabled) && m_gopBasedTemporalFilterLookahead > 0)
+#else
+  if (m_gopBasedTemporalFilterEnabled && m_gopBasedTemporalFilterLookahead > 0)
+#endif
+  {
+    printf(" TemporalFilterLookahead:%d", m_gopBasedTemporalFilterLookahead);
+  }
+  if (m_parallelChunks > 1)
+  {
+    printf(" ParallelChunks:%d", m_parallelChunks);
+  }
   printf(" ScalingList:%d ", m_useScalingListId );
   printf("TMVPMode:%d ", m_TMVPModeId     );
 #if ADAPTIVE_QP_SELECTION
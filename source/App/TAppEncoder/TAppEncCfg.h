@@ -74,7 +74,18 @@ protected:
   std::string m_inputFileName;                                ///< source file name
   std::string m_bitstreamFileName;                            ///< output bitstream file
   std::string m_reconFileName;                                ///< output reconstruction file
+  std::vector<std::string> m_cmdLineArgs;                     ///< command line, parsed again to configure the encoders of parallel chunks
+  Bool        m_isChunkEncoder;                               ///< encodes one chunk of a ParallelChunks encode, without print-out of the configuration
   std::string m_inputMaskPath;                                ///< mask path for ROI-based coding
+  RoiMaskFormat m_roiMaskFormat;                              ///< format of the ROI mask file(s)
+  Int         m_roiMaskInterval;                              ///< number of input frames per mask of a mask sequence
+  Int         m_roiMaskDilation;                              ///< margin in luma samples around propagated masks
+  std::string m_roiStatsFileName;                             ///< CSV or JSON output of the per-picture ROI region statistics
+  Bool        m_roiBackgroundFastDecision;                    ///< reduced mode decision for CUs entirely outside the ROI mask
+  Int         m_roiBackgroundIntraModes;                      ///< number of intra modes given full RD check in ROI background CUs
+  Int         m_roiBackgroundSearchRange;                     ///< motion search range of PUs entirely outside the ROI mask
+  UInt        m_roiBackgroundFracSkipThreshold;               ///< integer-pel cost per sample below which ROI background PUs skip fractional ME
+  Bool        m_roiForegroundExtendedSearch;                  ///< extended TZ search settings for PUs touching the ROI mask
 #if SHUTTER_INTERVAL_SEI_PROCESSING
   Bool        m_ShutterFilterEnable;                          ///< enable Pre-Filtering with Shutter Interval SEI
   std::string m_shutterIntervalPreFileName;                   ///< output Pre-Filtering video
@@ -183,6 +194,7 @@ protected:
   UInt      m_sliceChromaQpOffsetPeriodicity;                 ///< Used in conjunction with Slice Cb/Cr QpOffsetIntraOrPeriodic. Use 0 (default) to disable periodic nature.
   Int       m_sliceChromaQpOffsetIntraOrPeriodic[2/*Cb,Cr*/]; ///< Chroma Cb QP Offset at slice level for I slice or for periodic inter slices as defined by SliceChromaQPOffsetPeriodicity. Replaces offset in the GOP table.
   LumaLevelToDeltaQPMapping m_lumaLevelToDeltaQPMapping;      ///< mapping from luma level to Delta QP.
+  RoiLevelToDeltaQPMapping m_roiLevelToDeltaQPMapping;        ///< mapping from ROI importance level to Delta QP.
 #if ADAPTIVE_QP_SELECTION
   Bool      m_bUseAdaptQpSelect;
 #endif
@@ -283,7 +295,18 @@ protected:
   Int       m_numTileRowsMinus1;
   std::vector<Int> m_tileColumnWidth;
   std::vector<Int> m_tileRowHeight;
+  Int       m_numTileThreads;                                 ///< number of threads compressing and entropy coding the tiles of a slice
   Bool      m_entropyCodingSyncEnabledFlag;
+  Int       m_numWaveFrontThreads;                            ///< number of threads compressing the CTU rows of a slice with entropy coding sync
+  Int       m_numFrameThreads;                                ///< number of threads compressing independent pictures of a GOP
+  Bool      m_loopFilterThread;                               ///< deblock and SAO process the CTU rows of a picture on a separate thread while it is compressed
+  Int       m_lookaheadThreads;                               ///< number of threads analysing the received pictures before they are compressed (0: analysis on the encoding thread)
+  Int       m_lookaheadDepth;                                 ///< maximum number of received pictures waiting for analysis (0: no limit)
+  Bool      m_sceneCutDetection;                              ///< insert an IDR picture and restart the intra period at scene cuts
+  Double    m_sceneCutThreshold;                              ///< ratio of the inter to the intra SATD estimate from which a picture is a scene cut
+  Int       m_sceneCutMinDistance;                            ///< minimum distance in pictures between a scene cut and the previous IRAP picture
+  Int       m_parallelChunks;                                 ///< number of chunks of whole intra periods encoded in parallel
+  std::string m_simdExtension;                                ///< most capable x86 vector extension used by the kernels (empty: the best supported one)
 
   Bool      m_bUseConstrainedIntraPred;                       ///< flag for using constrained intra prediction
   Bool      m_bFastUDIUseMPMEnabled;
@@ -423,6 +446,8 @@ protected:
   Bool                  m_gopBasedTemporalFilterEnabled;               ///< GOP-based Temporal Filter enable/disable
   Int                   m_gopBasedTemporalFilterPastRefs;
   Int                   m_gopBasedTemporalFilterFutureRefs;
+  Int                   m_gopBasedTemporalFilterThreads;               ///< number of threads of the motion estimation and filtering of the GOP-based Temporal Filter
+  Int                   m_gopBasedTemporalFilterLookahead;             ///< number of frames the GOP-based Temporal Filter may filter ahead of the input on a background thread
   Int                   m_firstValidFrame;
   Int                   m_lastValidFrame;
   std::map<Int, Double> m_gopBasedTemporalFilterStrengths;             ///< Filter strength per frame for the GOP-based Temporal Filter
@@ -431,6 +456,7 @@ protected:
 #endif
 
   std::string           m_arSEIFileRoot;
+  Bool                  m_arSEIFromRoiMask;                 ///< annotated region SEI derived from the ROI mask
   Bool                    m_fisheyeVIdeoInfoSEIEnabled;
   TComSEIFisheyeVideoInfo m_fisheyeVideoInfoSEI;
   // weighted prediction
@@ -453,6 +479,8 @@ protected:
   Bool      m_RCCpbSaturationEnabled;             ///< enable target bits saturation to avoid CPB overflow and underflow
   UInt      m_RCCpbSize;                          ///< CPB size
   Double    m_RCInitialCpbFullness;               ///< initial CPB fullness 
+  Double    m_RCRoiForegroundBitShare;            ///< share of the picture data bits given to the ROI foreground, 0: off
+  Double    m_RCRoiLambdaRatio;                   ///< ratio of the foreground to the background lambda, 0: off
   ScalingListMode m_useScalingListId;                         ///< using quantization matrix
   std::string m_scalingListFileName;                          ///< quantization matrix file name
 
@@ -0,0 +1,337 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2022, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TAppEncParcat.cpp
+    \brief    Concatenation of the bitstreams of parallel chunks
+*/
+
+#include <algorithm>
+
+#include "TAppEncParcat.h"
+
+using namespace std;
+
+//! \ingroup TAppEncoder
+//! \{
+
+/** find the next three-byte start code prefix at or after pos
+ * \returns the position of the start code, or size if there is none
+ */
+static size_t findStartCode( const UChar* buf, size_t size, size_t pos )
+{
+  for ( ; pos + 2 < size; pos++ )
+  {
+    if ( buf[pos] == 0x00 && buf[pos+1] == 0x00 && buf[pos+2] == 0x01 )
+    {
+      return pos;
+    }
+  }
+  return size;
+}
+
+/// remove the emulation prevention bytes of a NAL unit
+static Void convertPayloadToRBSP( const UChar* nal, size_t size, vector<UChar>& rbsp )
+{
+  UInt zeroCount = 0;
+  rbsp.clear();
+  rbsp.reserve( size );
+  for ( size_t i = 0; i < size; i++ )
+  {
+    if ( zeroCount == 2 && nal[i] == 0x03 )
+    {
+      zeroCount = 0;
+      continue;
+    }
+    zeroCount = ( nal[i] == 0x00 ) ? zeroCount + 1 : 0;
+    rbsp.push_back( nal[i] );
+  }
+}
+
+/// write a NAL unit, inserting emulation prevention bytes after the NAL unit header as NALwrite does
+static Void writeRBSPAsPayload( const vector<UChar>& rbsp, ostream& out )
+{
+  vector<UChar> payload;
+  payload.reserve( rbsp.size() * 2 + 1 );
+  UInt zeroCount = 0;
+  for ( size_t i = 0; i < rbsp.size(); i++ )
+  {
+    if ( i >= 2 && zeroCount == 2 && rbsp[i] <= 0x03 )
+    {
+      payload.push_back( 0x03 );
+      zeroCount = 0;
+    }
+    zeroCount = ( i >= 2 && rbsp[i] == 0x00 ) ? zeroCount + 1 : 0;
+    payload.push_back( rbsp[i] );
+  }
+  if ( zeroCount > 0 )
+  {
+    payload.push_back( 0x03 );
+  }
+  out.write( reinterpret_cast<const TChar*>( &payload[0] ), payload.size() );
+}
+
+static UInt readBits( const vector<UChar>& buf, UInt& bitPos, UInt numBits )
+{
+  UInt value = 0;
+  for ( UInt i = 0; i < numBits; i++, bitPos++ )
+  {
+    const UInt byte = ( bitPos >> 3 ) < buf.size() ? buf[bitPos >> 3] : 0;
+    value = ( value << 1 ) | ( ( byte >> ( 7 - ( bitPos & 7 ) ) ) & 1 );
+  }
+  return value;
+}
+
+static UInt readUvlc( const vector<UChar>& buf, UInt& bitPos )
+{
+  UInt leadingZeros = 0;
+  while ( readBits( buf, bitPos, 1 ) == 0 && leadingZeros < 32 )
+  {
+    leadingZeros++;
+  }
+  return ( 1u << leadingZeros ) - 1 + readBits( buf, bitPos, leadingZeros );
+}
+
+static Void writeBits( vector<UChar>& buf, UInt bitPos, UInt numBits, UInt value )
+{
+  for ( UInt i = 0; i < numBits; i++, bitPos++ )
+  {
+    const UChar mask = UChar( 0x80 >> ( bitPos & 7 ) );
+    if ( ( value >> ( numBits - 1 - i ) ) & 1 )
+    {
+      buf[bitPos >> 3] |= mask;
+    }
+    else
+    {
+      buf[bitPos >> 3] &= ~mask;
+    }
+  }
+}
+
+// ====================================================================================================================
+// Constructor / initialization
+// ====================================================================================================================
+
+TAppEncParcat::TAppEncParcat()
+: m_bitsForPOC                    ( 8 )
+, m_dependentSliceSegmentsEnabled ( false )
+, m_sliceSegmentAddressBits       ( 0 )
+, m_numSegments                   ( 0 )
+, m_pocBase                       ( 0 )
+, m_lastIdrPoc                    ( 0 )
+, m_totalBytes                    ( 0 )
+, m_essentialBytes                ( 0 )
+{
+}
+
+/** \param bitsForPOC                     number of bits of slice_pic_order_cnt_lsb
+ * \param dependentSliceSegmentsEnabled  dependent_slice_segments_enabled_flag of the PPS
+ * \param sliceSegmentAddressBits        Ceil( Log2( PicSizeInCtbsY ) )
+ */
+Void TAppEncParcat::init( UInt bitsForPOC, Bool dependentSliceSegmentsEnabled, UInt sliceSegmentAddressBits )
+{
+  m_bitsForPOC                    = bitsForPOC;
+  m_dependentSliceSegmentsEnabled = dependentSliceSegmentsEnabled;
+  m_sliceSegmentAddressBits       = sliceSegmentAddressBits;
+}
+
+// ====================================================================================================================
+// Public member functions
+// ====================================================================================================================
+
+/// derive the POC from its LSBs as in clause 8.3.1
+Int TAppEncParcat::calcPOC( Int pocLsb, Int prevTid0POC, Int bitsForPOC, Int nalUnitType )
+{
+  const Int maxPocLsb     = 1 << bitsForPOC;
+  const Int prevPocLsb    = prevTid0POC & ( maxPocLsb - 1 );
+  const Int prevPocMsb    = prevTid0POC - prevPocLsb;
+  Int       pocMsb;
+  if ( ( pocLsb < prevPocLsb ) && ( ( prevPocLsb - pocLsb ) >= ( maxPocLsb / 2 ) ) )
+  {
+    pocMsb = prevPocMsb + maxPocLsb;
+  }
+  else if ( ( pocLsb > prevPocLsb ) && ( ( pocLsb - prevPocLsb ) > ( maxPocLsb / 2 ) ) )
+  {
+    pocMsb = prevPocMsb - maxPocLsb;
+  }
+  else
+  {
+    pocMsb = prevPocMsb;
+  }
+  if ( nalUnitType == NAL_UNIT_CODED_SLICE_BLA_W_LP || nalUnitType == NAL_UNIT_CODED_SLICE_BLA_W_RADL || nalUnitType == NAL_UNIT_CODED_SLICE_BLA_N_LP )
+  {
+    // For BLA picture types, POCmsb is set to 0.
+    pocMsb = 0;
+  }
+  return pocMsb + pocLsb;
+}
+
+/**
+ - the first chunk is written unchanged
+ - of the following chunks, the first access unit (parameter sets, SEI messages and the duplicated IDR picture) is dropped
+ - the POC LSBs of the remaining slices are rebased by the POC of the last picture of the previous chunk
+ .
+ \param segment  bitstream of the chunk
+ \param out      concatenated bitstream
+ */
+Void TAppEncParcat::filterSegment( const string& segment, ostream& out )
+{
+  const UChar* buf  = reinterpret_cast<const UChar*>( segment.data() );
+  const size_t size = segment.size();
+
+  Bool  dropAccessUnit = m_numSegments > 0;
+  Bool  irapDropped    = false;
+  Int   prevTid0POC    = 0;
+  Int   maxPOC         = 0;
+  vector<UChar> rbsp;
+  const UInt pocLsbMask = ( 1u << m_bitsForPOC ) - 1;
+
+  size_t prefixStart = 0;
+  size_t startCode   = findStartCode( buf, size, 0 );
+  while ( startCode < size )
+  {
+    const size_t nalStart = startCode + 3;
+    startCode = findStartCode( buf, size, nalStart );
+    size_t nalEnd = startCode;
+    while ( nalEnd > nalStart && buf[nalEnd - 1] == 0x00 )
+    {
+      nalEnd--;   // zero_byte of the next start code, or trailing_zero_8bits
+    }
+    const size_t prefixEnd = nalStart;
+    const size_t prefixBegin = prefixStart;
+    prefixStart = nalEnd;
+    if ( nalEnd < nalStart + 2 )
+    {
+      continue;
+    }
+
+    const Int  nalUnitType = ( buf[nalStart] >> 1 ) & 0x3f;
+    const Int  temporalId  = ( buf[nalStart + 1] & 0x07 ) - 1;
+    const Bool isVcl       = nalUnitType <= NAL_UNIT_RESERVED_VCL31;
+    const Bool firstSliceSegmentInPic = isVcl && nalEnd > nalStart + 2 && ( buf[nalStart + 2] & 0x80 ) != 0;
+
+    if ( dropAccessUnit )
+    {
+      if ( irapDropped && ( firstSliceSegmentInPic || ( !isVcl && nalUnitType != NAL_UNIT_SUFFIX_SEI && nalUnitType != NAL_UNIT_FILLER_DATA ) ) )
+      {
+        dropAccessUnit = false;
+      }
+      else
+      {
+        irapDropped = irapDropped || isVcl;
+        continue;
+      }
+    }
+
+    const size_t prefixBytes = prefixEnd - prefixBegin;
+    out.write( reinterpret_cast<const TChar*>( buf + prefixBegin ), prefixBytes );
+    if ( isVcl )
+    {
+      convertPayloadToRBSP( buf + nalStart, nalEnd - nalStart, rbsp );
+      maxPOC = std::max( maxPOC, xRebaseSliceHeader( rbsp, nalUnitType, temporalId, prevTid0POC ) );
+    }
+    if ( isVcl && ( UInt( m_pocBase - m_lastIdrPoc ) & pocLsbMask ) != 0 )
+    {
+      writeRBSPAsPayload( rbsp, out );
+    }
+    else
+    {
+      out.write( reinterpret_cast<const TChar*>( buf + nalStart ), nalEnd - nalStart );
+    }
+
+    const UInt nalBytes = UInt( prefixBytes + nalEnd - nalStart );
+    m_totalBytes += nalBytes;
+    if ( isVcl || nalUnitType == NAL_UNIT_VPS || nalUnitType == NAL_UNIT_SPS || nalUnitType == NAL_UNIT_PPS )
+    {
+      m_essentialBytes += nalBytes;
+    }
+  }
+
+  m_pocBase += maxPOC;
+  m_numSegments++;
+}
+
+// ====================================================================================================================
+// Private member functions
+// ====================================================================================================================
+
+/** rewrite slice_pic_order_cnt_lsb of a slice segment header for the POC base of the chunk
+ * \param rbsp         slice segment NAL unit without emulation prevention bytes
+ * \param nalUnitType  NAL unit type of the slice segment
+ * \param temporalId   TemporalId of the slice segment
+ * \param prevTid0POC  POC of the previous TemporalId 0 picture of the chunk, updated for this picture
+ * \returns POC of the picture within the chunk, 0 for dependent slice segments
+ */
+Int TAppEncParcat::xRebaseSliceHeader( vector<UChar>& rbsp, Int nalUnitType, Int temporalId, Int& prevTid0POC )
+{
+  if ( nalUnitType == NAL_UNIT_CODED_SLICE_IDR_W_RADL || nalUnitType == NAL_UNIT_CODED_SLICE_IDR_N_LP )
+  {
+    m_lastIdrPoc = m_pocBase;
+    prevTid0POC  = 0;
+    return 0;
+  }
+
+  UInt bitPos = 16;
+  const Bool firstSliceSegmentInPic = readBits( rbsp, bitPos, 1 ) != 0;
+  if ( nalUnitType >= NAL_UNIT_CODED_SLICE_BLA_W_LP && nalUnitType <= NAL_UNIT_RESERVED_IRAP_VCL23 )
+  {
+    readBits( rbsp, bitPos, 1 );                            // no_output_of_prior_pics_flag
+  }
+  readUvlc( rbsp, bitPos );                                 // slice_pic_parameter_set_id
+  if ( !firstSliceSegmentInPic )
+  {
+    if ( m_dependentSliceSegmentsEnabled && readBits( rbsp, bitPos, 1 ) )
+    {
+      return 0;                                             // dependent slice segments do not carry the POC
+    }
+    readBits( rbsp, bitPos, m_sliceSegmentAddressBits );    // slice_segment_address
+  }
+  // num_extra_slice_header_bits, output_flag_present_flag and separate_colour_plane_flag are 0 in this encoder
+  readUvlc( rbsp, bitPos );                                 // slice_type
+
+  const UInt pocLsbPos = bitPos;
+  const Int  pocLsb    = readBits( rbsp, bitPos, m_bitsForPOC );
+  const Int  poc       = calcPOC( pocLsb, prevTid0POC, m_bitsForPOC, nalUnitType );
+
+  const Bool isSubLayerNonReference = nalUnitType <= NAL_UNIT_RESERVED_VCL_R15 && ( nalUnitType % 2 ) == 0;
+  const Bool isLeading = nalUnitType >= NAL_UNIT_CODED_SLICE_RADL_N && nalUnitType <= NAL_UNIT_CODED_SLICE_RASL_R;
+  if ( temporalId == 0 && !isSubLayerNonReference && !isLeading )
+  {
+    prevTid0POC = poc;
+  }
+
+  const UInt newPocLsb = UInt( poc + m_pocBase - m_lastIdrPoc ) & ( ( 1u << m_bitsForPOC ) - 1 );
+  writeBits( rbsp, pocLsbPos, m_bitsForPOC, newPocLsb );
+  return poc;
+}
+
+//! \}
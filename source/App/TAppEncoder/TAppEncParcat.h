@@ -0,0 +1,87 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2022, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TAppEncParcat.h
+    \brief    Concatenation of the bitstreams of parallel chunks (header)
+*/
+
+#ifndef __TAPPENCPARCAT__
+#define __TAPPENCPARCAT__
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "TLibCommon/CommonDef.h"
+
+//! \ingroup TAppEncoder
+//! \{
+
+// ====================================================================================================================
+// Class definition
+// ====================================================================================================================
+
+/**
+ Concatenates chunk bitstreams in the same way as the parcat tool.
+ Every chunk after the first starts with an IDR picture that duplicates the last (CRA) picture of the previous chunk.
+ The first access unit of these chunks is dropped and the POC LSBs of their slices are rebased onto the previous chunk.
+ */
+class TAppEncParcat
+{
+private:
+  UInt  m_bitsForPOC;                                       ///< number of bits of slice_pic_order_cnt_lsb
+  Bool  m_dependentSliceSegmentsEnabled;                    ///< dependent_slice_segments_enabled_flag of the PPS
+  UInt  m_sliceSegmentAddressBits;                          ///< number of bits of slice_segment_address
+  Int   m_numSegments;                                      ///< number of chunks written so far
+  Int   m_pocBase;                                          ///< POC of the first picture of the next chunk
+  Int   m_lastIdrPoc;                                       ///< POC of the last IDR picture written
+  UInt  m_totalBytes;                                       ///< bytes written, including start codes
+  UInt  m_essentialBytes;                                   ///< bytes of slices and parameter sets written, including start codes
+
+  Int   xRebaseSliceHeader( std::vector<UChar>& rbsp, Int nalUnitType, Int temporalId, Int& prevTid0POC );
+
+public:
+  TAppEncParcat();
+
+  Void  init              ( UInt bitsForPOC, Bool dependentSliceSegmentsEnabled, UInt sliceSegmentAddressBits );
+  Void  filterSegment     ( const std::string& segment, std::ostream& out );   ///< append the bitstream of the next chunk to out
+
+  UInt  getTotalBytes     () const { return m_totalBytes;     }
+  UInt  getEssentialBytes () const { return m_essentialBytes; }
+
+  static Int calcPOC      ( Int pocLsb, Int prevTid0POC, Int bitsForPOC, Int nalUnitType );
+};// END CLASS DEFINITION TAppEncParcat
+
+//! \}
+
+#endif // __TAPPENCPARCAT__
@@ -42,11 +42,13 @@
 #include <fcntl.h>
 #include <assert.h>
 #include <iomanip>
+#include <sstream>
+#include <thread>
 
 #include "TAppEncTop.h"
+#include "TAppEncParcat.h"
 #include "TLibEncoder/TEncTemporalFilter.h"
 #include "TLibEncoder/AnnexBwrite.h"
-#include "TLibCommon/variables_fg_coding.h"
 
 #if EXTENSION_360_VIDEO
 #include "TAppEncHelper360/TExt360AppEncTop.h"
@@ -66,6 +68,8 @@ TAppEncTop::TAppEncTop()
   m_iFrameRcvd = 0;
   m_totalBytes = 0;
   m_essentialBytes = 0;
+  m_reconFrameOffset = -1;
+  m_numReconFramesToDrop = 0;
 }
 
 TAppEncTop::~TAppEncTop()
@@ -147,8 +151,18 @@ Void TAppEncTop::xInitLibCfg()
   m_cTEncTop.setIntraQpFactor                                     ( m_dIntraQpFactor );
 
   m_cTEncTop.setQP                                                ( m_iQP );
-  setmyQP_fg                                                      (m_iQP_fg);
-  setImagePath                                                    (m_inputMaskPath);
+  m_cTEncTop.setRoiMaskPath                                       ( m_inputMaskPath );
+  m_cTEncTop.setRoiMaskFormat                                     ( m_roiMaskFormat );
+  m_cTEncTop.setRoiMaskInterval                                   ( m_roiMaskInterval );
+  m_cTEncTop.setRoiMaskDilation                                   ( m_roiMaskDilation );
+  m_cTEncTop.setRoiStatsFilename                                  ( m_roiStatsFileName );
+  m_cTEncTop.setRoiForegroundQP                                   ( m_iQP_fg );
+  m_cTEncTop.setRoiLevelToDeltaQPControls                         ( m_roiLevelToDeltaQPMapping );
+  m_cTEncTop.setRoiBackgroundFastDecision                         ( m_roiBackgroundFastDecision );
+  m_cTEncTop.setRoiBackgroundIntraModes                           ( m_roiBackgroundIntraModes );
+  m_cTEncTop.setRoiBackgroundSearchRange                          ( m_roiBackgroundSearchRange );
+  m_cTEncTop.setRoiBackgroundFracSkipThreshold                    ( m_roiBackgroundFracSkipThreshold );
+  m_cTEncTop.setRoiForegroundExtendedSearch                       ( m_roiForegroundExtendedSearch );
 
   m_cTEncTop.setIntraQPOffset                                     ( m_intraQPOffset );
   m_cTEncTop.setLambdaFromQPEnable                                ( m_lambdaFromQPEnable );
@@ -504,6 +518,7 @@ Void TAppEncTop::xInitLibCfg()
   m_cTEncTop.setSEIXSDMetricType                                  ( UChar(m_xsdMetricType) );
   m_cTEncTop.setRegionalNestingSEIFileRoot                        ( m_regionalNestingSEIFileRoot );
   m_cTEncTop.setAnnotatedRegionSEIFileRoot                        (m_arSEIFileRoot);
+  m_cTEncTop.setAnnotatedRegionSEIFromRoiMask                     (m_arSEIFromRoiMask);
   m_cTEncTop.setTileUniformSpacingFlag                            ( m_tileUniformSpacingFlag );
   m_cTEncTop.setNumColumnsMinus1                                  ( m_numTileColumnsMinus1 );
   m_cTEncTop.setNumRowsMinus1                                     ( m_numTileRowsMinus1 );
@@ -519,7 +534,16 @@ Void TAppEncTop::xInitLibCfg()
     m_bLFCrossTileBoundaryFlag = true;
   }
   m_cTEncTop.setLFCrossTileBoundaryFlag                           ( m_bLFCrossTileBoundaryFlag );
+  m_cTEncTop.setNumTileThreads                                    ( m_numTileThreads );
   m_cTEncTop.setEntropyCodingSyncEnabledFlag                      ( m_entropyCodingSyncEnabledFlag );
+  m_cTEncTop.setNumWaveFrontThreads                               ( m_numWaveFrontThreads );
+  m_cTEncTop.setNumFrameThreads                                   ( m_numFrameThreads );
+  m_cTEncTop.setLoopFilterThread                                  ( m_loopFilterThread );
+  m_cTEncTop.setLookaheadThreads                                  ( m_lookaheadThreads );
+  m_cTEncTop.setLookaheadDepth                                    ( m_lookaheadDepth );
+  m_cTEncTop.setSceneCutDetection                                 ( m_sceneCutDetection );
+  m_cTEncTop.setSceneCutThreshold                                 ( m_sceneCutThreshold );
+  m_cTEncTop.setSceneCutMinDistance                               ( m_sceneCutMinDistance );
   m_cTEncTop.setTMVPModeId                                        ( m_TMVPModeId );
   m_cTEncTop.setUseScalingListId                                  ( m_useScalingListId  );
   m_cTEncTop.setScalingListFileName                               ( m_scalingListFileName );
@@ -534,6 +558,8 @@ Void TAppEncTop::xInitLibCfg()
   m_cTEncTop.setCpbSaturationEnabled                              ( m_RCCpbSaturationEnabled );
   m_cTEncTop.setCpbSize                                           ( m_RCCpbSize );
   m_cTEncTop.setInitialCpbFullness                                ( m_RCInitialCpbFullness );
+  m_cTEncTop.setRCRoiForegroundBitShare                           ( m_RCRoiForegroundBitShare );
+  m_cTEncTop.setRCRoiLambdaRatio                                  ( m_RCRoiLambdaRatio );
   m_cTEncTop.setTransquantBypassEnabledFlag                       ( m_TransquantBypassEnabledFlag );
   m_cTEncTop.setCUTransquantBypassFlagForceValue                  ( m_CUTransquantBypassFlagForce );
   m_cTEncTop.setCostMode                                          ( m_costMode );
@@ -593,7 +619,16 @@ Void TAppEncTop::xCreateLib()
 
   if (!m_reconFileName.empty())
   {
-    m_cTVideoIOYuvReconFile.open(m_reconFileName, true, m_outputBitDepth, m_outputBitDepth, m_internalBitDepth);  // write mode
+    if (m_reconFrameOffset >= 0)
+    {
+      // the encoders of parallel chunks write their frames into the file created by the main encoder
+      m_cTVideoIOYuvReconFile.open(m_reconFileName, true, m_outputBitDepth, m_outputBitDepth, m_internalBitDepth, true);  // update mode
+      m_cTVideoIOYuvReconFile.skipFrames(m_reconFrameOffset, m_sourceWidth - m_confWinLeft - m_confWinRight, m_sourceHeight - m_confWinTop - m_confWinBottom, m_chromaFormatIDC);
+    }
+    else
+    {
+      m_cTVideoIOYuvReconFile.open(m_reconFileName, true, m_outputBitDepth, m_outputBitDepth, m_internalBitDepth);  // write mode
+    }
   }
 #if SHUTTER_INTERVAL_SEI_PROCESSING
   if (m_ShutterFilterEnable && !m_shutterIntervalPreFileName.empty())
@@ -648,6 +683,22 @@ Void TAppEncTop::encode()
     exit(EXIT_FAILURE);
   }
 
+  if (m_parallelChunks > 1)
+  {
+    xEncodeChunks(bitstreamFile);
+  }
+  else
+  {
+    xEncode(bitstreamFile);
+  }
+}
+
+// ====================================================================================================================
+// Protected member functions
+// ====================================================================================================================
+
+Void TAppEncTop::xEncode( std::ostream& bitstreamFile )
+{
   TComPicYuv*       pcPicYuvOrg = new TComPicYuv;
   TComPicYuv*       pcPicYuvRec = NULL;
 
@@ -669,7 +720,10 @@ Void TAppEncTop::encode()
   xCreateLib();
   xInitLib(m_isField);
 
-  printChromaFormat();
+  if (!m_isChunkEncoder)
+  {
+    printChromaFormat();
+  }
 
   // main encoder loop
   Int   iNumEncoded = 0;
@@ -704,10 +758,16 @@ Void TAppEncTop::encode()
   if (m_gopBasedTemporalFilterEnabled)
 #endif
   {
+    // the background thread reads the frames to be filtered itself, so it needs them as they are in the file
+    Bool lookaheadPossible = !m_isField && m_InputChromaFormatIDC == m_chromaFormatIDC;
+#if EXTENSION_360_VIDEO
+    lookaheadPossible = lookaheadPossible && !ext360.isEnabled();
+#endif
     temporalFilter.init(m_FrameSkip, m_inputBitDepth, m_MSBExtendedBitDepth, m_internalBitDepth, m_sourceWidth, m_sourceHeight,
       m_sourcePadding, m_framesToBeEncoded, m_bClipInputVideoToRec709Range, m_inputFileName, m_chromaFormatIDC,
       m_inputColourSpaceConvert, m_iQP, m_iGOPSize, m_gopBasedTemporalFilterStrengths,
       m_gopBasedTemporalFilterPastRefs, m_gopBasedTemporalFilterFutureRefs,
+      m_gopBasedTemporalFilterThreads, lookaheadPossible ? m_gopBasedTemporalFilterLookahead : 0,
 #if !JVET_Y0077_BIM
       m_firstValidFrame, m_lastValidFrame);
 #else
@@ -730,7 +790,7 @@ Void TAppEncTop::encode()
     m_temporalFilterForFG.init(m_FrameSkip, m_inputBitDepth, m_MSBExtendedBitDepth, m_internalBitDepth, m_sourceWidth, m_sourceHeight,
       m_sourcePadding, m_framesToBeEncoded, m_bClipInputVideoToRec709Range, m_inputFileName, m_chromaFormatIDC,
       m_inputColourSpaceConvert, m_iQP, m_iGOPSize, filteredFramesAndStrengths,
-      m_gopBasedTemporalFilterPastRefs, m_gopBasedTemporalFilterFutureRefs,
+      m_gopBasedTemporalFilterPastRefs, m_gopBasedTemporalFilterFutureRefs, m_gopBasedTemporalFilterThreads, 0,
 #if !JVET_Y0077_BIM
       m_firstValidFrame, m_lastValidFrame);
 #else
@@ -849,14 +909,111 @@ Void TAppEncTop::encode()
   xDeleteBuffer();
   xDestroyLib();
 
-  printRateSummary();
+  if (!m_isChunkEncoder)
+  {
+    printRateSummary();
+  }
 
   return;
 }
 
-// ====================================================================================================================
-// Protected member functions
-// ====================================================================================================================
+/**
+ - partition the sequence into chunks of whole intra periods, every chunk also encodes the first frame of the next chunk as its last (CRA) picture
+ - encode the chunks in parallel into memory, each with its own encoder configured from the command line
+ - concatenate the chunks in order, dropping the duplicated IDR picture at the start of every chunk but the first and rebasing the POCs
+ .
+ */
+Void TAppEncTop::xEncodeChunks( std::ostream& bitstreamFile )
+{
+  const Int numIntraPeriods = ( m_framesToBeEncoded - 1 + m_iIntraPeriod - 1 ) / m_iIntraPeriod;
+  const Int chunkLength     = std::max( 1, ( numIntraPeriods + m_parallelChunks - 1 ) / m_parallelChunks ) * m_iIntraPeriod;
+
+  std::vector<Int> chunkFirstFrame;
+  for ( Int frame = 0; frame == 0 || frame < m_framesToBeEncoded - 1; frame += chunkLength )
+  {
+    chunkFirstFrame.push_back( frame );
+  }
+  const Int numChunks = Int( chunkFirstFrame.size() );
+
+  if (!m_reconFileName.empty())
+  {
+    // create the file, the chunks then write their frames at their own position
+    fstream reconFile(m_reconFileName.c_str(), fstream::binary | fstream::out);
+    if (!reconFile)
+    {
+      printf("\nfailed to write reconstructed YUV file\n");
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  std::vector<TAppEncTop*>         chunkEncoders( numChunks );
+  std::vector<std::ostringstream>  chunkBitstreams( numChunks );
+  std::vector<std::thread>         chunkThreads;
+  for ( Int chunk = 0; chunk < numChunks; chunk++ )
+  {
+    const Int firstFrame = chunkFirstFrame[chunk];
+    const Int lastFrame  = std::min( firstFrame + chunkLength, m_framesToBeEncoded - 1 );
+
+    std::vector<std::string> args( m_cmdLineArgs );
+    args.push_back( "--FrameSkip=" + std::to_string( m_FrameSkip + firstFrame * m_temporalSubsampleRatio ) );
+    args.push_back( "--FramesToBeEncoded=" + std::to_string( ( lastFrame - firstFrame + 1 ) * m_temporalSubsampleRatio ) );
+    args.push_back( "--ParallelChunks=1" );
+    std::vector<TChar*> argv;
+    for ( std::size_t i = 0; i < args.size(); i++ )
+    {
+      argv.push_back( const_cast<TChar*>( args[i].c_str() ) );
+    }
+
+    TAppEncTop* pcChunkEncoder = new TAppEncTop;
+    pcChunkEncoder->create();
+    pcChunkEncoder->m_isChunkEncoder = true;
+    if ( !pcChunkEncoder->parseCfg( Int( argv.size() ), &argv[0] ) )
+    {
+      fprintf(stderr, "\nfailed to configure the encoder of chunk %d\n", chunk);
+      exit(EXIT_FAILURE);
+    }
+    pcChunkEncoder->m_reconFrameOffset     = firstFrame == 0 ? 0 : firstFrame + 1;
+    pcChunkEncoder->m_numReconFramesToDrop = firstFrame == 0 ? 0 : 1;
+    chunkEncoders[chunk] = pcChunkEncoder;
+
+    printf("Chunk %d: frames %d - %d\n", chunk, firstFrame, lastFrame);
+  }
+  for ( Int chunk = 0; chunk < numChunks; chunk++ )
+  {
+    chunkThreads.push_back( std::thread( &TAppEncTop::xEncode, chunkEncoders[chunk], std::ref( chunkBitstreams[chunk] ) ) );
+  }
+
+  const UInt numCtus = ( ( m_sourceWidth + m_uiMaxCUWidth - 1 ) / m_uiMaxCUWidth ) * ( ( m_sourceHeight + m_uiMaxCUHeight - 1 ) / m_uiMaxCUHeight );
+  UInt sliceSegmentAddressBits = 0;
+  while ( ( 1u << sliceSegmentAddressBits ) < numCtus )
+  {
+    sliceSegmentAddressBits++;
+  }
+  // the encoder signals the default number of POC LSBs of the SPS
+  TAppEncParcat parcat;
+  parcat.init( TComSPS().getBitsForPOC(), m_sliceSegmentMode != NO_SLICES, sliceSegmentAddressBits );
+
+  m_iFrameRcvd = 0;
+  for ( Int chunk = 0; chunk < numChunks; chunk++ )
+  {
+    chunkThreads[chunk].join();
+
+    const std::string segment = chunkBitstreams[chunk].str();
+    chunkBitstreams[chunk].str( std::string() );
+    parcat.filterSegment( segment, bitstreamFile );
+
+    TAppEncTop* pcChunkEncoder = chunkEncoders[chunk];
+    m_iFrameRcvd += std::max( 0, pcChunkEncoder->m_iFrameRcvd - ( chunk > 0 ? 1 : 0 ) );
+    printf("\nChunk %d: %d frames, %u bytes\n", chunk, pcChunkEncoder->m_iFrameRcvd, UInt( segment.size() ));
+    pcChunkEncoder->destroy();
+    delete pcChunkEncoder;
+  }
+
+  m_totalBytes     = parcat.getTotalBytes();
+  m_essentialBytes = parcat.getEssentialBytes();
+  printf("\n");
+  printRateSummary();
+}
 
 /**
  - application has picture buffer list with size of GOP
@@ -955,7 +1112,11 @@ Void TAppEncTop::xWriteOutput(std::ostream& bitstreamFile, Int iNumEncoded, cons
     for ( i = 0; i < iNumEncoded; i++ )
     {
       TComPicYuv*  pcPicYuvRec  = *(iterPicYuvRec++);
-      if (!m_reconFileName.empty())
+      if (m_numReconFramesToDrop > 0)
+      {
+        m_numReconFramesToDrop--;
+      }
+      else if (!m_reconFileName.empty())
       {
         m_cTVideoIOYuvReconFile.write( pcPicYuvRec, ipCSC, m_confWinLeft, m_confWinRight, m_confWinTop, m_confWinBottom,
             NUM_CHROMA_FORMAT, m_bClipOutputVideoToRec709Range  );
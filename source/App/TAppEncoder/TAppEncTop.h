@@ -72,6 +72,9 @@ private:
   UInt m_essentialBytes;
   UInt m_totalBytes;
 
+  Int                        m_reconFrameOffset;            ///< frame of the reconstruction file written first by the encoder of a parallel chunk (-1: create the file)
+  Int                        m_numReconFramesToDrop;        ///< leading reconstructed frames not written (the duplicated IDR picture of a chunk)
+
 protected:
   // initialization
   Void  xCreateLib        ();                               ///< create files & encoder class
@@ -79,6 +82,9 @@ protected:
   Void  xInitLib          (Bool isFieldCoding);             ///< initialize encoder class
   Void  xDestroyLib       ();                               ///< destroy encoder class
 
+  Void  xEncode           ( std::ostream& bitstreamFile );  ///< encode the sequence into bitstreamFile
+  Void  xEncodeChunks     ( std::ostream& bitstreamFile );  ///< encode chunks of whole intra periods in parallel and concatenate them
+
   /// obtain required buffers
   Void xGetBuffer(TComPicYuv*& rpcPicYuvRec);
 
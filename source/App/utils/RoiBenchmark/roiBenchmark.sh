@@ -0,0 +1,178 @@
+#! /bin/bash
+
+# The copyright in this software is being made available under the BSD
+# License, included below. This software may be subject to other third party
+# and contributor rights, including patent rights, and no such rights are
+# granted under this license.
+#
+# Copyright (c) 2010-2022, ITU/ISO/IEC
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+#  * Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+#    be used to endorse or promote products derived from this software without
+#    specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+# BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+# THE POSSIBILITY OF SUCH DAMAGE.
+
+
+# Measures the encoding speed (frames per second), the rate and the quality of ROI-based coding.  Every encoder given
+# with -e is run once per variant given with -x on the same input and mask, and one line is printed per run.  The mask
+# is a centred foreground rectangle written as a binary PGM image, which every encoder version that accepts
+# InputMaskPath can read.  The speed column is the frame rate relative to the first run.
+#
+# Examples (run from the root of the repository):
+#   Cost of the ROI mask handling, e.g. the encoder before and after TEncRoiMap, and the encode without a mask:
+#     roiBenchmark.sh -e old/bin/TAppEncoderStatic -e bin/TAppEncoderStatic -x "" -n -i BQMall_832x480_60.yuv -w 832 -h 480 -r 60
+#   Speed-up of the background fast decision:
+#     roiBenchmark.sh -x "" -x "--RoiBackgroundFastDecision=1" -i BQMall_832x480_60.yuv -w 832 -h 480 -r 60
+
+ROOT_DIRECTORY=$(cd "$(dirname "$0")/../../../.." && pwd)
+
+encoders=()
+variants=()
+baseConfiguration="$ROOT_DIRECTORY/cfg/encoder_randomaccess_main.cfg"
+roiConfiguration="$ROOT_DIRECTORY/cfg/misc/encoder_roi_benchmark.cfg"
+numFrames=17
+qp=37
+frameRate=30
+foregroundPercent=10
+outputDirectory=roiBenchmark
+withoutMask=
+
+function outputUsageAndExit {
+  echo "Usage: $0 -i input -w width -h height [-r frameRate] [-f numFrames] [-q qp] [-e encoder]... [-x \"options\"]... [-n] [-c configuration] [-p foregroundPercent] [-m mask] [-o outputDirectory]" >&2
+  echo "  input is an 8-bit 4:2:0 YUV file of width x height luma samples." >&2
+  echo "  qp is the QP of the background and of the runs without mask (default $qp); the foreground QP is set in cfg/misc/encoder_roi_benchmark.cfg." >&2
+  echo "  encoder is the path of an encoder executable; it may be given several times.  The default is bin/TAppEncoderStatic." >&2
+  echo "  options are extra encoder arguments defining one variant; -x may be given several times.  The default variants are \"\" and \"--RoiBackgroundFastDecision=1\"." >&2
+  echo "  -n adds a run of every encoder without the mask and without $(basename "$roiConfiguration")." >&2
+  echo "  configuration is the main configuration file.  The default is cfg/encoder_randomaccess_main.cfg; cfg/misc/encoder_roi_benchmark.cfg is added on top of it." >&2
+  echo "  foregroundPercent is the share of the picture covered by the generated mask (default $foregroundPercent)." >&2
+  echo "  mask replaces the generated mask by an existing mask file." >&2
+  exit 1
+}
+
+# Write a binary PGM mask of $1 x $2 samples with a centred foreground rectangle covering about $3 percent of the picture
+function writeMask {
+  local width=$1 height=$2
+  local fgWidth=$(awk "BEGIN { print int($width * sqrt($3 / 100.0) / 2) * 2 }")
+  local fgHeight=$(awk "BEGIN { print int($height * sqrt($3 / 100.0) / 2) * 2 }")
+  local left=$(( (width - fgWidth) / 2 ))
+  local top=$(( (height - fgHeight) / 2 ))
+  local row="$outputDirectory/mask_row.bin"
+  { head -c $left /dev/zero; head -c $fgWidth /dev/zero | tr '\0' '\377'; head -c $(( width - left - fgWidth )) /dev/zero; } > "$row"
+  {
+    printf 'P5\n%d %d\n255\n' $width $height
+    head -c $(( width * top )) /dev/zero
+    for (( y = 0; y < fgHeight; y++ )) ; do cat "$row" ; done
+    head -c $(( width * (height - top - fgHeight) )) /dev/zero
+  } > "$4"
+  rm -f "$row"
+}
+
+# Print the frames, time, frame rate, bitrate and PSNRs of the encoder log $1, and the speed relative to the frame rate $2
+function summarizeLog {
+  awk -v referenceFps="$2" '
+    /Total Time:/ { time = $3 }
+    /^SUMMARY/ { summary = 1; next }
+    /^I Slices/ { summary = 0 }
+    summary && $2 == "a" { frames = $1; kbps = $3; psnr = $4 }
+    summary && $1 == "Foreground" { fgPsnr = $4 }
+    summary && $1 == "Background" { bgPsnr = $4 }
+    END {
+      if (frames == "" || time == "") { printf "%7s %9s %8s %8s %10s %8s %8s %8s\n", "-", "-", "-", "-", "-", "-", "-", "-"; exit }
+      fps = frames / time
+      printf "%7d %9.3f %8.3f %8.2f %10.4f %8.4f %8s %8s\n", frames, time, fps, (referenceFps + 0 > 0 ? fps / referenceFps : 1), kbps, psnr, (fgPsnr == "" ? "-" : fgPsnr), (bgPsnr == "" ? "-" : bgPsnr)
+    }' "$1"
+}
+
+while [ "" != "$*" ] ; do
+  case $1 in
+    -n) withoutMask=1 ; shift ; continue ;;
+  esac
+  if [[ $# -lt 2 ]] ; then
+    printf "An argument must follow $1.\n" >&2
+    outputUsageAndExit
+  fi
+  case $1 in
+    -e) encoders+=("$2") ;;
+    -x) variants+=("$2") ;;
+    -i) input=$2 ;;
+    -w) width=$2 ;;
+    -h) height=$2 ;;
+    -r) frameRate=$2 ;;
+    -f) numFrames=$2 ;;
+    -q) qp=$2 ;;
+    -c) baseConfiguration=$2 ;;
+    -p) foregroundPercent=$2 ;;
+    -m) mask=$2 ;;
+    -o) outputDirectory=$2 ;;
+    *)
+      printf "You entered an invalid option: \"$1\".\n" >&2
+      outputUsageAndExit
+      ;;
+  esac
+  shift 2
+done
+
+if [[ "" == $input || "" == $width || "" == $height ]] ; then
+  printf "The input, width and height parameters must be provided.\n" >&2
+  outputUsageAndExit
+fi
+if [[ ${#encoders[@]} -eq 0 ]] ; then
+  encoders=("$ROOT_DIRECTORY/bin/TAppEncoderStatic")
+fi
+if [[ ${#variants[@]} -eq 0 ]] ; then
+  variants=("" "--RoiBackgroundFastDecision=1")
+fi
+
+mkdir -p "$outputDirectory" || exit 1
+if [[ "" == $mask ]] ; then
+  mask="$outputDirectory/mask.pgm"
+  writeMask $width $height $foregroundPercent "$mask"
+fi
+
+printf "%-3s %-40s %-32s %7s %9s %8s %8s %10s %8s %8s %8s\n" run encoder options frames time[s] fps speed kbps Y-PSNR FG-Y BG-Y
+run=0
+for encoder in "${encoders[@]}" ; do
+  runs=("${variants[@]}")
+  if [[ "" != $withoutMask ]] ; then
+    runs=("<no mask>" "${runs[@]}")
+  fi
+  for variant in "${runs[@]}" ; do
+    log="$outputDirectory/run$run.log"
+    if [[ "<no mask>" == $variant ]] ; then
+      roiArguments=()
+      extraArguments=()
+    else
+      roiArguments=(-c "$roiConfiguration" --InputMaskPath="$mask")
+      extraArguments=($variant)
+    fi
+    "$encoder" -c "$baseConfiguration" "${roiArguments[@]}" -i "$input" -wdt $width -hgt $height -fr $frameRate -f $numFrames -q $qp \
+      -b "$outputDirectory/run$run.bin" -o "" "${extraArguments[@]}" > "$log" 2> "$outputDirectory/run$run.err"
+    summary=$(summarizeLog "$log" $referenceFps)
+    printf "%-3d %-40s %-32s %s\n" $run "$(echo "$encoder" | tail -c 40)" "$variant" "$summary"
+    if [[ $run -eq 0 ]] ; then
+      referenceFps=$(echo "$summary" | awk '{ print $3 }')
+    fi
+    run=$(( run + 1 ))
+  done
+done
@@ -0,0 +1,133 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2022, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     SimdKernelTest.cpp
+    \brief    Check of the x86 kernels against the scalar functions, and microbenchmark
+*/
+
+#include <stdio.h>
+#include "SimdKernelTest.h"
+
+#if VECTOR_CODING__X86_DISPATCH
+
+//! \ingroup SimdKernelTest
+//! \{
+
+SimdKernelTest::SimdKernelTest( UInt seed, Int iterations )
+: m_random        ( seed )
+, m_iterations    ( iterations )
+, m_numChecks     ( 0 )
+, m_numMismatches ( 0 )
+{
+  // SSE4.2 and AVX have no kernels of their own, they use the SSE4.1 ones
+  const X86_VEXT extensions[] = { X86_SCALAR, X86_SSE41, X86_AVX2, X86_AVX512 };
+  setX86ExtensionLimit( X86_AVX512 );
+  const X86_VEXT supported = getX86Extension();
+  for( size_t i = 0; i < sizeof( extensions ) / sizeof( extensions[0] ); i++ )
+  {
+    if( extensions[i] <= supported )
+    {
+      m_extensions.push_back( extensions[i] );
+    }
+  }
+}
+
+Void SimdKernelTest::xFillRandom( std::vector<Pel>& buffer, Int minValue, Int maxValue )
+{
+  for( size_t i = 0; i < buffer.size(); i++ )
+  {
+    buffer[i] = Pel( xRandom( minValue, maxValue ) );
+  }
+}
+
+/** Fill two sample buffers with one of five patterns: independent random samples, opposite extreme samples, close
+ *  samples, constant extremes, and random residuals of the full signed range.
+ */
+Void SimdKernelTest::xFillPattern( std::vector<Pel>& org, std::vector<Pel>& cur, Int bitDepth, Int pattern )
+{
+  const Int maxValue = ( 1 << bitDepth ) - 1;
+  for( size_t i = 0; i < org.size(); i++ )
+  {
+    switch( pattern )
+    {
+    case 0:
+      org[i] = Pel( xRandom( 0, maxValue ) );
+      cur[i] = Pel( xRandom( 0, maxValue ) );
+      break;
+    case 1:
+      org[i] = Pel( xRandom( 0, 1 ) * maxValue );
+      cur[i] = Pel( maxValue - org[i] );
+      break;
+    case 2:
+      org[i] = Pel( xRandom( 0, maxValue ) );
+      cur[i] = Pel( Clip3( 0, maxValue, org[i] + xRandom( -4, 4 ) ) );
+      break;
+    case 3:
+      org[i] = Pel( maxValue );
+      cur[i] = 0;
+      break;
+    default:
+      org[i] = Pel( xRandom( -maxValue, maxValue ) );
+      cur[i] = Pel( xRandom( -maxValue, maxValue ) );
+      break;
+    }
+  }
+}
+
+Bool SimdKernelTest::xCompare( const std::string& kernel, X86_VEXT vext, Int64 reference, Int64 value )
+{
+  m_numChecks++;
+  if( value == reference )
+  {
+    return true;
+  }
+  if( m_numMismatches++ < MAX_REPORTED_MISMATCHES )
+  {
+    printf( "MISMATCH %s %s: %lld instead of %lld\n", getX86ExtensionName( vext ), kernel.c_str(), (long long)value, (long long)reference );
+  }
+  return false;
+}
+
+Void SimdKernelTest::xPrintBenchHeader( const TChar* title ) const
+{
+  printf( "\n%-16s", title );
+  for( size_t e = 0; e < m_extensions.size(); e++ )
+  {
+    printf( " %10s", getX86ExtensionName( m_extensions[e] ) );
+  }
+  printf( "   (ns per call)\n" );
+}
+
+//! \}
+
+#endif // VECTOR_CODING__X86_DISPATCH
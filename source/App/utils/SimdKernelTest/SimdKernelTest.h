@@ -0,0 +1,128 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2022, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     SimdKernelTest.h
+    \brief    Check of the x86 kernels against the scalar functions, and microbenchmark (header)
+*/
+
+#ifndef __SIMDKERNELTEST__
+#define __SIMDKERNELTEST__
+
+#include <stdio.h>
+#include <random>
+#include <string>
+#include <vector>
+#include "TLibCommon/CommonDef.h"
+
+#if VECTOR_CODING__X86_DISPATCH
+
+#include "TLibCommon/x86/CommonDefX86.h"
+
+//! \ingroup SimdKernelTest
+//! \{
+
+// ====================================================================================================================
+// Class definition
+// ====================================================================================================================
+
+/// runs the kernels of every extension supported by the CPU on random input and compares them with the scalar functions
+/** The class is a friend of the classes that hold the kernels, so that it can call their function tables directly.
+ */
+class SimdKernelTest
+{
+public:
+  SimdKernelTest( UInt seed, Int iterations );
+
+  // checks: return false on a mismatch
+  Bool  checkRdCost            ();
+  Bool  checkInterpolationFilter();
+  Bool  checkTrQuant           ();
+  Bool  checkPrediction        ();
+  Bool  checkLoopFilter        ();
+
+  // microbenchmarks: print the time per call of every extension for typical block sizes
+  Void  benchRdCost            ();
+  Void  benchInterpolationFilter();
+  Void  benchTrQuant           ();
+  Void  benchPrediction        ();
+  Void  benchLoopFilter        ();
+
+  UInt64 getNumChecks          () const { return m_numChecks; }
+  UInt64 getNumMismatches      () const { return m_numMismatches; }
+
+private:
+  static const UInt64   MAX_REPORTED_MISMATCHES = 20;
+
+  std::vector<X86_VEXT> m_extensions;       ///< X86_SCALAR and the extensions with their own kernels that the CPU supports
+  std::mt19937          m_random;
+  Int                   m_iterations;       ///< random inputs per kernel and bit depth
+  UInt64                m_numChecks;
+  UInt64                m_numMismatches;
+
+  Int   xRandom                ( Int minValue, Int maxValue ) { return std::uniform_int_distribution<Int>( minValue, maxValue )( m_random ); }
+  Void  xFillRandom            ( std::vector<Pel>& buffer, Int minValue, Int maxValue );
+  Void  xFillPattern           ( std::vector<Pel>& org, std::vector<Pel>& cur, Int bitDepth, Int pattern );
+  Bool  xIsReported            () const { return m_numMismatches <= MAX_REPORTED_MISMATCHES; } ///< whether the last mismatch was printed, for the details of the caller
+  Bool  xCompare               ( const std::string& kernel, X86_VEXT vext, Int64 reference, Int64 value );
+  template<typename T>
+  Bool  xCompare               ( const std::string& kernel, X86_VEXT vext, const T* reference, const T* value, Int stride, Int width, Int height );
+  Void  xPrintBenchHeader      ( const TChar* title ) const;
+};
+
+/// compare a block of samples or coefficients
+template<typename T>
+Bool SimdKernelTest::xCompare( const std::string& kernel, X86_VEXT vext, const T* reference, const T* value, Int stride, Int width, Int height )
+{
+  m_numChecks++;
+  for( Int y = 0; y < height; y++ )
+  {
+    for( Int x = 0; x < width; x++ )
+    {
+      if( value[y * stride + x] != reference[y * stride + x] )
+      {
+        if( m_numMismatches++ < MAX_REPORTED_MISMATCHES )
+        {
+          printf( "MISMATCH %s %s at (%d,%d): %d instead of %d\n", getX86ExtensionName( vext ), kernel.c_str(), x, y, Int( value[y * stride + x] ), Int( reference[y * stride + x] ) );
+        }
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+//! \}
+
+#endif // VECTOR_CODING__X86_DISPATCH
+
+#endif // __SIMDKERNELTEST__
@@ -0,0 +1,251 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2022, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     SimdKernelTestInterpolationFilter.cpp
+    \brief    Check and microbenchmark of the interpolation filter kernels of TComInterpolationFilter
+*/
+
+#include <stdio.h>
+#include <chrono>
+#include "SimdKernelTest.h"
+#include "TLibCommon/TComInterpolationFilter.h"
+#include "TLibCommon/TComChromaFormat.h"
+
+#if VECTOR_CODING__X86_DISPATCH
+
+//! \ingroup SimdKernelTest
+//! \{
+
+static const Int IF_STRIDE = 100;
+static const Int IF_ROWS   = 90;
+static const Int IF_MARGIN = 8;          ///< rows and columns of the source in front of the block, for the filter taps
+
+/// a component of a chroma format, with its number of fractional positions
+struct InterpolationComponent
+{
+  ComponentID  compID;
+  ChromaFormat fmt;
+  Int          numFrac;
+};
+
+static const InterpolationComponent s_interpolationComponents[] =
+{
+  { COMPONENT_Y,  CHROMA_420, 4 },
+  { COMPONENT_Cb, CHROMA_420, 8 },
+  { COMPONENT_Cr, CHROMA_422, 4 },
+  { COMPONENT_Cb, CHROMA_444, 4 },
+};
+
+Bool SimdKernelTest::checkInterpolationFilter()
+{
+  const UInt64 numMismatches = m_numMismatches;
+  std::vector<TComInterpolationFilter*> filter;
+  for( size_t e = 0; e < m_extensions.size(); e++ )
+  {
+    setX86ExtensionLimit( m_extensions[e] );
+    filter.push_back( new TComInterpolationFilter );
+    filter.back()->init();
+  }
+  setX86ExtensionLimit( X86_AVX512 );
+
+  static const Int widths [] = { 2, 3, 4, 5, 6, 8, 9, 12, 14, 16, 17, 24, 32, 33, 48, 64, 65 };
+  static const Int heights[] = { 1, 2, 4, 6, 8, 12, 16, 24, 32, 48, 64, 65 };
+  const Int numWidths  = Int( sizeof( widths  ) / sizeof( widths [0] ) );
+  const Int numHeights = Int( sizeof( heights ) / sizeof( heights[0] ) );
+  const Int numComponents = Int( sizeof( s_interpolationComponents ) / sizeof( s_interpolationComponents[0] ) );
+
+  std::vector<Pel> src( IF_STRIDE * IF_ROWS );
+  std::vector<Pel> mid( IF_STRIDE * IF_ROWS );
+  std::vector<Pel> tmp( IF_STRIDE * IF_ROWS );
+  std::vector<Pel> ref( IF_STRIDE * IF_ROWS );
+  std::vector<Pel> dst( IF_STRIDE * IF_ROWS );
+  Pel* const srcBlock = &src[IF_MARGIN * IF_STRIDE + IF_MARGIN];
+  Pel* const midBlock = &mid[IF_MARGIN * IF_STRIDE + IF_MARGIN];
+
+  const Int maxBitDepth = RExt__HIGH_BIT_DEPTH_SUPPORT ? 16 : 12;
+  for( Int bitDepth = 8; bitDepth <= maxBitDepth; bitDepth += 2 )
+  {
+    const Int maxValue = ( 1 << bitDepth ) - 1;
+    for( Int iter = 0; iter < m_iterations; iter++ )
+    {
+      const InterpolationComponent& component = s_interpolationComponents[xRandom( 0, numComponents - 1 )];
+      const Int  numTaps = isLuma( component.compID ) ? NTAPS_LUMA : NTAPS_CHROMA;
+      const Int  width   = widths [xRandom( 0, numWidths  - ( isLuma( component.compID ) ? 1 : 2 ) )];
+      const Int  height  = heights[xRandom( 0, numHeights - 1 )];
+      const Int  fracHor = xRandom( 0, component.numFrac - 1 );
+      const Int  fracVer = xRandom( 1, component.numFrac - 1 );
+      const Bool isFirst = xRandom( 0, 1 ) != 0;
+      const Bool isLast  = xRandom( 0, 1 ) != 0;
+
+      // random samples, extremes of alternating sign, constant extremes, or a mix of them
+      switch( iter % 4 )
+      {
+      case 0:
+        xFillRandom( src, 0, maxValue );
+        break;
+      case 1:
+        for( size_t i = 0; i < src.size(); i++ )
+        {
+          src[i] = Pel( xRandom( 0, 1 ) * maxValue );
+        }
+        break;
+      case 2:
+        xFillRandom( src, maxValue, maxValue );
+        break;
+      default:
+        for( size_t i = 0; i < src.size(); i++ )
+        {
+          const Int r = xRandom( 0, 2 );
+          src[i] = Pel( r == 0 ? 0 : r == 1 ? maxValue : xRandom( 0, maxValue ) );
+        }
+        break;
+      }
+      // the input of a second pass: the intermediate samples of a first pass that is not the last one
+      filter[0]->filterHor( component.compID, &src[IF_MARGIN / 2 * IF_STRIDE + IF_MARGIN / 2], IF_STRIDE, &mid[IF_MARGIN / 2 * IF_STRIDE + IF_MARGIN / 2], IF_STRIDE,
+                            IF_STRIDE - 2 * IF_MARGIN - 4, IF_ROWS - IF_MARGIN - 6, xRandom( 0, component.numFrac - 1 ), false, component.fmt, bitDepth );
+
+      Pel* const verInput = isFirst ? srcBlock : midBlock;
+      filter[0]->filterHor( component.compID, srcBlock, IF_STRIDE, &ref[0], IF_STRIDE, width, height, fracHor, isLast, component.fmt, bitDepth );
+      for( size_t e = 1; e < filter.size(); e++ )
+      {
+        filter[e]->filterHor( component.compID, srcBlock, IF_STRIDE, &dst[0], IF_STRIDE, width, height, fracHor, isLast, component.fmt, bitDepth );
+        if( !xCompare( "filterHor", m_extensions[e], &ref[0], &dst[0], IF_STRIDE, width, height ) && xIsReported() )
+        {
+          printf( "  %d bit, component %d, chroma format %d, %dx%d, frac %d, last %d\n", bitDepth, component.compID, component.fmt, width, height, fracHor, isLast );
+        }
+      }
+
+      filter[0]->filterVer( component.compID, verInput, IF_STRIDE, &ref[0], IF_STRIDE, width, height, fracVer, isFirst, isLast, component.fmt, bitDepth );
+      for( size_t e = 1; e < filter.size(); e++ )
+      {
+        filter[e]->filterVer( component.compID, verInput, IF_STRIDE, &dst[0], IF_STRIDE, width, height, fracVer, isFirst, isLast, component.fmt, bitDepth );
+        if( !xCompare( "filterVer", m_extensions[e], &ref[0], &dst[0], IF_STRIDE, width, height ) && xIsReported() )
+        {
+          printf( "  %d bit, component %d, chroma format %d, %dx%d, frac %d, first %d, last %d\n", bitDepth, component.compID, component.fmt, width, height, fracVer, isFirst, isLast );
+        }
+      }
+
+      if( fracHor != 0 && width <= MAX_CU_SIZE && height <= MAX_CU_SIZE )
+      {
+        // the one-pass filter of every extension, the scalar one included, must give the two passes of the prediction
+        const Int tapRows = numTaps / 2 - 1;
+        filter[0]->filterHor( component.compID, srcBlock - tapRows * IF_STRIDE, IF_STRIDE, &tmp[0], IF_STRIDE, width, height + numTaps - 1, fracHor, false, component.fmt, bitDepth );
+        filter[0]->filterVer( component.compID, &tmp[tapRows * IF_STRIDE], IF_STRIDE, &ref[0], IF_STRIDE, width, height, fracVer, false, isLast, component.fmt, bitDepth );
+        for( size_t e = 0; e < filter.size(); e++ )
+        {
+          filter[e]->filter2D( component.compID, srcBlock, IF_STRIDE, &dst[0], IF_STRIDE, width, height, fracHor, fracVer, isLast, component.fmt, bitDepth );
+          if( !xCompare( "filter2D", m_extensions[e], &ref[0], &dst[0], IF_STRIDE, width, height ) && xIsReported() )
+          {
+            printf( "  %d bit, component %d, chroma format %d, %dx%d, frac %d/%d, last %d\n", bitDepth, component.compID, component.fmt, width, height, fracHor, fracVer, isLast );
+          }
+        }
+      }
+    }
+  }
+
+  for( size_t e = 0; e < filter.size(); e++ )
+  {
+    delete filter[e];
+  }
+  return m_numMismatches == numMismatches;
+}
+
+Void SimdKernelTest::benchInterpolationFilter()
+{
+  std::vector<TComInterpolationFilter*> filter;
+  for( size_t e = 0; e < m_extensions.size(); e++ )
+  {
+    setX86ExtensionLimit( m_extensions[e] );
+    filter.push_back( new TComInterpolationFilter );
+    filter.back()->init();
+  }
+  setX86ExtensionLimit( X86_AVX512 );
+
+  std::vector<Pel> src( IF_STRIDE * IF_ROWS );
+  std::vector<Pel> dst( IF_STRIDE * IF_ROWS );
+  xFillRandom( src, 0, 1023 );
+  Pel* const srcBlock = &src[IF_MARGIN * IF_STRIDE + IF_MARGIN];
+
+  enum Pass { PASS_HOR, PASS_VER, PASS_2D };
+  struct Block { Pass pass; ComponentID compID; const TChar* name; Int width; Int height; };
+  static const Block blocks[] =
+  {
+    { PASS_HOR, COMPONENT_Y,  "Hor 8x8",      8,  8 }, { PASS_HOR, COMPONENT_Y,  "Hor 16x16",   16, 16 },
+    { PASS_HOR, COMPONENT_Y,  "Hor 32x32",   32, 32 }, { PASS_HOR, COMPONENT_Y,  "Hor 64x64",   64, 64 },
+    { PASS_VER, COMPONENT_Y,  "Ver 8x8",      8,  8 }, { PASS_VER, COMPONENT_Y,  "Ver 16x16",   16, 16 },
+    { PASS_VER, COMPONENT_Y,  "Ver 32x32",   32, 32 }, { PASS_VER, COMPONENT_Y,  "Ver 64x64",   64, 64 },
+    { PASS_2D,  COMPONENT_Y,  "2D 8x8",       8,  8 }, { PASS_2D,  COMPONENT_Y,  "2D 16x16",    16, 16 },
+    { PASS_2D,  COMPONENT_Y,  "2D 32x32",    32, 32 }, { PASS_2D,  COMPONENT_Y,  "2D 64x64",    64, 64 },
+    { PASS_HOR, COMPONENT_Cb, "Hor C 4x4",    4,  4 }, { PASS_HOR, COMPONENT_Cb, "Hor C 16x16", 16, 16 },
+    { PASS_2D,  COMPONENT_Cb, "2D C 4x4",     4,  4 }, { PASS_2D,  COMPONENT_Cb, "2D C 16x16",  16, 16 },
+  };
+
+  xPrintBenchHeader( "Interp, 10 bit" );
+  for( size_t b = 0; b < sizeof( blocks ) / sizeof( blocks[0] ); b++ )
+  {
+    const Block& block = blocks[b];
+    printf( "%-16s", block.name );
+    const Int numCalls = 4000000 / ( block.width * block.height ) + 1000;
+    for( size_t e = 0; e < filter.size(); e++ )
+    {
+      const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      for( Int n = 0; n < numCalls; n++ )
+      {
+        switch( block.pass )
+        {
+        case PASS_HOR:
+          filter[e]->filterHor( block.compID, srcBlock + ( n & 7 ), IF_STRIDE, &dst[0], IF_STRIDE, block.width, block.height, 1, true, CHROMA_420, 10 );
+          break;
+        case PASS_VER:
+          filter[e]->filterVer( block.compID, srcBlock + ( n & 7 ), IF_STRIDE, &dst[0], IF_STRIDE, block.width, block.height, 2, true, true, CHROMA_420, 10 );
+          break;
+        default:
+          filter[e]->filter2D( block.compID, srcBlock + ( n & 7 ), IF_STRIDE, &dst[0], IF_STRIDE, block.width, block.height, 1, 3, true, CHROMA_420, 10 );
+          break;
+        }
+      }
+      const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+      printf( " %10.1f", std::chrono::duration<Double, std::nano>( end - start ).count() / numCalls );
+    }
+    printf( "\n" );
+  }
+
+  for( size_t e = 0; e < filter.size(); e++ )
+  {
+    delete filter[e];
+  }
+}
+
+//! \}
+
+#endif // VECTOR_CODING__X86_DISPATCH
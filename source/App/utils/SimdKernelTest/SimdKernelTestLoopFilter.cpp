@@ -0,0 +1,234 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2022, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     SimdKernelTestLoopFilter.cpp
+    \brief    Check and microbenchmark of the deblocking filter kernels of TComLoopFilter
+*/
+
+#include <stdio.h>
+#include <chrono>
+#include "SimdKernelTest.h"
+#include "TLibCommon/TComLoopFilter.h"
+
+#if VECTOR_CODING__X86_DISPATCH
+
+//! \ingroup SimdKernelTest
+//! \{
+
+static const Int LF_STRIDE = MAX_CU_SIZE + 40;   ///< room for the edges of the 8x8 grid that the benchmark filters in turn
+static const Int LF_ROWS   = MAX_CU_SIZE + 40;
+static const Int LF_EDGE   = 8;                  ///< row and column of the first sample of the Q side
+
+/** The edges are filtered with all numbers of lines, both directions and every bit depth, on smooth, noisy, extreme
+ *  and blocky content. tc and beta are taken from the tables of the filter at random QPs; some segments are not
+ *  filtered (beta of 0), and some have a side that is kept as for I_PCM or lossless blocks. The tc of the chroma lines
+ *  varies from line to line. The whole buffer is compared, so that a kernel that changes samples outside of the
+ *  filtered ones is caught too.
+ */
+Bool SimdKernelTest::checkLoopFilter()
+{
+  const UInt64 numMismatches = m_numMismatches;
+  std::vector<TComLoopFilter*> loopFilter;
+  for( size_t e = 0; e < m_extensions.size(); e++ )
+  {
+    setX86ExtensionLimit( m_extensions[e] );
+    loopFilter.push_back( new TComLoopFilter );
+  }
+  setX86ExtensionLimit( X86_AVX512 );
+
+  std::vector<Pel> src( LF_STRIDE * LF_ROWS );
+  std::vector<Pel> ref( LF_STRIDE * LF_ROWS );
+  std::vector<Pel> dst( LF_STRIDE * LF_ROWS );
+  const Int numTc   = Int( sizeof( TComLoopFilter::sm_tcTable   ) / sizeof( TComLoopFilter::sm_tcTable  [0] ) );
+  const Int numBeta = Int( sizeof( TComLoopFilter::sm_betaTable ) / sizeof( TComLoopFilter::sm_betaTable[0] ) );
+
+  // every bit depth, since the kernels change from 16-bit to 32-bit lanes above 11 bits
+  const Int maxBitDepth   = RExt__HIGH_BIT_DEPTH_SUPPORT ? 16 : 12;
+  for( Int bitDepth = 8; bitDepth <= maxBitDepth; bitDepth++ )
+  {
+    const Int maxValue      = ( 1 << bitDepth ) - 1;
+    const Int bitDepthScale = 1 << ( bitDepth - 8 );
+    for( Int iter = 0; iter < m_iterations; iter++ )
+    {
+      const Int pattern = iter % 4;
+      for( Int i = 0; i < LF_STRIDE * LF_ROWS; i++ )
+      {
+        const Int x = i % LF_STRIDE;
+        const Int y = i / LF_STRIDE;
+        switch( pattern )
+        {
+        case 0:  src[i] = Pel( ( x * 3 + y ) % ( maxValue + 1 ) );                                                            break;
+        case 1:  src[i] = Pel( xRandom( 0, maxValue ) );                                                                      break;
+        case 2:  src[i] = Pel( xRandom( 0, 1 ) * maxValue );                                                                  break;
+        default: src[i] = Pel( Clip3( 0, maxValue, ( ( x / 8 ) * 37 + ( y / 8 ) * 11 ) * bitDepthScale + xRandom( -2, 2 ) ) ); break;
+        }
+      }
+
+      const Int   numLines = 4 << xRandom( 0, 4 );
+      LFEdgeParam param;
+      for( Int line = 0; line < numLines; line += 4 )
+      {
+        const Int tc        = TComLoopFilter::sm_tcTable[xRandom( 0, numTc - 1 )] * bitDepthScale;
+        const Int beta      = xRandom( 0, 3 ) ? TComLoopFilter::sm_betaTable[xRandom( 0, numBeta - 1 )] * bitDepthScale : 0;
+        const Int noFilterP = xRandom( 0, 4 ) ? 0 : -1;
+        const Int noFilterQ = xRandom( 0, 4 ) ? 0 : -1;
+        for( Int k = line; k < line + 4; k++ )
+        {
+          param.aiTc       [k] = tc;
+          param.aiBeta     [k] = beta;
+          param.aiNoFilterP[k] = noFilterP;
+          param.aiNoFilterQ[k] = noFilterQ;
+        }
+      }
+
+      for( Int chroma = 0; chroma < 2; chroma++ )
+      {
+        LFEdgeParam edgeParam = param;
+        if( chroma )
+        {
+          for( Int line = 0; line < numLines; line++ )
+          {
+            if( xRandom( 0, 2 ) == 0 )
+            {
+              edgeParam.aiTc[line] = TComLoopFilter::sm_tcTable[xRandom( 0, numTc - 1 )] * bitDepthScale;
+            }
+          }
+        }
+        for( Int edgeDir = 0; edgeDir < NUM_EDGE_DIR; edgeDir++ )
+        {
+          ref = src;
+          if( chroma )
+          {
+            loopFilter[0]->m_afpFilterEdgeChroma[edgeDir]( &ref[LF_EDGE * LF_STRIDE + LF_EDGE], LF_STRIDE, numLines, edgeParam, bitDepth );
+          }
+          else
+          {
+            loopFilter[0]->m_afpFilterEdgeLuma  [edgeDir]( &ref[LF_EDGE * LF_STRIDE + LF_EDGE], LF_STRIDE, numLines, edgeParam, bitDepth );
+          }
+          for( size_t e = 1; e < loopFilter.size(); e++ )
+          {
+            dst = src;
+            if( chroma )
+            {
+              loopFilter[e]->m_afpFilterEdgeChroma[edgeDir]( &dst[LF_EDGE * LF_STRIDE + LF_EDGE], LF_STRIDE, numLines, edgeParam, bitDepth );
+            }
+            else
+            {
+              loopFilter[e]->m_afpFilterEdgeLuma  [edgeDir]( &dst[LF_EDGE * LF_STRIDE + LF_EDGE], LF_STRIDE, numLines, edgeParam, bitDepth );
+            }
+            if( !xCompare( chroma ? "filterEdgeChroma" : "filterEdgeLuma", m_extensions[e], &ref[0], &dst[0], LF_STRIDE, LF_STRIDE, LF_ROWS ) && xIsReported() )
+            {
+              printf( "  %d bit, %s edge, %d lines, pattern %d\n", bitDepth, edgeDir == EDGE_VER ? "vertical" : "horizontal", numLines, pattern );
+            }
+          }
+        }
+      }
+    }
+  }
+
+  for( size_t e = 0; e < loopFilter.size(); e++ )
+  {
+    delete loopFilter[e];
+  }
+  return m_numMismatches == numMismatches;
+}
+
+Void SimdKernelTest::benchLoopFilter()
+{
+  std::vector<TComLoopFilter*> loopFilter;
+  for( size_t e = 0; e < m_extensions.size(); e++ )
+  {
+    setX86ExtensionLimit( m_extensions[e] );
+    loopFilter.push_back( new TComLoopFilter );
+  }
+  setX86ExtensionLimit( X86_AVX512 );
+
+  // blocky content, with all the segments filtered
+  std::vector<Pel> src( LF_STRIDE * LF_ROWS );
+  std::vector<Pel> buf( LF_STRIDE * LF_ROWS );
+  for( Int i = 0; i < LF_STRIDE * LF_ROWS; i++ )
+  {
+    src[i] = Pel( ( ( i % LF_STRIDE ) / 8 * 7 + ( i / LF_STRIDE ) / 8 * 5 + xRandom( 0, 2 ) ) & 255 );
+  }
+  LFEdgeParam param;
+  for( Int line = 0; line < MAX_CU_SIZE; line++ )
+  {
+    param.aiTc       [line] = 4;
+    param.aiBeta     [line] = 40;
+    param.aiNoFilterP[line] = 0;
+    param.aiNoFilterQ[line] = 0;
+  }
+
+  xPrintBenchHeader( "Deblock, 8 bit" );
+  for( Int chroma = 0; chroma < 2; chroma++ )
+  {
+    for( Int edgeDir = 0; edgeDir < NUM_EDGE_DIR; edgeDir++ )
+    {
+      for( Int numLines = 8; numLines <= MAX_CU_SIZE; numLines <<= 1 )
+      {
+        printf( "%-6s %s %2d    ", chroma ? "Chroma" : "Luma", edgeDir == EDGE_VER ? "ver" : "hor", numLines );
+        const Int numCalls = 4000000 / numLines;
+        for( size_t e = 0; e < loopFilter.size(); e++ )
+        {
+          buf = src;
+          const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+          for( Int n = 0; n < numCalls; n++ )
+          {
+            // the edges of the 8x8 grid, so that each call filters content that the previous one changed little
+            Pel* const piSrc = &buf[LF_EDGE * LF_STRIDE + LF_EDGE] + ( n & 3 ) * 8 * ( edgeDir == EDGE_VER ? 1 : LF_STRIDE );
+            if( chroma )
+            {
+              loopFilter[e]->m_afpFilterEdgeChroma[edgeDir]( piSrc, LF_STRIDE, numLines, param, 8 );
+            }
+            else
+            {
+              loopFilter[e]->m_afpFilterEdgeLuma  [edgeDir]( piSrc, LF_STRIDE, numLines, param, 8 );
+            }
+          }
+          const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+          printf( " %10.1f", std::chrono::duration<Double, std::nano>( end - start ).count() / numCalls );
+        }
+        printf( "\n" );
+      }
+    }
+  }
+
+  for( size_t e = 0; e < loopFilter.size(); e++ )
+  {
+    delete loopFilter[e];
+  }
+}
+
+//! \}
+
+#endif // VECTOR_CODING__X86_DISPATCH
@@ -0,0 +1,194 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2022, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     SimdKernelTestPrediction.cpp
+    \brief    Check and microbenchmark of the intra prediction kernels of TComPrediction
+*/
+
+#include <stdio.h>
+#include <chrono>
+#include "SimdKernelTest.h"
+#include "TLibCommon/TComPrediction.h"
+#include "TLibCommon/TComRom.h"
+
+#if VECTOR_CODING__X86_DISPATCH
+
+//! \ingroup SimdKernelTest
+//! \{
+
+static const Int INTRA_NUM_MODES = 35;                      ///< planar, DC and the 33 angular modes
+static const Int INTRA_NUM_REFS  = 2 * MAX_CU_SIZE + 1;
+static const Int INTRA_STRIDE    = MAX_CU_SIZE + 16;
+static const Int INTRA_ROWS      = MAX_CU_SIZE + 1;         ///< one row below the largest block, to catch writes beyond it
+static const Pel INTRA_UNUSED    = -7;                      ///< marks the samples that the prediction must not write
+
+/** Every mode is predicted for each block from random, smooth, extreme and constant reference samples, for luma and
+ *  chroma and with and without the edge filters. The whole destination buffer is compared, so that a kernel that
+ *  writes beyond the block is caught too.
+ */
+Bool SimdKernelTest::checkPrediction()
+{
+  const UInt64 numMismatches = m_numMismatches;
+  initROM();
+  std::vector<TComPrediction*> prediction;
+  for( size_t e = 0; e < m_extensions.size(); e++ )
+  {
+    setX86ExtensionLimit( m_extensions[e] );
+    prediction.push_back( new TComPrediction );
+  }
+  setX86ExtensionLimit( X86_AVX512 );
+
+  std::vector<Pel> refAbove( INTRA_NUM_REFS );
+  std::vector<Pel> refLeft ( INTRA_NUM_REFS );
+  std::vector<Pel> predRef ( INTRA_STRIDE * INTRA_ROWS );
+  std::vector<Pel> pred    ( INTRA_STRIDE * INTRA_ROWS );
+
+  const Int maxBitDepth = RExt__HIGH_BIT_DEPTH_SUPPORT ? 16 : 12;
+  for( Int bitDepth = 8; bitDepth <= maxBitDepth; bitDepth += 2 )
+  {
+    const Int maxValue = ( 1 << bitDepth ) - 1;
+    for( Int iter = 0; iter < m_iterations; iter++ )
+    {
+      const Int         size             = 4 << ( iter % 5 );
+      const ChannelType channelType      = xRandom( 0, 1 ) ? CHANNEL_TYPE_LUMA : CHANNEL_TYPE_CHROMA;
+      const Bool        enableEdgeFilter = xRandom( 0, 3 ) != 0;
+      const Int         pattern          = xRandom( 0, 3 );
+      switch( pattern )
+      {
+      case 0:
+        xFillRandom( refAbove, 0, maxValue );
+        xFillRandom( refLeft,  0, maxValue );
+        break;
+      case 1:
+        refAbove[0] = refLeft[0] = Pel( xRandom( 0, maxValue ) );
+        for( Int i = 1; i < INTRA_NUM_REFS; i++ )
+        {
+          refAbove[i] = Pel( Clip3( 0, maxValue, refAbove[i - 1] + xRandom( -3, 3 ) ) );
+          refLeft [i] = Pel( Clip3( 0, maxValue, refLeft [i - 1] + xRandom( -3, 3 ) ) );
+        }
+        break;
+      case 2:
+        for( Int i = 0; i < INTRA_NUM_REFS; i++ )
+        {
+          refAbove[i] = Pel( xRandom( 0, 1 ) * maxValue );
+          refLeft [i] = Pel( xRandom( 0, 1 ) * maxValue );
+        }
+        break;
+      default:
+        xFillRandom( refAbove, maxValue, maxValue );
+        xFillRandom( refLeft,  0, 0 );
+        break;
+      }
+      refLeft[0] = refAbove[0];
+
+      for( Int mode = 0; mode < INTRA_NUM_MODES; mode++ )
+      {
+        predRef.assign( predRef.size(), INTRA_UNUSED );
+        prediction[0]->xPredIntraMode( bitDepth, &refAbove[0], &refLeft[0], &predRef[0], INTRA_STRIDE, size, size, channelType, mode, enableEdgeFilter );
+        for( size_t e = 1; e < prediction.size(); e++ )
+        {
+          pred.assign( pred.size(), INTRA_UNUSED );
+          prediction[e]->xPredIntraMode( bitDepth, &refAbove[0], &refLeft[0], &pred[0], INTRA_STRIDE, size, size, channelType, mode, enableEdgeFilter );
+          if( !xCompare( "intra prediction", m_extensions[e], &predRef[0], &pred[0], INTRA_STRIDE, INTRA_STRIDE, INTRA_ROWS ) && xIsReported() )
+          {
+            printf( "  %d bit, %dx%d, %s, mode %d, edge filters %d, pattern %d\n", bitDepth, size, size, isLuma( channelType ) ? "luma" : "chroma", mode, enableEdgeFilter, pattern );
+          }
+        }
+      }
+    }
+  }
+
+  for( size_t e = 0; e < prediction.size(); e++ )
+  {
+    delete prediction[e];
+  }
+  destroyROM();
+  return m_numMismatches == numMismatches;
+}
+
+Void SimdKernelTest::benchPrediction()
+{
+  initROM();
+  std::vector<TComPrediction*> prediction;
+  for( size_t e = 0; e < m_extensions.size(); e++ )
+  {
+    setX86ExtensionLimit( m_extensions[e] );
+    prediction.push_back( new TComPrediction );
+  }
+  setX86ExtensionLimit( X86_AVX512 );
+
+  std::vector<Pel> refAbove( INTRA_NUM_REFS );
+  std::vector<Pel> refLeft ( INTRA_NUM_REFS );
+  std::vector<Pel> pred    ( INTRA_STRIDE * INTRA_ROWS );
+  xFillRandom( refAbove, 0, 255 );
+  xFillRandom( refLeft,  0, 255 );
+  refLeft[0] = refAbove[0];
+
+  // planar, DC, and the mean of the angular modes
+  static const TChar* kindNames[] = { "Planar", "DC", "Angular" };
+  xPrintBenchHeader( "Intra, 8 bit" );
+  for( Int kind = 0; kind < 3; kind++ )
+  {
+    for( Int size = 4; size <= MAX_CU_SIZE / 2; size <<= 1 )
+    {
+      printf( "%-7s %2dx%-2d   ", kindNames[kind], size, size );
+      const Int firstMode = kind;
+      const Int lastMode  = kind < 2 ? kind : INTRA_NUM_MODES - 1;
+      const Int numCalls  = 1000000 / ( size * size ) + 1000;
+      for( size_t e = 0; e < prediction.size(); e++ )
+      {
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for( Int n = 0; n < numCalls; n++ )
+        {
+          for( Int mode = firstMode; mode <= lastMode; mode++ )
+          {
+            prediction[e]->xPredIntraMode( 8, &refAbove[0], &refLeft[0], &pred[0], INTRA_STRIDE, size, size, CHANNEL_TYPE_LUMA, mode, true );
+          }
+        }
+        const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        printf( " %10.1f", std::chrono::duration<Double, std::nano>( end - start ).count() / ( Double( numCalls ) * ( lastMode - firstMode + 1 ) ) );
+      }
+      printf( "\n" );
+    }
+  }
+
+  for( size_t e = 0; e < prediction.size(); e++ )
+  {
+    delete prediction[e];
+  }
+  destroyROM();
+}
+
+//! \}
+
+#endif // VECTOR_CODING__X86_DISPATCH
@@ -0,0 +1,228 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2022, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     SimdKernelTestRdCost.cpp
+    \brief    Check and microbenchmark of the distortion kernels of TComRdCost
+*/
+
+#include <stdio.h>
+#include <chrono>
+#include "SimdKernelTest.h"
+#include "TLibCommon/TComRdCost.h"
+
+#if VECTOR_CODING__X86_DISPATCH
+
+//! \ingroup SimdKernelTest
+//! \{
+
+static const Int RDCOST_STRIDE = 80;
+static const Int RDCOST_ROWS   = 72;
+
+/// a distortion function and the block widths it is called with
+struct RdCostFunction
+{
+  DFunc        func;
+  const TChar* name;
+  Int          numWidths;
+  Int          widths[12];
+  Bool         subsampling;      ///< called with iSubShift > 0
+};
+
+static const RdCostFunction s_rdCostFunctions[] =
+{
+  { DF_SSE,    "SSE",    12, { 4, 8, 12, 16, 20, 24, 32, 48, 64, 6, 2, 66 }, false },
+  { DF_SSE4,   "SSE4",    1, { 4 },                                         false },
+  { DF_SSE8,   "SSE8",    1, { 8 },                                         false },
+  { DF_SSE16,  "SSE16",   1, { 16 },                                        false },
+  { DF_SSE32,  "SSE32",   1, { 32 },                                        false },
+  { DF_SSE64,  "SSE64",   1, { 64 },                                        false },
+  { DF_SSE16N, "SSE16N",  4, { 16, 32, 48, 64 },                            false },
+  { DF_SAD,    "SAD",    12, { 4, 8, 12, 16, 24, 32, 48, 64, 2, 6, 14, 66 }, false },
+  { DF_SAD4,   "SAD4",    1, { 4 },                                         true  },
+  { DF_SAD8,   "SAD8",    1, { 8 },                                         true  },
+  { DF_SAD16,  "SAD16",   1, { 16 },                                        true  },
+  { DF_SAD32,  "SAD32",   1, { 32 },                                        true  },
+  { DF_SAD64,  "SAD64",   1, { 64 },                                        true  },
+  { DF_SAD16N, "SAD16N",  4, { 16, 32, 48, 64 },                            true  },
+  { DF_SAD12,  "SAD12",   1, { 12 },                                        true  },
+  { DF_SAD24,  "SAD24",   1, { 24 },                                        true  },
+  { DF_SAD48,  "SAD48",   1, { 48 },                                        true  },
+  { DF_HADS,   "HADS",   10, { 4, 8, 12, 16, 24, 32, 48, 64, 2, 6 },        false },
+};
+
+Bool SimdKernelTest::checkRdCost()
+{
+  const UInt64 numMismatches = m_numMismatches;
+  std::vector<TComRdCost*> rdCost;
+  for( size_t e = 0; e < m_extensions.size(); e++ )
+  {
+    setX86ExtensionLimit( m_extensions[e] );
+    rdCost.push_back( new TComRdCost );
+  }
+  setX86ExtensionLimit( X86_AVX512 );
+
+  std::vector<Pel> org( RDCOST_STRIDE * RDCOST_ROWS + 64 );
+  std::vector<Pel> cur( RDCOST_STRIDE * RDCOST_ROWS + 64 );
+  const Int maxBitDepth = RExt__HIGH_BIT_DEPTH_SUPPORT ? 16 : 12;
+  for( Int bitDepth = 8; bitDepth <= maxBitDepth; bitDepth += 2 )
+  {
+    for( Int iter = 0; iter < m_iterations; iter++ )
+    {
+      xFillPattern( org, cur, bitDepth, iter % 5 );
+      for( size_t f = 0; f < sizeof( s_rdCostFunctions ) / sizeof( s_rdCostFunctions[0] ); f++ )
+      {
+        const RdCostFunction& function = s_rdCostFunctions[f];
+        const Int width  = function.widths[xRandom( 0, function.numWidths - 1 )];
+        Int       height = 4 << xRandom( 0, 4 );
+        if( function.func == DF_HADS )
+        {
+          static const Int hadHeights[] = { 2, 4, 6, 8, 12, 16, 24, 32, 64 };
+          height = hadHeights[xRandom( 0, 8 )];
+          if( ( width & 1 ) || ( height & 1 ) )
+          {
+            continue;
+          }
+        }
+        else if( function.func == DF_SSE || function.func == DF_SAD )
+        {
+          height = xRandom( 1, 64 );
+        }
+#if VECTOR_CODING__DISTORTION_CALCULATIONS && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
+        if( function.func == DF_SAD && bitDepth <= 10 && ( width & 3 ) )
+        {
+          // the SSE2 path of the scalar function needs a multiple of 4 columns
+          continue;
+        }
+#endif
+
+        DistParam distParam;
+        distParam.pOrg       = &org[xRandom( 0, 7 )];
+        distParam.pCur       = &cur[xRandom( 0, 7 )];
+        distParam.iStrideOrg = RDCOST_STRIDE;
+        distParam.iStrideCur = RDCOST_STRIDE - xRandom( 0, 2 );
+        distParam.iCols      = width;
+        distParam.iRows      = height;
+        distParam.bitDepth   = bitDepth;
+        distParam.iSubShift  = function.subsampling ? xRandom( 0, 2 ) : 0;
+        if( ( ( height >> distParam.iSubShift ) << distParam.iSubShift ) != height )
+        {
+          distParam.iSubShift = 0;
+        }
+        if( function.func == DF_SAD && bitDepth > 10 && xRandom( 0, 1 ) )
+        {
+          distParam.m_maximumDistortionForEarlyExit = xRandom( 0, 64 * 64 * 64 );
+        }
+
+        const Distortion reference = rdCost[0]->m_afpDistortFunc[function.func]( &distParam );
+        for( size_t e = 1; e < rdCost.size(); e++ )
+        {
+          const Distortion value = rdCost[e]->m_afpDistortFunc[function.func]( &distParam );
+          if( !xCompare( function.name, m_extensions[e], Int64( reference ), Int64( value ) ) && xIsReported() )
+          {
+            printf( "  %d bit, %dx%d, subsampling shift %d\n", bitDepth, width, height, distParam.iSubShift );
+          }
+        }
+      }
+    }
+  }
+
+  for( size_t e = 0; e < rdCost.size(); e++ )
+  {
+    delete rdCost[e];
+  }
+  return m_numMismatches == numMismatches;
+}
+
+Void SimdKernelTest::benchRdCost()
+{
+  std::vector<TComRdCost*> rdCost;
+  for( size_t e = 0; e < m_extensions.size(); e++ )
+  {
+    setX86ExtensionLimit( m_extensions[e] );
+    rdCost.push_back( new TComRdCost );
+  }
+  setX86ExtensionLimit( X86_AVX512 );
+
+  std::vector<Pel> org( RDCOST_STRIDE * RDCOST_ROWS + 64 );
+  std::vector<Pel> cur( RDCOST_STRIDE * RDCOST_ROWS + 64 );
+  xFillRandom( org, 0, 1023 );
+  xFillRandom( cur, 0, 1023 );
+
+  struct Block { DFunc func; const TChar* name; Int width; Int height; };
+  static const Block blocks[] =
+  {
+    { DF_SAD4,  "SAD 4x4",    4,  4 }, { DF_SAD8,  "SAD 8x8",    8,  8 }, { DF_SAD16, "SAD 16x16",  16, 16 },
+    { DF_SAD32, "SAD 32x32", 32, 32 }, { DF_SAD64, "SAD 64x64", 64, 64 },
+    { DF_SAD12, "SAD 12x16", 12, 16 }, { DF_SAD24, "SAD 24x32", 24, 32 }, { DF_SAD48, "SAD 48x64",  48, 64 },
+    { DF_SSE4,  "SSE 4x4",    4,  4 }, { DF_SSE8,  "SSE 8x8",    8,  8 }, { DF_SSE16, "SSE 16x16",  16, 16 },
+    { DF_SSE32, "SSE 32x32", 32, 32 }, { DF_SSE64, "SSE 64x64", 64, 64 },
+    { DF_HADS,  "HAD 4x4",    4,  4 }, { DF_HADS,  "HAD 8x8",    8,  8 }, { DF_HADS,  "HAD 16x16",  16, 16 },
+    { DF_HADS,  "HAD 32x32", 32, 32 }, { DF_HADS,  "HAD 64x64", 64, 64 }, { DF_HADS,  "HAD 12x16",  12, 16 },
+  };
+
+  xPrintBenchHeader( "RdCost, 10 bit" );
+  for( size_t b = 0; b < sizeof( blocks ) / sizeof( blocks[0] ); b++ )
+  {
+    printf( "%-16s", blocks[b].name );
+    const Int numCalls = 4000000 / ( blocks[b].width * blocks[b].height ) + 1000;
+    for( size_t e = 0; e < rdCost.size(); e++ )
+    {
+      DistParam distParam;
+      distParam.pOrg       = &org[0];
+      distParam.iStrideOrg = RDCOST_STRIDE;
+      distParam.iStrideCur = RDCOST_STRIDE;
+      distParam.iCols      = blocks[b].width;
+      distParam.iRows      = blocks[b].height;
+      distParam.bitDepth   = 10;
+      volatile Distortion sink = 0;
+      const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      for( Int n = 0; n < numCalls; n++ )
+      {
+        distParam.pCur = &cur[n & 7];
+        sink = sink + rdCost[e]->m_afpDistortFunc[blocks[b].func]( &distParam );
+      }
+      const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+      printf( " %10.1f", std::chrono::duration<Double, std::nano>( end - start ).count() / numCalls );
+    }
+    printf( "\n" );
+  }
+
+  for( size_t e = 0; e < rdCost.size(); e++ )
+  {
+    delete rdCost[e];
+  }
+}
+
+//! \}
+
+#endif // VECTOR_CODING__X86_DISPATCH
@@ -0,0 +1,331 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2022, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     SimdKernelTestTrQuant.cpp
+    \brief    Check and microbenchmark of the transform and quantisation kernels of TComTrQuant
+*/
+
+#include <stdio.h>
+#include <chrono>
+#include "SimdKernelTest.h"
+#include "TLibCommon/TComTrQuant.h"
+#include "TLibCommon/TComRom.h"
+
+#if VECTOR_CODING__X86_DISPATCH
+
+//! \ingroup SimdKernelTest
+//! \{
+
+static const Int TRQUANT_STRIDE       = MAX_TU_SIZE + 8;
+static const Int TRQUANT_NUM_SAMPLES  = TRQUANT_STRIDE * MAX_TU_SIZE;
+static const Int TRQUANT_NUM_COEFF    = MAX_TU_SIZE * MAX_TU_SIZE;
+
+/** The transforms are checked for every TU size and bit depth, with the dynamic range of the coefficients of the
+ *  normal profiles (15 bits) and, where it differs, with that of extended precision processing (bit depth + 6, which
+ *  goes up to 18 bits for 12-bit video). The quantisation parameters are derived as in TComTrQuant from a random QP,
+ *  with and without random scaling lists, with and without the adaptive reconstruction levels (ARL) of the adaptive
+ *  QP selection, and with the transform shift clipped to 0 as for transform skip with extended precision.
+ */
+Bool SimdKernelTest::checkTrQuant()
+{
+  const UInt64 numMismatches = m_numMismatches;
+  initROM();
+  std::vector<TComTrQuant*> trQuant;
+  for( size_t e = 0; e < m_extensions.size(); e++ )
+  {
+    setX86ExtensionLimit( m_extensions[e] );
+    trQuant.push_back( new TComTrQuant );
+    trQuant.back()->init( MAX_TU_SIZE );
+  }
+  setX86ExtensionLimit( X86_AVX512 );
+
+  std::vector<Pel>    resi    ( TRQUANT_NUM_SAMPLES );
+  std::vector<Pel>    resiRef ( TRQUANT_NUM_SAMPLES );
+  std::vector<Pel>    resiOut ( TRQUANT_NUM_SAMPLES );
+  std::vector<TCoeff> coeff   ( TRQUANT_NUM_COEFF );
+  std::vector<TCoeff> coeffRef( TRQUANT_NUM_COEFF );
+  std::vector<TCoeff> coeffOut( TRQUANT_NUM_COEFF );
+  std::vector<TCoeff> levelRef( TRQUANT_NUM_COEFF ), levelOut( TRQUANT_NUM_COEFF );
+  std::vector<TCoeff> deltaRef( TRQUANT_NUM_COEFF ), deltaOut( TRQUANT_NUM_COEFF );
+  std::vector<TCoeff> arlRef  ( TRQUANT_NUM_COEFF ), arlOut  ( TRQUANT_NUM_COEFF );
+  std::vector<Int>    quantCoeff  ( TRQUANT_NUM_COEFF );
+  std::vector<Int>    dequantCoeff( TRQUANT_NUM_COEFF );
+
+  const Int maxBitDepth = RExt__HIGH_BIT_DEPTH_SUPPORT ? 16 : 12;
+  for( Int bitDepth = 8; bitDepth <= maxBitDepth; bitDepth++ )
+  {
+    for( Int extendedPrecision = 0; extendedPrecision < 2; extendedPrecision++ )
+    {
+      const Int maxLog2TrDynamicRange = extendedPrecision ? std::max<Int>( 15, bitDepth + 6 ) : 15;
+      if( extendedPrecision && maxLog2TrDynamicRange == 15 )
+      {
+        continue;
+      }
+      const TCoeff coeffMinimum = -( 1 << maxLog2TrDynamicRange );
+      const TCoeff coeffMaximum =  ( 1 << maxLog2TrDynamicRange ) - 1;
+      const Int    maxResi      = ( 1 << bitDepth ) - 1;
+
+      for( Int iter = 0; iter < m_iterations; iter++ )
+      {
+        // every TU size in turn, and the DST of 4x4 luma intra blocks
+        const Int  log2TrSize = 2 + iter % 4;
+        const Int  size       = 1 << log2TrSize;
+        const Bool useDST     = log2TrSize == 2 && ( iter / 4 ) % 2 == 1;
+        const Int  numCoeff   = size * size;
+        const Int  stride     = size + xRandom( 0, TRQUANT_STRIDE - size );
+        const Int  pattern    = xRandom( 0, 4 );
+
+        // residuals: random, small, extreme, alternating extremes, and the doubled range of cross-component prediction
+        const Int  resiRange  = pattern == 4 ? std::min<Int>( 2 * maxResi + 1, std::numeric_limits<Pel>::max() ) : maxResi;
+        for( Int i = 0; i < TRQUANT_NUM_SAMPLES; i++ )
+        {
+          switch( pattern )
+          {
+          case 1:  resi[i] = Pel( xRandom( -8, 8 ) );                            break;
+          case 2:  resi[i] = Pel( xRandom( 0, 1 ) ? resiRange : -resiRange );    break;
+          case 3:  resi[i] = Pel( ( i & 1 ) ? resiRange : -resiRange );          break;
+          default: resi[i] = Pel( xRandom( -resiRange, resiRange ) );            break;
+          }
+        }
+
+        TComTrQuant::xTrBlock( bitDepth, useDST, &resi[0], stride, &coeffRef[0], size, size, maxLog2TrDynamicRange );
+        for( size_t e = 1; e < trQuant.size(); e++ )
+        {
+          trQuant[e]->m_fpTransform( bitDepth, useDST, &resi[0], stride, &coeffOut[0], size, size, maxLog2TrDynamicRange );
+          if( !xCompare( "transform", m_extensions[e], &coeffRef[0], &coeffOut[0], size, size, size ) && xIsReported() )
+          {
+            printf( "  %d bit, dynamic range %d, %dx%d%s, pattern %d\n", bitDepth, maxLog2TrDynamicRange, size, size, useDST ? " DST" : "", pattern );
+          }
+        }
+
+        // coefficients of the inverse transform: random in the dynamic range, small, extreme, 16-bit, or a few low frequencies
+        for( Int i = 0; i < numCoeff; i++ )
+        {
+          switch( pattern )
+          {
+          case 0:  coeff[i] = xRandom( coeffMinimum, coeffMaximum );                           break;
+          case 1:  coeff[i] = xRandom( -64, 64 );                                               break;
+          case 2:  coeff[i] = xRandom( 0, 1 ) ? coeffMaximum : coeffMinimum;                    break;
+          case 3:  coeff[i] = xRandom( -32768, 32767 );                                         break;
+          default: coeff[i] = i < 8 ? xRandom( coeffMinimum, coeffMaximum ) : 0;                break;
+          }
+        }
+        TComTrQuant::xITrBlock( bitDepth, useDST, &coeff[0], &resiRef[0], stride, size, size, maxLog2TrDynamicRange );
+        for( size_t e = 1; e < trQuant.size(); e++ )
+        {
+          trQuant[e]->m_fpInvTransform( bitDepth, useDST, &coeff[0], &resiOut[0], stride, size, size, maxLog2TrDynamicRange );
+          if( !xCompare( "inverse transform", m_extensions[e], &resiRef[0], &resiOut[0], stride, size, size ) && xIsReported() )
+          {
+            printf( "  %d bit, dynamic range %d, %dx%d%s, pattern %d\n", bitDepth, maxLog2TrDynamicRange, size, size, useDST ? " DST" : "", pattern );
+          }
+        }
+
+        // quantisation parameters as derived in TComTrQuant::xQuant, xNeedRDOQ and xDeQuant
+        const Int  qp              = xRandom( 0, 51 + 6 * ( bitDepth - 8 ) );
+        const Int  qpPer           = qp / 6;
+        const Int  qpRem           = qp % 6;
+        const Bool clipShiftTo0    = extendedPrecision && xRandom( 0, 1 );
+        const Int  transformShift  = clipShiftTo0 ? std::max<Int>( 0, getTransformShift( bitDepth, log2TrSize, maxLog2TrDynamicRange ) )
+                                                  : getTransformShift( bitDepth, log2TrSize, maxLog2TrDynamicRange );
+        const Bool useScalingList  = xRandom( 0, 1 ) != 0;
+        const Bool useArl          = xRandom( 0, 1 ) != 0;
+        for( Int i = 0; i < numCoeff; i++ )
+        {
+          const Int scalingFactor = xRandom( 0, 3 ) ? xRandom( 1, 255 ) : 16;
+          quantCoeff[i]   = ( g_quantScales[qpRem] << LOG2_SCALING_LIST_NEUTRAL_VALUE ) / scalingFactor;
+          dequantCoeff[i] = g_invQuantScales[qpRem] * scalingFactor;
+        }
+        const Int* const quantScalingList   = useScalingList ? &quantCoeff[0]   : NULL;
+        const Int* const dequantScalingList = useScalingList ? &dequantCoeff[0] : NULL;
+
+        const Int qBits  = QUANT_SHIFT + qpPer + transformShift;
+        const Int add    = ( xRandom( 0, 1 ) ? 171 : 85 ) << ( qBits - 9 );
+        const Int qBitsC = useArl ? qBits - ARL_C_PRECISION : MAX_INT;
+        const Int addC   = useArl ? 1 << ( qBitsC - 1 )     : MAX_INT;
+
+        // quantise the forward transform, or random coefficients of the dynamic range, sometimes beyond it
+        if( xRandom( 0, 1 ) )
+        {
+          coeff.assign( coeffRef.begin(), coeffRef.end() );
+        }
+        else
+        {
+          const Int coeffRange = xRandom( 0, 3 ) ? coeffMaximum : ( 1 << 20 );
+          for( Int i = 0; i < numCoeff; i++ )
+          {
+            coeff[i] = xRandom( 0, 2 ) ? xRandom( -coeffRange, coeffRange ) : 0;
+          }
+        }
+        const TCoeff absSumRef = TComTrQuant::xQuantBlock( &coeff[0], &levelRef[0], useArl ? &arlRef[0] : NULL, &deltaRef[0], numCoeff, quantScalingList, g_quantScales[qpRem],
+                                                           qBits, add, qBitsC, addC, coeffMinimum, coeffMaximum );
+        for( size_t e = 1; e < trQuant.size(); e++ )
+        {
+          const TCoeff absSum = trQuant[e]->m_fpQuant( &coeff[0], &levelOut[0], useArl ? &arlOut[0] : NULL, &deltaOut[0], numCoeff, quantScalingList, g_quantScales[qpRem],
+                                                       qBits, add, qBitsC, addC, coeffMinimum, coeffMaximum );
+          Bool match = xCompare( "quant sum", m_extensions[e], Int64( absSumRef ), Int64( absSum ) );
+          match = xCompare( "quant", m_extensions[e], &levelRef[0], &levelOut[0], size, size, size ) && match;
+          match = xCompare( "quant delta", m_extensions[e], &deltaRef[0], &deltaOut[0], size, size, size ) && match;
+          if( useArl )
+          {
+            match = xCompare( "quant ARL", m_extensions[e], &arlRef[0], &arlOut[0], size, size, size ) && match;
+          }
+          if( !match && xIsReported() )
+          {
+            printf( "  %d bit, dynamic range %d, %dx%d, QP %d, transform shift %d, scaling list %d, ARL %d\n", bitDepth, maxLog2TrDynamicRange, size, size, qp, transformShift, useScalingList, useArl );
+          }
+        }
+
+        // the check of selective RDOQ, on the coefficients above and on sparse small ones
+        const Int addRDOQ = ( xRandom( 0, 1 ) ? 171 : 256 ) << ( qBits - 9 );
+        for( Int sparse = 0; sparse < 2; sparse++ )
+        {
+          if( sparse )
+          {
+            for( Int i = 0; i < numCoeff; i++ )
+            {
+              coeff[i] = xRandom( 0, 30 ) ? 0 : xRandom( -3, 3 );
+            }
+          }
+          const Bool needRDOQRef = TComTrQuant::xNeedRDOQBlock( &coeff[0], numCoeff, quantScalingList, g_quantScales[qpRem], qBits, addRDOQ );
+          for( size_t e = 1; e < trQuant.size(); e++ )
+          {
+            const Bool needRDOQ = trQuant[e]->m_fpNeedRDOQ( &coeff[0], numCoeff, quantScalingList, g_quantScales[qpRem], qBits, addRDOQ );
+            if( !xCompare( "needRDOQ", m_extensions[e], Int64( needRDOQRef ), Int64( needRDOQ ) ) && xIsReported() )
+            {
+              printf( "  %d bit, dynamic range %d, %dx%d, QP %d, scaling list %d, sparse %d\n", bitDepth, maxLog2TrDynamicRange, size, size, qp, useScalingList, sparse );
+            }
+          }
+        }
+
+        // dequantisation of levels of the dynamic range, and beyond it to exercise the input clipping
+        const Int rightShift  = ( IQUANT_SHIFT - ( transformShift + qpPer ) ) + ( useScalingList ? LOG2_SCALING_LIST_NEUTRAL_VALUE : 0 );
+        const Int scaleBits   = useScalingList ? ( 1 + IQUANT_SHIFT + SCALING_LIST_BITS ) : ( IQUANT_SHIFT + 1 );
+        const Int inputBits   = std::min<Int>( maxLog2TrDynamicRange + 1, Int( sizeof( Intermediate_Int ) * 8 ) + rightShift - scaleBits );
+        const Intermediate_Int inputMinimum = -( 1 << ( inputBits - 1 ) );
+        const Intermediate_Int inputMaximum =  ( 1 << ( inputBits - 1 ) ) - 1;
+        for( Int i = 0; i < numCoeff; i++ )
+        {
+          coeff[i] = xRandom( 0, 2 ) ? xRandom( -200, 200 ) : xRandom( 2 * coeffMinimum, 2 * coeffMaximum );
+        }
+        TComTrQuant::xDeQuantBlock( &coeff[0], &coeffRef[0], numCoeff, dequantScalingList, g_invQuantScales[qpRem], rightShift,
+                                    inputMinimum, inputMaximum, coeffMinimum, coeffMaximum );
+        for( size_t e = 1; e < trQuant.size(); e++ )
+        {
+          trQuant[e]->m_fpDeQuant( &coeff[0], &coeffOut[0], numCoeff, dequantScalingList, g_invQuantScales[qpRem], rightShift,
+                                   inputMinimum, inputMaximum, coeffMinimum, coeffMaximum );
+          if( !xCompare( "dequant", m_extensions[e], &coeffRef[0], &coeffOut[0], size, size, size ) && xIsReported() )
+          {
+            printf( "  %d bit, dynamic range %d, %dx%d, QP %d, shift %d, scaling list %d\n", bitDepth, maxLog2TrDynamicRange, size, size, qp, rightShift, useScalingList );
+          }
+        }
+      }
+    }
+  }
+
+  for( size_t e = 0; e < trQuant.size(); e++ )
+  {
+    delete trQuant[e];
+  }
+  destroyROM();
+  return m_numMismatches == numMismatches;
+}
+
+Void SimdKernelTest::benchTrQuant()
+{
+  initROM();
+  std::vector<TComTrQuant*> trQuant;
+  for( size_t e = 0; e < m_extensions.size(); e++ )
+  {
+    setX86ExtensionLimit( m_extensions[e] );
+    trQuant.push_back( new TComTrQuant );
+    trQuant.back()->init( MAX_TU_SIZE );
+  }
+  setX86ExtensionLimit( X86_AVX512 );
+
+  std::vector<Pel>    resi ( TRQUANT_NUM_SAMPLES );
+  std::vector<TCoeff> coeff( TRQUANT_NUM_COEFF );
+  std::vector<TCoeff> level( TRQUANT_NUM_COEFF );
+  std::vector<TCoeff> delta( TRQUANT_NUM_COEFF );
+  xFillRandom( resi, -255, 255 );
+
+  enum Kernel { KERNEL_TRANSFORM, KERNEL_INV_TRANSFORM, KERNEL_QUANT, KERNEL_DEQUANT };
+  static const TChar* kernelNames[] = { "Fwd", "Inv", "Quant", "DeQuant" };
+
+  xPrintBenchHeader( "TrQuant, 8 bit" );
+  for( Int kernel = KERNEL_TRANSFORM; kernel <= KERNEL_DEQUANT; kernel++ )
+  {
+    for( Int size = 4; size <= MAX_TU_SIZE; size <<= 1 )
+    {
+      printf( "%-7s %2dx%-2d   ", kernelNames[kernel], size, size );
+      const Int numCalls = 2000000 / ( size * size ) + 1000;
+      for( size_t e = 0; e < trQuant.size(); e++ )
+      {
+        TComTrQuant& tq = *trQuant[e];
+        tq.m_fpTransform( 8, false, &resi[0], size, &coeff[0], size, size, 15 );
+        volatile TCoeff sink = 0;
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for( Int n = 0; n < numCalls; n++ )
+        {
+          switch( kernel )
+          {
+          case KERNEL_TRANSFORM:
+            tq.m_fpTransform( 8, false, &resi[n & 7], size, &coeff[0], size, size, 15 );
+            break;
+          case KERNEL_INV_TRANSFORM:
+            tq.m_fpInvTransform( 8, false, &coeff[0], &resi[n & 7], TRQUANT_STRIDE, size, size, 15 );
+            break;
+          case KERNEL_QUANT:
+            sink = sink + tq.m_fpQuant( &coeff[0], &level[0], NULL, &delta[0], size * size, NULL, g_quantScales[4], 20, 171 << 11, MAX_INT, MAX_INT, -32768, 32767 );
+            break;
+          default:
+            tq.m_fpDeQuant( &level[0], &delta[0], size * size, NULL, g_invQuantScales[4], 6, -32768, 32767, -32768, 32767 );
+            break;
+          }
+        }
+        const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        printf( " %10.1f", std::chrono::duration<Double, std::nano>( end - start ).count() / numCalls );
+      }
+      printf( "\n" );
+    }
+  }
+
+  for( size_t e = 0; e < trQuant.size(); e++ )
+  {
+    delete trQuant[e];
+  }
+  destroyROM();
+}
+
+//! \}
+
+#endif // VECTOR_CODING__X86_DISPATCH
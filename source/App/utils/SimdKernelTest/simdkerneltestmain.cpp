@@ -0,0 +1,167 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2022, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     simdkerneltestmain.cpp
+    \brief    Check of the x86 kernels against the scalar functions, and microbenchmark
+    \details  Usage: SimdKernelTest [--bench] [--seed=N] [--iterations=N] [group ...]
+              Without groups, all the groups of kernels are checked (and benchmarked with --bench).
+              The exit code is non-zero if a kernel gives a different result than the scalar function.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "SimdKernelTest.h"
+
+//! \ingroup SimdKernelTest
+//! \{
+
+#if VECTOR_CODING__X86_DISPATCH
+
+/// a group of kernels, named after the class that holds them
+struct KernelGroup
+{
+  const TChar* name;
+  Bool ( SimdKernelTest::*check )();
+  Void ( SimdKernelTest::*bench )();
+};
+
+static const KernelGroup s_kernelGroups[] =
+{
+  { "RdCost",              &SimdKernelTest::checkRdCost,              &SimdKernelTest::benchRdCost              },
+  { "InterpolationFilter", &SimdKernelTest::checkInterpolationFilter, &SimdKernelTest::benchInterpolationFilter },
+  { "TrQuant",             &SimdKernelTest::checkTrQuant,             &SimdKernelTest::benchTrQuant             },
+  { "Prediction",          &SimdKernelTest::checkPrediction,          &SimdKernelTest::benchPrediction          },
+  { "LoopFilter",          &SimdKernelTest::checkLoopFilter,          &SimdKernelTest::benchLoopFilter          },
+};
+
+static const size_t NUM_KERNEL_GROUPS = sizeof( s_kernelGroups ) / sizeof( s_kernelGroups[0] );
+
+static Void printUsage()
+{
+  printf( "Usage: SimdKernelTest [--bench] [--seed=N] [--iterations=N] [group ...]\n" );
+  printf( "  --bench         also print the time per call of the kernels of every extension\n" );
+  printf( "  --seed=N        seed of the random input (default 1)\n" );
+  printf( "  --iterations=N  random inputs per kernel and bit depth (default 1000)\n" );
+  printf( "  groups:" );
+  for( size_t g = 0; g < NUM_KERNEL_GROUPS; g++ )
+  {
+    printf( " %s", s_kernelGroups[g].name );
+  }
+  printf( " (default: all)\n" );
+}
+
+// ====================================================================================================================
+// Main function
+// ====================================================================================================================
+
+int main( int argc, char* argv[] )
+{
+  Bool bench      = false;
+  UInt seed       = 1;
+  Int  iterations = 1000;
+  std::vector<size_t> groups;
+  for( Int i = 1; i < argc; i++ )
+  {
+    if( !strcmp( argv[i], "--bench" ) )
+    {
+      bench = true;
+    }
+    else if( !strncmp( argv[i], "--seed=", 7 ) )
+    {
+      seed = UInt( strtoul( argv[i] + 7, NULL, 10 ) );
+    }
+    else if( !strncmp( argv[i], "--iterations=", 13 ) )
+    {
+      iterations = atoi( argv[i] + 13 );
+    }
+    else
+    {
+      size_t g = 0;
+      while( g < NUM_KERNEL_GROUPS && strcmp( argv[i], s_kernelGroups[g].name ) )
+      {
+        g++;
+      }
+      if( g == NUM_KERNEL_GROUPS )
+      {
+        printUsage();
+        return EXIT_FAILURE;
+      }
+      groups.push_back( g );
+    }
+  }
+  if( groups.empty() )
+  {
+    for( size_t g = 0; g < NUM_KERNEL_GROUPS; g++ )
+    {
+      groups.push_back( g );
+    }
+  }
+
+  SimdKernelTest test( seed, iterations );
+  printf( "SimdKernelTest: best extension %s, %s Pel, seed %u, %d iterations\n",
+          getX86ExtensionName( getX86Extension() ), RExt__HIGH_BIT_DEPTH_SUPPORT ? "32-bit" : "16-bit", seed, iterations );
+
+  Bool passed = true;
+  for( size_t i = 0; i < groups.size(); i++ )
+  {
+    const KernelGroup& group = s_kernelGroups[groups[i]];
+    const Bool groupPassed = ( test.*group.check )();
+    printf( "%-20s %s\n", group.name, groupPassed ? "ok" : "FAILED" );
+    passed = passed && groupPassed;
+  }
+  printf( "%llu checks, %llu mismatches\n", (unsigned long long)test.getNumChecks(), (unsigned long long)test.getNumMismatches() );
+
+  if( bench )
+  {
+    for( size_t i = 0; i < groups.size(); i++ )
+    {
+      ( test.*s_kernelGroups[groups[i]].bench )();
+    }
+  }
+  return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#else
+
+int main( int argc, char* argv[] )
+{
+  printf( "SimdKernelTest: built without the x86 kernels, nothing to check\n" );
+  return EXIT_SUCCESS;
+}
+
+#endif // VECTOR_CODING__X86_DISPATCH
+
+//! \}
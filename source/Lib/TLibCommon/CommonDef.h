@@ -245,6 +245,7 @@ static const Int LAST_SIGNIFICANT_GROUPS =                        10 ;
 static const Int MAX_ENCODER_DEBLOCKING_QUALITY_LAYERS =           8 ;
 
 static const UInt LUMA_LEVEL_TO_DQP_LUT_MAXSIZE =                1024; ///< max LUT size for QP offset based on luma
+static const UInt ROI_LEVEL_TO_DQP_LUT_SIZE =                     256; ///< LUT size for QP offset based on 8-bit ROI importance level
 
 #if JVET_X0048_X0103_FILM_GRAIN
 static const Int FG_MAX_NUM_INTENSITIES =                         256; // Maximum nuber of intensity intervals supported in FGC SEI
@@ -84,7 +84,6 @@ TComDataCU::TComDataCU()
     m_explicitRdpcmMode[comp]             = NULL;
   }
 #if ADAPTIVE_QP_SELECTION
-  m_ArlCoeffIsAliasedAllocation = false;
 #endif
   m_pbIPCMFlag         = NULL;
 
@@ -108,7 +107,7 @@ TComDataCU::~TComDataCU()
 
 Void TComDataCU::create( ChromaFormat chromaFormatIDC, UInt uiNumPartition, UInt uiWidth, UInt uiHeight, Bool bDecSubCu, Int unitSize
 #if ADAPTIVE_QP_SELECTION
-                        , TCoeff *pParentARLBuffer
+                        , Bool bArlCoeff
 #endif
                         )
 {
@@ -166,17 +165,8 @@ Void TComDataCU::create( ChromaFormat chromaFormatIDC, UInt uiNumPartition, UInt
       memset( m_pcTrCoeff[compID], 0, (totalSize * sizeof( TCoeff )) );
 
 #if ADAPTIVE_QP_SELECTION
-      if( pParentARLBuffer != 0 )
-      {
-        m_pcArlCoeff[compID] = pParentARLBuffer;
-        m_ArlCoeffIsAliasedAllocation = true;
-        pParentARLBuffer += totalSize;
-      }
-      else
-      {
-        m_pcArlCoeff[compID] = (TCoeff*)xMalloc(TCoeff, totalSize);
-        m_ArlCoeffIsAliasedAllocation = false;
-      }
+      // the ARL statistics are collected from the CUs of the encoder, the CTUs of a picture keep no ARL coefficients
+      m_pcArlCoeff[compID] = bArlCoeff ? (TCoeff*)xMalloc(TCoeff, totalSize) : NULL;
 #endif
       m_pcIPCMSample[compID] = (Pel*   )xMalloc(Pel , totalSize);
     }
@@ -314,13 +304,10 @@ Void TComDataCU::destroy()
       }
 
 #if ADAPTIVE_QP_SELECTION
-      if (!m_ArlCoeffIsAliasedAllocation)
+      if ( m_pcArlCoeff[comp] )
       {
-        if ( m_pcArlCoeff[comp] )
-        {
-          xFree(m_pcArlCoeff[comp]);
-          m_pcArlCoeff[comp] = NULL;
-        }
+        xFree(m_pcArlCoeff[comp]);
+        m_pcArlCoeff[comp] = NULL;
       }
 #endif
 
@@ -475,7 +462,10 @@ Void TComDataCU::initCtu( TComPic* pcPic, UInt ctuRsAddr )
     const UInt componentShift = m_pcPic->getComponentScaleX(ComponentID(comp)) + m_pcPic->getComponentScaleY(ComponentID(comp));
     memset( m_pcTrCoeff[comp], 0, sizeof(TCoeff)* numCoeffY>>componentShift );
 #if ADAPTIVE_QP_SELECTION
-    memset( m_pcArlCoeff[comp], 0, sizeof(TCoeff)* numCoeffY>>componentShift );
+    if ( m_pcArlCoeff[comp] != NULL )
+    {
+      memset( m_pcArlCoeff[comp], 0, sizeof(TCoeff)* numCoeffY>>componentShift );
+    }
 #endif
   }
 
@@ -772,7 +762,7 @@ Void TComDataCU::copySubCU( TComDataCU* pcCU, UInt uiAbsPartIdx )
     const UInt offset           = uiCoffOffset >> componentShift;
     m_pcTrCoeff[ch] = pcCU->getCoeff(component) + offset;
 #if ADAPTIVE_QP_SELECTION
-    m_pcArlCoeff[ch] = pcCU->getArlCoeff(component) + offset;
+    m_pcArlCoeff[ch] = pcCU->getArlCoeff(component) != NULL ? pcCU->getArlCoeff(component) + offset : NULL;
 #endif
     m_pcIPCMSample[ch] = pcCU->getPCMSample(component) + offset;
   }
@@ -970,7 +960,10 @@ Void TComDataCU::copyToPic( UChar uhDepth )
     const UInt componentShift   = m_pcPic->getComponentScaleX(component) + m_pcPic->getComponentScaleY(component);
     memcpy( pCtu->getCoeff(component)   + (offsetY>>componentShift), m_pcTrCoeff[component], sizeof(TCoeff)*(numCoeffY>>componentShift) );
 #if ADAPTIVE_QP_SELECTION
-    memcpy( pCtu->getArlCoeff(component) + (offsetY>>componentShift), m_pcArlCoeff[component], sizeof(TCoeff)*(numCoeffY>>componentShift) );
+    if ( pCtu->getArlCoeff(component) != NULL )
+    {
+      memcpy( pCtu->getArlCoeff(component) + (offsetY>>componentShift), m_pcArlCoeff[component], sizeof(TCoeff)*(numCoeffY>>componentShift) );
+    }
 #endif
     memcpy( pCtu->getPCMSample(component) + (offsetY>>componentShift), m_pcIPCMSample[component], sizeof(Pel)*(numCoeffY>>componentShift) );
   }
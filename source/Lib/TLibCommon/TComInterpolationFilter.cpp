@@ -492,9 +492,13 @@ Void TComInterpolationFilter::filter(Int bitDepth, Pel const *src, Int srcStride
 }
 
 /**
- * \brief Filter a block of samples (horizontal)
+ * \brief Apply FIR filter to a block of samples horizontally, then vertically
+ *
+ * The intermediate samples of both passes are the same as those of a horizontal filter operation followed by
+ * a vertical one.
  *
  * \tparam N          Number of taps
+ * \tparam isLast     Flag indicating whether it is the last filtering operation
  * \param  bitDepth   Bit depth of samples
  * \param  src        Pointer to source samples
  * \param  srcStride  Stride of source samples
@@ -502,62 +506,105 @@ Void TComInterpolationFilter::filter(Int bitDepth, Pel const *src, Int srcStride
  * \param  dstStride  Stride of destination samples
  * \param  width      Width of block
  * \param  height     Height of block
- * \param  isLast     Flag indicating whether it is the last filtering operation
- * \param  coeff      Pointer to filter taps
+ * \param  coeffHor   Pointer to horizontal filter taps
+ * \param  coeffVer   Pointer to vertical filter taps
  */
-template<Int N>
-Void TComInterpolationFilter::filterHor(Int bitDepth, Pel *src, Int srcStride, Pel *dst, Int dstStride, Int width, Int height, Bool isLast, TFilterCoeff const *coeff)
+template<Int N, Bool isLast>
+Void TComInterpolationFilter::filter2D(Int bitDepth, Pel const *src, Int srcStride, Pel *dst, Int dstStride, Int width, Int height, TFilterCoeff const *coeffHor, TFilterCoeff const *coeffVer)
 {
-  if ( isLast )
-  {
-    filter<N, false, true, true>(bitDepth, src, srcStride, dst, dstStride, width, height, coeff);
-  }
-  else
-  {
-    filter<N, false, true, false>(bitDepth, src, srcStride, dst, dstStride, width, height, coeff);
-  }
+  Pel tmp[MAX_CU_SIZE * (MAX_CU_SIZE + N - 1)];
+
+  assert( width <= MAX_CU_SIZE && height <= MAX_CU_SIZE );
+
+  filter<N, false, true, false  >(bitDepth, src - ( N/2 - 1 ) * srcStride, srcStride, tmp, width, width, height + N - 1, coeffHor);
+  filter<N, true,  false, isLast>(bitDepth, tmp + ( N/2 - 1 ) * width, width, dst, dstStride, width, height, coeffVer);
 }
 
 /**
- * \brief Filter a block of samples (vertical)
+ * \brief Get the horizontal filter taps of a colour component
  *
- * \tparam N          Number of taps
- * \param  bitDepth   Bit depth
- * \param  src        Pointer to source samples
- * \param  srcStride  Stride of source samples
- * \param  dst        Pointer to destination samples
- * \param  dstStride  Stride of destination samples
- * \param  width      Width of block
- * \param  height     Height of block
- * \param  isFirst    Flag indicating whether it is the first filtering operation
- * \param  isLast     Flag indicating whether it is the last filtering operation
- * \param  coeff      Pointer to filter taps
+ * \param  compID     Colour component ID
+ * \param  frac       Fractional sample offset
+ * \param  fmt        Chroma format
  */
-template<Int N>
-Void TComInterpolationFilter::filterVer(Int bitDepth, Pel *src, Int srcStride, Pel *dst, Int dstStride, Int width, Int height, Bool isFirst, Bool isLast, TFilterCoeff const *coeff)
+TFilterCoeff const *TComInterpolationFilter::xGetCoeffHor(const ComponentID compID, Int frac, const ChromaFormat fmt) const
 {
-  if ( isFirst && isLast )
-  {
-    filter<N, true, true, true>(bitDepth, src, srcStride, dst, dstStride, width, height, coeff);
-  }
-  else if ( isFirst && !isLast )
-  {
-    filter<N, true, true, false>(bitDepth, src, srcStride, dst, dstStride, width, height, coeff);
-  }
-  else if ( !isFirst && isLast )
+  if (isLuma(compID))
   {
-    filter<N, true, false, true>(bitDepth, src, srcStride, dst, dstStride, width, height, coeff);
+    assert(frac >= 0 && frac < LUMA_INTERPOLATION_FILTER_SUB_SAMPLE_POSITIONS);
+    return m_lumaFilter[frac];
   }
-  else
+
+  const UInt csx = getComponentScaleX(compID, fmt);
+  assert(frac >=0 && csx<2 && (frac<<(1-csx)) < CHROMA_INTERPOLATION_FILTER_SUB_SAMPLE_POSITIONS);
+  return m_chromaFilter[frac<<(1-csx)];
+}
+
+/**
+ * \brief Get the vertical filter taps of a colour component
+ *
+ * \param  compID     Colour component ID
+ * \param  frac       Fractional sample offset
+ * \param  fmt        Chroma format
+ */
+TFilterCoeff const *TComInterpolationFilter::xGetCoeffVer(const ComponentID compID, Int frac, const ChromaFormat fmt) const
+{
+  if (isLuma(compID))
   {
-    filter<N, true, false, false>(bitDepth, src, srcStride, dst, dstStride, width, height, coeff);
+    assert(frac >= 0 && frac < LUMA_INTERPOLATION_FILTER_SUB_SAMPLE_POSITIONS);
+    return m_lumaFilter[frac];
   }
+
+  const UInt csy = getComponentScaleY(compID, fmt);
+  assert(frac >=0 && csy<2 && (frac<<(1-csy)) < CHROMA_INTERPOLATION_FILTER_SUB_SAMPLE_POSITIONS);
+  return m_chromaFilter[frac<<(1-csy)];
 }
 
 // ====================================================================================================================
 // Public member functions
 // ====================================================================================================================
 
+TComInterpolationFilter::TComInterpolationFilter()
+{
+  init();
+}
+
+/**
+ * \brief Install the filter functions
+ *
+ * Called again by TComPrediction::initTempBuff, so that the vector kernels follow the x86 extension limit of the encoder.
+ */
+Void TComInterpolationFilter::init()
+{
+  m_fpFilterCopy = filterCopy;
+
+  m_afpFilter[CHANNEL_TYPE_LUMA  ][0][0][0] = filter<NTAPS_LUMA,   false, false, false>;
+  m_afpFilter[CHANNEL_TYPE_LUMA  ][0][0][1] = filter<NTAPS_LUMA,   false, false, true >;
+  m_afpFilter[CHANNEL_TYPE_LUMA  ][0][1][0] = filter<NTAPS_LUMA,   false, true,  false>;
+  m_afpFilter[CHANNEL_TYPE_LUMA  ][0][1][1] = filter<NTAPS_LUMA,   false, true,  true >;
+  m_afpFilter[CHANNEL_TYPE_LUMA  ][1][0][0] = filter<NTAPS_LUMA,   true,  false, false>;
+  m_afpFilter[CHANNEL_TYPE_LUMA  ][1][0][1] = filter<NTAPS_LUMA,   true,  false, true >;
+  m_afpFilter[CHANNEL_TYPE_LUMA  ][1][1][0] = filter<NTAPS_LUMA,   true,  true,  false>;
+  m_afpFilter[CHANNEL_TYPE_LUMA  ][1][1][1] = filter<NTAPS_LUMA,   true,  true,  true >;
+  m_afpFilter[CHANNEL_TYPE_CHROMA][0][0][0] = filter<NTAPS_CHROMA, false, false, false>;
+  m_afpFilter[CHANNEL_TYPE_CHROMA][0][0][1] = filter<NTAPS_CHROMA, false, false, true >;
+  m_afpFilter[CHANNEL_TYPE_CHROMA][0][1][0] = filter<NTAPS_CHROMA, false, true,  false>;
+  m_afpFilter[CHANNEL_TYPE_CHROMA][0][1][1] = filter<NTAPS_CHROMA, false, true,  true >;
+  m_afpFilter[CHANNEL_TYPE_CHROMA][1][0][0] = filter<NTAPS_CHROMA, true,  false, false>;
+  m_afpFilter[CHANNEL_TYPE_CHROMA][1][0][1] = filter<NTAPS_CHROMA, true,  false, true >;
+  m_afpFilter[CHANNEL_TYPE_CHROMA][1][1][0] = filter<NTAPS_CHROMA, true,  true,  false>;
+  m_afpFilter[CHANNEL_TYPE_CHROMA][1][1][1] = filter<NTAPS_CHROMA, true,  true,  true >;
+
+  m_afpFilter2D[CHANNEL_TYPE_LUMA  ][0] = filter2D<NTAPS_LUMA,   false>;
+  m_afpFilter2D[CHANNEL_TYPE_LUMA  ][1] = filter2D<NTAPS_LUMA,   true >;
+  m_afpFilter2D[CHANNEL_TYPE_CHROMA][0] = filter2D<NTAPS_CHROMA, false>;
+  m_afpFilter2D[CHANNEL_TYPE_CHROMA][1] = filter2D<NTAPS_CHROMA, true >;
+
+#if VECTOR_CODING__X86_DISPATCH
+  xInitInterpolationFilterX86();
+#endif
+}
+
 /**
  * \brief Filter a block of Luma/Chroma samples (horizontal)
  *
@@ -577,18 +624,11 @@ Void TComInterpolationFilter::filterHor(const ComponentID compID, Pel *src, Int
 {
   if ( frac == 0 )
   {
-    filterCopy(bitDepth, src, srcStride, dst, dstStride, width, height, true, isLast );
-  }
-  else if (isLuma(compID))
-  {
-    assert(frac >= 0 && frac < LUMA_INTERPOLATION_FILTER_SUB_SAMPLE_POSITIONS);
-    filterHor<NTAPS_LUMA>(bitDepth, src, srcStride, dst, dstStride, width, height, isLast, m_lumaFilter[frac]);
+    m_fpFilterCopy(bitDepth, src, srcStride, dst, dstStride, width, height, true, isLast );
   }
   else
   {
-    const UInt csx = getComponentScaleX(compID, fmt);
-    assert(frac >=0 && csx<2 && (frac<<(1-csx)) < CHROMA_INTERPOLATION_FILTER_SUB_SAMPLE_POSITIONS);
-    filterHor<NTAPS_CHROMA>(bitDepth, src, srcStride, dst, dstStride, width, height, isLast, m_chromaFilter[frac<<(1-csx)]);
+    m_afpFilter[toChannelType(compID)][0][1][isLast ? 1 : 0](bitDepth, src, srcStride, dst, dstStride, width, height, xGetCoeffHor(compID, frac, fmt));
   }
 }
 
@@ -613,19 +653,37 @@ Void TComInterpolationFilter::filterVer(const ComponentID compID, Pel *src, Int
 {
   if ( frac == 0 )
   {
-    filterCopy(bitDepth, src, srcStride, dst, dstStride, width, height, isFirst, isLast );
-  }
-  else if (isLuma(compID))
-  {
-    assert(frac >= 0 && frac < LUMA_INTERPOLATION_FILTER_SUB_SAMPLE_POSITIONS);
-    filterVer<NTAPS_LUMA>(bitDepth, src, srcStride, dst, dstStride, width, height, isFirst, isLast, m_lumaFilter[frac]);
+    m_fpFilterCopy(bitDepth, src, srcStride, dst, dstStride, width, height, isFirst, isLast );
   }
   else
   {
-    const UInt csy = getComponentScaleY(compID, fmt);
-    assert(frac >=0 && csy<2 && (frac<<(1-csy)) < CHROMA_INTERPOLATION_FILTER_SUB_SAMPLE_POSITIONS);
-    filterVer<NTAPS_CHROMA>(bitDepth, src, srcStride, dst, dstStride, width, height, isFirst, isLast, m_chromaFilter[frac<<(1-csy)]);
+    m_afpFilter[toChannelType(compID)][1][isFirst ? 1 : 0][isLast ? 1 : 0](bitDepth, src, srcStride, dst, dstStride, width, height, xGetCoeffVer(compID, frac, fmt));
   }
 }
 
+/**
+ * \brief Filter a block of Luma/Chroma samples horizontally, then vertically
+ *
+ * Gives the same samples as filterHor into a temporary buffer followed by filterVer.
+ *
+ * \param  compID     Colour component ID
+ * \param  src        Pointer to source samples
+ * \param  srcStride  Stride of source samples
+ * \param  dst        Pointer to destination samples
+ * \param  dstStride  Stride of destination samples
+ * \param  width      Width of block
+ * \param  height     Height of block
+ * \param  fracHor    Horizontal fractional sample offset (non-zero)
+ * \param  fracVer    Vertical fractional sample offset (non-zero)
+ * \param  isLast     Flag indicating whether it is the last filtering operation
+ * \param  fmt        Chroma format
+ * \param  bitDepth   Bit depth
+ */
+Void TComInterpolationFilter::filter2D(const ComponentID compID, Pel *src, Int srcStride, Pel *dst, Int dstStride, Int width, Int height, Int fracHor, Int fracVer, Bool isLast, const ChromaFormat fmt, const Int bitDepth )
+{
+  assert( fracHor != 0 && fracVer != 0 );
+
+  m_afpFilter2D[toChannelType(compID)][isLast ? 1 : 0](bitDepth, src, srcStride, dst, dstStride, width, height, xGetCoeffHor(compID, fracHor, fmt), xGetCoeffVer(compID, fracVer, fmt));
+}
+
 //! \}
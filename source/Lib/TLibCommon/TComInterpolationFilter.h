@@ -40,6 +40,9 @@
 #define __TCOMINTERPOLATIONFILTER__
 
 #include "CommonDef.h"
+#if VECTOR_CODING__X86_DISPATCH
+#include "CommonDefX86.h"
+#endif
 
 //! \ingroup TLibCommon
 //! \{
@@ -55,25 +58,48 @@
  */
 class TComInterpolationFilter
 {
+  typedef Void (*FpFilterCopy)( Int bitDepth, const Pel *src, Int srcStride, Pel *dst, Int dstStride, Int width, Int height, Bool isFirst, Bool isLast );
+  typedef Void (*FpFilter)    ( Int bitDepth, Pel const *src, Int srcStride, Pel *dst, Int dstStride, Int width, Int height, TFilterCoeff const *coeff );
+  typedef Void (*FpFilter2D)  ( Int bitDepth, Pel const *src, Int srcStride, Pel *dst, Int dstStride, Int width, Int height, TFilterCoeff const *coeffHor, TFilterCoeff const *coeffVer );
+
   static const TFilterCoeff m_lumaFilter[LUMA_INTERPOLATION_FILTER_SUB_SAMPLE_POSITIONS][NTAPS_LUMA];     ///< Luma filter taps
   static const TFilterCoeff m_chromaFilter[CHROMA_INTERPOLATION_FILTER_SUB_SAMPLE_POSITIONS][NTAPS_CHROMA]; ///< Chroma filter taps
 
+  FpFilterCopy m_fpFilterCopy;                                         ///< unit filter
+  FpFilter     m_afpFilter  [MAX_NUM_CHANNEL_TYPE][2][2][2];           ///< FIR filters, indexed by [channel type][isVertical][isFirst][isLast]
+  FpFilter2D   m_afpFilter2D[MAX_NUM_CHANNEL_TYPE][2];                 ///< separable FIR filters, indexed by [channel type][isLast]
+
   static Void filterCopy(Int bitDepth, const Pel *src, Int srcStride, Pel *dst, Int dstStride, Int width, Int height, Bool isFirst, Bool isLast);
 
   template<Int N, Bool isVertical, Bool isFirst, Bool isLast>
   static Void filter(Int bitDepth, Pel const *src, Int srcStride, Pel *dst, Int dstStride, Int width, Int height, TFilterCoeff const *coeff);
 
-  template<Int N>
-  static Void filterHor(Int bitDepth, Pel *src, Int srcStride, Pel *dst, Int dstStride, Int width, Int height,               Bool isLast, TFilterCoeff const *coeff);
-  template<Int N>
-  static Void filterVer(Int bitDepth, Pel *src, Int srcStride, Pel *dst, Int dstStride, Int width, Int height, Bool isFirst, Bool isLast, TFilterCoeff const *coeff);
+  template<Int N, Bool isLast>
+  static Void filter2D(Int bitDepth, Pel const *src, Int srcStride, Pel *dst, Int dstStride, Int width, Int height, TFilterCoeff const *coeffHor, TFilterCoeff const *coeffVer);
+
+  TFilterCoeff const *xGetCoeffHor(const ComponentID compID, Int frac, const ChromaFormat fmt) const;
+  TFilterCoeff const *xGetCoeffVer(const ComponentID compID, Int frac, const ChromaFormat fmt) const;
+
+#if VECTOR_CODING__X86_DISPATCH
+  // vector kernels (x86/TComInterpolationFilterX86.h), installed by xInitInterpolationFilterX86 for the extension selected at run time
+  Void    xInitInterpolationFilterX86();
+  template<X86_VEXT vext>
+  Void    xInitInterpolationFilterX86();
+
+  template<X86_VEXT vext>                                             static Void xFilterCopyX86( Int bitDepth, const Pel *src, Int srcStride, Pel *dst, Int dstStride, Int width, Int height, Bool isFirst, Bool isLast );
+  template<X86_VEXT vext, Int N, Bool isVertical, Bool isFirst, Bool isLast> static Void xFilterX86( Int bitDepth, Pel const *src, Int srcStride, Pel *dst, Int dstStride, Int width, Int height, TFilterCoeff const *coeff );
+  template<X86_VEXT vext, Int N, Bool isLast>                         static Void xFilter2DX86( Int bitDepth, Pel const *src, Int srcStride, Pel *dst, Int dstStride, Int width, Int height, TFilterCoeff const *coeffHor, TFilterCoeff const *coeffVer );
+#endif
 
 public:
-  TComInterpolationFilter() {}
+  TComInterpolationFilter();
   ~TComInterpolationFilter() {}
 
+  Void init();
+
   Void filterHor(const ComponentID compID, Pel *src, Int srcStride, Pel *dst, Int dstStride, Int width, Int height, Int frac,               Bool isLast, const ChromaFormat fmt, const Int bitDepth );
   Void filterVer(const ComponentID compID, Pel *src, Int srcStride, Pel *dst, Int dstStride, Int width, Int height, Int frac, Bool isFirst, Bool isLast, const ChromaFormat fmt, const Int bitDepth );
+  Void filter2D (const ComponentID compID, Pel *src, Int srcStride, Pel *dst, Int dstStride, Int width, Int height, Int fracHor, Int fracVer, Bool isLast, const ChromaFormat fmt, const Int bitDepth );
 };
 
 //! \}
@@ -79,6 +79,7 @@ TComLoopFilter::TComLoopFilter()
     m_aapucBS       [edgeDir] = NULL;
     m_aapbEdgeFilter[edgeDir] = NULL;
   }
+  xInitKernels();
 }
 
 TComLoopFilter::~TComLoopFilter()
@@ -102,6 +103,7 @@ Void TComLoopFilter::create( UInt uiMaxCUDepth )
     m_aapucBS       [edgeDir] = new UChar[m_uiNumPartitions];
     m_aapbEdgeFilter[edgeDir] = new Bool [m_uiNumPartitions];
   }
+  xInitKernels();
 }
 
 Void TComLoopFilter::destroy()
@@ -132,25 +134,39 @@ Void TComLoopFilter::loopFilterPic( TComPic* pcPic )
   // Horizontal filtering
   for ( UInt ctuRsAddr = 0; ctuRsAddr < pcPic->getNumberOfCtusInFrame(); ctuRsAddr++ )
   {
-    TComDataCU* pCtu = pcPic->getCtu( ctuRsAddr );
-
-    ::memset( m_aapucBS       [EDGE_VER], 0, sizeof( UChar ) * m_uiNumPartitions );
-    ::memset( m_aapbEdgeFilter[EDGE_VER], 0, sizeof( Bool  ) * m_uiNumPartitions );
-
-    // CU-based deblocking
-    xDeblockCU( pCtu, 0, 0, EDGE_VER );
+    xDeblockCtu( pcPic->getCtu( ctuRsAddr ), EDGE_VER );
   }
 
   // Vertical filtering
   for ( UInt ctuRsAddr = 0; ctuRsAddr < pcPic->getNumberOfCtusInFrame(); ctuRsAddr++ )
   {
-    TComDataCU* pCtu = pcPic->getCtu( ctuRsAddr );
+    xDeblockCtu( pcPic->getCtu( ctuRsAddr ), EDGE_HOR );
+  }
+}
 
-    ::memset( m_aapucBS       [EDGE_HOR], 0, sizeof( UChar ) * m_uiNumPartitions );
-    ::memset( m_aapbEdgeFilter[EDGE_HOR], 0, sizeof( Bool  ) * m_uiNumPartitions );
+/**
+ - call deblocking function for every CU of a CTU row.
+ - The vertical edges of a CTU row only modify samples of that row and its horizontal edges only modify samples of that row
+   and the last lines of the row above, so deblocking the rows in order gives the same result as loopFilterPic().
+ .
+ \param  pcPic   picture class (TComPic) pointer
+ \param  ctuRow  CTU row
+ */
+Void TComLoopFilter::loopFilterCtuRow( TComPic* pcPic, UInt ctuRow )
+{
+  const UInt frameWidthInCtus = pcPic->getFrameWidthInCtus();
+  const UInt firstCtuRsAddr   = ctuRow * frameWidthInCtus;
 
-    // CU-based deblocking
-    xDeblockCU( pCtu, 0, 0, EDGE_HOR );
+  // Horizontal filtering
+  for ( UInt ctuRsAddr = firstCtuRsAddr; ctuRsAddr < firstCtuRsAddr + frameWidthInCtus; ctuRsAddr++ )
+  {
+    xDeblockCtu( pcPic->getCtu( ctuRsAddr ), EDGE_VER );
+  }
+
+  // Vertical filtering
+  for ( UInt ctuRsAddr = firstCtuRsAddr; ctuRsAddr < firstCtuRsAddr + frameWidthInCtus; ctuRsAddr++ )
+  {
+    xDeblockCtu( pcPic->getCtu( ctuRsAddr ), EDGE_HOR );
   }
 }
 
@@ -159,6 +175,25 @@ Void TComLoopFilter::loopFilterPic( TComPic* pcPic )
 // Protected member functions
 // ====================================================================================================================
 
+/**
+ Deblocking of the edges of one direction in a CTU:
+ - the edges of all the CUs are set,
+ - the boundary strength of every edge of the CTU is derived in one pass,
+ - the edges of each CU are filtered.
+ .
+ \param pCtu             Pointer to CTU structure
+ \param edgeDir          the direction of the edges (horizontal/vertical)
+*/
+Void TComLoopFilter::xDeblockCtu( TComDataCU* pCtu, DeblockEdgeDir edgeDir )
+{
+  ::memset( m_aapucBS       [edgeDir], 0, sizeof( UChar ) * m_uiNumPartitions );
+  ::memset( m_aapbEdgeFilter[edgeDir], 0, sizeof( Bool  ) * m_uiNumPartitions );
+
+  xDeblockCU( pCtu, 0, 0, edgeDir, false );
+  xSetBoundaryStrengthCtu( pCtu, edgeDir );
+  xDeblockCU( pCtu, 0, 0, edgeDir, true );
+}
+
 /**
  Deblocking filter process in CU-based (the same function as conventional's)
 
@@ -166,16 +201,16 @@ Void TComLoopFilter::loopFilterPic( TComPic* pcPic )
  \param uiAbsZorderIdx   Position in CU
  \param uiDepth          Depth in CU
  \param edgeDir          the direction of the edge in block boundary (horizontal/vertical), which is added newly
+ \param bFilterEdges     false to set the edges of the CUs and their transform/prediction boundary flags, true to filter them
 */
-Void TComLoopFilter::xDeblockCU( TComDataCU* pcCU, UInt uiAbsZorderIdx, UInt uiDepth, DeblockEdgeDir edgeDir )
+Void TComLoopFilter::xDeblockCU( TComDataCU* pcCU, UInt uiAbsZorderIdx, UInt uiDepth, DeblockEdgeDir edgeDir, Bool bFilterEdges )
 {
   if(pcCU->getPic()==0||pcCU->getPartitionSize(uiAbsZorderIdx)==NUMBER_OF_PART_SIZES)
   {
     return;
   }
   TComPic* pcPic     = pcCU->getPic();
-  UInt uiCurNumParts = pcPic->getNumPartitionsInCtu() >> (uiDepth<<1);
-  UInt uiQNumParts   = uiCurNumParts>>2;
+  UInt uiQNumParts   = pcPic->getNumPartitionsInCtu() >> ((uiDepth+1)<<1);
   const TComSPS &sps = *(pcCU->getSlice()->getSPS());
 
   if( pcCU->getDepth(uiAbsZorderIdx) > uiDepth )
@@ -186,37 +221,23 @@ Void TComLoopFilter::xDeblockCU( TComDataCU* pcCU, UInt uiAbsZorderIdx, UInt uiD
       UInt uiTPelY   = pcCU->getCUPelY() + g_auiRasterToPelY[ g_auiZscanToRaster[uiAbsZorderIdx] ];
       if( ( uiLPelX < sps.getPicWidthInLumaSamples() ) && ( uiTPelY < sps.getPicHeightInLumaSamples() ) )
       {
-        xDeblockCU( pcCU, uiAbsZorderIdx, uiDepth+1, edgeDir );
+        xDeblockCU( pcCU, uiAbsZorderIdx, uiDepth+1, edgeDir, bFilterEdges );
       }
     }
     return;
   }
 
-  xSetLoopfilterParam( pcCU, uiAbsZorderIdx );
-  TComTURecurse tuRecurse(pcCU, uiAbsZorderIdx);
-  xSetEdgefilterTU   ( tuRecurse );
-  xSetEdgefilterPU   ( pcCU, uiAbsZorderIdx );
-
-  const UInt uiPelsInPart = sps.getMaxCUWidth() >> sps.getMaxTotalCUDepth();
-
-  for( UInt uiPartIdx = uiAbsZorderIdx; uiPartIdx < uiAbsZorderIdx + uiCurNumParts; uiPartIdx++ )
+  if( !bFilterEdges )
   {
-    UInt uiBSCheck;
-    if( uiPelsInPart == 4 )
-    {
-      uiBSCheck = (edgeDir == EDGE_VER && uiPartIdx%2 == 0) || (edgeDir == EDGE_HOR && (uiPartIdx-((uiPartIdx>>2)<<2))/2 == 0);
-    }
-    else
-    {
-      uiBSCheck = 1;
-    }
-
-    if ( m_aapbEdgeFilter[edgeDir][uiPartIdx] && uiBSCheck )
-    {
-      xGetBoundaryStrengthSingle ( pcCU, edgeDir, uiPartIdx );
-    }
+    xSetLoopfilterParam( pcCU, uiAbsZorderIdx );
+    TComTURecurse tuRecurse(pcCU, uiAbsZorderIdx);
+    xSetEdgefilterTU   ( tuRecurse );
+    xSetEdgefilterPU   ( pcCU, uiAbsZorderIdx );
+    return;
   }
 
+  const UInt uiPelsInPart = sps.getMaxCUWidth() >> sps.getMaxTotalCUDepth();
+
   UInt PartIdxIncr = DEBLOCK_SMALLEST_BLOCK / uiPelsInPart ? DEBLOCK_SMALLEST_BLOCK / uiPelsInPart : 1 ;
 
   UInt uiSizeInPU = pcPic->getNumPartInCtuWidth()>>(uiDepth);
@@ -413,29 +434,73 @@ Void TComLoopFilter::xSetLoopfilterParam( TComDataCU* pcCU, UInt uiAbsZorderIdx
   }
 }
 
-Void TComLoopFilter::xGetBoundaryStrengthSingle ( TComDataCU* pCtu, DeblockEdgeDir edgeDir, UInt uiAbsPartIdx4x4BlockWithinCtu )
+/**
+ - derive the boundary strength of all the edges of a CTU that are set, in one pass over its base units
+ .
+ \param pCtu      Pointer to CTU structure
+ \param edgeDir   the direction of the edges (horizontal/vertical)
+ */
+Void TComLoopFilter::xSetBoundaryStrengthCtu( TComDataCU* pCtu, DeblockEdgeDir edgeDir )
 {
-  TComSlice * const pcSlice = pCtu->getSlice();
-
-  const Bool lfCrossSliceBoundaryFlag=pCtu->getSlice()->getLFCrossSliceBoundaryFlag();
-
-  const UInt uiPartQ = uiAbsPartIdx4x4BlockWithinCtu;
-  TComDataCU* const pcCUQ = pCtu;
+  const TComPic*   const pcPic                    = pCtu->getPic();
+        TComSlice* const pcSlice                  = pCtu->getSlice();
+  const TComSPS         &sps                      = *(pcSlice->getSPS());
+  const Bool             lfCrossSliceBoundaryFlag = pcSlice->getLFCrossSliceBoundaryFlag();
+  const UInt             uiWidthInBaseUnits       = pcPic->getNumPartInCtuWidth();
+  const UInt             uiHeightInBaseUnits      = pcPic->getNumPartInCtuHeight();
+  const UInt             uiPelsInPart             = sps.getMaxCUWidth() >> sps.getMaxTotalCUDepth();
+  // with 4x4 base units, the edges lie on the 8x8 grid: every other column (vertical edges) or row (horizontal edges)
+  const UInt             uiStepX                  = ( uiPelsInPart == 4 && edgeDir == EDGE_VER ) ? 2 : 1;
+  const UInt             uiStepY                  = ( uiPelsInPart == 4 && edgeDir == EDGE_HOR ) ? 2 : 1;
+  const UInt             uiRasterOffsetP          = edgeDir == EDGE_VER ? 1 : uiWidthInBaseUnits;
+
+  for( UInt y = 0; y < uiHeightInBaseUnits; y += uiStepY )
+  {
+    for( UInt x = 0; x < uiWidthInBaseUnits; x += uiStepX )
+    {
+      const UInt uiRaster = y * uiWidthInBaseUnits + x;
+      const UInt uiPartQ  = g_auiRasterToZscan[uiRaster];
+      if( !m_aapbEdgeFilter[edgeDir][uiPartQ] )
+      {
+        continue;
+      }
 
-  UInt uiPartP;
-  const TComDataCU* pcCUP;
-  UInt uiBs = 0;
+      UInt uiPartP;
+      const TComDataCU* pcCUP;
+      if( ( edgeDir == EDGE_VER ? x : y ) > 0 )
+      {
+        // the P side is in the same CTU
+        uiPartP = g_auiRasterToZscan[uiRaster - uiRasterOffsetP];
+        pcCUP   = pCtu;
+      }
+      else if( edgeDir == EDGE_VER )
+      {
+        pcCUP = pCtu->getPULeft (uiPartP, uiPartQ, !lfCrossSliceBoundaryFlag, !m_bLFCrossTileBoundary);
+      }
+      else  // (edgeDir == EDGE_HOR)
+      {
+        pcCUP = pCtu->getPUAbove(uiPartP, uiPartQ, !lfCrossSliceBoundaryFlag, false, !m_bLFCrossTileBoundary);
+      }
 
-  //-- Calculate Block Index
-  if (edgeDir == EDGE_VER)
-  {
-    pcCUP = pcCUQ->getPULeft(uiPartP, uiPartQ, !lfCrossSliceBoundaryFlag, !m_bLFCrossTileBoundary);
-  }
-  else  // (edgeDir == EDGE_HOR)
-  {
-    pcCUP = pcCUQ->getPUAbove(uiPartP, uiPartQ, !pCtu->getSlice()->getLFCrossSliceBoundaryFlag(), false, !m_bLFCrossTileBoundary);
+      m_aapucBS[edgeDir][uiPartQ] = xGetBoundaryStrength( pcSlice, pcCUP, uiPartP, pCtu, uiPartQ, m_aapucBS[edgeDir][uiPartQ] != 0 );
+    }
   }
+}
 
+/**
+ - boundary strength of one edge
+ .
+ \param pcSlice         slice of the Q side
+ \param pcCUP           CTU of the P side
+ \param uiPartP         base unit of the P side
+ \param pcCUQ           CTU of the Q side
+ \param uiPartQ         base unit of the Q side
+ \param bTransformEdge  true if the edge is a transform unit boundary
+ \returns the boundary strength, from 0 to 2
+ */
+UInt TComLoopFilter::xGetBoundaryStrength( const TComSlice* pcSlice, const TComDataCU* pcCUP, UInt uiPartP, const TComDataCU* pcCUQ, UInt uiPartQ, Bool bTransformEdge )
+{
+  UInt uiBs = 0;
   //-- Set BS for Intra MB : BS = 4 or 3
   if ( pcCUP->isIntra(uiPartP) || pcCUQ->isIntra(uiPartQ) )
   {
@@ -448,7 +513,7 @@ Void TComLoopFilter::xGetBoundaryStrengthSingle ( TComDataCU* pCtu, DeblockEdgeD
     UInt nsPartQ = uiPartQ;
     UInt nsPartP = uiPartP;
 
-    if ( m_aapucBS[edgeDir][uiAbsPartIdx4x4BlockWithinCtu] && (pcCUQ->getCbf( nsPartQ, COMPONENT_Y, pcCUQ->getTransformIdx(nsPartQ)) != 0 || pcCUP->getCbf( nsPartP, COMPONENT_Y, pcCUP->getTransformIdx(nsPartP) ) != 0) )
+    if ( bTransformEdge && (pcCUQ->getCbf( nsPartQ, COMPONENT_Y, pcCUQ->getTransformIdx(nsPartQ)) != 0 || pcCUP->getCbf( nsPartP, COMPONENT_Y, pcCUP->getTransformIdx(nsPartP) ) != 0) )
     {
       uiBs = 1;
     }
@@ -550,7 +615,7 @@ Void TComLoopFilter::xGetBoundaryStrengthSingle ( TComDataCU* pCtu, DeblockEdgeD
     }   // enf of "if( one of BCBP == 0 )"
   }   // enf of "if( not Intra )"
 
-  m_aapucBS[edgeDir][uiAbsPartIdx4x4BlockWithinCtu] = uiBs;
+  return uiBs;
 }
 
 
@@ -572,7 +637,6 @@ Void TComLoopFilter::xEdgeFilterLuma( TComDataCU* const pcCU, const UInt uiAbsZo
 
   UInt  uiPelsInPart = sps.getMaxCUWidth() >> sps.getMaxTotalCUDepth();
   UInt  uiBsAbsIdx = 0, uiBs = 0;
-  Int   iOffset, iSrcStep;
 
   Bool  bPCMFilter = (sps.getUsePCM() && sps.getPCMFilterDisableFlag())? true : false;
   Bool  bPartPNoFilter = false;
@@ -586,23 +650,25 @@ Void TComLoopFilter::xEdgeFilterLuma( TComDataCU* const pcCU, const UInt uiAbsZo
 
   if (edgeDir == EDGE_VER)
   {
-    iOffset = 1;
-    iSrcStep = iStride;
     piTmpSrc += iEdge*uiPelsInPart;
   }
   else  // (edgeDir == EDGE_HOR)
   {
-    iOffset = iStride;
-    iSrcStep = 1;
     piTmpSrc += iEdge*uiPelsInPart*iStride;
   }
 
   const Int iBitdepthScale = 1 << (bitDepthLuma-8);
 
+  // gather the parameters of all the lines of the edge, which is then filtered in one call
+  LFEdgeParam param;
+  Bool        bFilterEdge = false;
+
   for ( UInt iIdx = 0; iIdx < uiNumParts; iIdx++ )
   {
     uiBsAbsIdx = xCalcBsIdx( pcCU, uiAbsZorderIdx, edgeDir, iEdge, iIdx);
     uiBs = m_aapucBS[edgeDir][uiBsAbsIdx];
+    Int iTc = 0;
+    Int iBeta = 0;
     if ( uiBs )
     {
       iQP_Q = pcCU->getQP( uiBsAbsIdx );
@@ -623,52 +689,34 @@ Void TComLoopFilter::xEdgeFilterLuma( TComDataCU* const pcCU, const UInt uiAbsZo
       Int iIndexTC = Clip3(0, MAX_QP+DEFAULT_INTRA_TC_OFFSET, Int(iQP + DEFAULT_INTRA_TC_OFFSET*(uiBs-1) + (tcOffsetDiv2 << 1)));
       Int iIndexB = Clip3(0, MAX_QP, iQP + (betaOffsetDiv2 << 1));
 
-      Int iTc =  sm_tcTable[iIndexTC]*iBitdepthScale;
-      Int iBeta = sm_betaTable[iIndexB]*iBitdepthScale;
-      Int iSideThreshold = (iBeta+(iBeta>>1))>>3;
-      Int iThrCut = iTc*10;
-
+      iTc =  sm_tcTable[iIndexTC]*iBitdepthScale;
+      iBeta = sm_betaTable[iIndexB]*iBitdepthScale;
 
-      UInt  uiBlocksInPart = uiPelsInPart / 4 ? uiPelsInPart / 4 : 1;
-      for (UInt iBlkIdx = 0; iBlkIdx<uiBlocksInPart; iBlkIdx ++)
+      if (bPCMFilter || ppsTransquantBypassEnabledFlag)
       {
-        Int dp0 = xCalcDP( piTmpSrc+iSrcStep*(iIdx*uiPelsInPart+iBlkIdx*4+0), iOffset);
-        Int dq0 = xCalcDQ( piTmpSrc+iSrcStep*(iIdx*uiPelsInPart+iBlkIdx*4+0), iOffset);
-        Int dp3 = xCalcDP( piTmpSrc+iSrcStep*(iIdx*uiPelsInPart+iBlkIdx*4+3), iOffset);
-        Int dq3 = xCalcDQ( piTmpSrc+iSrcStep*(iIdx*uiPelsInPart+iBlkIdx*4+3), iOffset);
-        Int d0 = dp0 + dq0;
-        Int d3 = dp3 + dq3;
-
-        Int dp = dp0 + dp3;
-        Int dq = dq0 + dq3;
-        Int d =  d0 + d3;
-
-        if (bPCMFilter || ppsTransquantBypassEnabledFlag)
-        {
-          // Check if each of PUs is I_PCM with LF disabling
-          bPartPNoFilter = (bPCMFilter && pcCUP->getIPCMFlag(uiPartPIdx));
-          bPartQNoFilter = (bPCMFilter && pcCUQ->getIPCMFlag(uiPartQIdx));
-
-          // check if each of PUs is lossless coded
-          bPartPNoFilter = bPartPNoFilter || (pcCUP->isLosslessCoded(uiPartPIdx) );
-          bPartQNoFilter = bPartQNoFilter || (pcCUQ->isLosslessCoded(uiPartQIdx) );
-        }
-
-        if (d < iBeta)
-        {
-          Bool bFilterP = (dp < iSideThreshold);
-          Bool bFilterQ = (dq < iSideThreshold);
-
-          Bool sw =  xUseStrongFiltering( iOffset, 2*d0, iBeta, iTc, piTmpSrc+iSrcStep*(iIdx*uiPelsInPart+iBlkIdx*4+0))
-          && xUseStrongFiltering( iOffset, 2*d3, iBeta, iTc, piTmpSrc+iSrcStep*(iIdx*uiPelsInPart+iBlkIdx*4+3));
+        // Check if each of PUs is I_PCM with LF disabling
+        bPartPNoFilter = (bPCMFilter && pcCUP->getIPCMFlag(uiPartPIdx));
+        bPartQNoFilter = (bPCMFilter && pcCUQ->getIPCMFlag(uiPartQIdx));
 
-          for ( Int i = 0; i < DEBLOCK_SMALLEST_BLOCK/2; i++)
-          {
-            xPelFilterLuma( piTmpSrc+iSrcStep*(iIdx*uiPelsInPart+iBlkIdx*4+i), iOffset, iTc, sw, bPartPNoFilter, bPartQNoFilter, iThrCut, bFilterP, bFilterQ, bitDepthLuma);
-          }
-        }
+        // check if each of PUs is lossless coded
+        bPartPNoFilter = bPartPNoFilter || (pcCUP->isLosslessCoded(uiPartPIdx) );
+        bPartQNoFilter = bPartQNoFilter || (pcCUQ->isLosslessCoded(uiPartQIdx) );
       }
+      bFilterEdge = bFilterEdge || iBeta > 0;
     }
+
+    for ( UInt uiLine = iIdx*uiPelsInPart; uiLine < (iIdx+1)*uiPelsInPart; uiLine++ )
+    {
+      param.aiTc       [uiLine] = iTc;
+      param.aiBeta     [uiLine] = iBeta;
+      param.aiNoFilterP[uiLine] = bPartPNoFilter ? -1 : 0;
+      param.aiNoFilterQ[uiLine] = bPartQNoFilter ? -1 : 0;
+    }
+  }
+
+  if ( bFilterEdge )
+  {
+    m_afpFilterEdgeLuma[edgeDir]( piTmpSrc, iStride, uiNumParts*uiPelsInPart, param, bitDepthLuma );
   }
 }
 
@@ -689,7 +737,6 @@ Void TComLoopFilter::xEdgeFilterChroma( TComDataCU* const pcCU, const UInt uiAbs
   Int iQP_P = 0;
   Int iQP_Q = 0;
 
-  Int   iOffset, iSrcStep;
   UInt  uiLoopLength;
 
   const UInt uiCtuWidthInBaseUnits = pcCU->getPic()->getNumPartInCtuWidth();
@@ -727,16 +774,12 @@ Void TComLoopFilter::xEdgeFilterChroma( TComDataCU* const pcCU, const UInt uiAbs
 
   if (edgeDir == EDGE_VER)
   {
-    iOffset   = 1;
-    iSrcStep  = iStride;
     piTmpSrcCb += iEdge*uiPelsInPartChromaH;
     piTmpSrcCr += iEdge*uiPelsInPartChromaH;
     uiLoopLength=uiPelsInPartChromaV;
   }
   else  // (edgeDir == EDGE_HOR)
   {
-    iOffset   = iStride;
-    iSrcStep  = 1;
     piTmpSrcCb += iEdge*iStride*uiPelsInPartChromaV;
     piTmpSrcCr += iEdge*iStride*uiPelsInPartChromaV;
     uiLoopLength=uiPelsInPartChromaH;
@@ -744,10 +787,15 @@ Void TComLoopFilter::xEdgeFilterChroma( TComDataCU* const pcCU, const UInt uiAbs
 
   const Int iBitdepthScale = 1 << (pcCU->getSlice()->getSPS()->getBitDepth(CHANNEL_TYPE_CHROMA)-8);
 
+  // gather the parameters of all the lines of the edge, which is then filtered in one call per component
+  LFEdgeParam param[2];
+  Bool        bFilterEdge = false;
+
   for ( UInt iIdx = 0; iIdx < uiNumParts; iIdx++ )
   {
     uiBsAbsIdx = xCalcBsIdx( pcCU, uiAbsZorderIdx, edgeDir, iEdge, iIdx);
     ucBs = m_aapucBS[edgeDir][uiBsAbsIdx];
+    Int aiTc[2] = { 0, 0 };
 
     if ( ucBs > 1)
     {
@@ -782,7 +830,6 @@ Void TComLoopFilter::xEdgeFilterChroma( TComDataCU* const pcCU, const UInt uiAbs
       for ( UInt chromaIdx = 0; chromaIdx < 2; chromaIdx++ )
       {
         Int chromaQPOffset  = pcCU->getSlice()->getPPS()->getQpOffset(ComponentID(chromaIdx + 1));
-        Pel* piTmpSrcChroma = (chromaIdx == 0) ? piTmpSrcCb : piTmpSrcCr;
 
         iQP = ((iQP_P + iQP_Q + 1) >> 1) + chromaQPOffset;
         if (iQP >= chromaQPMappingTableSize)
@@ -802,17 +849,126 @@ Void TComLoopFilter::xEdgeFilterChroma( TComDataCU* const pcCU, const UInt uiAbs
         }
 
         Int iIndexTC = Clip3(0, MAX_QP+DEFAULT_INTRA_TC_OFFSET, iQP + DEFAULT_INTRA_TC_OFFSET*(ucBs - 1) + (tcOffsetDiv2 << 1));
-        Int iTc =  sm_tcTable[iIndexTC]*iBitdepthScale;
+        aiTc[chromaIdx] = sm_tcTable[iIndexTC]*iBitdepthScale;
+        bFilterEdge = bFilterEdge || aiTc[chromaIdx] > 0;
+      }
+    }
 
-        for ( UInt uiStep = 0; uiStep < uiLoopLength; uiStep++ )
-        {
-          xPelFilterChroma( piTmpSrcChroma + iSrcStep*(uiStep+iIdx*uiLoopLength), iOffset, iTc , bPartPNoFilter, bPartQNoFilter, bitDepthChroma);
-        }
+    for ( UInt chromaIdx = 0; chromaIdx < 2; chromaIdx++ )
+    {
+      for ( UInt uiLine = iIdx*uiLoopLength; uiLine < (iIdx+1)*uiLoopLength; uiLine++ )
+      {
+        param[chromaIdx].aiTc       [uiLine] = aiTc[chromaIdx];
+        param[chromaIdx].aiNoFilterP[uiLine] = bPartPNoFilter ? -1 : 0;
+        param[chromaIdx].aiNoFilterQ[uiLine] = bPartQNoFilter ? -1 : 0;
+      }
+    }
+  }
+
+  if ( bFilterEdge )
+  {
+    m_afpFilterEdgeChroma[edgeDir]( piTmpSrcCb, iStride, uiNumParts*uiLoopLength, param[0], bitDepthChroma );
+    m_afpFilterEdgeChroma[edgeDir]( piTmpSrcCr, iStride, uiNumParts*uiLoopLength, param[1], bitDepthChroma );
+  }
+}
+
+// ====================================================================================================================
+// Edge filter kernels
+// ====================================================================================================================
+
+Void TComLoopFilter::xInitKernels()
+{
+  m_afpFilterEdgeLuma  [EDGE_VER] = xFilterEdgeLuma  <EDGE_VER>;
+  m_afpFilterEdgeLuma  [EDGE_HOR] = xFilterEdgeLuma  <EDGE_HOR>;
+  m_afpFilterEdgeChroma[EDGE_VER] = xFilterEdgeChroma<EDGE_VER>;
+  m_afpFilterEdgeChroma[EDGE_HOR] = xFilterEdgeChroma<EDGE_HOR>;
+
+#if VECTOR_CODING__X86_DISPATCH
+  xInitLoopFilterX86();
+#endif
+}
+
+/**
+ - Deblocking of the lines of a luma edge, 4-line segment by 4-line segment
+ .
+ \param piSrc         pointer to the first sample of the Q side of the first line
+ \param iStride       picture stride
+ \param numLines      number of lines, a multiple of 4
+ \param param         parameters of the lines
+ \param bitDepthLuma  luma bit depth
+ */
+template<DeblockEdgeDir edgeDir>
+Void TComLoopFilter::xFilterEdgeLuma( Pel* piSrc, Int iStride, Int numLines, const LFEdgeParam& param, Int bitDepthLuma )
+{
+  const Int iOffset  = edgeDir == EDGE_VER ? 1 : iStride;
+  const Int iSrcStep = edgeDir == EDGE_VER ? iStride : 1;
+
+  for ( Int iLine = 0; iLine < numLines; iLine += DEBLOCK_SMALLEST_BLOCK/2 )
+  {
+    const Int iBeta = param.aiBeta[iLine];
+    if ( iBeta == 0 )
+    {
+      // d < iBeta cannot hold
+      continue;
+    }
+    const Int  iTc            = param.aiTc[iLine];
+    const Int  iSideThreshold = (iBeta+(iBeta>>1))>>3;
+    const Int  iThrCut        = iTc*10;
+    const Bool bPartPNoFilter = param.aiNoFilterP[iLine] != 0;
+    const Bool bPartQNoFilter = param.aiNoFilterQ[iLine] != 0;
+    Pel* const piSeg          = piSrc + iSrcStep*iLine;
+
+    Int dp0 = xCalcDP( piSeg, iOffset);
+    Int dq0 = xCalcDQ( piSeg, iOffset);
+    Int dp3 = xCalcDP( piSeg+iSrcStep*3, iOffset);
+    Int dq3 = xCalcDQ( piSeg+iSrcStep*3, iOffset);
+    Int d0 = dp0 + dq0;
+    Int d3 = dp3 + dq3;
+
+    Int dp = dp0 + dp3;
+    Int dq = dq0 + dq3;
+    Int d =  d0 + d3;
+
+    if (d < iBeta)
+    {
+      Bool bFilterP = (dp < iSideThreshold);
+      Bool bFilterQ = (dq < iSideThreshold);
+
+      Bool sw =  xUseStrongFiltering( iOffset, 2*d0, iBeta, iTc, piSeg)
+      && xUseStrongFiltering( iOffset, 2*d3, iBeta, iTc, piSeg+iSrcStep*3);
+
+      for ( Int i = 0; i < DEBLOCK_SMALLEST_BLOCK/2; i++)
+      {
+        xPelFilterLuma( piSeg+iSrcStep*i, iOffset, iTc, sw, bPartPNoFilter, bPartQNoFilter, iThrCut, bFilterP, bFilterQ, bitDepthLuma);
       }
     }
   }
 }
 
+/**
+ - Deblocking of the lines of a chroma edge
+ .
+ \param piSrc           pointer to the first sample of the Q side of the first line
+ \param iStride         picture stride
+ \param numLines        number of lines
+ \param param           parameters of the lines
+ \param bitDepthChroma  chroma bit depth
+ */
+template<DeblockEdgeDir edgeDir>
+Void TComLoopFilter::xFilterEdgeChroma( Pel* piSrc, Int iStride, Int numLines, const LFEdgeParam& param, Int bitDepthChroma )
+{
+  const Int iOffset  = edgeDir == EDGE_VER ? 1 : iStride;
+  const Int iSrcStep = edgeDir == EDGE_VER ? iStride : 1;
+
+  for ( Int iLine = 0; iLine < numLines; iLine++ )
+  {
+    if ( param.aiTc[iLine] > 0 )
+    {
+      xPelFilterChroma( piSrc + iSrcStep*iLine, iOffset, param.aiTc[iLine], param.aiNoFilterP[iLine] != 0, param.aiNoFilterQ[iLine] != 0, bitDepthChroma);
+    }
+  }
+}
+
 /**
  - Deblocking for the luminance component with strong or weak filter
  .
@@ -40,12 +40,24 @@
 
 #include "CommonDef.h"
 #include "TComPic.h"
+#if VECTOR_CODING__X86_DISPATCH
+#include "CommonDefX86.h"
+#endif
 
 //! \ingroup TLibCommon
 //! \{
 
 #define DEBLOCK_SMALLEST_BLOCK  8
 
+/// parameters of each line across an edge, for the edge filter kernels; the lines of a 4-line luma segment share their parameters
+struct LFEdgeParam
+{
+  Int aiTc       [MAX_CU_SIZE];      ///< tc; a chroma line with a tc of 0 is left unchanged
+  Int aiBeta     [MAX_CU_SIZE];      ///< beta of a luma line; 0 where the edge is not filtered
+  Int aiNoFilterP[MAX_CU_SIZE];      ///< -1 to keep the samples of the P side (I_PCM with loop filter disabled, or lossless), 0 otherwise
+  Int aiNoFilterQ[MAX_CU_SIZE];      ///< -1 to keep the samples of the Q side, 0 otherwise
+};
+
 // ====================================================================================================================
 // Class definition
 // ====================================================================================================================
@@ -62,16 +74,41 @@ private:
 
   Bool      m_bLFCrossTileBoundary;
 
+  typedef Void (*FpFilterEdge)( Pel* piSrc, Int iStride, Int numLines, const LFEdgeParam& param, Int bitDepth );
+
+  FpFilterEdge m_afpFilterEdgeLuma  [NUM_EDGE_DIR];  ///< luma filter of the lines of an edge, with the strong/weak decisions of each 4-line segment
+  FpFilterEdge m_afpFilterEdgeChroma[NUM_EDGE_DIR];  ///< chroma filter of the lines of an edge
+
+  Void xInitKernels();
+
+  template<DeblockEdgeDir edgeDir> static Void xFilterEdgeLuma  ( Pel* piSrc, Int iStride, Int numLines, const LFEdgeParam& param, Int bitDepthLuma );
+  template<DeblockEdgeDir edgeDir> static Void xFilterEdgeChroma( Pel* piSrc, Int iStride, Int numLines, const LFEdgeParam& param, Int bitDepthChroma );
+
+#if VECTOR_CODING__X86_DISPATCH
+  friend class SimdKernelTest;                       ///< checks the kernels against the scalar functions (source/App/utils/SimdKernelTest)
+
+  // vector kernels (x86/TComLoopFilterX86.h), installed by xInitLoopFilterX86 for the extension selected at run time
+  Void xInitLoopFilterX86();
+  template<X86_VEXT vext>
+  Void xInitLoopFilterX86();
+
+  template<X86_VEXT vext, DeblockEdgeDir edgeDir> static Void xFilterEdgeLumaX86  ( Pel* piSrc, Int iStride, Int numLines, const LFEdgeParam& param, Int bitDepthLuma );
+  template<X86_VEXT vext, DeblockEdgeDir edgeDir> static Void xFilterEdgeChromaX86( Pel* piSrc, Int iStride, Int numLines, const LFEdgeParam& param, Int bitDepthChroma );
+#endif
+
 protected:
-  /// CU-level deblocking function
-  Void xDeblockCU                 ( TComDataCU* pcCU, UInt uiAbsZorderIdx, UInt uiDepth, DeblockEdgeDir edgeDir );
+  /// CTU-level deblocking function
+  Void xDeblockCtu                ( TComDataCU* pCtu, DeblockEdgeDir edgeDir );
+  /// CU-level deblocking function: sets the edges of the CUs, or filters them
+  Void xDeblockCU                 ( TComDataCU* pcCU, UInt uiAbsZorderIdx, UInt uiDepth, DeblockEdgeDir edgeDir, Bool bFilterEdges );
 
   // set / get functions
   Void xSetLoopfilterParam        ( TComDataCU* pcCU, UInt uiAbsZorderIdx );
   // filtering functions
   Void xSetEdgefilterTU           ( TComTU &rTu );
   Void xSetEdgefilterPU           ( TComDataCU* pcCU, UInt uiAbsZorderIdx );
-  Void xGetBoundaryStrengthSingle ( TComDataCU* pCtu, DeblockEdgeDir edgeDir, UInt uiPartIdx );
+  Void xSetBoundaryStrengthCtu    ( TComDataCU* pCtu, DeblockEdgeDir edgeDir );
+  static UInt xGetBoundaryStrength( const TComSlice* pcSlice, const TComDataCU* pcCUP, UInt uiPartP, const TComDataCU* pcCUQ, UInt uiPartQ, Bool bTransformEdge );
   UInt xCalcBsIdx                 ( TComDataCU* pcCU, UInt absZIdxInCtu, DeblockEdgeDir edgeDir, Int iEdgeIdx, Int iBaseUnitIdx, const struct TComRectangle *rect=NULL )
   {
     TComPic* const pcPic = pcCU->getPic();
@@ -107,13 +144,13 @@ protected:
   Void xEdgeFilterLuma            ( TComDataCU* const pcCU, const UInt uiAbsZorderIdx, const UInt uiDepth, const DeblockEdgeDir edgeDir, const Int iEdge );
   Void xEdgeFilterChroma          ( TComDataCU* const pcCU, const UInt uiAbsZorderIdx, const UInt uiDepth, const DeblockEdgeDir edgeDir, const Int iEdge );
 
-  __inline Void xPelFilterLuma( Pel* piSrc, Int iOffset, Int tc, Bool sw, Bool bPartPNoFilter, Bool bPartQNoFilter, Int iThrCut, Bool bFilterSecondP, Bool bFilterSecondQ, const Int bitDepthLuma);
-  __inline Void xPelFilterChroma( Pel* piSrc, Int iOffset, Int tc, Bool bPartPNoFilter, Bool bPartQNoFilter, const Int bitDepthChroma);
+  static __inline Void xPelFilterLuma( Pel* piSrc, Int iOffset, Int tc, Bool sw, Bool bPartPNoFilter, Bool bPartQNoFilter, Int iThrCut, Bool bFilterSecondP, Bool bFilterSecondQ, const Int bitDepthLuma);
+  static __inline Void xPelFilterChroma( Pel* piSrc, Int iOffset, Int tc, Bool bPartPNoFilter, Bool bPartQNoFilter, const Int bitDepthChroma);
 
 
-  __inline Bool xUseStrongFiltering( Int offset, Int d, Int beta, Int tc, Pel* piSrc);
-  __inline Int xCalcDP( Pel* piSrc, Int iOffset);
-  __inline Int xCalcDQ( Pel* piSrc, Int iOffset);
+  static __inline Bool xUseStrongFiltering( Int offset, Int d, Int beta, Int tc, Pel* piSrc);
+  static __inline Int xCalcDP( Pel* piSrc, Int iOffset);
+  static __inline Int xCalcDQ( Pel* piSrc, Int iOffset);
 
   static const UChar sm_tcTable[54];
   static const UChar sm_betaTable[52];
@@ -131,6 +168,9 @@ public:
   /// picture-level deblocking filter
   Void loopFilterPic( TComPic* pcPic );
 
+  /// deblocking filter of one CTU row, the CTU rows above it must have been deblocked
+  Void loopFilterCtuRow( TComPic* pcPic, UInt ctuRow );
+
   static Int getBeta( Int qp )
   {
     Int indexB = Clip3( 0, MAX_QP, qp );
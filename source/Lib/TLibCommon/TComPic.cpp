@@ -55,6 +55,8 @@ TComPic::TComPic()
 , m_bNeededForOutput                      (false)
 , m_uiCurrSliceIdx                        (0)
 , m_bCheckLTMSB                           (false)
+, m_numFinishedCtuRows                    (MAX_INT)
+, m_bOutputPending                        (false)
 {
   for(UInt i=0; i<NUM_PIC_YUV; i++)
   {
@@ -299,6 +301,58 @@ Void TComPic::compressMotion()
   }
 }
 
+/** Compress the motion of the CTUs of one CTU row.
+ * \param ctuRow CTU row
+ */
+Void TComPic::compressMotion( UInt ctuRow )
+{
+  TComPicSym* pPicSym = getPicSym();
+  const UInt frameWidthInCtus = pPicSym->getFrameWidthInCtus();
+  for ( UInt uiCUAddr = ctuRow * frameWidthInCtus; uiCUAddr < ( ctuRow + 1 ) * frameWidthInCtus; uiCUAddr++ )
+  {
+    TComDataCU* pCtu = pPicSym->getCtu(uiCUAddr);
+    pCtu->compressMV();
+  }
+}
+
+/** Publish the number of CTU rows that can be referenced by other pictures.
+ * \param numRows number of finished CTU rows, 0 when the picture enters the pipeline, MAX_INT when it is completely finished
+ */
+Void TComPic::setNumFinishedCtuRows( Int numRows )
+{
+  std::lock_guard<std::mutex> lock( m_pipelineMutex );
+  m_numFinishedCtuRows = numRows;
+  m_pipelineCond.notify_all();
+}
+
+/** Wait until the first CTU rows of the picture are finished.
+ * \param numRows number of CTU rows needed
+ */
+Void TComPic::waitForFinishedCtuRows( Int numRows )
+{
+  if ( m_numFinishedCtuRows >= numRows )
+  {
+    return;
+  }
+  std::unique_lock<std::mutex> lock( m_pipelineMutex );
+  m_pipelineCond.wait( lock, [&]{ return m_numFinishedCtuRows >= numRows; } );
+}
+
+Void TComPic::setOutputPending( Bool b )
+{
+  std::lock_guard<std::mutex> lock( m_pipelineMutex );
+  m_bOutputPending = b;
+  m_pipelineCond.notify_all();
+}
+
+/** Wait until the picture has left all the stages of the pipeline, before it is reused or destroyed.
+ */
+Void TComPic::waitForPipeline()
+{
+  std::unique_lock<std::mutex> lock( m_pipelineMutex );
+  m_pipelineCond.wait( lock, [&]{ return m_numFinishedCtuRows == MAX_INT && !m_bOutputPending; } );
+}
+
 Bool  TComPic::getSAOMergeAvailability(Int currAddr, Int mergeAddr)
 {
   Bool mergeCtbInSliceSeg = (mergeAddr >= getPicSym()->getCtuTsToRsAddrMap(getCtu(currAddr)->getSlice()->getSliceCurStartCtuTsAddr()));
@@ -432,11 +486,13 @@ TComPic*  TComPic::findPrevPicPOC(TComPic* pcPic, TComList<TComPic*>* pcListPic)
 }
 Void TComPic::xOutputPostFilteredPic(TComPic* pcPic, TComList<TComPic*>* pcListPic)
 {
+  pcPic->waitForFinishedCtuRows(pcPic->getFrameHeightInCtus());
   if (pcPic->getPOC() % 2 == 0)
   {
     TComPic* prevPic = findPrevPicPOC(pcPic, pcListPic);
     if (prevPic)
     {
+      prevPic->waitForFinishedCtuRows(prevPic->getFrameHeightInCtus());
       TComPicYuv* currYuv = pcPic->getPicYuvRec();
       TComPicYuv* prevYuv = prevPic->getPicYuvRec();
       TComPicYuv* postYuv = pcPic->getPicYuvPostRec();
@@ -39,6 +39,9 @@
 #define __TCOMPIC__
 
 // Include files
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
 #include "CommonDef.h"
 #include "TComPicSym.h"
 #include "TComPicYuv.h"
@@ -98,6 +101,11 @@ private:
 
   SEIMessages  m_SEIs; ///< Any SEI messages that have been received.  If !NULL we own the object.
 
+  std::mutex              m_pipelineMutex;
+  std::condition_variable m_pipelineCond;
+  std::atomic<Int>        m_numFinishedCtuRows;   ///< number of CTU rows that are filtered and border extended (MAX_INT: whole picture)
+  Bool                    m_bOutputPending;       ///< picture is queued for writing
+
 public:
   TComPic();
   virtual ~TComPic();
@@ -194,11 +202,18 @@ public:
   Bool          getOutputMark () const      { return m_bNeededForOutput;  }
 
   Void          compressMotion();
+  Void          compressMotion( UInt ctuRow );
+
+  // progress of the in-loop filtering and output stages of a pipelined decoder
+  Void          setNumFinishedCtuRows ( Int numRows );
+  Void          waitForFinishedCtuRows( Int numRows );
+  Void          setOutputPending      ( Bool b );
+  Void          waitForPipeline       ();
   UInt          getCurrSliceIdx() const           { return m_uiCurrSliceIdx;                }
   Void          setCurrSliceIdx(UInt i)      { m_uiCurrSliceIdx = i;                   }
   UInt          getNumAllocatedSlice() const      {return m_picSym.getNumAllocatedSlice();}
   Void          allocateNewSlice()           {m_picSym.allocateNewSlice();         }
-  Void          clearSliceBuffer()           {m_picSym.clearSliceBuffer();         }
+  Void          clearSliceBuffer( UInt numSlicesToKeep = 0 ) {m_picSym.clearSliceBuffer( numSlicesToKeep );}
 
   const Window& getConformanceWindow() const { return m_picSym.getSPS().getConformanceWindow(); }
   Window        getDefDisplayWindow() const  { return m_picSym.getSPS().getVuiParametersPresentFlag() ? m_picSym.getSPS().getVuiParameters()->getDefaultDisplayWindow() : Window(); }
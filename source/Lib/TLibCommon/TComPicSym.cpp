@@ -67,9 +67,6 @@ TComPicSym::TComPicSym()
 ,m_dpbPerCtuData(NULL)
 #endif
 ,m_saoBlkParams(NULL)
-#if ADAPTIVE_QP_SELECTION
-,m_pParentARLBuffer(NULL)
-#endif
 {}
 
 
@@ -120,13 +117,6 @@ Void TComPicSym::create  ( const TComSPS &sps, const TComPPS &pps, UInt uiMaxDep
   clearSliceBuffer();
   allocateNewSlice();
 
-#if ADAPTIVE_QP_SELECTION
-  if (m_pParentARLBuffer == NULL)
-  {
-    m_pParentARLBuffer = new TCoeff[uiMaxCuWidth*uiMaxCuHeight*MAX_NUM_COMPONENT];
-  }
-#endif
-
 #if REDUCED_ENCODER_MEMORY
   if (bAllocateCtuArray)
   {
@@ -138,7 +128,7 @@ Void TComPicSym::create  ( const TComSPS &sps, const TComPPS &pps, UInt uiMaxDep
     m_pictureCtuArray[i] = new TComDataCU;
     m_pictureCtuArray[i]->create( chromaFormatIDC, m_numPartitionsInCtu, uiMaxCuWidth, uiMaxCuHeight, false, uiMaxCuWidth >> m_uhTotalDepth
 #if ADAPTIVE_QP_SELECTION
-      , m_pParentARLBuffer
+      , false
 #endif
       );
   }
@@ -177,7 +167,7 @@ Void TComPicSym::prepareForReconstruction()
       m_pictureCtuArray[i] = new TComDataCU;
       m_pictureCtuArray[i]->create( chromaFormatIDC, m_numPartitionsInCtu, uiMaxCuWidth, uiMaxCuHeight, false, uiMaxCuWidth >> m_uhTotalDepth
 #if ADAPTIVE_QP_SELECTION
-        , m_pParentARLBuffer
+        , false
 #endif
         );
     }
@@ -275,11 +265,6 @@ Void TComPicSym::destroy()
   {
     delete[] m_saoBlkParams; m_saoBlkParams = NULL;
   }
-
-#if ADAPTIVE_QP_SELECTION
-  delete [] m_pParentARLBuffer;
-  m_pParentARLBuffer = NULL;
-#endif
 }
 
 Void TComPicSym::allocateNewSlice()
@@ -294,13 +279,13 @@ Void TComPicSym::allocateNewSlice()
   }
 }
 
-Void TComPicSym::clearSliceBuffer()
+Void TComPicSym::clearSliceBuffer( UInt numSlicesToKeep )
 {
-  for (UInt i = 0; i < UInt(m_apSlices.size()); i++)
+  while (UInt(m_apSlices.size()) > numSlicesToKeep)
   {
-    delete m_apSlices[i];
+    delete m_apSlices.back();
+    m_apSlices.pop_back();
   }
-  m_apSlices.clear();
 }
 
 Void TComPicSym::xInitCtuTsRsAddrMaps()
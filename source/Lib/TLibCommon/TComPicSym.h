@@ -127,9 +127,6 @@ private:
   DPBPerCtuData *m_dpbPerCtuData;
 #endif
   SAOBlkParam  *m_saoBlkParams;
-#if ADAPTIVE_QP_SELECTION
-  TCoeff*       m_pParentARLBuffer;
-#endif
   TComSPS       m_sps;
   TComPPS       m_pps;
 
@@ -174,7 +171,7 @@ public:
   TComSlice *        swapSliceObject(TComSlice* p, UInt i)                 { p->setSPS(&m_sps); p->setPPS(&m_pps); TComSlice *pTmp=m_apSlices[i];m_apSlices[i] = p; pTmp->setSPS(0); pTmp->setPPS(0); return pTmp; }
   UInt               getNumAllocatedSlice() const                          { return UInt(m_apSlices.size());       }
   Void               allocateNewSlice();
-  Void               clearSliceBuffer();
+  Void               clearSliceBuffer( UInt numSlicesToKeep = 0 );
   UInt               getNumPartitionsInCtu() const                         { return m_numPartitionsInCtu;   }
   UInt               getNumPartInCtuWidth() const                          { return m_numPartInCtuWidth;    }
   UInt               getNumPartInCtuHeight() const                         { return m_numPartInCtuHeight;   }
@@ -380,6 +380,59 @@ Void TComPicYuv::extendPicBorder ()
   m_bIsBorderExtended = true;
 }
 
+/** Extend the border of a range of lines, for the pictures that are referenced while they are still being filtered.
+ * The left and right margins of the lines are extended, as well as the top (bottom) margin when the range contains the first (last) line.
+ * The border extension flag is left unchanged.
+ * \param firstLumaLine first luma line of the range
+ * \param numLumaLines  number of luma lines in the range
+ */
+Void TComPicYuv::extendPicBorderLines( const Int firstLumaLine, const Int numLumaLines )
+{
+  for(Int comp=0; comp<getNumberValidComponents(); comp++)
+  {
+    const ComponentID compId=ComponentID(comp);
+    const Int stride=getStride(compId);
+    const Int width=getWidth(compId);
+    const Int height=getHeight(compId);
+    const Int marginX=getMarginX(compId);
+    const Int marginY=getMarginY(compId);
+    const Int firstLine=firstLumaLine >> getComponentScaleY(compId);
+    const Int endLine=std::min(height, (firstLumaLine + numLumaLines) >> getComponentScaleY(compId));
+
+    Pel*  pi = getAddr(compId) + firstLine*stride;
+    // do left and right margins
+    for (Int y = firstLine; y < endLine; y++)
+    {
+      for (Int x = 0; x < marginX; x++ )
+      {
+        pi[ -marginX + x ] = pi[0];
+        pi[    width + x ] = pi[width-1];
+      }
+      pi += stride;
+    }
+
+    if (endLine == height)
+    {
+      // pi is now (-marginX, height-1)
+      pi -= (stride + marginX);
+      for (Int y = 0; y < marginY; y++ )
+      {
+        ::memcpy( pi + (y+1)*stride, pi, sizeof(Pel)*(width + (marginX<<1)) );
+      }
+    }
+
+    if (firstLine == 0)
+    {
+      // pi is now (-marginX, 0)
+      pi = getAddr(compId) - marginX;
+      for (Int y = 0; y < marginY; y++ )
+      {
+        ::memcpy( pi - (y+1)*stride, pi, sizeof(Pel)*(width + (marginX<<1)) );
+      }
+    }
+  }
+}
+
 #if JVET_X0048_X0103_FILM_GRAIN
 Void TComPicYuv::extendPicBorder(const ComponentID compId, const Int marginX, const Int marginY, const Bool bScaleMarginChroma)
 {
@@ -193,6 +193,7 @@ public:
 
   //  Extend function of picture buffer
   Void          extendPicBorder   ();
+  Void          extendPicBorderLines( const Int firstLumaLine, const Int numLumaLines );
 
   //  Dump picture
 #if JVET_X0048_X0103_FILM_GRAIN
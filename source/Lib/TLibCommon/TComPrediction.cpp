@@ -81,6 +81,8 @@ TComPrediction::TComPrediction()
       m_piYuvExt[ch][buf] = NULL;
     }
   }
+
+  xInitIntraKernels();
 }
 
 TComPrediction::~TComPrediction()
@@ -125,6 +127,9 @@ Void TComPrediction::destroy()
 
 Void TComPrediction::initTempBuff(ChromaFormat chromaFormatIDC)
 {
+  m_if.init();
+  xInitIntraKernels();
+
   // if it has been initialised before, but the chroma format has changed, release the memory and start again.
   if( m_piYuvExt[COMPONENT_Y][PRED_BUF_UNFILTERED] != NULL && m_cYuvPredTemp.getChromaFormat()!=chromaFormatIDC)
   {
@@ -174,6 +179,20 @@ Void TComPrediction::initTempBuff(ChromaFormat chromaFormatIDC)
   }
 }
 
+/** Install the intra prediction kernels
+ */
+Void TComPrediction::xInitIntraKernels()
+{
+  m_afpPredIntraAng[0] = xPredIntraAngBlk<false>;
+  m_afpPredIntraAng[1] = xPredIntraAngBlk<true>;
+  m_fpPredIntraPlanar  = xPredIntraPlanarBlk;
+  m_fpPredIntraDC      = xPredIntraDCBlk;
+
+#if VECTOR_CODING__X86_DISPATCH
+  xInitPredictionX86();
+#endif
+}
+
 // ====================================================================================================================
 // Public member functions
 // ====================================================================================================================
@@ -200,21 +219,64 @@ Pel TComPrediction::predIntraGetPredValDC( const Pel* pSrc, Int iSrcStride, UInt
   return pDcVal;
 }
 
+/** Load the reference samples of an intra block.
+ * \param pSrc      pointer to the first sample of the block in the reference sample array
+ * \param srcStride the stride of the reference sample array
+ * \param width     the width of the block
+ * \param height    the height of the block
+ * \param refAbove  receives the top-left sample followed by the 2*width samples above the block
+ * \param refLeft   receives the top-left sample followed by the 2*height samples left of the block
+ */
+Void TComPrediction::xGetIntraRefs( const Pel* pSrc, Int srcStride, Int width, Int height, Pel* refAbove, Pel* refLeft )
+{
+  memcpy( refAbove, pSrc-srcStride-1, (2*width+1)*sizeof(Pel) );
+  for (Int y=0;y<2*height+1;y++)
+  {
+    refLeft[y] = pSrc[(y-1)*srcStride-1];
+  }
+}
+
+/** Function for deriving the prediction of an intra mode from the loaded reference samples (lossless DPCM excepted).
+ * \param bitDepth           bit depth
+ * \param refAbove           top-left and above reference samples, as loaded by xGetIntraRefs
+ * \param refLeft            top-left and left reference samples, as loaded by xGetIntraRefs
+ * \param pDst               pointer to the prediction sample array
+ * \param dstStride          the stride of the prediction sample array
+ * \param width              the width of the block
+ * \param height             the height of the block
+ * \param channelType        type of pel array (luma/chroma)
+ * \param dirMode            the intra prediction mode index
+ * \param bEnableEdgeFilters indication whether to enable the edge filters of the pure horizontal and vertical modes
+ */
+Void TComPrediction::xPredIntraMode( Int bitDepth, const Pel* refAbove, const Pel* refLeft, Pel* pDst, Int dstStride, Int width, Int height, ChannelType channelType, UInt dirMode, const Bool bEnableEdgeFilters )
+{
+  if ( dirMode == PLANAR_IDX )
+  {
+    m_fpPredIntraPlanar( refAbove, refLeft, pDst, dstStride, width, height );
+  }
+  else if ( dirMode == DC_IDX )
+  {
+    const Bool bFilter = isLuma(channelType) && (width <= MAXIMUM_INTRA_FILTERED_WIDTH) && (height <= MAXIMUM_INTRA_FILTERED_HEIGHT);
+    m_fpPredIntraDC( refAbove, refLeft, pDst, dstStride, width, height, bFilter );
+  }
+  else
+  {
+    xPredIntraAng( bitDepth, refAbove, refLeft, pDst, dstStride, width, height, channelType, dirMode, bEnableEdgeFilters );
+  }
+}
+
 // Function for deriving the angular Intra predictions
 
 /** Function for deriving the simplified angular intra predictions.
  * \param bitDepth           bit depth
- * \param pSrc               pointer to reconstructed sample array
- * \param srcStride          the stride of the reconstructed sample array
- * \param pTrueDst           reference to pointer for the prediction sample array
- * \param dstStrideTrue      the stride of the prediction sample array
- * \param uiWidth            the width of the block
- * \param uiHeight           the height of the block
+ * \param refAbove           top-left and above reference samples, as loaded by xGetIntraRefs
+ * \param refLeft            top-left and left reference samples, as loaded by xGetIntraRefs
+ * \param pDst               pointer to the prediction sample array
+ * \param dstStride          the stride of the prediction sample array
+ * \param width              the width of the block
+ * \param height             the height of the block
  * \param channelType        type of pel array (luma/chroma)
- * \param format             chroma format
  * \param dirMode            the intra prediction mode index
- * \param blkAboveAvailable  boolean indication if the block above is available
- * \param blkLeftAvailable   boolean indication if the block to the left is available
  * \param bEnableEdgeFilters indication whether to enable edge filters
  *
  * This function derives the prediction samples for the angular mode based on the prediction direction indicated by
@@ -227,161 +289,95 @@ Pel TComPrediction::predIntraGetPredValDC( const Pel* pSrc, Int iSrcStride, UInt
  */
 //NOTE: Bit-Limit - 25-bit source
 Void TComPrediction::xPredIntraAng(       Int bitDepth,
-                                    const Pel* pSrc,     Int srcStride,
-                                          Pel* pTrueDst, Int dstStrideTrue,
-                                          UInt uiWidth, UInt uiHeight, ChannelType channelType,
+                                    const Pel* refAbove, const Pel* refLeft,
+                                          Pel* pDst,     Int dstStride,
+                                          Int width,     Int height, ChannelType channelType,
                                           UInt dirMode, const Bool bEnableEdgeFilters
                                   )
 {
-  Int width=Int(uiWidth);
-  Int height=Int(uiHeight);
-
   // Map the mode index to main prediction direction and angle
-  assert( dirMode != PLANAR_IDX ); //no planar
-  const Bool modeDC        = dirMode==DC_IDX;
-
-  // Do the DC prediction
-  if (modeDC)
+  assert( dirMode != PLANAR_IDX && dirMode != DC_IDX );
+
+  const Bool       bIsModeVer         = (dirMode >= 18);
+  const Int        intraPredAngleMode = (bIsModeVer) ? (Int)dirMode - VER_IDX :  -((Int)dirMode - HOR_IDX);
+  const Int        absAngMode         = abs(intraPredAngleMode);
+  const Int        signAng            = intraPredAngleMode < 0 ? -1 : 1;
+  const Bool       edgeFilter         = bEnableEdgeFilters && isLuma(channelType) && (width <= MAXIMUM_INTRA_FILTERED_WIDTH) && (height <= MAXIMUM_INTRA_FILTERED_HEIGHT);
+
+  // Set bitshifts and scale the angle parameter to block size
+  static const Int angTable[9]    = {0,    2,    5,   9,  13,  17,  21,  26,  32};
+  static const Int invAngTable[9] = {0, 4096, 1638, 910, 630, 482, 390, 315, 256}; // (256 * 32) / Angle
+  Int invAngle                    = invAngTable[absAngMode];
+  Int absAng                      = angTable[absAngMode];
+  Int intraPredAngle              = signAng * absAng;
+
+  const Pel* refMain = bIsModeVer ? refAbove : refLeft;
+  const Pel* refSide = bIsModeVer ? refLeft  : refAbove;
+
+  // Extend the Main reference to the left.
+  Pel  refMainExt[MAX_CU_SIZE+2*MAX_CU_SIZE+1];
+  if (intraPredAngle < 0)
   {
-    const Pel dcval = predIntraGetPredValDC(pSrc, srcStride, width, height);
+    const Int numRows   = bIsModeVer ? height : width;
+    const Int rowLength = bIsModeVer ? width  : height;
+    Pel *refMainExtended = refMainExt + MAX_CU_SIZE;
 
-    for (Int y=height;y>0;y--, pTrueDst+=dstStrideTrue)
+    memcpy( refMainExtended, refMain, (rowLength+1)*sizeof(Pel) );
+    Int invAngleSum    = 128;       // rounding for (shift by 8)
+    for (Int k=-1; k>numRows*intraPredAngle>>5; k--)
     {
-      for (Int x=0; x<width;) // width is always a multiple of 4.
-      {
-        pTrueDst[x++] = dcval;
-      }
+      invAngleSum += invAngle;
+      refMainExtended[k] = refSide[invAngleSum>>8];
     }
+    refMain = refMainExtended;
   }
-  else // Do angular predictions
-  {
-    const Bool       bIsModeVer         = (dirMode >= 18);
-    const Int        intraPredAngleMode = (bIsModeVer) ? (Int)dirMode - VER_IDX :  -((Int)dirMode - HOR_IDX);
-    const Int        absAngMode         = abs(intraPredAngleMode);
-    const Int        signAng            = intraPredAngleMode < 0 ? -1 : 1;
-    const Bool       edgeFilter         = bEnableEdgeFilters && isLuma(channelType) && (width <= MAXIMUM_INTRA_FILTERED_WIDTH) && (height <= MAXIMUM_INTRA_FILTERED_HEIGHT);
-
-    // Set bitshifts and scale the angle parameter to block size
-    static const Int angTable[9]    = {0,    2,    5,   9,  13,  17,  21,  26,  32};
-    static const Int invAngTable[9] = {0, 4096, 1638, 910, 630, 482, 390, 315, 256}; // (256 * 32) / Angle
-    Int invAngle                    = invAngTable[absAngMode];
-    Int absAng                      = angTable[absAngMode];
-    Int intraPredAngle              = signAng * absAng;
-
-    Pel* refMain;
-    Pel* refSide;
-
-    Pel  refAbove[2*MAX_CU_SIZE+1];
-    Pel  refLeft[2*MAX_CU_SIZE+1];
 
-    // Initialize the Main and Left reference array.
-    if (intraPredAngle < 0)
-    {
-      const Int refMainOffsetPreScale = (bIsModeVer ? height : width ) - 1;
-      const Int refMainOffset         = height - 1;
-      for (Int x=0;x<width+1;x++)
-      {
-        refAbove[x+refMainOffset] = pSrc[x-srcStride-1];
-      }
-      for (Int y=0;y<height+1;y++)
-      {
-        refLeft[y+refMainOffset] = pSrc[(y-1)*srcStride-1];
-      }
-      refMain = (bIsModeVer ? refAbove : refLeft)  + refMainOffset;
-      refSide = (bIsModeVer ? refLeft  : refAbove) + refMainOffset;
+  m_afpPredIntraAng[bIsModeVer ? 1 : 0]( refMain, intraPredAngle, pDst, dstStride, width, height );
 
-      // Extend the Main reference to the left.
-      Int invAngleSum    = 128;       // rounding for (shift by 8)
-      for (Int k=-1; k>(refMainOffsetPreScale+1)*intraPredAngle>>5; k--)
-      {
-        invAngleSum += invAngle;
-        refMain[k] = refSide[invAngleSum>>8];
-      }
-    }
-    else
+  if (intraPredAngle == 0 && edgeFilter)  // pure vertical or pure horizontal
+  {
+    const Int numPels  = bIsModeVer ? height : width;
+    const Int pelStep  = bIsModeVer ? dstStride : 1;
+    for (Int k=0;k<numPels;k++)
     {
-      for (Int x=0;x<2*width+1;x++)
-      {
-        refAbove[x] = pSrc[x-srcStride-1];
-      }
-      for (Int y=0;y<2*height+1;y++)
-      {
-        refLeft[y] = pSrc[(y-1)*srcStride-1];
-      }
-      refMain = bIsModeVer ? refAbove : refLeft ;
-      refSide = bIsModeVer ? refLeft  : refAbove;
+      pDst[k*pelStep] = Clip3 (0, ((1 << bitDepth) - 1), pDst[k*pelStep] + (( refSide[k+1] - refSide[0] ) >> 1) );
     }
+  }
+}
 
-    // swap width/height if we are doing a horizontal mode:
-    Pel tempArray[MAX_CU_SIZE*MAX_CU_SIZE];
-    const Int dstStride = bIsModeVer ? dstStrideTrue : MAX_CU_SIZE;
-    Pel *pDst = bIsModeVer ? pTrueDst : tempArray;
-    if (!bIsModeVer)
-    {
-      std::swap(width, height);
-    }
+/** Angular prediction of a block from its (extended) main reference, refMain[0] being the top-left sample.
+ *  Each row of a vertical mode, or column of a horizontal mode, is projected onto refMain with the displacement
+ *  (y+1)*intraPredAngle, at 1/32 pixel accuracy.
+ */
+template<Bool bIsModeVer>
+Void TComPrediction::xPredIntraAngBlk( const Pel* refMain, Int intraPredAngle, Pel* pDst, Int dstStride, Int width, Int height )
+{
+  // horizontal modes are derived as vertical ones and written transposed
+  const Int numRows   = bIsModeVer ? height    : width;
+  const Int rowLength = bIsModeVer ? width     : height;
+  const Int rowStep   = bIsModeVer ? dstStride : 1;
+  const Int pelStep   = bIsModeVer ? 1         : dstStride;
 
-    if (intraPredAngle == 0)  // pure vertical or pure horizontal
-    {
-      for (Int y=0;y<height;y++)
-      {
-        for (Int x=0;x<width;x++)
-        {
-          pDst[y*dstStride+x] = refMain[x+1];
-        }
-      }
+  for (Int y=0, deltaPos=intraPredAngle; y<numRows; y++, deltaPos+=intraPredAngle, pDst+=rowStep)
+  {
+    const Int deltaInt   = deltaPos >> 5;
+    const Int deltaFract = deltaPos & (32 - 1);
+    const Pel *pRM       = refMain+deltaInt+1;
 
-      if (edgeFilter)
-      {
-        for (Int y=0;y<height;y++)
-        {
-          pDst[y*dstStride] = Clip3 (0, ((1 << bitDepth) - 1), pDst[y*dstStride] + (( refSide[y+1] - refSide[0] ) >> 1) );
-        }
-      }
-    }
-    else
+    if (deltaFract)
     {
-      Pel *pDsty=pDst;
-
-      for (Int y=0, deltaPos=intraPredAngle; y<height; y++, deltaPos+=intraPredAngle, pDsty+=dstStride)
+      // Do linear filtering
+      for (Int x=0;x<rowLength;x++)
       {
-        const Int deltaInt   = deltaPos >> 5;
-        const Int deltaFract = deltaPos & (32 - 1);
-
-        if (deltaFract)
-        {
-          // Do linear filtering
-          const Pel *pRM=refMain+deltaInt+1;
-          Int lastRefMainPel=*pRM++;
-          for (Int x=0;x<width;pRM++,x++)
-          {
-            Int thisRefMainPel=*pRM;
-            pDsty[x+0] = (Pel) ( ((32-deltaFract)*lastRefMainPel + deltaFract*thisRefMainPel +16) >> 5 );
-            lastRefMainPel=thisRefMainPel;
-          }
-        }
-        else
-        {
-          // Just copy the integer samples
-          for (Int x=0;x<width; x++)
-          {
-            pDsty[x] = refMain[x+deltaInt+1];
-          }
-        }
+        pDst[x*pelStep] = (Pel) ( ((32-deltaFract)*pRM[x] + deltaFract*pRM[x+1] +16) >> 5 );
       }
     }
-
-    // Flip the block if this is the horizontal mode
-    if (!bIsModeVer)
+    else
     {
-      for (Int y=0; y<height; y++)
+      // Just copy the integer samples
+      for (Int x=0;x<rowLength;x++)
       {
-        for (Int x=0; x<width; x++)
-        {
-          pTrueDst[x*dstStrideTrue] = pDst[x];
-        }
-        pTrueDst++;
-        pDst+=dstStride;
+        pDst[x*pelStep] = pRM[x];
       }
     }
   }
@@ -445,31 +441,72 @@ Void TComPrediction::predIntraAng( const ComponentID compID, UInt uiDirMode, Pel
   else
   {
     const Pel *ptrSrc = getPredictorPtr( compID, bUseFilteredPredSamples );
+    Pel  refAbove[2*MAX_CU_SIZE+1];
+    Pel  refLeft[2*MAX_CU_SIZE+1];
 
-    if ( uiDirMode == PLANAR_IDX )
-    {
-      xPredIntraPlanar( ptrSrc+sw+1, sw, pDst, uiStride, iWidth, iHeight );
-    }
-    else
-    {
-      // Create the prediction
-            TComDataCU *const pcCU              = rTu.getCU();
-      const UInt              uiAbsPartIdx      = rTu.GetAbsPartIdxTU();
-      const Bool              enableEdgeFilters = !(pcCU->isRDPCMEnabled(uiAbsPartIdx) && pcCU->getCUTransquantBypass(uiAbsPartIdx));
+    xGetIntraRefs( ptrSrc+sw+1, sw, iWidth, iHeight, refAbove, refLeft );
+
+    // Create the prediction
+          TComDataCU *const pcCU              = rTu.getCU();
+    const UInt              uiAbsPartIdx      = rTu.GetAbsPartIdxTU();
+    const Bool              enableEdgeFilters = !(pcCU->isRDPCMEnabled(uiAbsPartIdx) && pcCU->getCUTransquantBypass(uiAbsPartIdx));
 #if O0043_BEST_EFFORT_DECODING
-      const Int channelsBitDepthForPrediction = rTu.getCU()->getSlice()->getSPS()->getStreamBitDepth(channelType);
+    const Int channelsBitDepthForPrediction = rTu.getCU()->getSlice()->getSPS()->getStreamBitDepth(channelType);
 #else
-      const Int channelsBitDepthForPrediction = rTu.getCU()->getSlice()->getSPS()->getBitDepth(channelType);
+    const Int channelsBitDepthForPrediction = rTu.getCU()->getSlice()->getSPS()->getBitDepth(channelType);
 #endif
-      xPredIntraAng( channelsBitDepthForPrediction, ptrSrc+sw+1, sw, pDst, uiStride, iWidth, iHeight, channelType, uiDirMode, enableEdgeFilters );
+    xPredIntraMode( channelsBitDepthForPrediction, refAbove, refLeft, pDst, uiStride, iWidth, iHeight, channelType, uiDirMode, enableEdgeFilters );
+  }
 
-      if( uiDirMode == DC_IDX )
-      {
-        xDCPredFiltering( ptrSrc+sw+1, sw, pDst, uiStride, iWidth, iHeight, channelType );
-      }
+}
+
+/** Function for deriving the intra predictions of several modes of one block, as predIntraAng without lossless DPCM.
+ * \param compID    colour component
+ * \param puiModes  the intra prediction mode indices
+ * \param iNumModes the number of modes
+ * \param ppiPred   the prediction sample array of each mode
+ * \param uiStride  the stride of the prediction sample arrays
+ * \param rTu       the block
+ *
+ * The reference samples are loaded once for all the modes, from the unfiltered or filtered buffer selected by
+ * filteringIntraReferenceSamples, so initIntraPatternChType must have been called with bFilterRefSamples set.
+ */
+Void TComPrediction::predIntraAngModes( const ComponentID compID, const UInt* puiModes, const Int iNumModes, Pel* const* ppiPred, UInt uiStride, TComTU &rTu )
+{
+  const ChannelType    channelType = toChannelType(compID);
+  const TComRectangle &rect        = rTu.getRect(isLuma(compID) ? COMPONENT_Y : COMPONENT_Cb);
+  const Int            iWidth      = rect.width;
+  const Int            iHeight     = rect.height;
+  const Int            sw          = (2 * iWidth + 1);
+
+        TComDataCU *const pcCU              = rTu.getCU();
+  const TComSPS          &sps               = *(pcCU->getSlice()->getSPS());
+  const UInt              uiAbsPartIdx      = rTu.GetAbsPartIdxTU();
+  const Bool              enableEdgeFilters = !(pcCU->isRDPCMEnabled(uiAbsPartIdx) && pcCU->getCUTransquantBypass(uiAbsPartIdx));
+#if O0043_BEST_EFFORT_DECODING
+  const Int channelsBitDepthForPrediction = sps.getStreamBitDepth(channelType);
+#else
+  const Int channelsBitDepthForPrediction = sps.getBitDepth(channelType);
+#endif
+
+  Pel  refAbove[NUM_PRED_BUF][2*MAX_CU_SIZE+1];
+  Pel  refLeft[NUM_PRED_BUF][2*MAX_CU_SIZE+1];
+  Bool bRefsLoaded[NUM_PRED_BUF] = { false, false };
+
+  for (Int i=0; i<iNumModes; i++)
+  {
+    const UInt uiDirMode = puiModes[i];
+    const Bool bFilter   = filteringIntraReferenceSamples(compID, uiDirMode, iWidth, iHeight, rTu.GetChromaFormat(), sps.getSpsRangeExtension().getIntraSmoothingDisabledFlag());
+    const Int  buf       = bFilter ? PRED_BUF_FILTERED : PRED_BUF_UNFILTERED;
+
+    if (!bRefsLoaded[buf])
+    {
+      xGetIntraRefs( getPredictorPtr( compID, bFilter )+sw+1, sw, iWidth, iHeight, refAbove[buf], refLeft[buf] );
+      bRefsLoaded[buf] = true;
     }
-  }
 
+    xPredIntraMode( channelsBitDepthForPrediction, refAbove[buf], refLeft[buf], ppiPred[i], uiStride, iWidth, iHeight, channelType, uiDirMode, enableEdgeFilters );
+  }
 }
 
 /** Check for identical motion in both motion vector direction of a bi-directional predicted CU
@@ -670,13 +707,7 @@ Void TComPrediction::xPredInterBlk(const ComponentID compID, TComDataCU *cu, TCo
   }
   else
   {
-    Int   tmpStride = m_filteredBlockTmp[0].getStride(compID);
-    Pel*  tmp       = m_filteredBlockTmp[0].getAddr(compID);
-
-    const Int vFilterSize = isLuma(compID) ? NTAPS_LUMA : NTAPS_CHROMA;
-
-    m_if.filterHor(compID, ref - ((vFilterSize>>1) -1)*refStride, refStride, tmp, tmpStride, cxWidth, cxHeight+vFilterSize-1, xFrac, false,      chFmt, bitDepth);
-    m_if.filterVer(compID, tmp + ((vFilterSize>>1) -1)*tmpStride, tmpStride, dst, dstStride, cxWidth, cxHeight,               yFrac, false, !bi, chFmt, bitDepth);
+    m_if.filter2D(compID, ref, refStride, dst, dstStride, cxWidth, cxHeight, xFrac, yFrac, !bi, chFmt, bitDepth);
   }
 }
 
@@ -716,19 +747,17 @@ Void TComPrediction::getMvPredAMVP( TComDataCU* pcCU, UInt uiPartIdx, UInt uiPar
 }
 
 /** Function for deriving planar intra prediction.
- * \param pSrc        pointer to reconstructed sample array
- * \param srcStride   the stride of the reconstructed sample array
+ * \param refAbove    top-left and above reference samples, as loaded by xGetIntraRefs
+ * \param refLeft     top-left and left reference samples, as loaded by xGetIntraRefs
  * \param rpDst       reference to pointer for the prediction sample array
  * \param dstStride   the stride of the prediction sample array
  * \param width       the width of the block
  * \param height      the height of the block
- * \param channelType type of pel array (luma, chroma)
- * \param format      chroma format
  *
  * This function derives the prediction samples for planar mode (intra coding).
  */
 //NOTE: Bit-Limit - 24-bit source
-Void TComPrediction::xPredIntraPlanar( const Pel* pSrc, Int srcStride, Pel* rpDst, Int dstStride, UInt width, UInt height )
+Void TComPrediction::xPredIntraPlanarBlk( const Pel* refAbove, const Pel* refLeft, Pel* rpDst, Int dstStride, Int width, Int height )
 {
   assert(width <= height);
 
@@ -742,12 +771,12 @@ Void TComPrediction::xPredIntraPlanar( const Pel* pSrc, Int srcStride, Pel* rpDs
   // Get left and above reference column and row
   for(Int k=0;k<width+1;k++)
   {
-    topRow[k] = pSrc[k-srcStride];
+    topRow[k] = refAbove[k+1];
   }
 
   for (Int k=0; k < height+1; k++)
   {
-    leftColumn[k] = pSrc[k*srcStride-1];
+    leftColumn[k] = refLeft[k+1];
   }
 
   // Prepare intermediate variables used in interpolation
@@ -783,43 +812,58 @@ Void TComPrediction::xPredIntraPlanar( const Pel* pSrc, Int srcStride, Pel* rpDs
   }
 }
 
-/** Function for filtering intra DC predictor.
- * \param pSrc pointer to reconstructed sample array
- * \param iSrcStride the stride of the reconstructed sample array
- * \param pDst reference to pointer for the prediction sample array
- * \param iDstStride the stride of the prediction sample array
- * \param iWidth the width of the block
- * \param iHeight the height of the block
- * \param channelType type of pel array (luma, chroma)
+/** Function for deriving DC intra prediction.
+ * \param refAbove    top-left and above reference samples, as loaded by xGetIntraRefs
+ * \param refLeft     top-left and left reference samples, as loaded by xGetIntraRefs
+ * \param pDst        pointer to the prediction sample array
+ * \param dstStride   the stride of the prediction sample array
+ * \param width       the width of the block
+ * \param height      the height of the block
+ * \param bFilter     filter the left and top edges of the prediction
  *
- * This function performs filtering left and top edges of the prediction samples for DC mode (intra coding).
+ * This function fills the block with the mean of the reference samples and, for small luma blocks, filters its
+ * left and top edges towards the reference samples.
  */
-Void TComPrediction::xDCPredFiltering( const Pel* pSrc, Int iSrcStride, Pel* pDst, Int iDstStride, Int iWidth, Int iHeight, ChannelType channelType )
+Void TComPrediction::xPredIntraDCBlk( const Pel* refAbove, const Pel* refLeft, Pel* pDst, Int dstStride, Int width, Int height, Bool bFilter )
 {
-  Int x, y, iDstStride2, iSrcStride2;
+  Int iSum = 0;
+  for (Int x=0;x<width;x++)
+  {
+    iSum += refAbove[x+1];
+  }
+  for (Int y=0;y<height;y++)
+  {
+    iSum += refLeft[y+1];
+  }
+  const Pel dcval = (iSum + width) / (width + height);
 
-  if (isLuma(channelType) && (iWidth <= MAXIMUM_INTRA_FILTERED_WIDTH) && (iHeight <= MAXIMUM_INTRA_FILTERED_HEIGHT))
+  for (Int y=0;y<height;y++)
+  {
+    for (Int x=0;x<width;x++)
+    {
+      pDst[y*dstStride+x] = dcval;
+    }
+  }
+
+  if (bFilter)
   {
     //top-left
-    pDst[0] = (Pel)((pSrc[-iSrcStride] + pSrc[-1] + 2 * pDst[0] + 2) >> 2);
+    pDst[0] = (Pel)((refAbove[1] + refLeft[1] + 2 * dcval + 2) >> 2);
 
     //top row (vertical filter)
-    for ( x = 1; x < iWidth; x++ )
+    for (Int x=1;x<width;x++)
     {
-      pDst[x] = (Pel)((pSrc[x - iSrcStride] +  3 * pDst[x] + 2) >> 2);
+      pDst[x] = (Pel)((refAbove[x+1] + 3 * dcval + 2) >> 2);
     }
 
     //left column (horizontal filter)
-    for ( y = 1, iDstStride2 = iDstStride, iSrcStride2 = iSrcStride-1; y < iHeight; y++, iDstStride2+=iDstStride, iSrcStride2+=iSrcStride )
+    for (Int y=1;y<height;y++)
     {
-      pDst[iDstStride2] = (Pel)((pSrc[iSrcStride2] + 3 * pDst[iDstStride2] + 2) >> 2);
+      pDst[y*dstStride] = (Pel)((refLeft[y+1] + 3 * dcval + 2) >> 2);
     }
   }
-
-  return;
 }
 
-/* Static member function */
 Bool TComPrediction::UseDPCMForFirstPassIntraEstimation(TComTU &rTu, const UInt uiDirMode)
 {
   return (rTu.getCU()->isRDPCMEnabled(rTu.GetAbsPartIdxTU()) ) &&
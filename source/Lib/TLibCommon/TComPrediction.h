@@ -44,6 +44,10 @@
 #include "TComInterpolationFilter.h"
 #include "TComWeightPrediction.h"
 
+#if VECTOR_CODING__X86_DISPATCH
+#include "CommonDefX86.h"
+#endif
+
 // forward declaration
 class TComMv;
 class TComTU; 
@@ -84,8 +88,9 @@ protected:
   Pel*   m_pLumaRecBuffer;       ///< array for downsampled reconstructed luma sample
   Int    m_iLumaRecStride;       ///< stride of #m_pLumaRecBuffer array
 
-  Void xPredIntraAng            ( Int bitDepth, const Pel* pSrc, Int srcStride, Pel* pDst, Int dstStride, UInt width, UInt height, ChannelType channelType, UInt dirMode, const Bool bEnableEdgeFilters );
-  Void xPredIntraPlanar         ( const Pel* pSrc, Int srcStride, Pel* rpDst, Int dstStride, UInt width, UInt height );
+  static Void xGetIntraRefs     ( const Pel* pSrc, Int srcStride, Int width, Int height, Pel* refAbove, Pel* refLeft );
+  Void xPredIntraMode           ( Int bitDepth, const Pel* refAbove, const Pel* refLeft, Pel* pDst, Int dstStride, Int width, Int height, ChannelType channelType, UInt dirMode, const Bool bEnableEdgeFilters );
+  Void xPredIntraAng            ( Int bitDepth, const Pel* refAbove, const Pel* refLeft, Pel* pDst, Int dstStride, Int width, Int height, ChannelType channelType, UInt dirMode, const Bool bEnableEdgeFilters );
 
   // motion compensation functions
   Void xPredInterUni            ( TComDataCU* pcCU,                          UInt uiPartAddr,               Int iWidth, Int iHeight, RefPicList eRefPicList, TComYuv* pcYuvPred, Bool bi=false          );
@@ -95,10 +100,38 @@ protected:
 
   Void xGetLLSPrediction ( const Pel* pSrc0, Int iSrcStride, Pel* pDst0, Int iDstStride, UInt uiWidth, UInt uiHeight, UInt uiExt0, const ChromaFormat chFmt  DEBUG_STRING_FN_DECLARE(sDebug) );
 
-  Void xDCPredFiltering( const Pel* pSrc, Int iSrcStride, Pel* pDst, Int iDstStride, Int iWidth, Int iHeight, ChannelType channelType );
   Bool xCheckIdenticalMotion    ( TComDataCU* pcCU, UInt PartAddr);
   Void destroy();
 
+private:
+  typedef Void (*FpPredIntraAng)   ( const Pel* refMain, Int intraPredAngle, Pel* pDst, Int dstStride, Int width, Int height );
+  typedef Void (*FpPredIntraPlanar)( const Pel* refAbove, const Pel* refLeft, Pel* pDst, Int dstStride, Int width, Int height );
+  typedef Void (*FpPredIntraDC)    ( const Pel* refAbove, const Pel* refLeft, Pel* pDst, Int dstStride, Int width, Int height, Bool bFilter );
+
+  FpPredIntraAng    m_afpPredIntraAng[2];                              ///< angular prediction from the main reference: [0] horizontal modes, [1] vertical modes
+  FpPredIntraPlanar m_fpPredIntraPlanar;                               ///< planar prediction
+  FpPredIntraDC     m_fpPredIntraDC;                                   ///< DC prediction, with the edge filter when bFilter is set
+
+  Void        xInitIntraKernels   ();
+
+  template<Bool bIsModeVer>
+  static Void xPredIntraAngBlk    ( const Pel* refMain, Int intraPredAngle, Pel* pDst, Int dstStride, Int width, Int height );
+  static Void xPredIntraPlanarBlk ( const Pel* refAbove, const Pel* refLeft, Pel* rpDst, Int dstStride, Int width, Int height );
+  static Void xPredIntraDCBlk     ( const Pel* refAbove, const Pel* refLeft, Pel* pDst, Int dstStride, Int width, Int height, Bool bFilter );
+
+#if VECTOR_CODING__X86_DISPATCH
+  friend class SimdKernelTest;                                         ///< checks the kernels against the scalar functions (source/App/utils/SimdKernelTest)
+
+  // vector kernels (x86/TComPredictionX86.h), installed by xInitPredictionX86 for the extension selected at run time
+  Void    xInitPredictionX86();
+  template<X86_VEXT vext>
+  Void    xInitPredictionX86();
+
+  template<X86_VEXT vext, Bool bIsModeVer> static Void xPredIntraAngX86   ( const Pel* refMain, Int intraPredAngle, Pel* pDst, Int dstStride, Int width, Int height );
+  template<X86_VEXT vext>                  static Void xPredIntraPlanarX86( const Pel* refAbove, const Pel* refLeft, Pel* pDst, Int dstStride, Int width, Int height );
+  template<X86_VEXT vext>                  static Void xPredIntraDCX86    ( const Pel* refAbove, const Pel* refLeft, Pel* pDst, Int dstStride, Int width, Int height, Bool bFilter );
+#endif
+
 public:
   TComPrediction();
   virtual ~TComPrediction();
@@ -115,6 +148,7 @@ public:
 
   // Angular Intra
   Void predIntraAng               ( const ComponentID compID, UInt uiDirMode, Pel *piOrg /* Will be null for decoding */, UInt uiOrgStride, Pel* piPred, UInt uiStride, TComTU &rTu, const Bool bUseFilteredPredSamples, const Bool bUseLosslessDPCM = false );
+  Void predIntraAngModes          ( const ComponentID compID, const UInt* puiModes, const Int iNumModes, Pel* const* ppiPred, UInt uiStride, TComTU &rTu );
 
   Pel  predIntraGetPredValDC      ( const Pel* pSrc, Int iSrcStride, UInt iWidth, UInt iHeight);
 
@@ -167,6 +167,10 @@ Void TComRdCost::init()
   m_afpDistortFunc[DF_HADS64 ] = TComRdCost::xGetHADs;
   m_afpDistortFunc[DF_HADS16N] = TComRdCost::xGetHADs;
 
+#if VECTOR_CODING__X86_DISPATCH
+  xInitRdCostX86();
+#endif
+
   m_costMode                   = COST_STANDARD_LOSSY;
 
   m_motionLambda               = 0;
@@ -296,41 +300,18 @@ Void TComRdCost::setDistParam( DistParam& rcDP, Int bitDepth, const Pel* p1, Int
 
 Distortion TComRdCost::calcHAD( Int bitDepth, const Pel* pi0, Int iStride0, const Pel* pi1, Int iStride1, Int iWidth, Int iHeight )
 {
-  Distortion uiSum = 0;
-  Int x, y;
+  assert ( ( (iWidth % 4) == 0 ) && ( (iHeight % 4) == 0 ) );
 
-  if ( ( (iWidth % 8) == 0 ) && ( (iHeight % 8) == 0 ) )
-  {
-    for ( y=0; y<iHeight; y+= 8 )
-    {
-      for ( x=0; x<iWidth; x+= 8 )
-      {
-        uiSum += xCalcHADs8x8( &pi0[x], &pi1[x], iStride0, iStride1, 1
-#if VECTOR_CODING__DISTORTION_CALCULATIONS && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
-          , bitDepth
-#endif
-          );
-      }
-      pi0 += iStride0*8;
-      pi1 += iStride1*8;
-    }
-  }
-  else
-  {
-    assert ( ( (iWidth % 4) == 0 ) && ( (iHeight % 4) == 0 ) );
-
-    for ( y=0; y<iHeight; y+= 4 )
-    {
-      for ( x=0; x<iWidth; x+= 4 )
-      {
-        uiSum += xCalcHADs4x4( &pi0[x], &pi1[x], iStride0, iStride1, 1 );
-      }
-      pi0 += iStride0*4;
-      pi1 += iStride1*4;
-    }
-  }
-
-  return ( uiSum >> DISTORTION_PRECISION_ADJUSTMENT(bitDepth-8) );
+  DistParam cDtParam;
+  cDtParam.pOrg       = pi0;
+  cDtParam.pCur       = pi1;
+  cDtParam.iStrideOrg = iStride0;
+  cDtParam.iStrideCur = iStride1;
+  cDtParam.iCols      = iWidth;
+  cDtParam.iRows      = iHeight;
+  cDtParam.bitDepth   = bitDepth;
+
+  return m_afpDistortFunc[DF_HADS]( &cDtParam );
 }
 
 Distortion TComRdCost::getDistPart( Int bitDepth, const Pel* piCur, Int iCurStride,  const Pel* piOrg, Int iOrgStride, UInt uiBlkWidth, UInt uiBlkHeight, const ComponentID compID, DFunc eDFunc )
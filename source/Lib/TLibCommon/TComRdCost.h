@@ -45,6 +45,9 @@
 
 #include "TComSlice.h"
 #include "TComRdCostWeightPrediction.h"
+#if VECTOR_CODING__X86_DISPATCH
+#include "CommonDefX86.h"
+#endif
 
 //! \ingroup TLibCommon
 //! \{
@@ -204,6 +207,22 @@ private:
 #endif
                                       );
 
+#if VECTOR_CODING__X86_DISPATCH
+  friend class SimdKernelTest;                                     ///< checks the kernels against the scalar functions (source/App/utils/SimdKernelTest)
+
+  // vector kernels (x86/TComRdCostX86.h), installed by xInitRdCostX86 for the extension selected at run time
+  Void    xInitRdCostX86();
+  template<X86_VEXT vext>
+  Void    xInitRdCostX86();
+
+  template<X86_VEXT vext>             static Distortion xGetSSEX86      ( DistParam* pcDtParam );
+  template<X86_VEXT vext, Int iWidth> static Distortion xGetSSEBlockX86 ( DistParam* pcDtParam );
+  template<X86_VEXT vext>             static Distortion xGetSADX86      ( DistParam* pcDtParam );
+  template<X86_VEXT vext, Int iWidth> static Distortion xGetSADBlockX86 ( DistParam* pcDtParam );
+  template<X86_VEXT vext>             static Distortion xGetSAD16NX86   ( DistParam* pcDtParam );
+  template<X86_VEXT vext>             static Distortion xGetHADsX86     ( DistParam* pcDtParam );
+#endif
+
 public:
 
   Distortion   getDistPart(Int bitDepth, const Pel* piCur, Int iCurStride, const Pel* piOrg, Int iOrgStride, UInt uiBlkWidth, UInt uiBlkHeight, const ComponentID compID, DFunc eDFunc = DF_SSE );
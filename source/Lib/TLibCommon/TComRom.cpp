@@ -41,6 +41,7 @@
 #include <stdio.h>
 #include <iomanip>
 #include <assert.h>
+#include <mutex>
 #include "TComDataCU.h"
 #include "Debug.h"
 // ====================================================================================================================
@@ -175,9 +176,19 @@ public:
   }
 };
 
+// the tables are shared by all encoders and decoders of the process, e.g. the encoders of parallel chunks
+static std::mutex g_romMutex;
+static Int        g_romUsers = 0;
+
 // initialize ROM variables
 Void initROM()
 {
+  std::lock_guard<std::mutex> lock(g_romMutex);
+  if (g_romUsers++ > 0)
+  {
+    return;
+  }
+
   Int i, c;
 
   // g_aucConvertToBit[ x ]: log2(x/4), if x=4 -> 0, x=8 -> 1, x=16 -> 2, ...
@@ -262,6 +273,12 @@ Void initROM()
 
 Void destroyROM()
 {
+  std::lock_guard<std::mutex> lock(g_romMutex);
+  if (--g_romUsers > 0)
+  {
+    return;
+  }
+
   for(UInt groupTypeIndex = 0; groupTypeIndex < SCAN_NUMBER_OF_GROUP_TYPES; groupTypeIndex++)
   {
     for (UInt scanOrderIndex = 0; scanOrderIndex < SCAN_NUMBER_OF_TYPES; scanOrderIndex++)
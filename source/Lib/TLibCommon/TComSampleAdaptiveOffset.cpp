@@ -611,18 +611,22 @@ Void TComSampleAdaptiveOffset::offsetCTU(Int ctuRsAddr, TComPicYuv* srcYuv, TCom
 }
 
 
-Void TComSampleAdaptiveOffset::SAOProcess(TComPic* pDecPic)
+Bool TComSampleAdaptiveOffset::xIsAllDisabled() const
 {
   const Int numberOfComponents = getNumberValidComponents(m_chromaFormatIDC);
-  Bool bAllDisabled=true;
   for(Int compIdx = 0; compIdx < numberOfComponents; compIdx++)
   {
     if (m_picSAOEnabled[compIdx])
     {
-      bAllDisabled=false;
+      return false;
     }
   }
-  if (bAllDisabled)
+  return true;
+}
+
+Void TComSampleAdaptiveOffset::SAOProcess(TComPic* pDecPic)
+{
+  if (xIsAllDisabled())
   {
     return;
   }
@@ -647,16 +651,88 @@ Void TComSampleAdaptiveOffset::PCMLFDisableProcess (TComPic* pcPic)
   xPCMRestoration(pcPic);
 }
 
+/** Keep the deblocked samples of a CTU row for the SAO of the CTU rows around it.
+ * \param pDecPic picture (TComPic) pointer
+ * \param ctuRow  CTU row, of which the deblocking is finished
+ */
+Void TComSampleAdaptiveOffset::SAOCopyCtuRow(TComPic* pDecPic, Int ctuRow)
+{
+  if (xIsAllDisabled())
+  {
+    return;
+  }
+
+  TComPicYuv* srcYuv = pDecPic->getPicYuvRec();
+  TComPicYuv* dstYuv = m_tempPicYuv;
+  const Int yPos   = ctuRow*m_maxCUHeight;
+  const Int height = std::min(m_maxCUHeight, m_picHeight - yPos);
+
+  for(Int compIdx = 0; compIdx < getNumberValidComponents(m_chromaFormatIDC); compIdx++)
+  {
+    const ComponentID component = ComponentID(compIdx);
+    const UInt componentScaleY  = getComponentScaleY(component, m_chromaFormatIDC);
+    const Int  srcStride = srcYuv->getStride(component);
+    const Int  dstStride = dstYuv->getStride(component);
+    const Int  width     = srcYuv->getWidth(component);
+    const Pel* src       = srcYuv->getAddr(component) + (yPos >> componentScaleY)*srcStride;
+    Pel*       dst       = dstYuv->getAddr(component) + (yPos >> componentScaleY)*dstStride;
+
+    for(Int y = 0; y < (height >> componentScaleY); y++)
+    {
+      ::memcpy(dst, src, sizeof(Pel)*width);
+      src += srcStride;
+      dst += dstStride;
+    }
+  }
+}
+
+/** SAO of one CTU row.
+ * \param pDecPic picture (TComPic) pointer
+ * \param ctuRow  CTU row
+ * \note  SAOCopyCtuRow() must have been called for the CTU row and the CTU rows above and below it.
+ */
+Void TComSampleAdaptiveOffset::SAOProcessCtuRow(TComPic* pDecPic, Int ctuRow)
+{
+  if (xIsAllDisabled())
+  {
+    return;
+  }
+
+  for(Int ctuRsAddr = ctuRow*m_numCTUInWidth; ctuRsAddr < (ctuRow + 1)*m_numCTUInWidth; ctuRsAddr++)
+  {
+    offsetCTU(ctuRsAddr, m_tempPicYuv, pDecPic->getPicYuvRec(), (pDecPic->getPicSym()->getSAOBlkParam())[ctuRsAddr], pDecPic);
+  }
+}
+
+/** PCM LF disable process of one CTU row.
+ * \param pcPic  picture (TComPic) pointer
+ * \param ctuRow CTU row
+ */
+Void TComSampleAdaptiveOffset::PCMLFDisableProcessCtuRow (TComPic* pcPic, Int ctuRow)
+{
+  xPCMRestoration(pcPic, ctuRow*pcPic->getFrameWidthInCtus(), (ctuRow + 1)*pcPic->getFrameWidthInCtus());
+}
+
 /** Picture-level PCM restoration.
  * \param pcPic picture (TComPic) pointer
  */
 Void TComSampleAdaptiveOffset::xPCMRestoration(TComPic* pcPic)
+{
+  xPCMRestoration(pcPic, 0, pcPic->getNumberOfCtusInFrame());
+}
+
+/** PCM restoration of a range of CTUs.
+ * \param pcPic          picture (TComPic) pointer
+ * \param firstCtuRsAddr first CTU of the range, in raster scan
+ * \param endCtuRsAddr   CTU following the range, in raster scan
+ */
+Void TComSampleAdaptiveOffset::xPCMRestoration(TComPic* pcPic, Int firstCtuRsAddr, Int endCtuRsAddr)
 {
   Bool  bPCMFilter = (pcPic->getSlice(0)->getSPS()->getUsePCM() && pcPic->getSlice(0)->getSPS()->getPCMFilterDisableFlag())? true : false;
 
   if(bPCMFilter || pcPic->getSlice(0)->getPPS()->getTransquantBypassEnabledFlag())
   {
-    for( UInt ctuRsAddr = 0; ctuRsAddr < pcPic->getNumberOfCtusInFrame() ; ctuRsAddr++ )
+    for( Int ctuRsAddr = firstCtuRsAddr; ctuRsAddr < endCtuRsAddr ; ctuRsAddr++ )
     {
       TComDataCU* pcCU = pcPic->getCtu(ctuRsAddr);
 
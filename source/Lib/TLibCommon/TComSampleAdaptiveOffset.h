@@ -70,6 +70,11 @@ public:
   Void destroy();
   Void reconstructBlkSAOParams(TComPic* pic, SAOBlkParam* saoBlkParams);
   Void PCMLFDisableProcess (TComPic* pcPic);
+
+  // CTU-row based SAO, for pictures that are filtered while the CTU rows below are still being deblocked
+  Void SAOCopyCtuRow(TComPic* pDecPic, Int ctuRow);
+  Void SAOProcessCtuRow(TComPic* pDecPic, Int ctuRow);
+  Void PCMLFDisableProcessCtuRow(TComPic* pcPic, Int ctuRow);
   static Int getMaxOffsetQVal(const Int channelBitDepth) { return (1<<(std::min<Int>(channelBitDepth,MAX_SAO_TRUNCATED_BITDEPTH)-5))-1; } //Table 9-32, inclusive
 
 protected:
@@ -80,6 +85,8 @@ protected:
   Int  getMergeList(TComPic* pic, Int ctuRsAddr, SAOBlkParam* blkParams, SAOBlkParam* mergeList[NUM_SAO_MERGE_TYPES]);
   Void offsetCTU(Int ctuRsAddr, TComPicYuv* srcYuv, TComPicYuv* resYuv, SAOBlkParam& saoblkParam, TComPic* pPic);
   Void xPCMRestoration(TComPic* pcPic);
+  Void xPCMRestoration(TComPic* pcPic, Int firstCtuRsAddr, Int endCtuRsAddr);
+  Bool xIsAllDisabled() const;
   Void xPCMCURestoration ( TComDataCU* pcCU, UInt uiAbsZorderIdx, UInt uiDepth );
   Void xPCMSampleRestoration (TComDataCU* pcCU, UInt uiAbsZorderIdx, UInt uiDepth, const ComponentID compID);
 protected:
@@ -98,7 +105,6 @@ protected:
   SChar* m_signLineBuf1;
   SChar* m_signLineBuf2;
   ChromaFormat m_chromaFormatIDC;
-private:
   Bool m_picSAOEnabled[MAX_NUM_COMPONENT];
 };
 
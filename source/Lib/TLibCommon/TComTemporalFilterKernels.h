@@ -0,0 +1,89 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2022, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TComTemporalFilterKernels.h
+    \brief    Block kernels of the GOP-based temporal filter (header)
+*/
+
+#ifndef __TCOMTEMPORALFILTERKERNELS__
+#define __TCOMTEMPORALFILTERKERNELS__
+
+#include "CommonDef.h"
+#if VECTOR_CODING__X86_DISPATCH
+#include "CommonDefX86.h"
+#endif
+
+//! \ingroup TLibCommon
+//! \{
+
+// ====================================================================================================================
+// Class definition
+// ====================================================================================================================
+
+/// vector kernels of the motion search and the noise statistics of TEncTemporalFilter
+/** A kernel is NULL when there is none for the selected extension, and the caller then uses its own scalar code.
+ *  The kernels give exactly the same results as the scalar code for blocks of 8N (N <= 8) samples, respectively
+ *  noise statistics blocks 4 or 8 samples wide, and up to 10 bit.
+ */
+class TComTemporalFilterKernels
+{
+public:
+  TComTemporalFilterKernels();
+
+  /// squared error of a bs x bs block at a full-sample offset; stops after the first row at which the error exceeds besterror
+  Int  (*m_motionErrorFullPel)   ( const Pel* origRow, const Int origStride, const Pel* bufferRow, const Int buffStride, const Int bs, const Int besterror );
+  /// squared error of a bs x bs block at a fractional-sample offset, bufferRow pointing 3 samples above and left of the integer position
+  Int  (*m_motionErrorFracPel)   ( const Pel* origRow, const Int origStride, const Pel* bufferRow, const Int buffStride, const Int bs,
+                                   const Int* xFilter, const Int* yFilter, const Int maxSampleValue, const Int besterror );
+  /// squared differences to the reference and squared differences of adjacent differences of a blkSizeX x blkSizeY block
+  Void (*m_blockNoiseStatistics) ( const Pel* srcPel, const Int srcStride, const Pel* refPel, const Int refStride, const Int blkSizeX, const Int blkSizeY,
+                                   Double& variance, Double& diffsum );
+
+private:
+#if VECTOR_CODING__X86_DISPATCH
+  // vector kernels (x86/TComTemporalFilterKernelsX86.h), installed by xInitTemporalFilterKernelsX86 for the extension selected at run time
+  Void    xInitTemporalFilterKernelsX86();
+  template<X86_VEXT vext>
+  Void    xInitTemporalFilterKernelsX86();
+
+  template<X86_VEXT vext> static Int  xMotionErrorFullPelX86   ( const Pel* origRow, const Int origStride, const Pel* bufferRow, const Int buffStride, const Int bs, const Int besterror );
+  template<X86_VEXT vext> static Int  xMotionErrorFracPelX86   ( const Pel* origRow, const Int origStride, const Pel* bufferRow, const Int buffStride, const Int bs,
+                                                                 const Int* xFilter, const Int* yFilter, const Int maxSampleValue, const Int besterror );
+  template<X86_VEXT vext> static Void xBlockNoiseStatisticsX86 ( const Pel* srcPel, const Int srcStride, const Pel* refPel, const Int refStride, const Int blkSizeX, const Int blkSizeY,
+                                                                 Double& variance, Double& diffsum );
+#endif
+};// END CLASS DEFINITION TComTemporalFilterKernels
+
+//! \}
+
+#endif // __TCOMTEMPORALFILTERKERNELS__
@@ -131,6 +131,8 @@ TComTrQuant::TComTrQuant()
   // allocate bit estimation class  (for RDOQ)
   m_pcEstBitsSbac = new estBitsSbacStruct;
   initScalingList();
+
+  xInitKernels();
 }
 
 TComTrQuant::~TComTrQuant()
@@ -1213,31 +1215,15 @@ Void TComTrQuant::xQuant(       TComTU       &rTu,
 #endif
 
     const Int iAdd   = (pcCU->getSlice()->getSliceType()==I_SLICE ? 171 : 85) << (iQBits-9);
-    const Int qBits8 = iQBits - 8;
-
-    for( Int uiBlockPos = 0; uiBlockPos < uiWidth*uiHeight; uiBlockPos++ )
-    {
-      const TCoeff iLevel   = piCoef[uiBlockPos];
-      const TCoeff iSign    = (iLevel < 0 ? -1: 1);
-
-      const Int64  tmpLevel = (Int64)abs(iLevel) * (enableScalingLists ? piQuantCoeff[uiBlockPos] : defaultQuantisationCoefficient);
 
 #if ADAPTIVE_QP_SELECTION
-      if( m_bUseAdaptQpSelect )
-      {
-        piArlCCoef[uiBlockPos] = (TCoeff)((tmpLevel + iAddC ) >> iQBitsC);
-      }
+    uiAbsSum += m_fpQuant( piCoef, piQCoef, m_bUseAdaptQpSelect ? piArlCCoef : NULL, deltaU, uiWidth*uiHeight, enableScalingLists ? piQuantCoeff : NULL, defaultQuantisationCoefficient,
+                           iQBits, iAdd, iQBitsC, iAddC, entropyCodingMinimum, entropyCodingMaximum );
+#else
+    uiAbsSum += m_fpQuant( piCoef, piQCoef, NULL, deltaU, uiWidth*uiHeight, enableScalingLists ? piQuantCoeff : NULL, defaultQuantisationCoefficient,
+                           iQBits, iAdd, 0, 0, entropyCodingMinimum, entropyCodingMaximum );
 #endif
 
-      const TCoeff quantisedMagnitude = TCoeff((tmpLevel + iAdd ) >> iQBits);
-      deltaU[uiBlockPos] = (TCoeff)((tmpLevel - (quantisedMagnitude<<iQBits) )>> qBits8);
-
-      uiAbsSum += quantisedMagnitude;
-      const TCoeff quantisedCoefficient = quantisedMagnitude * iSign;
-
-      piQCoef[uiBlockPos] = Clip3<TCoeff>( entropyCodingMinimum, entropyCodingMaximum, quantisedCoefficient );
-    } // for n
-
     if( pcCU->getSlice()->getPPS()->getSignDataHidingEnabledFlag() )
     {
       if(uiAbsSum >= 2) //this prevents TUs with only one coefficient of value 1 from being tested
@@ -1291,10 +1277,69 @@ Bool TComTrQuant::xNeedRDOQ( TComTU &rTu, TCoeff * pSrc, const ComponentID compI
   // iAdd is different from the iAdd used in normal quantization
   const Int iAdd   = (compID == COMPONENT_Y ? 171 : 256) << (iQBits-9);
 
-  for( Int uiBlockPos = 0; uiBlockPos < uiWidth*uiHeight; uiBlockPos++ )
+  return m_fpNeedRDOQ( piCoef, uiWidth*uiHeight, enableScalingLists ? piQuantCoeff : NULL, defaultQuantisationCoefficient, iQBits, iAdd );
+}
+
+/** Quantisation of a block of coefficients, without RDOQ
+ *  \param piCoef               input coefficients
+ *  \param piQCoef              quantised coefficients
+ *  \param piArlCCoef           levels at ARL_C_PRECISION extra bits of precision, written when not NULL
+ *  \param deltaU               quantisation errors, for sign data hiding
+ *  \param numCoeff             number of coefficients
+ *  \param piQuantCoeff         scaling list, or NULL for the flat quantCoeff
+ *  \param quantCoeff           flat quantisation coefficient
+ *  \param iQBits               quantisation shift
+ *  \param iAdd                 rounding offset
+ *  \param iQBitsC              quantisation shift of piArlCCoef
+ *  \param iAddC                rounding offset of piArlCCoef
+ *  \param entropyCodingMinimum minimum of the quantised coefficients
+ *  \param entropyCodingMaximum maximum of the quantised coefficients
+ *  \returns sum of the absolute levels
+ */
+TCoeff TComTrQuant::xQuantBlock( const TCoeff *piCoef, TCoeff *piQCoef, TCoeff *piArlCCoef, TCoeff *deltaU, Int numCoeff, const Int *piQuantCoeff, Int quantCoeff,
+                                 Int iQBits, Int iAdd, Int iQBitsC, Int iAddC, TCoeff entropyCodingMinimum, TCoeff entropyCodingMaximum )
+{
+  const Int qBits8   = iQBits - 8;
+  TCoeff    uiAbsSum = 0;
+
+  for( Int uiBlockPos = 0; uiBlockPos < numCoeff; uiBlockPos++ )
   {
     const TCoeff iLevel   = piCoef[uiBlockPos];
-    const Int64  tmpLevel = (Int64)abs(iLevel) * (enableScalingLists ? piQuantCoeff[uiBlockPos] : defaultQuantisationCoefficient);
+    const TCoeff iSign    = (iLevel < 0 ? -1: 1);
+
+    const Int64  tmpLevel = (Int64)abs(iLevel) * (piQuantCoeff != NULL ? piQuantCoeff[uiBlockPos] : quantCoeff);
+
+    if( piArlCCoef != NULL )
+    {
+      piArlCCoef[uiBlockPos] = (TCoeff)((tmpLevel + iAddC ) >> iQBitsC);
+    }
+
+    const TCoeff quantisedMagnitude = TCoeff((tmpLevel + iAdd ) >> iQBits);
+    deltaU[uiBlockPos] = (TCoeff)((tmpLevel - (quantisedMagnitude<<iQBits) )>> qBits8);
+
+    uiAbsSum += quantisedMagnitude;
+    const TCoeff quantisedCoefficient = quantisedMagnitude * iSign;
+
+    piQCoef[uiBlockPos] = Clip3<TCoeff>( entropyCodingMinimum, entropyCodingMaximum, quantisedCoefficient );
+  } // for n
+
+  return uiAbsSum;
+}
+
+/** Check whether any coefficient of a block quantises to a non-zero level
+ *  \param piCoef       input coefficients
+ *  \param numCoeff     number of coefficients
+ *  \param piQuantCoeff scaling list, or NULL for the flat quantCoeff
+ *  \param quantCoeff   flat quantisation coefficient
+ *  \param iQBits       quantisation shift
+ *  \param iAdd         rounding offset
+ */
+Bool TComTrQuant::xNeedRDOQBlock( const TCoeff *piCoef, Int numCoeff, const Int *piQuantCoeff, Int quantCoeff, Int iQBits, Int iAdd )
+{
+  for( Int uiBlockPos = 0; uiBlockPos < numCoeff; uiBlockPos++ )
+  {
+    const TCoeff iLevel   = piCoef[uiBlockPos];
+    const Int64  tmpLevel = (Int64)abs(iLevel) * (piQuantCoeff != NULL ? piQuantCoeff[uiBlockPos] : quantCoeff);
     const TCoeff quantisedMagnitude = TCoeff((tmpLevel + iAdd ) >> iQBits);
 
     if ( quantisedMagnitude != 0 )
@@ -1305,6 +1350,47 @@ Bool TComTrQuant::xNeedRDOQ( TComTU &rTu, TCoeff * pSrc, const ComponentID compI
   return false;
 }
 
+/** Dequantisation of a block of coefficients
+ *  \param piQCoef          quantised coefficients
+ *  \param piCoef           dequantised coefficients
+ *  \param numCoeff         number of coefficients
+ *  \param piDequantCoef    scaling list, or NULL for the flat scale
+ *  \param scale            flat dequantisation coefficient
+ *  \param rightShift       dequantisation shift, a left shift when negative
+ *  \param inputMinimum     minimum of the quantised coefficients
+ *  \param inputMaximum     maximum of the quantised coefficients
+ *  \param transformMinimum minimum of the dequantised coefficients
+ *  \param transformMaximum maximum of the dequantised coefficients
+ */
+Void TComTrQuant::xDeQuantBlock( const TCoeff *piQCoef, TCoeff *piCoef, Int numCoeff, const Int *piDequantCoef, Int scale, Int rightShift,
+                                 Intermediate_Int inputMinimum, Intermediate_Int inputMaximum, TCoeff transformMinimum, TCoeff transformMaximum )
+{
+  if(rightShift > 0)
+  {
+    const Intermediate_Int iAdd = 1 << (rightShift - 1);
+
+    for( Int n = 0; n < numCoeff; n++ )
+    {
+      const TCoeff           clipQCoef = TCoeff(Clip3<Intermediate_Int>(inputMinimum, inputMaximum, piQCoef[n]));
+      const Intermediate_Int iCoeffQ   = ((Intermediate_Int(clipQCoef) * (piDequantCoef != NULL ? piDequantCoef[n] : scale)) + iAdd ) >> rightShift;
+
+      piCoef[n] = TCoeff(Clip3<Intermediate_Int>(transformMinimum,transformMaximum,iCoeffQ));
+    }
+  }
+  else
+  {
+    const Int leftShift = -rightShift;
+
+    for( Int n = 0; n < numCoeff; n++ )
+    {
+      const TCoeff           clipQCoef = TCoeff(Clip3<Intermediate_Int>(inputMinimum, inputMaximum, piQCoef[n]));
+      const Intermediate_Int iCoeffQ   = (Intermediate_Int(clipQCoef) * (piDequantCoef != NULL ? piDequantCoef[n] : scale)) << leftShift;
+
+      piCoef[n] = TCoeff(Clip3<Intermediate_Int>(transformMinimum,transformMaximum,iCoeffQ));
+    }
+  }
+}
+
 Void TComTrQuant::xDeQuant(       TComTU        &rTu,
                             const TCoeff       * pSrc,
                                   TCoeff       * pDes,
@@ -1359,30 +1445,7 @@ Void TComTrQuant::xDeQuant(       TComTU        &rTu,
 
     Int *piDequantCoef = getDequantCoeff(scalingListType,QP_rem,uiLog2TrSize-2);
 
-    if(rightShift > 0)
-    {
-      const Intermediate_Int iAdd = 1 << (rightShift - 1);
-
-      for( Int n = 0; n < numSamplesInBlock; n++ )
-      {
-        const TCoeff           clipQCoef = TCoeff(Clip3<Intermediate_Int>(inputMinimum, inputMaximum, piQCoef[n]));
-        const Intermediate_Int iCoeffQ   = ((Intermediate_Int(clipQCoef) * piDequantCoef[n]) + iAdd ) >> rightShift;
-
-        piCoef[n] = TCoeff(Clip3<Intermediate_Int>(transformMinimum,transformMaximum,iCoeffQ));
-      }
-    }
-    else
-    {
-      const Int leftShift = -rightShift;
-
-      for( Int n = 0; n < numSamplesInBlock; n++ )
-      {
-        const TCoeff           clipQCoef = TCoeff(Clip3<Intermediate_Int>(inputMinimum, inputMaximum, piQCoef[n]));
-        const Intermediate_Int iCoeffQ   = (Intermediate_Int(clipQCoef) * piDequantCoef[n]) << leftShift;
-
-        piCoef[n] = TCoeff(Clip3<Intermediate_Int>(transformMinimum,transformMaximum,iCoeffQ));
-      }
-    }
+    m_fpDeQuant( piQCoef, piCoef, numSamplesInBlock, piDequantCoef, 0, rightShift, inputMinimum, inputMaximum, transformMinimum, transformMaximum );
   }
   else
   {
@@ -1396,30 +1459,7 @@ Void TComTrQuant::xDeQuant(       TComTU        &rTu,
     const Intermediate_Int inputMinimum        = -(1 << (targetInputBitDepth - 1));
     const Intermediate_Int inputMaximum        =  (1 << (targetInputBitDepth - 1)) - 1;
 
-    if (rightShift > 0)
-    {
-      const Intermediate_Int iAdd = 1 << (rightShift - 1);
-
-      for( Int n = 0; n < numSamplesInBlock; n++ )
-      {
-        const TCoeff           clipQCoef = TCoeff(Clip3<Intermediate_Int>(inputMinimum, inputMaximum, piQCoef[n]));
-        const Intermediate_Int iCoeffQ   = (Intermediate_Int(clipQCoef) * scale + iAdd) >> rightShift;
-
-        piCoef[n] = TCoeff(Clip3<Intermediate_Int>(transformMinimum,transformMaximum,iCoeffQ));
-      }
-    }
-    else
-    {
-      const Int leftShift = -rightShift;
-
-      for( Int n = 0; n < numSamplesInBlock; n++ )
-      {
-        const TCoeff           clipQCoef = TCoeff(Clip3<Intermediate_Int>(inputMinimum, inputMaximum, piQCoef[n]));
-        const Intermediate_Int iCoeffQ   = (Intermediate_Int(clipQCoef) * scale) << leftShift;
-
-        piCoef[n] = TCoeff(Clip3<Intermediate_Int>(transformMinimum,transformMaximum,iCoeffQ));
-      }
-    }
+    m_fpDeQuant( piQCoef, piCoef, numSamplesInBlock, NULL, scale, rightShift, inputMinimum, inputMaximum, transformMinimum, transformMaximum );
   }
 }
 
@@ -1444,6 +1484,24 @@ Void TComTrQuant::init(   UInt  uiMaxTrSize,
   m_bUseAdaptQpSelect = bUseAdaptQpSelect;
 #endif
   m_useTransformSkipFast = useTransformSkipFast;
+
+  // the x86 extension limit of the encoder is set by now
+  xInitKernels();
+}
+
+/** Install the transform and quantisation kernels
+ */
+Void TComTrQuant::xInitKernels()
+{
+  m_fpTransform    = xTrBlock;
+  m_fpInvTransform = xITrBlock;
+  m_fpQuant        = xQuantBlock;
+  m_fpNeedRDOQ     = xNeedRDOQBlock;
+  m_fpDeQuant      = xDeQuantBlock;
+
+#if VECTOR_CODING__X86_DISPATCH
+  xInitTrQuantX86();
+#endif
 }
 
 
@@ -1949,6 +2007,21 @@ Void TComTrQuant::xT( const Int channelBitDepth, Bool useDST, Pel* piBlkResi, UI
   }
 #endif
 
+  m_fpTransform( channelBitDepth, useDST, piBlkResi, uiStride, psCoeff, iWidth, iHeight, maxLog2TrDynamicRange );
+}
+
+/** Core NxN forward transform (2D) of a block of residuals
+ *  \param bitDepth bit depth of channel
+ *  \param useDST
+ *  \param piBlkResi input data (residual)
+ *  \param uiStride stride of input residual data
+ *  \param psCoeff output data (transform coefficients)
+ *  \param iWidth transform width
+ *  \param iHeight transform height
+ *  \param maxLog2TrDynamicRange
+ */
+Void TComTrQuant::xTrBlock( Int bitDepth, Bool useDST, const Pel* piBlkResi, UInt uiStride, TCoeff* psCoeff, Int iWidth, Int iHeight, Int maxLog2TrDynamicRange )
+{
   TCoeff block[ MAX_TU_SIZE * MAX_TU_SIZE ];
   TCoeff coeff[ MAX_TU_SIZE * MAX_TU_SIZE ];
 
@@ -1960,7 +2033,7 @@ Void TComTrQuant::xT( const Int channelBitDepth, Bool useDST, Pel* piBlkResi, UI
     }
   }
 
-  xTrMxN( channelBitDepth, block, coeff, iWidth, iHeight, useDST, maxLog2TrDynamicRange );
+  xTrMxN( bitDepth, block, coeff, iWidth, iHeight, useDST, maxLog2TrDynamicRange );
 
   memcpy(psCoeff, coeff, (iWidth * iHeight * sizeof(TCoeff)));
 }
@@ -1985,12 +2058,27 @@ Void TComTrQuant::xIT( const Int channelBitDepth, Bool useDST, TCoeff* plCoef, P
   }
 #endif
 
+  m_fpInvTransform( channelBitDepth, useDST, plCoef, pResidual, uiStride, iWidth, iHeight, maxLog2TrDynamicRange );
+}
+
+/** Core NxN inverse transform (2D) of a block of coefficients
+ *  \param bitDepth bit depth of channel
+ *  \param useDST
+ *  \param plCoef input data (transform coefficients)
+ *  \param pResidual output data (residual)
+ *  \param uiStride stride of input residual data
+ *  \param iWidth transform width
+ *  \param iHeight transform height
+ *  \param maxLog2TrDynamicRange
+ */
+Void TComTrQuant::xITrBlock( Int bitDepth, Bool useDST, const TCoeff* plCoef, Pel* pResidual, UInt uiStride, Int iWidth, Int iHeight, Int maxLog2TrDynamicRange )
+{
   TCoeff block[ MAX_TU_SIZE * MAX_TU_SIZE ];
   TCoeff coeff[ MAX_TU_SIZE * MAX_TU_SIZE ];
 
   memcpy(coeff, plCoef, (iWidth * iHeight * sizeof(TCoeff)));
 
-  xITrMxN( channelBitDepth, coeff, block, iWidth, iHeight, useDST, maxLog2TrDynamicRange );
+  xITrMxN( bitDepth, coeff, block, iWidth, iHeight, useDST, maxLog2TrDynamicRange );
 
   for (Int y = 0; y < iHeight; y++)
   {
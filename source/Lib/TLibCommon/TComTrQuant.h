@@ -43,6 +43,9 @@
 #include "TComDataCU.h"
 #include "TComChromaFormat.h"
 #include "ContextTables.h"
+#if VECTOR_CODING__X86_DISPATCH
+#include "CommonDefX86.h"
+#endif
 
 //! \ingroup TLibCommon
 //! \{
@@ -230,6 +233,49 @@ protected:
   Double    m_errScaleNoScalingList[SCALING_LIST_SIZE_NUM][SCALING_LIST_NUM][SCALING_LIST_REM_NUM]; ///< array of quantization matrix coefficient 4x4
 
 private:
+#if VECTOR_CODING__X86_DISPATCH
+  friend class SimdKernelTest;                                         ///< checks the kernels against the scalar functions (source/App/utils/SimdKernelTest)
+#endif
+
+  typedef Void   (*FpTransform)   ( Int bitDepth, Bool useDST, const Pel *piBlkResi, UInt uiStride, TCoeff *psCoeff, Int iWidth, Int iHeight, Int maxLog2TrDynamicRange );
+  typedef Void   (*FpInvTransform)( Int bitDepth, Bool useDST, const TCoeff *plCoef, Pel *pResidual, UInt uiStride, Int iWidth, Int iHeight, Int maxLog2TrDynamicRange );
+  typedef TCoeff (*FpQuant)       ( const TCoeff *piCoef, TCoeff *piQCoef, TCoeff *piArlCCoef, TCoeff *deltaU, Int numCoeff, const Int *piQuantCoeff, Int quantCoeff,
+                                    Int iQBits, Int iAdd, Int iQBitsC, Int iAddC, TCoeff entropyCodingMinimum, TCoeff entropyCodingMaximum );
+  typedef Bool   (*FpNeedRDOQ)    ( const TCoeff *piCoef, Int numCoeff, const Int *piQuantCoeff, Int quantCoeff, Int iQBits, Int iAdd );
+  typedef Void   (*FpDeQuant)     ( const TCoeff *piQCoef, TCoeff *piCoef, Int numCoeff, const Int *piDequantCoef, Int scale, Int rightShift,
+                                    Intermediate_Int inputMinimum, Intermediate_Int inputMaximum, TCoeff transformMinimum, TCoeff transformMaximum );
+
+  FpTransform    m_fpTransform;                                        ///< 2D forward transform of a block of residuals
+  FpInvTransform m_fpInvTransform;                                     ///< 2D inverse transform of a block of coefficients
+  FpQuant        m_fpQuant;                                            ///< quantisation without RDOQ
+  FpNeedRDOQ     m_fpNeedRDOQ;                                         ///< check for a non-zero level, for selective RDOQ
+  FpDeQuant      m_fpDeQuant;                                          ///< dequantisation
+
+  Void          xInitKernels ();
+
+  static Void   xTrBlock     ( Int bitDepth, Bool useDST, const Pel *piBlkResi, UInt uiStride, TCoeff *psCoeff, Int iWidth, Int iHeight, Int maxLog2TrDynamicRange );
+  static Void   xITrBlock    ( Int bitDepth, Bool useDST, const TCoeff *plCoef, Pel *pResidual, UInt uiStride, Int iWidth, Int iHeight, Int maxLog2TrDynamicRange );
+  static TCoeff xQuantBlock  ( const TCoeff *piCoef, TCoeff *piQCoef, TCoeff *piArlCCoef, TCoeff *deltaU, Int numCoeff, const Int *piQuantCoeff, Int quantCoeff,
+                               Int iQBits, Int iAdd, Int iQBitsC, Int iAddC, TCoeff entropyCodingMinimum, TCoeff entropyCodingMaximum );
+  static Bool   xNeedRDOQBlock( const TCoeff *piCoef, Int numCoeff, const Int *piQuantCoeff, Int quantCoeff, Int iQBits, Int iAdd );
+  static Void   xDeQuantBlock( const TCoeff *piQCoef, TCoeff *piCoef, Int numCoeff, const Int *piDequantCoef, Int scale, Int rightShift,
+                               Intermediate_Int inputMinimum, Intermediate_Int inputMaximum, TCoeff transformMinimum, TCoeff transformMaximum );
+
+#if VECTOR_CODING__X86_DISPATCH
+  // vector kernels (x86/TComTrQuantX86.h), installed by xInitTrQuantX86 for the extension selected at run time
+  Void    xInitTrQuantX86();
+  template<X86_VEXT vext>
+  Void    xInitTrQuantX86();
+
+  template<X86_VEXT vext> static Void   xTrBlockX86      ( Int bitDepth, Bool useDST, const Pel *piBlkResi, UInt uiStride, TCoeff *psCoeff, Int iWidth, Int iHeight, Int maxLog2TrDynamicRange );
+  template<X86_VEXT vext> static Void   xITrBlockX86     ( Int bitDepth, Bool useDST, const TCoeff *plCoef, Pel *pResidual, UInt uiStride, Int iWidth, Int iHeight, Int maxLog2TrDynamicRange );
+  template<X86_VEXT vext> static TCoeff xQuantBlockX86   ( const TCoeff *piCoef, TCoeff *piQCoef, TCoeff *piArlCCoef, TCoeff *deltaU, Int numCoeff, const Int *piQuantCoeff, Int quantCoeff,
+                                                           Int iQBits, Int iAdd, Int iQBitsC, Int iAddC, TCoeff entropyCodingMinimum, TCoeff entropyCodingMaximum );
+  template<X86_VEXT vext> static Bool   xNeedRDOQBlockX86( const TCoeff *piCoef, Int numCoeff, const Int *piQuantCoeff, Int quantCoeff, Int iQBits, Int iAdd );
+  template<X86_VEXT vext> static Void   xDeQuantBlockX86 ( const TCoeff *piQCoef, TCoeff *piCoef, Int numCoeff, const Int *piDequantCoef, Int scale, Int rightShift,
+                                                           Intermediate_Int inputMinimum, Intermediate_Int inputMaximum, TCoeff transformMinimum, TCoeff transformMaximum );
+#endif
+
   // forward Transform
   Void xT   ( const Int channelBitDepth, Bool useDST, Pel* piBlkResi, UInt uiStride, TCoeff* psCoeff, Int iWidth, Int iHeight, const Int maxLog2TrDynamicRange );
 
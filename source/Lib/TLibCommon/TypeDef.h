@@ -159,6 +159,12 @@
 #define VECTOR_CODING__DISTORTION_CALCULATIONS            0 ///< enable vector coding for distortion calculations   0 (default if SSE not possible) disable SSE vector coding. Should not affect RD costs/decisions. Code back-ported from JEM2.0.
 #endif
 
+#if defined __SSE4_1__ || defined __AVX2__ || defined __AVX__ || defined _M_AMD64 || defined _M_X64
+#define VECTOR_CODING__X86_DISPATCH                       1 ///< enable the SSE4.1/AVX2/AVX-512 kernels of TLibCommon/x86, selected at run time from the CPUID flags. 1 (default if x86). Should not affect RD costs/decisions.
+#else
+#define VECTOR_CODING__X86_DISPATCH                       0 ///< enable the SSE4.1/AVX2/AVX-512 kernels of TLibCommon/x86, selected at run time from the CPUID flags. 0 (default if not x86).
+#endif
+
 // ====================================================================================================================
 // Derived macros
 // ====================================================================================================================
@@ -472,6 +478,25 @@ enum TransformDirection
   TRANSFORM_NUMBER_OF_DIRECTIONS = 2
 };
 
+/// supported ROI mask input formats
+enum RoiMaskFormat
+{
+  ROI_MASK_FORMAT_AUTO              = 0,  ///< derived from the file name
+  ROI_MASK_FORMAT_IMAGE             = 1,  ///< single image or printf-style numbered image series
+  ROI_MASK_FORMAT_YUV400            = 2,  ///< raw 8-bit luma-only video
+  ROI_MASK_FORMAT_Y4M               = 3,  ///< 8-bit Y4M video, chroma planes ignored
+  ROI_MASK_FORMAT_PACKED1BIT        = 4,  ///< raw video with one bit per sample
+  ROI_MASK_FORMAT_NUMBER_OF_FORMATS = 5
+};
+
+/// picture regions distinguished by the ROI mask, indexed by the occupancy of a mask block
+enum RoiRegion
+{
+  ROI_REGION_BACKGROUND = 0,
+  ROI_REGION_FOREGROUND = 1,
+  NUM_ROI_REGIONS       = 2
+};
+
 /// supported ME search methods
 enum MESearchMethod
 {
@@ -763,6 +788,14 @@ enum LumaLevelToDQPMode
   LUMALVL_TO_DQP_NUM_MODES  = 3
 };
 
+enum RoiLevelToDQPMode
+{
+  ROI_LEVEL_TO_DQP_DISABLED   = 0, // binary mask, CUs touching the foreground use the foreground QP
+  ROI_LEVEL_TO_DQP_MAX_METHOD = 1, // use maximum importance level covered by the CU
+  ROI_LEVEL_TO_DQP_AVG_METHOD = 2, // use area-weighted mean importance level covered by the CU
+  ROI_LEVEL_TO_DQP_NUM_MODES  = 3
+};
+
 // ====================================================================================================================
 // Type definition
 // ====================================================================================================================
@@ -913,6 +946,14 @@ struct LumaLevelToDeltaQPMapping
   Bool isEnabled() const { return mode!=LUMALVL_TO_DQP_DISABLED; }
 };
 
+struct RoiLevelToDeltaQPMapping
+{
+  RoiLevelToDQPMode                  mode;             ///< use deltaQP determined by the ROI importance level of the CU
+  Bool                               interpolate;      ///< interpolate linearly between mapping points instead of holding the last delta QP
+  std::vector< std::pair<Int, Int> > mapping;          ///< first=importance level, second=delta QP.
+  Bool isEnabled() const { return mode!=ROI_LEVEL_TO_DQP_DISABLED; }
+};
+
 struct WCGChromaQPControl
 {
   Bool isEnabled() const { return enabled; }
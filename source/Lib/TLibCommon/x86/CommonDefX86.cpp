@@ -0,0 +1,167 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2022, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     CommonDefX86.cpp
+    \brief    Run-time selection of the x86 vector extension
+*/
+
+#include "CommonDefX86.h"
+
+#if VECTOR_CODING__X86_DISPATCH
+
+#include <algorithm>
+#include <cctype>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+//! \ingroup TLibCommon
+//! \{
+
+static X86_VEXT s_x86ExtensionLimit = X86_AVX512;
+
+static const TChar* const s_x86ExtensionNames[NUMBER_OF_X86_VEXT] = { "SCALAR", "SSE41", "SSE42", "AVX", "AVX2", "AVX512" };
+
+static Void xCpuid( UInt leaf, UInt subLeaf, UInt regs[4] )
+{
+#if defined(_MSC_VER)
+  Int info[4];
+  __cpuidex( info, Int(leaf), Int(subLeaf) );
+  for( Int i = 0; i < 4; i++ )
+  {
+    regs[i] = UInt(info[i]);
+  }
+#else
+  if( !__get_cpuid_count( leaf, subLeaf, &regs[0], &regs[1], &regs[2], &regs[3] ) )
+  {
+    regs[0] = regs[1] = regs[2] = regs[3] = 0;
+  }
+#endif
+}
+
+/** Read the register state the OS saves on context switches (XCR0). Only valid when CPUID reports OSXSAVE.
+ */
+static UInt64 xGetXcr0()
+{
+#if defined(_MSC_VER)
+  return _xgetbv( 0 );
+#else
+  UInt eax, edx;
+  __asm__ volatile( "xgetbv" : "=a"( eax ), "=d"( edx ) : "c"( 0 ) );
+  return ( UInt64( edx ) << 32 ) | eax;
+#endif
+}
+
+/** Find the best extension that both the CPU and the OS support.
+ * AVX and above need the OS to save the YMM (and for AVX-512 the ZMM and mask) registers.
+ */
+static X86_VEXT xDetectX86Extension()
+{
+  UInt regs[4];
+  xCpuid( 0, 0, regs );
+  const UInt maxLeaf = regs[0];
+
+  xCpuid( 1, 0, regs );
+  const UInt ecx1 = regs[2];
+  if( ( ecx1 & ( 1u << 19 ) ) == 0 )
+  {
+    return X86_SCALAR;
+  }
+  if( ( ecx1 & ( 1u << 20 ) ) == 0 )
+  {
+    return X86_SSE41;
+  }
+
+  const Bool   bOsXSave = ( ecx1 & ( 1u << 27 ) ) != 0;
+  const UInt64 xcr0     = bOsXSave ? xGetXcr0() : 0;
+  if( ( ecx1 & ( 1u << 28 ) ) == 0 || ( xcr0 & 0x06 ) != 0x06 )
+  {
+    return X86_SSE42;
+  }
+  if( maxLeaf < 7 )
+  {
+    return X86_AVX;
+  }
+
+  xCpuid( 7, 0, regs );
+  const UInt ebx7 = regs[1];
+  if( ( ebx7 & ( 1u << 5 ) ) == 0 )
+  {
+    return X86_AVX;
+  }
+  if( ( ebx7 & ( 1u << 16 ) ) == 0 || ( ebx7 & ( 1u << 30 ) ) == 0 || ( xcr0 & 0xe6 ) != 0xe6 )
+  {
+    return X86_AVX2;
+  }
+  return X86_AVX512;
+}
+
+X86_VEXT getX86Extension()
+{
+  static const X86_VEXT detected = xDetectX86Extension();
+  return std::min( detected, s_x86ExtensionLimit );
+}
+
+/** The limit is a process-wide setting: set it before the encoder objects (and their threads) are created.
+ */
+Void setX86ExtensionLimit( X86_VEXT vext )
+{
+  s_x86ExtensionLimit = vext;
+}
+
+const TChar* getX86ExtensionName( X86_VEXT vext )
+{
+  return s_x86ExtensionNames[vext];
+}
+
+Bool parseX86ExtensionName( const std::string& name, X86_VEXT& vext )
+{
+  std::string upperName = name;
+  std::transform( upperName.begin(), upperName.end(), upperName.begin(), ::toupper );
+  for( Int i = 0; i < NUMBER_OF_X86_VEXT; i++ )
+  {
+    if( upperName == s_x86ExtensionNames[i] )
+    {
+      vext = X86_VEXT( i );
+      return true;
+    }
+  }
+  return false;
+}
+
+//! \}
+
+#endif // VECTOR_CODING__X86_DISPATCH
@@ -0,0 +1,93 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2022, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     CommonDefX86.h
+    \brief    Run-time selection of the x86 vector extension (header)
+*/
+
+#ifndef __COMMONDEFX86__
+#define __COMMONDEFX86__
+
+#include <string>
+#include "CommonDef.h"
+
+#if VECTOR_CODING__X86_DISPATCH
+
+//! \ingroup TLibCommon
+//! \{
+
+// ====================================================================================================================
+// Enumeration
+// ====================================================================================================================
+
+/// x86 vector extensions, in increasing order of capability
+enum X86_VEXT
+{
+  X86_SCALAR = 0,       ///< no kernels of TLibCommon/x86
+  X86_SSE41,
+  X86_SSE42,
+  X86_AVX,
+  X86_AVX2,
+  X86_AVX512,           ///< AVX-512 F and BW
+  NUMBER_OF_X86_VEXT
+};
+
+// ====================================================================================================================
+// Register widths of the kernels, set by the target flags of x86/<extension>/*.cpp
+// ====================================================================================================================
+
+#if defined( USE_AVX512 )
+#define X86_KERNELS_AVX2                                  1 ///< 256-bit kernels
+#define X86_KERNELS_AVX512                                1 ///< 512-bit kernels
+#elif defined( USE_AVX2 )
+#define X86_KERNELS_AVX2                                  1
+#define X86_KERNELS_AVX512                                0
+#else
+#define X86_KERNELS_AVX2                                  0
+#define X86_KERNELS_AVX512                                0
+#endif
+
+// ====================================================================================================================
+// Function declarations
+// ====================================================================================================================
+
+X86_VEXT    getX86Extension        ();                                   ///< extension used by the kernels: the best one supported by the CPU and the OS, capped by the limit
+Void        setX86ExtensionLimit   ( X86_VEXT vext );                    ///< cap the extension used by objects initialised from now on
+const TChar* getX86ExtensionName    ( X86_VEXT vext );
+Bool        parseX86ExtensionName  ( const std::string& name, X86_VEXT& vext ); ///< case-insensitive; returns false for an unknown name
+
+//! \}
+
+#endif // VECTOR_CODING__X86_DISPATCH
+
+#endif // __COMMONDEFX86__
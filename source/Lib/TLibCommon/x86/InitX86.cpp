@@ -0,0 +1,172 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2022, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     InitX86.cpp
+    \brief    Installation of the kernels for the x86 extension selected at run time
+*/
+
+#include "CommonDefX86.h"
+#include "TComRdCost.h"
+#include "TComInterpolationFilter.h"
+#include "TComTrQuant.h"
+#include "TComPrediction.h"
+#include "TComLoopFilter.h"
+#include "TComTemporalFilterKernels.h"
+
+#if VECTOR_CODING__X86_DISPATCH
+
+//! \ingroup TLibCommon
+//! \{
+
+Void TComRdCost::xInitRdCostX86()
+{
+  switch( getX86Extension() )
+  {
+  case X86_AVX512:
+    xInitRdCostX86<X86_AVX512>();
+    break;
+  case X86_AVX2:
+    xInitRdCostX86<X86_AVX2>();
+    break;
+  case X86_AVX:
+  case X86_SSE42:
+  case X86_SSE41:
+    xInitRdCostX86<X86_SSE41>();
+    break;
+  default:
+    break;
+  }
+}
+
+Void TComInterpolationFilter::xInitInterpolationFilterX86()
+{
+  switch( getX86Extension() )
+  {
+  case X86_AVX512:
+    xInitInterpolationFilterX86<X86_AVX512>();
+    break;
+  case X86_AVX2:
+    xInitInterpolationFilterX86<X86_AVX2>();
+    break;
+  case X86_AVX:
+  case X86_SSE42:
+  case X86_SSE41:
+    xInitInterpolationFilterX86<X86_SSE41>();
+    break;
+  default:
+    break;
+  }
+}
+
+Void TComTrQuant::xInitTrQuantX86()
+{
+  switch( getX86Extension() )
+  {
+  case X86_AVX512:
+    xInitTrQuantX86<X86_AVX512>();
+    break;
+  case X86_AVX2:
+    xInitTrQuantX86<X86_AVX2>();
+    break;
+  case X86_AVX:
+  case X86_SSE42:
+  case X86_SSE41:
+    xInitTrQuantX86<X86_SSE41>();
+    break;
+  default:
+    break;
+  }
+}
+
+Void TComPrediction::xInitPredictionX86()
+{
+  switch( getX86Extension() )
+  {
+  case X86_AVX512:
+    xInitPredictionX86<X86_AVX512>();
+    break;
+  case X86_AVX2:
+    xInitPredictionX86<X86_AVX2>();
+    break;
+  case X86_AVX:
+  case X86_SSE42:
+  case X86_SSE41:
+    xInitPredictionX86<X86_SSE41>();
+    break;
+  default:
+    break;
+  }
+}
+
+Void TComLoopFilter::xInitLoopFilterX86()
+{
+  switch( getX86Extension() )
+  {
+  case X86_AVX512:
+    xInitLoopFilterX86<X86_AVX512>();
+    break;
+  case X86_AVX2:
+    xInitLoopFilterX86<X86_AVX2>();
+    break;
+  case X86_AVX:
+  case X86_SSE42:
+  case X86_SSE41:
+    xInitLoopFilterX86<X86_SSE41>();
+    break;
+  default:
+    break;
+  }
+}
+
+Void TComTemporalFilterKernels::xInitTemporalFilterKernelsX86()
+{
+#if RExt__HIGH_BIT_DEPTH_SUPPORT==0
+  // there are only SSE4.1 kernels, which the wider extensions use as well
+  switch( getX86Extension() )
+  {
+  case X86_AVX512:
+  case X86_AVX2:
+  case X86_AVX:
+  case X86_SSE42:
+  case X86_SSE41:
+    xInitTemporalFilterKernelsX86<X86_SSE41>();
+    break;
+  default:
+    break;
+  }
+#endif
+}
+
+//! \}
+
+#endif // VECTOR_CODING__X86_DISPATCH
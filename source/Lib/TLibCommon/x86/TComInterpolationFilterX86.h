@@ -0,0 +1,556 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2022, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TComInterpolationFilterX86.h
+    \brief    SSE4.1, AVX2 and AVX-512 kernels of TComInterpolationFilter
+    \details  Included by x86/<extension>/TComInterpolationFilter_<extension>.cpp, which are compiled with the matching target flags.
+              The kernels give exactly the same samples as the scalar functions, for 16-bit and (high bit depth) 32-bit Pel.
+              Blocks are processed in columns as wide as a register, widest registers first. A last column narrower than
+              the smallest register is filtered again together with the samples to its left.
+*/
+
+#ifndef __TCOMINTERPOLATIONFILTERX86__
+#define __TCOMINTERPOLATIONFILTERX86__
+
+#include "TComInterpolationFilter.h"
+
+#if VECTOR_CODING__X86_DISPATCH
+
+#include <immintrin.h>
+#include <cstring>
+
+//! \ingroup TLibCommon
+//! \{
+
+// ====================================================================================================================
+// Loads and stores of a row of samples
+// ====================================================================================================================
+
+#if !RExt__HIGH_BIT_DEPTH_SUPPORT
+/// 2 samples in the low 32 bits of a 128-bit register
+struct PelVec32
+{
+  typedef __m128i T;
+  static const Int PELS = Int( 4 / sizeof( Pel ) );
+  static inline T    load ( const Pel* p )  { Int v; memcpy( &v, p, sizeof( v ) ); return _mm_cvtsi32_si128( v ); }
+  static inline Void store( Pel* p, T v )   { const Int i = _mm_cvtsi128_si32( v ); memcpy( p, &i, sizeof( i ) ); }
+};
+#endif
+
+/// samples in the low 64 bits of a 128-bit register
+struct PelVec64
+{
+  typedef __m128i T;
+  static const Int PELS = Int( 8 / sizeof( Pel ) );
+  static inline T    load ( const Pel* p )  { return _mm_loadl_epi64( ( const __m128i* )p ); }
+  static inline Void store( Pel* p, T v )   { _mm_storel_epi64( ( __m128i* )p, v ); }
+};
+
+struct PelVec128
+{
+  typedef __m128i T;
+  static const Int PELS = Int( 16 / sizeof( Pel ) );
+  static inline T    load ( const Pel* p )  { return _mm_loadu_si128( ( const __m128i* )p ); }
+  static inline Void store( Pel* p, T v )   { _mm_storeu_si128( ( __m128i* )p, v ); }
+};
+
+#if X86_KERNELS_AVX2
+struct PelVec256
+{
+  typedef __m256i T;
+  static const Int PELS = Int( 32 / sizeof( Pel ) );
+  static inline T    load ( const Pel* p )  { return _mm256_loadu_si256( ( const __m256i* )p ); }
+  static inline Void store( Pel* p, T v )   { _mm256_storeu_si256( ( __m256i* )p, v ); }
+};
+#endif
+
+#if X86_KERNELS_AVX512
+struct PelVec512
+{
+  typedef __m512i T;
+  static const Int PELS = Int( 64 / sizeof( Pel ) );
+  static inline T    load ( const Pel* p )  { return _mm512_loadu_si512( ( const void* )p ); }
+  static inline Void store( Pel* p, T v )   { _mm512_storeu_si512( ( void* )p, v ); }
+};
+#endif
+
+#if RExt__HIGH_BIT_DEPTH_SUPPORT
+typedef PelVec64 PelVecMin;   ///< narrowest column: 2 samples
+#else
+typedef PelVec32 PelVecMin;
+#endif
+
+// ====================================================================================================================
+// Vector helpers. xAdd, xSra and the filter arithmetic work on 32-bit lanes; the clipping and the unit filter work on
+// lanes of the size of Pel.
+// ====================================================================================================================
+
+static inline __m128i xSet1  ( Int v, __m128i )              { return _mm_set1_epi32( v ); }
+static inline __m128i xAdd   ( __m128i a, __m128i b )        { return _mm_add_epi32( a, b ); }
+static inline __m128i xSra   ( __m128i a, __m128i cnt )      { return _mm_sra_epi32( a, cnt ); }
+#if RExt__HIGH_BIT_DEPTH_SUPPORT
+static inline __m128i xMul   ( __m128i a, __m128i b )        { return _mm_mullo_epi32( a, b ); }
+static inline __m128i xSet1Pel( Int v, __m128i )             { return _mm_set1_epi32( v ); }
+static inline __m128i xSllPel( __m128i a, __m128i cnt )      { return _mm_sll_epi32( a, cnt ); }
+static inline __m128i xSubPel( __m128i a, __m128i b )        { return _mm_sub_epi32( a, b ); }
+static inline __m128i xClipPel( __m128i a, __m128i lo, __m128i hi ) { return _mm_min_epi32( _mm_max_epi32( a, lo ), hi ); }
+#else
+static inline __m128i xMAdd  ( __m128i a, __m128i b )        { return _mm_madd_epi16( a, b ); }
+static inline __m128i xUnpackLo( __m128i a, __m128i b )      { return _mm_unpacklo_epi16( a, b ); }
+static inline __m128i xUnpackHi( __m128i a, __m128i b )      { return _mm_unpackhi_epi16( a, b ); }
+static inline __m128i xPack  ( __m128i lo, __m128i hi )      { return _mm_packs_epi32( lo, hi ); }
+static inline __m128i xSet1Pel( Int v, __m128i )             { return _mm_set1_epi16( Short( v ) ); }
+static inline __m128i xSllPel( __m128i a, __m128i cnt )      { return _mm_sll_epi16( a, cnt ); }
+static inline __m128i xSubPel( __m128i a, __m128i b )        { return _mm_sub_epi16( a, b ); }
+static inline __m128i xClipPel( __m128i a, __m128i lo, __m128i hi ) { return _mm_min_epi16( _mm_max_epi16( a, lo ), hi ); }
+#endif
+
+#if X86_KERNELS_AVX2
+static inline __m256i xSet1  ( Int v, __m256i )              { return _mm256_set1_epi32( v ); }
+static inline __m256i xAdd   ( __m256i a, __m256i b )        { return _mm256_add_epi32( a, b ); }
+static inline __m256i xSra   ( __m256i a, __m128i cnt )      { return _mm256_sra_epi32( a, cnt ); }
+#if RExt__HIGH_BIT_DEPTH_SUPPORT
+static inline __m256i xMul   ( __m256i a, __m256i b )        { return _mm256_mullo_epi32( a, b ); }
+static inline __m256i xSet1Pel( Int v, __m256i )             { return _mm256_set1_epi32( v ); }
+static inline __m256i xSllPel( __m256i a, __m128i cnt )      { return _mm256_sll_epi32( a, cnt ); }
+static inline __m256i xSubPel( __m256i a, __m256i b )        { return _mm256_sub_epi32( a, b ); }
+static inline __m256i xClipPel( __m256i a, __m256i lo, __m256i hi ) { return _mm256_min_epi32( _mm256_max_epi32( a, lo ), hi ); }
+#else
+static inline __m256i xMAdd  ( __m256i a, __m256i b )        { return _mm256_madd_epi16( a, b ); }
+static inline __m256i xUnpackLo( __m256i a, __m256i b )      { return _mm256_unpacklo_epi16( a, b ); }
+static inline __m256i xUnpackHi( __m256i a, __m256i b )      { return _mm256_unpackhi_epi16( a, b ); }
+static inline __m256i xPack  ( __m256i lo, __m256i hi )      { return _mm256_packs_epi32( lo, hi ); }
+static inline __m256i xSet1Pel( Int v, __m256i )             { return _mm256_set1_epi16( Short( v ) ); }
+static inline __m256i xSllPel( __m256i a, __m128i cnt )      { return _mm256_sll_epi16( a, cnt ); }
+static inline __m256i xSubPel( __m256i a, __m256i b )        { return _mm256_sub_epi16( a, b ); }
+static inline __m256i xClipPel( __m256i a, __m256i lo, __m256i hi ) { return _mm256_min_epi16( _mm256_max_epi16( a, lo ), hi ); }
+#endif
+#endif // X86_KERNELS_AVX2
+
+#if X86_KERNELS_AVX512
+static inline __m512i xSet1  ( Int v, __m512i )              { return _mm512_set1_epi32( v ); }
+static inline __m512i xAdd   ( __m512i a, __m512i b )        { return _mm512_add_epi32( a, b ); }
+static inline __m512i xSra   ( __m512i a, __m128i cnt )      { return _mm512_sra_epi32( a, cnt ); }
+#if RExt__HIGH_BIT_DEPTH_SUPPORT
+static inline __m512i xMul   ( __m512i a, __m512i b )        { return _mm512_mullo_epi32( a, b ); }
+static inline __m512i xSet1Pel( Int v, __m512i )             { return _mm512_set1_epi32( v ); }
+static inline __m512i xSllPel( __m512i a, __m128i cnt )      { return _mm512_sll_epi32( a, cnt ); }
+static inline __m512i xSubPel( __m512i a, __m512i b )        { return _mm512_sub_epi32( a, b ); }
+static inline __m512i xClipPel( __m512i a, __m512i lo, __m512i hi ) { return _mm512_min_epi32( _mm512_max_epi32( a, lo ), hi ); }
+#else
+static inline __m512i xMAdd  ( __m512i a, __m512i b )        { return _mm512_madd_epi16( a, b ); }
+static inline __m512i xUnpackLo( __m512i a, __m512i b )      { return _mm512_unpacklo_epi16( a, b ); }
+static inline __m512i xUnpackHi( __m512i a, __m512i b )      { return _mm512_unpackhi_epi16( a, b ); }
+static inline __m512i xPack  ( __m512i lo, __m512i hi )      { return _mm512_packs_epi32( lo, hi ); }
+static inline __m512i xSet1Pel( Int v, __m512i )             { return _mm512_set1_epi16( Short( v ) ); }
+static inline __m512i xSllPel( __m512i a, __m128i cnt )      { return _mm512_sll_epi16( a, cnt ); }
+static inline __m512i xSubPel( __m512i a, __m512i b )        { return _mm512_sub_epi16( a, b ); }
+static inline __m512i xClipPel( __m512i a, __m512i lo, __m512i hi ) { return _mm512_min_epi16( _mm512_max_epi16( a, lo ), hi ); }
+#endif
+#endif // X86_KERNELS_AVX512
+
+// ====================================================================================================================
+// FIR filter arithmetic
+// ====================================================================================================================
+
+/** Rounding of a filter operation, as in TComInterpolationFilter::filter.
+ */
+static inline Void xFilterRounding( Int bitDepth, Bool isFirst, Bool isLast, Int& offset, Int& shift, Int& maxVal )
+{
+  const Int headRoom = std::max<Int>( 2, ( IF_INTERNAL_PREC - bitDepth ) );
+  shift = IF_FILTER_PREC;
+
+  if( isLast )
+  {
+    shift  += isFirst ? 0 : headRoom;
+    offset  = 1 << ( shift - 1 );
+    offset += isFirst ? 0 : IF_INTERNAL_OFFS << IF_FILTER_PREC;
+    maxVal  = ( 1 << bitDepth ) - 1;
+  }
+  else
+  {
+    shift  -= isFirst ? headRoom : 0;
+    offset  = isFirst ? -IF_INTERNAL_OFFS << shift : 0;
+    maxVal  = 0;
+  }
+}
+
+/** Broadcast the filter taps. With 16-bit samples, each 32-bit lane holds a pair of taps for _mm_madd_epi16.
+ */
+template<Int N, typename T>
+static inline Void xSetTaps( const TFilterCoeff* coeff, T* taps )
+{
+#if RExt__HIGH_BIT_DEPTH_SUPPORT
+  for( Int k = 0; k < N; k++ )
+  {
+    taps[k] = xSet1( coeff[k], T() );
+  }
+#else
+  for( Int k = 0; k < N; k += 2 )
+  {
+    taps[k >> 1] = xSet1( Int( UInt( UShort( coeff[k] ) ) | ( UInt( UShort( coeff[k + 1] ) ) << 16 ) ), T() );
+  }
+#endif
+}
+
+/** Filter N registers of samples, tap k being applied to r[k]; the sums are rounded and, for 16-bit samples, packed
+    with signed saturation.
+ */
+template<Int N, typename T>
+static inline T xFilterRegs( const T* r, const T* taps, const T& offset, const __m128i& shift )
+{
+#if RExt__HIGH_BIT_DEPTH_SUPPORT
+  T sum = xMul( r[0], taps[0] );
+  for( Int k = 1; k < N; k++ )
+  {
+    sum = xAdd( sum, xMul( r[k], taps[k] ) );
+  }
+  return xSra( xAdd( sum, offset ), shift );
+#else
+  T lo = xMAdd( xUnpackLo( r[0], r[1] ), taps[0] );
+  T hi = xMAdd( xUnpackHi( r[0], r[1] ), taps[0] );
+  for( Int k = 2; k < N; k += 2 )
+  {
+    lo = xAdd( lo, xMAdd( xUnpackLo( r[k], r[k + 1] ), taps[k >> 1] ) );
+    hi = xAdd( hi, xMAdd( xUnpackHi( r[k], r[k + 1] ), taps[k >> 1] ) );
+  }
+  return xPack( xSra( xAdd( lo, offset ), shift ), xSra( xAdd( hi, offset ), shift ) );
+#endif
+}
+
+/** Filter the N samples to the right of each sample of a register.
+ */
+template<typename V, Int N>
+static inline typename V::T xFilterHorRegs( const Pel* src, const typename V::T* taps, const typename V::T& offset, const __m128i& shift )
+{
+  typename V::T r[N];
+  for( Int k = 0; k < N; k++ )
+  {
+    r[k] = V::load( src + k );
+  }
+  return xFilterRegs<N>( r, taps, offset, shift );
+}
+
+// ====================================================================================================================
+// Columns of a block
+// ====================================================================================================================
+
+/** Visit the columns of a block, op.template column<V>( x ) filtering the V::PELS columns from x on.
+ */
+template<typename Op>
+static inline Void xForEachColumn( Int width, const Op& op )
+{
+  assert( width >= PelVecMin::PELS );
+
+  Int x = 0;
+#if X86_KERNELS_AVX512
+  for( ; x + PelVec512::PELS <= width; x += PelVec512::PELS )
+  {
+    op.template column<PelVec512>( x );
+  }
+#endif
+#if X86_KERNELS_AVX2
+  for( ; x + PelVec256::PELS <= width; x += PelVec256::PELS )
+  {
+    op.template column<PelVec256>( x );
+  }
+#endif
+  for( ; x + PelVec128::PELS <= width; x += PelVec128::PELS )
+  {
+    op.template column<PelVec128>( x );
+  }
+  for( ; x + PelVec64::PELS <= width; x += PelVec64::PELS )
+  {
+    op.template column<PelVec64>( x );
+  }
+#if !RExt__HIGH_BIT_DEPTH_SUPPORT
+  for( ; x + PelVec32::PELS <= width; x += PelVec32::PELS )
+  {
+    op.template column<PelVec32>( x );
+  }
+#endif
+  if( x < width )
+  {
+    op.template column<PelVecMin>( width - PelVecMin::PELS );
+  }
+}
+
+/// unit filter of TComInterpolationFilter::filterCopy
+struct FilterCopyColumn
+{
+  const Pel* src;
+  Int        srcStride;
+  Pel*       dst;
+  Int        dstStride;
+  Int        height;
+  Int        bitDepth;
+  Bool       isFirst;
+  Bool       isLast;
+
+  template<typename V>
+  Void column( Int x ) const
+  {
+    typedef typename V::T T;
+    const Pel* s = src + x;
+    Pel*       d = dst + x;
+
+    if( isFirst == isLast )
+    {
+      for( Int y = 0; y < height; y++, s += srcStride, d += dstStride )
+      {
+        V::store( d, V::load( s ) );
+      }
+      return;
+    }
+
+    const Int shift = std::max<Int>( 2, ( IF_INTERNAL_PREC - bitDepth ) );
+
+    if( isFirst )
+    {
+      const __m128i cnt  = _mm_cvtsi32_si128( shift );
+      const T       offs = xSet1Pel( IF_INTERNAL_OFFS, T() );
+      for( Int y = 0; y < height; y++, s += srcStride, d += dstStride )
+      {
+        V::store( d, xSubPel( xSllPel( V::load( s ), cnt ), offs ) );
+      }
+    }
+    else
+    {
+      const __m128i cnt    = _mm_cvtsi32_si128( shift );
+      const T       offset = xSet1( IF_INTERNAL_OFFS + ( 1 << ( shift - 1 ) ), T() );
+      const T       minVal = xSet1Pel( 0, T() );
+      const T       maxVal = xSet1Pel( ( 1 << bitDepth ) - 1, T() );
+      for( Int y = 0; y < height; y++, s += srcStride, d += dstStride )
+      {
+        const T v = V::load( s );
+#if RExt__HIGH_BIT_DEPTH_SUPPORT
+        const T r = xSra( xAdd( v, offset ), cnt );
+#else
+        // sign-extended to 32 bits: the pairs of equal samples shifted right
+        const __m128i cnt16 = _mm_cvtsi32_si128( 16 );
+        const T r = xPack( xSra( xAdd( xSra( xUnpackLo( v, v ), cnt16 ), offset ), cnt ), xSra( xAdd( xSra( xUnpackHi( v, v ), cnt16 ), offset ), cnt ) );
+#endif
+        V::store( d, xClipPel( r, minVal, maxVal ) );
+      }
+    }
+  }
+};
+
+/// FIR filter of TComInterpolationFilter::filter, src pointing at the first tap
+template<Int N, Bool isVertical, Bool isLast>
+struct FilterColumn
+{
+  const Pel*          src;
+  Int                 srcStride;
+  Pel*                dst;
+  Int                 dstStride;
+  Int                 height;
+  const TFilterCoeff* coeff;
+  Int                 offset;
+  Int                 shift;
+  Int                 maxVal;
+
+  template<typename V>
+  Void column( Int x ) const
+  {
+    typedef typename V::T T;
+    const Pel* s = src + x;
+    Pel*       d = dst + x;
+
+    T taps[N];
+    xSetTaps<N>( coeff, taps );
+    const T       vOffset = xSet1( offset, T() );
+    const __m128i vShift  = _mm_cvtsi32_si128( shift );
+    const T       vMin    = xSet1Pel( 0, T() );
+    const T       vMax    = xSet1Pel( maxVal, T() );
+
+    if( isVertical )
+    {
+      // window of the rows under the taps
+      T r[N];
+      for( Int k = 0; k < N - 1; k++, s += srcStride )
+      {
+        r[k] = V::load( s );
+      }
+      for( Int y = 0; y < height; y++, s += srcStride, d += dstStride )
+      {
+        r[N - 1] = V::load( s );
+        T v = xFilterRegs<N>( r, taps, vOffset, vShift );
+        if( isLast )
+        {
+          v = xClipPel( v, vMin, vMax );
+        }
+        V::store( d, v );
+        for( Int k = 0; k < N - 1; k++ )
+        {
+          r[k] = r[k + 1];
+        }
+      }
+    }
+    else
+    {
+      for( Int y = 0; y < height; y++, s += srcStride, d += dstStride )
+      {
+        T v = xFilterHorRegs<V, N>( s, taps, vOffset, vShift );
+        if( isLast )
+        {
+          v = xClipPel( v, vMin, vMax );
+        }
+        V::store( d, v );
+      }
+    }
+  }
+};
+
+/// horizontal then vertical FIR filter: the horizontally filtered rows under the vertical taps stay in registers
+template<Int N, Bool isLast>
+struct Filter2DColumn
+{
+  const Pel*          src;
+  Int                 srcStride;
+  Pel*                dst;
+  Int                 dstStride;
+  Int                 height;
+  const TFilterCoeff* coeffHor;
+  const TFilterCoeff* coeffVer;
+  Int                 bitDepth;
+
+  template<typename V>
+  Void column( Int x ) const
+  {
+    typedef typename V::T T;
+    const Pel* s = src + x - ( N/2 - 1 ) * srcStride - ( N/2 - 1 );
+    Pel*       d = dst + x;
+
+    Int offset, shift, maxVal;
+    T tapsHor[N], tapsVer[N];
+    xSetTaps<N>( coeffHor, tapsHor );
+    xSetTaps<N>( coeffVer, tapsVer );
+
+    xFilterRounding( bitDepth, true, false, offset, shift, maxVal );
+    const T       offsetHor = xSet1( offset, T() );
+    const __m128i shiftHor  = _mm_cvtsi32_si128( shift );
+
+    xFilterRounding( bitDepth, false, isLast, offset, shift, maxVal );
+    const T       offsetVer = xSet1( offset, T() );
+    const __m128i shiftVer  = _mm_cvtsi32_si128( shift );
+    const T       vMin      = xSet1Pel( 0, T() );
+    const T       vMax      = xSet1Pel( maxVal, T() );
+
+    T h[N];
+    for( Int k = 0; k < N - 1; k++, s += srcStride )
+    {
+      h[k] = xFilterHorRegs<V, N>( s, tapsHor, offsetHor, shiftHor );
+    }
+    for( Int y = 0; y < height; y++, s += srcStride, d += dstStride )
+    {
+      h[N - 1] = xFilterHorRegs<V, N>( s, tapsHor, offsetHor, shiftHor );
+      T v = xFilterRegs<N>( h, tapsVer, offsetVer, shiftVer );
+      if( isLast )
+      {
+        v = xClipPel( v, vMin, vMax );
+      }
+      V::store( d, v );
+      for( Int k = 0; k < N - 1; k++ )
+      {
+        h[k] = h[k + 1];
+      }
+    }
+  }
+};
+
+// ====================================================================================================================
+// Kernels
+// ====================================================================================================================
+
+template<X86_VEXT vext>
+Void TComInterpolationFilter::xFilterCopyX86( Int bitDepth, const Pel *src, Int srcStride, Pel *dst, Int dstStride, Int width, Int height, Bool isFirst, Bool isLast )
+{
+  const FilterCopyColumn op = { src, srcStride, dst, dstStride, height, bitDepth, isFirst, isLast };
+  xForEachColumn( width, op );
+}
+
+template<X86_VEXT vext, Int N, Bool isVertical, Bool isFirst, Bool isLast>
+Void TComInterpolationFilter::xFilterX86( Int bitDepth, Pel const *src, Int srcStride, Pel *dst, Int dstStride, Int width, Int height, TFilterCoeff const *coeff )
+{
+  Int offset, shift, maxVal;
+  xFilterRounding( bitDepth, isFirst, isLast, offset, shift, maxVal );
+
+  const FilterColumn<N, isVertical, isLast> op = { src - ( N/2 - 1 ) * ( isVertical ? srcStride : 1 ), srcStride, dst, dstStride, height, coeff, offset, shift, maxVal };
+  xForEachColumn( width, op );
+}
+
+template<X86_VEXT vext, Int N, Bool isLast>
+Void TComInterpolationFilter::xFilter2DX86( Int bitDepth, Pel const *src, Int srcStride, Pel *dst, Int dstStride, Int width, Int height, TFilterCoeff const *coeffHor, TFilterCoeff const *coeffVer )
+{
+  const Filter2DColumn<N, isLast> op = { src, srcStride, dst, dstStride, height, coeffHor, coeffVer, bitDepth };
+  xForEachColumn( width, op );
+}
+
+// ====================================================================================================================
+// Initialisation
+// ====================================================================================================================
+
+template<X86_VEXT vext>
+Void TComInterpolationFilter::xInitInterpolationFilterX86()
+{
+  m_fpFilterCopy = xFilterCopyX86<vext>;
+
+  m_afpFilter[CHANNEL_TYPE_LUMA  ][0][0][0] = xFilterX86<vext, NTAPS_LUMA,   false, false, false>;
+  m_afpFilter[CHANNEL_TYPE_LUMA  ][0][0][1] = xFilterX86<vext, NTAPS_LUMA,   false, false, true >;
+  m_afpFilter[CHANNEL_TYPE_LUMA  ][0][1][0] = xFilterX86<vext, NTAPS_LUMA,   false, true,  false>;
+  m_afpFilter[CHANNEL_TYPE_LUMA  ][0][1][1] = xFilterX86<vext, NTAPS_LUMA,   false, true,  true >;
+  m_afpFilter[CHANNEL_TYPE_LUMA  ][1][0][0] = xFilterX86<vext, NTAPS_LUMA,   true,  false, false>;
+  m_afpFilter[CHANNEL_TYPE_LUMA  ][1][0][1] = xFilterX86<vext, NTAPS_LUMA,   true,  false, true >;
+  m_afpFilter[CHANNEL_TYPE_LUMA  ][1][1][0] = xFilterX86<vext, NTAPS_LUMA,   true,  true,  false>;
+  m_afpFilter[CHANNEL_TYPE_LUMA  ][1][1][1] = xFilterX86<vext, NTAPS_LUMA,   true,  true,  true >;
+  m_afpFilter[CHANNEL_TYPE_CHROMA][0][0][0] = xFilterX86<vext, NTAPS_CHROMA, false, false, false>;
+  m_afpFilter[CHANNEL_TYPE_CHROMA][0][0][1] = xFilterX86<vext, NTAPS_CHROMA, false, false, true >;
+  m_afpFilter[CHANNEL_TYPE_CHROMA][0][1][0] = xFilterX86<vext, NTAPS_CHROMA, false, true,  false>;
+  m_afpFilter[CHANNEL_TYPE_CHROMA][0][1][1] = xFilterX86<vext, NTAPS_CHROMA, false, true,  true >;
+  m_afpFilter[CHANNEL_TYPE_CHROMA][1][0][0] = xFilterX86<vext, NTAPS_CHROMA, true,  false, false>;
+  m_afpFilter[CHANNEL_TYPE_CHROMA][1][0][1] = xFilterX86<vext, NTAPS_CHROMA, true,  false, true >;
+  m_afpFilter[CHANNEL_TYPE_CHROMA][1][1][0] = xFilterX86<vext, NTAPS_CHROMA, true,  true,  false>;
+  m_afpFilter[CHANNEL_TYPE_CHROMA][1][1][1] = xFilterX86<vext, NTAPS_CHROMA, true,  true,  true >;
+
+  m_afpFilter2D[CHANNEL_TYPE_LUMA  ][0] = xFilter2DX86<vext, NTAPS_LUMA,   false>;
+  m_afpFilter2D[CHANNEL_TYPE_LUMA  ][1] = xFilter2DX86<vext, NTAPS_LUMA,   true >;
+  m_afpFilter2D[CHANNEL_TYPE_CHROMA][0] = xFilter2DX86<vext, NTAPS_CHROMA, false>;
+  m_afpFilter2D[CHANNEL_TYPE_CHROMA][1] = xFilter2DX86<vext, NTAPS_CHROMA, true >;
+}
+
+//! \}
+
+#endif // VECTOR_CODING__X86_DISPATCH
+
+#endif // __TCOMINTERPOLATIONFILTERX86__
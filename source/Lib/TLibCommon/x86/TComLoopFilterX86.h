@@ -0,0 +1,752 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2022, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TComLoopFilterX86.h
+    \brief    SSE4.1, AVX2 and AVX-512 deblocking kernels of TComLoopFilter
+    \details  Included by x86/<extension>/TComLoopFilter_<extension>.cpp, which are compiled with the matching target flags.
+              The kernels give exactly the same samples as the scalar functions, for 16-bit and (high bit depth) 32-bit Pel.
+              Each lane holds one line across the edge: 16-bit lanes, up to 11-bit samples, filter 8, 16 or 32 lines per
+              register and 32-bit lanes 4, 8 or 16 lines, that is several segments of 4 lines. The decisions of a segment
+              are taken from its lanes 0 and 3 and both the strong and the weak filter are computed and selected with masks.
+              The lines across a vertical edge are rows of the picture, which are transposed in groups of 8 or 4.
+*/
+
+#ifndef __TCOMLOOPFILTERX86__
+#define __TCOMLOOPFILTERX86__
+
+#include "TComLoopFilter.h"
+
+#if VECTOR_CODING__X86_DISPATCH
+
+#include <immintrin.h>
+
+//! \ingroup TLibCommon
+//! \{
+
+// ====================================================================================================================
+// Lines across an edge, one line per lane. The lanes are 32 bit, or 16 bit for 16-bit samples of at most
+// LF_MAX_BIT_DEPTH_16 bits, for which none of the intermediate values of the filters exceeds 16 bits.
+// A mask has all the bits of a lane set or cleared.
+// ====================================================================================================================
+
+static const Int LF_MAX_BIT_DEPTH_16 = 11;   ///< largest bit depth filtered on 16-bit lanes: 9*(q0-p0) - 3*(q1-p1) fits in 16 bits
+
+static inline __m128i xAnd    ( __m128i a, __m128i b )            { return _mm_and_si128( a, b ); }
+static inline __m128i xAndNot ( __m128i a, __m128i b )            { return _mm_andnot_si128( a, b ); }   ///< ~a & b
+static inline __m128i xSelect ( __m128i a, __m128i b, __m128i m ) { return _mm_blendv_epi8( a, b, m ); } ///< m ? b : a
+static inline Bool    xAny    ( __m128i a )                       { return !_mm_testz_si128( a, a ); }
+#if X86_KERNELS_AVX2
+static inline __m256i xAnd    ( __m256i a, __m256i b )            { return _mm256_and_si256( a, b ); }
+static inline __m256i xAndNot ( __m256i a, __m256i b )            { return _mm256_andnot_si256( a, b ); }
+static inline __m256i xSelect ( __m256i a, __m256i b, __m256i m ) { return _mm256_blendv_epi8( a, b, m ); }
+static inline Bool    xAny    ( __m256i a )                       { return !_mm256_testz_si256( a, a ); }
+#endif
+#if X86_KERNELS_AVX512
+static inline __m512i xAnd    ( __m512i a, __m512i b )            { return _mm512_and_si512( a, b ); }
+static inline __m512i xAndNot ( __m512i a, __m512i b )            { return _mm512_andnot_si512( a, b ); }
+static inline __m512i xSelect ( __m512i a, __m512i b, __m512i m ) { return _mm512_ternarylogic_epi32( m, b, a, 0xca ); }
+static inline Bool    xAny    ( __m512i a )                       { return _mm512_test_epi32_mask( a, a ) != 0; }
+#endif
+
+/** Register of lines: besides the arithmetic of its lanes, loadParam loads the parameters of the lines, loadPels and
+ *  storePels the samples of the lines at one distance from a horizontal edge, and fromBlocks and toBlocks gather and
+ *  split the 128-bit blocks of BLOCK_LINES lines that the rows across a vertical edge are transposed into.
+ *  line0 and line3 broadcast lane 0 and lane 3 of each segment of 4 lines.
+ */
+struct LFVec128
+{
+  typedef __m128i T;
+  static const Int LINES       = 4;
+  static const Int BLOCK_LINES = 4;
+  static inline T    set1 ( Int v )                { return _mm_set1_epi32( v ); }
+  static inline T    add  ( T a, T b )             { return _mm_add_epi32( a, b ); }
+  static inline T    sub  ( T a, T b )             { return _mm_sub_epi32( a, b ); }
+  static inline T    abs  ( T a )                  { return _mm_abs_epi32( a ); }
+  static inline T    slli ( T a, Int n )           { return _mm_slli_epi32( a, n ); }
+  static inline T    srai ( T a, Int n )           { return _mm_srai_epi32( a, n ); }
+  static inline T    clip ( T a, T lo, T hi )      { return _mm_min_epi32( _mm_max_epi32( a, lo ), hi ); }
+  static inline T    less ( T a, T b )             { return _mm_cmplt_epi32( a, b ); }
+  static inline T    line0( T a )                  { return _mm_shuffle_epi32( a, 0x00 ); }
+  static inline T    line3( T a )                  { return _mm_shuffle_epi32( a, 0xff ); }
+  static inline T    loadParam( const Int* p )     { return _mm_loadu_si128( ( const __m128i* )p ); }
+#if RExt__HIGH_BIT_DEPTH_SUPPORT
+  static inline T    loadPels ( const Pel* p )     { return _mm_loadu_si128( ( const __m128i* )p ); }
+  static inline Void storePels( Pel* p, T v )      { _mm_storeu_si128( ( __m128i* )p, v ); }
+#else
+  static inline T    loadPels ( const Pel* p )     { return _mm_cvtepi16_epi32( _mm_loadl_epi64( ( const __m128i* )p ) ); }
+  static inline Void storePels( Pel* p, T v )      { _mm_storel_epi64( ( __m128i* )p, _mm_packs_epi32( v, v ) ); }
+#endif
+  static inline T    fromBlocks( const __m128i* b ) { return b[0]; }
+  static inline Void toBlocks  ( T v, __m128i* b )  { b[0] = v; }
+};
+
+#if X86_KERNELS_AVX2
+struct LFVec256
+{
+  typedef __m256i T;
+  static const Int LINES       = 8;
+  static const Int BLOCK_LINES = 4;
+  static inline T    set1 ( Int v )                { return _mm256_set1_epi32( v ); }
+  static inline T    add  ( T a, T b )             { return _mm256_add_epi32( a, b ); }
+  static inline T    sub  ( T a, T b )             { return _mm256_sub_epi32( a, b ); }
+  static inline T    abs  ( T a )                  { return _mm256_abs_epi32( a ); }
+  static inline T    slli ( T a, Int n )           { return _mm256_slli_epi32( a, n ); }
+  static inline T    srai ( T a, Int n )           { return _mm256_srai_epi32( a, n ); }
+  static inline T    clip ( T a, T lo, T hi )      { return _mm256_min_epi32( _mm256_max_epi32( a, lo ), hi ); }
+  static inline T    less ( T a, T b )             { return _mm256_cmpgt_epi32( b, a ); }
+  static inline T    line0( T a )                  { return _mm256_shuffle_epi32( a, 0x00 ); }
+  static inline T    line3( T a )                  { return _mm256_shuffle_epi32( a, 0xff ); }
+  static inline T    loadParam( const Int* p )     { return _mm256_loadu_si256( ( const __m256i* )p ); }
+#if RExt__HIGH_BIT_DEPTH_SUPPORT
+  static inline T    loadPels ( const Pel* p )     { return _mm256_loadu_si256( ( const __m256i* )p ); }
+  static inline Void storePels( Pel* p, T v )      { _mm256_storeu_si256( ( __m256i* )p, v ); }
+#else
+  static inline T    loadPels ( const Pel* p )     { return _mm256_cvtepi16_epi32( _mm_loadu_si128( ( const __m128i* )p ) ); }
+  static inline Void storePels( Pel* p, T v )      { _mm_storeu_si128( ( __m128i* )p, _mm_packs_epi32( _mm256_castsi256_si128( v ), _mm256_extracti128_si256( v, 1 ) ) ); }
+#endif
+  static inline T    fromBlocks( const __m128i* b ) { return _mm256_inserti128_si256( _mm256_castsi128_si256( b[0] ), b[1], 1 ); }
+  static inline Void toBlocks  ( T v, __m128i* b )  { b[0] = _mm256_castsi256_si128( v ); b[1] = _mm256_extracti128_si256( v, 1 ); }
+};
+#endif
+
+#if X86_KERNELS_AVX512
+static inline __m512i xFromBlocks512( const __m128i* b )
+{
+  __m512i v = _mm512_castsi128_si512( b[0] );
+  v = _mm512_inserti32x4( v, b[1], 1 );
+  v = _mm512_inserti32x4( v, b[2], 2 );
+  return _mm512_inserti32x4( v, b[3], 3 );
+}
+
+static inline Void xToBlocks512( __m512i v, __m128i* b )
+{
+  b[0] = _mm512_castsi512_si128( v );
+  b[1] = _mm512_extracti32x4_epi32( v, 1 );
+  b[2] = _mm512_extracti32x4_epi32( v, 2 );
+  b[3] = _mm512_extracti32x4_epi32( v, 3 );
+}
+
+struct LFVec512
+{
+  typedef __m512i T;
+  static const Int LINES       = 16;
+  static const Int BLOCK_LINES = 4;
+  static inline T    set1 ( Int v )                { return _mm512_set1_epi32( v ); }
+  static inline T    add  ( T a, T b )             { return _mm512_add_epi32( a, b ); }
+  static inline T    sub  ( T a, T b )             { return _mm512_sub_epi32( a, b ); }
+  static inline T    abs  ( T a )                  { return _mm512_abs_epi32( a ); }
+  static inline T    slli ( T a, Int n )           { return _mm512_slli_epi32( a, n ); }
+  static inline T    srai ( T a, Int n )           { return _mm512_srai_epi32( a, n ); }
+  static inline T    clip ( T a, T lo, T hi )      { return _mm512_min_epi32( _mm512_max_epi32( a, lo ), hi ); }
+  static inline T    less ( T a, T b )             { return _mm512_maskz_set1_epi32( _mm512_cmplt_epi32_mask( a, b ), -1 ); }
+  static inline T    line0( T a )                  { return _mm512_shuffle_epi32( a, _MM_PERM_AAAA ); }
+  static inline T    line3( T a )                  { return _mm512_shuffle_epi32( a, _MM_PERM_DDDD ); }
+  static inline T    loadParam( const Int* p )     { return _mm512_loadu_si512( ( const void* )p ); }
+#if RExt__HIGH_BIT_DEPTH_SUPPORT
+  static inline T    loadPels ( const Pel* p )     { return _mm512_loadu_si512( ( const void* )p ); }
+  static inline Void storePels( Pel* p, T v )      { _mm512_storeu_si512( ( void* )p, v ); }
+#else
+  static inline T    loadPels ( const Pel* p )     { return _mm512_cvtepi16_epi32( _mm256_loadu_si256( ( const __m256i* )p ) ); }
+  static inline Void storePels( Pel* p, T v )      { _mm256_storeu_si256( ( __m256i* )p, _mm512_cvtepi32_epi16( v ) ); }
+#endif
+  static inline T    fromBlocks( const __m128i* b ) { return xFromBlocks512( b ); }
+  static inline Void toBlocks  ( T v, __m128i* b )  { xToBlocks512( v, b ); }
+};
+#endif
+
+#if !RExt__HIGH_BIT_DEPTH_SUPPORT
+/// 8 lines on 16-bit lanes
+struct LFVec128x16
+{
+  typedef __m128i T;
+  static const Int LINES       = 8;
+  static const Int BLOCK_LINES = 8;
+  static inline T    set1 ( Int v )                { return _mm_set1_epi16( Short( v ) ); }
+  static inline T    add  ( T a, T b )             { return _mm_add_epi16( a, b ); }
+  static inline T    sub  ( T a, T b )             { return _mm_sub_epi16( a, b ); }
+  static inline T    abs  ( T a )                  { return _mm_abs_epi16( a ); }
+  static inline T    slli ( T a, Int n )           { return _mm_slli_epi16( a, n ); }
+  static inline T    srai ( T a, Int n )           { return _mm_srai_epi16( a, n ); }
+  static inline T    clip ( T a, T lo, T hi )      { return _mm_min_epi16( _mm_max_epi16( a, lo ), hi ); }
+  static inline T    less ( T a, T b )             { return _mm_cmplt_epi16( a, b ); }
+  static inline T    line0( T a )                  { return _mm_shufflehi_epi16( _mm_shufflelo_epi16( a, 0x00 ), 0x00 ); }
+  static inline T    line3( T a )                  { return _mm_shufflehi_epi16( _mm_shufflelo_epi16( a, 0xff ), 0xff ); }
+  static inline T    loadParam( const Int* p )     { return _mm_packs_epi32( _mm_loadu_si128( ( const __m128i* )p ), _mm_loadu_si128( ( const __m128i* )( p + 4 ) ) ); }
+  static inline T    loadPels ( const Pel* p )     { return _mm_loadu_si128( ( const __m128i* )p ); }
+  static inline Void storePels( Pel* p, T v )      { _mm_storeu_si128( ( __m128i* )p, v ); }
+  static inline T    fromBlocks( const __m128i* b ) { return b[0]; }
+  static inline Void toBlocks  ( T v, __m128i* b )  { b[0] = v; }
+};
+
+#if X86_KERNELS_AVX2
+/// 16 lines on 16-bit lanes
+struct LFVec256x16
+{
+  typedef __m256i T;
+  static const Int LINES       = 16;
+  static const Int BLOCK_LINES = 8;
+  static inline T    set1 ( Int v )                { return _mm256_set1_epi16( Short( v ) ); }
+  static inline T    add  ( T a, T b )             { return _mm256_add_epi16( a, b ); }
+  static inline T    sub  ( T a, T b )             { return _mm256_sub_epi16( a, b ); }
+  static inline T    abs  ( T a )                  { return _mm256_abs_epi16( a ); }
+  static inline T    slli ( T a, Int n )           { return _mm256_slli_epi16( a, n ); }
+  static inline T    srai ( T a, Int n )           { return _mm256_srai_epi16( a, n ); }
+  static inline T    clip ( T a, T lo, T hi )      { return _mm256_min_epi16( _mm256_max_epi16( a, lo ), hi ); }
+  static inline T    less ( T a, T b )             { return _mm256_cmpgt_epi16( b, a ); }
+  static inline T    line0( T a )                  { return _mm256_shufflehi_epi16( _mm256_shufflelo_epi16( a, 0x00 ), 0x00 ); }
+  static inline T    line3( T a )                  { return _mm256_shufflehi_epi16( _mm256_shufflelo_epi16( a, 0xff ), 0xff ); }
+  static inline T    loadParam( const Int* p )
+  {
+    return _mm256_permute4x64_epi64( _mm256_packs_epi32( _mm256_loadu_si256( ( const __m256i* )p ), _mm256_loadu_si256( ( const __m256i* )( p + 8 ) ) ), 0xd8 );
+  }
+  static inline T    loadPels ( const Pel* p )     { return _mm256_loadu_si256( ( const __m256i* )p ); }
+  static inline Void storePels( Pel* p, T v )      { _mm256_storeu_si256( ( __m256i* )p, v ); }
+  static inline T    fromBlocks( const __m128i* b ) { return _mm256_inserti128_si256( _mm256_castsi128_si256( b[0] ), b[1], 1 ); }
+  static inline Void toBlocks  ( T v, __m128i* b )  { b[0] = _mm256_castsi256_si128( v ); b[1] = _mm256_extracti128_si256( v, 1 ); }
+};
+#endif
+
+#if X86_KERNELS_AVX512
+/// 32 lines on 16-bit lanes
+struct LFVec512x16
+{
+  typedef __m512i T;
+  static const Int LINES       = 32;
+  static const Int BLOCK_LINES = 8;
+  static inline T    set1 ( Int v )                { return _mm512_set1_epi16( Short( v ) ); }
+  static inline T    add  ( T a, T b )             { return _mm512_add_epi16( a, b ); }
+  static inline T    sub  ( T a, T b )             { return _mm512_sub_epi16( a, b ); }
+  static inline T    abs  ( T a )                  { return _mm512_abs_epi16( a ); }
+  static inline T    slli ( T a, Int n )           { return _mm512_slli_epi16( a, n ); }
+  static inline T    srai ( T a, Int n )           { return _mm512_srai_epi16( a, n ); }
+  static inline T    clip ( T a, T lo, T hi )      { return _mm512_min_epi16( _mm512_max_epi16( a, lo ), hi ); }
+  static inline T    less ( T a, T b )             { return _mm512_movm_epi16( _mm512_cmplt_epi16_mask( a, b ) ); }
+  static inline T    line0( T a )                  { return _mm512_shufflehi_epi16( _mm512_shufflelo_epi16( a, 0x00 ), 0x00 ); }
+  static inline T    line3( T a )                  { return _mm512_shufflehi_epi16( _mm512_shufflelo_epi16( a, 0xff ), 0xff ); }
+  static inline T    loadParam( const Int* p )
+  {
+    return _mm512_inserti64x4( _mm512_castsi256_si512( _mm512_cvtepi32_epi16( _mm512_loadu_si512( ( const void* )p ) ) ),
+                               _mm512_cvtepi32_epi16( _mm512_loadu_si512( ( const void* )( p + 16 ) ) ), 1 );
+  }
+  static inline T    loadPels ( const Pel* p )     { return _mm512_loadu_si512( ( const void* )p ); }
+  static inline Void storePels( Pel* p, T v )      { _mm512_storeu_si512( ( void* )p, v ); }
+  static inline T    fromBlocks( const __m128i* b ) { return xFromBlocks512( b ); }
+  static inline Void toBlocks  ( T v, __m128i* b )  { xToBlocks512( v, b ); }
+};
+#endif
+#endif // !RExt__HIGH_BIT_DEPTH_SUPPORT
+
+// ====================================================================================================================
+// Transposition of the rows across a vertical edge, in groups of 4 rows to 32-bit lanes or 8 rows to 16-bit lanes
+// ====================================================================================================================
+
+#if RExt__HIGH_BIT_DEPTH_SUPPORT
+static inline Void xTranspose4x4( const __m128i* in, __m128i* out )
+{
+  const __m128i t0 = _mm_unpacklo_epi32( in[0], in[1] );
+  const __m128i t1 = _mm_unpacklo_epi32( in[2], in[3] );
+  const __m128i t2 = _mm_unpackhi_epi32( in[0], in[1] );
+  const __m128i t3 = _mm_unpackhi_epi32( in[2], in[3] );
+  out[0] = _mm_unpacklo_epi64( t0, t1 );
+  out[1] = _mm_unpackhi_epi64( t0, t1 );
+  out[2] = _mm_unpacklo_epi64( t2, t3 );
+  out[3] = _mm_unpackhi_epi64( t2, t3 );
+}
+#endif
+
+/** Samples m[0..N-1] of 4 rows across a vertical edge: p3..q3 for luma (N = 8), p1..q1 for chroma (N = 4).
+ *  piSrc points to q0 of the first row.
+ */
+template<Int N>
+static inline Void xLoadRows( const Pel* piSrc, Int iStride, __m128i* m )
+{
+#if RExt__HIGH_BIT_DEPTH_SUPPORT
+  for( Int k = 0; k < N; k += 4 )
+  {
+    __m128i r[4];
+    for( Int i = 0; i < 4; i++ )
+    {
+      r[i] = _mm_loadu_si128( ( const __m128i* )( piSrc + i * iStride - N / 2 + k ) );
+    }
+    xTranspose4x4( r, m + k );
+  }
+#else
+  __m128i r[4];
+  for( Int i = 0; i < 4; i++ )
+  {
+    r[i] = N == 8 ? _mm_loadu_si128( ( const __m128i* )( piSrc + i * iStride - 4 ) ) : _mm_loadl_epi64( ( const __m128i* )( piSrc + i * iStride - 2 ) );
+  }
+  // pairs of 16-bit columns of the 4 rows: m[k] in the low half and m[k+1] in the high half of t[k/2]
+  const __m128i a0 = _mm_unpacklo_epi16( r[0], r[1] );
+  const __m128i a1 = _mm_unpacklo_epi16( r[2], r[3] );
+  __m128i t[4];
+  t[0] = _mm_unpacklo_epi32( a0, a1 );
+  t[1] = _mm_unpackhi_epi32( a0, a1 );
+  if( N == 8 )
+  {
+    const __m128i a2 = _mm_unpackhi_epi16( r[0], r[1] );
+    const __m128i a3 = _mm_unpackhi_epi16( r[2], r[3] );
+    t[2] = _mm_unpacklo_epi32( a2, a3 );
+    t[3] = _mm_unpackhi_epi32( a2, a3 );
+  }
+  for( Int k = 0; k < N; k += 2 )
+  {
+    m[k]     = _mm_cvtepi16_epi32( t[k >> 1] );
+    m[k + 1] = _mm_cvtepi16_epi32( _mm_unpackhi_epi64( t[k >> 1], t[k >> 1] ) );
+  }
+#endif
+}
+
+/** Store the samples m[0..N-1] of 4 rows across a vertical edge, the inverse of xLoadRows.
+ */
+template<Int N>
+static inline Void xStoreRows( Pel* piSrc, Int iStride, const __m128i* m )
+{
+#if RExt__HIGH_BIT_DEPTH_SUPPORT
+  for( Int k = 0; k < N; k += 4 )
+  {
+    __m128i r[4];
+    xTranspose4x4( m + k, r );
+    for( Int i = 0; i < 4; i++ )
+    {
+      _mm_storeu_si128( ( __m128i* )( piSrc + i * iStride - N / 2 + k ), r[i] );
+    }
+  }
+#else
+  __m128i c[4];
+  for( Int k = 0; k < N; k += 2 )
+  {
+    c[k >> 1] = _mm_packs_epi32( m[k], m[k + 1] );
+  }
+  // columns k and k+2 interleaved, then k, k+1, k+2, k+3 of each row
+  const __m128i d0 = _mm_unpacklo_epi16( c[0], c[1] );
+  const __m128i d1 = _mm_unpackhi_epi16( c[0], c[1] );
+  const __m128i e0 = _mm_unpacklo_epi16( d0, d1 );
+  const __m128i e1 = _mm_unpackhi_epi16( d0, d1 );
+  if( N == 8 )
+  {
+    const __m128i d2 = _mm_unpacklo_epi16( c[2], c[3] );
+    const __m128i d3 = _mm_unpackhi_epi16( c[2], c[3] );
+    const __m128i e2 = _mm_unpacklo_epi16( d2, d3 );
+    const __m128i e3 = _mm_unpackhi_epi16( d2, d3 );
+    _mm_storeu_si128( ( __m128i* )( piSrc              - 4 ), _mm_unpacklo_epi64( e0, e2 ) );
+    _mm_storeu_si128( ( __m128i* )( piSrc +     iStride - 4 ), _mm_unpackhi_epi64( e0, e2 ) );
+    _mm_storeu_si128( ( __m128i* )( piSrc + 2 * iStride - 4 ), _mm_unpacklo_epi64( e1, e3 ) );
+    _mm_storeu_si128( ( __m128i* )( piSrc + 3 * iStride - 4 ), _mm_unpackhi_epi64( e1, e3 ) );
+  }
+  else
+  {
+    _mm_storel_epi64( ( __m128i* )( piSrc               - 2 ), e0 );
+    _mm_storel_epi64( ( __m128i* )( piSrc +     iStride - 2 ), _mm_unpackhi_epi64( e0, e0 ) );
+    _mm_storel_epi64( ( __m128i* )( piSrc + 2 * iStride - 2 ), e1 );
+    _mm_storel_epi64( ( __m128i* )( piSrc + 3 * iStride - 2 ), _mm_unpackhi_epi64( e1, e1 ) );
+  }
+#endif
+}
+
+#if !RExt__HIGH_BIT_DEPTH_SUPPORT
+/** Transpose the first N (4 or 8) 16-bit columns of 8 rows r[0..7] to m[0..N-1].
+ */
+template<Int N>
+static inline Void xTranspose8xN( const __m128i* r, __m128i* m )
+{
+  for( Int h = 0; h < N / 4; h++ )
+  {
+    // columns 4h..4h+3 of the pairs of rows, then of rows 0-3 in b0, b2 and of rows 4-7 in b1, b3
+    const __m128i a0 = h ? _mm_unpackhi_epi16( r[0], r[1] ) : _mm_unpacklo_epi16( r[0], r[1] );
+    const __m128i a1 = h ? _mm_unpackhi_epi16( r[2], r[3] ) : _mm_unpacklo_epi16( r[2], r[3] );
+    const __m128i a2 = h ? _mm_unpackhi_epi16( r[4], r[5] ) : _mm_unpacklo_epi16( r[4], r[5] );
+    const __m128i a3 = h ? _mm_unpackhi_epi16( r[6], r[7] ) : _mm_unpacklo_epi16( r[6], r[7] );
+    const __m128i b0 = _mm_unpacklo_epi32( a0, a1 );
+    const __m128i b1 = _mm_unpacklo_epi32( a2, a3 );
+    const __m128i b2 = _mm_unpackhi_epi32( a0, a1 );
+    const __m128i b3 = _mm_unpackhi_epi32( a2, a3 );
+    m[4 * h]     = _mm_unpacklo_epi64( b0, b1 );
+    m[4 * h + 1] = _mm_unpackhi_epi64( b0, b1 );
+    m[4 * h + 2] = _mm_unpacklo_epi64( b2, b3 );
+    m[4 * h + 3] = _mm_unpackhi_epi64( b2, b3 );
+  }
+}
+
+/** Samples m[0..N-1] of 8 rows across a vertical edge, on 16-bit lanes. piSrc points to q0 of the first row.
+ */
+template<Int N>
+static inline Void xLoadRows16( const Pel* piSrc, Int iStride, __m128i* m )
+{
+  __m128i r[8];
+  for( Int i = 0; i < 8; i++ )
+  {
+    r[i] = N == 8 ? _mm_loadu_si128( ( const __m128i* )( piSrc + i * iStride - 4 ) ) : _mm_loadl_epi64( ( const __m128i* )( piSrc + i * iStride - 2 ) );
+  }
+  xTranspose8xN<N>( r, m );
+}
+
+/** Store the samples m[0..N-1] of 8 rows across a vertical edge, the inverse of xLoadRows16.
+ */
+template<Int N>
+static inline Void xStoreRows16( Pel* piSrc, Int iStride, const __m128i* m )
+{
+  if( N == 8 )
+  {
+    // the transposition of 8x8 samples is its own inverse
+    __m128i r[8];
+    xTranspose8xN<8>( m, r );
+    for( Int i = 0; i < 8; i++ )
+    {
+      _mm_storeu_si128( ( __m128i* )( piSrc + i * iStride - 4 ), r[i] );
+    }
+  }
+  else
+  {
+    // rows 2i and 2i+1 in the low and the high half of d[i]
+    const __m128i c0   = _mm_unpacklo_epi16( m[0], m[1] );
+    const __m128i c1   = _mm_unpacklo_epi16( m[2], m[3] );
+    const __m128i c2   = _mm_unpackhi_epi16( m[0], m[1] );
+    const __m128i c3   = _mm_unpackhi_epi16( m[2], m[3] );
+    const __m128i d[4] = { _mm_unpacklo_epi32( c0, c1 ), _mm_unpackhi_epi32( c0, c1 ), _mm_unpacklo_epi32( c2, c3 ), _mm_unpackhi_epi32( c2, c3 ) };
+    for( Int i = 0; i < 4; i++ )
+    {
+      _mm_storel_epi64( ( __m128i* )( piSrc + 2 * i * iStride - 2 ), d[i] );
+      _mm_storel_epi64( ( __m128i* )( piSrc + ( 2 * i + 1 ) * iStride - 2 ), _mm_unpackhi_epi64( d[i], d[i] ) );
+    }
+  }
+}
+#endif
+
+/** Samples m[0..N-1] across the edge of V::LINES lines, piSrc pointing to q0 of the first line.
+ */
+template<typename V, DeblockEdgeDir edgeDir, Int N>
+static inline Void xLoadLines( const Pel* piSrc, Int iStride, typename V::T* m )
+{
+  if( edgeDir == EDGE_HOR )
+  {
+    for( Int k = 0; k < N; k++ )
+    {
+      m[k] = V::loadPels( piSrc + ( k - N / 2 ) * iStride );
+    }
+  }
+  else
+  {
+    const Int B = V::BLOCK_LINES;
+    __m128i   q[N][V::LINES / B];
+    for( Int j = 0; j < V::LINES / B; j++ )
+    {
+      __m128i r[N];
+#if !RExt__HIGH_BIT_DEPTH_SUPPORT
+      if( B == 8 )
+      {
+        xLoadRows16<N>( piSrc + B * j * iStride, iStride, r );
+      }
+      else
+#endif
+      {
+        xLoadRows<N>( piSrc + B * j * iStride, iStride, r );
+      }
+      for( Int k = 0; k < N; k++ )
+      {
+        q[k][j] = r[k];
+      }
+    }
+    for( Int k = 0; k < N; k++ )
+    {
+      m[k] = V::fromBlocks( q[k] );
+    }
+  }
+}
+
+/** Store the samples across the edge of V::LINES lines; across a horizontal edge, only the rows that can change
+ *  (all but the first and the last) are written.
+ */
+template<typename V, DeblockEdgeDir edgeDir, Int N>
+static inline Void xStoreLines( Pel* piSrc, Int iStride, const typename V::T* m )
+{
+  if( edgeDir == EDGE_HOR )
+  {
+    for( Int k = 1; k < N - 1; k++ )
+    {
+      V::storePels( piSrc + ( k - N / 2 ) * iStride, m[k] );
+    }
+  }
+  else
+  {
+    const Int B = V::BLOCK_LINES;
+    __m128i   q[N][V::LINES / B];
+    for( Int k = 0; k < N; k++ )
+    {
+      V::toBlocks( m[k], q[k] );
+    }
+    for( Int j = 0; j < V::LINES / B; j++ )
+    {
+      __m128i r[N];
+      for( Int k = 0; k < N; k++ )
+      {
+        r[k] = q[k][j];
+      }
+#if !RExt__HIGH_BIT_DEPTH_SUPPORT
+      if( B == 8 )
+      {
+        xStoreRows16<N>( piSrc + B * j * iStride, iStride, r );
+      }
+      else
+#endif
+      {
+        xStoreRows<N>( piSrc + B * j * iStride, iStride, r );
+      }
+    }
+  }
+}
+
+// ====================================================================================================================
+// Luma
+// ====================================================================================================================
+
+/** Filter the lines of a luma edge from iLine, V::LINES at a time, as long as a whole register of lines is left.
+ *  m[0..7] are the samples p3, p2, p1, p0, q0, q1, q2, q3 of each line.
+ *  \returns the first line that is not filtered
+ */
+template<typename V, DeblockEdgeDir edgeDir>
+static inline Int xFilterEdgeLumaLines( Pel* piSrc, Int iStride, Int iLine, Int numLines, const LFEdgeParam& param, Int bitDepth )
+{
+  typedef typename V::T T;
+
+  const Int iSrcStep = edgeDir == EDGE_VER ? iStride : 1;
+  const T   zero     = V::set1( 0 );
+  const T   one      = V::set1( 1 );
+  const T   two      = V::set1( 2 );
+  const T   four     = V::set1( 4 );
+  const T   eight    = V::set1( 8 );
+  const T   maxVal   = V::set1( ( 1 << bitDepth ) - 1 );
+
+  for( ; iLine + V::LINES <= numLines; iLine += V::LINES )
+  {
+    const T beta = V::loadParam( param.aiBeta + iLine );
+    if( !xAny( beta ) )
+    {
+      continue;
+    }
+
+    Pel* const piLines = piSrc + iLine * iSrcStep;
+    T m[8];
+    xLoadLines<V, edgeDir, 8>( piLines, iStride, m );
+
+    // decisions of each segment, from its lines 0 and 3
+    const T dp    = V::abs( V::add( V::sub( m[1], V::slli( m[2], 1 ) ), m[3] ) );
+    const T dq    = V::abs( V::add( V::sub( m[4], V::slli( m[5], 1 ) ), m[6] ) );
+    const T dpSeg = V::add( V::line0( dp ), V::line3( dp ) );
+    const T dqSeg = V::add( V::line0( dq ), V::line3( dq ) );
+    const T on    = V::less( V::add( dpSeg, dqSeg ), beta );
+    if( !xAny( on ) )
+    {
+      continue;
+    }
+
+    const T tc            = V::loadParam( param.aiTc + iLine );
+    const T keepP         = V::loadParam( param.aiNoFilterP + iLine );
+    const T keepQ         = V::loadParam( param.aiNoFilterQ + iLine );
+    const T sideThreshold = V::srai( V::add( beta, V::srai( beta, 1 ) ), 3 );
+    const T filterP       = V::less( dpSeg, sideThreshold );
+    const T filterQ       = V::less( dqSeg, sideThreshold );
+    const T strongLine    = xAnd( xAnd( V::less( V::add( V::abs( V::sub( m[0], m[3] ) ), V::abs( V::sub( m[7], m[4] ) ) ), V::srai( beta, 3 ) ),
+                                        V::less( V::slli( V::add( dp, dq ), 1 ), V::srai( beta, 2 ) ) ),
+                                  V::less( V::abs( V::sub( m[3], m[4] ) ), V::srai( V::add( V::add( V::slli( tc, 2 ), tc ), one ), 1 ) ) );
+    const T sw            = xAnd( V::line0( strongLine ), V::line3( strongLine ) );
+    const T strong        = xAnd( on, sw );
+
+    // strong filter
+    const T tc2 = V::slli( tc, 1 );
+    const T m34 = V::add( m[3], m[4] );
+    const T sp0 = V::srai( V::add( V::add( m[1], m[5] ), V::add( V::slli( V::add( m[2], m34 ), 1 ), four ) ), 3 );
+    const T sq0 = V::srai( V::add( V::add( m[2], m[6] ), V::add( V::slli( V::add( m34, m[5] ), 1 ), four ) ), 3 );
+    const T sp1 = V::srai( V::add( V::add( m[1], m[2] ), V::add( m34, two ) ), 2 );
+    const T sq1 = V::srai( V::add( V::add( m[5], m[6] ), V::add( m34, two ) ), 2 );
+    const T sp2 = V::srai( V::add( V::add( V::slli( V::add( m[0], m[1] ), 1 ), V::add( m[1], m[2] ) ), V::add( m34, four ) ), 3 );
+    const T sq2 = V::srai( V::add( V::add( V::slli( V::add( m[6], m[7] ), 1 ), V::add( m[6], m[5] ) ), V::add( m34, four ) ), 3 );
+
+    // weak filter
+    const T a      = V::sub( m[4], m[3] );
+    const T b      = V::sub( m[5], m[2] );
+    T       delta  = V::srai( V::add( V::sub( V::add( V::slli( a, 3 ), a ), V::add( V::slli( b, 1 ), b ) ), eight ), 4 );
+    const T thrCut = V::add( V::slli( tc, 3 ), V::slli( tc, 1 ) );
+    const T weak   = xAndNot( sw, xAnd( on, V::less( V::abs( delta ), thrCut ) ) );
+    delta          = V::clip( delta, V::sub( zero, tc ), tc );
+    const T tcH    = V::srai( tc, 1 );
+    const T ntcH   = V::sub( zero, tcH );
+    const T delta1 = V::clip( V::srai( V::sub( V::add( V::srai( V::add( V::add( m[1], m[3] ), one ), 1 ), delta ), m[2] ), 1 ), ntcH, tcH );
+    const T delta2 = V::clip( V::srai( V::sub( V::sub( V::srai( V::add( V::add( m[6], m[4] ), one ), 1 ), m[5] ), delta ), 1 ), ntcH, tcH );
+    const T wp0    = V::clip( V::add( m[3], delta ), zero, maxVal );
+    const T wq0    = V::clip( V::sub( m[4], delta ), zero, maxVal );
+    const T wp1    = V::clip( V::add( m[2], delta1 ), zero, maxVal );
+    const T wq1    = V::clip( V::add( m[5], delta2 ), zero, maxVal );
+
+    const T strongP = xAndNot( keepP, strong );
+    const T strongQ = xAndNot( keepQ, strong );
+    const T weakP   = xAndNot( keepP, weak );
+    const T weakQ   = xAndNot( keepQ, weak );
+
+    m[1] = xSelect( m[1], V::clip( sp2, V::sub( m[1], tc2 ), V::add( m[1], tc2 ) ), strongP );
+    m[6] = xSelect( m[6], V::clip( sq2, V::sub( m[6], tc2 ), V::add( m[6], tc2 ) ), strongQ );
+    m[2] = xSelect( xSelect( m[2], wp1, xAnd( weakP, filterP ) ), V::clip( sp1, V::sub( m[2], tc2 ), V::add( m[2], tc2 ) ), strongP );
+    m[5] = xSelect( xSelect( m[5], wq1, xAnd( weakQ, filterQ ) ), V::clip( sq1, V::sub( m[5], tc2 ), V::add( m[5], tc2 ) ), strongQ );
+    m[3] = xSelect( xSelect( m[3], wp0, weakP ), V::clip( sp0, V::sub( m[3], tc2 ), V::add( m[3], tc2 ) ), strongP );
+    m[4] = xSelect( xSelect( m[4], wq0, weakQ ), V::clip( sq0, V::sub( m[4], tc2 ), V::add( m[4], tc2 ) ), strongQ );
+
+    xStoreLines<V, edgeDir, 8>( piLines, iStride, m );
+  }
+  return iLine;
+}
+
+/** The lines are filtered on the widest registers first; the rows across a vertical edge are transposed in 128-bit
+ *  blocks, which leaves no gain to 512-bit registers there.
+ */
+template<X86_VEXT vext, DeblockEdgeDir edgeDir>
+Void TComLoopFilter::xFilterEdgeLumaX86( Pel* piSrc, Int iStride, Int numLines, const LFEdgeParam& param, Int bitDepthLuma )
+{
+  Int iLine = 0;
+#if !RExt__HIGH_BIT_DEPTH_SUPPORT
+  if( bitDepthLuma <= LF_MAX_BIT_DEPTH_16 )
+  {
+#if X86_KERNELS_AVX512
+    if( edgeDir == EDGE_HOR )
+    {
+      iLine = xFilterEdgeLumaLines<LFVec512x16, edgeDir>( piSrc, iStride, iLine, numLines, param, bitDepthLuma );
+    }
+#endif
+#if X86_KERNELS_AVX2
+    iLine = xFilterEdgeLumaLines<LFVec256x16, edgeDir>( piSrc, iStride, iLine, numLines, param, bitDepthLuma );
+#endif
+    iLine = xFilterEdgeLumaLines<LFVec128x16, edgeDir>( piSrc, iStride, iLine, numLines, param, bitDepthLuma );
+  }
+#endif
+  // 32-bit lanes for the deeper samples
+#if X86_KERNELS_AVX512
+  if( edgeDir == EDGE_HOR )
+  {
+    iLine = xFilterEdgeLumaLines<LFVec512, edgeDir>( piSrc, iStride, iLine, numLines, param, bitDepthLuma );
+  }
+#endif
+#if X86_KERNELS_AVX2
+  iLine = xFilterEdgeLumaLines<LFVec256, edgeDir>( piSrc, iStride, iLine, numLines, param, bitDepthLuma );
+#endif
+  xFilterEdgeLumaLines<LFVec128, edgeDir>( piSrc, iStride, iLine, numLines, param, bitDepthLuma );
+}
+
+// ====================================================================================================================
+// Chroma
+// ====================================================================================================================
+
+/** Filter the lines of a chroma edge from iLine, V::LINES at a time, as long as a whole register of lines is left.
+ *  m[0..3] are the samples p1, p0, q0, q1 of each line.
+ *  \returns the first line that is not filtered
+ */
+template<typename V, DeblockEdgeDir edgeDir>
+static inline Int xFilterEdgeChromaLines( Pel* piSrc, Int iStride, Int iLine, Int numLines, const LFEdgeParam& param, Int bitDepth )
+{
+  typedef typename V::T T;
+
+  const Int iSrcStep = edgeDir == EDGE_VER ? iStride : 1;
+  const T   zero     = V::set1( 0 );
+  const T   four     = V::set1( 4 );
+  const T   maxVal   = V::set1( ( 1 << bitDepth ) - 1 );
+
+  for( ; iLine + V::LINES <= numLines; iLine += V::LINES )
+  {
+    const T tc = V::loadParam( param.aiTc + iLine );
+    if( !xAny( tc ) )
+    {
+      continue;
+    }
+
+    Pel* const piLines = piSrc + iLine * iSrcStep;
+    T m[4];
+    xLoadLines<V, edgeDir, 4>( piLines, iStride, m );
+
+    const T delta = V::clip( V::srai( V::add( V::sub( V::add( V::slli( V::sub( m[2], m[1] ), 2 ), m[0] ), m[3] ), four ), 3 ), V::sub( zero, tc ), tc );
+
+    m[1] = xSelect( V::clip( V::add( m[1], delta ), zero, maxVal ), m[1], V::loadParam( param.aiNoFilterP + iLine ) );
+    m[2] = xSelect( V::clip( V::sub( m[2], delta ), zero, maxVal ), m[2], V::loadParam( param.aiNoFilterQ + iLine ) );
+
+    xStoreLines<V, edgeDir, 4>( piLines, iStride, m );
+  }
+  return iLine;
+}
+
+template<X86_VEXT vext, DeblockEdgeDir edgeDir>
+Void TComLoopFilter::xFilterEdgeChromaX86( Pel* piSrc, Int iStride, Int numLines, const LFEdgeParam& param, Int bitDepthChroma )
+{
+  Int iLine = 0;
+#if !RExt__HIGH_BIT_DEPTH_SUPPORT
+  if( bitDepthChroma <= LF_MAX_BIT_DEPTH_16 )
+  {
+#if X86_KERNELS_AVX512
+    if( edgeDir == EDGE_HOR )
+    {
+      iLine = xFilterEdgeChromaLines<LFVec512x16, edgeDir>( piSrc, iStride, iLine, numLines, param, bitDepthChroma );
+    }
+#endif
+#if X86_KERNELS_AVX2
+    iLine = xFilterEdgeChromaLines<LFVec256x16, edgeDir>( piSrc, iStride, iLine, numLines, param, bitDepthChroma );
+#endif
+    iLine = xFilterEdgeChromaLines<LFVec128x16, edgeDir>( piSrc, iStride, iLine, numLines, param, bitDepthChroma );
+  }
+#endif
+  // 32-bit lanes for the deeper samples, and for the last 4 chroma lines
+#if X86_KERNELS_AVX512
+  if( edgeDir == EDGE_HOR )
+  {
+    iLine = xFilterEdgeChromaLines<LFVec512, edgeDir>( piSrc, iStride, iLine, numLines, param, bitDepthChroma );
+  }
+#endif
+#if X86_KERNELS_AVX2
+  iLine = xFilterEdgeChromaLines<LFVec256, edgeDir>( piSrc, iStride, iLine, numLines, param, bitDepthChroma );
+#endif
+  xFilterEdgeChromaLines<LFVec128, edgeDir>( piSrc, iStride, iLine, numLines, param, bitDepthChroma );
+}
+
+// ====================================================================================================================
+// Installation
+// ====================================================================================================================
+
+template<X86_VEXT vext>
+Void TComLoopFilter::xInitLoopFilterX86()
+{
+  m_afpFilterEdgeLuma  [EDGE_VER] = xFilterEdgeLumaX86  <vext, EDGE_VER>;
+  m_afpFilterEdgeLuma  [EDGE_HOR] = xFilterEdgeLumaX86  <vext, EDGE_HOR>;
+  m_afpFilterEdgeChroma[EDGE_VER] = xFilterEdgeChromaX86<vext, EDGE_VER>;
+  m_afpFilterEdgeChroma[EDGE_HOR] = xFilterEdgeChromaX86<vext, EDGE_HOR>;
+}
+
+//! \}
+
+#endif // VECTOR_CODING__X86_DISPATCH
+
+#endif // __TCOMLOOPFILTERX86__
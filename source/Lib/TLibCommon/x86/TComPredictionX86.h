@@ -0,0 +1,481 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2022, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TComPredictionX86.h
+    \brief    SSE4.1, AVX2 and AVX-512 intra prediction kernels of TComPrediction
+    \details  Included by x86/<extension>/TComPrediction_<extension>.cpp, which are compiled with the matching target flags.
+              The kernels give exactly the same samples as the scalar functions, for 16-bit and (high bit depth) 32-bit Pel,
+              and share the sample registers and the column walk of the interpolation filter kernels.
+              Angular modes are predicted one line of the main reference at a time; horizontal modes are predicted into a
+              temporary block, which is then transposed in tiles.
+*/
+
+#ifndef __TCOMPREDICTIONX86__
+#define __TCOMPREDICTIONX86__
+
+#include "TComPrediction.h"
+#include "TComInterpolationFilterX86.h"
+
+#if VECTOR_CODING__X86_DISPATCH
+
+//! \ingroup TLibCommon
+//! \{
+
+// ====================================================================================================================
+// Angular prediction
+// ====================================================================================================================
+
+/** Interpolation between the main reference samples a and b, ((32-f)*a + f*b + 16) >> 5, computed as
+ *  a + ((f*(b-a) + 16) >> 5). With 16-bit samples, the rounded product is _mm_mulhrs_epi16 with the weight f << 10.
+ */
+#if RExt__HIGH_BIT_DEPTH_SUPPORT
+template<typename T>
+static inline T xPredIntraAngWeight( Int deltaFract )
+{
+  return xSet1( deltaFract, T() );
+}
+
+template<typename T>
+static inline T xPredIntraAngInterpolate( const T& a, const T& b, const T& weight )
+{
+  return xAdd( a, xSra( xAdd( xMul( xSubPel( b, a ), weight ), xSet1( 16, T() ) ), _mm_cvtsi32_si128( 5 ) ) );
+}
+#else
+template<typename T>
+static inline T xPredIntraAngWeight( Int deltaFract )
+{
+  return xSet1Pel( deltaFract << 10, T() );
+}
+
+static inline __m128i xPredIntraAngInterpolate( __m128i a, __m128i b, __m128i weight )
+{
+  return _mm_add_epi16( a, _mm_mulhrs_epi16( _mm_sub_epi16( b, a ), weight ) );
+}
+#if X86_KERNELS_AVX2
+static inline __m256i xPredIntraAngInterpolate( __m256i a, __m256i b, __m256i weight )
+{
+  return _mm256_add_epi16( a, _mm256_mulhrs_epi16( _mm256_sub_epi16( b, a ), weight ) );
+}
+#endif
+#if X86_KERNELS_AVX512
+static inline __m512i xPredIntraAngInterpolate( __m512i a, __m512i b, __m512i weight )
+{
+  return _mm512_add_epi16( a, _mm512_mulhrs_epi16( _mm512_sub_epi16( b, a ), weight ) );
+}
+#endif
+#endif
+
+/** Predict the numRows lines of rowLength samples of an angular mode, each line being projected onto the main reference;
+ *  rowLength is a multiple of V::PELS.
+ */
+template<typename V>
+static inline Void xPredIntraAngLines( const Pel* refMain, Int intraPredAngle, Pel* pDst, Int dstStride, Int rowLength, Int numRows )
+{
+  typedef typename V::T T;
+
+  for( Int y = 0, deltaPos = intraPredAngle; y < numRows; y++, deltaPos += intraPredAngle, pDst += dstStride )
+  {
+    const Int  deltaInt   = deltaPos >> 5;
+    const Int  deltaFract = deltaPos & ( 32 - 1 );
+    const Pel* pRM        = refMain + deltaInt + 1;
+
+    if( deltaFract )
+    {
+      const T weight = xPredIntraAngWeight<T>( deltaFract );
+      for( Int x = 0; x < rowLength; x += V::PELS )
+      {
+        V::store( pDst + x, xPredIntraAngInterpolate( V::load( pRM + x ), V::load( pRM + x + 1 ), weight ) );
+      }
+    }
+    else
+    {
+      for( Int x = 0; x < rowLength; x += V::PELS )
+      {
+        V::store( pDst + x, V::load( pRM + x ) );
+      }
+    }
+  }
+}
+
+/** Predict the lines of an angular mode with the widest register that fits in a line.
+ */
+static inline Void xPredIntraAngLines( const Pel* refMain, Int intraPredAngle, Pel* pDst, Int dstStride, Int rowLength, Int numRows )
+{
+#if X86_KERNELS_AVX512
+  if( rowLength >= PelVec512::PELS )
+  {
+    xPredIntraAngLines<PelVec512>( refMain, intraPredAngle, pDst, dstStride, rowLength, numRows );
+    return;
+  }
+#endif
+#if X86_KERNELS_AVX2
+  if( rowLength >= PelVec256::PELS )
+  {
+    xPredIntraAngLines<PelVec256>( refMain, intraPredAngle, pDst, dstStride, rowLength, numRows );
+    return;
+  }
+#endif
+  if( rowLength >= PelVec128::PELS )
+  {
+    xPredIntraAngLines<PelVec128>( refMain, intraPredAngle, pDst, dstStride, rowLength, numRows );
+    return;
+  }
+  xPredIntraAngLines<PelVec64>( refMain, intraPredAngle, pDst, dstStride, rowLength, numRows );
+}
+
+#if RExt__HIGH_BIT_DEPTH_SUPPORT
+/// transpose of a tile of 4x4 32-bit samples
+static inline Void xTransposeTile4x4( const Pel* src, Int srcStride, Pel* dst, Int dstStride )
+{
+  const __m128i r0 = PelVec128::load( src );
+  const __m128i r1 = PelVec128::load( src +     srcStride );
+  const __m128i r2 = PelVec128::load( src + 2 * srcStride );
+  const __m128i r3 = PelVec128::load( src + 3 * srcStride );
+
+  const __m128i a0 = _mm_unpacklo_epi32( r0, r1 );
+  const __m128i a1 = _mm_unpackhi_epi32( r0, r1 );
+  const __m128i a2 = _mm_unpacklo_epi32( r2, r3 );
+  const __m128i a3 = _mm_unpackhi_epi32( r2, r3 );
+
+  PelVec128::store( dst,                 _mm_unpacklo_epi64( a0, a2 ) );
+  PelVec128::store( dst +     dstStride, _mm_unpackhi_epi64( a0, a2 ) );
+  PelVec128::store( dst + 2 * dstStride, _mm_unpacklo_epi64( a1, a3 ) );
+  PelVec128::store( dst + 3 * dstStride, _mm_unpackhi_epi64( a1, a3 ) );
+}
+#else
+/// transpose of a tile of 4x4 16-bit samples
+static inline Void xTransposeTile4x4( const Pel* src, Int srcStride, Pel* dst, Int dstStride )
+{
+  const __m128i a0 = _mm_unpacklo_epi16( PelVec64::load( src ),                 PelVec64::load( src +     srcStride ) );
+  const __m128i a1 = _mm_unpacklo_epi16( PelVec64::load( src + 2 * srcStride ), PelVec64::load( src + 3 * srcStride ) );
+  const __m128i b0 = _mm_unpacklo_epi32( a0, a1 );
+  const __m128i b1 = _mm_unpackhi_epi32( a0, a1 );
+
+  PelVec64::store( dst,                 b0 );
+  PelVec64::store( dst +     dstStride, _mm_srli_si128( b0, 8 ) );
+  PelVec64::store( dst + 2 * dstStride, b1 );
+  PelVec64::store( dst + 3 * dstStride, _mm_srli_si128( b1, 8 ) );
+}
+
+/// transpose of a tile of 8x8 16-bit samples
+static inline Void xTransposeTile8x8( const Pel* src, Int srcStride, Pel* dst, Int dstStride )
+{
+  __m128i r[8];
+  for( Int k = 0; k < 8; k++ )
+  {
+    r[k] = PelVec128::load( src + k * srcStride );
+  }
+
+  const __m128i a0 = _mm_unpacklo_epi16( r[0], r[1] );
+  const __m128i a1 = _mm_unpackhi_epi16( r[0], r[1] );
+  const __m128i a2 = _mm_unpacklo_epi16( r[2], r[3] );
+  const __m128i a3 = _mm_unpackhi_epi16( r[2], r[3] );
+  const __m128i a4 = _mm_unpacklo_epi16( r[4], r[5] );
+  const __m128i a5 = _mm_unpackhi_epi16( r[4], r[5] );
+  const __m128i a6 = _mm_unpacklo_epi16( r[6], r[7] );
+  const __m128i a7 = _mm_unpackhi_epi16( r[6], r[7] );
+
+  const __m128i b0 = _mm_unpacklo_epi32( a0, a2 );
+  const __m128i b1 = _mm_unpackhi_epi32( a0, a2 );
+  const __m128i b2 = _mm_unpacklo_epi32( a1, a3 );
+  const __m128i b3 = _mm_unpackhi_epi32( a1, a3 );
+  const __m128i b4 = _mm_unpacklo_epi32( a4, a6 );
+  const __m128i b5 = _mm_unpackhi_epi32( a4, a6 );
+  const __m128i b6 = _mm_unpacklo_epi32( a5, a7 );
+  const __m128i b7 = _mm_unpackhi_epi32( a5, a7 );
+
+  PelVec128::store( dst,                 _mm_unpacklo_epi64( b0, b4 ) );
+  PelVec128::store( dst +     dstStride, _mm_unpackhi_epi64( b0, b4 ) );
+  PelVec128::store( dst + 2 * dstStride, _mm_unpacklo_epi64( b1, b5 ) );
+  PelVec128::store( dst + 3 * dstStride, _mm_unpackhi_epi64( b1, b5 ) );
+  PelVec128::store( dst + 4 * dstStride, _mm_unpacklo_epi64( b2, b6 ) );
+  PelVec128::store( dst + 5 * dstStride, _mm_unpackhi_epi64( b2, b6 ) );
+  PelVec128::store( dst + 6 * dstStride, _mm_unpacklo_epi64( b3, b7 ) );
+  PelVec128::store( dst + 7 * dstStride, _mm_unpackhi_epi64( b3, b7 ) );
+}
+#endif
+
+/** Transpose a block of width x height samples; both dimensions are multiples of 4.
+ */
+static inline Void xTransposeBlock( const Pel* src, Int srcStride, Pel* dst, Int dstStride, Int width, Int height )
+{
+#if !RExt__HIGH_BIT_DEPTH_SUPPORT
+  if( ( ( width | height ) & 7 ) == 0 )
+  {
+    for( Int y = 0; y < height; y += 8 )
+    {
+      for( Int x = 0; x < width; x += 8 )
+      {
+        xTransposeTile8x8( src + y * srcStride + x, srcStride, dst + x * dstStride + y, dstStride );
+      }
+    }
+    return;
+  }
+#endif
+  for( Int y = 0; y < height; y += 4 )
+  {
+    for( Int x = 0; x < width; x += 4 )
+    {
+      xTransposeTile4x4( src + y * srcStride + x, srcStride, dst + x * dstStride + y, dstStride );
+    }
+  }
+}
+
+template<X86_VEXT vext, Bool bIsModeVer>
+Void TComPrediction::xPredIntraAngX86( const Pel* refMain, Int intraPredAngle, Pel* pDst, Int dstStride, Int width, Int height )
+{
+  if( bIsModeVer )
+  {
+    xPredIntraAngLines( refMain, intraPredAngle, pDst, dstStride, width, height );
+  }
+  else
+  {
+    // one line per column, transposed into the block
+    Pel tmp[MAX_CU_SIZE * MAX_CU_SIZE];
+    xPredIntraAngLines( refMain, intraPredAngle, tmp, height, height, width );
+    xTransposeBlock( tmp, height, pDst, dstStride, height, width );
+  }
+}
+
+// ====================================================================================================================
+// Planar prediction
+// ====================================================================================================================
+
+/// 32-bit lanes of the planar prediction
+struct PlanarVec128
+{
+  typedef __m128i T;
+  static const Int LANES = 4;
+  static inline T    load ( const Int* p )       { return _mm_loadu_si128( ( const __m128i* )p ); }
+  static inline T    set1 ( Int v )              { return _mm_set1_epi32( v ); }
+  static inline T    add  ( T a, T b )           { return _mm_add_epi32( a, b ); }
+  static inline T    mul  ( T a, T b )           { return _mm_mullo_epi32( a, b ); }
+  static inline T    sra  ( T a, __m128i cnt )   { return _mm_sra_epi32( a, cnt ); }
+#if RExt__HIGH_BIT_DEPTH_SUPPORT
+  static inline Void store( Pel* p, T v )        { _mm_storeu_si128( ( __m128i* )p, v ); }
+#else
+  static inline Void store( Pel* p, T v )        { _mm_storel_epi64( ( __m128i* )p, _mm_packs_epi32( v, v ) ); }
+#endif
+};
+
+#if X86_KERNELS_AVX2
+struct PlanarVec256
+{
+  typedef __m256i T;
+  static const Int LANES = 8;
+  static inline T    load ( const Int* p )       { return _mm256_loadu_si256( ( const __m256i* )p ); }
+  static inline T    set1 ( Int v )              { return _mm256_set1_epi32( v ); }
+  static inline T    add  ( T a, T b )           { return _mm256_add_epi32( a, b ); }
+  static inline T    mul  ( T a, T b )           { return _mm256_mullo_epi32( a, b ); }
+  static inline T    sra  ( T a, __m128i cnt )   { return _mm256_sra_epi32( a, cnt ); }
+#if RExt__HIGH_BIT_DEPTH_SUPPORT
+  static inline Void store( Pel* p, T v )        { _mm256_storeu_si256( ( __m256i* )p, v ); }
+#else
+  static inline Void store( Pel* p, T v )        { _mm_storeu_si128( ( __m128i* )p, _mm256_castsi256_si128( _mm256_permute4x64_epi64( _mm256_packs_epi32( v, v ), 0x08 ) ) ); }
+#endif
+};
+#endif
+
+#if X86_KERNELS_AVX512
+struct PlanarVec512
+{
+  typedef __m512i T;
+  static const Int LANES = 16;
+  static inline T    load ( const Int* p )       { return _mm512_loadu_si512( ( const void* )p ); }
+  static inline T    set1 ( Int v )              { return _mm512_set1_epi32( v ); }
+  static inline T    add  ( T a, T b )           { return _mm512_add_epi32( a, b ); }
+  static inline T    mul  ( T a, T b )           { return _mm512_mullo_epi32( a, b ); }
+  static inline T    sra  ( T a, __m128i cnt )   { return _mm512_sra_epi32( a, cnt ); }
+#if RExt__HIGH_BIT_DEPTH_SUPPORT
+  static inline Void store( Pel* p, T v )        { _mm512_storeu_si512( ( void* )p, v ); }
+#else
+  static inline Void store( Pel* p, T v )        { _mm256_storeu_si256( ( __m256i* )p, _mm512_cvtsepi32_epi16( v ) ); }
+#endif
+};
+#endif
+
+/// per line and per column terms of the planar prediction, as in TComPrediction::xPredIntraPlanarBlk
+struct PlanarTerms
+{
+  Int topRow   [MAX_CU_SIZE];  ///< above sample, scaled by the height
+  Int bottomRow[MAX_CU_SIZE];  ///< vertical increment: bottom-left sample minus above sample
+  Int xPlusOne [MAX_CU_SIZE];  ///< weight of the horizontal increment
+  Int horBase  [MAX_CU_SIZE];  ///< left sample, scaled by the width, plus the rounding offset
+  Int horStep  [MAX_CU_SIZE];  ///< horizontal increment: top-right sample minus left sample
+};
+
+/** Predict the columns from x on with registers of V::LANES samples, while they fit in the block.
+ */
+template<typename V>
+static inline Void xPredIntraPlanarColumns( const PlanarTerms& t, Pel* pDst, Int dstStride, Int width, Int height, Int& x, const __m128i& shift )
+{
+  typedef typename V::T T;
+
+  for( ; x + V::LANES <= width; x += V::LANES )
+  {
+    const T bottom   = V::load( t.bottomRow + x );
+    const T xPlusOne = V::load( t.xPlusOne  + x );
+    T       vertPred = V::load( t.topRow    + x );
+    Pel*    dst      = pDst + x;
+
+    for( Int y = 0; y < height; y++, dst += dstStride )
+    {
+      vertPred         = V::add( vertPred, bottom );
+      const T horPred  = V::add( V::set1( t.horBase[y] ), V::mul( xPlusOne, V::set1( t.horStep[y] ) ) );
+      V::store( dst, V::sra( V::add( horPred, vertPred ), shift ) );
+    }
+  }
+}
+
+template<X86_VEXT vext>
+Void TComPrediction::xPredIntraPlanarX86( const Pel* refAbove, const Pel* refLeft, Pel* pDst, Int dstStride, Int width, Int height )
+{
+  assert( width <= height );
+
+  const Int shift1Dhor = g_aucConvertToBit[ width ] + 2;
+  const Int shift1Dver = g_aucConvertToBit[ height ] + 2;
+  const Int bottomLeft = refLeft[ height + 1 ];
+  const Int topRight   = refAbove[ width + 1 ];
+
+  PlanarTerms t;
+  for( Int k = 0; k < width; k++ )
+  {
+    t.topRow   [k] = refAbove[k + 1] << shift1Dver;
+    t.bottomRow[k] = bottomLeft - refAbove[k + 1];
+    t.xPlusOne [k] = k + 1;
+  }
+  for( Int k = 0; k < height; k++ )
+  {
+    t.horBase[k] = ( refLeft[k + 1] << shift1Dhor ) + width;
+    t.horStep[k] = topRight - refLeft[k + 1];
+  }
+
+  const __m128i shift = _mm_cvtsi32_si128( shift1Dhor + 1 );
+  Int x = 0;
+#if X86_KERNELS_AVX512
+  xPredIntraPlanarColumns<PlanarVec512>( t, pDst, dstStride, width, height, x, shift );
+#endif
+#if X86_KERNELS_AVX2
+  xPredIntraPlanarColumns<PlanarVec256>( t, pDst, dstStride, width, height, x, shift );
+#endif
+  xPredIntraPlanarColumns<PlanarVec128>( t, pDst, dstStride, width, height, x, shift );
+  assert( x == width );
+}
+
+// ====================================================================================================================
+// DC prediction
+// ====================================================================================================================
+
+/// row of the DC prediction
+struct PredIntraDCFill
+{
+  Pel* dst;
+  Pel  dcVal;
+
+  template<typename V>
+  Void column( Int x ) const
+  {
+    V::store( dst + x, xSet1Pel( dcVal, typename V::T() ) );
+  }
+};
+
+/** Sum of numPels reference samples, numPels being a multiple of 4.
+ */
+static inline Int xSumRefs( const Pel* ref, Int numPels )
+{
+  __m128i sum = _mm_setzero_si128();
+  Int     k   = 0;
+#if RExt__HIGH_BIT_DEPTH_SUPPORT
+  for( ; k < numPels; k += PelVec128::PELS )
+  {
+    sum = _mm_add_epi32( sum, PelVec128::load( ref + k ) );
+  }
+#else
+  const __m128i ones = _mm_set1_epi16( 1 );
+  for( ; k + PelVec128::PELS <= numPels; k += PelVec128::PELS )
+  {
+    sum = _mm_add_epi32( sum, _mm_madd_epi16( PelVec128::load( ref + k ), ones ) );
+  }
+  if( k < numPels )
+  {
+    sum = _mm_add_epi32( sum, _mm_madd_epi16( PelVec64::load( ref + k ), ones ) );
+  }
+#endif
+  sum = _mm_add_epi32( sum, _mm_shuffle_epi32( sum, 0x4e ) );
+  sum = _mm_add_epi32( sum, _mm_shuffle_epi32( sum, 0xb1 ) );
+  return _mm_cvtsi128_si32( sum );
+}
+
+template<X86_VEXT vext>
+Void TComPrediction::xPredIntraDCX86( const Pel* refAbove, const Pel* refLeft, Pel* pDst, Int dstStride, Int width, Int height, Bool bFilter )
+{
+  const Pel dcval = ( xSumRefs( refAbove + 1, width ) + xSumRefs( refLeft + 1, height ) + width ) / ( width + height );
+
+  for( Int y = 0; y < height; y++ )
+  {
+    const PredIntraDCFill op = { pDst + y * dstStride, dcval };
+    xForEachColumn( width, op );
+  }
+
+  if( bFilter )
+  {
+    pDst[0] = ( Pel )( ( refAbove[1] + refLeft[1] + 2 * dcval + 2 ) >> 2 );
+    for( Int x = 1; x < width; x++ )
+    {
+      pDst[x] = ( Pel )( ( refAbove[x + 1] + 3 * dcval + 2 ) >> 2 );
+    }
+    for( Int y = 1; y < height; y++ )
+    {
+      pDst[y * dstStride] = ( Pel )( ( refLeft[y + 1] + 3 * dcval + 2 ) >> 2 );
+    }
+  }
+}
+
+// ====================================================================================================================
+// Installation
+// ====================================================================================================================
+
+template<X86_VEXT vext>
+Void TComPrediction::xInitPredictionX86()
+{
+  m_afpPredIntraAng[0] = xPredIntraAngX86<vext, false>;
+  m_afpPredIntraAng[1] = xPredIntraAngX86<vext, true>;
+  m_fpPredIntraPlanar  = xPredIntraPlanarX86<vext>;
+  m_fpPredIntraDC      = xPredIntraDCX86<vext>;
+}
+
+//! \}
+
+#endif // VECTOR_CODING__X86_DISPATCH
+
+#endif // __TCOMPREDICTIONX86__
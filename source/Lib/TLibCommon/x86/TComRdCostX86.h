@@ -0,0 +1,770 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2022, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TComRdCostX86.h
+    \brief    SSE4.1, AVX2 and AVX-512 distortion kernels of TComRdCost
+    \details  Included by x86/<extension>/TComRdCost_<extension>.cpp, which are compiled with the matching target flags.
+              The kernels give exactly the same results as the scalar functions, for 16-bit and (high bit depth) 32-bit Pel.
+*/
+
+#ifndef __TCOMRDCOSTX86__
+#define __TCOMRDCOSTX86__
+
+#include "TComRdCost.h"
+
+#if VECTOR_CODING__X86_DISPATCH
+
+#include <immintrin.h>
+
+//! \ingroup TLibCommon
+//! \{
+
+static const Int PELS_PER_128 = Int( 16 / sizeof( Pel ) );   ///< samples in a 128-bit register
+
+// ====================================================================================================================
+// Vector helpers. All lanes are 32 bit unless the name says otherwise.
+// ====================================================================================================================
+
+static inline __m128i xLoad ( const Pel* p, __m128i ) { return _mm_loadu_si128( ( const __m128i* )p ); }
+static inline __m128i xAdd  ( __m128i a, __m128i b )  { return _mm_add_epi32( a, b ); }
+static inline __m128i xSub  ( __m128i a, __m128i b )  { return _mm_sub_epi32( a, b ); }
+static inline __m128i xAbs  ( __m128i a )             { return _mm_abs_epi32( a ); }
+
+/** |org - cur|, summed pairwise for 16-bit samples.
+ */
+static inline __m128i xAbsDiff( __m128i org, __m128i cur )
+{
+#if RExt__HIGH_BIT_DEPTH_SUPPORT
+  return _mm_abs_epi32( _mm_sub_epi32( org, cur ) );
+#else
+  return _mm_madd_epi16( _mm_abs_epi16( _mm_sub_epi16( org, cur ) ), _mm_set1_epi16( 1 ) );
+#endif
+}
+
+/** Add (org - cur)^2 to the 64-bit lanes of acc.
+ */
+static inline Void xAddSqrDiff( __m128i& acc, __m128i org, __m128i cur )
+{
+#if RExt__HIGH_BIT_DEPTH_SUPPORT
+  const __m128i diff    = _mm_sub_epi32( org, cur );
+  const __m128i diffOdd = _mm_srli_epi64( diff, 32 );
+  acc = _mm_add_epi64( acc, _mm_mul_epi32( diff, diff ) );
+  acc = _mm_add_epi64( acc, _mm_mul_epi32( diffOdd, diffOdd ) );
+#else
+  // a pair of squared 16-bit differences fits into 32 bits
+  const __m128i diff = _mm_sub_epi16( org, cur );
+  const __m128i sqr  = _mm_madd_epi16( diff, diff );
+  const __m128i zero = _mm_setzero_si128();
+  acc = _mm_add_epi64( acc, _mm_unpacklo_epi32( sqr, zero ) );
+  acc = _mm_add_epi64( acc, _mm_unpackhi_epi32( sqr, zero ) );
+#endif
+}
+
+/** Differences of a row of samples, widened to 32 bit: 4 samples.
+ */
+static inline __m128i xDiffRow4( const Pel* piOrg, const Pel* piCur )
+{
+#if RExt__HIGH_BIT_DEPTH_SUPPORT
+  return _mm_sub_epi32( _mm_loadu_si128( ( const __m128i* )piOrg ), _mm_loadu_si128( ( const __m128i* )piCur ) );
+#else
+  return _mm_cvtepi16_epi32( _mm_sub_epi16( _mm_loadl_epi64( ( const __m128i* )piOrg ), _mm_loadl_epi64( ( const __m128i* )piCur ) ) );
+#endif
+}
+
+static inline Void xTranspose4x4( __m128i& r0, __m128i& r1, __m128i& r2, __m128i& r3 )
+{
+  const __m128i t0 = _mm_unpacklo_epi32( r0, r1 );
+  const __m128i t1 = _mm_unpackhi_epi32( r0, r1 );
+  const __m128i t2 = _mm_unpacklo_epi32( r2, r3 );
+  const __m128i t3 = _mm_unpackhi_epi32( r2, r3 );
+  r0 = _mm_unpacklo_epi64( t0, t2 );
+  r1 = _mm_unpackhi_epi64( t0, t2 );
+  r2 = _mm_unpacklo_epi64( t1, t3 );
+  r3 = _mm_unpackhi_epi64( t1, t3 );
+}
+
+static inline UInt64 xSumU64( __m128i v )
+{
+  UInt64 sum[2];
+  _mm_storeu_si128( ( __m128i* )sum, v );
+  return sum[0] + sum[1];
+}
+
+/** Sum of the unsigned 32-bit lanes.
+ */
+static inline UInt64 xSumU32( __m128i v )
+{
+  const __m128i zero = _mm_setzero_si128();
+  v = _mm_add_epi64( _mm_unpacklo_epi32( v, zero ), _mm_unpackhi_epi32( v, zero ) );
+  return xSumU64( v );
+}
+
+#if X86_KERNELS_AVX2
+static inline __m256i xLoad ( const Pel* p, __m256i ) { return _mm256_loadu_si256( ( const __m256i* )p ); }
+static inline __m256i xAdd  ( __m256i a, __m256i b )  { return _mm256_add_epi32( a, b ); }
+static inline __m256i xSub  ( __m256i a, __m256i b )  { return _mm256_sub_epi32( a, b ); }
+static inline __m256i xAbs  ( __m256i a )             { return _mm256_abs_epi32( a ); }
+
+static inline __m256i xAbsDiff( __m256i org, __m256i cur )
+{
+#if RExt__HIGH_BIT_DEPTH_SUPPORT
+  return _mm256_abs_epi32( _mm256_sub_epi32( org, cur ) );
+#else
+  return _mm256_madd_epi16( _mm256_abs_epi16( _mm256_sub_epi16( org, cur ) ), _mm256_set1_epi16( 1 ) );
+#endif
+}
+
+static inline Void xAddSqrDiff( __m256i& acc, __m256i org, __m256i cur )
+{
+#if RExt__HIGH_BIT_DEPTH_SUPPORT
+  const __m256i diff    = _mm256_sub_epi32( org, cur );
+  const __m256i diffOdd = _mm256_srli_epi64( diff, 32 );
+  acc = _mm256_add_epi64( acc, _mm256_mul_epi32( diff, diff ) );
+  acc = _mm256_add_epi64( acc, _mm256_mul_epi32( diffOdd, diffOdd ) );
+#else
+  const __m256i diff = _mm256_sub_epi16( org, cur );
+  const __m256i sqr  = _mm256_madd_epi16( diff, diff );
+  const __m256i zero = _mm256_setzero_si256();
+  acc = _mm256_add_epi64( acc, _mm256_unpacklo_epi32( sqr, zero ) );
+  acc = _mm256_add_epi64( acc, _mm256_unpackhi_epi32( sqr, zero ) );
+#endif
+}
+
+/** Differences of a row of samples, widened to 32 bit: 8 samples.
+ */
+static inline __m256i xDiffRow8( const Pel* piOrg, const Pel* piCur )
+{
+#if RExt__HIGH_BIT_DEPTH_SUPPORT
+  return _mm256_sub_epi32( _mm256_loadu_si256( ( const __m256i* )piOrg ), _mm256_loadu_si256( ( const __m256i* )piCur ) );
+#else
+  return _mm256_cvtepi16_epi32( _mm_sub_epi16( _mm_loadu_si128( ( const __m128i* )piOrg ), _mm_loadu_si128( ( const __m128i* )piCur ) ) );
+#endif
+}
+
+/** Transpose the 4x4 blocks in each 128-bit lane.
+ */
+static inline Void xTranspose4x4( __m256i& r0, __m256i& r1, __m256i& r2, __m256i& r3 )
+{
+  const __m256i t0 = _mm256_unpacklo_epi32( r0, r1 );
+  const __m256i t1 = _mm256_unpackhi_epi32( r0, r1 );
+  const __m256i t2 = _mm256_unpacklo_epi32( r2, r3 );
+  const __m256i t3 = _mm256_unpackhi_epi32( r2, r3 );
+  r0 = _mm256_unpacklo_epi64( t0, t2 );
+  r1 = _mm256_unpackhi_epi64( t0, t2 );
+  r2 = _mm256_unpacklo_epi64( t1, t3 );
+  r3 = _mm256_unpackhi_epi64( t1, t3 );
+}
+
+static inline Void xTranspose8x8( __m256i* r )
+{
+  xTranspose4x4( r[0], r[1], r[2], r[3] );
+  xTranspose4x4( r[4], r[5], r[6], r[7] );
+  for( Int i = 0; i < 4; i++ )
+  {
+    const __m256i lo = _mm256_permute2x128_si256( r[i], r[i + 4], 0x20 );
+    const __m256i hi = _mm256_permute2x128_si256( r[i], r[i + 4], 0x31 );
+    r[i]     = lo;
+    r[i + 4] = hi;
+  }
+}
+
+static inline UInt64 xSumU32( __m256i v )
+{
+  return xSumU32( _mm256_castsi256_si128( v ) ) + xSumU32( _mm256_extracti128_si256( v, 1 ) );
+}
+
+static inline UInt64 xSumU64( __m256i v )
+{
+  return xSumU64( _mm_add_epi64( _mm256_castsi256_si128( v ), _mm256_extracti128_si256( v, 1 ) ) );
+}
+#endif // X86_KERNELS_AVX2
+
+#if X86_KERNELS_AVX512
+static inline __m512i xLoad ( const Pel* p, __m512i ) { return _mm512_loadu_si512( ( const void* )p ); }
+static inline __m512i xAdd  ( __m512i a, __m512i b )  { return _mm512_add_epi32( a, b ); }
+static inline __m512i xSub  ( __m512i a, __m512i b )  { return _mm512_sub_epi32( a, b ); }
+static inline __m512i xAbs  ( __m512i a )             { return _mm512_abs_epi32( a ); }
+
+static inline __m512i xAbsDiff( __m512i org, __m512i cur )
+{
+#if RExt__HIGH_BIT_DEPTH_SUPPORT
+  return _mm512_abs_epi32( _mm512_sub_epi32( org, cur ) );
+#else
+  return _mm512_madd_epi16( _mm512_abs_epi16( _mm512_sub_epi16( org, cur ) ), _mm512_set1_epi16( 1 ) );
+#endif
+}
+
+static inline Void xAddSqrDiff( __m512i& acc, __m512i org, __m512i cur )
+{
+#if RExt__HIGH_BIT_DEPTH_SUPPORT
+  const __m512i diff    = _mm512_sub_epi32( org, cur );
+  const __m512i diffOdd = _mm512_srli_epi64( diff, 32 );
+  acc = _mm512_add_epi64( acc, _mm512_mul_epi32( diff, diff ) );
+  acc = _mm512_add_epi64( acc, _mm512_mul_epi32( diffOdd, diffOdd ) );
+#else
+  const __m512i diff = _mm512_sub_epi16( org, cur );
+  const __m512i sqr  = _mm512_madd_epi16( diff, diff );
+  const __m512i zero = _mm512_setzero_si512();
+  acc = _mm512_add_epi64( acc, _mm512_unpacklo_epi32( sqr, zero ) );
+  acc = _mm512_add_epi64( acc, _mm512_unpackhi_epi32( sqr, zero ) );
+#endif
+}
+
+/** Differences of a row of samples, widened to 32 bit: 16 samples.
+ */
+static inline __m512i xDiffRow16( const Pel* piOrg, const Pel* piCur )
+{
+#if RExt__HIGH_BIT_DEPTH_SUPPORT
+  return _mm512_sub_epi32( _mm512_loadu_si512( ( const void* )piOrg ), _mm512_loadu_si512( ( const void* )piCur ) );
+#else
+  return _mm512_cvtepi16_epi32( _mm256_sub_epi16( _mm256_loadu_si256( ( const __m256i* )piOrg ), _mm256_loadu_si256( ( const __m256i* )piCur ) ) );
+#endif
+}
+
+static inline Void xTranspose4x4( __m512i& r0, __m512i& r1, __m512i& r2, __m512i& r3 )
+{
+  const __m512i t0 = _mm512_unpacklo_epi32( r0, r1 );
+  const __m512i t1 = _mm512_unpackhi_epi32( r0, r1 );
+  const __m512i t2 = _mm512_unpacklo_epi32( r2, r3 );
+  const __m512i t3 = _mm512_unpackhi_epi32( r2, r3 );
+  r0 = _mm512_unpacklo_epi64( t0, t2 );
+  r1 = _mm512_unpackhi_epi64( t0, t2 );
+  r2 = _mm512_unpacklo_epi64( t1, t3 );
+  r3 = _mm512_unpackhi_epi64( t1, t3 );
+}
+
+/** Transpose the 8x8 blocks in each 256-bit half.
+ */
+static inline Void xTranspose8x8( __m512i* r )
+{
+  const __m512i idxLo = _mm512_set_epi64( 13, 12, 5, 4, 9, 8, 1, 0 );
+  const __m512i idxHi = _mm512_set_epi64( 15, 14, 7, 6, 11, 10, 3, 2 );
+  xTranspose4x4( r[0], r[1], r[2], r[3] );
+  xTranspose4x4( r[4], r[5], r[6], r[7] );
+  for( Int i = 0; i < 4; i++ )
+  {
+    const __m512i lo = _mm512_permutex2var_epi64( r[i], idxLo, r[i + 4] );
+    const __m512i hi = _mm512_permutex2var_epi64( r[i], idxHi, r[i + 4] );
+    r[i]     = lo;
+    r[i + 4] = hi;
+  }
+}
+
+static inline UInt64 xSumU32( __m512i v )
+{
+  return xSumU32( _mm512_castsi512_si256( v ) ) + xSumU32( _mm512_extracti64x4_epi64( v, 1 ) );
+}
+
+static inline UInt64 xSumU64( __m512i v )
+{
+  return xSumU64( _mm256_add_epi64( _mm512_castsi512_si256( v ), _mm512_extracti64x4_epi64( v, 1 ) ) );
+}
+#endif // X86_KERNELS_AVX512
+
+/** Butterfly of two registers: (a, b) -> (a + b, a - b).
+ */
+template<typename T>
+static inline Void xButterfly( T& a, T& b )
+{
+  const T sum = xAdd( a, b );
+  b = xSub( a, b );
+  a = sum;
+}
+
+/** 1-D Hadamard transform across 4 registers, in place. The order of the outputs does not matter for the SATD.
+ */
+template<typename T>
+static inline Void xHadamard4( T* r )
+{
+  xButterfly( r[0], r[2] );  xButterfly( r[1], r[3] );
+  xButterfly( r[0], r[1] );  xButterfly( r[2], r[3] );
+}
+
+/** 1-D Hadamard transform across 8 registers, in place.
+ */
+template<typename T>
+static inline Void xHadamard8( T* r )
+{
+  xButterfly( r[0], r[4] );  xButterfly( r[1], r[5] );  xButterfly( r[2], r[6] );  xButterfly( r[3], r[7] );
+  xButterfly( r[0], r[2] );  xButterfly( r[1], r[3] );  xButterfly( r[4], r[6] );  xButterfly( r[5], r[7] );
+  xButterfly( r[0], r[1] );  xButterfly( r[2], r[3] );  xButterfly( r[4], r[5] );  xButterfly( r[6], r[7] );
+}
+
+/** Sum of absolute values of the 2-D Hadamard transform of the 4x4 blocks in the 128-bit lanes of r.
+ *  The lanes of the result hold the partial sums of their own block.
+ */
+template<typename T>
+static inline T xHADs4x4Lanes( T* r )
+{
+  xHadamard4( r );
+  xTranspose4x4( r[0], r[1], r[2], r[3] );
+  xHadamard4( r );
+  return xAdd( xAdd( xAbs( r[0] ), xAbs( r[1] ) ), xAdd( xAbs( r[2] ), xAbs( r[3] ) ) );
+}
+
+// ====================================================================================================================
+// Block loops
+// ====================================================================================================================
+
+/** SAD of a block, with the widest registers first. Columns are not restricted; the tail of a row is done in scalar code.
+ *  32-bit accumulators hold blocks of up to 64x64 samples of 16 bit.
+ */
+static inline Distortion xCalcSAD( const Pel* piOrg, Int iStrideOrg, const Pel* piCur, Int iStrideCur, Int iCols, Int iRows, Int iRowStep )
+{
+  __m128i vSum128 = _mm_setzero_si128();
+#if X86_KERNELS_AVX2
+  __m256i vSum256 = _mm256_setzero_si256();
+#endif
+#if X86_KERNELS_AVX512
+  __m512i vSum512 = _mm512_setzero_si512();
+#endif
+  Distortion uiSum = 0;
+
+  for( Int y = 0; y < iRows; y += iRowStep )
+  {
+    Int x = 0;
+#if X86_KERNELS_AVX512
+    for( ; x + 4 * PELS_PER_128 <= iCols; x += 4 * PELS_PER_128 )
+    {
+      vSum512 = _mm512_add_epi32( vSum512, xAbsDiff( xLoad( piOrg + x, vSum512 ), xLoad( piCur + x, vSum512 ) ) );
+    }
+#endif
+#if X86_KERNELS_AVX2
+    for( ; x + 2 * PELS_PER_128 <= iCols; x += 2 * PELS_PER_128 )
+    {
+      vSum256 = _mm256_add_epi32( vSum256, xAbsDiff( xLoad( piOrg + x, vSum256 ), xLoad( piCur + x, vSum256 ) ) );
+    }
+#endif
+    for( ; x + PELS_PER_128 <= iCols; x += PELS_PER_128 )
+    {
+      vSum128 = _mm_add_epi32( vSum128, xAbsDiff( xLoad( piOrg + x, vSum128 ), xLoad( piCur + x, vSum128 ) ) );
+    }
+    if( x + PELS_PER_128 / 2 <= iCols )
+    {
+      vSum128 = _mm_add_epi32( vSum128, xAbsDiff( _mm_loadl_epi64( ( const __m128i* )( piOrg + x ) ), _mm_loadl_epi64( ( const __m128i* )( piCur + x ) ) ) );
+      x += PELS_PER_128 / 2;
+    }
+    for( ; x < iCols; x++ )
+    {
+      uiSum += abs( piOrg[x] - piCur[x] );
+    }
+    piOrg += iStrideOrg;
+    piCur += iStrideCur;
+  }
+
+  uiSum += xSumU32( vSum128 );
+#if X86_KERNELS_AVX2
+  uiSum += xSumU32( vSum256 );
+#endif
+#if X86_KERNELS_AVX512
+  uiSum += xSumU32( vSum512 );
+#endif
+  return uiSum;
+}
+
+/** Sum of squared errors of a block, with the widest registers first and 64-bit accumulators.
+ */
+static inline Distortion xCalcSSE( const Pel* piOrg, Int iStrideOrg, const Pel* piCur, Int iStrideCur, Int iCols, Int iRows )
+{
+  __m128i vSum128 = _mm_setzero_si128();
+#if X86_KERNELS_AVX2
+  __m256i vSum256 = _mm256_setzero_si256();
+#endif
+#if X86_KERNELS_AVX512
+  __m512i vSum512 = _mm512_setzero_si512();
+#endif
+  Distortion uiSum = 0;
+
+  for( Int y = 0; y < iRows; y++ )
+  {
+    Int x = 0;
+#if X86_KERNELS_AVX512
+    for( ; x + 4 * PELS_PER_128 <= iCols; x += 4 * PELS_PER_128 )
+    {
+      xAddSqrDiff( vSum512, xLoad( piOrg + x, vSum512 ), xLoad( piCur + x, vSum512 ) );
+    }
+#endif
+#if X86_KERNELS_AVX2
+    for( ; x + 2 * PELS_PER_128 <= iCols; x += 2 * PELS_PER_128 )
+    {
+      xAddSqrDiff( vSum256, xLoad( piOrg + x, vSum256 ), xLoad( piCur + x, vSum256 ) );
+    }
+#endif
+    for( ; x + PELS_PER_128 <= iCols; x += PELS_PER_128 )
+    {
+      xAddSqrDiff( vSum128, xLoad( piOrg + x, vSum128 ), xLoad( piCur + x, vSum128 ) );
+    }
+    if( x + PELS_PER_128 / 2 <= iCols )
+    {
+      xAddSqrDiff( vSum128, _mm_loadl_epi64( ( const __m128i* )( piOrg + x ) ), _mm_loadl_epi64( ( const __m128i* )( piCur + x ) ) );
+      x += PELS_PER_128 / 2;
+    }
+    for( ; x < iCols; x++ )
+    {
+      const Intermediate_Int iTemp = piOrg[x] - piCur[x];
+      uiSum += Distortion( iTemp * iTemp );
+    }
+    piOrg += iStrideOrg;
+    piCur += iStrideCur;
+  }
+
+  uiSum += xSumU64( vSum128 );
+#if X86_KERNELS_AVX2
+  uiSum += xSumU64( vSum256 );
+#endif
+#if X86_KERNELS_AVX512
+  uiSum += xSumU64( vSum512 );
+#endif
+  return uiSum;
+}
+
+/** Hadamard SATD of one 8x8 block, rounded as in TComRdCost::xCalcHADs8x8.
+ */
+static inline Distortion xSATD8x8( const Pel* piOrg, Int iStrideOrg, const Pel* piCur, Int iStrideCur )
+{
+#if X86_KERNELS_AVX2
+  __m256i r[8];
+  for( Int i = 0; i < 8; i++, piOrg += iStrideOrg, piCur += iStrideCur )
+  {
+    r[i] = xDiffRow8( piOrg, piCur );
+  }
+  xHadamard8( r );
+  xTranspose8x8( r );
+  xHadamard8( r );
+  __m256i vSum = xAbs( r[0] );
+  for( Int i = 1; i < 8; i++ )
+  {
+    vSum = xAdd( vSum, xAbs( r[i] ) );
+  }
+  return ( xSumU32( vSum ) + 2 ) >> 2;
+#else
+  // left and right halves of the rows
+  __m128i rl[8], rr[8];
+  for( Int i = 0; i < 8; i++, piOrg += iStrideOrg, piCur += iStrideCur )
+  {
+    rl[i] = xDiffRow4( piOrg,     piCur     );
+    rr[i] = xDiffRow4( piOrg + 4, piCur + 4 );
+  }
+  xHadamard8( rl );
+  xHadamard8( rr );
+  xTranspose4x4( rl[0], rl[1], rl[2], rl[3] );
+  xTranspose4x4( rl[4], rl[5], rl[6], rl[7] );
+  xTranspose4x4( rr[0], rr[1], rr[2], rr[3] );
+  xTranspose4x4( rr[4], rr[5], rr[6], rr[7] );
+  // the transposed rows 0-3 are (rl[0..3], rl[4..7]) and rows 4-7 are (rr[0..3], rr[4..7])
+  for( Int i = 0; i < 4; i++ )
+  {
+    const __m128i t = rl[i + 4];
+    rl[i + 4] = rr[i];
+    rr[i]     = t;
+  }
+  xHadamard8( rl );
+  xHadamard8( rr );
+  __m128i vSum = _mm_setzero_si128();
+  for( Int i = 0; i < 8; i++ )
+  {
+    vSum = xAdd( vSum, xAdd( xAbs( rl[i] ), xAbs( rr[i] ) ) );
+  }
+  return ( xSumU32( vSum ) + 2 ) >> 2;
+#endif
+}
+
+#if X86_KERNELS_AVX512
+/** Hadamard SATD of two horizontally adjacent 8x8 blocks, each rounded as in TComRdCost::xCalcHADs8x8.
+ */
+static inline Distortion xSATD16x8( const Pel* piOrg, Int iStrideOrg, const Pel* piCur, Int iStrideCur )
+{
+  __m512i r[8];
+  for( Int i = 0; i < 8; i++, piOrg += iStrideOrg, piCur += iStrideCur )
+  {
+    r[i] = xDiffRow16( piOrg, piCur );
+  }
+  xHadamard8( r );
+  xTranspose8x8( r );
+  xHadamard8( r );
+  __m512i vSum = xAbs( r[0] );
+  for( Int i = 1; i < 8; i++ )
+  {
+    vSum = xAdd( vSum, xAbs( r[i] ) );
+  }
+  return ( ( xSumU32( _mm512_castsi512_si256( vSum ) ) + 2 ) >> 2 ) + ( ( xSumU32( _mm512_extracti64x4_epi64( vSum, 1 ) ) + 2 ) >> 2 );
+}
+#endif
+
+/** Hadamard SATD of the 4x4 blocks of a 4-row strip, each rounded as in TComRdCost::xCalcHADs4x4.
+ */
+static inline Distortion xSATD4x4Row( const Pel* piOrg, Int iStrideOrg, const Pel* piCur, Int iStrideCur, Int iCols )
+{
+  Distortion uiSum = 0;
+  Int x = 0;
+#if X86_KERNELS_AVX512
+  for( ; x + 16 <= iCols; x += 16 )
+  {
+    __m512i r[4];
+    for( Int i = 0; i < 4; i++ )
+    {
+      r[i] = xDiffRow16( piOrg + x + i * iStrideOrg, piCur + x + i * iStrideCur );
+    }
+    const __m512i vSum = xHADs4x4Lanes( r );
+    for( Int i = 0; i < 2; i++ )
+    {
+      const __m256i vHalf = i ? _mm512_extracti64x4_epi64( vSum, 1 ) : _mm512_castsi512_si256( vSum );
+      uiSum += ( xSumU32( _mm256_castsi256_si128( vHalf ) ) + 1 ) >> 1;
+      uiSum += ( xSumU32( _mm256_extracti128_si256( vHalf, 1 ) ) + 1 ) >> 1;
+    }
+  }
+#endif
+#if X86_KERNELS_AVX2
+  for( ; x + 8 <= iCols; x += 8 )
+  {
+    __m256i r[4];
+    for( Int i = 0; i < 4; i++ )
+    {
+      r[i] = xDiffRow8( piOrg + x + i * iStrideOrg, piCur + x + i * iStrideCur );
+    }
+    const __m256i vSum = xHADs4x4Lanes( r );
+    uiSum += ( xSumU32( _mm256_castsi256_si128( vSum ) ) + 1 ) >> 1;
+    uiSum += ( xSumU32( _mm256_extracti128_si256( vSum, 1 ) ) + 1 ) >> 1;
+  }
+#endif
+  for( ; x + 4 <= iCols; x += 4 )
+  {
+    __m128i r[4];
+    for( Int i = 0; i < 4; i++ )
+    {
+      r[i] = xDiffRow4( piOrg + x + i * iStrideOrg, piCur + x + i * iStrideCur );
+    }
+    uiSum += ( xSumU32( xHADs4x4Lanes( r ) ) + 1 ) >> 1;
+  }
+  return uiSum;
+}
+
+// ====================================================================================================================
+// Distortion functions
+// ====================================================================================================================
+
+template<X86_VEXT vext>
+Distortion TComRdCost::xGetSSEX86( DistParam* pcDtParam )
+{
+  if ( pcDtParam->bApplyWeight )
+  {
+    return TComRdCostWeightPrediction::xGetSSEw( pcDtParam );
+  }
+  return xCalcSSE( pcDtParam->pOrg, pcDtParam->iStrideOrg, pcDtParam->pCur, pcDtParam->iStrideCur, pcDtParam->iCols, pcDtParam->iRows );
+}
+
+template<X86_VEXT vext, Int iWidth>
+Distortion TComRdCost::xGetSSEBlockX86( DistParam* pcDtParam )
+{
+  if ( pcDtParam->bApplyWeight )
+  {
+    assert( pcDtParam->iCols == iWidth );
+    return TComRdCostWeightPrediction::xGetSSEw( pcDtParam );
+  }
+  return xCalcSSE( pcDtParam->pOrg, pcDtParam->iStrideOrg, pcDtParam->pCur, pcDtParam->iStrideCur, iWidth, pcDtParam->iRows );
+}
+
+/** General size SAD. Like TComRdCost::xGetSAD it stops after the row at which the distortion exceeds the early exit limit.
+ */
+template<X86_VEXT vext>
+Distortion TComRdCost::xGetSADX86( DistParam* pcDtParam )
+{
+  if ( pcDtParam->bApplyWeight )
+  {
+    return TComRdCostWeightPrediction::xGetSADw( pcDtParam );
+  }
+  const Pel* piOrg           = pcDtParam->pOrg;
+  const Pel* piCur           = pcDtParam->pCur;
+  const Int  iCols           = pcDtParam->iCols;
+  const Int  iStrideCur      = pcDtParam->iStrideCur;
+  const Int  iStrideOrg      = pcDtParam->iStrideOrg;
+  const UInt distortionShift = DISTORTION_PRECISION_ADJUSTMENT(pcDtParam->bitDepth - 8);
+
+  Distortion uiSum = 0;
+
+  for( Int iRows = pcDtParam->iRows; iRows != 0; iRows-- )
+  {
+    uiSum += xCalcSAD( piOrg, iStrideOrg, piCur, iStrideCur, iCols, 1, 1 );
+    if ( pcDtParam->m_maximumDistortionForEarlyExit < ( uiSum >> distortionShift ) )
+    {
+      return ( uiSum >> distortionShift );
+    }
+    piOrg += iStrideOrg;
+    piCur += iStrideCur;
+  }
+
+  return ( uiSum >> distortionShift );
+}
+
+template<X86_VEXT vext, Int iWidth>
+Distortion TComRdCost::xGetSADBlockX86( DistParam* pcDtParam )
+{
+  if ( pcDtParam->bApplyWeight )
+  {
+    return TComRdCostWeightPrediction::xGetSADw( pcDtParam );
+  }
+  const Int iSubShift = pcDtParam->iSubShift;
+  const Int iSubStep  = ( 1 << iSubShift );
+
+  Distortion uiSum = xCalcSAD( pcDtParam->pOrg, pcDtParam->iStrideOrg*iSubStep, pcDtParam->pCur, pcDtParam->iStrideCur*iSubStep, iWidth, pcDtParam->iRows, iSubStep );
+
+  uiSum <<= iSubShift;
+  return ( uiSum >> DISTORTION_PRECISION_ADJUSTMENT(pcDtParam->bitDepth-8) );
+}
+
+/** SAD of 16N columns. Like TComRdCost::xGetSAD16N it does not apply weighted prediction.
+ */
+template<X86_VEXT vext>
+Distortion TComRdCost::xGetSAD16NX86( DistParam* pcDtParam )
+{
+  const Int iSubShift = pcDtParam->iSubShift;
+  const Int iSubStep  = ( 1 << iSubShift );
+
+  Distortion uiSum = xCalcSAD( pcDtParam->pOrg, pcDtParam->iStrideOrg*iSubStep, pcDtParam->pCur, pcDtParam->iStrideCur*iSubStep, pcDtParam->iCols, pcDtParam->iRows, iSubStep );
+
+  uiSum <<= iSubShift;
+  return ( uiSum >> DISTORTION_PRECISION_ADJUSTMENT(pcDtParam->bitDepth-8) );
+}
+
+/** Hadamard SATD in 8x8 blocks when possible, else in 4x4 blocks. Sizes that need 2x2 blocks use the scalar function.
+ */
+template<X86_VEXT vext>
+Distortion TComRdCost::xGetHADsX86( DistParam* pcDtParam )
+{
+  if ( pcDtParam->bApplyWeight )
+  {
+    return TComRdCostWeightPrediction::xGetHADsw( pcDtParam );
+  }
+  const Pel* piOrg      = pcDtParam->pOrg;
+  const Pel* piCur      = pcDtParam->pCur;
+  const Int  iRows      = pcDtParam->iRows;
+  const Int  iCols      = pcDtParam->iCols;
+  const Int  iStrideCur = pcDtParam->iStrideCur;
+  const Int  iStrideOrg = pcDtParam->iStrideOrg;
+
+  assert( pcDtParam->iStep == 1 );
+
+  Distortion uiSum = 0;
+
+  if( ( iRows % 8 == 0) && (iCols % 8 == 0) )
+  {
+    for ( Int y = 0; y < iRows; y += 8 )
+    {
+      Int x = 0;
+#if X86_KERNELS_AVX512
+      for ( ; x + 16 <= iCols; x += 16 )
+      {
+        uiSum += xSATD16x8( &piOrg[x], iStrideOrg, &piCur[x], iStrideCur );
+      }
+#endif
+      for ( ; x < iCols; x += 8 )
+      {
+        uiSum += xSATD8x8( &piOrg[x], iStrideOrg, &piCur[x], iStrideCur );
+      }
+      piOrg += iStrideOrg<<3;
+      piCur += iStrideCur<<3;
+    }
+  }
+  else if( ( iRows % 4 == 0) && (iCols % 4 == 0) )
+  {
+    for ( Int y = 0; y < iRows; y += 4 )
+    {
+      uiSum += xSATD4x4Row( piOrg, iStrideOrg, piCur, iStrideCur, iCols );
+      piOrg += iStrideOrg<<2;
+      piCur += iStrideCur<<2;
+    }
+  }
+  else
+  {
+    return xGetHADs( pcDtParam );
+  }
+
+  return ( uiSum >> DISTORTION_PRECISION_ADJUSTMENT(pcDtParam->bitDepth-8) );
+}
+
+// ====================================================================================================================
+// Initialisation
+// ====================================================================================================================
+
+template<X86_VEXT vext>
+Void TComRdCost::xInitRdCostX86()
+{
+#if FULL_NBIT
+  // the scalar SSE functions shift every squared error when FULL_NBIT is off
+  m_afpDistortFunc[DF_SSE    ] = TComRdCost::xGetSSEX86<vext>;
+  m_afpDistortFunc[DF_SSE4   ] = TComRdCost::xGetSSEBlockX86<vext, 4>;
+  m_afpDistortFunc[DF_SSE8   ] = TComRdCost::xGetSSEBlockX86<vext, 8>;
+  m_afpDistortFunc[DF_SSE16  ] = TComRdCost::xGetSSEBlockX86<vext, 16>;
+  m_afpDistortFunc[DF_SSE32  ] = TComRdCost::xGetSSEBlockX86<vext, 32>;
+  m_afpDistortFunc[DF_SSE64  ] = TComRdCost::xGetSSEBlockX86<vext, 64>;
+  m_afpDistortFunc[DF_SSE16N ] = TComRdCost::xGetSSEX86<vext>;
+#endif
+
+  m_afpDistortFunc[DF_SAD    ] = TComRdCost::xGetSADX86<vext>;
+  m_afpDistortFunc[DF_SAD4   ] = TComRdCost::xGetSADBlockX86<vext, 4>;
+  m_afpDistortFunc[DF_SAD8   ] = TComRdCost::xGetSADBlockX86<vext, 8>;
+  m_afpDistortFunc[DF_SAD16  ] = TComRdCost::xGetSADBlockX86<vext, 16>;
+  m_afpDistortFunc[DF_SAD32  ] = TComRdCost::xGetSADBlockX86<vext, 32>;
+  m_afpDistortFunc[DF_SAD64  ] = TComRdCost::xGetSADBlockX86<vext, 64>;
+  m_afpDistortFunc[DF_SAD16N ] = TComRdCost::xGetSAD16NX86<vext>;
+
+  m_afpDistortFunc[DF_SADS   ] = TComRdCost::xGetSADX86<vext>;
+  m_afpDistortFunc[DF_SADS4  ] = TComRdCost::xGetSADBlockX86<vext, 4>;
+  m_afpDistortFunc[DF_SADS8  ] = TComRdCost::xGetSADBlockX86<vext, 8>;
+  m_afpDistortFunc[DF_SADS16 ] = TComRdCost::xGetSADBlockX86<vext, 16>;
+  m_afpDistortFunc[DF_SADS32 ] = TComRdCost::xGetSADBlockX86<vext, 32>;
+  m_afpDistortFunc[DF_SADS64 ] = TComRdCost::xGetSADBlockX86<vext, 64>;
+  m_afpDistortFunc[DF_SADS16N] = TComRdCost::xGetSAD16NX86<vext>;
+
+  m_afpDistortFunc[DF_SAD12  ] = TComRdCost::xGetSADBlockX86<vext, 12>;
+  m_afpDistortFunc[DF_SAD24  ] = TComRdCost::xGetSADBlockX86<vext, 24>;
+  m_afpDistortFunc[DF_SAD48  ] = TComRdCost::xGetSADBlockX86<vext, 48>;
+
+  m_afpDistortFunc[DF_SADS12 ] = TComRdCost::xGetSADBlockX86<vext, 12>;
+  m_afpDistortFunc[DF_SADS24 ] = TComRdCost::xGetSADBlockX86<vext, 24>;
+  m_afpDistortFunc[DF_SADS48 ] = TComRdCost::xGetSADBlockX86<vext, 48>;
+
+  m_afpDistortFunc[DF_HADS   ] = TComRdCost::xGetHADsX86<vext>;
+  m_afpDistortFunc[DF_HADS4  ] = TComRdCost::xGetHADsX86<vext>;
+  m_afpDistortFunc[DF_HADS8  ] = TComRdCost::xGetHADsX86<vext>;
+  m_afpDistortFunc[DF_HADS16 ] = TComRdCost::xGetHADsX86<vext>;
+  m_afpDistortFunc[DF_HADS32 ] = TComRdCost::xGetHADsX86<vext>;
+  m_afpDistortFunc[DF_HADS64 ] = TComRdCost::xGetHADsX86<vext>;
+  m_afpDistortFunc[DF_HADS16N] = TComRdCost::xGetHADsX86<vext>;
+}
+
+//! \}
+
+#endif // VECTOR_CODING__X86_DISPATCH
+
+#endif // __TCOMRDCOSTX86__
@@ -0,0 +1,203 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2022, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TComTemporalFilterKernelsX86.h
+    \brief    SSE4.1 kernels of the GOP-based temporal filter
+    \details  Included by x86/sse41/TComTemporalFilterKernels_sse41.cpp, which is compiled with the SSE4.1 target flags.
+              The wider extensions use the SSE4.1 kernels. There are no kernels for (high bit depth) 32-bit Pel.
+*/
+
+#ifndef __TCOMTEMPORALFILTERKERNELSX86__
+#define __TCOMTEMPORALFILTERKERNELSX86__
+
+#include "TComTemporalFilterKernels.h"
+
+#if VECTOR_CODING__X86_DISPATCH && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
+
+#include <smmintrin.h>
+
+//! \ingroup TLibCommon
+//! \{
+
+static inline Int xSumEpi32( __m128i sum )
+{
+  sum = _mm_add_epi32( sum, _mm_shuffle_epi32( sum, 0x4e ) );
+  sum = _mm_add_epi32( sum, _mm_shuffle_epi32( sum, 0xb1 ) );
+  return _mm_cvtsi128_si32( sum );
+}
+
+// ====================================================================================================================
+// Kernels
+// ====================================================================================================================
+
+/** Squared error of a block at a full-sample offset, 8 samples at a time.
+ */
+template<X86_VEXT vext>
+Int TComTemporalFilterKernels::xMotionErrorFullPelX86( const Pel* origRow, const Int origStride, const Pel* bufferRow, const Int buffStride, const Int bs, const Int besterror )
+{
+  Int error = 0;
+  for (Int y1 = 0; y1 < bs; y1++, origRow += origStride, bufferRow += buffStride)
+  {
+    __m128i sum = _mm_setzero_si128();
+    for (Int x1 = 0; x1 < bs; x1 += 8)
+    {
+      const __m128i diff = _mm_sub_epi16(_mm_loadu_si128((const __m128i*)(origRow + x1)), _mm_loadu_si128((const __m128i*)(bufferRow + x1)));
+      sum = _mm_add_epi32(sum, _mm_madd_epi16(diff, diff));
+    }
+    error += xSumEpi32(sum);
+    if (error > besterror)
+    {
+      return error;
+    }
+  }
+  return error;
+}
+
+/** Squared error of a block at a fractional-sample offset: horizontal pass with 16-bit tap pairs, vertical pass with
+ * 32-bit products.
+ */
+template<X86_VEXT vext>
+Int TComTemporalFilterKernels::xMotionErrorFracPelX86( const Pel* origRow, const Int origStride, const Pel* bufferRow, const Int buffStride, const Int bs,
+                                                       const Int* xFilter, const Int* yFilter, const Int maxSampleValue, const Int besterror )
+{
+  Int tempArray[64 + 8][64];
+
+  const __m128i xCoeff12 = _mm_setr_epi16(xFilter[1], xFilter[2], xFilter[1], xFilter[2], xFilter[1], xFilter[2], xFilter[1], xFilter[2]);
+  const __m128i xCoeff34 = _mm_setr_epi16(xFilter[3], xFilter[4], xFilter[3], xFilter[4], xFilter[3], xFilter[4], xFilter[3], xFilter[4]);
+  const __m128i xCoeff56 = _mm_setr_epi16(xFilter[5], xFilter[6], xFilter[5], xFilter[6], xFilter[5], xFilter[6], xFilter[5], xFilter[6]);
+  for (Int y1 = 1; y1 < bs + 7; y1++)
+  {
+    const Pel *rowStart = bufferRow + y1 * buffStride + 1;
+    for (Int x1 = 0; x1 < bs; x1 += 8)
+    {
+      const __m128i src1 = _mm_loadu_si128((const __m128i*)(rowStart + x1));
+      const __m128i src2 = _mm_loadu_si128((const __m128i*)(rowStart + x1 + 1));
+      const __m128i src3 = _mm_loadu_si128((const __m128i*)(rowStart + x1 + 2));
+      const __m128i src4 = _mm_loadu_si128((const __m128i*)(rowStart + x1 + 3));
+      const __m128i src5 = _mm_loadu_si128((const __m128i*)(rowStart + x1 + 4));
+      const __m128i src6 = _mm_loadu_si128((const __m128i*)(rowStart + x1 + 5));
+      __m128i sumLo = _mm_madd_epi16(_mm_unpacklo_epi16(src1, src2), xCoeff12);
+      __m128i sumHi = _mm_madd_epi16(_mm_unpackhi_epi16(src1, src2), xCoeff12);
+      sumLo = _mm_add_epi32(sumLo, _mm_madd_epi16(_mm_unpacklo_epi16(src3, src4), xCoeff34));
+      sumHi = _mm_add_epi32(sumHi, _mm_madd_epi16(_mm_unpackhi_epi16(src3, src4), xCoeff34));
+      sumLo = _mm_add_epi32(sumLo, _mm_madd_epi16(_mm_unpacklo_epi16(src5, src6), xCoeff56));
+      sumHi = _mm_add_epi32(sumHi, _mm_madd_epi16(_mm_unpackhi_epi16(src5, src6), xCoeff56));
+      _mm_storeu_si128((__m128i*)&tempArray[y1][x1], sumLo);
+      _mm_storeu_si128((__m128i*)&tempArray[y1][x1 + 4], sumHi);
+    }
+  }
+
+  const __m128i yCoeff1 = _mm_set1_epi32(yFilter[1]);
+  const __m128i yCoeff2 = _mm_set1_epi32(yFilter[2]);
+  const __m128i yCoeff3 = _mm_set1_epi32(yFilter[3]);
+  const __m128i yCoeff4 = _mm_set1_epi32(yFilter[4]);
+  const __m128i yCoeff5 = _mm_set1_epi32(yFilter[5]);
+  const __m128i yCoeff6 = _mm_set1_epi32(yFilter[6]);
+  const __m128i offset  = _mm_set1_epi32(1 << 11);
+  const __m128i minVal  = _mm_setzero_si128();
+  const __m128i maxVal  = _mm_set1_epi32(maxSampleValue);
+  Int error = 0;
+  for (Int y1 = 0; y1 < bs; y1++, origRow += origStride)
+  {
+    __m128i errorSum = _mm_setzero_si128();
+    for (Int x1 = 0; x1 < bs; x1 += 4)
+    {
+      __m128i sum = _mm_mullo_epi32(_mm_loadu_si128((const __m128i*)&tempArray[y1 + 1][x1]), yCoeff1);
+      sum = _mm_add_epi32(sum, _mm_mullo_epi32(_mm_loadu_si128((const __m128i*)&tempArray[y1 + 2][x1]), yCoeff2));
+      sum = _mm_add_epi32(sum, _mm_mullo_epi32(_mm_loadu_si128((const __m128i*)&tempArray[y1 + 3][x1]), yCoeff3));
+      sum = _mm_add_epi32(sum, _mm_mullo_epi32(_mm_loadu_si128((const __m128i*)&tempArray[y1 + 4][x1]), yCoeff4));
+      sum = _mm_add_epi32(sum, _mm_mullo_epi32(_mm_loadu_si128((const __m128i*)&tempArray[y1 + 5][x1]), yCoeff5));
+      sum = _mm_add_epi32(sum, _mm_mullo_epi32(_mm_loadu_si128((const __m128i*)&tempArray[y1 + 6][x1]), yCoeff6));
+      sum = _mm_srai_epi32(_mm_add_epi32(sum, offset), 12);
+      sum = _mm_min_epi32(_mm_max_epi32(sum, minVal), maxVal);
+
+      const __m128i diff = _mm_sub_epi32(sum, _mm_cvtepi16_epi32(_mm_loadl_epi64((const __m128i*)(origRow + x1))));
+      errorSum = _mm_add_epi32(errorSum, _mm_mullo_epi32(diff, diff));
+    }
+    error += xSumEpi32(errorSum);
+    if (error > besterror)
+    {
+      return error;
+    }
+  }
+  return error;
+}
+
+/** Squared differences between a block and its motion compensated reference, and squared differences of horizontally
+ * and vertically adjacent differences, for blocks 4 or 8 samples wide.
+ */
+template<X86_VEXT vext>
+Void TComTemporalFilterKernels::xBlockNoiseStatisticsX86( const Pel* srcPel, const Int srcStride, const Pel* refPel, const Int refStride, const Int blkSizeX, const Int blkSizeY,
+                                                          Double& variance, Double& diffsum )
+{
+  const __m128i mask = blkSizeX == 8 ? _mm_setr_epi16(-1, -1, -1, -1, -1, -1, -1, 0) : _mm_setr_epi16(-1, -1, -1, 0, 0, 0, 0, 0);
+  __m128i varianceSum = _mm_setzero_si128();
+  __m128i diffSum     = _mm_setzero_si128();
+  __m128i diffAbove   = _mm_setzero_si128();
+  for (Int y1 = 0; y1 < blkSizeY; y1++, srcPel += srcStride, refPel += refStride)
+  {
+    const __m128i src = blkSizeX == 8 ? _mm_loadu_si128((const __m128i*)srcPel) : _mm_loadl_epi64((const __m128i*)srcPel);
+    const __m128i ref = blkSizeX == 8 ? _mm_loadu_si128((const __m128i*)refPel) : _mm_loadl_epi64((const __m128i*)refPel);
+    const __m128i diff = _mm_sub_epi16(src, ref);
+    varianceSum = _mm_add_epi32(varianceSum, _mm_madd_epi16(diff, diff));
+
+    const __m128i diffRight = _mm_and_si128(_mm_sub_epi16(_mm_srli_si128(diff, 2), diff), mask);
+    diffSum = _mm_add_epi32(diffSum, _mm_madd_epi16(diffRight, diffRight));
+    if (y1 > 0)
+    {
+      const __m128i diffDown = _mm_sub_epi16(diff, diffAbove);
+      diffSum = _mm_add_epi32(diffSum, _mm_madd_epi16(diffDown, diffDown));
+    }
+    diffAbove = diff;
+  }
+  variance = xSumEpi32(varianceSum);
+  diffsum  = xSumEpi32(diffSum);
+}
+
+// ====================================================================================================================
+// Initialisation
+// ====================================================================================================================
+
+template<X86_VEXT vext>
+Void TComTemporalFilterKernels::xInitTemporalFilterKernelsX86()
+{
+  m_motionErrorFullPel   = TComTemporalFilterKernels::xMotionErrorFullPelX86<vext>;
+  m_motionErrorFracPel   = TComTemporalFilterKernels::xMotionErrorFracPelX86<vext>;
+  m_blockNoiseStatistics = TComTemporalFilterKernels::xBlockNoiseStatisticsX86<vext>;
+}
+
+//! \}
+
+#endif // VECTOR_CODING__X86_DISPATCH && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
+
+#endif // __TCOMTEMPORALFILTERKERNELSX86__
@@ -0,0 +1,662 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2022, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TComTrQuantX86.h
+    \brief    SSE4.1, AVX2 and AVX-512 kernels of TComTrQuant
+    \details  Included by x86/<extension>/TComTrQuant_<extension>.cpp, which are compiled with the matching target flags.
+              The kernels give exactly the same coefficients and residuals as the scalar functions. Each 1D transform
+              is computed as a product with the transform matrix, which equals the partial butterflies in 32-bit
+              arithmetic. Intermediate values that fit in 16 bits, as they always do when maxLog2TrDynamicRange is 15,
+              are multiplied in pairs by pmaddwd; wider ones (extended precision) by pmulld.
+              The kernels are only built for 16-bit Pel: with high bit depth support, TCoeff is 64 bits wide and the
+              scalar functions are used.
+*/
+
+#ifndef __TCOMTRQUANTX86__
+#define __TCOMTRQUANTX86__
+
+#include "TComTrQuant.h"
+#include "TComRom.h"
+
+#if VECTOR_CODING__X86_DISPATCH
+
+#include <immintrin.h>
+#include <cstring>
+#include <limits>
+
+//! \ingroup TLibCommon
+//! \{
+
+#if !RExt__HIGH_BIT_DEPTH_SUPPORT
+
+// ====================================================================================================================
+// Registers of 32-bit lanes
+// ====================================================================================================================
+
+struct TrVec128
+{
+  typedef __m128i T;
+  static const Int LANES = 4;
+  static inline T    load      ( const Int* p )       { return _mm_loadu_si128( ( const __m128i* )p ); }
+  static inline Void store     ( Int* p, T v )        { _mm_storeu_si128( ( __m128i* )p, v ); }
+  static inline Void storeShort( Short* p, T v )      { _mm_storel_epi64( ( __m128i* )p, _mm_packs_epi32( v, v ) ); } ///< saturating
+  static inline T    set1      ( Int v )              { return _mm_set1_epi32( v ); }
+  static inline T    set1x64   ( Int64 v )            { return _mm_set1_epi64x( v ); }
+  static inline T    add       ( T a, T b )           { return _mm_add_epi32( a, b ); }
+  static inline T    sub       ( T a, T b )           { return _mm_sub_epi32( a, b ); }
+  static inline T    mul       ( T a, T b )           { return _mm_mullo_epi32( a, b ); }
+  static inline T    madd      ( T a, T b )           { return _mm_madd_epi16( a, b ); }
+  static inline T    sra       ( T a, __m128i cnt )   { return _mm_sra_epi32( a, cnt ); }
+  static inline T    sll       ( T a, __m128i cnt )   { return _mm_sll_epi32( a, cnt ); }
+  static inline T    min       ( T a, T b )           { return _mm_min_epi32( a, b ); }
+  static inline T    max       ( T a, T b )           { return _mm_max_epi32( a, b ); }
+  static inline T    abs       ( T a )                { return _mm_abs_epi32( a ); }
+  static inline T    sign      ( T a, T b )           { return _mm_sign_epi32( a, b ); }              ///< a negated where b < 0, zero where b == 0
+  static inline T    pair      ( T lo, T hi )         { return _mm_blend_epi16( lo, _mm_slli_epi32( hi, 16 ), 0xAA ); } ///< low 16 bits of lo and of hi, in the low and the high half of each lane
+  static inline Bool anyGreater( T a, T b )           { return _mm_movemask_epi8( _mm_cmpgt_epi32( a, b ) ) != 0; }
+  static inline Bool anyNonZero( T a )                { return !_mm_testz_si128( a, a ); }
+  static inline Int  sum       ( T a )                { a = _mm_add_epi32( a, _mm_shuffle_epi32( a, 0x4E ) ); return _mm_cvtsi128_si32( _mm_add_epi32( a, _mm_shuffle_epi32( a, 0xB1 ) ) ); }
+  // 64-bit lanes
+  static inline T    mulEven   ( T a, T b )           { return _mm_mul_epu32( a, b ); }                ///< unsigned products of the even 32-bit lanes
+  static inline T    odd       ( T a )                { return _mm_srli_epi64( a, 32 ); }              ///< odd 32-bit lanes moved to the even ones
+  static inline T    add64     ( T a, T b )           { return _mm_add_epi64( a, b ); }
+  static inline T    sub64     ( T a, T b )           { return _mm_sub_epi64( a, b ); }
+  static inline T    srl64     ( T a, __m128i cnt )   { return _mm_srl_epi64( a, cnt ); }
+  static inline T    sra64     ( T a, __m128i cnt )   { const T s = _mm_shuffle_epi32( _mm_srai_epi32( a, 31 ), 0xF5 ); return _mm_xor_si128( _mm_srl_epi64( _mm_xor_si128( a, s ), cnt ), s ); }
+  static inline T    sext64    ( T a )                { const T m = _mm_set1_epi64x( 0x80000000 ); return _mm_sub_epi64( _mm_xor_si128( _mm_and_si128( a, _mm_set1_epi64x( 0xFFFFFFFF ) ), m ), m ); } ///< sign extension of the even 32-bit lanes
+  static inline T    combine   ( T even, T odd )      { return _mm_blend_epi16( even, _mm_slli_epi64( odd, 32 ), 0xCC ); } ///< low 32 bits of each 64-bit lane
+};
+
+#if X86_KERNELS_AVX2
+struct TrVec256
+{
+  typedef __m256i T;
+  static const Int LANES = 8;
+  static inline T    load      ( const Int* p )       { return _mm256_loadu_si256( ( const __m256i* )p ); }
+  static inline Void store     ( Int* p, T v )        { _mm256_storeu_si256( ( __m256i* )p, v ); }
+  static inline Void storeShort( Short* p, T v )      { _mm_storeu_si128( ( __m128i* )p, _mm256_castsi256_si128( _mm256_permute4x64_epi64( _mm256_packs_epi32( v, v ), 0x08 ) ) ); }
+  static inline T    set1      ( Int v )              { return _mm256_set1_epi32( v ); }
+  static inline T    set1x64   ( Int64 v )            { return _mm256_set1_epi64x( v ); }
+  static inline T    add       ( T a, T b )           { return _mm256_add_epi32( a, b ); }
+  static inline T    sub       ( T a, T b )           { return _mm256_sub_epi32( a, b ); }
+  static inline T    mul       ( T a, T b )           { return _mm256_mullo_epi32( a, b ); }
+  static inline T    madd      ( T a, T b )           { return _mm256_madd_epi16( a, b ); }
+  static inline T    sra       ( T a, __m128i cnt )   { return _mm256_sra_epi32( a, cnt ); }
+  static inline T    sll       ( T a, __m128i cnt )   { return _mm256_sll_epi32( a, cnt ); }
+  static inline T    min       ( T a, T b )           { return _mm256_min_epi32( a, b ); }
+  static inline T    max       ( T a, T b )           { return _mm256_max_epi32( a, b ); }
+  static inline T    abs       ( T a )                { return _mm256_abs_epi32( a ); }
+  static inline T    sign      ( T a, T b )           { return _mm256_sign_epi32( a, b ); }
+  static inline T    pair      ( T lo, T hi )         { return _mm256_blend_epi16( lo, _mm256_slli_epi32( hi, 16 ), 0xAA ); }
+  static inline Bool anyGreater( T a, T b )           { return _mm256_movemask_epi8( _mm256_cmpgt_epi32( a, b ) ) != 0; }
+  static inline Bool anyNonZero( T a )                { return !_mm256_testz_si256( a, a ); }
+  static inline Int  sum       ( T a )                { return TrVec128::sum( _mm_add_epi32( _mm256_castsi256_si128( a ), _mm256_extracti128_si256( a, 1 ) ) ); }
+  static inline T    mulEven   ( T a, T b )           { return _mm256_mul_epu32( a, b ); }
+  static inline T    odd       ( T a )                { return _mm256_srli_epi64( a, 32 ); }
+  static inline T    add64     ( T a, T b )           { return _mm256_add_epi64( a, b ); }
+  static inline T    sub64     ( T a, T b )           { return _mm256_sub_epi64( a, b ); }
+  static inline T    srl64     ( T a, __m128i cnt )   { return _mm256_srl_epi64( a, cnt ); }
+  static inline T    sra64     ( T a, __m128i cnt )   { const T s = _mm256_shuffle_epi32( _mm256_srai_epi32( a, 31 ), 0xF5 ); return _mm256_xor_si256( _mm256_srl_epi64( _mm256_xor_si256( a, s ), cnt ), s ); }
+  static inline T    sext64    ( T a )                { const T m = _mm256_set1_epi64x( 0x80000000 ); return _mm256_sub_epi64( _mm256_xor_si256( _mm256_and_si256( a, _mm256_set1_epi64x( 0xFFFFFFFF ) ), m ), m ); }
+  static inline T    combine   ( T even, T odd )      { return _mm256_blend_epi32( even, _mm256_slli_epi64( odd, 32 ), 0xAA ); }
+};
+#endif
+
+#if X86_KERNELS_AVX512
+struct TrVec512
+{
+  typedef __m512i T;
+  static const Int LANES = 16;
+  static inline T    load      ( const Int* p )       { return _mm512_loadu_si512( ( const void* )p ); }
+  static inline Void store     ( Int* p, T v )        { _mm512_storeu_si512( ( void* )p, v ); }
+  static inline Void storeShort( Short* p, T v )      { _mm256_storeu_si256( ( __m256i* )p, _mm512_cvtsepi32_epi16( v ) ); }
+  static inline T    set1      ( Int v )              { return _mm512_set1_epi32( v ); }
+  static inline T    set1x64   ( Int64 v )            { return _mm512_set1_epi64( v ); }
+  static inline T    add       ( T a, T b )           { return _mm512_add_epi32( a, b ); }
+  static inline T    sub       ( T a, T b )           { return _mm512_sub_epi32( a, b ); }
+  static inline T    mul       ( T a, T b )           { return _mm512_mullo_epi32( a, b ); }
+  static inline T    madd      ( T a, T b )           { return _mm512_madd_epi16( a, b ); }
+  static inline T    sra       ( T a, __m128i cnt )   { return _mm512_sra_epi32( a, cnt ); }
+  static inline T    sll       ( T a, __m128i cnt )   { return _mm512_sll_epi32( a, cnt ); }
+  static inline T    min       ( T a, T b )           { return _mm512_min_epi32( a, b ); }
+  static inline T    max       ( T a, T b )           { return _mm512_max_epi32( a, b ); }
+  static inline T    abs       ( T a )                { return _mm512_abs_epi32( a ); }
+  static inline T    sign      ( T a, T b )           { const T z = _mm512_setzero_si512(); return _mm512_mask_sub_epi32( _mm512_maskz_mov_epi32( _mm512_cmpneq_epi32_mask( b, z ), a ), _mm512_cmplt_epi32_mask( b, z ), z, a ); }
+  static inline T    pair      ( T lo, T hi )         { return _mm512_mask_blend_epi16( 0xAAAAAAAA, lo, _mm512_slli_epi32( hi, 16 ) ); }
+  static inline Bool anyGreater( T a, T b )           { return _mm512_cmpgt_epi32_mask( a, b ) != 0; }
+  static inline Bool anyNonZero( T a )                { return _mm512_test_epi32_mask( a, a ) != 0; }
+  static inline Int  sum       ( T a )                { return _mm512_reduce_add_epi32( a ); }
+  static inline T    mulEven   ( T a, T b )           { return _mm512_mul_epu32( a, b ); }
+  static inline T    odd       ( T a )                { return _mm512_srli_epi64( a, 32 ); }
+  static inline T    add64     ( T a, T b )           { return _mm512_add_epi64( a, b ); }
+  static inline T    sub64     ( T a, T b )           { return _mm512_sub_epi64( a, b ); }
+  static inline T    srl64     ( T a, __m128i cnt )   { return _mm512_srl_epi64( a, cnt ); }
+  static inline T    sra64     ( T a, __m128i cnt )   { return _mm512_sra_epi64( a, cnt ); }
+  static inline T    sext64    ( T a )                { return _mm512_srai_epi64( _mm512_slli_epi64( a, 32 ), 32 ); }
+  static inline T    combine   ( T even, T odd )      { return _mm512_mask_blend_epi32( 0xAAAA, even, _mm512_slli_epi64( odd, 32 ) ); }
+};
+#endif
+
+// ====================================================================================================================
+// Transform matrices
+// ====================================================================================================================
+
+/** A 1D transform computes out[r] = sum_m M[r][m] * in[m]: M is the transform matrix for the forward transform and
+ *  its transpose for the inverse transform. The tables hold M in the layouts read by the kernels.
+ */
+struct TrMatrixX86
+{
+  Int aiPairRow[MAX_TU_SIZE    ][MAX_TU_SIZE / 2]; ///< M[r][2p] and M[r][2p+1] in the low and the high 16 bits, at [r][p]
+  Int aiPairCol[MAX_TU_SIZE / 2][MAX_TU_SIZE    ]; ///< the same pairs, at [p][r]
+  Int aiRow    [MAX_TU_SIZE    ][MAX_TU_SIZE    ]; ///< M[r][m], at [r][m]
+  Int aiCol    [MAX_TU_SIZE    ][MAX_TU_SIZE    ]; ///< M[r][m], at [m][r]
+};
+
+class TrMatricesX86
+{
+public:
+  TrMatricesX86()
+  {
+    for( Int dir = 0; dir < TRANSFORM_NUMBER_OF_DIRECTIONS; dir++ )
+    {
+      xSetMatrix( m_matrices[dir][0], &g_as_DST_MAT_4[dir][0][0], 4,  dir == TRANSFORM_INVERSE );
+      xSetMatrix( m_matrices[dir][1], &g_aiT4        [dir][0][0], 4,  dir == TRANSFORM_INVERSE );
+      xSetMatrix( m_matrices[dir][2], &g_aiT8        [dir][0][0], 8,  dir == TRANSFORM_INVERSE );
+      xSetMatrix( m_matrices[dir][3], &g_aiT16       [dir][0][0], 16, dir == TRANSFORM_INVERSE );
+      xSetMatrix( m_matrices[dir][4], &g_aiT32       [dir][0][0], 32, dir == TRANSFORM_INVERSE );
+    }
+  }
+
+  const TrMatrixX86& get( TransformDirection dir, Int size, Bool useDST ) const
+  {
+    return m_matrices[dir][useDST ? 0 : size == 4 ? 1 : size == 8 ? 2 : size == 16 ? 3 : 4];
+  }
+
+private:
+  static Void xSetMatrix( TrMatrixX86& mat, const TMatrixCoeff* coeff, Int size, Bool transpose )
+  {
+    for( Int r = 0; r < size; r++ )
+    {
+      for( Int m = 0; m < size; m++ )
+      {
+        const Int c = transpose ? coeff[m * size + r] : coeff[r * size + m];
+        mat.aiRow[r][m] = c;
+        mat.aiCol[m][r] = c;
+      }
+      for( Int p = 0; p < size / 2; p++ )
+      {
+        const Int pair = Int( UInt( UShort( mat.aiRow[r][2 * p] ) ) | ( UInt( UShort( mat.aiRow[r][2 * p + 1] ) ) << 16 ) );
+        mat.aiPairRow[r][p] = pair;
+        mat.aiPairCol[p][r] = pair;
+      }
+    }
+  }
+
+  TrMatrixX86 m_matrices[TRANSFORM_NUMBER_OF_DIRECTIONS][5]; ///< DST 4x4 and DCT 4x4 to 32x32
+};
+
+static inline const TrMatrixX86& xGetTrMatrixX86( TransformDirection dir, Int size, Bool useDST )
+{
+  static const TrMatricesX86 matrices;
+  return matrices.get( dir, size, useDST );
+}
+
+/** Two adjacent 16-bit values, as one 32-bit lane.
+ */
+static inline Int xLoadPair( const Short* p )
+{
+  Int pair;
+  memcpy( &pair, p, sizeof( pair ) );
+  return pair;
+}
+
+// ====================================================================================================================
+// Transforms. The 1D transforms of both stages are vectorised over the columns of the block, so that all loads and
+// stores are of consecutive values. The block width W is a template parameter, so that the accumulators of a row,
+// W / V::LANES registers, stay in registers.
+// ====================================================================================================================
+
+/// register of the transforms of blocks of width W: the widest one that fits
+template<Int W> struct TrVecOfWidth          { typedef TrVec128 V; };
+#if X86_KERNELS_AVX512
+template<>      struct TrVecOfWidth<8>       { typedef TrVec256 V; };
+template<>      struct TrVecOfWidth<16>      { typedef TrVec512 V; };
+template<>      struct TrVecOfWidth<32>      { typedef TrVec512 V; };
+#elif X86_KERNELS_AVX2
+template<>      struct TrVecOfWidth<8>       { typedef TrVec256 V; };
+template<>      struct TrVecOfWidth<16>      { typedef TrVec256 V; };
+template<>      struct TrVecOfWidth<32>      { typedef TrVec256 V; };
+#endif
+
+/** Transform along the columns, output row r: acc = (sum_m M[r][m] * src[m][x] + add) >> shift.
+ *  The source rows are given in pairs, src[2p][x] and src[2p+1][x] packed into one 32-bit lane (pairs != NULL), or
+ *  as 32-bit values (src32).
+ */
+template<typename V, Int W>
+static inline Void xTrColumns( const TrMatrixX86& mat, Int r, const Int* pairs, const Int* src32, Int iHeight, Int shift, typename V::T* acc )
+{
+  typedef typename V::T T;
+  const Int COLS = W / V::LANES;
+  const T   vAdd = V::set1( shift > 0 ? 1 << ( shift - 1 ) : 0 );
+
+  for( Int c = 0; c < COLS; c++ )
+  {
+    acc[c] = vAdd;
+  }
+  if( pairs != NULL )
+  {
+    for( Int p = 0; p < iHeight / 2; p++, pairs += W )
+    {
+      const T m = V::set1( mat.aiPairRow[r][p] );
+      for( Int c = 0; c < COLS; c++ )
+      {
+        acc[c] = V::add( acc[c], V::madd( V::load( pairs + c * V::LANES ), m ) );
+      }
+    }
+  }
+  else
+  {
+    for( Int k = 0; k < iHeight; k++, src32 += W )
+    {
+      const T m = V::set1( mat.aiRow[r][k] );
+      for( Int c = 0; c < COLS; c++ )
+      {
+        acc[c] = V::add( acc[c], V::mul( V::load( src32 + c * V::LANES ), m ) );
+      }
+    }
+  }
+  const __m128i vShift = _mm_cvtsi32_si128( shift );
+  for( Int c = 0; c < COLS; c++ )
+  {
+    acc[c] = V::sra( acc[c], vShift );
+  }
+}
+
+/** Transform along a row: acc = (sum_n M[x][n] * src[n] + add) >> shift, the row being given as 16-bit values.
+ */
+template<typename V, Int W>
+static inline Void xTrRow( const TrMatrixX86& mat, const Short* src, Int shift, typename V::T* acc )
+{
+  typedef typename V::T T;
+  const Int COLS = W / V::LANES;
+  const T   vAdd = V::set1( shift > 0 ? 1 << ( shift - 1 ) : 0 );
+
+  for( Int c = 0; c < COLS; c++ )
+  {
+    acc[c] = vAdd;
+  }
+  for( Int p = 0; p < W / 2; p++ )
+  {
+    const T s = V::set1( xLoadPair( src + 2 * p ) );
+    for( Int c = 0; c < COLS; c++ )
+    {
+      acc[c] = V::add( acc[c], V::madd( s, V::load( mat.aiPairCol[p] + c * V::LANES ) ) );
+    }
+  }
+  const __m128i vShift = _mm_cvtsi32_si128( shift );
+  for( Int c = 0; c < COLS; c++ )
+  {
+    acc[c] = V::sra( acc[c], vShift );
+  }
+}
+
+/** Transform along a row, the row being given as 32-bit values.
+ */
+template<typename V, Int W>
+static inline Void xTrRow( const TrMatrixX86& mat, const Int* src, Int shift, typename V::T* acc )
+{
+  typedef typename V::T T;
+  const Int COLS = W / V::LANES;
+  const T   vAdd = V::set1( shift > 0 ? 1 << ( shift - 1 ) : 0 );
+
+  for( Int c = 0; c < COLS; c++ )
+  {
+    acc[c] = vAdd;
+  }
+  for( Int n = 0; n < W; n++ )
+  {
+    const T s = V::set1( src[n] );
+    for( Int c = 0; c < COLS; c++ )
+    {
+      acc[c] = V::add( acc[c], V::mul( s, V::load( mat.aiCol[n] + c * V::LANES ) ) );
+    }
+  }
+  const __m128i vShift = _mm_cvtsi32_si128( shift );
+  for( Int c = 0; c < COLS; c++ )
+  {
+    acc[c] = V::sra( acc[c], vShift );
+  }
+}
+
+/** Pack pairs of rows of 32-bit values into 16-bit pairs, for xTrColumns.
+ *  \returns false if a value does not fit in 16 bits
+ */
+template<typename V, Int W>
+static inline Bool xPairRows( const Int* src, Int* pairs, Int iHeight )
+{
+  typedef typename V::T T;
+  const T vLo = V::set1( std::numeric_limits<Short>::min() );
+  const T vHi = V::set1( std::numeric_limits<Short>::max() );
+  T vMin = vLo, vMax = vHi;
+
+  for( Int p = 0; p < iHeight / 2; p++, src += 2 * W, pairs += W )
+  {
+    for( Int x = 0; x < W; x += V::LANES )
+    {
+      const T lo = V::load( src + x );
+      const T hi = V::load( src + W + x );
+      vMin = V::min( vMin, V::min( lo, hi ) );
+      vMax = V::max( vMax, V::max( lo, hi ) );
+      V::store( pairs + x, V::pair( lo, hi ) );
+    }
+  }
+  return !V::anyGreater( vMax, vHi ) && !V::anyGreater( vLo, vMin );
+}
+
+template<Int W>
+static Void xTrBlockVec( Int bitDepth, Bool useDST, const Pel *piBlkResi, UInt uiStride, TCoeff *psCoeff, Int iHeight, Int maxLog2TrDynamicRange )
+{
+  typedef typename TrVecOfWidth<W>::V V;
+  typedef typename V::T T;
+  const Int TRANSFORM_MATRIX_SHIFT = g_transformMatrixShift[TRANSFORM_FORWARD];
+  const Int COLS = W / V::LANES;
+
+  const Int  shift_1st = ((g_aucConvertToBit[W] + 2) +  bitDepth + TRANSFORM_MATRIX_SHIFT) - maxLog2TrDynamicRange;
+  const Int  shift_2nd = (g_aucConvertToBit[iHeight] + 2) + TRANSFORM_MATRIX_SHIFT;
+  const Bool bDST      = useDST && W == 4 && iHeight == 4;
+
+  const TrMatrixX86& matW = xGetTrMatrixX86( TRANSFORM_FORWARD, W,       bDST );
+  const TrMatrixX86& matH = xGetTrMatrixX86( TRANSFORM_FORWARD, iHeight, bDST );
+
+  Int tmp  [W * MAX_TU_SIZE];
+  Int pairs[W * MAX_TU_SIZE / 2];
+  T   acc  [COLS];
+
+  // first stage, along the rows
+  for( Int y = 0; y < iHeight; y++ )
+  {
+    xTrRow<V, W>( matW, piBlkResi + y * uiStride, shift_1st, acc );
+    for( Int c = 0; c < COLS; c++ )
+    {
+      V::store( tmp + y * W + c * V::LANES, acc[c] );
+    }
+  }
+
+  // second stage, along the columns
+  const Bool b16 = xPairRows<V, W>( tmp, pairs, iHeight );
+  for( Int r = 0; r < iHeight; r++ )
+  {
+    xTrColumns<V, W>( matH, r, b16 ? pairs : NULL, tmp, iHeight, shift_2nd, acc );
+    for( Int c = 0; c < COLS; c++ )
+    {
+      V::store( psCoeff + r * W + c * V::LANES, acc[c] );
+    }
+  }
+}
+
+template<Int W>
+static Void xITrBlockVec( Int bitDepth, Bool useDST, const TCoeff *plCoef, Pel *pResidual, UInt uiStride, Int iHeight, Int maxLog2TrDynamicRange )
+{
+  typedef typename TrVecOfWidth<W>::V V;
+  typedef typename V::T T;
+  const Int TRANSFORM_MATRIX_SHIFT = g_transformMatrixShift[TRANSFORM_INVERSE];
+  const Int COLS = W / V::LANES;
+
+  const Int  shift_1st = TRANSFORM_MATRIX_SHIFT + 1; //1 has been added to shift_1st at the expense of shift_2nd
+  const Int  shift_2nd = (TRANSFORM_MATRIX_SHIFT + maxLog2TrDynamicRange - 1) - bitDepth;
+  const Bool bDST      = useDST && W == 4 && iHeight == 4;
+  // the first stage clips to 16 bits when the dynamic range is 15 bits
+  const Bool b16Out    = maxLog2TrDynamicRange == 15;
+  const T    vClipMin  = V::set1( -(1 << maxLog2TrDynamicRange) );
+  const T    vClipMax  = V::set1(  (1 << maxLog2TrDynamicRange) - 1 );
+
+  const TrMatrixX86& matW = xGetTrMatrixX86( TRANSFORM_INVERSE, W,       bDST );
+  const TrMatrixX86& matH = xGetTrMatrixX86( TRANSFORM_INVERSE, iHeight, bDST );
+
+  Int   pairs[W * MAX_TU_SIZE / 2];
+  Short tmp16[W * MAX_TU_SIZE];
+  Int   tmp32[W * MAX_TU_SIZE];
+  T     acc  [COLS];
+
+  // first stage, along the columns
+  const Bool b16In = xPairRows<V, W>( plCoef, pairs, iHeight );
+  for( Int r = 0; r < iHeight; r++ )
+  {
+    xTrColumns<V, W>( matH, r, b16In ? pairs : NULL, plCoef, iHeight, shift_1st, acc );
+    for( Int c = 0; c < COLS; c++ )
+    {
+      if( b16Out )
+      {
+        V::storeShort( tmp16 + r * W + c * V::LANES, acc[c] );
+      }
+      else
+      {
+        V::store( tmp32 + r * W + c * V::LANES, V::min( V::max( acc[c], vClipMin ), vClipMax ) );
+      }
+    }
+  }
+
+  // second stage, along the rows. Clipping here is not in the standard, but is used to protect the "Pel" data type
+  for( Int y = 0; y < iHeight; y++ )
+  {
+    if( b16Out )
+    {
+      xTrRow<V, W>( matW, tmp16 + y * W, shift_2nd, acc );
+    }
+    else
+    {
+      xTrRow<V, W>( matW, tmp32 + y * W, shift_2nd, acc );
+    }
+    for( Int c = 0; c < COLS; c++ )
+    {
+      V::storeShort( pResidual + y * uiStride + c * V::LANES, acc[c] );
+    }
+  }
+}
+
+// ====================================================================================================================
+// Quantisation. The products of the levels with the quantisation coefficients are 64 bits wide, and are computed
+// separately for the even and the odd 32-bit lanes.
+// ====================================================================================================================
+
+template<typename V>
+static TCoeff xQuantBlockVec( const TCoeff *piCoef, TCoeff *piQCoef, TCoeff *piArlCCoef, TCoeff *deltaU, Int numCoeff, const Int *piQuantCoeff, Int quantCoeff,
+                              Int iQBits, Int iAdd, Int iQBitsC, Int iAddC, TCoeff entropyCodingMinimum, TCoeff entropyCodingMaximum )
+{
+  typedef typename V::T T;
+  const __m128i vQBits  = _mm_cvtsi32_si128( iQBits );
+  const __m128i vQBits8 = _mm_cvtsi32_si128( iQBits - 8 );
+  const __m128i vQBitsC = _mm_cvtsi32_si128( iQBitsC );
+  const T       vAdd    = V::set1x64( iAdd );
+  const T       vAddC   = V::set1x64( iAddC );
+  const T       vQuant  = V::set1( quantCoeff );
+  const T       vMin    = V::set1( entropyCodingMinimum );
+  const T       vMax    = V::set1( entropyCodingMaximum );
+  T             vSum    = V::set1( 0 );
+
+  for( Int n = 0; n < numCoeff; n += V::LANES )
+  {
+    const T level = V::load( piCoef + n );
+    const T absL  = V::abs( level );
+    const T scale = piQuantCoeff != NULL ? V::load( piQuantCoeff + n ) : vQuant;
+    const T tmpE  = V::mulEven( absL, scale );
+    const T tmpO  = V::mulEven( V::odd( absL ), V::odd( scale ) );
+
+    if( piArlCCoef != NULL )
+    {
+      V::store( piArlCCoef + n, V::combine( V::srl64( V::add64( tmpE, vAddC ), vQBitsC ), V::srl64( V::add64( tmpO, vAddC ), vQBitsC ) ) );
+    }
+
+    const T mag = V::combine( V::srl64( V::add64( tmpE, vAdd ), vQBits ), V::srl64( V::add64( tmpO, vAdd ), vQBits ) );
+
+    // as the scalar code, quantisedMagnitude << iQBits is a 32-bit shift
+    const T rec = V::sll( mag, vQBits );
+    V::store( deltaU + n, V::combine( V::sra64( V::sub64( tmpE, V::sext64( rec ) ),          vQBits8 ),
+                                      V::sra64( V::sub64( tmpO, V::sext64( V::odd( rec ) ) ), vQBits8 ) ) );
+
+    vSum = V::add( vSum, mag );
+    V::store( piQCoef + n, V::min( V::max( V::sign( mag, level ), vMin ), vMax ) );
+  }
+
+  return V::sum( vSum );
+}
+
+template<typename V>
+static Bool xNeedRDOQBlockVec( const TCoeff *piCoef, Int numCoeff, const Int *piQuantCoeff, Int quantCoeff, Int iQBits, Int iAdd )
+{
+  typedef typename V::T T;
+  const __m128i vQBits = _mm_cvtsi32_si128( iQBits );
+  const T       vAdd   = V::set1x64( iAdd );
+  const T       vQuant = V::set1( quantCoeff );
+
+  for( Int n = 0; n < numCoeff; n += V::LANES )
+  {
+    const T absL  = V::abs( V::load( piCoef + n ) );
+    const T scale = piQuantCoeff != NULL ? V::load( piQuantCoeff + n ) : vQuant;
+    const T tmpE  = V::mulEven( absL, scale );
+    const T tmpO  = V::mulEven( V::odd( absL ), V::odd( scale ) );
+    const T mag   = V::combine( V::srl64( V::add64( tmpE, vAdd ), vQBits ), V::srl64( V::add64( tmpO, vAdd ), vQBits ) );
+
+    if( V::anyNonZero( mag ) )
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+template<typename V>
+static Void xDeQuantBlockVec( const TCoeff *piQCoef, TCoeff *piCoef, Int numCoeff, const Int *piDequantCoef, Int scale, Int rightShift,
+                              Intermediate_Int inputMinimum, Intermediate_Int inputMaximum, TCoeff transformMinimum, TCoeff transformMaximum )
+{
+  typedef typename V::T T;
+  const __m128i vShift = _mm_cvtsi32_si128( rightShift > 0 ? rightShift : -rightShift );
+  const T       vAdd   = V::set1( rightShift > 0 ? 1 << ( rightShift - 1 ) : 0 );
+  const T       vScale = V::set1( scale );
+  const T       vInMin = V::set1( inputMinimum );
+  const T       vInMax = V::set1( inputMaximum );
+  const T       vMin   = V::set1( transformMinimum );
+  const T       vMax   = V::set1( transformMaximum );
+
+  for( Int n = 0; n < numCoeff; n += V::LANES )
+  {
+    const T clipQCoef = V::min( V::max( V::load( piQCoef + n ), vInMin ), vInMax );
+    const T iCoeffQ   = V::mul( clipQCoef, piDequantCoef != NULL ? V::load( piDequantCoef + n ) : vScale );
+
+    V::store( piCoef + n, V::min( V::max( rightShift > 0 ? V::sra( V::add( iCoeffQ, vAdd ), vShift ) : V::sll( iCoeffQ, vShift ), vMin ), vMax ) );
+  }
+}
+
+// ====================================================================================================================
+// Kernels: the widest register that fits the block
+// ====================================================================================================================
+
+template<X86_VEXT vext>
+Void TComTrQuant::xTrBlockX86( Int bitDepth, Bool useDST, const Pel *piBlkResi, UInt uiStride, TCoeff *psCoeff, Int iWidth, Int iHeight, Int maxLog2TrDynamicRange )
+{
+  switch( iWidth )
+  {
+  case 4:  xTrBlockVec<4> ( bitDepth, useDST, piBlkResi, uiStride, psCoeff, iHeight, maxLog2TrDynamicRange ); break;
+  case 8:  xTrBlockVec<8> ( bitDepth, useDST, piBlkResi, uiStride, psCoeff, iHeight, maxLog2TrDynamicRange ); break;
+  case 16: xTrBlockVec<16>( bitDepth, useDST, piBlkResi, uiStride, psCoeff, iHeight, maxLog2TrDynamicRange ); break;
+  case 32: xTrBlockVec<32>( bitDepth, useDST, piBlkResi, uiStride, psCoeff, iHeight, maxLog2TrDynamicRange ); break;
+  default:
+    assert(0); exit (1); break;
+  }
+}
+
+template<X86_VEXT vext>
+Void TComTrQuant::xITrBlockX86( Int bitDepth, Bool useDST, const TCoeff *plCoef, Pel *pResidual, UInt uiStride, Int iWidth, Int iHeight, Int maxLog2TrDynamicRange )
+{
+  switch( iWidth )
+  {
+  case 4:  xITrBlockVec<4> ( bitDepth, useDST, plCoef, pResidual, uiStride, iHeight, maxLog2TrDynamicRange ); break;
+  case 8:  xITrBlockVec<8> ( bitDepth, useDST, plCoef, pResidual, uiStride, iHeight, maxLog2TrDynamicRange ); break;
+  case 16: xITrBlockVec<16>( bitDepth, useDST, plCoef, pResidual, uiStride, iHeight, maxLog2TrDynamicRange ); break;
+  case 32: xITrBlockVec<32>( bitDepth, useDST, plCoef, pResidual, uiStride, iHeight, maxLog2TrDynamicRange ); break;
+  default:
+    assert(0); exit (1); break;
+  }
+}
+
+#if X86_KERNELS_AVX512
+typedef TrVec512 TrVecMax;    ///< register of the coefficient loops: blocks have at least 16 coefficients
+#elif X86_KERNELS_AVX2
+typedef TrVec256 TrVecMax;
+#else
+typedef TrVec128 TrVecMax;
+#endif
+
+template<X86_VEXT vext>
+TCoeff TComTrQuant::xQuantBlockX86( const TCoeff *piCoef, TCoeff *piQCoef, TCoeff *piArlCCoef, TCoeff *deltaU, Int numCoeff, const Int *piQuantCoeff, Int quantCoeff,
+                                    Int iQBits, Int iAdd, Int iQBitsC, Int iAddC, TCoeff entropyCodingMinimum, TCoeff entropyCodingMaximum )
+{
+  return xQuantBlockVec<TrVecMax>( piCoef, piQCoef, piArlCCoef, deltaU, numCoeff, piQuantCoeff, quantCoeff, iQBits, iAdd, iQBitsC, iAddC, entropyCodingMinimum, entropyCodingMaximum );
+}
+
+template<X86_VEXT vext>
+Bool TComTrQuant::xNeedRDOQBlockX86( const TCoeff *piCoef, Int numCoeff, const Int *piQuantCoeff, Int quantCoeff, Int iQBits, Int iAdd )
+{
+  return xNeedRDOQBlockVec<TrVecMax>( piCoef, numCoeff, piQuantCoeff, quantCoeff, iQBits, iAdd );
+}
+
+template<X86_VEXT vext>
+Void TComTrQuant::xDeQuantBlockX86( const TCoeff *piQCoef, TCoeff *piCoef, Int numCoeff, const Int *piDequantCoef, Int scale, Int rightShift,
+                                    Intermediate_Int inputMinimum, Intermediate_Int inputMaximum, TCoeff transformMinimum, TCoeff transformMaximum )
+{
+  xDeQuantBlockVec<TrVecMax>( piQCoef, piCoef, numCoeff, piDequantCoef, scale, rightShift, inputMinimum, inputMaximum, transformMinimum, transformMaximum );
+}
+
+#endif // !RExt__HIGH_BIT_DEPTH_SUPPORT
+
+// ====================================================================================================================
+// Initialisation
+// ====================================================================================================================
+
+template<X86_VEXT vext>
+Void TComTrQuant::xInitTrQuantX86()
+{
+#if !RExt__HIGH_BIT_DEPTH_SUPPORT
+  m_fpTransform    = xTrBlockX86<vext>;
+  m_fpInvTransform = xITrBlockX86<vext>;
+  m_fpQuant        = xQuantBlockX86<vext>;
+  m_fpNeedRDOQ     = xNeedRDOQBlockX86<vext>;
+  m_fpDeQuant      = xDeQuantBlockX86<vext>;
+#endif
+}
+
+//! \}
+
+#endif // VECTOR_CODING__X86_DISPATCH
+
+#endif // __TCOMTRQUANTX86__
@@ -47,6 +47,9 @@
 // ====================================================================================================================
 
 TDecCu::TDecCu()
+: m_uiMaxDepth(0)
+, m_uiMaxWidth(0)
+, m_uiMaxHeight(0)
 {
   m_ppcYuvResi = NULL;
   m_ppcYuvReco = NULL;
@@ -79,7 +82,12 @@ Void TDecCu::init(TDecEntropy* pcEntropyDecoder, TComTrQuant* pcTrQuant, TComPre
  */
 Void TDecCu::create( UInt uiMaxDepth, UInt uiMaxWidth, UInt uiMaxHeight, ChromaFormat chromaFormatIDC )
 {
-  m_uiMaxDepth = uiMaxDepth+1;
+  // the partition tables are read by the filter thread of a pipelined decoder, so they are only rewritten when the CTU size changes
+  const Bool bInitPartitionTables = !isCreatedFor( uiMaxDepth, uiMaxWidth, uiMaxHeight );
+
+  m_uiMaxDepth  = uiMaxDepth+1;
+  m_uiMaxWidth  = uiMaxWidth;
+  m_uiMaxHeight = uiMaxHeight;
 
   m_ppcYuvResi = new TComYuv*[m_uiMaxDepth-1];
   m_ppcYuvReco = new TComYuv*[m_uiMaxDepth-1];
@@ -107,13 +115,16 @@ Void TDecCu::create( UInt uiMaxDepth, UInt uiMaxWidth, UInt uiMaxHeight, ChromaF
   m_bDecodeDQP = false;
   m_IsChromaQpAdjCoded = false;
 
-  // initialize partition order.
-  UInt* piTmp = &g_auiZscanToRaster[0];
-  initZscanToRaster(m_uiMaxDepth, 1, 0, piTmp);
-  initRasterToZscan( uiMaxWidth, uiMaxHeight, m_uiMaxDepth );
+  if ( bInitPartitionTables )
+  {
+    // initialize partition order.
+    UInt* piTmp = &g_auiZscanToRaster[0];
+    initZscanToRaster(m_uiMaxDepth, 1, 0, piTmp);
+    initRasterToZscan( uiMaxWidth, uiMaxHeight, m_uiMaxDepth );
 
-  // initialize conversion matrix from partition index to pel
-  initRasterToPelXY( uiMaxWidth, uiMaxHeight, m_uiMaxDepth );
+    // initialize conversion matrix from partition index to pel
+    initRasterToPelXY( uiMaxWidth, uiMaxHeight, m_uiMaxDepth );
+  }
 }
 
 Void TDecCu::destroy()
@@ -151,6 +162,14 @@ Void TDecCu::decodeCtu( TComDataCU* pCtu, Bool& isLastCtuOfSliceSegment )
     setIsChromaQpAdjCoded(true);
   }
 
+  // the temporal motion vector predictors are taken from the same CTU row of the collocated picture
+  TComSlice* pcSlice = pCtu->getSlice();
+  if ( !pcSlice->isIntra() && pcSlice->getEnableTMVPFlag() )
+  {
+    TComPic* pColPic = pcSlice->getRefPic( RefPicList(pcSlice->isInterB() ? 1-pcSlice->getColFromL0Flag() : 0), pcSlice->getColRefIdx() );
+    pColPic->waitForFinishedCtuRows( pCtu->getCUPelY() / pcSlice->getSPS()->getMaxCUHeight() + 1 );
+  }
+
   // start from the top level CU
   xDecodeCU( pCtu, 0, 0, isLastCtuOfSliceSegment);
 }
@@ -430,6 +449,37 @@ Void TDecCu::xDecompressCU( TComDataCU* pCtu, UInt uiAbsPartIdx,  UInt uiDepth )
   xCopyToPic( m_ppcCU[uiDepth], pcPic, uiAbsPartIdx, uiDepth );
 }
 
+/** Wait until the reference picture rows used by the motion compensation of a CU are finished, when the reference pictures are still being filtered.
+ * \param pcCU pointer to CU data structure
+ */
+Void TDecCu::xWaitForReferenceRows( TComDataCU* pcCU )
+{
+  TComSlice*       pcSlice       = pcCU->getSlice();
+  const Int        maxCUHeight   = pcSlice->getSPS()->getMaxCUHeight();
+  const Int        ctuPelY       = pcCU->getPic()->getCtu( pcCU->getCtuRsAddr() )->getCUPelY();
+  const Int        numCtuRows    = pcCU->getPic()->getFrameHeightInCtus();
+
+  for ( Int partIdx = 0; partIdx < pcCU->getNumPartitions(); partIdx++ )
+  {
+    UInt partAddr;
+    Int  width, height;
+    pcCU->getPartIndexAndSize( partIdx, partAddr, width, height );
+    const Int partPelY = ctuPelY + g_auiRasterToPelY[ g_auiZscanToRaster[ pcCU->getZorderIdxInCtu() + partAddr ] ];
+
+    for ( Int refList = 0; refList < NUM_REF_PIC_LIST_01; refList++ )
+    {
+      const RefPicList eRefPicList = RefPicList( refList );
+      const Int        refIdx      = pcCU->getCUMvField( eRefPicList )->getRefIdx( partAddr );
+      if ( refIdx >= 0 )
+      {
+        // bottom line read by the luma and chroma interpolation filters, with some rounding headroom
+        const Int bottomPelY = partPelY + height + ( pcCU->getCUMvField( eRefPicList )->getMv( partAddr ).getVer() >> 2 ) + 8;
+        pcSlice->getRefPic( eRefPicList, refIdx )->waitForFinishedCtuRows( Clip3( 1, numCtuRows, bottomPelY / maxCUHeight + 1 ) );
+      }
+    }
+  }
+}
+
 Void TDecCu::xReconInter( TComDataCU* pcCU, UInt uiDepth )
 {
 
@@ -440,6 +490,7 @@ Void TDecCu::xReconInter( TComDataCU* pcCU, UInt uiDepth )
     m_pConformanceCheck->flagTMctsError("motion vector across tile boundaries");
   }
 #endif
+  xWaitForReferenceRows( pcCU );
   m_pcPrediction->motionCompensation( pcCU, m_ppcYuvReco[uiDepth] );
 
 #if DEBUG_STRING
@@ -58,6 +58,8 @@ class TDecCu
 {
 private:
   UInt                m_uiMaxDepth;       ///< max. number of depth
+  UInt                m_uiMaxWidth;       ///< largest CU width
+  UInt                m_uiMaxHeight;      ///< largest CU height
   TComYuv**           m_ppcYuvResi;       ///< array of residual buffer
   TComYuv**           m_ppcYuvReco;       ///< array of prediction & reconstruction buffer
   TComDataCU**        m_ppcCU;            ///< CU data array
@@ -90,6 +92,9 @@ public:
   /// destroy internal buffers
   Void  destroy                 ();
 
+  /// whether create() was last called for this CTU size, in which case it leaves the partition tables of TComRom unchanged
+  Bool  isCreatedFor            ( UInt uiMaxDepth, UInt uiMaxWidth, UInt uiMaxHeight ) const { return m_uiMaxDepth == uiMaxDepth+1 && m_uiMaxWidth == uiMaxWidth && m_uiMaxHeight == uiMaxHeight; }
+
   /// decode Ctu information
   Void  decodeCtu               ( TComDataCU* pCtu, Bool &isLastCtuOfSliceSegment );
 
@@ -103,6 +108,7 @@ protected:
   Bool xDecodeSliceEnd          ( TComDataCU* pcCU, UInt uiAbsPartIdx );
   Void xDecompressCU            ( TComDataCU* pCtu, UInt uiAbsPartIdx, UInt uiDepth );
 
+  Void xWaitForReferenceRows    ( TComDataCU* pcCU );
   Void xReconInter              ( TComDataCU* pcCU, UInt uiDepth );
 
   Void xReconIntraQT            ( TComDataCU* pcCU, UInt uiDepth );
@@ -54,6 +54,8 @@ static Void calcAndPrintHashStatus(TComPicYuv& pic, const SEIDecodedPictureHash*
 
 TDecGop::TDecGop()
  : m_numberOfChecksumErrorsDetected(0)
+ , m_pipelineDepth(0)
+ , m_bFilterThreadStop(false)
 {
   m_dDecTime = 0;
 }
@@ -71,6 +73,16 @@ Void TDecGop::create()
 
 Void TDecGop::destroy()
 {
+  if (m_filterThread.joinable())
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_filterQueueMutex);
+      m_bFilterThreadStop = true;
+    }
+    m_filterQueueCond.notify_all();
+    m_filterThread.join();
+    m_bFilterThreadStop = false;
+  }
 }
 
 Void TDecGop::init( TDecEntropy*            pcEntropyDecoder,
@@ -93,9 +105,6 @@ Void TDecGop::init( TDecEntropy*            pcEntropyDecoder,
 }
 
 
-// ====================================================================================================================
-// Private member functions
-// ====================================================================================================================
 // ====================================================================================================================
 // Public member functions
 // ====================================================================================================================
@@ -121,7 +130,7 @@ Void TDecGop::decompressSlice(TComInputBitstream* pcBitstream, TComPic* pcPic)
     ppcSubstreams[ui] = pcBitstream->extractSubstream(ui+1 < uiNumSubstreams ? (pcSlice->getSubstreamSize(ui)<<3) : pcBitstream->getNumBitsLeft());
   }
 
-  m_pcSliceDecoder->decompressSlice( ppcSubstreams, pcPic, m_pcSbacDecoder);
+  m_pcSliceDecoder->decompressSlice( ppcSubstreams, pcPic, m_pcSbacDecoder, uiNumSubstreams );
   // deallocate all created substreams, including internal buffers.
   for (UInt ui = 0; ui < uiNumSubstreams; ui++)
   {
@@ -132,28 +141,121 @@ Void TDecGop::decompressSlice(TComInputBitstream* pcBitstream, TComPic* pcPic)
   m_dDecTime += (Double)(clock()-iBeforeTime) / CLOCKS_PER_SEC;
 }
 
+/** Apply the in-loop filters to a decoded picture and mark it as reconstructed.
+ * When the decoder is pipelined, the picture is queued for the filter thread and the other pictures wait for its CTU rows with TComPic::waitForFinishedCtuRows().
+ * \param pcPic picture (TComPic) pointer
+ */
 Void TDecGop::filterPicture(TComPic* pcPic)
 {
-  TComSlice*  pcSlice = pcPic->getSlice(pcPic->getCurrSliceIdx());
+  if (m_pipelineDepth > 0)
+  {
+    {
+      std::unique_lock<std::mutex> lock(m_filterQueueMutex);
+      m_filterQueueCond.wait(lock, [&]{ return (Int)m_filterQueue.size() < m_pipelineDepth; });
+      TComSlice* pcSlice = pcPic->getSlice(pcPic->getCurrSliceIdx());
+      FilterJob  job     = { pcPic, pcSlice, m_dDecTime, pcSlice->isReferenced() };
+      m_filterQueue.push_back(job);
+    }
+    m_filterQueueCond.notify_all();
+    m_dDecTime = 0;
+
+    if (!m_filterThread.joinable())
+    {
+      m_filterThread = std::thread(&TDecGop::xFilterPictures, this);
+    }
+  }
+  else
+  {
+    TComSlice* pcSlice = pcPic->getSlice(pcPic->getCurrSliceIdx());
+    FilterJob  job     = { pcPic, pcSlice, m_dDecTime, pcSlice->isReferenced() };
+    xFilterPicture(job);
+    m_dDecTime = 0;
+  }
+
+  pcPic->setOutputMark(pcPic->getSlice(0)->getPicOutputFlag() ? true : false);
+  pcPic->setReconMark(true);
+}
+
+/** Wait until the filter thread has finished all the queued pictures.
+ */
+Void TDecGop::waitForFilteredPictures()
+{
+  std::unique_lock<std::mutex> lock(m_filterQueueMutex);
+  m_filterQueueCond.wait(lock, [&]{ return m_filterQueue.empty(); });
+}
+
+// ====================================================================================================================
+// Private member functions
+// ====================================================================================================================
+
+/** Filter thread of the pipelined decoder: filters the queued pictures in decoding order.
+ */
+Void TDecGop::xFilterPictures()
+{
+  while (true)
+  {
+    FilterJob job;
+    {
+      std::unique_lock<std::mutex> lock(m_filterQueueMutex);
+      m_filterQueueCond.wait(lock, [&]{ return !m_filterQueue.empty() || m_bFilterThreadStop; });
+      if (m_filterQueue.empty())
+      {
+        return;
+      }
+      job = m_filterQueue.front();
+    }
+
+    xFilterPicture(job);
+
+    {
+      std::lock_guard<std::mutex> lock(m_filterQueueMutex);
+      m_filterQueue.pop_front();
+    }
+    m_filterQueueCond.notify_all();
+  }
+}
+
+/** Deblocking, SAO, PCM restoration and motion compression of a picture, followed by the picture hash check.
+ * \param job picture to filter
+ */
+Void TDecGop::xFilterPicture(const FilterJob& job)
+{
+  TComPic*    pcPic    = job.pcPic;
+  TComSlice*  pcSlice  = job.pcSlice;
+  Double      dDecTime = job.dDecTime;
+  const TComSPS &sps = pcPic->getPicSym()->getSPS();
+  const TComPPS &pps = pcPic->getPicSym()->getPPS();
 
   //-- For time output for each slice
   clock_t iBeforeTime = clock();
 
+  // the filters are set up for each picture by the thread running them
+  m_pcSAO->create( sps.getPicWidthInLumaSamples(), sps.getPicHeightInLumaSamples(), sps.getChromaFormatIdc(), sps.getMaxCUWidth(), sps.getMaxCUHeight(), sps.getMaxTotalCUDepth(), pps.getPpsRangeExtension().getLog2SaoOffsetScale(CHANNEL_TYPE_LUMA), pps.getPpsRangeExtension().getLog2SaoOffsetScale(CHANNEL_TYPE_CHROMA) );
+  m_pcLoopFilter->create( sps.getMaxTotalCUDepth() );
+
   // deblocking filter
   Bool bLFCrossTileBoundary = pcSlice->getPPS()->getLoopFilterAcrossTilesEnabledFlag();
   m_pcLoopFilter->setCfg(bLFCrossTileBoundary);
-  m_pcLoopFilter->loopFilterPic( pcPic );
 
-  if( pcSlice->getSPS()->getUseSAO() )
+  if (m_pipelineDepth > 0)
   {
-    m_pcSAO->reconstructBlkSAOParams(pcPic, pcPic->getPicSym()->getSAOBlkParam());
-    m_pcSAO->SAOProcess(pcPic);
-    m_pcSAO->PCMLFDisableProcess(pcPic);
+    xFilterCtuRows(pcPic);
   }
+  else
+  {
+    m_pcLoopFilter->loopFilterPic( pcPic );
 
-  pcPic->compressMotion();
+    if( pcSlice->getSPS()->getUseSAO() )
+    {
+      m_pcSAO->reconstructBlkSAOParams(pcPic, pcPic->getPicSym()->getSAOBlkParam());
+      m_pcSAO->SAOProcess(pcPic);
+      m_pcSAO->PCMLFDisableProcess(pcPic);
+    }
+
+    pcPic->compressMotion();
+  }
   TChar c = (pcSlice->isIntra() ? 'I' : pcSlice->isInterP() ? 'P' : 'B');
-  if (!pcSlice->isReferenced())
+  if (!job.bReferenced)
   {
     c += 32;
   }
@@ -164,9 +266,8 @@ Void TDecGop::filterPicture(TComPic* pcPic)
                                                   c,
                                                   pcSlice->getSliceQp() );
 
-  m_dDecTime += (Double)(clock()-iBeforeTime) / CLOCKS_PER_SEC;
-  printf ("[DT %6.3f] ", m_dDecTime );
-  m_dDecTime  = 0;
+  dDecTime += (Double)(clock()-iBeforeTime) / CLOCKS_PER_SEC;
+  printf ("[DT %6.3f] ", dDecTime );
 
   for (Int iRefList = 0; iRefList < 2; iRefList++)
   {
@@ -190,8 +291,55 @@ Void TDecGop::filterPicture(TComPic* pcPic)
 
   printf("\n");
 
-  pcPic->setOutputMark(pcPic->getSlice(0)->getPicOutputFlag() ? true : false);
-  pcPic->setReconMark(true);
+  if (m_pipelineDepth > 0)
+  {
+    fflush(stdout);
+    // the picture can be reused from now on
+    pcPic->setNumFinishedCtuRows(MAX_INT);
+  }
+}
+
+/** In-loop filtering of a picture CTU row by CTU row, so that the finished rows can be referenced while the rest of the picture is filtered.
+ * Deblocking runs one CTU row ahead of SAO, because the deblocking of a row modifies the last lines of the row above it,
+ * and the deblocked samples of a row are kept for SAO once the row below is deblocked, so SAO of row n runs after the deblocking of row n+2.
+ * \param pcPic picture (TComPic) pointer
+ */
+Void TDecGop::xFilterCtuRows(TComPic* pcPic)
+{
+  const Bool bSAO           = pcPic->getPicSym()->getSPS().getUseSAO();
+  const Int  numCtuRows     = pcPic->getFrameHeightInCtus();
+  const Int  maxCUHeight    = pcPic->getPicSym()->getSPS().getMaxCUHeight();
+  TComPicYuv* pcPicYuvRec   = pcPic->getPicYuvRec();
+
+  if (bSAO)
+  {
+    m_pcSAO->reconstructBlkSAOParams(pcPic, pcPic->getPicSym()->getSAOBlkParam());
+  }
+
+  for (Int ctuRow = 0; ctuRow < numCtuRows + 2; ctuRow++)
+  {
+    if (ctuRow < numCtuRows)
+    {
+      m_pcLoopFilter->loopFilterCtuRow(pcPic, ctuRow);
+    }
+    if (bSAO && ctuRow >= 1 && ctuRow <= numCtuRows)
+    {
+      m_pcSAO->SAOCopyCtuRow(pcPic, ctuRow - 1);
+    }
+
+    const Int finishedRow = ctuRow - 2;
+    if (finishedRow >= 0)
+    {
+      if (bSAO)
+      {
+        m_pcSAO->SAOProcessCtuRow(pcPic, finishedRow);
+        m_pcSAO->PCMLFDisableProcessCtuRow(pcPic, finishedRow);
+      }
+      pcPic->compressMotion(finishedRow);
+      pcPicYuvRec->extendPicBorderLines(finishedRow * maxCUHeight, maxCUHeight);
+      pcPic->setNumFinishedCtuRows(finishedRow + 1);
+    }
+  }
 }
 
 /**
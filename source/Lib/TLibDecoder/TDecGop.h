@@ -42,6 +42,11 @@
 #pragma once
 #endif // _MSC_VER > 1000
 
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+
 #include "TLibCommon/CommonDef.h"
 #include "TLibCommon/TComBitStream.h"
 #include "TLibCommon/TComList.h"
@@ -81,6 +86,27 @@ private:
   Int                   m_decodedPictureHashSEIEnabled;  ///< Checksum(3)/CRC(2)/MD5(1)/disable(0) acting on decoded picture hash SEI message
   UInt                  m_numberOfChecksumErrorsDetected;
 
+  /// picture queued for the in-loop filtering stage
+  struct FilterJob
+  {
+    TComPic*   pcPic;
+    TComSlice* pcSlice;         ///< last decoded slice of the picture
+    Double     dDecTime;        ///< time spent in decoding the slices of the picture
+    Bool       bReferenced;     ///< picture marking when it was decoded
+  };
+
+  // in-loop filtering stage of the pipelined decoder
+  Int                     m_pipelineDepth;      ///< maximum number of pictures in the in-loop filtering stage (0: filtering on the decoding thread)
+  std::thread             m_filterThread;
+  std::mutex              m_filterQueueMutex;
+  std::condition_variable m_filterQueueCond;
+  std::deque<FilterJob>   m_filterQueue;        ///< pictures waiting for or being filtered
+  Bool                    m_bFilterThreadStop;
+
+  Void  xFilterPictures();
+  Void  xFilterPicture ( const FilterJob& job );
+  Void  xFilterCtuRows ( TComPic* pcPic );
+
 public:
   TDecGop();
   virtual ~TDecGop();
@@ -97,8 +123,10 @@ public:
   Void  destroy ();
   Void  decompressSlice(TComInputBitstream* pcBitstream, TComPic* pcPic );
   Void  filterPicture  (TComPic* pcPic );
+  Void  waitForFilteredPictures();
 
   Void setDecodedPictureHashSEIEnabled(Int enabled) { m_decodedPictureHashSEIEnabled = enabled; }
+  Void setPipelineDepth(Int depth)                   { m_pipelineDepth = depth; }
   UInt getNumberOfChecksumErrorsDetected() const { return m_numberOfChecksumErrorsDetected; }
 
 };
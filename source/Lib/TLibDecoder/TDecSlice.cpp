@@ -37,6 +37,9 @@
 
 #include "TDecSlice.h"
 #include "TDecConformance.h"
+#include "TDecCtuWorker.h"
+
+#include <thread>
 
 //! \ingroup TLibDecoder
 //! \{
@@ -46,11 +49,18 @@
 //////////////////////////////////////////////////////////////////////
 
 TDecSlice::TDecSlice()
+: m_numCtuRows                 ( 0 )
+, m_wavefrontSyncContextStates ( NULL )
+, m_nextSubstream              ( 0 )
+, m_wavefrontLastSyncRow       ( -1 )
+, m_pcLastCtuDecoder           ( NULL )
+, m_boundingCtuTsAddr          ( 0 )
 {
 }
 
 TDecSlice::~TDecSlice()
 {
+  destroy();
 }
 
 Void TDecSlice::create()
@@ -59,16 +69,26 @@ Void TDecSlice::create()
 
 Void TDecSlice::destroy()
 {
+  delete [] m_wavefrontSyncContextStates;
+  m_wavefrontSyncContextStates = NULL;
+  m_numCtuRows                 = 0;
 }
 
-Void TDecSlice::init(TDecEntropy* pcEntropyDecoder, TDecCu* pcCuDecoder, TDecConformanceCheck *pDecConformanceCheck)
+/** Initialize the slice decoder.
+ * \param pcEntropyDecoder      entropy decoder
+ * \param pcCuDecoder           CU decoder
+ * \param pDecConformanceCheck  conformance checks of the decoder
+ * \param ctuWorkers            decoding objects of the threads decoding substreams in parallel (empty: single thread)
+ */
+Void TDecSlice::init(TDecEntropy* pcEntropyDecoder, TDecCu* pcCuDecoder, TDecConformanceCheck *pDecConformanceCheck, const std::vector<TDecCtuWorker*> &ctuWorkers)
 {
   m_pcEntropyDecoder     = pcEntropyDecoder;
   m_pcCuDecoder          = pcCuDecoder;
   m_pDecConformanceCheck = pDecConformanceCheck;
+  m_ctuWorkers           = ctuWorkers;
 }
 
-Void TDecSlice::decompressSlice(TComInputBitstream** ppcSubstreams, TComPic* pcPic, TDecSbac* pcSbacDecoder)
+Void TDecSlice::decompressSlice(TComInputBitstream** ppcSubstreams, TComPic* pcPic, TDecSbac* pcSbacDecoder, const UInt numSubstreams)
 {
   TComSlice* pcSlice                 = pcPic->getSlice(pcPic->getCurrSliceIdx());
 
@@ -80,14 +100,20 @@ Void TDecSlice::decompressSlice(TComInputBitstream** ppcSubstreams, TComPic* pcP
   const Bool depSliceSegmentsEnabled = pcSlice->getPPS()->getDependentSliceSegmentsEnabledFlag();
   const Bool wavefrontsEnabled       = pcSlice->getPPS()->getEntropyCodingSyncEnabledFlag();
 
-  m_pcEntropyDecoder->setEntropyDecoder ( pcSbacDecoder  );
-  m_pcEntropyDecoder->setBitstream      ( ppcSubstreams[0] );
-  m_pcEntropyDecoder->resetEntropy      (pcSlice);
-
   // decoder doesn't need prediction & residual frame buffer
   pcPic->setPicYuvPred( 0 );
   pcPic->setPicYuvResi( 0 );
 
+  if ( xUseCtuWorkers( pcPic, numSubstreams ) )
+  {
+    xDecompressSliceSubstreams( ppcSubstreams, pcPic, numSubstreams );
+    return;
+  }
+
+  m_pcEntropyDecoder->setEntropyDecoder ( pcSbacDecoder  );
+  m_pcEntropyDecoder->setBitstream      ( ppcSubstreams[0] );
+  m_pcEntropyDecoder->resetEntropy      (pcSlice);
+
 #if ENC_DEC_TRACE
   g_bJustDoIt = g_bEncDecTraceEnable;
 #endif
@@ -174,42 +200,7 @@ Void TDecSlice::decompressSlice(TComInputBitstream** ppcSubstreams, TComPic* pcP
     const UInt numRemainingBitsPriorToCtu=ppcSubstreams[uiSubStrm]->getNumBitsLeft();
 #endif
 
-    if ( pcSlice->getSPS()->getUseSAO() )
-    {
-      SAOBlkParam& saoblkParam = (pcPic->getPicSym()->getSAOBlkParam())[ctuRsAddr];
-      Bool bIsSAOSliceEnabled = false;
-      Bool sliceEnabled[MAX_NUM_COMPONENT];
-      for(Int comp=0; comp < MAX_NUM_COMPONENT; comp++)
-      {
-        ComponentID compId=ComponentID(comp);
-        sliceEnabled[compId] = pcSlice->getSaoEnabledFlag(toChannelType(compId)) && (comp < pcPic->getNumberValidComponents());
-        if (sliceEnabled[compId])
-        {
-          bIsSAOSliceEnabled=true;
-        }
-        saoblkParam[compId].modeIdc = SAO_MODE_OFF;
-      }
-      if (bIsSAOSliceEnabled)
-      {
-        Bool leftMergeAvail = false;
-        Bool aboveMergeAvail= false;
-
-        //merge left condition
-        Int rx = (ctuRsAddr % frameWidthInCtus);
-        if(rx > 0)
-        {
-          leftMergeAvail = pcPic->getSAOMergeAvailability(ctuRsAddr, ctuRsAddr-1);
-        }
-        //merge up condition
-        Int ry = (ctuRsAddr / frameWidthInCtus);
-        if(ry > 0)
-        {
-          aboveMergeAvail = pcPic->getSAOMergeAvailability(ctuRsAddr, ctuRsAddr-frameWidthInCtus);
-        }
-
-        pcSbacDecoder->parseSAOBlkParam( saoblkParam, sliceEnabled, leftMergeAvail, aboveMergeAvail, pcSlice->getSPS()->getBitDepths());
-      }
-    }
+    xDecodeSao( pcSbacDecoder, pcPic, ctuRsAddr );
 
     m_pcCuDecoder->decodeCtu     ( pCtu, isLastCtuOfSliceSegment );
 
@@ -270,4 +261,315 @@ Void TDecSlice::decompressSlice(TComInputBitstream** ppcSubstreams, TComPic* pcP
 
 }
 
+/** Parse the SAO parameters of a CTU, if SAO is enabled in the slice.
+ * \param pcSbacDecoder  SBAC decoder reading the substream of the CTU
+ * \param pcPic          picture class
+ * \param ctuRsAddr      raster scan address of the CTU
+ */
+Void TDecSlice::xDecodeSao( TDecSbac* pcSbacDecoder, TComPic* pcPic, const UInt ctuRsAddr )
+{
+  const TComSlice* pcSlice          = pcPic->getSlice(pcPic->getCurrSliceIdx());
+  const UInt       frameWidthInCtus = pcPic->getPicSym()->getFrameWidthInCtus();
+
+  if ( pcSlice->getSPS()->getUseSAO() )
+  {
+    SAOBlkParam& saoblkParam = (pcPic->getPicSym()->getSAOBlkParam())[ctuRsAddr];
+    Bool bIsSAOSliceEnabled = false;
+    Bool sliceEnabled[MAX_NUM_COMPONENT];
+    for(Int comp=0; comp < MAX_NUM_COMPONENT; comp++)
+    {
+      ComponentID compId=ComponentID(comp);
+      sliceEnabled[compId] = pcSlice->getSaoEnabledFlag(toChannelType(compId)) && (comp < pcPic->getNumberValidComponents());
+      if (sliceEnabled[compId])
+      {
+        bIsSAOSliceEnabled=true;
+      }
+      saoblkParam[compId].modeIdc = SAO_MODE_OFF;
+    }
+    if (bIsSAOSliceEnabled)
+    {
+      Bool leftMergeAvail = false;
+      Bool aboveMergeAvail= false;
+
+      //merge left condition
+      Int rx = (ctuRsAddr % frameWidthInCtus);
+      if(rx > 0)
+      {
+        leftMergeAvail = pcPic->getSAOMergeAvailability(ctuRsAddr, ctuRsAddr-1);
+      }
+      //merge up condition
+      Int ry = (ctuRsAddr / frameWidthInCtus);
+      if(ry > 0)
+      {
+        aboveMergeAvail = pcPic->getSAOMergeAvailability(ctuRsAddr, ctuRsAddr-frameWidthInCtus);
+      }
+
+      pcSbacDecoder->parseSAOBlkParam( saoblkParam, sliceEnabled, leftMergeAvail, aboveMergeAvail, pcSlice->getSPS()->getBitDepths());
+    }
+  }
+}
+
+/** Check whether the substreams of the current slice segment can be decoded by the substream threads: the CTU rows
+ * of a slice segment with wavefronts and a single tile, or the tiles of a slice segment without wavefronts.
+ * A slice segment with more than one substream starts at the beginning of a CTU row or tile.
+ * \param pcPic          picture class
+ * \param numSubstreams  number of substreams of the slice segment
+ */
+Bool TDecSlice::xUseCtuWorkers( TComPic* pcPic, const UInt numSubstreams )
+{
+#if ENC_DEC_TRACE
+  return false; // the trace of the substreams would be interleaved
+#else
+  if ( m_ctuWorkers.size() < 2 || numSubstreams < 2 )
+  {
+    return false;
+  }
+  const TComSlice* pcSlice        = pcPic->getSlice(pcPic->getCurrSliceIdx());
+  const UInt       startCtuRsAddr = pcPic->getPicSym()->getCtuTsToRsAddrMap(pcSlice->getSliceSegmentCurStartCtuTsAddr());
+  const UInt       numTiles       = pcPic->getPicSym()->getNumTiles();
+  if ( pcSlice->getPPS()->getEntropyCodingSyncEnabledFlag() )
+  {
+    return numTiles == 1 && startCtuRsAddr % pcPic->getPicSym()->getFrameWidthInCtus() == 0;
+  }
+  const UInt startTileIdx = pcPic->getPicSym()->getTileIdxMap(startCtuRsAddr);
+  return numTiles > 1 && startCtuRsAddr == pcPic->getPicSym()->getTComTile(startTileIdx)->getFirstCtuRsAddr()
+      && startTileIdx + numSubstreams <= numTiles;
+#endif
+}
+
+/** Decode the substreams of a slice segment with the substream threads.
+ * With wavefronts, a CTU is decoded once the CTU above and to its right is done, which also provides the contexts at
+ * the start of the row. Tiles are decoded independently, so the output is the same as with the serial loop.
+ * \param ppcSubstreams  substreams of the slice segment
+ * \param pcPic          picture class
+ * \param numSubstreams  number of substreams of the slice segment
+ */
+Void TDecSlice::xDecompressSliceSubstreams( TComInputBitstream** ppcSubstreams, TComPic* pcPic, const UInt numSubstreams )
+{
+  TComSlice* pcSlice                 = pcPic->getSlice(pcPic->getCurrSliceIdx());
+  const UInt startCtuTsAddr          = pcSlice->getSliceSegmentCurStartCtuTsAddr();
+  const Bool wavefrontsEnabled       = pcSlice->getPPS()->getEntropyCodingSyncEnabledFlag();
+
+  m_nextSubstream        = 0;
+  m_wavefrontLastSyncRow = -1;
+  m_pcLastCtuDecoder     = NULL;
+
+  if ( wavefrontsEnabled )
+  {
+    const UInt frameHeightInCtus = pcPic->getPicSym()->getFrameHeightInCtus();
+    if ( m_numCtuRows < frameHeightInCtus )
+    {
+      delete [] m_wavefrontSyncContextStates;
+      m_wavefrontSyncContextStates = new TDecSbac[frameHeightInCtus];
+      m_numCtuRows                 = frameHeightInCtus;
+    }
+    m_wavefrontRowProgress.assign( frameHeightInCtus, 0 );
+  }
+  else
+  {
+    // initialise all CTUs up front: the neighbour derivation compares the slice of a CTU in another tile
+    // before rejecting it for the tile, so that slice must be set before any thread starts
+    const UInt lastTileIdx       = pcPic->getPicSym()->getTileIdxMap(pcPic->getPicSym()->getCtuTsToRsAddrMap(startCtuTsAddr)) + numSubstreams - 1;
+    const TComTile *pLastTile    = pcPic->getPicSym()->getTComTile( lastTileIdx );
+    const UInt boundingCtuTsAddr = pcPic->getPicSym()->getCtuRsToTsAddrMap( pLastTile->getFirstCtuRsAddr() ) + pLastTile->getTileWidthInCtus() * pLastTile->getTileHeightInCtus();
+    for( UInt ctuTsAddr = startCtuTsAddr; ctuTsAddr < boundingCtuTsAddr; ++ctuTsAddr )
+    {
+      const UInt ctuRsAddr = pcPic->getPicSym()->getCtuTsToRsAddrMap(ctuTsAddr);
+      pcPic->getCtu( ctuRsAddr )->initCtu( pcPic, ctuRsAddr );
+    }
+  }
+
+  std::vector<std::thread> threads;
+  for ( std::size_t i = 1; i < m_ctuWorkers.size() && i < numSubstreams; i++ )
+  {
+    threads.push_back( std::thread( &TDecSlice::xDecompressSubstreams, this, m_ctuWorkers[i], ppcSubstreams, pcPic, numSubstreams ) );
+  }
+  xDecompressSubstreams( m_ctuWorkers[0], ppcSubstreams, pcPic, numSubstreams );
+  for ( std::size_t i = 0; i < threads.size(); i++ )
+  {
+    threads[i].join();
+  }
+
+  assert( m_pcLastCtuDecoder != NULL );
+
+  if(!pcSlice->getDependentSliceSegmentFlag())
+  {
+    pcSlice->setSliceCurEndCtuTsAddr( m_boundingCtuTsAddr );
+  }
+  pcSlice->setSliceSegmentCurEndCtuTsAddr( m_boundingCtuTsAddr );
+
+  if( pcSlice->getPPS()->getDependentSliceSegmentsEnabledFlag() )
+  {
+    m_lastSliceSegmentEndContextState.loadContexts( m_pcLastCtuDecoder );//ctx end of dep.slice
+    if ( m_wavefrontLastSyncRow >= 0 )
+    {
+      m_entropyCodingSyncContextState.loadContexts( &m_wavefrontSyncContextStates[m_wavefrontLastSyncRow] );
+    }
+  }
+}
+
+/** Decode substreams handed out by xDecompressSliceSubstreams until all substreams of the slice segment are taken.
+ * \param pcWorker       decoding objects of the thread
+ * \param ppcSubstreams  substreams of the slice segment
+ * \param pcPic          picture class
+ * \param numSubstreams  number of substreams of the slice segment
+ */
+Void TDecSlice::xDecompressSubstreams( TDecCtuWorker* pcWorker, TComInputBitstream** ppcSubstreams, TComPic* pcPic, const UInt numSubstreams )
+{
+  TComSlice* pcSlice                 = pcPic->getSlice(pcPic->getCurrSliceIdx());
+  const UInt startCtuTsAddr          = pcSlice->getSliceSegmentCurStartCtuTsAddr();
+  const UInt startCtuRsAddr          = pcPic->getPicSym()->getCtuTsToRsAddrMap(startCtuTsAddr);
+  const UInt frameWidthInCtus        = pcPic->getPicSym()->getFrameWidthInCtus();
+  const UInt firstRow                = startCtuRsAddr / frameWidthInCtus;
+  const UInt startTileIdx            = pcPic->getPicSym()->getTileIdxMap(startCtuRsAddr);
+  const Bool wavefrontsEnabled       = pcSlice->getPPS()->getEntropyCodingSyncEnabledFlag();
+  TDecEntropy* pcEntropyDecoder      = pcWorker->getEntropyDecoder();
+  TDecSbac*    pcSbacDecoder         = pcWorker->getSbacDecoder();
+  TDecCu*      pcCuDecoder           = pcWorker->getCuDecoder();
+
+  for ( ; ; )
+  {
+    UInt substream;
+    {
+      std::lock_guard<std::mutex> lock( m_substreamMutex );
+      substream = m_nextSubstream++;
+    }
+    if ( substream >= numSubstreams )
+    {
+      break;
+    }
+
+    // the CTUs of a substream are consecutive in tile scan: a CTU row of the single tile, or a whole tile
+    const UInt row = firstRow + substream;
+    UInt substreamStartCtuTsAddr;
+    UInt substreamBoundingCtuTsAddr;
+    if ( wavefrontsEnabled )
+    {
+      substreamStartCtuTsAddr    = std::max( startCtuTsAddr, row * frameWidthInCtus );
+      substreamBoundingCtuTsAddr = ( row + 1 ) * frameWidthInCtus;
+    }
+    else
+    {
+      const TComTile *pTile      = pcPic->getPicSym()->getTComTile( startTileIdx + substream );
+      substreamStartCtuTsAddr    = pcPic->getPicSym()->getCtuRsToTsAddrMap( pTile->getFirstCtuRsAddr() );
+      substreamBoundingCtuTsAddr = substreamStartCtuTsAddr + pTile->getTileWidthInCtus() * pTile->getTileHeightInCtus();
+    }
+
+    Bool isLastCtuOfSliceSegment = false;
+    for( UInt ctuTsAddr = substreamStartCtuTsAddr; !isLastCtuOfSliceSegment && ctuTsAddr < substreamBoundingCtuTsAddr; ctuTsAddr++ )
+    {
+      const UInt ctuRsAddr     = pcPic->getPicSym()->getCtuTsToRsAddrMap(ctuTsAddr);
+      const UInt ctuXPosInCtus = ctuRsAddr % frameWidthInCtus;
+      TComDataCU* pCtu         = pcPic->getCtu( ctuRsAddr );
+
+      if ( wavefrontsEnabled )
+      {
+        // wait for the CTU above and to the right (above for the last CTU of the row)
+        if ( row > firstRow )
+        {
+          const UInt requiredProgress = std::min( ctuXPosInCtus + 2, frameWidthInCtus );
+          std::unique_lock<std::mutex> lock( m_substreamMutex );
+          while ( m_wavefrontRowProgress[row - 1] < requiredProgress )
+          {
+            m_wavefrontProgressCond.wait( lock );
+          }
+        }
+        pCtu->initCtu( pcPic, ctuRsAddr );
+      }
+
+      // set up CABAC contexts' state for the first CTU of the substream, as in the serial loop
+      if ( ctuTsAddr == substreamStartCtuTsAddr )
+      {
+        pcEntropyDecoder->setBitstream( ppcSubstreams[substream] );
+        pcEntropyDecoder->resetEntropy( pcSlice );
+
+        if ( ctuTsAddr == startCtuTsAddr && pcSlice->getDependentSliceSegmentFlag() )
+        {
+          const TComTile *pCurrentTile = pcPic->getPicSym()->getTComTile(startTileIdx);
+          if ( startCtuRsAddr != pCurrentTile->getFirstCtuRsAddr() && ( pCurrentTile->getTileWidthInCtus() >= 2 || !wavefrontsEnabled ) )
+          {
+            pcSbacDecoder->loadContexts( &m_lastSliceSegmentEndContextState );
+          }
+        }
+        if ( wavefrontsEnabled && ctuXPosInCtus == 0 )
+        {
+          // Synchronize cabac probabilities with upper-right CTU if it's available: stored by the thread of the row
+          // above, or at the end of the previous slice segment for the first row
+          TComDataCU *pCtuUp = pCtu->getCtuAbove();
+          if ( pCtuUp && ( ctuXPosInCtus + 1 ) < frameWidthInCtus )
+          {
+            TComDataCU *pCtuTR = pcPic->getCtu( ctuRsAddr - frameWidthInCtus + 1 );
+            if ( pCtu->CUIsFromSameSliceAndTile(pCtuTR) )
+            {
+              pcSbacDecoder->loadContexts( row > firstRow ? &m_wavefrontSyncContextStates[row - 1] : &m_entropyCodingSyncContextState );
+            }
+          }
+        }
+      }
+
+#if DECODER_PARTIAL_CONFORMANCE_CHECK != 0
+      const UInt numRemainingBitsPriorToCtu=ppcSubstreams[substream]->getNumBitsLeft();
+#endif
+
+      xDecodeSao( pcSbacDecoder, pcPic, ctuRsAddr );
+
+      pcCuDecoder->decodeCtu     ( pCtu, isLastCtuOfSliceSegment );
+
+#if DECODER_PARTIAL_CONFORMANCE_CHECK != 0
+      const UInt numRemainingBitsPostCtu=ppcSubstreams[substream]->getNumBitsLeft();
+      if (TDecConformanceCheck::doChecking() && m_pDecConformanceCheck)
+      {
+        m_pDecConformanceCheck->checkCtuDecoding(numRemainingBitsPriorToCtu-numRemainingBitsPostCtu);
+      }
+#endif
+
+      pcCuDecoder->decompressCtu ( pCtu );
+
+      //Store probabilities of second CTU in line into buffer, for the start of the next row
+      if ( wavefrontsEnabled && ctuXPosInCtus == 1 )
+      {
+        m_wavefrontSyncContextStates[row].loadContexts( pcSbacDecoder );
+      }
+
+      if (isLastCtuOfSliceSegment)
+      {
+#if DECODER_CHECK_SUBSTREAM_AND_SLICE_TRAILING_BYTES
+        pcSbacDecoder->parseRemainingBytes(false);
+#endif
+      }
+      else if ( ctuTsAddr + 1 == substreamBoundingCtuTsAddr )
+      {
+        // The sub-stream should be terminated after this CTU (end of tile, end of wavefront-CTU-row)
+        UInt binVal;
+        pcSbacDecoder->parseTerminatingBit( binVal );
+        assert( binVal );
+#if DECODER_CHECK_SUBSTREAM_AND_SLICE_TRAILING_BYTES
+        pcSbacDecoder->parseRemainingBytes(true);
+#endif
+      }
+
+      {
+        std::lock_guard<std::mutex> lock( m_substreamMutex );
+        if ( wavefrontsEnabled )
+        {
+          m_wavefrontRowProgress[row] = ctuXPosInCtus + 1;
+          if ( ctuXPosInCtus == 1 )
+          {
+            m_wavefrontLastSyncRow = std::max( m_wavefrontLastSyncRow, (Int)row );
+          }
+        }
+        if ( isLastCtuOfSliceSegment )
+        {
+          m_pcLastCtuDecoder  = pcSbacDecoder;
+          m_boundingCtuTsAddr = ctuTsAddr + 1;
+        }
+      }
+      if ( wavefrontsEnabled )
+      {
+        m_wavefrontProgressCond.notify_all();
+      }
+    }
+  }
+}
+
 //! \}
@@ -42,6 +42,10 @@
 #pragma once
 #endif // _MSC_VER > 1000
 
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+
 #include "TLibCommon/CommonDef.h"
 #include "TLibCommon/TComBitStream.h"
 #include "TLibCommon/TComPic.h"
@@ -58,6 +62,7 @@
 // ====================================================================================================================
 
 class TDecConformanceCheck;
+class TDecCtuWorker;
 
 /// slice decoder class
 class TDecSlice
@@ -70,15 +75,33 @@ private:
 
   TDecSbac        m_lastSliceSegmentEndContextState;    ///< context storage for state at the end of the previous slice-segment (used for dependent slices only).
   TDecSbac        m_entropyCodingSyncContextState;      ///< context storate for state of contexts at the wavefront/WPP/entropy-coding-sync second CTU of tile-row
+
+  // substream threads
+  std::vector<TDecCtuWorker*> m_ctuWorkers;             ///< decoding objects of the threads decoding CTU rows or tiles in parallel
+  UInt                    m_numCtuRows;                 ///< number of CTU rows of the context buffers below
+  TDecSbac*               m_wavefrontSyncContextStates; ///< state of contexts at the second CTU of each CTU row
+  std::mutex              m_substreamMutex;             ///< protects the substream hand-out and the progress below
+  std::condition_variable m_wavefrontProgressCond;      ///< signalled when a CTU row has made progress
+  UInt                    m_nextSubstream;              ///< next substream to be handed to a thread
+  std::vector<UInt>       m_wavefrontRowProgress;       ///< number of decoded CTU columns in each row
+  Int                     m_wavefrontLastSyncRow;       ///< last CTU row whose contexts after its second CTU were stored
+  TDecSbac*               m_pcLastCtuDecoder;           ///< SBAC decoder that decoded the last CTU of the slice segment
+  UInt                    m_boundingCtuTsAddr;          ///< CTU after the last CTU of the slice segment
+
+  Bool  xUseCtuWorkers    ( TComPic* pcPic, const UInt numSubstreams );
+  Void  xDecodeSao        ( TDecSbac* pcSbacDecoder, TComPic* pcPic, const UInt ctuRsAddr );
+  Void  xDecompressSliceSubstreams( TComInputBitstream** ppcSubstreams, TComPic* pcPic, const UInt numSubstreams );
+  Void  xDecompressSubstreams( TDecCtuWorker* pcWorker, TComInputBitstream** ppcSubstreams, TComPic* pcPic, const UInt numSubstreams );
+
 public:
   TDecSlice();
   virtual ~TDecSlice();
 
-  Void  init              ( TDecEntropy* pcEntropyDecoder, TDecCu* pcMbDecoder, TDecConformanceCheck *pDecConformanceCheck );
+  Void  init              ( TDecEntropy* pcEntropyDecoder, TDecCu* pcMbDecoder, TDecConformanceCheck *pDecConformanceCheck, const std::vector<TDecCtuWorker*> &ctuWorkers );
   Void  create            ();
   Void  destroy           ();
 
-  Void  decompressSlice   ( TComInputBitstream** ppcSubstreams,   TComPic* pcPic, TDecSbac* pcSbacDecoder );
+  Void  decompressSlice   ( TComInputBitstream** ppcSubstreams,   TComPic* pcPic, TDecSbac* pcSbacDecoder, const UInt numSubstreams );
 };
 
 //! \}
@@ -63,6 +63,9 @@ TDecTop::TDecTop()
   , m_seiReader()
   , m_cLoopFilter()
   , m_cSAO()
+  , m_numCtuThreads(1)
+  , m_pipelineDepth(0)
+  , m_ctuWorkers()
   , m_pcPic(NULL)
   , m_prevPOC(MAX_INT)
   , m_prevTid0POC(0)
@@ -129,14 +132,33 @@ Void TDecTop::destroy()
   m_apcSlicePilot = NULL;
 
   m_cSliceDecoder.destroy();
+
+  for ( std::size_t i = 0; i < m_ctuWorkers.size(); i++ )
+  {
+    delete m_ctuWorkers[i];
+  }
+  m_ctuWorkers.clear();
 }
 
 Void TDecTop::init()
 {
   // initialize ROM
   initROM();
+
+  // the threads decoding the substreams of a slice segment in parallel each have their own decoding objects
+  if ( m_numCtuThreads > 1 && m_ctuWorkers.empty() )
+  {
+    m_ctuWorkers.resize( m_numCtuThreads );
+    for ( std::size_t i = 0; i < m_ctuWorkers.size(); i++ )
+    {
+      m_ctuWorkers[i] = new TDecCtuWorker;
+      m_ctuWorkers[i]->init( &m_conformanceCheck );
+    }
+  }
+
   m_cGopDecoder.init( &m_cEntropyDecoder, &m_cSbacDecoder, &m_cBinCABAC, &m_cCavlcDecoder, &m_cSliceDecoder, &m_cLoopFilter, &m_cSAO);
-  m_cSliceDecoder.init( &m_cEntropyDecoder, &m_cCuDecoder, &m_conformanceCheck );
+  m_cGopDecoder.setPipelineDepth( m_pipelineDepth );
+  m_cSliceDecoder.init( &m_cEntropyDecoder, &m_cCuDecoder, &m_conformanceCheck, m_ctuWorkers );
 #if MCTS_ENC_CHECK
   m_cEntropyDecoder.init(&m_cPrediction, &m_conformanceCheck );
 #else
@@ -152,6 +174,7 @@ Void TDecTop::deletePicBuffer ( )
   for (Int i = 0; i < iSize; i++ )
   {
     TComPic* pcPic = *(iterPic++);
+    pcPic->waitForPipeline();
     pcPic->destroy();
 
     delete pcPic;
@@ -227,6 +250,7 @@ Void TDecTop::xGetNewPicBuffer ( const TComSPS &sps, const TComPPS &pps, TComPic
     rpcPic = new TComPic();
     m_cListPic.pushBack( rpcPic );
   }
+  rpcPic->waitForPipeline();
   rpcPic->destroy();
 #if REDUCED_ENCODER_MEMORY
   rpcPic->create ( sps, pps, false, true
@@ -267,6 +291,10 @@ Void TDecTop::executeLoopFilters(Int& poc, TComList<TComPic*>*& rpcListPic)
   poc                 = pcPic->getSlice(m_uiSliceIdx-1)->getPOC();
   rpcListPic          = &m_cListPic;
   m_cCuDecoder.destroy();
+  for ( std::size_t i = 0; i < m_ctuWorkers.size(); i++ )
+  {
+    m_ctuWorkers[i]->destroy();
+  }
   m_bFirstSliceInPicture  = true;
 
   return;
@@ -315,6 +343,7 @@ Void TDecTop::xCreateLostPicture(Int iLostPoc)
     if(abs(rpcPic->getPicSym()->getSlice(0)->getPOC() -iLostPoc)==closestPoc&&rpcPic->getPicSym()->getSlice(0)->getPOC()!=m_apcSlicePilot->getPOC())
     {
       printf("copying picture %d to %d (%d)\n",rpcPic->getPicSym()->getSlice(0)->getPOC() ,iLostPoc,m_apcSlicePilot->getPOC());
+      rpcPic->waitForFinishedCtuRows(rpcPic->getFrameHeightInCtus());
       rpcPic->getPicYuvRec()->copyToPic(cFillPic->getPicYuvRec());
       break;
     }
@@ -378,6 +407,12 @@ Void TDecTop::xActivateParameterSets()
 
     //  Get a new picture buffer. This will also set up m_pcPic, and therefore give us a SPS and PPS pointer that we can use.
     xGetNewPicBuffer (*(sps), *(pps), m_pcPic, m_apcSlicePilot->getTLayer());
+    if ( m_pipelineDepth > 0 )
+    {
+      // the picture is referenced CTU row by CTU row while it is filtered, and its border is extended by the filter thread
+      m_pcPic->setNumFinishedCtuRows( 0 );
+      m_pcPic->getPicYuvRec()->setBorderExtension( true );
+    }
     m_apcSlicePilot->applyReferencePictureSet(m_cListPic, m_apcSlicePilot->getRPS());
 #if JVET_X0048_X0103_FILM_GRAIN
     // Initialization of film grain synthesizer 
@@ -395,9 +430,7 @@ Void TDecTop::xActivateParameterSets()
     pps=pSlice->getPPS();
     sps=pSlice->getSPS();
 
-    // Initialise the various objects for the new set of settings
-    m_cSAO.create( sps->getPicWidthInLumaSamples(), sps->getPicHeightInLumaSamples(), sps->getChromaFormatIdc(), sps->getMaxCUWidth(), sps->getMaxCUHeight(), sps->getMaxTotalCUDepth(), pps->getPpsRangeExtension().getLog2SaoOffsetScale(CHANNEL_TYPE_LUMA), pps->getPpsRangeExtension().getLog2SaoOffsetScale(CHANNEL_TYPE_CHROMA) );
-    m_cLoopFilter.create( sps->getMaxTotalCUDepth() );
+    // Initialise the various objects for the new set of settings (SAO and deblocking are set up by TDecGop::filterPicture)
     m_cPrediction.initTempBuff(sps->getChromaFormatIdc());
 
 
@@ -428,6 +461,11 @@ Void TDecTop::xActivateParameterSets()
   {
 #endif
       // Recursive structure
+      if ( m_pipelineDepth > 0 && !m_cCuDecoder.isCreatedFor( sps->getMaxTotalCUDepth(), sps->getMaxCUWidth(), sps->getMaxCUHeight() ) )
+      {
+        // the partition tables used by the filter thread change with the CTU size
+        m_cGopDecoder.waitForFilteredPictures();
+      }
       m_cCuDecoder.create ( sps->getMaxTotalCUDepth(), sps->getMaxCUWidth(), sps->getMaxCUHeight(), sps->getChromaFormatIdc() );
   #if MCTS_ENC_CHECK
       m_cCuDecoder.init   ( &m_cEntropyDecoder, &m_cTrQuant, &m_cPrediction, &m_conformanceCheck );
@@ -435,6 +473,10 @@ Void TDecTop::xActivateParameterSets()
       m_cCuDecoder.init(&m_cEntropyDecoder, &m_cTrQuant, &m_cPrediction);
   #endif
       m_cTrQuant.init     ( sps->getMaxTrSize() );
+      for ( std::size_t i = 0; i < m_ctuWorkers.size(); i++ )
+      {
+        m_ctuWorkers[i]->create( *sps );
+      }
 
       m_cSliceDecoder.create();
     }
@@ -774,6 +816,27 @@ Bool TDecTop::xDecodeSlice(InputNALUnit &nalu, Int &iSkipFrame, Int iPOCLastDisp
   }
 
   m_pcPic->setCurrSliceIdx(m_uiSliceIdx);
+  xSetScalingList(m_cTrQuant, pcSlice);
+  for ( std::size_t i = 0; i < m_ctuWorkers.size(); i++ )
+  {
+    xSetScalingList(*m_ctuWorkers[i]->getTrQuant(), pcSlice);
+  }
+
+  //  Decode a picture
+  m_cGopDecoder.decompressSlice(&(nalu.getBitstream()), m_pcPic);
+
+  m_bFirstSliceInPicture = false;
+  m_uiSliceIdx++;
+
+  return false;
+}
+
+/** Set up the dequantisation of a transform & quantization class for the scaling lists of a slice.
+ * \param trQuant  transform & quantization class
+ * \param pcSlice  slice to be decoded
+ */
+Void TDecTop::xSetScalingList(TComTrQuant &trQuant, const TComSlice *pcSlice)
+{
   if(pcSlice->getSPS()->getScalingListFlag())
   {
     TComScalingList scalingList;
@@ -789,8 +852,8 @@ Bool TDecTop::xDecodeSlice(InputNALUnit &nalu, Int &iSkipFrame, Int iPOCLastDisp
     {
       scalingList.setDefaultScalingList();
     }
-    m_cTrQuant.setScalingListDec(scalingList);
-    m_cTrQuant.setUseScalingList(true);
+    trQuant.setScalingListDec(scalingList);
+    trQuant.setUseScalingList(true);
   }
   else
   {
@@ -799,17 +862,9 @@ Bool TDecTop::xDecodeSlice(InputNALUnit &nalu, Int &iSkipFrame, Int iPOCLastDisp
         pcSlice->getSPS()->getMaxLog2TrDynamicRange(CHANNEL_TYPE_LUMA),
         pcSlice->getSPS()->getMaxLog2TrDynamicRange(CHANNEL_TYPE_CHROMA)
     };
-    m_cTrQuant.setFlatScalingList(maxLog2TrDynamicRange, pcSlice->getSPS()->getBitDepths());
-    m_cTrQuant.setUseScalingList(false);
+    trQuant.setFlatScalingList(maxLog2TrDynamicRange, pcSlice->getSPS()->getBitDepths());
+    trQuant.setUseScalingList(false);
   }
-
-  //  Decode a picture
-  m_cGopDecoder.decompressSlice(&(nalu.getBitstream()), m_pcPic);
-
-  m_bFirstSliceInPicture = false;
-  m_uiSliceIdx++;
-
-  return false;
 }
 
 Void TDecTop::xDecodeVPS(const std::vector<UChar> &naluData)
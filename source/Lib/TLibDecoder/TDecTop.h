@@ -50,6 +50,7 @@
 #include "TDecEntropy.h"
 #include "TDecSbac.h"
 #include "TDecCAVLC.h"
+#include "TDecCtuWorker.h"
 #include "SEIread.h"
 #include "TDecConformance.h"
 
@@ -92,6 +93,9 @@ private:
   TComLoopFilter          m_cLoopFilter;
   TComSampleAdaptiveOffset m_cSAO;
   TDecConformanceCheck    m_conformanceCheck;
+  Int                     m_numCtuThreads;                ///< number of threads decoding the substreams of a slice segment
+  Int                     m_pipelineDepth;                ///< maximum number of pictures being filtered while the next pictures are decoded (0: no pipelining)
+  std::vector<TDecCtuWorker*> m_ctuWorkers;               ///< decoding objects of the threads decoding substreams in parallel
 
   Bool isSkipPictureForBLA(Int& iPOCLastDisplay);
   Bool isRandomAccessSkipPicture(Int& iSkipFrame,  Int& iPOCLastDisplay);
@@ -134,6 +138,8 @@ public:
   Void  create  ();
   Void  destroy ();
 
+  Void setNumCtuThreads(Int numCtuThreads) { m_numCtuThreads = numCtuThreads; } ///< must be set before init()
+  Void setPipelineDepth(Int depth)          { m_pipelineDepth = depth; }          ///< must be set before init()
   Void setDecodedPictureHashSEIEnabled(Int enabled) { m_cGopDecoder.setDecodedPictureHashSEIEnabled(enabled); }
 #if MCTS_ENC_CHECK
   Void setTMctsCheckEnabled(Bool enabled) { m_tmctsCheckEnabled = enabled; }
@@ -180,6 +186,7 @@ protected:
   Bool      xDecodeSlice(InputNALUnit &nalu, Int &iSkipFrame, Int iPOCLastDisplay);
   Void      xActivateParameterSets();
 #endif
+  Void      xSetScalingList(TComTrQuant &trQuant, const TComSlice *pcSlice);
   Void      xDecodeVPS(const std::vector<UChar> &naluData);
   Void      xDecodeSPS(const std::vector<UChar> &naluData);
   Void      xDecodePPS(const std::vector<UChar> &naluData);
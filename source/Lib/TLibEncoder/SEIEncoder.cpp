@@ -1470,6 +1470,55 @@ Bool SEIEncoder::initSEIAnnotatedRegions(SEIAnnotatedRegions* SEIAnnoReg, Int cu
   }
   return true;
 }
+
+/** Annotated regions derived from the ROI mask: one object per connected foreground region, without labels.
+ * Objects persist until they change, so only new or moved objects and cancellations are sent. Refresh pictures
+ * (IRAP) repeat all objects, so that decoding can start there.
+ */
+Bool SEIEncoder::initSEIAnnotatedRegionsFromRoiMap(SEIAnnotatedRegions *sei, const TEncRoiMap *roiMap, Bool refresh)
+{
+  assert(m_isInitialized);
+  assert(sei != NULL);
+  assert(roiMap != NULL);
+
+  sei->m_hdr.m_cancelFlag = false;
+  sei->m_hdr.m_notOptimizedForViewingFlag = false;
+  sei->m_hdr.m_trueMotionFlag = false;
+  sei->m_hdr.m_occludedObjectFlag = false;
+  sei->m_hdr.m_partialObjectFlagPresentFlag = false;
+  sei->m_hdr.m_objectLabelPresentFlag = false;
+  sei->m_hdr.m_objectConfidenceInfoPresentFlag = false;
+  sei->m_hdr.m_objectConfidenceLength = 0;
+  sei->m_hdr.m_objectLabelLanguagePresentFlag = false;
+  sei->m_annotatedLabels.clear();
+  sei->m_annotatedRegions.clear();
+
+  const std::vector<UInt> &cancelled = roiMap->getCancelledObjects();
+  for (std::size_t i = 0; i < cancelled.size(); i++)
+  {
+    SEIAnnotatedRegions::AnnotatedRegionObject ar;
+    ar.objectCancelFlag = true;
+    sei->m_annotatedRegions.push_back(std::make_pair(cancelled[i], ar));
+  }
+
+  const std::vector<TEncRoiMap::RoiObject> &objects = roiMap->getObjects();
+  for (std::size_t i = 0; i < objects.size(); i++)
+  {
+    if (refresh || objects[i].changed)
+    {
+      SEIAnnotatedRegions::AnnotatedRegionObject ar;
+      ar.boundingBoxValid = true;
+      ar.boundingBoxCancelFlag = false;
+      ar.boundingBoxTop = objects[i].top;
+      ar.boundingBoxLeft = objects[i].left;
+      ar.boundingBoxWidth = objects[i].width;
+      ar.boundingBoxHeight = objects[i].height;
+      sei->m_annotatedRegions.push_back(std::make_pair(objects[i].idx, ar));
+    }
+  }
+  return refresh || !sei->m_annotatedRegions.empty();
+}
+
 Void SEIEncoder::initSEIChromaResamplingFilterHint(SEIChromaResamplingFilterHint *seiChromaResamplingFilterHint, Int iHorFilterIndex, Int iVerFilterIndex)
 {
   assert (m_isInitialized);
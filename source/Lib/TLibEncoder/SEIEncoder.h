@@ -42,6 +42,7 @@
 class TEncCfg;
 class TEncTop;
 class TEncGOP;
+class TEncRoiMap;
 
 
 //! Initializes different SEI message types based on given encoder configuration parameters 
@@ -109,6 +110,7 @@ public:
   Void readRNSEIWindow(std::istream &fic, RNSEIWindowVec::iterator regionIter, Bool &failed );
   Bool initSEIAnnotatedRegions(SEIAnnotatedRegions *sei, Int currPOC);
   Void readAnnotatedRegionSEI(std::istream &fic, SEIAnnotatedRegions *seiAnnoRegion, Bool &failed);
+  Bool initSEIAnnotatedRegionsFromRoiMap(SEIAnnotatedRegions *sei, const TEncRoiMap *roiMap, Bool refresh); // returns false if there is nothing to update
 #if JCTVC_AD0021_SEI_MANIFEST
   Void initSEISEIManifest(SEIManifest* seiSeiManifest, const SEIMessages& seiMessage);
 #endif
@@ -1593,25 +1593,25 @@ Void SEIWriter::xWriteSEIAnnotatedRegions(const SEIAnnotatedRegions &sei, const
         }
         WRITE_CODE('\0', 8, "ar_label_language");
       }
-    }
-    WRITE_UVLC((UInt)sei.m_annotatedLabels.size(), "ar_num_label_updates");
-    assert(sei.m_annotatedLabels.size()<256);
-    for(auto it=sei.m_annotatedLabels.begin(); it!=sei.m_annotatedLabels.end(); it++)
-    {
-      assert(it->first < 256);
-      WRITE_UVLC(it->first, "ar_label_idx[]");
-      const SEIAnnotatedRegions::AnnotatedRegionLabel &ar=it->second;
-      WRITE_FLAG(!ar.labelValid, "ar_label_cancel_flag");
-      if (ar.labelValid)
+      WRITE_UVLC((UInt)sei.m_annotatedLabels.size(), "ar_num_label_updates");
+      assert(sei.m_annotatedLabels.size()<256);
+      for(auto it=sei.m_annotatedLabels.begin(); it!=sei.m_annotatedLabels.end(); it++)
       {
-        xWriteByteAlign();
-        assert(ar.label.size()<256);
-        for (UInt j = 0; j < ar.label.size(); j++)
+        assert(it->first < 256);
+        WRITE_UVLC(it->first, "ar_label_idx[]");
+        const SEIAnnotatedRegions::AnnotatedRegionLabel &ar=it->second;
+        WRITE_FLAG(!ar.labelValid, "ar_label_cancel_flag");
+        if (ar.labelValid)
         {
-          UChar ch = ar.label[j];
-          WRITE_CODE(ch, 8, "ar_label[]");
+          xWriteByteAlign();
+          assert(ar.label.size()<256);
+          for (UInt j = 0; j < ar.label.size(); j++)
+          {
+            UChar ch = ar.label[j];
+            WRITE_CODE(ch, 8, "ar_label[]");
+          }
+          WRITE_CODE('\0', 8, "ar_label[]");
         }
-        WRITE_CODE('\0', 8, "ar_label[]");
       }
     }
     WRITE_UVLC((UInt)sei.m_annotatedRegions.size(), "ar_num_object_updates");
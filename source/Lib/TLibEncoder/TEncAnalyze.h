@@ -71,6 +71,27 @@ public:
     Bool printMSSSIM;
     Bool printXPSNR;
     Bool printHexPerPOCPSNRs;
+    Bool printRoiStats;
+  };
+
+  /// metrics restricted to the samples of one ROI region
+  struct RegionData
+  {
+    RegionData () : bits(0)
+      , numSamples(0)
+    {
+      for(Int i=0; i<MAX_NUM_COMPONENT; i++)
+      {
+        psnr[i]=0;
+        MSE[i]=0;
+        MSSSIM[i]=0;
+      }
+    }
+    Double psnr[MAX_NUM_COMPONENT];
+    Double bits;        ///< bits of the CUs coded in the region
+    Double numSamples;  ///< luma samples in the region, 0 if the region is empty in this picture
+    Double MSE[MAX_NUM_COMPONENT];
+    Double MSSSIM[MAX_NUM_COMPONENT];
   };
 
   struct ResultData
@@ -90,11 +111,13 @@ public:
     Double MSEyuvframe[MAX_NUM_COMPONENT];
     Double MSSSIM[MAX_NUM_COMPONENT];
     Double xpsnr;
+    RegionData region[NUM_ROI_REGIONS];
   };
 
 private:
   ResultData m_runningTotal;
   UInt      m_uiNumPic;
+  UInt      m_uiNumRegionPic[NUM_ROI_REGIONS]; ///< pictures in which the region is not empty
   Double    m_dFrmRate; //--CFG_KDY
 
 #if EXTENSION_360_VIDEO
@@ -116,9 +139,48 @@ public:
     }
 
     m_runningTotal.xpsnr += result.xpsnr;
+
+    for(Int r=0; r<NUM_ROI_REGIONS; r++)
+    {
+      const RegionData &region = result.region[r];
+      m_runningTotal.region[r].bits += region.bits;
+      if (region.numSamples > 0)
+      {
+        m_runningTotal.region[r].numSamples += region.numSamples;
+        for(UInt i=0; i<MAX_NUM_COMPONENT; i++)
+        {
+          m_runningTotal.region[r].psnr[i] += region.psnr[i];
+          m_runningTotal.region[r].MSE[i] += region.MSE[i];
+          m_runningTotal.region[r].MSSSIM[i] += region.MSSSIM[i];
+        }
+        m_uiNumRegionPic[r]++;
+      }
+    }
     m_uiNumPic++;
   }
 
+  /// per-picture averages of the region metrics; bits are averaged over all pictures, distortions over the pictures in which the region is not empty
+  RegionData getRegionAverage(RoiRegion r) const
+  {
+    RegionData average;
+    if (m_uiNumPic > 0)
+    {
+      average.bits = m_runningTotal.region[r].bits / (Double)m_uiNumPic;
+    }
+    if (m_uiNumRegionPic[r] > 0)
+    {
+      const Double numPic = (Double)m_uiNumRegionPic[r];
+      average.numSamples = m_runningTotal.region[r].numSamples / numPic;
+      for(UInt i=0; i<MAX_NUM_COMPONENT; i++)
+      {
+        average.psnr[i]   = m_runningTotal.region[r].psnr[i] / numPic;
+        average.MSE[i]    = m_runningTotal.region[r].MSE[i] / numPic;
+        average.MSSSIM[i] = m_runningTotal.region[r].MSSSIM[i] / numPic;
+      }
+    }
+    return average;
+  }
+
   Double  getPsnr(ComponentID compID) const { return  m_runningTotal.psnr[compID];  }
   Double  getMsssim(ComponentID compID) const { return  m_runningTotal.MSSSIM[compID];  }
   Double  getxPSNR()                  const { return m_runningTotal.xpsnr;}
@@ -134,6 +196,8 @@ public:
   {
     m_runningTotal=ResultData();
     m_uiNumPic = 0;
+    m_uiNumRegionPic[ROI_REGION_BACKGROUND] = 0;
+    m_uiNumRegionPic[ROI_REGION_FOREGROUND] = 0;
 #if EXTENSION_360_VIDEO
     m_ext360.clear();
 #endif
@@ -368,6 +432,65 @@ public:
         exit(1);
         break;
     }
+
+    if (logctrl.printRoiStats)
+    {
+      printRoiOut(chFmt, logctrl);
+    }
+  }
+
+  /// print the bitrate and distortion of the foreground and background regions of the ROI mask
+  Void    printRoiOut ( const ChromaFormat chFmt, const OutputLogControl &logctrl )
+  {
+    const Double dScale    = m_dFrmRate / 1000;
+    const UInt   numComp   = (chFmt == CHROMA_400) ? 1 : MAX_NUM_COMPONENT;
+    const TChar *compName[MAX_NUM_COMPONENT] = { "Y", "U", "V" };
+
+    printf( "\tROI region   |   Bitrate     " );
+    for (UInt comp = 0; comp < numComp; comp++)
+    {
+      printf( "%s-PSNR    ", compName[comp] );
+    }
+    if (logctrl.printMSSSIM)
+    {
+      for (UInt comp = 0; comp < numComp; comp++)
+      {
+        printf( "  %s-MS-SSIM  ", compName[comp] );
+      }
+    }
+    if (logctrl.printSequenceMSE)
+    {
+      for (UInt comp = 0; comp < numComp; comp++)
+      {
+        printf( "  %s-MSE   ", compName[comp] );
+      }
+    }
+    printf( "\n" );
+
+    for (Int r = NUM_ROI_REGIONS - 1; r >= 0; r--)
+    {
+      const RegionData average = getRegionAverage(RoiRegion(r));
+      printf( "\t%-12s |   %12.4lf  ", r == ROI_REGION_FOREGROUND ? "Foreground" : "Background", average.bits * dScale );
+      for (UInt comp = 0; comp < numComp; comp++)
+      {
+        printf( "%8.4lf  ", average.psnr[comp] );
+      }
+      if (logctrl.printMSSSIM)
+      {
+        for (UInt comp = 0; comp < numComp; comp++)
+        {
+          printf( "   %8.6lf  ", average.MSSSIM[comp] );
+        }
+      }
+      if (logctrl.printSequenceMSE)
+      {
+        for (UInt comp = 0; comp < numComp; comp++)
+        {
+          printf( " %8.4lf  ", average.MSE[comp] );
+        }
+      }
+      printf( "\n" );
+    }
   }
 
 
@@ -248,6 +248,17 @@ protected:
   Bool      m_extendedPrecisionProcessingFlag;
   Bool      m_highPrecisionOffsetsEnabledFlag;
   Bool      m_bUseAdaptiveQP;
+  std::string m_roiMaskPath;                    ///< ROI mask image, numbered image pattern or mask video, empty if ROI coding is off
+  RoiMaskFormat m_roiMaskFormat;
+  Int       m_roiMaskInterval;                  ///< number of input frames per mask of a mask sequence, the masks in between are propagated
+  Int       m_roiMaskDilation;                  ///< margin in luma samples added around a propagated mask
+  std::string m_roiStatsFilename;               ///< CSV or JSON file receiving the per-picture ROI region statistics, empty if not written
+  Int       m_roiForegroundQP;                  ///< QP of CUs intersecting the ROI mask
+  Bool      m_roiBackgroundFastDecision;        ///< reduced mode decision for CUs entirely outside the ROI mask
+  Int       m_roiBackgroundIntraModes;          ///< number of intra modes given full RD check in ROI background CUs
+  Int       m_roiBackgroundSearchRange;         ///< motion search range of PUs entirely outside the ROI mask, 0: same as SearchRange
+  UInt      m_roiBackgroundFracSkipThreshold;   ///< integer-pel cost per luma sample below which ROI background PUs skip fractional refinement, 0: never
+  Bool      m_roiForegroundExtendedSearch;      ///< extended TZ search settings for PUs touching the ROI mask
   Int       m_iQPAdaptationRange;
 
   //====== Tool list ========
@@ -278,6 +289,7 @@ protected:
   Bool      m_cabacBypassAlignmentEnabledFlag;
   Bool      m_rdpcmEnabledFlag[NUMBER_OF_RDPCM_SIGNALLING_MODES];
   LumaLevelToDeltaQPMapping m_lumaLevelToDeltaQPMapping; ///< mapping from luma level to delta QP.
+  RoiLevelToDeltaQPMapping m_roiLevelToDeltaQPMapping; ///< mapping from ROI importance level to delta QP.
   Int*      m_aidQP;
   UInt      m_uiDeltaQpRD;
   Bool      m_bFastDeltaQP;
@@ -316,7 +328,17 @@ protected:
   std::vector<Int> m_tileColumnWidth;
   std::vector<Int> m_tileRowHeight;
 
+  Int       m_numTileThreads;                                 ///< number of threads compressing and entropy coding the tiles of a slice
+
   Bool      m_entropyCodingSyncEnabledFlag;
+  Int       m_numWaveFrontThreads;                            ///< number of threads compressing the CTU rows of a slice with entropy coding sync
+  Int       m_numFrameThreads;                                ///< number of threads compressing independent pictures of a GOP
+  Bool      m_loopFilterThread;                               ///< deblock and SAO process the CTU rows of a picture on a separate thread while it is compressed
+  Int       m_lookaheadThreads;                               ///< number of threads analysing the received pictures before they are compressed (0: analysis on the encoding thread)
+  Int       m_lookaheadDepth;                                 ///< maximum number of received pictures waiting for analysis (0: no limit)
+  Bool      m_sceneCutDetection;                              ///< insert an IDR picture and restart the intra period at scene cuts
+  Double    m_sceneCutThreshold;                              ///< ratio of the inter to the intra SATD estimate from which a picture is a scene cut
+  Int       m_sceneCutMinDistance;                            ///< minimum distance in pictures between a scene cut and the previous IRAP picture
 
   HashType  m_decodedPictureHashSEIType;
   Bool      m_bufferingPeriodSEIEnabled;
@@ -453,6 +475,7 @@ protected:
   std::vector<Bool>     m_rwpSEIRwpGuardBandNotUsedForPredFlag;
   std::vector<UChar>    m_rwpSEIRwpGuardBandType;
   std::string           m_arSEIFileRoot;  // Annotated region SEI - initialized from external file
+  Bool                  m_arSEIFromRoiMask;  ///< annotated region SEI derived from the connected regions of the ROI mask
   Bool                    m_fviSEIEnabled;
   TComSEIFisheyeVideoInfo m_fisheyeVideoInfo;
   std::string m_regionalNestingSEIFileRoot;  // Regional nesting SEI - initialized from external file
@@ -513,6 +536,8 @@ protected:
   Bool      m_RCCpbSaturationEnabled;
   UInt      m_RCCpbSize;
   Double    m_RCInitialCpbFullness;
+  Double    m_RCRoiForegroundBitShare;                        ///< share of the picture data bits given to the ROI foreground, 0: off
+  Double    m_RCRoiLambdaRatio;                               ///< ratio of the foreground to the background lambda, 0: off
   Bool      m_TransquantBypassEnabledFlag;                    ///< transquant_bypass_enabled_flag setting in PPS.
   Bool      m_CUTransquantBypassFlagForce;                    ///< if transquant_bypass_enabled_flag, then, if true, all CU transquant bypass flags will be set to true.
 
@@ -697,6 +722,8 @@ public:
 
   Void      setLumaLevelToDeltaQPControls( const LumaLevelToDeltaQPMapping &lumaLevelToDeltaQPMapping ) { m_lumaLevelToDeltaQPMapping=lumaLevelToDeltaQPMapping; }
   const LumaLevelToDeltaQPMapping& getLumaLevelToDeltaQPMapping() const { return m_lumaLevelToDeltaQPMapping; }
+  Void      setRoiLevelToDeltaQPControls( const RoiLevelToDeltaQPMapping &roiLevelToDeltaQPMapping ) { m_roiLevelToDeltaQPMapping=roiLevelToDeltaQPMapping; }
+  const RoiLevelToDeltaQPMapping& getRoiLevelToDeltaQPMapping() const { return m_roiLevelToDeltaQPMapping; }
 
 #if ADAPTIVE_QP_SELECTION
   Void      setUseAdaptQpSelect             ( Bool   i ) { m_bUseAdaptQpSelect    = i; }
@@ -725,6 +752,17 @@ public:
   Void      setHighPrecisionOffsetsEnabledFlag(Bool value) { m_highPrecisionOffsetsEnabledFlag = value; }
 
   Void      setUseAdaptiveQP                ( Bool  b )      { m_bUseAdaptiveQP = b; }
+  Void      setRoiMaskPath                  ( const std::string &s ) { m_roiMaskPath = s; }
+  Void      setRoiMaskFormat                ( RoiMaskFormat e ) { m_roiMaskFormat = e; }
+  Void      setRoiMaskInterval              ( Int   i )      { m_roiMaskInterval = i; }
+  Void      setRoiMaskDilation              ( Int   i )      { m_roiMaskDilation = i; }
+  Void      setRoiStatsFilename             ( const std::string &s ) { m_roiStatsFilename = s; }
+  Void      setRoiForegroundQP              ( Int   i )      { m_roiForegroundQP = i; }
+  Void      setRoiBackgroundFastDecision    ( Bool  b )      { m_roiBackgroundFastDecision = b; }
+  Void      setRoiBackgroundIntraModes      ( Int   i )      { m_roiBackgroundIntraModes = i; }
+  Void      setRoiBackgroundSearchRange     ( Int   i )      { m_roiBackgroundSearchRange = i; }
+  Void      setRoiBackgroundFracSkipThreshold( UInt u )      { m_roiBackgroundFracSkipThreshold = u; }
+  Void      setRoiForegroundExtendedSearch  ( Bool  b )      { m_roiForegroundExtendedSearch = b; }
   Void      setQPAdaptationRange            ( Int   i )      { m_iQPAdaptationRange = i; }
 
   //====== Sequence ========
@@ -787,6 +825,17 @@ public:
   Int       getMaxDeltaQP                   () const { return  m_iMaxDeltaQP; }
   Int       getMaxCuDQPDepth                () const { return  m_iMaxCuDQPDepth; }
   Bool      getUseAdaptiveQP                () const { return  m_bUseAdaptiveQP; }
+  const std::string &getRoiMaskPath         () const { return  m_roiMaskPath; }
+  RoiMaskFormat getRoiMaskFormat            () const { return  m_roiMaskFormat; }
+  Int       getRoiMaskInterval              () const { return  m_roiMaskInterval; }
+  Int       getRoiMaskDilation              () const { return  m_roiMaskDilation; }
+  const std::string &getRoiStatsFilename    () const { return  m_roiStatsFilename; }
+  Int       getRoiForegroundQP              () const { return  m_roiForegroundQP; }
+  Bool      getRoiBackgroundFastDecision    () const { return  m_roiBackgroundFastDecision; }
+  Int       getRoiBackgroundIntraModes      () const { return  m_roiBackgroundIntraModes; }
+  Int       getRoiBackgroundSearchRange     () const { return  m_roiBackgroundSearchRange; }
+  UInt      getRoiBackgroundFracSkipThreshold() const { return m_roiBackgroundFracSkipThreshold; }
+  Bool      getRoiForegroundExtendedSearch  () const { return  m_roiForegroundExtendedSearch; }
   Int       getQPAdaptationRange            () const { return  m_iQPAdaptationRange; }
 #if JVET_X0048_X0103_FILM_GRAIN
   int       getBitDepth(const ChannelType chType) const { return m_bitDepth[chType]; }
@@ -913,9 +962,27 @@ public:
   Int   getNumRowsMinus1               ()                            { return m_iNumRowsMinus1; }
   Void  setRowHeight ( const std::vector<Int>& rowHeight)            { m_tileRowHeight = rowHeight; }
   UInt  getRowHeight                   ( UInt rowIdx )               { return m_tileRowHeight[rowIdx]; }
+  Void  setNumTileThreads              ( Int i )                     { m_numTileThreads = i; }
+  Int   getNumTileThreads              () const                      { return m_numTileThreads; }
   Void  xCheckGSParameters();
   Void  setEntropyCodingSyncEnabledFlag(Bool b)                      { m_entropyCodingSyncEnabledFlag = b; }
   Bool  getEntropyCodingSyncEnabledFlag() const                      { return m_entropyCodingSyncEnabledFlag; }
+  Void  setNumWaveFrontThreads(Int i)                                { m_numWaveFrontThreads = i; }
+  Int   getNumWaveFrontThreads() const                               { return m_numWaveFrontThreads; }
+  Void  setNumFrameThreads(Int i)                                    { m_numFrameThreads = i; }
+  Int   getNumFrameThreads() const                                   { return m_numFrameThreads; }
+  Void  setLoopFilterThread(Bool b)                                  { m_loopFilterThread = b; }
+  Bool  getLoopFilterThread() const                                  { return m_loopFilterThread; }
+  Void  setLookaheadThreads(Int i)                                   { m_lookaheadThreads = i; }
+  Int   getLookaheadThreads() const                                  { return m_lookaheadThreads; }
+  Void  setLookaheadDepth(Int i)                                     { m_lookaheadDepth = i; }
+  Int   getLookaheadDepth() const                                    { return m_lookaheadDepth; }
+  Void  setSceneCutDetection(Bool b)                                 { m_sceneCutDetection = b; }
+  Bool  getSceneCutDetection() const                                 { return m_sceneCutDetection; }
+  Void  setSceneCutThreshold(Double d)                               { m_sceneCutThreshold = d; }
+  Double getSceneCutThreshold() const                                { return m_sceneCutThreshold; }
+  Void  setSceneCutMinDistance(Int i)                                { m_sceneCutMinDistance = i; }
+  Int   getSceneCutMinDistance() const                               { return m_sceneCutMinDistance; }
   Void  setDecodedPictureHashSEIType(HashType m)                     { m_decodedPictureHashSEIType = m; }
   HashType getDecodedPictureHashSEIType() const                      { return m_decodedPictureHashSEIType; }
   Void  setBufferingPeriodSEIEnabled(Bool b)                         { m_bufferingPeriodSEIEnabled = b; }
@@ -1261,6 +1328,8 @@ public:
   Void  setAnnotatedRegionSEIFileRoot(const std::string &s)          { m_arSEIFileRoot = s; }
 #endif
   const std::string &getAnnotatedRegionSEIFileRoot() const           { return m_arSEIFileRoot; }
+  Void  setAnnotatedRegionSEIFromRoiMask(Bool b)                    { m_arSEIFromRoiMask = b; }
+  Bool  getAnnotatedRegionSEIFromRoiMask() const                     { return m_arSEIFromRoiMask; }
 
   const TComSEIMasteringDisplay &getMasteringDisplaySEI() const      { return m_masteringDisplay; }
   Void         setUseWP               ( Bool b )                     { m_useWeightedPred   = b;    }
@@ -1301,6 +1370,11 @@ public:
   Void         setCpbSize             ( UInt ui )                    { m_RCCpbSize = ui;   }
   Double       getInitialCpbFullness  ()                             { return m_RCInitialCpbFullness;  }
   Void         setInitialCpbFullness  (Double f)                     { m_RCInitialCpbFullness = f;     }
+  Double       getRCRoiForegroundBitShare()                          { return m_RCRoiForegroundBitShare; }
+  Void         setRCRoiForegroundBitShare( Double d )                { m_RCRoiForegroundBitShare = d;    }
+  Double       getRCRoiLambdaRatio    ()                             { return m_RCRoiLambdaRatio;      }
+  Void         setRCRoiLambdaRatio    ( Double d )                   { m_RCRoiLambdaRatio = d;         }
+  Bool         getUseRoiRateCtrl      () const                       { return m_RCEnableRateControl && (m_RCRoiForegroundBitShare > 0 || m_RCRoiLambdaRatio > 0); }
   Bool         getTransquantBypassEnabledFlag()                      { return m_TransquantBypassEnabledFlag; }
   Void         setTransquantBypassEnabledFlag(Bool flag)             { m_TransquantBypassEnabledFlag = flag; }
   Bool         getCUTransquantBypassFlagForceValue()                 { return m_CUTransquantBypassFlagForce; }
@@ -0,0 +1,117 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2022, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/** \file     TEncCtuWorker.cpp
+    \brief    coding objects of one CTU encoding thread
+*/
+
+#include "TEncCtuWorker.h"
+
+//! \ingroup TLibEncoder
+//! \{
+
+TEncCtuWorker::TEncCtuWorker()
+: m_numDepths        ( 0 )
+, m_pppcRDSbacCoder  ( NULL )
+, m_pppcBinCoderCABAC( NULL )
+{
+  m_cSbacCoder.init( &m_cBinCoderCABAC );
+  m_cRDGoOnSbacCoder.init( &m_cRDGoOnBinCoderCABAC );
+}
+
+TEncCtuWorker::~TEncCtuWorker()
+{
+  destroy();
+}
+
+Void TEncCtuWorker::create( UInt maxTotalCUDepth, UInt maxCUWidth, UInt maxCUHeight, ChromaFormat chromaFormat )
+{
+  m_cCuEncoder.create( maxTotalCUDepth, maxCUWidth, maxCUHeight, chromaFormat );
+
+  m_numDepths         = maxTotalCUDepth + 1;
+  m_pppcRDSbacCoder   = new TEncSbac** [m_numDepths];
+#if FAST_BIT_EST
+  m_pppcBinCoderCABAC = new TEncBinCABACCounter** [m_numDepths];
+#else
+  m_pppcBinCoderCABAC = new TEncBinCABAC** [m_numDepths];
+#endif
+
+  for ( UInt depth = 0; depth < m_numDepths; depth++ )
+  {
+    m_pppcRDSbacCoder[depth] = new TEncSbac* [CI_NUM];
+#if FAST_BIT_EST
+    m_pppcBinCoderCABAC[depth] = new TEncBinCABACCounter* [CI_NUM];
+#else
+    m_pppcBinCoderCABAC[depth] = new TEncBinCABAC* [CI_NUM];
+#endif
+
+    for ( Int ciIdx = 0; ciIdx < CI_NUM; ciIdx++ )
+    {
+      m_pppcRDSbacCoder[depth][ciIdx] = new TEncSbac;
+#if FAST_BIT_EST
+      m_pppcBinCoderCABAC[depth][ciIdx] = new TEncBinCABACCounter;
+#else
+      m_pppcBinCoderCABAC[depth][ciIdx] = new TEncBinCABAC;
+#endif
+      m_pppcRDSbacCoder[depth][ciIdx]->init( m_pppcBinCoderCABAC[depth][ciIdx] );
+    }
+  }
+}
+
+Void TEncCtuWorker::destroy()
+{
+  if ( m_pppcRDSbacCoder == NULL )
+  {
+    return;
+  }
+  m_cCuEncoder.destroy(); // the encoder search is released by its own destructor, as it is only allocated by init
+
+  for ( UInt depth = 0; depth < m_numDepths; depth++ )
+  {
+    for ( Int ciIdx = 0; ciIdx < CI_NUM; ciIdx++ )
+    {
+      delete m_pppcRDSbacCoder[depth][ciIdx];
+      delete m_pppcBinCoderCABAC[depth][ciIdx];
+    }
+    delete [] m_pppcRDSbacCoder[depth];
+    delete [] m_pppcBinCoderCABAC[depth];
+  }
+  delete [] m_pppcRDSbacCoder;
+  delete [] m_pppcBinCoderCABAC;
+  m_pppcRDSbacCoder   = NULL;
+  m_pppcBinCoderCABAC = NULL;
+  m_numDepths         = 0;
+}
+
+//! \}
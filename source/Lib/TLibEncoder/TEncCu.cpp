@@ -34,15 +34,12 @@
 /** \file     TEncCu.cpp
     \brief    Coding Unit (CU) encoder class
 */
-#define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
 #include <iostream>
 #include <stdio.h>
 #include "TEncTop.h"
 #include "TEncCu.h"
 #include "TEncAnalyze.h"
 #include "TLibCommon/Debug.h"
-#include "TLibCommon/variables_fg_coding.h"
 #include <iostream>
 #include <fstream>
 
@@ -235,21 +232,39 @@ Void TEncCu::destroy()
 /** \param    pcEncTop      pointer of encoder class
  */
 Void TEncCu::init(TEncTop *pcEncTop)
+{
+  init(pcEncTop, pcEncTop->getPredSearch(), pcEncTop->getTrQuant(), pcEncTop->getRdCost(),
+       pcEncTop->getEntropyCoder(), pcEncTop->getRDSbacCoder(), pcEncTop->getRDGoOnSbacCoder());
+}
+
+/** \param    pcEncTop           pointer of encoder class
+ * \param    pcPredSearch       encoder search class
+ * \param    pcTrQuant          transform & quantization class
+ * \param    pcRdCost           RD cost computation class
+ * \param    pcEntropyCoder     entropy encoder
+ * \param    pppcRDSbacCoder    storage for SBAC-based RD optimization
+ * \param    pcRDGoOnSbacCoder  go-on SBAC encoder
+ */
+Void TEncCu::init(TEncTop *pcEncTop, TEncSearch *pcPredSearch, TComTrQuant *pcTrQuant, TComRdCost *pcRdCost,
+                  TEncEntropy *pcEntropyCoder, TEncSbac ***pppcRDSbacCoder, TEncSbac *pcRDGoOnSbacCoder)
 {
   m_pcEncCfg = pcEncTop;
-  m_pcPredSearch = pcEncTop->getPredSearch();
-  m_pcTrQuant = pcEncTop->getTrQuant();
-  m_pcRdCost = pcEncTop->getRdCost();
+  m_pcPredSearch = pcPredSearch;
+  m_pcTrQuant = pcTrQuant;
+  m_pcRdCost = pcRdCost;
 
-  m_pcEntropyCoder = pcEncTop->getEntropyCoder();
+  m_pcEntropyCoder = pcEntropyCoder;
   m_pcBinCABAC = pcEncTop->getBinCABAC();
 
-  m_pppcRDSbacCoder = pcEncTop->getRDSbacCoder();
-  m_pcRDGoOnSbacCoder = pcEncTop->getRDGoOnSbacCoder();
+  m_pppcRDSbacCoder = pppcRDSbacCoder;
+  m_pcRDGoOnSbacCoder = pcRDGoOnSbacCoder;
 
   m_pcRateCtrl = pcEncTop->getRateCtrl();
   m_lumaQPOffset = 0;
   initLumaDeltaQpLUT();
+  initRoiDeltaQpLUT();
+  m_bCountRoiRegionBits = false;
+  m_uiCUStartBits = 0;
 #if JVET_V0078
   m_smoothQPoffset = 0;
 #endif
@@ -271,6 +286,7 @@ Void TEncCu::compressCtu(TComDataCU *pCtu)
   m_ppcBestCU[0]->initCtu(pCtu->getPic(), pCtu->getCtuRsAddr());
   m_ppcTempCU[0]->initCtu(pCtu->getPic(), pCtu->getCtuRsAddr());
   m_bEncodeDQP = false;
+  m_dRoiBaseLambda = m_pcRdCost->getLambda();
 
   // analysis of CU
   DEBUG_STRING_NEW(sDebug)
@@ -278,20 +294,27 @@ Void TEncCu::compressCtu(TComDataCU *pCtu)
   xCompressCU(m_ppcBestCU[0], m_ppcTempCU[0], 0 DEBUG_STRING_PASS_INTO(sDebug));
   DEBUG_STRING_OUTPUT(std::cout, sDebug)
 
+  // restore the CTU lambda of the rate control
+  xSetRoiRateCtrlLambda(NULL, 0);
+
 #if ADAPTIVE_QP_SELECTION
   if (m_pcEncCfg->getUseAdaptQpSelect())
   {
     if (pCtu->getSlice()->getSliceType() != I_SLICE) // IIII
     {
-      xCtuCollectARLStats(pCtu);
+      xCtuCollectARLStats(m_ppcBestCU[0]);
     }
   }
 #endif
 }
 /** \param  pCtu  pointer of CU data class
+ * \param  bCountRoiRegionBits  add the bits of each CU to the ROI region statistics of the picture
  */
-Void TEncCu::encodeCtu(TComDataCU *pCtu)
+Void TEncCu::encodeCtu(TComDataCU *pCtu, Bool bCountRoiRegionBits)
 {
+  const TEncPic *pcEPic = dynamic_cast<const TEncPic *>(pCtu->getPic());
+  m_bCountRoiRegionBits = bCountRoiRegionBits && pcEPic != NULL && pcEPic->getRoiMap() != NULL && pcEPic->getRoiMap()->isActive();
+
   if (pCtu->getSlice()->getPPS()->getUseDQP())
   {
     setdQPFlag(true);
@@ -334,6 +357,43 @@ Void TEncCu::initLumaDeltaQpLUT()
   }
 }
 
+Void TEncCu::initRoiDeltaQpLUT()
+{
+  const RoiLevelToDeltaQPMapping &mapping = m_pcEncCfg->getRoiLevelToDeltaQPMapping();
+
+  if (!mapping.isEnabled())
+  {
+    return;
+  }
+
+  // map the sparse RoiLevelToDeltaQPMapping.mapping to a fully populated table, holding or interpolating between points.
+  // Levels below the first point use its delta QP.
+
+  std::size_t nextSparseIndex = 0;
+  for (Int index = 0; index < ROI_LEVEL_TO_DQP_LUT_SIZE; index++)
+  {
+    while (nextSparseIndex < mapping.mapping.size() && index >= mapping.mapping[nextSparseIndex].first)
+    {
+      nextSparseIndex++;
+    }
+    if (nextSparseIndex == 0)
+    {
+      m_roiLevelToDeltaQPLUT[index] = mapping.mapping[0].second;
+    }
+    else if (!mapping.interpolate || nextSparseIndex == mapping.mapping.size())
+    {
+      m_roiLevelToDeltaQPLUT[index] = mapping.mapping[nextSparseIndex - 1].second;
+    }
+    else
+    {
+      const std::pair<Int, Int> &p0 = mapping.mapping[nextSparseIndex - 1];
+      const std::pair<Int, Int> &p1 = mapping.mapping[nextSparseIndex];
+      const Double dQP = p0.second + Double(p1.second - p0.second) * (index - p0.first) / (p1.first - p0.first);
+      m_roiLevelToDeltaQPLUT[index] = Int(floor(dQP + 0.5));
+    }
+  }
+}
+
 Int TEncCu::calculateLumaDQP(TComDataCU *pCU, const UInt absPartIdx, const TComYuv *pOrgYuv)
 {
   const Pel *pY = pOrgYuv->getAddr(COMPONENT_Y, absPartIdx);
@@ -577,7 +637,12 @@ Void TEncCu::xCompressCU(TComDataCU *&rpcBestCU, TComDataCU *&rpcTempCU, const U
   const UInt uiBPelY = uiTPelY + rpcBestCU->getHeight(0) - 1;
   const UInt uiWidth = rpcBestCU->getWidth(0);
 
+  // CUs entirely outside the ROI mask: early skip and CU termination, no AMP and no split to the minimum CU size
+  const Bool bRoiBackground = xIsRoiBackgroundFast(rpcBestCU);
+  const Bool bEarlySkipDetection = m_pcEncCfg->getUseEarlySkipDetection() || bRoiBackground;
+
   Int iBaseQP = xComputeQP(rpcBestCU, uiDepth);
+  xSetRoiRateCtrlLambda(rpcBestCU, uiDepth);
   Int iMinQP;
   Int iMaxQP;
   Bool isAddLowestQP = false;
@@ -666,7 +731,8 @@ Void TEncCu::xCompressCU(TComDataCU *&rpcBestCU, TComDataCU *&rpcTempCU, const U
   }
 #endif
 
-  if (m_pcEncCfg->getUseRateCtrl())
+  // with ROI rate control, xComputeQP offsets the rate control QP of foreground CUs
+  if (m_pcEncCfg->getUseRateCtrl() && !m_pcRateCtrl->getRCPic()->getRoiEnabled())
   {
     iMinQP = m_pcRateCtrl->getRCQP();
     iMaxQP = m_pcRateCtrl->getRCQP();
@@ -732,7 +798,7 @@ Void TEncCu::xCompressCU(TComDataCU *&rpcBestCU, TComDataCU *&rpcTempCU, const U
       if (rpcBestCU->getSlice()->getSliceType() != I_SLICE)
       {
         // 2Nx2N
-        if (m_pcEncCfg->getUseEarlySkipDetection())
+        if (bEarlySkipDetection)
         {
           xCheckRDCostInter(rpcBestCU, rpcTempCU, SIZE_2Nx2N DEBUG_STRING_PASS_INTO(sDebug));
           rpcTempCU->initEstData(uiDepth, iQP, bIsLosslessMode); // by Competition for inter_2Nx2N
@@ -741,7 +807,7 @@ Void TEncCu::xCompressCU(TComDataCU *&rpcBestCU, TComDataCU *&rpcTempCU, const U
         xCheckRDCostMerge2Nx2N(rpcBestCU, rpcTempCU DEBUG_STRING_PASS_INTO(sDebug), &earlyDetectionSkipMode); // by Merge for inter_2Nx2N
         rpcTempCU->initEstData(uiDepth, iQP, bIsLosslessMode);
 
-        if (!m_pcEncCfg->getUseEarlySkipDetection())
+        if (!bEarlySkipDetection)
         {
           // 2Nx2N, NxN
           xCheckRDCostInter(rpcBestCU, rpcTempCU, SIZE_2Nx2N DEBUG_STRING_PASS_INTO(sDebug));
@@ -806,7 +872,7 @@ Void TEncCu::xCompressCU(TComDataCU *&rpcBestCU, TComDataCU *&rpcTempCU, const U
           }
 
           //! Try AMP (SIZE_2NxnU, SIZE_2NxnD, SIZE_nLx2N, SIZE_nRx2N)
-          if (sps.getUseAMP() && uiDepth < sps.getLog2DiffMaxMinCodingBlockSize())
+          if (sps.getUseAMP() && uiDepth < sps.getLog2DiffMaxMinCodingBlockSize() && !bRoiBackground)
           {
 #if AMP_ENC_SPEEDUP
             Bool bTestAMP_Hor = false, bTestAMP_Ver = false;
@@ -1020,7 +1086,8 @@ Void TEncCu::xCompressCU(TComDataCU *&rpcBestCU, TComDataCU *&rpcTempCU, const U
     iMaxQP = iMinQP;
   }
 
-  if (m_pcEncCfg->getUseRateCtrl())
+  // with ROI rate control, xComputeQP offsets the rate control QP of foreground CUs
+  if (m_pcEncCfg->getUseRateCtrl() && !m_pcRateCtrl->getRCPic()->getRoiEnabled())
   {
     iMinQP = m_pcRateCtrl->getRCQP();
     iMaxQP = m_pcRateCtrl->getRCQP();
@@ -1031,9 +1098,10 @@ Void TEncCu::xCompressCU(TComDataCU *&rpcBestCU, TComDataCU *&rpcTempCU, const U
     iMaxQP = iMinQP; // If all TUs are forced into using transquant bypass, do not loop here.
   }
 
-  const Bool bSubBranch = bBoundary || !(m_pcEncCfg->getUseEarlyCU() && rpcBestCU->getTotalCost() != MAX_DOUBLE && rpcBestCU->isSkipped(0));
+  const Bool bSubBranch = bBoundary || !((m_pcEncCfg->getUseEarlyCU() || bRoiBackground) && rpcBestCU->getTotalCost() != MAX_DOUBLE && rpcBestCU->isSkipped(0));
+  const UInt uiMaxSplitDepth = (bRoiBackground && !bBoundary) ? sps.getLog2DiffMaxMinCodingBlockSize() - 1 : sps.getLog2DiffMaxMinCodingBlockSize();
 
-  if (bSubBranch && uiDepth < sps.getLog2DiffMaxMinCodingBlockSize() && (!getFastDeltaQp() || uiWidth > fastDeltaQPCuMaxSize || bBoundary))
+  if (bSubBranch && uiDepth < uiMaxSplitDepth && (!getFastDeltaQp() || uiWidth > fastDeltaQPCuMaxSize || bBoundary))
   {
     // further split
     Double splitTotalCost = 0;
@@ -1104,6 +1172,7 @@ Void TEncCu::xCompressCU(TComDataCU *&rpcBestCU, TComDataCU *&rpcTempCU, const U
       }
 
       m_pcRDGoOnSbacCoder->load(m_pppcRDSbacCoder[uhNextDepth][CI_NEXT_BEST]);
+      xSetRoiRateCtrlLambda(rpcTempCU, uiDepth); // the sub-CUs may have changed the lambda
       if (!bBoundary)
       {
         m_pcEntropyCoder->resetBits();
@@ -1252,41 +1321,66 @@ Void TEncCu::finishCU(TComDataCU *pcCU, UInt uiAbsPartIdx)
       m_pcEntropyCoder->encodeTerminatingBit(0);
     }
   }
+
+  if (m_bCountRoiRegionBits)
+  {
+    TEncPic *pcEPic = dynamic_cast<TEncPic *>(pcPic);
+    const Int iPosX = pcCU->getCUPelX() + g_auiRasterToPelX[g_auiZscanToRaster[uiAbsPartIdx]];
+    const Int iPosY = pcCU->getCUPelY() + g_auiRasterToPelY[g_auiZscanToRaster[uiAbsPartIdx]];
+    const Bool bForeground = pcEPic->getRoiMap()->intersects(iPosX, iPosY, pcCU->getWidth(uiAbsPartIdx), pcCU->getHeight(uiAbsPartIdx));
+    pcEPic->addRoiRegionBits(bForeground ? ROI_REGION_FOREGROUND : ROI_REGION_BACKGROUND, m_pcEntropyCoder->getNumberOfWrittenBits() - m_uiCUStartBits);
+  }
 }
 
-Int check_overlap(TComDataCU *&pcCU, std::string imagePath)
+/** Check whether a CU gets the reduced background mode decision
+ * \param pcCU Target CU
+ * \returns true if RoiBackgroundFastDecision is enabled and the CU lies entirely outside the ROI mask
+ */
+Bool TEncCu::xIsRoiBackgroundFast(const TComDataCU *pcCU) const
 {
-  const UInt uiLPelX = pcCU->getCUPelX();
-  const UInt uiRPelX = uiLPelX + pcCU->getWidth(0) - 1;
-  const UInt uiTPelY = pcCU->getCUPelY();
-  const UInt uiBPelY = uiTPelY + pcCU->getHeight(0) - 1;
-  int width, height, channels;
-  int QP_base = pcCU->getSlice()->getSliceQpBase();
-  unsigned char *data = stbi_load(imagePath.c_str(), &width, &height, &channels, STBI_grey);
-  if (data == nullptr)
+  if (!m_pcEncCfg->getRoiBackgroundFastDecision())
   {
-    throw std::runtime_error("Could not open or find the image");
+    return false;
   }
-  for (unsigned int y = uiTPelY; y <= uiBPelY; ++y)
+  const TEncPic *pcEPic = dynamic_cast<const TEncPic *>(pcCU->getPic());
+  return pcEPic != NULL && pcEPic->isRoiBackground(pcCU->getCUPelX(), pcCU->getCUPelY(), pcCU->getWidth(0), pcCU->getHeight(0));
+}
+
+/** Set the lambda of a CU under ROI rate control: CUs touching the mask scale the CTU lambda by the region lambda ratio to match their QP offset
+ * \param pcCU Target CU, NULL to restore the CTU lambda
+ * \param uiDepth CU depth
+ */
+Void TEncCu::xSetRoiRateCtrlLambda(const TComDataCU *pcCU, UInt uiDepth)
+{
+  if (!m_pcEncCfg->getUseRateCtrl() || !m_pcRateCtrl->getRCPic()->getRoiEnabled())
   {
-    for (unsigned int x = uiLPelX; x <= uiRPelX; ++x)
+    return;
+  }
+  Double dLambda = m_dRoiBaseLambda;
+  if (pcCU != NULL)
+  {
+    if (uiDepth > pcCU->getSlice()->getPPS()->getMaxCuDQPDepth())
     {
-      // Ensure we are within the image bounds
-      if (y < 0 || y >= height || x < 0 || x >= width)
-      {
-        continue;
-      }
-      if (data[y * width + x] > 128)
-      { // threshold check
-        stbi_image_free(data);
-        pcCU->getSlice()->setSliceQp(getmyQP_fg());
-        return 0;
-      }
+      return;
+    }
+    const TEncRoiMap *pcRoiMap = dynamic_cast<const TEncPic *>(pcCU->getPic())->getRoiMap();
+    if (pcRoiMap->intersects(pcCU->getCUPelX(), pcCU->getCUPelY(), pcCU->getWidth(0), pcCU->getHeight(0)))
+    {
+      dLambda *= m_pcRateCtrl->getRCPic()->getRoiLambdaRatio();
     }
   }
-  pcCU->getSlice()->setSliceQp(QP_base);
-  stbi_image_free(data);
-  return 0;
+  if (dLambda == m_pcRdCost->getLambda())
+  {
+    return;
+  }
+  m_pcRdCost->setLambda(dLambda, m_ppcBestCU[0]->getSlice()->getSPS()->getBitDepths());
+#if RDOQ_CHROMA_LAMBDA
+  const Double chromaLambda = dLambda / m_pcRdCost->getChromaWeight();
+  const Double lambdaArray[MAX_NUM_COMPONENT] = {dLambda, chromaLambda, chromaLambda};
+  m_pcTrQuant->setLambdas(lambdaArray);
+#else
+  m_pcTrQuant->setLambda(dLambda);
+#endif
 }
 
 /** Compute QP for each CU
@@ -1296,34 +1390,51 @@ Int check_overlap(TComDataCU *&pcCU, std::string imagePath)
  */
 Int TEncCu::xComputeQP(TComDataCU *pcCU, UInt uiDepth)
 {
-  std::string imagePath = getImagePath();
+  Int iBaseQp = pcCU->getSlice()->getSliceQp();
   Int iQpOffset = 0;
-  if (m_pcEncCfg->getUseAdaptiveQP() && imagePath != "")
+  const TEncRoiMap *pcRoiMap = m_pcEncCfg->getUseAdaptiveQP() ? dynamic_cast<TEncPic *>(pcCU->getPic())->getRoiMap() : NULL;
+  if (pcRoiMap != NULL && pcRoiMap->isActive())
   {
-    iQpOffset = check_overlap(pcCU, imagePath);
-  }
-  else
-  {
-    if (m_pcEncCfg->getUseAdaptiveQP())
+    const RoiLevelToDeltaQPMapping &roiMapping = m_pcEncCfg->getRoiLevelToDeltaQPMapping();
+    if (m_pcEncCfg->getUseRateCtrl())
     {
-      std::cout << "WTF" << std::endl;
-      TEncPic *pcEPic = dynamic_cast<TEncPic *>(pcCU->getPic());
-      UInt uiAQDepth = min(uiDepth, pcEPic->getMaxAQDepth() - 1);
-      TEncPicQPAdaptationLayer *pcAQLayer = pcEPic->getAQLayer(uiAQDepth);
-      UInt uiAQUPosX = pcCU->getCUPelX() / pcAQLayer->getAQPartWidth();
-      UInt uiAQUPosY = pcCU->getCUPelY() / pcAQLayer->getAQPartHeight();
-      UInt uiAQUStride = pcAQLayer->getAQPartStride();
-      TEncQPAdaptationUnit *acAQU = pcAQLayer->getQPAdaptationUnit();
-
-      Double dMaxQScale = pow(2.0, m_pcEncCfg->getQPAdaptationRange() / 6.0);
-      Double dAvgAct = pcAQLayer->getAvgActivity();
-      Double dCUAct = acAQU[uiAQUPosY * uiAQUStride + uiAQUPosX].getActivity();
-      Double dNormAct = (dMaxQScale * dCUAct + dAvgAct) / (dCUAct + dMaxQScale * dAvgAct);
-      Double dQpOffset = log(dNormAct) / log(2.0) * 6.0;
-      iQpOffset = Int(floor(dQpOffset + 0.49999));
+      // the rate control QP applies to the background, foreground CUs get the QP offset of the region lambda ratio
+      TEncRCPic *pcRCPic = m_pcRateCtrl->getRCPic();
+      iBaseQp = m_pcRateCtrl->getRCQP();
+      if (pcRCPic->getRoiEnabled() && pcRoiMap->intersects(pcCU->getCUPelX(), pcCU->getCUPelY(), pcCU->getWidth(0), pcCU->getHeight(0)))
+      {
+        iQpOffset = pcRCPic->getRoiQPOffset();
+      }
+    }
+    else if (roiMapping.isEnabled())
+    {
+      const Int level = roiMapping.mode == ROI_LEVEL_TO_DQP_MAX_METHOD ? pcRoiMap->getMaxLevel(pcCU->getCUPelX(), pcCU->getCUPelY(), pcCU->getWidth(0), pcCU->getHeight(0))
+                                                                       : pcRoiMap->getMeanLevel(pcCU->getCUPelX(), pcCU->getCUPelY(), pcCU->getWidth(0), pcCU->getHeight(0));
+      iQpOffset = m_roiLevelToDeltaQPLUT[level];
+    }
+    // CUs touching the foreground use the foreground QP, all others keep the slice QP
+    else if (pcRoiMap->intersects(pcCU->getCUPelX(), pcCU->getCUPelY(), pcCU->getWidth(0), pcCU->getHeight(0)))
+    {
+      iQpOffset = m_pcEncCfg->getRoiForegroundQP() - iBaseQp;
     }
   }
-  Int iBaseQp = pcCU->getSlice()->getSliceQp();
+  else if (m_pcEncCfg->getUseAdaptiveQP())
+  {
+    TEncPic *pcEPic = dynamic_cast<TEncPic *>(pcCU->getPic());
+    UInt uiAQDepth = min(uiDepth, pcEPic->getMaxAQDepth() - 1);
+    TEncPicQPAdaptationLayer *pcAQLayer = pcEPic->getAQLayer(uiAQDepth);
+    UInt uiAQUPosX = pcCU->getCUPelX() / pcAQLayer->getAQPartWidth();
+    UInt uiAQUPosY = pcCU->getCUPelY() / pcAQLayer->getAQPartHeight();
+    UInt uiAQUStride = pcAQLayer->getAQPartStride();
+    TEncQPAdaptationUnit *acAQU = pcAQLayer->getQPAdaptationUnit();
+
+    Double dMaxQScale = pow(2.0, m_pcEncCfg->getQPAdaptationRange() / 6.0);
+    Double dAvgAct = pcAQLayer->getAvgActivity();
+    Double dCUAct = acAQU[uiAQUPosY * uiAQUStride + uiAQUPosX].getActivity();
+    Double dNormAct = (dMaxQScale * dCUAct + dAvgAct) / (dCUAct + dMaxQScale * dAvgAct);
+    Double dQpOffset = log(dNormAct) / log(2.0) * 6.0;
+    iQpOffset = Int(floor(dQpOffset + 0.49999));
+  }
   return Clip3(-pcCU->getSlice()->getSPS()->getQpBDOffset(CHANNEL_TYPE_LUMA), MAX_QP, iBaseQp + iQpOffset);
 }
 
@@ -1383,6 +1494,8 @@ Void TEncCu::xEncodeCU(TComDataCU *pcCU, UInt uiAbsPartIdx, UInt uiDepth)
     return;
   }
 
+  m_uiCUStartBits = m_pcEntropyCoder->getNumberOfWrittenBits();
+
   if (uiDepth <= pps.getMaxCuDQPDepth() && pps.getUseDQP())
   {
     setdQPFlag(true);
@@ -1671,7 +1784,7 @@ Void TEncCu::xCheckRDCostMerge2Nx2N(TComDataCU *&rpcBestCU, TComDataCU *&rpcTemp
       }
     }
 
-    if (uiNoResidual == 0 && m_pcEncCfg->getUseEarlySkipDetection())
+    if (uiNoResidual == 0 && (m_pcEncCfg->getUseEarlySkipDetection() || xIsRoiBackgroundFast(rpcBestCU)))
     {
       if (rpcBestCU->getQtRootCbf(0) == 0)
       {
@@ -85,6 +85,10 @@ private:
   Int                     m_cuChromaQpOffsetIdxPlus1; // if 0, then cu_chroma_qp_offset_flag will be 0, otherwise cu_chroma_qp_offset_flag will be 1.
   Int                     m_lumaLevelToDeltaQPLUT[LUMA_LEVEL_TO_DQP_LUT_MAXSIZE];
   Int                     m_lumaQPOffset;
+  Int                     m_roiLevelToDeltaQPLUT[ROI_LEVEL_TO_DQP_LUT_SIZE];
+  Bool                    m_bCountRoiRegionBits;  ///< attribute the bits of each coded CU to its ROI region
+  UInt                    m_uiCUStartBits;        ///< written bits at the start of the current leaf CU
+  Double                  m_dRoiBaseLambda;       ///< lambda of the CTU given by the rate control, applies to the ROI background
   TEncSlice*              m_pcSliceEncoder;
 #if JVET_V0078
   Int                     m_smoothQPoffset;
@@ -110,10 +114,14 @@ private:
 public:
   /// copy parameters from encoder class
   Void  init                ( TEncTop* pcEncTop );
+  /// copy parameters from encoder class, using the search, transform, cost and entropy coding objects of a CTU encoding thread
+  Void  init                ( TEncTop* pcEncTop, TEncSearch* pcPredSearch, TComTrQuant* pcTrQuant, TComRdCost* pcRdCost,
+                              TEncEntropy* pcEntropyCoder, TEncSbac*** pppcRDSbacCoder, TEncSbac* pcRDGoOnSbacCoder );
 
   Void       setSliceEncoder( TEncSlice* pSliceEncoder ) { m_pcSliceEncoder = pSliceEncoder; }
   TEncSlice* getSliceEncoder() { return m_pcSliceEncoder; }
   Void       initLumaDeltaQpLUT();
+  Void       initRoiDeltaQpLUT();
   Int        calculateLumaDQP( TComDataCU *pCU, const UInt absPartIdx, const TComYuv * pOrgYuv );
 #if JVET_V0078
   Int        calculateLumaDQPsmooth(TComDataCU *pCU, const UInt absPartIdx, const TComYuv * pOrgYuv, Int iBaseQP);
@@ -128,8 +136,8 @@ public:
   /// CTU analysis function
   Void  compressCtu         ( TComDataCU*  pCtu );
 
-  /// CTU encoding function
-  Void  encodeCtu           ( TComDataCU*  pCtu );
+  /// CTU encoding function, optionally accumulating the bits of each CU into the ROI region statistics of the picture
+  Void  encodeCtu           ( TComDataCU*  pCtu, Bool bCountRoiRegionBits = false );
 
   Int   updateCtuDataISlice ( TComDataCU* pCtu, Int width, Int height );
 
@@ -145,6 +153,8 @@ protected:
   Void  xEncodeCU           ( TComDataCU*  pcCU, UInt uiAbsPartIdx,           UInt uiDepth        );
 
   Int   xComputeQP          ( TComDataCU* pcCU, UInt uiDepth );
+  Bool  xIsRoiBackgroundFast( const TComDataCU* pcCU ) const;
+  Void  xSetRoiRateCtrlLambda( const TComDataCU* pcCU, UInt uiDepth );
   Void  xCheckBestMode      ( TComDataCU*& rpcBestCU, TComDataCU*& rpcTempCU, UInt uiDepth DEBUG_STRING_FN_DECLARE(sParent) DEBUG_STRING_FN_DECLARE(sTest) DEBUG_STRING_PASS_INTO(Bool bAddSizeInfo=true));
 
   Void  xCheckRDCostMerge2Nx2N( TComDataCU*& rpcBestCU, TComDataCU*& rpcTempCU DEBUG_STRING_FN_DECLARE(sDebug), Bool *earlyDetectionSkipMode );
@@ -51,6 +51,8 @@
 #include <math.h>
 
 #include <deque>
+#include <atomic>
+#include <thread>
 using namespace std;
 
 //! \ingroup TLibEncoder
@@ -74,6 +76,7 @@ Int getLSB(Int poc, Int maxLSB)
 TEncGOP::TEncGOP()
 {
   m_iLastIDR            = 0;
+  m_intraPeriodStart    = 0;
   m_RASPOCforResetEncoder = MAX_INT;
 
   m_iGopSize            = 0;
@@ -102,6 +105,12 @@ TEncGOP::TEncGOP()
   m_associatedIRAPType = NAL_UNIT_CODED_SLICE_IDR_N_LP;
   m_associatedIRAPPOC  = 0;
   m_pcDeblockingTempPicYuv = NULL;
+  m_pcLoopFilterPic     = NULL;
+  m_numCompressedCtuRows = 0;
+  m_cLoopFilterSbacCoder.init( &m_cLoopFilterBinCoderCABAC );
+  m_pRoiStatsFile       = NULL;
+  m_roiStatsJson        = false;
+  m_numRoiStatsRecords  = 0;
 }
 
 TEncGOP::~TEncGOP()
@@ -130,6 +139,8 @@ Void  TEncGOP::destroy()
     m_FGAnalyser.destroy();
   }
 #endif
+  xCloseRoiStatsFile( NULL );
+  m_cRoiPropagator.destroy();
 }
 
 Void TEncGOP::init ( TEncTop* pcTEncTop )
@@ -150,6 +161,10 @@ Void TEncGOP::init ( TEncTop* pcTEncTop )
   m_pcRateCtrl           = pcTEncTop->getRateCtrl();
   m_lastBPSEI          = 0;
   m_totalCoded         = 0;
+  if (pcTEncTop->getRoiMaskReader()->isOpen() && pcTEncTop->getRoiMaskReader()->isSequence() && m_pcCfg->getRoiMaskInterval() > 1)
+  {
+    m_cRoiPropagator.create( m_pcCfg->getSourceWidth(), m_pcCfg->getSourceHeight(), m_pcCfg->getRoiMaskDilation() );
+  }
 #if JVET_X0048_X0103_FILM_GRAIN
   if (m_pcCfg->getFilmGrainAnalysisEnabled())
   {
@@ -723,6 +738,23 @@ Void TEncGOP::xCreatePerPictureSEIMessages (Int picInGOP, SEIMessages& seiMessag
       delete seiAnnotatedRegions;
     }
   }
+  // insert one Annotated Region SEI for the picture if the objects of the ROI mask changed
+  const TEncPic *pcEPic = dynamic_cast<TEncPic*>(slice->getPic());
+  const TEncRoiMap *pcRoiMap = (pcEPic != NULL) ? pcEPic->getRoiMap() : NULL;
+  if (m_pcCfg->getAnnotatedRegionSEIFromRoiMask() && pcRoiMap != NULL && pcRoiMap->isActive())
+  {
+    SEIAnnotatedRegions *seiAnnotatedRegions = new SEIAnnotatedRegions();
+    const Bool success = m_seiEncoder.initSEIAnnotatedRegionsFromRoiMap(seiAnnotatedRegions, pcRoiMap, slice->isIRAP());
+
+    if (success)
+    {
+      seiMessages.push_back(seiAnnotatedRegions);
+    }
+    else
+    {
+      delete seiAnnotatedRegions;
+    }
+  }
   // insert one Regional Nesting SEI for the picture (if the file exists)
   if (!m_pcCfg->getRegionalNestingSEIFileRoot().empty())
   {
@@ -1305,6 +1337,10 @@ Void TEncGOP::compressGOP( Int iPOCLast, Int iNumPicRcvd, TComList<TComPic*>& rc
   AccessUnit::iterator  itLocationToPushSliceHeaderNALU; // used to store location where NALU containing slice header is to be inserted
 
   xInitGOP( iPOCLast, iNumPicRcvd, isField );
+  if ( m_cRoiPropagator.isActive() )
+  {
+    xPropagateRoiMaps( iPOCLast, iNumPicRcvd, rcListPic );
+  }
 
   m_iNumPicCoded = 0;
   SEIMessages leadingSeiMessages;
@@ -1314,6 +1350,11 @@ Void TEncGOP::compressGOP( Int iPOCLast, Int iNumPicRcvd, TComList<TComPic*>& rc
   std::deque<DUData> duData;
   SEIDecodingUnitInfo decodingUnitInfoSEI;
 
+  // pictures prepared in coding order and not yet written; with frame threads, pictures that do not reference each other
+  // are compressed together before they are written in coding order
+  const Bool bFrameParallel = xUseFrameThreads( isField );
+  std::vector<PictureJob> pictureJobs;
+
   EfficientFieldIRAPMapping effFieldIRAPMap;
   if (m_pcCfg->getEfficientFieldIRAPEnabled())
   {
@@ -1341,9 +1382,9 @@ Void TEncGOP::compressGOP( Int iPOCLast, Int iNumPicRcvd, TComList<TComPic*>& rc
     Int iTimeOffset;
     Int pocCurr;
 
-    if(iPOCLast == 0) //case first frame or first top field
+    if(iPOCLast == m_intraPeriodStart) //case first frame or first top field, or scene cut
     {
-      pocCurr=0;
+      pocCurr=iPOCLast;
       iTimeOffset = 1;
     }
     else if(iPOCLast == 1 && isField) //case first bottom field, just like the first frame, the poc computation is not right anymore, we set the right value
@@ -1357,7 +1398,8 @@ Void TEncGOP::compressGOP( Int iPOCLast, Int iNumPicRcvd, TComList<TComPic*>& rc
       iTimeOffset = m_pcCfg->getGOPEntry(iGOPid).m_POC;
     }
 
-    if(pocCurr>=m_pcCfg->getFramesToBeEncoded())
+    // a GOP ended early by a scene cut, or the last GOP, only contains the received pictures
+    if(pocCurr>=m_pcCfg->getFramesToBeEncoded() || (!isField && pocCurr > iPOCLast))
     {
       if (m_pcCfg->getEfficientFieldIRAPEnabled())
       {
@@ -1366,6 +1408,12 @@ Void TEncGOP::compressGOP( Int iPOCLast, Int iNumPicRcvd, TComList<TComPic*>& rc
       continue;
     }
 
+    // a picture waits for the pending pictures it may reference, and for all of them if it starts a new coded video sequence
+    if ( !pictureJobs.empty() && xDependsOnPictureJobs( pocCurr, iGOPid, isField, pictureJobs ) )
+    {
+      xEncodePictureJobs( pictureJobs, rcListPic, pcBitstreamRedirect, leadingSeiMessages, nestedSeiMessages, duInfoSeiMessages, trailingSeiMessages, duData, isField, isTff, ip_conversion, snr_conversion, outputLogCtrl );
+    }
+
     if( getNalUnitType(pocCurr, m_iLastIDR, isField) == NAL_UNIT_CODED_SLICE_IDR_W_RADL || getNalUnitType(pocCurr, m_iLastIDR, isField) == NAL_UNIT_CODED_SLICE_IDR_N_LP )
     {
       m_iLastIDR = pocCurr;
@@ -1383,13 +1431,20 @@ Void TEncGOP::compressGOP( Int iPOCLast, Int iNumPicRcvd, TComList<TComPic*>& rc
 #endif
 
 #endif
+    TEncSlice* pcSliceEncoder = bFrameParallel ? m_pcEncTop->getFrameSliceEncoder( (UInt)pictureJobs.size() ) : m_pcSliceEncoder;
+
     //  Slice data initialization
     pcPic->clearSliceBuffer();
     pcPic->allocateNewSlice();
-    m_pcSliceEncoder->setSliceIdx(0);
+    pcSliceEncoder->setSliceIdx(0);
     pcPic->setCurrSliceIdx(0);
 
-    m_pcSliceEncoder->initEncSlice ( pcPic, iPOCLast, pocCurr, iGOPid, pcSlice, isField );
+    pcSliceEncoder->initEncSlice ( pcPic, iPOCLast, pocCurr, iGOPid, pcSlice, isField );
+
+    if (m_pcEncTop->getRoiMaskReader()->isOpen())
+    {
+      dynamic_cast<TEncPic*>(pcPic)->setRoiMap( m_cRoiPropagator.isActive() ? m_cRoiPropagator.getMap( pocCurr ) : m_pcEncTop->getRoiMaskReader()->getMap( pocCurr ) );
+    }
 
     pcSlice->setLastIDR(m_iLastIDR);
     pcSlice->setSliceIdx(0);
@@ -1631,7 +1686,7 @@ Void TEncGOP::compressGOP( Int iPOCLast, Int iNumPicRcvd, TComList<TComPic*>& rc
     // set adaptive search range for non-intra-slices
     if (m_pcCfg->getUseASR() && pcSlice->getSliceType()!=I_SLICE)
     {
-      m_pcSliceEncoder->setSearchRange(pcSlice);
+      pcSliceEncoder->setSearchRange(pcSlice);
     }
 
     Bool bGPBcheck=false;
@@ -1662,10 +1717,7 @@ Void TEncGOP::compressGOP( Int iPOCLast, Int iNumPicRcvd, TComList<TComPic*>& rc
 
 
     Double lambda            = 0.0;
-    Int actualHeadBits       = 0;
-    Int actualTotalBits      = 0;
     Int estimatedBits        = 0;
-    Int tmpBitsBeforeWriting = 0;
     if ( m_pcCfg->getUseRateCtrl() ) // TODO: does this work with multiple slices and slice-segments?
     {
       Int frameLevel = m_pcRateCtrl->getRCSeq()->getGOPID2Level( iGOPid );
@@ -1756,63 +1808,389 @@ Void TEncGOP::compressGOP( Int iPOCLast, Int iNumPicRcvd, TComList<TComPic*>& rc
       sliceQP = Clip3( -pcSlice->getSPS()->getQpBDOffset(CHANNEL_TYPE_LUMA), MAX_QP, sliceQP );
       m_pcRateCtrl->getRCPic()->setPicEstQP( sliceQP );
 
+      const TEncPic    *pcEPic   = dynamic_cast<TEncPic*>(pcPic);
+      const TEncRoiMap *pcRoiMap = (pcEPic != NULL) ? pcEPic->getRoiMap() : NULL;
+      if ( m_pcCfg->getUseRoiRateCtrl() && pcRoiMap != NULL && pcRoiMap->isActive() )
+      {
+        // foreground coverage of each CTU, counted in quantization groups as the foreground QP offset applies to every group touching the mask
+        const Int ctuSize   = pcSlice->getSPS()->getMaxCUWidth();
+        const Int qgSize    = ctuSize >> pcSlice->getPPS()->getMaxCuDQPDepth();
+        const Int picWidth  = pcSlice->getSPS()->getPicWidthInLumaSamples();
+        const Int picHeight = pcSlice->getSPS()->getPicHeightInLumaSamples();
+        std::vector<Double> coverage( pcPic->getNumberOfCtusInFrame() );
+        for ( UInt ctuRsAddr = 0; ctuRsAddr < pcPic->getNumberOfCtusInFrame(); ctuRsAddr++ )
+        {
+          const Int ctuX = ( ctuRsAddr % pcPic->getFrameWidthInCtus() ) * ctuSize;
+          const Int ctuY = ( ctuRsAddr / pcPic->getFrameWidthInCtus() ) * ctuSize;
+          const Int ctuW = min( ctuSize, picWidth - ctuX );
+          const Int ctuH = min( ctuSize, picHeight - ctuY );
+          Int foregroundArea = 0;
+          for ( Int y = ctuY; y < ctuY + ctuH; y += qgSize )
+          {
+            for ( Int x = ctuX; x < ctuX + ctuW; x += qgSize )
+            {
+              const Int w = min( qgSize, picWidth - x );
+              const Int h = min( qgSize, picHeight - y );
+              foregroundArea += pcRoiMap->intersects( x, y, w, h ) ? w * h : 0;
+            }
+          }
+          coverage[ctuRsAddr] = Double( foregroundArea ) / Double( ctuW * ctuH );
+        }
+        m_pcRateCtrl->getRCPic()->initRoiAllocation( coverage, m_pcCfg->getRCRoiForegroundBitShare(), m_pcCfg->getRCRoiLambdaRatio(), lambda );
+      }
+
       m_pcSliceEncoder->resetQP( pcPic, sliceQP, lambda );
     }
 
-    UInt uiNumSliceSegments = 1;
-
-    // Allocate some coders, now the number of tiles are known.
-    const Int numSubstreamsColumns = (pcSlice->getPPS()->getNumTileColumnsMinus1() + 1);
-    const Int numSubstreamRows     = pcSlice->getPPS()->getEntropyCodingSyncEnabledFlag() ? pcPic->getFrameHeightInCtus() : (pcSlice->getPPS()->getNumTileRowsMinus1() + 1);
-    const Int numSubstreams        = numSubstreamRows * numSubstreamsColumns;
-    std::vector<TComOutputBitstream> substreamsOut(numSubstreams);
+    PictureJob job;
+    job.iGOPid             = iGOPid;
+    job.pocCurr            = pocCurr;
+    job.IRAPGOPid          = m_pcCfg->getEfficientFieldIRAPEnabled() ? effFieldIRAPMap.GetIRAPGOPid() : 0;
+    job.iBeforeTime        = iBeforeTime;
+    job.pcPic              = pcPic;
+    job.pcPicYuvRecOut     = pcPicYuvRecOut;
+    job.pAccessUnit        = &accessUnit;
+    job.pcSliceEncoder     = pcSliceEncoder;
+    job.lambda             = lambda;
+    job.estimatedBits      = estimatedBits;
+    job.uiNumSliceSegments = 1;
+    pictureJobs.push_back( job );
+    if ( !bFrameParallel )
+    {
+      xEncodePictureJobs( pictureJobs, rcListPic, pcBitstreamRedirect, leadingSeiMessages, nestedSeiMessages, duInfoSeiMessages, trailingSeiMessages, duData, isField, isTff, ip_conversion, snr_conversion, outputLogCtrl );
+    }
 
-    // now compress (trial encode) the various slice segments (slices, and dependent slices)
+    if (m_pcCfg->getEfficientFieldIRAPEnabled())
     {
-      const UInt numberOfCtusInFrame=pcPic->getPicSym()->getNumberOfCtusInFrame();
-      pcSlice->setSliceCurStartCtuTsAddr( 0 );
-      pcSlice->setSliceSegmentCurStartCtuTsAddr( 0 );
+      iGOPid=effFieldIRAPMap.restoreGOPid(iGOPid);
+    }
+  } // iGOPid-loop
+
+  xEncodePictureJobs( pictureJobs, rcListPic, pcBitstreamRedirect, leadingSeiMessages, nestedSeiMessages, duInfoSeiMessages, trailingSeiMessages, duData, isField, isTff, ip_conversion, snr_conversion, outputLogCtrl );
 
-      for(UInt nextCtuTsAddr = 0; nextCtuTsAddr < numberOfCtusInFrame; )
+  delete pcBitstreamRedirect;
+
+  assert ( (m_iNumPicCoded == iNumPicRcvd) );
+}
+
+/** Check whether a picture has to wait until the pending pictures of the GOP are coded. These are the pictures in the
+ * reference picture set the picture will select, referenced or only kept, since the set is applied when the picture
+ * is prepared and a pending picture is not reconstructed yet. An IDR picture and a picture that resets the encoder
+ * decisions after an IRAP wait for all pending pictures, as both change state that the pending pictures still use
+ * when they are written.
+ * \param pocCurr  POC of the picture
+ * \param iGOPid   index of the picture in the GOP
+ * \param isField  field coding
+ * \param jobs     pending pictures
+ */
+Bool TEncGOP::xDependsOnPictureJobs( Int pocCurr, Int iGOPid, Bool isField, const std::vector<PictureJob> &jobs )
+{
+  const NalUnitType nalUnitType = getNalUnitType( pocCurr, m_iLastIDR, isField );
+  if ( nalUnitType == NAL_UNIT_CODED_SLICE_IDR_W_RADL || nalUnitType == NAL_UNIT_CODED_SLICE_IDR_N_LP )
+  {
+    return true;
+  }
+  if ( pocCurr > m_RASPOCforResetEncoder && m_pcCfg->getResetEncoderStateAfterIRAP() )
+  {
+    return true;
+  }
+
+  const GOPEntry &entry = m_pcCfg->getGOPEntry( m_pcEncTop->getReferencePictureSetIdxForSOP( pocCurr, iGOPid ) );
+  for ( Int i = 0; i < entry.m_numRefPics; i++ )
+  {
+    for ( std::size_t j = 0; j < jobs.size(); j++ )
+    {
+      if ( jobs[j].pocCurr == pocCurr + entry.m_referencePics[i] )
       {
-        m_pcSliceEncoder->precompressSlice( pcPic );
-        m_pcSliceEncoder->compressSlice   ( pcPic, false, false );
+        return true;
+      }
+    }
+  }
+  return false;
+}
 
-        const UInt curSliceSegmentEnd = pcSlice->getSliceSegmentCurEndCtuTsAddr();
-        if (curSliceSegmentEnd < numberOfCtusInFrame)
+/** Check whether the pictures of the GOP can be compressed by the frame threads. The QP adaptations that carry state
+ * from one picture to the next need the pictures in coding order, and the fields of field coding are paired, so these
+ * stay on a single thread. Rate control is rejected together with frame threads by the configuration.
+ * \param isField  field coding
+ */
+Bool TEncGOP::xUseFrameThreads( Bool isField )
+{
+#if ENC_DEC_TRACE
+  return false; // the trace of the pictures would be interleaved
+#else
+  return m_pcCfg->getNumFrameThreads() > 1
+      && !isField
+#if ADAPTIVE_QP_SELECTION
+      && !m_pcCfg->getUseAdaptQpSelect()
+#endif
+#if JVET_V0078
+      && !m_pcCfg->getSmoothQPReductionEnable()
+#endif
+#if JVET_Y0077_BIM
+      && !m_pcCfg->getBIM()
+#endif
+      && !m_pcCfg->getLumaLevelToDeltaQPMapping().isEnabled();
+#endif
+}
+
+/** Compress (trial encode) the slice segments of a prepared picture with the slice encoder of the job.
+ * \param job  prepared picture
+ */
+Void TEncGOP::xCompressPicture( PictureJob &job, Bool bLoopFilterThread )
+{
+  TComPic*   pcPic          = job.pcPic;
+  TEncSlice* pcSliceEncoder = job.pcSliceEncoder;
+  TComSlice* pcSlice        = pcPic->getSlice(0);
+  UInt uiNumSliceSegments   = 1;
+
+  job.bLoopFiltered = bLoopFilterThread;
+  if ( bLoopFilterThread )
+  {
+    m_pcLoopFilter->setCfg( pcSlice->getPPS()->getLoopFilterAcrossTilesEnabledFlag() );
+    m_numCompressedCtusInRow.assign( pcPic->getFrameHeightInCtus(), 0 );
+    m_numCompressedCtuRows = 0;
+    m_pcLoopFilterPic      = pcPic;
+    m_loopFilterThread     = std::thread( &TEncGOP::xLoopFilterCtuRows, this, &job, pcSlice );
+  }
+
+  // now compress (trial encode) the various slice segments (slices, and dependent slices)
+  {
+    const UInt numberOfCtusInFrame=pcPic->getPicSym()->getNumberOfCtusInFrame();
+    pcSlice->setSliceCurStartCtuTsAddr( 0 );
+    pcSlice->setSliceSegmentCurStartCtuTsAddr( 0 );
+
+    for(UInt nextCtuTsAddr = 0; nextCtuTsAddr < numberOfCtusInFrame; )
+    {
+      pcSliceEncoder->precompressSlice( pcPic );
+      pcSliceEncoder->compressSlice   ( pcPic, false, false );
+
+      const UInt curSliceSegmentEnd = pcSlice->getSliceSegmentCurEndCtuTsAddr();
+      if (curSliceSegmentEnd < numberOfCtusInFrame)
+      {
+        const Bool bNextSegmentIsDependentSlice=curSliceSegmentEnd<pcSlice->getSliceCurEndCtuTsAddr();
+        const UInt sliceBits=pcSlice->getSliceBits();
+        pcPic->allocateNewSlice();
+        // prepare for next slice
+        pcPic->setCurrSliceIdx                    ( uiNumSliceSegments );
+        pcSliceEncoder->setSliceIdx             ( uiNumSliceSegments   );
+        pcSlice = pcPic->getSlice                 ( uiNumSliceSegments   );
+        assert(pcSlice->getPPS()!=0);
+        pcSlice->copySliceInfo                    ( pcPic->getSlice(uiNumSliceSegments-1)  );
+        pcSlice->setSliceIdx                      ( uiNumSliceSegments   );
+        if (bNextSegmentIsDependentSlice)
         {
-          const Bool bNextSegmentIsDependentSlice=curSliceSegmentEnd<pcSlice->getSliceCurEndCtuTsAddr();
-          const UInt sliceBits=pcSlice->getSliceBits();
-          pcPic->allocateNewSlice();
-          // prepare for next slice
-          pcPic->setCurrSliceIdx                    ( uiNumSliceSegments );
-          m_pcSliceEncoder->setSliceIdx             ( uiNumSliceSegments   );
-          pcSlice = pcPic->getSlice                 ( uiNumSliceSegments   );
-          assert(pcSlice->getPPS()!=0);
-          pcSlice->copySliceInfo                    ( pcPic->getSlice(uiNumSliceSegments-1)  );
-          pcSlice->setSliceIdx                      ( uiNumSliceSegments   );
-          if (bNextSegmentIsDependentSlice)
-          {
-            pcSlice->setSliceBits(sliceBits);
-          }
-          else
-          {
-            pcSlice->setSliceCurStartCtuTsAddr      ( curSliceSegmentEnd );
-            pcSlice->setSliceBits(0);
-          }
-          pcSlice->setDependentSliceSegmentFlag(bNextSegmentIsDependentSlice);
-          pcSlice->setSliceSegmentCurStartCtuTsAddr ( curSliceSegmentEnd );
-          // TODO: optimise cabac_init during compress slice to improve multi-slice operation
-          // pcSlice->setEncCABACTableIdx(m_pcSliceEncoder->getEncCABACTableIdx());
-          uiNumSliceSegments ++;
+          pcSlice->setSliceBits(sliceBits);
         }
-        nextCtuTsAddr = curSliceSegmentEnd;
+        else
+        {
+          pcSlice->setSliceCurStartCtuTsAddr      ( curSliceSegmentEnd );
+          pcSlice->setSliceBits(0);
+        }
+        pcSlice->setDependentSliceSegmentFlag(bNextSegmentIsDependentSlice);
+        pcSlice->setSliceSegmentCurStartCtuTsAddr ( curSliceSegmentEnd );
+        // TODO: optimise cabac_init during compress slice to improve multi-slice operation
+        // pcSlice->setEncCABACTableIdx(pcSliceEncoder->getEncCABACTableIdx());
+        uiNumSliceSegments ++;
       }
+      nextCtuTsAddr = curSliceSegmentEnd;
     }
+  }
+
+  job.uiNumSliceSegments = uiNumSliceSegments;
+
+  if ( bLoopFilterThread )
+  {
+    m_loopFilterThread.join();
+    m_pcLoopFilterPic = NULL;
+  }
+}
 
-    duData.clear();
-    pcSlice = pcPic->getSlice(0);
+/** Check whether the pictures compressed one after the other can be loop filtered by the loop filter thread while they
+ * are compressed. Selecting the deblocking parameters, testing several slice QPs and the film grain analysis need the
+ * whole compressed picture, so they keep the loop filter after the compression.
+ */
+Bool TEncGOP::xUseLoopFilterThread()
+{
+  if ( !m_pcCfg->getLoopFilterThread() || m_pcCfg->getDeblockingFilterMetric() || m_pcCfg->getDeltaQpRD() > 0 )
+  {
+    return false;
+  }
+#if JVET_X0048_X0103_FILM_GRAIN
+  if ( m_pcCfg->getFilmGrainAnalysisEnabled() )
+  {
+    return false;
+  }
+#endif
+  return true;
+}
 
+/** Report a compressed CTU to the loop filter thread, if it is loop filtering the picture.
+ * \param pcPic      picture class
+ * \param ctuRsAddr  raster scan address of the CTU
+ */
+Void TEncGOP::setCtuCompressed( const TComPic* pcPic, UInt ctuRsAddr )
+{
+  if ( pcPic != m_pcLoopFilterPic )
+  {
+    return;
+  }
+  const UInt frameWidthInCtus = pcPic->getFrameWidthInCtus();
+  std::lock_guard<std::mutex> lock( m_loopFilterMutex );
+  if ( ++m_numCompressedCtusInRow[ctuRsAddr / frameWidthInCtus] == frameWidthInCtus )
+  {
+    while ( m_numCompressedCtuRows < (Int)m_numCompressedCtusInRow.size() && m_numCompressedCtusInRow[m_numCompressedCtuRows] == frameWidthInCtus )
+    {
+      m_numCompressedCtuRows++;
+    }
+    m_loopFilterCond.notify_one();
+  }
+}
+
+/** Deblock and SAO process the CTU rows of a picture while it is compressed, in the same way as xFinishPicture() does
+ * for the whole picture afterwards.
+ * When CTU row N is compressed, CTU row N-2 is deblocked: the intra prediction of row N+1 still reads the non-deblocked
+ * samples of row N, and deblocking row N-1 would modify its last lines. The SAO of a CTU row needs the deblocked samples
+ * of the rows above and below it, so it follows two rows behind the deblocking, and the SAO statistics of the
+ * non-deblocked samples of a row are collected before the row below it is deblocked.
+ * \param job      picture being compressed
+ * \param pcSlice  first slice of the picture
+ */
+Void TEncGOP::xLoopFilterCtuRows( PictureJob *job, TComSlice* pcSlice )
+{
+  TComPic*   pcPic      = job->pcPic;
+  const Int  numCtuRows = (Int)pcPic->getFrameHeightInCtus();
+  const Bool bUseSAO    = pcSlice->getSPS()->getUseSAO();
+  const Bool bPreDBF    = bUseSAO && m_pcCfg->getSaoCtuBoundary();
+  TComBitCounter tempBitCounter;
+
+  for ( Int n = 0; n < numCtuRows + 4; n++ )
+  {
+    // wait for CTU row n to be compressed
+    {
+      std::unique_lock<std::mutex> lock( m_loopFilterMutex );
+      while ( m_numCompressedCtuRows < std::min( n + 1, numCtuRows ) )
+      {
+        m_loopFilterCond.wait( lock );
+      }
+    }
+
+    if ( bPreDBF && n >= 1 && n - 1 < numCtuRows )
+    {
+      m_pcSAO->getPreDBFStatisticsCtuRow( pcPic, n - 1 );
+    }
+    if ( n >= 2 && n - 2 < numCtuRows )
+    {
+      m_pcLoopFilter->loopFilterCtuRow( pcPic, n - 2 );
+    }
+    if ( !bUseSAO )
+    {
+      continue;
+    }
+    if ( n == 3 )
+    {
+      // the QP and lambdas of the slice are settled once its compression has started
+      tempBitCounter.resetBits();
+      m_cLoopFilterSbacCoder.setBitstream( &tempBitCounter );
+      m_pcSAO->initRDOCabacCoder( &m_cLoopFilterSbacCoder, pcSlice );
+      m_pcSAO->SAOStartPicture( pcPic, job->saoSliceEnabled, pcSlice->getLambdas(), m_pcCfg->getSaoEncodingRate(), m_pcCfg->getSaoEncodingRateChroma() );
+    }
+    if ( n >= 3 && n - 3 < numCtuRows )
+    {
+      m_pcSAO->SAOCopyCtuRow( pcPic, n - 3 );
+    }
+    if ( n >= 4 )
+    {
+      m_pcSAO->SAODecideCtuRow( pcPic, job->saoSliceEnabled, n - 4, bPreDBF );
+      m_pcSAO->PCMLFDisableProcessCtuRow( pcPic, n - 4 );
+    }
+  }
+
+  if ( bUseSAO )
+  {
+    m_pcSAO->SAOFinishPicture( pcPic, job->saoSliceEnabled, m_pcCfg->getTestSAODisableAtPictureLevel(), m_pcCfg->getSaoEncodingRate(), m_pcCfg->getSaoEncodingRateChroma() );
+    m_cLoopFilterSbacCoder.setBitstream( NULL );
+  }
+}
+
+/** Compress the prepared pictures. Up to FrameThreads pictures are compressed at the same time, each with its own
+ * slice encoder, so the result does not depend on the number of threads.
+ * \param jobs  prepared pictures, in coding order
+ */
+Void TEncGOP::xCompressPictureJobs( std::vector<PictureJob> &jobs )
+{
+  const UInt numThreads = std::min<UInt>( (UInt)m_pcCfg->getNumFrameThreads(), (UInt)jobs.size() );
+  if ( numThreads <= 1 )
+  {
+    const Bool bLoopFilterThread = xUseLoopFilterThread();
+    for ( std::size_t i = 0; i < jobs.size(); i++ )
+    {
+      xCompressPicture( jobs[i], bLoopFilterThread );
+    }
+    return;
+  }
+
+  std::atomic<std::size_t> nextJob( 0 );
+  auto compressJobs = [this, &jobs, &nextJob]()
+  {
+    for ( std::size_t i = nextJob++; i < jobs.size(); i = nextJob++ )
+    {
+      xCompressPicture( jobs[i], false );
+    }
+  };
+  std::vector<std::thread> threads;
+  for ( UInt i = 1; i < numThreads; i++ )
+  {
+    threads.push_back( std::thread( compressJobs ) );
+  }
+  compressJobs();
+  for ( std::size_t i = 0; i < threads.size(); i++ )
+  {
+    threads[i].join();
+  }
+}
+
+/** Loop filter, entropy code and write a compressed picture, and update the statistics.
+ * \param job  compressed picture
+ */
+Void TEncGOP::xFinishPicture( PictureJob &job, TComList<TComPic*>& rcListPic, TComOutputBitstream* pcBitstreamRedirect,
+                              SEIMessages& leadingSeiMessages, SEIMessages& nestedSeiMessages, SEIMessages& duInfoSeiMessages, SEIMessages& trailingSeiMessages, std::deque<DUData>& duData,
+                              Bool isField, Bool isTff, const InputColourSpaceConversion ip_conversion, const InputColourSpaceConversion snr_conversion, const TEncAnalyze::OutputLogControl &outputLogCtrl )
+{
+  const Int   iGOPid             = job.iGOPid;
+  const Int   pocCurr            = job.pocCurr;
+  TComPic*    pcPic              = job.pcPic;
+  TComPicYuv* pcPicYuvRecOut     = job.pcPicYuvRecOut;
+  AccessUnit& accessUnit         = *job.pAccessUnit;
+  const UInt  uiNumSliceSegments = job.uiNumSliceSegments;
+  const Double lambda            = job.lambda;
+  const Int   estimatedBits      = job.estimatedBits;
+  TComSlice*  pcSlice            = pcPic->getSlice(0);
+  Int actualHeadBits       = 0;
+  Int actualTotalBits      = 0;
+  Int tmpBitsBeforeWriting = 0;
+#if MCTS_EXTRACTION
+  SliceType  encCABACTableIdx;
+  Bool encCabacInitFlag;
+#endif
+
+  // Allocate some coders, now the number of tiles are known.
+  const Int numSubstreamsColumns = (pcSlice->getPPS()->getNumTileColumnsMinus1() + 1);
+  const Int numSubstreamRows     = pcSlice->getPPS()->getEntropyCodingSyncEnabledFlag() ? pcPic->getFrameHeightInCtus() : (pcSlice->getPPS()->getNumTileRowsMinus1() + 1);
+  const Int numSubstreams        = numSubstreamRows * numSubstreamsColumns;
+  std::vector<TComOutputBitstream> substreamsOut(numSubstreams);
+
+  // pictures prepared after this one may already have dropped it from their reference picture sets, but it is written
+  // as a reference picture, as it is when the next picture is only prepared after it has been written
+  const Bool bReferenced = pcSlice->isReferenced();
+  pcSlice->setReferenced( true );
+
+  duData.clear();
+  pcSlice = pcPic->getSlice(0);
+
+  // the loop filter thread has already deblocked and SAO processed the picture
+  if ( !job.bLoopFiltered )
+  {
     // SAO parameter estimation using non-deblocked pixels for CTU bottom and right boundary areas
     if( pcSlice->getSPS()->getUseSAO() && m_pcCfg->getSaoCtuBoundary() )
     {
@@ -1834,63 +2212,66 @@ Void TEncGOP::compressGOP( Int iPOCLast, Int iNumPicRcvd, TComList<TComPic*>& rc
       }
     }
     m_pcLoopFilter->loopFilterPic( pcPic );
+  }
 
 #if JVET_X0048_X0103_FILM_GRAIN
-    if (m_pcCfg->getFilmGrainAnalysisEnabled())
+  if (m_pcCfg->getFilmGrainAnalysisEnabled())
+  {
+    int  filteredFrame = m_pcCfg->getIntraPeriod() < 1 ? 2 * m_pcCfg->getFrameRate() : m_pcCfg->getIntraPeriod();
+    bool ready_to_analyze = pcPic->getPOC() % filteredFrame ? false : true; // either it is mctf denoising or external source for film grain analysis. note: if mctf is used, it is different from mctf for encoding.
+    if (ready_to_analyze)
     {
-      int  filteredFrame = m_pcCfg->getIntraPeriod() < 1 ? 2 * m_pcCfg->getFrameRate() : m_pcCfg->getIntraPeriod();
-      bool ready_to_analyze = pcPic->getPOC() % filteredFrame ? false : true; // either it is mctf denoising or external source for film grain analysis. note: if mctf is used, it is different from mctf for encoding.
-      if (ready_to_analyze)
-      {
-          m_FGAnalyser.initBufs(pcPic);
-          m_FGAnalyser.estimate_grain(pcPic);
-      }
+        m_FGAnalyser.initBufs(pcPic);
+        m_FGAnalyser.estimate_grain(pcPic);
     }
+  }
 #endif
 
-    /////////////////////////////////////////////////////////////////////////////////////////////////// File writing
-    // Set entropy coder
-    m_pcEntropyCoder->setEntropyCoder   ( m_pcCavlcCoder );
+  /////////////////////////////////////////////////////////////////////////////////////////////////// File writing
+  // Set entropy coder
+  m_pcEntropyCoder->setEntropyCoder   ( m_pcCavlcCoder );
 
-    // write various parameter sets
-    //bool writePS = m_bSeqFirst || (m_pcCfg->getReWriteParamSetsFlag() && (pcPic->getSlice(0)->getSliceType() == I_SLICE));
-    bool writePS = m_bSeqFirst || (m_pcCfg->getReWriteParamSetsFlag() && (pcSlice->isIRAP()));
-    if (writePS)
-    {
-      m_pcEncTop->setParamSetChanged(pcSlice->getSPS()->getSPSId(), pcSlice->getPPS()->getPPSId());
-    }
-    actualTotalBits += xWriteParameterSets(accessUnit, pcSlice, writePS);
+  // write various parameter sets
+  //bool writePS = m_bSeqFirst || (m_pcCfg->getReWriteParamSetsFlag() && (pcPic->getSlice(0)->getSliceType() == I_SLICE));
+  bool writePS = m_bSeqFirst || (m_pcCfg->getReWriteParamSetsFlag() && (pcSlice->isIRAP()));
+  if (writePS)
+  {
+    m_pcEncTop->setParamSetChanged(pcSlice->getSPS()->getSPSId(), pcSlice->getPPS()->getPPSId());
+  }
+  actualTotalBits += xWriteParameterSets(accessUnit, pcSlice, writePS);
 
-    if (writePS)
-    {
-      // create prefix SEI messages at the beginning of the sequence
-      assert(leadingSeiMessages.empty());
+  if (writePS)
+  {
+    // create prefix SEI messages at the beginning of the sequence
+    assert(leadingSeiMessages.empty());
 #if MCTS_EXTRACTION
-      xCreateIRAPLeadingSEIMessages(leadingSeiMessages, m_pcEncTop->getVPS(),  pcSlice->getSPS(), pcSlice->getPPS());
+    xCreateIRAPLeadingSEIMessages(leadingSeiMessages, m_pcEncTop->getVPS(),  pcSlice->getSPS(), pcSlice->getPPS());
 #else
-      xCreateIRAPLeadingSEIMessages(leadingSeiMessages, pcSlice->getSPS(), pcSlice->getPPS());
+    xCreateIRAPLeadingSEIMessages(leadingSeiMessages, pcSlice->getSPS(), pcSlice->getPPS());
 #endif
 
-      m_bSeqFirst = false;
-    }
-    if (m_pcCfg->getAccessUnitDelimiter())
-    {
-      xWriteAccessUnitDelimiter(accessUnit, pcSlice);
-    }
+    m_bSeqFirst = false;
+  }
+  if (m_pcCfg->getAccessUnitDelimiter())
+  {
+    xWriteAccessUnitDelimiter(accessUnit, pcSlice);
+  }
 
-    // reset presence of BP SEI indication
-    m_bufferingPeriodSEIPresentInAU = false;
-    // create prefix SEI associated with a picture
-    xCreatePerPictureSEIMessages(iGOPid, leadingSeiMessages, nestedSeiMessages, pcSlice);
+  // reset presence of BP SEI indication
+  m_bufferingPeriodSEIPresentInAU = false;
+  // create prefix SEI associated with a picture
+  xCreatePerPictureSEIMessages(iGOPid, leadingSeiMessages, nestedSeiMessages, pcSlice);
 
-    /* use the main bitstream buffer for storing the marshalled picture */
-    m_pcEntropyCoder->setBitstream(NULL);
+  /* use the main bitstream buffer for storing the marshalled picture */
+  m_pcEntropyCoder->setBitstream(NULL);
 
-    pcSlice = pcPic->getSlice(0);
+  pcSlice = pcPic->getSlice(0);
 
-    if (pcSlice->getSPS()->getUseSAO())
+  if (pcSlice->getSPS()->getUseSAO())
+  {
+    Bool* sliceEnabled = job.saoSliceEnabled;
+    if ( !job.bLoopFiltered )
     {
-      Bool sliceEnabled[MAX_NUM_COMPONENT];
       TComBitCounter tempBitCounter;
       tempBitCounter.resetBits();
       m_pcEncTop->getRDGoOnSbacCoder()->setBitstream(&tempBitCounter);
@@ -1902,231 +2283,267 @@ Void TEncGOP::compressGOP( Int iPOCLast, Int iNumPicRcvd, TComList<TComPic*>& rc
                           m_pcCfg->getSaoCtuBoundary());
       m_pcSAO->PCMLFDisableProcess(pcPic);
       m_pcEncTop->getRDGoOnSbacCoder()->setBitstream(NULL);
+    }
 
-      //assign SAO slice header
-      for(Int s=0; s< uiNumSliceSegments; s++)
-      {
-        pcPic->getSlice(s)->setSaoEnabledFlag(CHANNEL_TYPE_LUMA, sliceEnabled[COMPONENT_Y]);
-        assert(sliceEnabled[COMPONENT_Cb] == sliceEnabled[COMPONENT_Cr]);
-        pcPic->getSlice(s)->setSaoEnabledFlag(CHANNEL_TYPE_CHROMA, sliceEnabled[COMPONENT_Cb]);
-      }
+    //assign SAO slice header
+    for(Int s=0; s< uiNumSliceSegments; s++)
+    {
+      pcPic->getSlice(s)->setSaoEnabledFlag(CHANNEL_TYPE_LUMA, sliceEnabled[COMPONENT_Y]);
+      assert(sliceEnabled[COMPONENT_Cb] == sliceEnabled[COMPONENT_Cr]);
+      pcPic->getSlice(s)->setSaoEnabledFlag(CHANNEL_TYPE_CHROMA, sliceEnabled[COMPONENT_Cb]);
     }
+  }
 
-    // pcSlice is currently slice 0.
-    std::size_t binCountsInNalUnits   = 0; // For implementation of cabac_zero_word stuffing (section 7.4.3.10)
-    std::size_t numBytesInVclNalUnits = 0; // For implementation of cabac_zero_word stuffing (section 7.4.3.10)
+  // pcSlice is currently slice 0.
+  std::size_t binCountsInNalUnits   = 0; // For implementation of cabac_zero_word stuffing (section 7.4.3.10)
+  std::size_t numBytesInVclNalUnits = 0; // For implementation of cabac_zero_word stuffing (section 7.4.3.10)
 
-    for( UInt sliceSegmentStartCtuTsAddr = 0, sliceIdxCount=0; sliceSegmentStartCtuTsAddr < pcPic->getPicSym()->getNumberOfCtusInFrame(); sliceIdxCount++, sliceSegmentStartCtuTsAddr=pcSlice->getSliceSegmentCurEndCtuTsAddr() )
+  for( UInt sliceSegmentStartCtuTsAddr = 0, sliceIdxCount=0; sliceSegmentStartCtuTsAddr < pcPic->getPicSym()->getNumberOfCtusInFrame(); sliceIdxCount++, sliceSegmentStartCtuTsAddr=pcSlice->getSliceSegmentCurEndCtuTsAddr() )
+  {
+    pcSlice = pcPic->getSlice(sliceIdxCount);
+    if(sliceIdxCount > 0 && pcSlice->getSliceType()!= I_SLICE)
     {
-      pcSlice = pcPic->getSlice(sliceIdxCount);
-      if(sliceIdxCount > 0 && pcSlice->getSliceType()!= I_SLICE)
-      {
-        pcSlice->checkColRefIdx(sliceIdxCount, pcPic);
-      }
-      pcPic->setCurrSliceIdx(sliceIdxCount);
-      m_pcSliceEncoder->setSliceIdx(sliceIdxCount);
+      pcSlice->checkColRefIdx(sliceIdxCount, pcPic);
+    }
+    pcPic->setCurrSliceIdx(sliceIdxCount);
+    m_pcSliceEncoder->setSliceIdx(sliceIdxCount);
 
-      pcSlice->setRPS(pcPic->getSlice(0)->getRPS());
-      pcSlice->setRPSidx(pcPic->getSlice(0)->getRPSidx());
+    pcSlice->setRPS(pcPic->getSlice(0)->getRPS());
+    pcSlice->setRPSidx(pcPic->getSlice(0)->getRPSidx());
 
-      for ( UInt ui = 0 ; ui < numSubstreams; ui++ )
-      {
-        substreamsOut[ui].clear();
-      }
+    for ( UInt ui = 0 ; ui < numSubstreams; ui++ )
+    {
+      substreamsOut[ui].clear();
+    }
 
-      m_pcEntropyCoder->setEntropyCoder   ( m_pcCavlcCoder );
-      m_pcEntropyCoder->resetEntropy      ( pcSlice );
-      /* start slice NALunit */
-      OutputNALUnit nalu( pcSlice->getNalUnitType(), pcSlice->getTLayer() );
-      m_pcEntropyCoder->setBitstream(&nalu.m_Bitstream);
+    m_pcEntropyCoder->setEntropyCoder   ( m_pcCavlcCoder );
+    m_pcEntropyCoder->resetEntropy      ( pcSlice );
+    /* start slice NALunit */
+    OutputNALUnit nalu( pcSlice->getNalUnitType(), pcSlice->getTLayer() );
+    m_pcEntropyCoder->setBitstream(&nalu.m_Bitstream);
 
-      pcSlice->setNoRaslOutputFlag(false);
-      if (pcSlice->isIRAP())
+    pcSlice->setNoRaslOutputFlag(false);
+    if (pcSlice->isIRAP())
+    {
+      if (pcSlice->getNalUnitType() >= NAL_UNIT_CODED_SLICE_BLA_W_LP && pcSlice->getNalUnitType() <= NAL_UNIT_CODED_SLICE_IDR_N_LP)
       {
-        if (pcSlice->getNalUnitType() >= NAL_UNIT_CODED_SLICE_BLA_W_LP && pcSlice->getNalUnitType() <= NAL_UNIT_CODED_SLICE_IDR_N_LP)
-        {
-          pcSlice->setNoRaslOutputFlag(true);
-        }
-        //the inference for NoOutputPriorPicsFlag
-        // KJS: This cannot happen at the encoder
-        if (!m_bFirst && pcSlice->isIRAP() && pcSlice->getNoRaslOutputFlag())
+        pcSlice->setNoRaslOutputFlag(true);
+      }
+      //the inference for NoOutputPriorPicsFlag
+      // KJS: This cannot happen at the encoder
+      if (!m_bFirst && pcSlice->isIRAP() && pcSlice->getNoRaslOutputFlag())
+      {
+        if (pcSlice->getNalUnitType() == NAL_UNIT_CODED_SLICE_CRA)
         {
-          if (pcSlice->getNalUnitType() == NAL_UNIT_CODED_SLICE_CRA)
-          {
-            pcSlice->setNoOutputPriorPicsFlag(true);
-          }
+          pcSlice->setNoOutputPriorPicsFlag(true);
         }
       }
+    }
 
-      pcSlice->setEncCABACTableIdx(m_pcSliceEncoder->getEncCABACTableIdx());
+    pcSlice->setEncCABACTableIdx(m_pcSliceEncoder->getEncCABACTableIdx());
 #if MCTS_EXTRACTION
-      encCABACTableIdx = pcSlice->getEncCABACTableIdx();
-      encCabacInitFlag = (pcSlice->getSliceType() != encCABACTableIdx && encCABACTableIdx != I_SLICE) ? true : false;
-      pcSlice->setCabacInitFlag(encCabacInitFlag);
+    encCABACTableIdx = pcSlice->getEncCABACTableIdx();
+    encCabacInitFlag = (pcSlice->getSliceType() != encCABACTableIdx && encCABACTableIdx != I_SLICE) ? true : false;
+    pcSlice->setCabacInitFlag(encCabacInitFlag);
 #endif
-      tmpBitsBeforeWriting = m_pcEntropyCoder->getNumberOfWrittenBits();
-      m_pcEntropyCoder->encodeSliceHeader(pcSlice);
-      actualHeadBits += ( m_pcEntropyCoder->getNumberOfWrittenBits() - tmpBitsBeforeWriting );
+    tmpBitsBeforeWriting = m_pcEntropyCoder->getNumberOfWrittenBits();
+    m_pcEntropyCoder->encodeSliceHeader(pcSlice);
+    actualHeadBits += ( m_pcEntropyCoder->getNumberOfWrittenBits() - tmpBitsBeforeWriting );
 
-      pcSlice->setFinalized(true);
+    pcSlice->setFinalized(true);
 
-      pcSlice->clearSubstreamSizes(  );
-      {
-        UInt numBinsCoded = 0;
-        m_pcSliceEncoder->encodeSlice(pcPic, &(substreamsOut[0]), numBinsCoded);
-        binCountsInNalUnits+=numBinsCoded;
-      }
+    pcSlice->clearSubstreamSizes(  );
+    {
+      UInt numBinsCoded = 0;
+      m_pcSliceEncoder->encodeSlice(pcPic, &(substreamsOut[0]), numBinsCoded);
+      binCountsInNalUnits+=numBinsCoded;
+    }
 
-      {
-        // Construct the final bitstream by concatenating substreams.
-        // The final bitstream is either nalu.m_Bitstream or pcBitstreamRedirect;
-        // Complete the slice header info.
-        m_pcEntropyCoder->setEntropyCoder   ( m_pcCavlcCoder );
-        m_pcEntropyCoder->setBitstream(&nalu.m_Bitstream);
-        m_pcEntropyCoder->encodeTilesWPPEntryPoint( pcSlice );
+    {
+      // Construct the final bitstream by concatenating substreams.
+      // The final bitstream is either nalu.m_Bitstream or pcBitstreamRedirect;
+      // Complete the slice header info.
+      m_pcEntropyCoder->setEntropyCoder   ( m_pcCavlcCoder );
+      m_pcEntropyCoder->setBitstream(&nalu.m_Bitstream);
+      m_pcEntropyCoder->encodeTilesWPPEntryPoint( pcSlice );
 
-        // Append substreams...
-        TComOutputBitstream *pcOut = pcBitstreamRedirect;
-        const Int numZeroSubstreamsAtStartOfSlice  = pcPic->getSubstreamForCtuAddr(pcSlice->getSliceSegmentCurStartCtuTsAddr(), false, pcSlice);
-        const Int numSubstreamsToCode  = pcSlice->getNumberOfSubstreamSizes()+1;
-        for ( UInt ui = 0 ; ui < numSubstreamsToCode; ui++ )
-        {
-          pcOut->addSubstream(&(substreamsOut[ui+numZeroSubstreamsAtStartOfSlice]));
-        }
+      // Append substreams...
+      TComOutputBitstream *pcOut = pcBitstreamRedirect;
+      const Int numZeroSubstreamsAtStartOfSlice  = pcPic->getSubstreamForCtuAddr(pcSlice->getSliceSegmentCurStartCtuTsAddr(), false, pcSlice);
+      const Int numSubstreamsToCode  = pcSlice->getNumberOfSubstreamSizes()+1;
+      for ( UInt ui = 0 ; ui < numSubstreamsToCode; ui++ )
+      {
+        pcOut->addSubstream(&(substreamsOut[ui+numZeroSubstreamsAtStartOfSlice]));
       }
+    }
+
+    // If current NALU is the first NALU of slice (containing slice header) and more NALUs exist (due to multiple dependent slices) then buffer it.
+    // If current NALU is the last NALU of slice and a NALU was buffered, then (a) Write current NALU (b) Update an write buffered NALU at approproate location in NALU list.
+    Bool bNALUAlignedWrittenToList    = false; // used to ensure current NALU is not written more than once to the NALU list.
+    xAttachSliceDataToNalUnit(nalu, pcBitstreamRedirect);
+    accessUnit.push_back(new NALUnitEBSP(nalu));
+    actualTotalBits += UInt(accessUnit.back()->m_nalUnitData.str().size()) * 8;
+    numBytesInVclNalUnits += (std::size_t)(accessUnit.back()->m_nalUnitData.str().size());
+    bNALUAlignedWrittenToList = true;
 
-      // If current NALU is the first NALU of slice (containing slice header) and more NALUs exist (due to multiple dependent slices) then buffer it.
-      // If current NALU is the last NALU of slice and a NALU was buffered, then (a) Write current NALU (b) Update an write buffered NALU at approproate location in NALU list.
-      Bool bNALUAlignedWrittenToList    = false; // used to ensure current NALU is not written more than once to the NALU list.
-      xAttachSliceDataToNalUnit(nalu, pcBitstreamRedirect);
+    if (!bNALUAlignedWrittenToList)
+    {
+      nalu.m_Bitstream.writeAlignZero();
       accessUnit.push_back(new NALUnitEBSP(nalu));
-      actualTotalBits += UInt(accessUnit.back()->m_nalUnitData.str().size()) * 8;
-      numBytesInVclNalUnits += (std::size_t)(accessUnit.back()->m_nalUnitData.str().size());
-      bNALUAlignedWrittenToList = true;
+    }
 
-      if (!bNALUAlignedWrittenToList)
+    if( ( m_pcCfg->getPictureTimingSEIEnabled() || m_pcCfg->getDecodingUnitInfoSEIEnabled() ) &&
+        ( pcSlice->getSPS()->getVuiParametersPresentFlag() ) &&
+        ( ( pcSlice->getSPS()->getVuiParameters()->getHrdParameters()->getNalHrdParametersPresentFlag() )
+       || ( pcSlice->getSPS()->getVuiParameters()->getHrdParameters()->getVclHrdParametersPresentFlag() ) ) &&
+        ( pcSlice->getSPS()->getVuiParameters()->getHrdParameters()->getSubPicCpbParamsPresentFlag() ) )
+    {
+        UInt numNalus = 0;
+      UInt numRBSPBytes = 0;
+      for (AccessUnit::const_iterator it = accessUnit.begin(); it != accessUnit.end(); it++)
       {
-        nalu.m_Bitstream.writeAlignZero();
-        accessUnit.push_back(new NALUnitEBSP(nalu));
+        numRBSPBytes += UInt((*it)->m_nalUnitData.str().size());
+        numNalus ++;
       }
+      duData.push_back(DUData());
+      duData.back().accumBitsDU = ( numRBSPBytes << 3 );
+      duData.back().accumNalsDU = numNalus;
+    }
+  } // end iteration over slices
 
-      if( ( m_pcCfg->getPictureTimingSEIEnabled() || m_pcCfg->getDecodingUnitInfoSEIEnabled() ) &&
-          ( pcSlice->getSPS()->getVuiParametersPresentFlag() ) &&
-          ( ( pcSlice->getSPS()->getVuiParameters()->getHrdParameters()->getNalHrdParametersPresentFlag() )
-         || ( pcSlice->getSPS()->getVuiParameters()->getHrdParameters()->getVclHrdParametersPresentFlag() ) ) &&
-          ( pcSlice->getSPS()->getVuiParameters()->getHrdParameters()->getSubPicCpbParamsPresentFlag() ) )
-      {
-          UInt numNalus = 0;
-        UInt numRBSPBytes = 0;
-        for (AccessUnit::const_iterator it = accessUnit.begin(); it != accessUnit.end(); it++)
-        {
-          numRBSPBytes += UInt((*it)->m_nalUnitData.str().size());
-          numNalus ++;
-        }
-        duData.push_back(DUData());
-        duData.back().accumBitsDU = ( numRBSPBytes << 3 );
-        duData.back().accumNalsDU = numNalus;
-      }
-    } // end iteration over slices
+  // cabac_zero_words processing
+  cabac_zero_word_padding(pcSlice, pcPic, binCountsInNalUnits, numBytesInVclNalUnits, accessUnit.back()->m_nalUnitData, m_pcCfg->getCabacZeroWordPaddingEnabled());
 
-    // cabac_zero_words processing
-    cabac_zero_word_padding(pcSlice, pcPic, binCountsInNalUnits, numBytesInVclNalUnits, accessUnit.back()->m_nalUnitData, m_pcCfg->getCabacZeroWordPaddingEnabled());
+  pcPic->compressMotion();
 
-    pcPic->compressMotion();
+  //-- For time output for each slice
+  Double dEncTime = (Double)(clock()-job.iBeforeTime) / CLOCKS_PER_SEC;
 
-    //-- For time output for each slice
-    Double dEncTime = (Double)(clock()-iBeforeTime) / CLOCKS_PER_SEC;
+  std::string digestStr;
+  if (m_pcCfg->getDecodedPictureHashSEIType()!=HASHTYPE_NONE)
+  {
+    SEIDecodedPictureHash *decodedPictureHashSei = new SEIDecodedPictureHash();
+    m_seiEncoder.initDecodedPictureHashSEI(decodedPictureHashSei, pcPic, digestStr, pcSlice->getSPS()->getBitDepths());
+    trailingSeiMessages.push_back(decodedPictureHashSei);
+  }
 
-    std::string digestStr;
-    if (m_pcCfg->getDecodedPictureHashSEIType()!=HASHTYPE_NONE)
-    {
-      SEIDecodedPictureHash *decodedPictureHashSei = new SEIDecodedPictureHash();
-      m_seiEncoder.initDecodedPictureHashSEI(decodedPictureHashSei, pcPic, digestStr, pcSlice->getSPS()->getBitDepths());
-      trailingSeiMessages.push_back(decodedPictureHashSei);
-    }
+  m_pcCfg->setEncodedFlag(iGOPid, true);
 
-    m_pcCfg->setEncodedFlag(iGOPid, true);
+  Double PSNR_Y;
 
-    Double PSNR_Y;
+  xCalculateAddPSNRs( isField, isTff, iGOPid, pcPic, accessUnit, rcListPic, dEncTime, ip_conversion, snr_conversion, outputLogCtrl, &PSNR_Y );
+  
+  // Only produce the Green Metadata SEI message with the last picture.
+  if( m_pcCfg->getSEIGreenMetadataInfoSEIEnable() && pcSlice->getPOC() == ( m_pcCfg->getFramesToBeEncoded() - 1 )  )
+  {
+    SEIGreenMetadataInfo *seiGreenMetadataInfo = new SEIGreenMetadataInfo;
+    m_seiEncoder.initSEIGreenMetadataInfo(seiGreenMetadataInfo, (UInt)(PSNR_Y * 100 + 0.5));
+    trailingSeiMessages.push_back(seiGreenMetadataInfo);
+  }
+  
+  xWriteTrailingSEIMessages(trailingSeiMessages, accessUnit, pcSlice->getTLayer(), pcSlice->getSPS());
+  
+  printHash(m_pcCfg->getDecodedPictureHashSEIType(), digestStr);
 
-    xCalculateAddPSNRs( isField, isTff, iGOPid, pcPic, accessUnit, rcListPic, dEncTime, ip_conversion, snr_conversion, outputLogCtrl, &PSNR_Y );
-    
-    // Only produce the Green Metadata SEI message with the last picture.
-    if( m_pcCfg->getSEIGreenMetadataInfoSEIEnable() && pcSlice->getPOC() == ( m_pcCfg->getFramesToBeEncoded() - 1 )  )
+  if ( m_pcCfg->getUseRateCtrl() )
+  {
+    Double avgQP     = m_pcRateCtrl->getRCPic()->calAverageQP();
+    Double avgLambda = m_pcRateCtrl->getRCPic()->calAverageLambda();
+    if ( avgLambda < 0.0 )
     {
-      SEIGreenMetadataInfo *seiGreenMetadataInfo = new SEIGreenMetadataInfo;
-      m_seiEncoder.initSEIGreenMetadataInfo(seiGreenMetadataInfo, (UInt)(PSNR_Y * 100 + 0.5));
-      trailingSeiMessages.push_back(seiGreenMetadataInfo);
+      avgLambda = lambda;
     }
-    
-    xWriteTrailingSEIMessages(trailingSeiMessages, accessUnit, pcSlice->getTLayer(), pcSlice->getSPS());
-    
-    printHash(m_pcCfg->getDecodedPictureHashSEIType(), digestStr);
 
-    if ( m_pcCfg->getUseRateCtrl() )
+    m_pcRateCtrl->getRCPic()->updateAfterPicture( actualHeadBits, actualTotalBits, avgQP, avgLambda, pcSlice->getSliceType());
+    if ( m_pcRateCtrl->getRCPic()->getRoiEnabled() )
     {
-      Double avgQP     = m_pcRateCtrl->getRCPic()->calAverageQP();
-      Double avgLambda = m_pcRateCtrl->getRCPic()->calAverageLambda();
-      if ( avgLambda < 0.0 )
-      {
-        avgLambda = lambda;
-      }
-
-      m_pcRateCtrl->getRCPic()->updateAfterPicture( actualHeadBits, actualTotalBits, avgQP, avgLambda, pcSlice->getSliceType());
-      m_pcRateCtrl->getRCPic()->addToPictureLsit( m_pcRateCtrl->getPicList() );
-
-      m_pcRateCtrl->getRCSeq()->updateAfterPic( actualTotalBits );
-      if ( pcSlice->getSliceType() != I_SLICE )
-      {
-        m_pcRateCtrl->getRCGOP()->updateAfterPicture( actualTotalBits );
-      }
-      else    // for intra picture, the estimated bits are used to update the current status in the GOP
-      {
-        m_pcRateCtrl->getRCGOP()->updateAfterPicture( estimatedBits );
-      }
-      if (m_pcRateCtrl->getCpbSaturationEnabled())
-      {
-        m_pcRateCtrl->updateCpbState(actualTotalBits);
-        printf(" [CPB %6d bits]", m_pcRateCtrl->getCpbState());
-      }
+      m_pcRateCtrl->getRCPic()->updateRoiAfterPicture( (Double)dynamic_cast<TEncPic*>(pcPic)->getRoiRegionBits( ROI_REGION_FOREGROUND ),
+                                                       (Double)dynamic_cast<TEncPic*>(pcPic)->getRoiRegionBits( ROI_REGION_BACKGROUND ), avgLambda );
     }
+    m_pcRateCtrl->getRCPic()->addToPictureLsit( m_pcRateCtrl->getPicList() );
 
-    xCreatePictureTimingSEI(m_pcCfg->getEfficientFieldIRAPEnabled()?effFieldIRAPMap.GetIRAPGOPid():0, leadingSeiMessages, nestedSeiMessages, duInfoSeiMessages, pcSlice, isField, duData);
-    if (m_pcCfg->getScalableNestingSEIEnabled())
+    m_pcRateCtrl->getRCSeq()->updateAfterPic( actualTotalBits );
+    if ( pcSlice->getSliceType() != I_SLICE )
+    {
+      m_pcRateCtrl->getRCGOP()->updateAfterPicture( actualTotalBits );
+    }
+    else    // for intra picture, the estimated bits are used to update the current status in the GOP
     {
-      xCreateScalableNestingSEI (leadingSeiMessages, nestedSeiMessages);
+      m_pcRateCtrl->getRCGOP()->updateAfterPicture( estimatedBits );
     }
-    xWriteLeadingSEIMessages(leadingSeiMessages, duInfoSeiMessages, accessUnit, pcSlice->getTLayer(), pcSlice->getSPS(), duData);
-    xWriteDuSEIMessages(duInfoSeiMessages, accessUnit, pcSlice->getTLayer(), pcSlice->getSPS(), duData);
+    if (m_pcRateCtrl->getCpbSaturationEnabled())
+    {
+      m_pcRateCtrl->updateCpbState(actualTotalBits);
+      printf(" [CPB %6d bits]", m_pcRateCtrl->getCpbState());
+    }
+  }
 
-    pcPic->getPicYuvRec()->copyToPic(pcPicYuvRecOut);
+  xCreatePictureTimingSEI(job.IRAPGOPid, leadingSeiMessages, nestedSeiMessages, duInfoSeiMessages, pcSlice, isField, duData);
+  if (m_pcCfg->getScalableNestingSEIEnabled())
+  {
+    xCreateScalableNestingSEI (leadingSeiMessages, nestedSeiMessages);
+  }
+  xWriteLeadingSEIMessages(leadingSeiMessages, duInfoSeiMessages, accessUnit, pcSlice->getTLayer(), pcSlice->getSPS(), duData);
+  xWriteDuSEIMessages(duInfoSeiMessages, accessUnit, pcSlice->getTLayer(), pcSlice->getSPS(), duData);
 
-    pcPic->setReconMark   ( true );
-    m_bFirst = false;
-    m_iNumPicCoded++;
-    m_totalCoded ++;
-    /* logging: insert a newline at end of picture period */
-    printf("\n");
-    fflush(stdout);
+  pcPic->getPicYuvRec()->copyToPic(pcPicYuvRecOut);
 
-    if (m_pcCfg->getEfficientFieldIRAPEnabled())
-    {
-      iGOPid=effFieldIRAPMap.restoreGOPid(iGOPid);
-    }
+  pcPic->setReconMark   ( true );
+  if (m_pcEncTop->getRoiMaskReader()->isOpen())
+  {
+    dynamic_cast<TEncPic*>(pcPic)->setRoiMap( NULL );
+    m_pcEncTop->getRoiMaskReader()->releaseMap( pocCurr );
+    m_cRoiPropagator.releaseMap( pocCurr );
+  }
+  m_bFirst = false;
+  m_iNumPicCoded++;
+  m_totalCoded ++;
+  /* logging: insert a newline at end of picture period */
+  printf("\n");
+  fflush(stdout);
 #if REDUCED_ENCODER_MEMORY
 
-    pcPic->releaseReconstructionIntermediateData();
-    if (!isField) // don't release the source data for field-coding because the fields are dealt with in pairs. // TODO: release source data for interlace simulations.
-    {
-      pcPic->releaseEncoderSourceImageData();
-    }
+  pcPic->releaseReconstructionIntermediateData();
+  if (!isField) // don't release the source data for field-coding because the fields are dealt with in pairs. // TODO: release source data for interlace simulations.
+  {
+    pcPic->releaseEncoderSourceImageData();
+  }
 
 #endif
-  } // iGOPid-loop
-
-  delete pcBitstreamRedirect;
+  pcPic->getSlice(0)->setReferenced( bReferenced );
+}
 
-  assert ( (m_iNumPicCoded == iNumPicRcvd) );
+/** Compress the prepared pictures, then write them in coding order.
+ * A picture compressed together with the pictures before it has used the CABAC initialization table decided when it was
+ * prepared, before these pictures were written. If the picture written before it decides another table, the picture is
+ * compressed again with that table, so that the bitstream is the same as when each picture is prepared and compressed
+ * after the picture before it has been written.
+ * \param jobs  prepared pictures, in coding order; cleared when they are written
+ */
+Void TEncGOP::xEncodePictureJobs( std::vector<PictureJob> &jobs, TComList<TComPic*>& rcListPic, TComOutputBitstream* pcBitstreamRedirect,
+                                  SEIMessages& leadingSeiMessages, SEIMessages& nestedSeiMessages, SEIMessages& duInfoSeiMessages, SEIMessages& trailingSeiMessages, std::deque<DUData>& duData,
+                                  Bool isField, Bool isTff, const InputColourSpaceConversion ip_conversion, const InputColourSpaceConversion snr_conversion, const TEncAnalyze::OutputLogControl &outputLogCtrl )
+{
+  xCompressPictureJobs( jobs );
+  for ( std::size_t i = 0; i < jobs.size(); i++ )
+  {
+    TComSlice* pcSlice = jobs[i].pcPic->getSlice(0);
+    if ( pcSlice->getEncCABACTableIdx() != m_pcSliceEncoder->getEncCABACTableIdx() )
+    {
+      jobs[i].pcPic->clearSliceBuffer( 1 );
+      jobs[i].pcPic->setCurrSliceIdx( 0 );
+      jobs[i].pcSliceEncoder->setSliceIdx( 0 );
+      pcSlice->setEncCABACTableIdx( m_pcSliceEncoder->getEncCABACTableIdx() );
+#if MCTS_EXTRACTION
+      const SliceType encCABACTableIdx = pcSlice->getEncCABACTableIdx();
+      pcSlice->setCabacInitFlag( pcSlice->getSliceType() != encCABACTableIdx && encCABACTableIdx != I_SLICE );
+#endif
+      xCompressPicture( jobs[i], false );
+    }
+    xFinishPicture( jobs[i], rcListPic, pcBitstreamRedirect, leadingSeiMessages, nestedSeiMessages, duInfoSeiMessages, trailingSeiMessages, duData,
+                    isField, isTff, ip_conversion, snr_conversion, outputLogCtrl );
+  }
+  jobs.clear();
 }
 
 Void TEncGOP::printOutSummary(UInt uiNumAllPicCoded, Bool isField, const TEncAnalyze::OutputLogControl &outputLogCtrl, const BitDepths &bitDepths)
@@ -2167,6 +2584,13 @@ Void TEncGOP::printOutSummary(UInt uiNumAllPicCoded, Bool isField, const TEncAna
     m_gcAnalyzeB.printSummary(chFmt, outputLogCtrl, bitDepths, m_pcCfg->getSummaryPicFilenameBase()+"B.txt");
   }
 
+  if (outputLogCtrl.printRoiStats)
+  {
+    xCloseRoiStatsFile( &m_gcAnalyzeAll );
+  }
+
+  m_pcSliceEncoder->printTileStats();
+
   if(isField)
   {
     //-- interlaced summary
@@ -2174,12 +2598,16 @@ Void TEncGOP::printOutSummary(UInt uiNumAllPicCoded, Bool isField, const TEncAna
     m_gcAnalyzeAll_in.setBits(m_gcAnalyzeAll.getBits());
     // prior to the above statement, the interlace analyser does not contain the correct total number of bits.
 
+    // ROI region statistics are gathered per field, not per interlaced frame
+    TEncAnalyze::OutputLogControl interlacedLogCtrl = outputLogCtrl;
+    interlacedLogCtrl.printRoiStats = false;
+
     printf( "\n\nSUMMARY INTERLACED ---------------------------------------------\n" );
-    m_gcAnalyzeAll_in.printOut('a', chFmt, outputLogCtrl, bitDepths);
+    m_gcAnalyzeAll_in.printOut('a', chFmt, interlacedLogCtrl, bitDepths);
 
     if (!m_pcCfg->getSummaryOutFilename().empty())
     {
-      m_gcAnalyzeAll_in.printSummary(chFmt, outputLogCtrl, bitDepths, m_pcCfg->getSummaryOutFilename());
+      m_gcAnalyzeAll_in.printSummary(chFmt, interlacedLogCtrl, bitDepths, m_pcCfg->getSummaryOutFilename());
     }
   }
 
@@ -2207,7 +2635,7 @@ Void TEncGOP::xInitGOP( Int iPOCLast, Int iNumPicRcvd, Bool isField )
 {
   assert( iNumPicRcvd > 0 );
   //  Exception for the first frames
-  if ( ( isField && (iPOCLast == 0 || iPOCLast == 1) ) || (!isField  && (iPOCLast == 0))  )
+  if ( ( isField && (iPOCLast == 0 || iPOCLast == 1) ) || (!isField  && (iPOCLast == m_intraPeriodStart))  )
   {
     m_iGopSize    = 1;
   }
@@ -2221,6 +2649,36 @@ Void TEncGOP::xInitGOP( Int iPOCLast, Int iNumPicRcvd, Bool isField )
 }
 
 
+/** Masks of a sparse mask sequence are propagated through the pictures of the GOP in output order, before any of them is
+ * coded: a picture with a mask restarts the propagation, the others follow the motion of the original pictures.
+ */
+Void TEncGOP::xPropagateRoiMaps( Int iPOCLast, Int iNumPicRcvd, TComList<TComPic*>& rcListPic )
+{
+  TEncRoiMaskReader *pcRoiMaskReader = m_pcEncTop->getRoiMaskReader();
+  for ( Int poc = iPOCLast - iNumPicRcvd + 1; poc <= iPOCLast; poc++ )
+  {
+    TComPic *pcPic = NULL;
+    for ( TComList<TComPic*>::iterator it = rcListPic.begin(); it != rcListPic.end(); it++ )
+    {
+      if ( (*it)->getPOC() == poc )
+      {
+        pcPic = *it;
+        break;
+      }
+    }
+    assert( pcPic != NULL );
+    if ( pcRoiMaskReader->hasMask( poc ) )
+    {
+      m_cRoiPropagator.reset( poc, *pcRoiMaskReader->getMap( poc ), *pcPic->getPicYuvOrg() );
+      pcRoiMaskReader->releaseMap( poc );
+    }
+    else
+    {
+      m_cRoiPropagator.propagate( poc, *pcPic->getPicYuvOrg() );
+    }
+  }
+}
+
 Void TEncGOP::xGetBuffer( TComList<TComPic*>&      rcListPic,
                          TComList<TComPicYuv*>&    rcListPicYuvRecOut,
                          Int                       iNumPicRcvd,
@@ -2404,6 +2862,15 @@ Void TEncGOP::xCalculateAddPSNR( TComPic* pcPic, TComPicYuv* pcPicD, const Acces
     pOrgPicYuv = pcPic ->getPicYuvTrueOrg();
   }
 
+  // the foreground distortion of the ROI mask is accumulated in the same pass as the picture distortion,
+  // the background distortion is the remainder
+  TEncPic          *pcEPic     = dynamic_cast<TEncPic*>(pcPic);
+  const TEncRoiMap *pcRoiMap   = (outputLogCtrl.printRoiStats && pcEPic != NULL && pcEPic->getRoiMap() != NULL && pcEPic->getRoiMap()->isActive()) ? pcEPic->getRoiMap() : NULL;
+  const UInt        log2RoiBlk = (pcRoiMap != NULL) ? pcRoiMap->getLog2BlkSize() : 0;
+  UInt64            uiPicSSD[MAX_NUM_COMPONENT] = { 0, 0, 0 };
+  Int               iPicSize[MAX_NUM_COMPONENT] = { 0, 0, 0 };
+  UInt64            uiRoiSSD[MAX_NUM_COMPONENT] = { 0, 0, 0 };
+  Int               iRoiSize[MAX_NUM_COMPONENT] = { 0, 0, 0 };
 
   //===== calculate PSNR =====
 
@@ -2440,6 +2907,7 @@ Void TEncGOP::xCalculateAddPSNR( TComPic* pcPic, TComPicYuv* pcPicD, const Acces
     std::vector<Double> vecSSEChroma(iSize[COMPONENT_Cb], Double(0));
     for(Int y = 0, t= 0; y < iHeight[COMPONENT_Cb]; y++ )
     {
+      const UChar *pRoiRow = (pcRoiMap != NULL) ? pcRoiMap->getOccupancyRow( (y << uiShiftHeight[COMPONENT_Cb]) >> log2RoiBlk ) : NULL;
       for(Int x = 0; x < iWidth[COMPONENT_Cb]; x++, t++)
       {
         UInt64 uiSE_cb, uiSE_cr;
@@ -2450,6 +2918,13 @@ Void TEncGOP::xCalculateAddPSNR( TComPic* pcPic, TComPicYuv* pcPicD, const Acces
         uiSSDtemp[COMPONENT_Cb] += uiSE_cb;
         uiSSDtemp[COMPONENT_Cr] += uiSE_cr;
         vecSSEChroma[t] = dWeightPel[COMPONENT_Cb] * (Double) uiSE_cb + dWeightPel[COMPONENT_Cr] * (Double) uiSE_cr;
+        if (pRoiRow != NULL && pRoiRow[(x << uiShiftWidth[COMPONENT_Cb]) >> log2RoiBlk])
+        {
+          uiRoiSSD[COMPONENT_Cb] += uiSE_cb;
+          uiRoiSSD[COMPONENT_Cr] += uiSE_cr;
+          iRoiSize[COMPONENT_Cb]++;
+          iRoiSize[COMPONENT_Cr]++;
+        }
       }
       pOrg[COMPONENT_Cb]  += iOrgStride[COMPONENT_Cb];
       pRec[COMPONENT_Cb]  += iRecStride[COMPONENT_Cb];
@@ -2460,6 +2935,7 @@ Void TEncGOP::xCalculateAddPSNR( TComPic* pcPic, TComPicYuv* pcPicD, const Acces
     for(Int y = 0; y < iHeight[COMPONENT_Y]; y++ )
     {
       UInt y_step_chroma = (y >> uiShiftHeight[COMPONENT_Cb]) * iWidth[COMPONENT_Cb];
+      const UChar *pRoiRow = (pcRoiMap != NULL) ? pcRoiMap->getOccupancyRow( y >> log2RoiBlk ) : NULL;
       for(Int x = 0; x < iWidth[COMPONENT_Y]; x++)
       {
         UInt64 uiSE_y;
@@ -2468,6 +2944,11 @@ Void TEncGOP::xCalculateAddPSNR( TComPic* pcPic, TComPicYuv* pcPicD, const Acces
         uiSE_y  = iDiff * iDiff;
         uiSSDtemp[COMPONENT_Y] += uiSE_y;
         dSSDtemp += sqrt(dWeightPel[COMPONENT_Y] * (Double) uiSE_y + vecSSEChroma[y_step_chroma+x_step_chroma]);
+        if (pRoiRow != NULL && pRoiRow[x >> log2RoiBlk])
+        {
+          uiRoiSSD[COMPONENT_Y] += uiSE_y;
+          iRoiSize[COMPONENT_Y]++;
+        }
       }
       pOrg[COMPONENT_Y]  += iOrgStride[COMPONENT_Y];
       pRec[COMPONENT_Y]  += iRecStride[COMPONENT_Y];
@@ -2482,6 +2963,8 @@ Void TEncGOP::xCalculateAddPSNR( TComPic* pcPic, TComPicYuv* pcPicD, const Acces
       result.psnr[ch]        = ( uiSSDtemp[ch] ? 10.0 * log10( fRefValue / (Double)uiSSDtemp[ch] ) : 999.99 );
       result.MSEyuvframe[ch]  = (Double)uiSSDtemp[ch]/(iSize[ch]);
       fWValue += (Double) iWeightSize[ch] * (Double) iSize[ch];
+      uiPicSSD[ch] = uiSSDtemp[ch];
+      iPicSize[ch] = iSize[ch];
     }
     const Double maxval    = 255 << (pcPic->getPicSym()->getSPS().getBitDepth(toChannelType(COMPONENT_Y)) - 8);
     fWValue = Double( maxval * fWValue);
@@ -2502,20 +2985,71 @@ Void TEncGOP::xCalculateAddPSNR( TComPic* pcPic, TComPicYuv* pcPicD, const Acces
       Int   iSize   = iWidth*iHeight;
 
       UInt64 uiSSDtemp=0;
-      for(Int y = 0; y < iHeight; y++ )
+      if (pcRoiMap == NULL)
       {
-        for(Int x = 0; x < iWidth; x++ )
+        for(Int y = 0; y < iHeight; y++ )
         {
-          Intermediate_Int iDiff = (Intermediate_Int)( pOrg[x] - pRec[x] );
-          uiSSDtemp   += iDiff * iDiff;
+          for(Int x = 0; x < iWidth; x++ )
+          {
+            Intermediate_Int iDiff = (Intermediate_Int)( pOrg[x] - pRec[x] );
+            uiSSDtemp   += iDiff * iDiff;
+          }
+          pOrg += iOrgStride;
+          pRec += iRecStride;
+        }
+      }
+      else
+      {
+        const UInt csx = pcPic->getComponentScaleX(ch);
+        const UInt csy = pcPic->getComponentScaleY(ch);
+        for(Int y = 0; y < iHeight; y++ )
+        {
+          const UChar *pRoiRow = pcRoiMap->getOccupancyRow( (y << csy) >> log2RoiBlk );
+          for(Int x = 0; x < iWidth; x++ )
+          {
+            Intermediate_Int iDiff = (Intermediate_Int)( pOrg[x] - pRec[x] );
+            const UInt64 uiSE = iDiff * iDiff;
+            uiSSDtemp   += uiSE;
+            if (pRoiRow[(x << csx) >> log2RoiBlk])
+            {
+              uiRoiSSD[ch] += uiSE;
+              iRoiSize[ch]++;
+            }
+          }
+          pOrg += iOrgStride;
+          pRec += iRecStride;
         }
-        pOrg += iOrgStride;
-        pRec += iRecStride;
       }
       const Int maxval = 255 << (pcPic->getPicSym()->getSPS().getBitDepth(toChannelType(ch)) - 8);
       const Double fRefValue = (Double) maxval * maxval * iSize;
       result.psnr[ch]         = ( uiSSDtemp ? 10.0 * log10( fRefValue / (Double)uiSSDtemp ) : 999.99 );
       result.MSEyuvframe[ch]   = (Double)uiSSDtemp/(iSize);
+      uiPicSSD[ch] = uiSSDtemp;
+      iPicSize[ch] = iSize;
+    }
+  }
+
+  if (pcRoiMap != NULL)
+  {
+    for(Int chan=0; chan<pcPicD->getNumberValidComponents(); chan++)
+    {
+      const ComponentID ch     = ComponentID(chan);
+      const Int         maxval = 255 << (pcPic->getPicSym()->getSPS().getBitDepth(toChannelType(ch)) - 8);
+      for(Int r=0; r<NUM_ROI_REGIONS; r++)
+      {
+        const UInt64 uiSSD  = (r == ROI_REGION_FOREGROUND) ? uiRoiSSD[ch] : uiPicSSD[ch] - uiRoiSSD[ch];
+        const Int    iSize  = (r == ROI_REGION_FOREGROUND) ? iRoiSize[ch] : iPicSize[ch] - iRoiSize[ch];
+        TEncAnalyze::RegionData &region = result.region[r];
+        if (ch == COMPONENT_Y)
+        {
+          region.numSamples = iSize;
+        }
+        if (iSize > 0)
+        {
+          region.psnr[ch] = ( uiSSD ? 10.0 * log10( (Double) maxval * maxval * iSize / (Double)uiSSD ) : 999.99 );
+          region.MSE[ch]  = (Double)uiSSD/iSize;
+        }
+      }
     }
   }
 #if EXTENSION_360_VIDEO
@@ -2535,8 +3069,15 @@ Void TEncGOP::xCalculateAddPSNR( TComPic* pcPic, TComPicYuv* pcPicD, const Acces
       const Int   width     = pcPicD->getWidth (ch) - (m_pcEncTop->getSourcePadding(0) >> pcPic->getComponentScaleX(ch));
       const Int   height    = pcPicD->getHeight(ch) - ((m_pcEncTop->getSourcePadding(1) >> (pcPic->isField()?1:0)) >> pcPic->getComponentScaleY(ch));
       const UInt  bitDepth  = pcPic->getPicSym()->getSPS().getBitDepth(toChannelType(ch));
- 
-      result.MSSSIM[ch] = xCalculateMSSSIM (pOrg, orgStride, pRec, recStride, width, height, bitDepth);
+      Double      regionMSSSIM[NUM_ROI_REGIONS];
+
+      result.MSSSIM[ch] = xCalculateMSSSIM (pOrg, orgStride, pRec, recStride, width, height, bitDepth,
+                                            pcRoiMap, pcPic->getComponentScaleX(ch), pcPic->getComponentScaleY(ch), regionMSSSIM);
+      if (pcRoiMap != NULL)
+      {
+        result.region[ROI_REGION_BACKGROUND].MSSSIM[ch] = regionMSSSIM[ROI_REGION_BACKGROUND];
+        result.region[ROI_REGION_FOREGROUND].MSSSIM[ch] = regionMSSSIM[ROI_REGION_FOREGROUND];
+      }
     }
   }
 
@@ -2571,6 +3112,11 @@ Void TEncGOP::xCalculateAddPSNR( TComPic* pcPic, TComPicYuv* pcPicD, const Acces
 
   //===== add distortion metrics =====
   result.bits=(Double)uibits;
+  if (pcRoiMap != NULL)
+  {
+    result.region[ROI_REGION_BACKGROUND].bits = (Double)pcEPic->getRoiRegionBits(ROI_REGION_BACKGROUND);
+    result.region[ROI_REGION_FOREGROUND].bits = (Double)pcEPic->getRoiRegionBits(ROI_REGION_FOREGROUND);
+  }
   m_gcAnalyzeAll.addResult (result);
 
 #if EXTENSION_360_VIDEO
@@ -2652,6 +3198,17 @@ Void TEncGOP::xCalculateAddPSNR( TComPic* pcPic, TComPicYuv* pcPicD, const Acces
   {
     printf(" [Y MSE %6.4lf  U MSE %6.4lf  V MSE %6.4lf]", result.MSEyuvframe[COMPONENT_Y], result.MSEyuvframe[COMPONENT_Cb], result.MSEyuvframe[COMPONENT_Cr] );
   }
+  if (pcRoiMap != NULL)
+  {
+    const TEncAnalyze::RegionData &fg = result.region[ROI_REGION_FOREGROUND];
+    const TEncAnalyze::RegionData &bg = result.region[ROI_REGION_BACKGROUND];
+    printf(" [FG %d bits Y %6.4lf dB  BG %d bits Y %6.4lf dB]", Int(fg.bits), fg.psnr[COMPONENT_Y], Int(bg.bits), bg.psnr[COMPONENT_Y] );
+    if (outputLogCtrl.printMSSSIM)
+    {
+      printf(" [FG MS-SSIM Y %1.6lf  BG MS-SSIM Y %1.6lf]", fg.MSSSIM[COMPONENT_Y], bg.MSSSIM[COMPONENT_Y] );
+    }
+    xWriteRoiStatsRecord( std::to_string(pcSlice->getPOC()), c, result.bits, result.region );
+  }
 #if EXTENSION_360_VIDEO
   m_ext360.printPerPOCInfo();
 #endif
@@ -2672,7 +3229,12 @@ Void TEncGOP::xCalculateAddPSNR( TComPic* pcPic, TComPicYuv* pcPicD, const Acces
   cscd.destroy();
 }
 
-Double TEncGOP::xCalculateMSSSIM (const Pel *pOrg, const Int orgStride, const Pel* pRec, const Int recStride, const Int width, const Int height, const UInt bitDepth)
+/** Calculate the MS-SSIM of one component
+ * If an ROI map is given, the structural similarity of each window is also accumulated for the region of its centre sample,
+ * and the MS-SSIM of each region is returned in regionMSSSIM. Scales without any window of a region do not contribute to it.
+ */
+Double TEncGOP::xCalculateMSSSIM (const Pel *pOrg, const Int orgStride, const Pel* pRec, const Int recStride, const Int width, const Int height, const UInt bitDepth,
+                                  const TEncRoiMap* pcRoiMap, const UInt csx, const UInt csy, Double* regionMSSSIM)
 {
   const Int MAX_MSSSIM_SCALE  = 5;
   const Int WEIGHTING_MID_TAP = 5;
@@ -2782,6 +3344,11 @@ Double TEncGOP::xCalculateMSSSIM (const Pel *pOrg, const Int orgStride, const Pe
   const Double c2        = (0.03*maxValue)*(0.03*maxValue);
   
   Double finalMSSSIM = 1.0;
+  if (pcRoiMap != NULL)
+  {
+    regionMSSSIM[ROI_REGION_BACKGROUND] = 1.0;
+    regionMSSSIM[ROI_REGION_FOREGROUND] = 1.0;
+  }
 
   for(UInt scale=0; scale<maxScale; scale++)
   {
@@ -2792,9 +3359,12 @@ Double TEncGOP::xCalculateMSSSIM (const Pel *pOrg, const Int orgStride, const Pe
     const Int totalBlocks     = blocksPerRow*blocksPerColumn;
 
     Double meanSSIM= 0.0;
+    Double regionSSIM[NUM_ROI_REGIONS]  = { 0.0, 0.0 };
+    Int    regionBlocks[NUM_ROI_REGIONS] = { 0, 0 };
 
     for(Int blockIndexY=0; blockIndexY<blocksPerColumn; blockIndexY++)
     {
+      const UChar *pRoiRow = (pcRoiMap != NULL) ? pcRoiMap->getOccupancyRow( (((blockIndexY+WEIGHTING_MID_TAP) << scale) << csy) >> pcRoiMap->getLog2BlkSize() ) : NULL;
       for(Int blockIndexX=0; blockIndexX<blocksPerRow; blockIndexX++)
       {
         Double muOrg          =0.0;
@@ -2831,18 +3401,153 @@ Double TEncGOP::xCalculateMSSSIM (const Pel *pOrg, const Int orgStride, const Pe
         }
 
         meanSSIM += blockSSIMVal;
+        if (pRoiRow != NULL)
+        {
+          const Int region = pRoiRow[(((blockIndexX+WEIGHTING_MID_TAP) << scale) << csx) >> pcRoiMap->getLog2BlkSize()];
+          regionSSIM[region] += blockSSIMVal;
+          regionBlocks[region]++;
+        }
       }
     }
 
     meanSSIM /=totalBlocks;
 
     finalMSSSIM *= pow(meanSSIM, exponentWeights[maxScale-1][scale]);
+    if (pcRoiMap != NULL)
+    {
+      for(Int r=0; r<NUM_ROI_REGIONS; r++)
+      {
+        if (regionBlocks[r] > 0)
+        {
+          regionMSSSIM[r] *= pow(regionSSIM[r] / regionBlocks[r], exponentWeights[maxScale-1][scale]);
+        }
+      }
+    }
   }
 
   return finalMSSSIM;
 }
 
 
+/** Append the ROI region statistics of one picture, or of the whole sequence, to the RoiStatsFile
+ * The file is opened with the first record. A name ending in ".json" selects JSON output, otherwise one CSV line is written per record.
+ * The MS-SSIM of the regions is only written when it is computed (PrintMSSSIM).
+ */
+Void TEncGOP::xWriteRoiStatsRecord( const std::string &id, TChar sliceType, Double bits, const TEncAnalyze::RegionData region[NUM_ROI_REGIONS] )
+{
+  const std::string &fileName    = m_pcCfg->getRoiStatsFilename();
+  const Bool         printMSSSIM = m_pcCfg->getPrintMSSSIM();
+  if (fileName.empty())
+  {
+    return;
+  }
+  if (m_pRoiStatsFile == NULL)
+  {
+    if (m_numRoiStatsRecords > 0)
+    {
+      return; // already closed by the summary
+    }
+    m_pRoiStatsFile = fopen(fileName.c_str(), "w");
+    if (m_pRoiStatsFile == NULL)
+    {
+      fprintf(stderr, "\nWarning: cannot open RoiStatsFile %s\n", fileName.c_str());
+      m_numRoiStatsRecords = 1;
+      return;
+    }
+    m_roiStatsJson = fileName.size() >= 5 && fileName.compare(fileName.size() - 5, 5, ".json") == 0;
+    if (m_roiStatsJson)
+    {
+      fprintf(m_pRoiStatsFile, "{\n  \"frames\": [");
+    }
+    else
+    {
+      fprintf(m_pRoiStatsFile, "poc,type,bits");
+      for (Int r = NUM_ROI_REGIONS - 1; r >= 0; r--)
+      {
+        const TChar *name = (r == ROI_REGION_FOREGROUND) ? "fg" : "bg";
+        fprintf(m_pRoiStatsFile, ",%s_bits,%s_samples,%s_psnr_y,%s_psnr_u,%s_psnr_v,%s_mse_y,%s_mse_u,%s_mse_v",
+                name, name, name, name, name, name, name, name);
+        if (printMSSSIM)
+        {
+          fprintf(m_pRoiStatsFile, ",%s_msssim_y,%s_msssim_u,%s_msssim_v", name, name, name);
+        }
+      }
+      fprintf(m_pRoiStatsFile, "\n");
+    }
+  }
+
+  const Bool isSummary = (sliceType == 'a');
+  if (m_roiStatsJson)
+  {
+    if (isSummary)
+    {
+      fprintf(m_pRoiStatsFile, "\n  ],\n  \"summary\": {\"frame_rate\": %.4lf, \"bits\": %.4lf", m_pcCfg->getFrameRate() / (Double)m_pcCfg->getTemporalSubsampleRatio(), bits);
+    }
+    else
+    {
+      fprintf(m_pRoiStatsFile, "%s\n    {\"poc\": %s, \"type\": \"%c\", \"bits\": %.0lf", m_numRoiStatsRecords > 0 ? "," : "", id.c_str(), sliceType, bits);
+    }
+    for (Int r = NUM_ROI_REGIONS - 1; r >= 0; r--)
+    {
+      const TEncAnalyze::RegionData &rd = region[r];
+      fprintf(m_pRoiStatsFile, ", \"%s\": {\"bits\": %.4lf, \"samples\": %.0lf, \"psnr\": [%.4lf, %.4lf, %.4lf], \"mse\": [%.4lf, %.4lf, %.4lf]",
+              r == ROI_REGION_FOREGROUND ? "foreground" : "background", rd.bits, rd.numSamples,
+              rd.psnr[COMPONENT_Y], rd.psnr[COMPONENT_Cb], rd.psnr[COMPONENT_Cr],
+              rd.MSE[COMPONENT_Y], rd.MSE[COMPONENT_Cb], rd.MSE[COMPONENT_Cr]);
+      if (printMSSSIM)
+      {
+        fprintf(m_pRoiStatsFile, ", \"msssim\": [%.6lf, %.6lf, %.6lf]", rd.MSSSIM[COMPONENT_Y], rd.MSSSIM[COMPONENT_Cb], rd.MSSSIM[COMPONENT_Cr]);
+      }
+      fprintf(m_pRoiStatsFile, "}");
+    }
+    fprintf(m_pRoiStatsFile, "}");
+  }
+  else
+  {
+    fprintf(m_pRoiStatsFile, "%s,%c,%.4lf", id.c_str(), sliceType, bits);
+    for (Int r = NUM_ROI_REGIONS - 1; r >= 0; r--)
+    {
+      const TEncAnalyze::RegionData &rd = region[r];
+      fprintf(m_pRoiStatsFile, ",%.4lf,%.0lf,%.4lf,%.4lf,%.4lf,%.4lf,%.4lf,%.4lf",
+              rd.bits, rd.numSamples,
+              rd.psnr[COMPONENT_Y], rd.psnr[COMPONENT_Cb], rd.psnr[COMPONENT_Cr],
+              rd.MSE[COMPONENT_Y], rd.MSE[COMPONENT_Cb], rd.MSE[COMPONENT_Cr]);
+      if (printMSSSIM)
+      {
+        fprintf(m_pRoiStatsFile, ",%.6lf,%.6lf,%.6lf", rd.MSSSIM[COMPONENT_Y], rd.MSSSIM[COMPONENT_Cb], rd.MSSSIM[COMPONENT_Cr]);
+      }
+    }
+    fprintf(m_pRoiStatsFile, "\n");
+  }
+  m_numRoiStatsRecords++;
+}
+
+/** Write the sequence averages of pcSummary (if not NULL) as the last record and close the RoiStatsFile
+ */
+Void TEncGOP::xCloseRoiStatsFile( const TEncAnalyze* pcSummary )
+{
+  if (pcSummary != NULL && pcSummary->getNumPic() > 0)
+  {
+    TEncAnalyze::RegionData region[NUM_ROI_REGIONS];
+    region[ROI_REGION_BACKGROUND] = pcSummary->getRegionAverage(ROI_REGION_BACKGROUND);
+    region[ROI_REGION_FOREGROUND] = pcSummary->getRegionAverage(ROI_REGION_FOREGROUND);
+    xWriteRoiStatsRecord("average", 'a', pcSummary->getBits() / pcSummary->getNumPic(), region);
+  }
+  else if (m_pRoiStatsFile != NULL && m_roiStatsJson)
+  {
+    fprintf(m_pRoiStatsFile, "\n  ]");
+  }
+  if (m_pRoiStatsFile != NULL)
+  {
+    if (m_roiStatsJson)
+    {
+      fprintf(m_pRoiStatsFile, "\n}\n");
+    }
+    fclose(m_pRoiStatsFile);
+    m_pRoiStatsFile = NULL;
+  }
+}
+
 Void TEncGOP::xCalculateInterlacedAddPSNR( TComPic* pcPicOrgFirstField, TComPic* pcPicOrgSecondField,
                                           TComPicYuv* pcPicRecFirstField, TComPicYuv* pcPicRecSecondField,
                                           const InputColourSpaceConversion conversion, const TEncAnalyze::OutputLogControl &outputLogCtrl, Double* PSNR_Y )
@@ -3073,7 +3778,7 @@ Void TEncGOP::xCalculateInterlacedAddPSNR( TComPic* pcPicOrgFirstField, TComPic*
  */
 NalUnitType TEncGOP::getNalUnitType(Int pocCurr, Int lastIDR, Bool isField)
 {
-  if (pocCurr == 0)
+  if (pocCurr == m_intraPeriodStart)
   {
     return NAL_UNIT_CODED_SLICE_IDR_W_RADL;
   }
@@ -3084,7 +3789,7 @@ NalUnitType TEncGOP::getNalUnitType(Int pocCurr, Int lastIDR, Bool isField)
     return NAL_UNIT_CODED_SLICE_TRAIL_R;
   }
 
-  if(m_pcCfg->getDecodingRefreshType() != 3 && (pocCurr - isField) % m_pcCfg->getIntraPeriod() == 0)
+  if(m_pcCfg->getDecodingRefreshType() != 3 && (pocCurr - isField - m_intraPeriodStart) % m_pcCfg->getIntraPeriod() == 0)
   {
     if (m_pcCfg->getDecodingRefreshType() == 1)
     {
@@ -63,6 +63,11 @@
 
 #include "TEncAnalyze.h"
 #include "TEncRateCtrl.h"
+#include "TEncRoiMap.h"
+#include "TEncRoiPropagator.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 //! \ingroup TLibEncoder
@@ -87,6 +92,24 @@ class TEncGOP
     Int accumNalsDU;
   };
 
+  /// picture of the GOP between its preparation and its writing, see compressGOP
+  struct PictureJob
+  {
+    Int         iGOPid;
+    Int         pocCurr;
+    Int         IRAPGOPid;                       ///< GOP index of the IRAP picture for efficient field IRAP coding, 0 otherwise
+    clock_t     iBeforeTime;
+    TComPic*    pcPic;
+    TComPicYuv* pcPicYuvRecOut;
+    AccessUnit* pAccessUnit;
+    TEncSlice*  pcSliceEncoder;                  ///< slice encoder compressing the picture
+    Double      lambda;                          ///< rate control lambda
+    Int         estimatedBits;                   ///< rate control target bits
+    UInt        uiNumSliceSegments;
+    Bool        bLoopFiltered;                   ///< deblocked and SAO processed by the loop filter thread while it was compressed
+    Bool        saoSliceEnabled[MAX_NUM_COMPONENT]; ///< SAO slice flags decided by the loop filter thread
+  };
+
 private:
 
   TEncAnalyze             m_gcAnalyzeAll;
@@ -110,6 +133,7 @@ private:
   UInt                    m_ltRefPicPocLsbSps[MAX_NUM_LONG_TERM_REF_PICS];
   Bool                    m_ltRefPicUsedByCurrPicFlag[MAX_NUM_LONG_TERM_REF_PICS];
   Int                     m_iLastIDR;
+  Int                     m_intraPeriodStart;      ///< POC of the picture starting the intra periods: 0, or the last scene cut
   Int                     m_RASPOCforResetEncoder; // an IDR POC number, after which the next POC (in output order) will be reset. If MAX_INT, then no reset is pending.
   Int                     m_iGopSize;
   Int                     m_iNumPicCoded;
@@ -147,6 +171,10 @@ private:
   Int                     m_associatedIRAPPOC;
 
   std::vector<Int> m_vRVM_RP;
+  FILE*                   m_pRoiStatsFile;         ///< per-picture ROI region statistics, CSV or JSON
+  Bool                    m_roiStatsJson;
+  UInt                    m_numRoiStatsRecords;
+  TEncRoiPropagator       m_cRoiPropagator;        ///< masks of the pictures between the frames of a sparse ROI mask sequence
   UInt                    m_lastBPSEI;
   UInt                    m_totalCoded;
   Bool                    m_bufferingPeriodSEIPresentInAU;
@@ -154,6 +182,20 @@ private:
   TComPicYuv*             m_pcDeblockingTempPicYuv;
   Int                     m_DBParam[MAX_ENCODER_DEBLOCKING_QUALITY_LAYERS][4];   //[layer_id][0: available; 1: bDBDisabled; 2: Beta Offset Div2; 3: Tc Offset Div2;]
 
+  // CTU-row lagged loop filter, see xLoopFilterCtuRows
+  TComPic*                m_pcLoopFilterPic;       ///< picture loop filtered by the loop filter thread while it is compressed, NULL if none
+  std::thread             m_loopFilterThread;      ///< thread deblocking and SAO processing the CTU rows of m_pcLoopFilterPic
+  std::mutex              m_loopFilterMutex;       ///< protects the counts of compressed CTUs below
+  std::condition_variable m_loopFilterCond;        ///< signalled when a CTU row is compressed
+  std::vector<UInt>       m_numCompressedCtusInRow; ///< number of compressed CTUs in each CTU row
+  Int                     m_numCompressedCtuRows;  ///< number of CTU rows from the top of the picture that are compressed
+  TEncSbac                m_cLoopFilterSbacCoder;  ///< SBAC coder for the SAO decisions of the loop filter thread
+#if FAST_BIT_EST
+  TEncBinCABACCounter     m_cLoopFilterBinCoderCABAC; ///< bin coder of m_cLoopFilterSbacCoder
+#else
+  TEncBinCABAC            m_cLoopFilterBinCoderCABAC; ///< bin coder of m_cLoopFilterSbacCoder
+#endif
+
 public:
   TEncGOP();
   virtual ~TEncGOP();
@@ -168,12 +210,15 @@ public:
 
 
   Int   getGOPSize()          { return  m_iGopSize;  }
+  Void  setIntraPeriodStart( Int poc )   { m_intraPeriodStart = poc;  }   ///< the next picture with this POC is an IDR picture coded on its own
+  Int   getIntraPeriodStart() const      { return m_intraPeriodStart; }
 
   TComList<TComPic*>*   getListPic()      { return m_pcListPic; }
 
   Void  printOutSummary      ( UInt uiNumAllPicCoded, Bool isField, const TEncAnalyze::OutputLogControl &outputLogCtrl, const BitDepths &bitDepths );
 
   Void  preLoopFilterPicAll  ( TComPic* pcPic, UInt64& ruiDist );
+  Void  setCtuCompressed     ( const TComPic* pcPic, UInt ctuRsAddr );  ///< report a compressed CTU to the loop filter thread
 
   TEncSlice*  getSliceEncoder()   { return m_pcSliceEncoder; }
   NalUnitType getNalUnitType( Int pocCurr, Int lastIdr, Bool isField );
@@ -196,14 +241,32 @@ protected:
 protected:
 
   Void  xInitGOP          ( Int iPOCLast, Int iNumPicRcvd, Bool isField );
+  Void  xPropagateRoiMaps ( Int iPOCLast, Int iNumPicRcvd, TComList<TComPic*>& rcListPic );
   Void  xGetBuffer        ( TComList<TComPic*>& rcListPic, TComList<TComPicYuv*>& rcListPicYuvRecOut, Int iNumPicRcvd, Int iTimeOffset, TComPic*& rpcPic, TComPicYuv*& rpcPicYuvRecOut, Int pocCurr, Bool isField );
 
+  Bool  xDependsOnPictureJobs ( Int pocCurr, Int iGOPid, Bool isField, const std::vector<PictureJob> &jobs );
+  Bool  xUseFrameThreads      ( Bool isField );
+  Bool  xUseLoopFilterThread  ();
+  Void  xCompressPicture      ( PictureJob &job, Bool bLoopFilterThread );
+  Void  xLoopFilterCtuRows    ( PictureJob *job, TComSlice* pcSlice );
+  Void  xCompressPictureJobs  ( std::vector<PictureJob> &jobs );
+  Void  xFinishPicture        ( PictureJob &job, TComList<TComPic*>& rcListPic, TComOutputBitstream* pcBitstreamRedirect,
+                                SEIMessages& leadingSeiMessages, SEIMessages& nestedSeiMessages, SEIMessages& duInfoSeiMessages, SEIMessages& trailingSeiMessages, std::deque<DUData>& duData,
+                                Bool isField, Bool isTff, const InputColourSpaceConversion ip_conversion, const InputColourSpaceConversion snr_conversion, const TEncAnalyze::OutputLogControl &outputLogCtrl );
+  Void  xEncodePictureJobs    ( std::vector<PictureJob> &jobs, TComList<TComPic*>& rcListPic, TComOutputBitstream* pcBitstreamRedirect,
+                                SEIMessages& leadingSeiMessages, SEIMessages& nestedSeiMessages, SEIMessages& duInfoSeiMessages, SEIMessages& trailingSeiMessages, std::deque<DUData>& duData,
+                                Bool isField, Bool isTff, const InputColourSpaceConversion ip_conversion, const InputColourSpaceConversion snr_conversion, const TEncAnalyze::OutputLogControl &outputLogCtrl );
+
   Void  xCalculateAddPSNRs         ( const Bool isField, const Bool isFieldTopFieldFirst, const Int iGOPid, TComPic* pcPic, const AccessUnit&accessUnit, TComList<TComPic*> &rcListPic, Double dEncTime, const InputColourSpaceConversion ip_conversion, const InputColourSpaceConversion snr_conversion, const TEncAnalyze::OutputLogControl &outputLogCtrl, Double* PSNR_Y );
   Void  xCalculateAddPSNR          ( TComPic* pcPic, TComPicYuv* pcPicD, const AccessUnit&, Double dEncTime, const InputColourSpaceConversion ip_conversion, const InputColourSpaceConversion snr_conversion, const TEncAnalyze::OutputLogControl &outputLogCtrl, Double* PSNR_Y );
   Void  xCalculateInterlacedAddPSNR( TComPic* pcPicOrgFirstField, TComPic* pcPicOrgSecondField,
                                     TComPicYuv* pcPicRecFirstField, TComPicYuv* pcPicRecSecondField,
                                     const InputColourSpaceConversion snr_conversion, const TEncAnalyze::OutputLogControl &outputLogCtrl, Double* PSNR_Y );
-  Double xCalculateMSSSIM (const Pel *pOrg, const Int orgStride, const Pel* pRec, const Int recStride, const Int width, const Int height, const UInt bitDepth);
+  Double xCalculateMSSSIM (const Pel *pOrg, const Int orgStride, const Pel* pRec, const Int recStride, const Int width, const Int height, const UInt bitDepth,
+                           const TEncRoiMap* pcRoiMap = NULL, const UInt csx = 0, const UInt csy = 0, Double* regionMSSSIM = NULL);
+
+  Void  xWriteRoiStatsRecord ( const std::string &id, TChar sliceType, Double bits, const TEncAnalyze::RegionData region[NUM_ROI_REGIONS] );
+  Void  xCloseRoiStatsFile   ( const TEncAnalyze* pcSummary );
 
   UInt64 xFindDistortionFrame (TComPicYuv* pcPic0, TComPicYuv* pcPic1, const BitDepths &bitDepths);
 
@@ -0,0 +1,374 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2022, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/** \file     TEncLookahead.cpp
+    \brief    analysis of the received pictures ahead of their compression
+*/
+
+#include "TEncLookahead.h"
+
+//! \ingroup TLibEncoder
+//! \{
+
+static const Int LOOKAHEAD_BLOCK_SIZE   = 8;    ///< block size of the SATD estimates, in half-resolution samples
+static const Int LOOKAHEAD_SEARCH_RANGE = 4;    ///< full-sample search range of the inter estimate, in half-resolution samples
+
+TEncLookahead::TEncLookahead()
+: m_bAdaptiveQP(false)
+, m_bStatistics(false)
+, m_depth(0)
+, m_numPending(0)
+, m_bStop(false)
+{
+}
+
+TEncLookahead::~TEncLookahead()
+{
+  destroy();
+}
+
+/** Start the worker threads.
+ * \param numThreads   number of worker threads, 0 to analyse the pictures on the calling thread
+ * \param depth        maximum number of pictures waiting for analysis before addPicture blocks, 0 for no limit
+ * \param bAdaptiveQP  compute the activities of the adaptive QP
+ * \param bStatistics  compute the statistics of TEncPicStatistics
+ */
+Void TEncLookahead::create( Int numThreads, Int depth, Bool bAdaptiveQP, Bool bStatistics )
+{
+  m_bAdaptiveQP = bAdaptiveQP;
+  m_bStatistics = bStatistics;
+  m_depth       = depth;
+  m_bStop       = false;
+  if ( bAdaptiveQP || bStatistics )
+  {
+    for ( Int i = 0; i < numThreads; i++ )
+    {
+      m_workers.push_back( std::thread( &TEncLookahead::xWorker, this ) );
+    }
+  }
+}
+
+Void TEncLookahead::destroy()
+{
+  if ( !m_workers.empty() )
+  {
+    waitForPictures();
+    {
+      std::lock_guard<std::mutex> lock( m_mutex );
+      m_bStop = true;
+    }
+    m_cond.notify_all();
+    for ( std::size_t i = 0; i < m_workers.size(); i++ )
+    {
+      m_workers[i].join();
+    }
+    m_workers.clear();
+  }
+  m_pcLastLowres.reset();
+}
+
+/** Analyse a received picture. The picture must not be compressed before waitForPictures returns.
+ * \param pcPic  received picture
+ */
+Void TEncLookahead::addPicture( TEncPic* pcPic )
+{
+  if ( !m_bAdaptiveQP && !m_bStatistics )
+  {
+    return;
+  }
+  pcPic->getStatistics().bValid = false;
+
+  LookaheadJob job;
+  job.pcPic = pcPic;
+  if ( m_bStatistics )
+  {
+    job.pcLowres     = std::make_shared<LowresPicture>();
+    job.pcPrevLowres = m_pcLastLowres;
+    m_pcLastLowres   = job.pcLowres;
+  }
+
+  if ( m_workers.empty() )
+  {
+    xAnalysePicture( job );
+    return;
+  }
+
+  {
+    std::unique_lock<std::mutex> lock( m_mutex );
+    m_cond.wait( lock, [this]() { return m_depth <= 0 || m_numPending < m_depth; } );
+    m_jobs.push_back( job );
+    m_numPending++;
+  }
+  m_cond.notify_all();
+}
+
+Void TEncLookahead::waitForPictures()
+{
+  std::unique_lock<std::mutex> lock( m_mutex );
+  m_cond.wait( lock, [this]() { return m_numPending == 0; } );
+}
+
+Void TEncLookahead::xWorker()
+{
+  while ( true )
+  {
+    LookaheadJob job;
+    {
+      std::unique_lock<std::mutex> lock( m_mutex );
+      m_cond.wait( lock, [this]() { return m_bStop || !m_jobs.empty(); } );
+      if ( m_jobs.empty() )
+      {
+        return;
+      }
+      job = m_jobs.front();
+      m_jobs.pop_front();
+    }
+
+    xAnalysePicture( job );
+    job.pcPrevLowres.reset();
+
+    {
+      std::lock_guard<std::mutex> lock( m_mutex );
+      m_numPending--;
+    }
+    m_cond.notify_all();
+  }
+}
+
+Void TEncLookahead::xAnalysePicture( LookaheadJob& job )
+{
+  TEncPic* pcPic = job.pcPic;
+  if ( m_bAdaptiveQP )
+  {
+    m_cPreanalyzer.xPreanalyze( pcPic );
+  }
+  if ( !m_bStatistics )
+  {
+    return;
+  }
+
+  xCalcACDC( pcPic );
+
+  // downsample the luma, then wait for the previous picture, which was taken by a worker before this one
+  const TComPicYuv* pcPicYuv = pcPic->getPicYuvOrg();
+  const Int  stride   = pcPicYuv->getStride( COMPONENT_Y );
+  LowresPicture& lowres = *job.pcLowres;
+  lowres.width  = pcPicYuv->getWidth( COMPONENT_Y ) >> 1;
+  lowres.height = pcPicYuv->getHeight( COMPONENT_Y ) >> 1;
+  lowres.luma.resize( lowres.width * lowres.height );
+  const Pel* pSrc = pcPicYuv->getAddr( COMPONENT_Y );
+  Pel*       pDst = &lowres.luma[0];
+  for ( Int y = 0; y < lowres.height; y++, pSrc += 2 * stride, pDst += lowres.width )
+  {
+    for ( Int x = 0; x < lowres.width; x++ )
+    {
+      pDst[x] = ( pSrc[2 * x] + pSrc[2 * x + 1] + pSrc[2 * x + stride] + pSrc[2 * x + 1 + stride] + 2 ) >> 2;
+    }
+  }
+  {
+    std::lock_guard<std::mutex> lock( m_mutex );
+    lowres.bReady = true;
+  }
+  m_cond.notify_all();
+
+  if ( job.pcPrevLowres )
+  {
+    std::unique_lock<std::mutex> lock( m_mutex );
+    m_cond.wait( lock, [&job]() { return job.pcPrevLowres->bReady; } );
+  }
+  xCalcSatd( pcPic, lowres, job.pcPrevLowres.get() );
+  pcPic->getStatistics().bValid = true;
+}
+
+/** Sums and mean absolute deviations of the components, as used by WeightPredAnalysis::xCalcACDCParamSlice
+ */
+Void TEncLookahead::xCalcACDC( TEncPic* pcPic )
+{
+  const TComPicYuv* pcPicYuv = pcPic->getPicYuvOrg();
+  TEncPicStatistics& statistics = pcPic->getStatistics();
+
+  for ( Int componentIndex = 0; componentIndex < pcPicYuv->getNumberValidComponents(); componentIndex++ )
+  {
+    const ComponentID compID = ComponentID( componentIndex );
+    const Int stride = pcPicYuv->getStride( compID );
+    const Int width  = pcPicYuv->getWidth( compID );
+    const Int height = pcPicYuv->getHeight( compID );
+    const Int sample = width * height;
+
+    Int64 orgDC = 0;
+    const Pel* pPel = pcPicYuv->getAddr( compID );
+    for ( Int y = 0; y < height; y++, pPel += stride )
+    {
+      for ( Int x = 0; x < width; x++ )
+      {
+        orgDC += (Int)( pPel[x] );
+      }
+    }
+
+    const Int64 orgNormDC = ( ( orgDC + ( sample >> 1 ) ) / sample );
+
+    Int64 orgAC = 0;
+    pPel = pcPicYuv->getAddr( compID );
+    for ( Int y = 0; y < height; y++, pPel += stride )
+    {
+      for ( Int x = 0; x < width; x++ )
+      {
+        orgAC += abs( (Int)pPel[x] - (Int)orgNormDC );
+      }
+    }
+
+    statistics.orgDC[compID] = orgDC;
+    statistics.orgAC[compID] = orgAC;
+  }
+}
+
+/** SATD estimates of intra and inter coding on 8x8 blocks of the half-resolution luma.
+ * Intra predicts each block by DC, horizontal or vertical prediction from the original samples next to it,
+ * inter by the best full-sample displacement (by SAD) within the search range in the previous received picture.
+ * \param pcPic         picture whose statistics are set
+ * \param lowres        half-resolution luma of the picture
+ * \param pcPrevLowres  half-resolution luma of the previous received picture, NULL if there is none
+ */
+Void TEncLookahead::xCalcSatd( TEncPic* pcPic, const LowresPicture& lowres, const LowresPicture* pcPrevLowres )
+{
+  TEncPicStatistics& statistics = pcPic->getStatistics();
+  const Int bitDepth     = pcPic->getPicSym()->getSPS().getBitDepth( CHANNEL_TYPE_LUMA );
+  const Int blkSize      = LOOKAHEAD_BLOCK_SIZE;
+  const Int stride       = lowres.width;
+  const Int numBlocksX   = lowres.width / blkSize;
+  const Int numBlocksY   = lowres.height / blkSize;
+  const Bool bInter      = pcPrevLowres != NULL && pcPrevLowres->width == lowres.width && pcPrevLowres->height == lowres.height;
+
+  UInt64 intraSatd = 0;
+  UInt64 interSatd = 0;
+  Pel    pred[LOOKAHEAD_BLOCK_SIZE * LOOKAHEAD_BLOCK_SIZE];
+  for ( Int by = 0; by < numBlocksY; by++ )
+  {
+    for ( Int bx = 0; bx < numBlocksX; bx++ )
+    {
+      const Int  x0   = bx * blkSize;
+      const Int  y0   = by * blkSize;
+      const Pel* pOrg = &lowres.luma[y0 * stride + x0];
+
+      // DC
+      Int sum = 0;
+      Int num = 0;
+      if ( y0 > 0 )
+      {
+        for ( Int i = 0; i < blkSize; i++ )
+        {
+          sum += pOrg[i - stride];
+        }
+        num += blkSize;
+      }
+      if ( x0 > 0 )
+      {
+        for ( Int i = 0; i < blkSize; i++ )
+        {
+          sum += pOrg[i * stride - 1];
+        }
+        num += blkSize;
+      }
+      const Pel dc = num > 0 ? Pel( ( sum + ( num >> 1 ) ) / num ) : Pel( 1 << ( bitDepth - 1 ) );
+      for ( Int i = 0; i < blkSize * blkSize; i++ )
+      {
+        pred[i] = dc;
+      }
+      Distortion intraCost = m_cRdCost.calcHAD( bitDepth, pOrg, stride, pred, blkSize, blkSize, blkSize );
+
+      // vertical
+      if ( y0 > 0 )
+      {
+        for ( Int y = 0; y < blkSize; y++ )
+        {
+          for ( Int x = 0; x < blkSize; x++ )
+          {
+            pred[y * blkSize + x] = pOrg[x - stride];
+          }
+        }
+        intraCost = std::min( intraCost, m_cRdCost.calcHAD( bitDepth, pOrg, stride, pred, blkSize, blkSize, blkSize ) );
+      }
+
+      // horizontal
+      if ( x0 > 0 )
+      {
+        for ( Int y = 0; y < blkSize; y++ )
+        {
+          for ( Int x = 0; x < blkSize; x++ )
+          {
+            pred[y * blkSize + x] = pOrg[y * stride - 1];
+          }
+        }
+        intraCost = std::min( intraCost, m_cRdCost.calcHAD( bitDepth, pOrg, stride, pred, blkSize, blkSize, blkSize ) );
+      }
+      intraSatd += intraCost;
+
+      if ( bInter )
+      {
+        const Pel* pRef    = &pcPrevLowres->luma[y0 * stride + x0];
+        Distortion minSad  = std::numeric_limits<Distortion>::max();
+        Int        bestOffset = 0;
+        for ( Int dy = std::max( -LOOKAHEAD_SEARCH_RANGE, -y0 ); dy <= std::min( LOOKAHEAD_SEARCH_RANGE, lowres.height - blkSize - y0 ); dy++ )
+        {
+          for ( Int dx = std::max( -LOOKAHEAD_SEARCH_RANGE, -x0 ); dx <= std::min( LOOKAHEAD_SEARCH_RANGE, lowres.width - blkSize - x0 ); dx++ )
+          {
+            const Pel* pCand = pRef + dy * stride + dx;
+            Distortion sad = 0;
+            for ( Int y = 0; y < blkSize && sad < minSad; y++ )
+            {
+              for ( Int x = 0; x < blkSize; x++ )
+              {
+                sad += abs( pOrg[y * stride + x] - pCand[y * stride + x] );
+              }
+            }
+            if ( sad < minSad )
+            {
+              minSad     = sad;
+              bestOffset = dy * stride + dx;
+            }
+          }
+        }
+        const Distortion interCost = m_cRdCost.calcHAD( bitDepth, pOrg, stride, pRef + bestOffset, stride, blkSize, blkSize );
+        interSatd += std::min( interCost, intraCost );
+      }
+    }
+  }
+
+  statistics.intraSatd       = intraSatd;
+  statistics.interSatd       = bInter ? interSatd : intraSatd;
+  statistics.bInterSatdValid = bInter;
+  statistics.numBlocks       = numBlocksX * numBlocksY;
+}
+
+//! \}
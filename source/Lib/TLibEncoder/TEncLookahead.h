@@ -0,0 +1,117 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2022, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/** \file     TEncLookahead.h
+    \brief    analysis of the received pictures ahead of their compression (header)
+*/
+
+#ifndef __TENCLOOKAHEAD__
+#define __TENCLOOKAHEAD__
+
+#include "TLibCommon/CommonDef.h"
+#include "TLibCommon/TComRdCost.h"
+#include "TEncPic.h"
+#include "TEncPreanalyzer.h"
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//! \ingroup TLibEncoder
+//! \{
+
+// ====================================================================================================================
+// Class definition
+// ====================================================================================================================
+
+/// Analyses the received pictures before they are compressed: the activities of the adaptive QP (TEncPreanalyzer) and,
+/// if enabled, the statistics of TEncPicStatistics. With worker threads, the pictures are analysed while the next ones
+/// are read and the encoder only waits for the results before it compresses a GOP.
+class TEncLookahead
+{
+private:
+  /// luma of a received picture, downsampled by two in both directions
+  struct LowresPicture
+  {
+    std::vector<Pel> luma;
+    Int              width;
+    Int              height;
+    Bool             bReady;                      ///< luma is computed, guarded by m_mutex
+    LowresPicture() : width(0), height(0), bReady(false) {}
+  };
+
+  struct LookaheadJob
+  {
+    TEncPic*                        pcPic;
+    std::shared_ptr<LowresPicture>  pcLowres;
+    std::shared_ptr<LowresPicture>  pcPrevLowres;  ///< lowres of the previous received picture, NULL for the first
+  };
+
+  TEncPreanalyzer                 m_cPreanalyzer;     ///< image characteristics analyzer for TM5-step3-like adaptive QP
+  TComRdCost                      m_cRdCost;          ///< SATD of the estimates
+  Bool                            m_bAdaptiveQP;
+  Bool                            m_bStatistics;
+  Int                             m_depth;            ///< maximum number of pictures waiting for analysis (0: no limit)
+  std::vector<std::thread>        m_workers;
+  std::mutex                      m_mutex;
+  std::condition_variable         m_cond;
+  std::deque<LookaheadJob>        m_jobs;             ///< pictures not yet taken by a worker
+  Int                             m_numPending;       ///< pictures added and not yet analysed
+  Bool                            m_bStop;
+  std::shared_ptr<LowresPicture>  m_pcLastLowres;     ///< lowres of the last added picture
+
+  Void  xWorker           ();
+  Void  xAnalysePicture   ( LookaheadJob& job );
+  Void  xCalcACDC         ( TEncPic* pcPic );
+  Void  xCalcSatd         ( TEncPic* pcPic, const LowresPicture& lowres, const LowresPicture* pcPrevLowres );
+
+public:
+  TEncLookahead();
+  virtual ~TEncLookahead();
+
+  Void  create            ( Int numThreads, Int depth, Bool bAdaptiveQP, Bool bStatistics );
+  Void  destroy           ();
+
+  Void  addPicture        ( TEncPic* pcPic );  ///< analyse a received picture, on a worker thread if there are any
+  Void  waitForPictures   ();                  ///< wait until all added pictures are analysed
+
+  Bool  getAnalysePictures() const { return m_bAdaptiveQP || m_bStatistics; }   ///< addPicture needs TEncPic pictures
+};
+
+//! \}
+
+#endif // __TENCLOOKAHEAD__
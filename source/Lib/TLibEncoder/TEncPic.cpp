@@ -105,7 +105,10 @@ Void TEncPicQPAdaptationLayer::destroy()
 TEncPic::TEncPic()
 : m_acAQLayer(NULL)
 , m_uiMaxAQDepth(0)
+, m_pcRoiMap(NULL)
 {
+  m_roiRegionBits[ROI_REGION_BACKGROUND] = 0;
+  m_roiRegionBits[ROI_REGION_FOREGROUND] = 0;
 }
 
 /** Destructor
@@ -40,6 +40,9 @@
 
 #include "TLibCommon/CommonDef.h"
 #include "TLibCommon/TComPic.h"
+#include "TEncRoiMap.h"
+
+#include <atomic>
 
 //! \ingroup TLibEncoder
 //! \{
@@ -91,12 +94,29 @@ public:
   Void                   setAvgActivity( Double d )  { m_dAvgActivity = d; }
 };
 
+/// Statistics of the original picture, computed by the lookahead before the picture is compressed
+struct TEncPicStatistics
+{
+  Bool    bValid;                                 ///< statistics are computed for the current content of the picture
+  Int64   orgDC[MAX_NUM_COMPONENT];               ///< sum of the samples of each component
+  Int64   orgAC[MAX_NUM_COMPONENT];               ///< sum of the absolute differences of the samples of each component to their rounded mean
+  UInt64  intraSatd;                              ///< SATD of the best of DC, horizontal and vertical prediction of the 8x8 blocks of the half-resolution luma
+  UInt64  interSatd;                              ///< SATD of the best of intra and full-sample motion compensated prediction from the previous received picture, per block
+  Bool    bInterSatdValid;                        ///< false for the first received picture, which has no previous picture
+  UInt    numBlocks;                              ///< number of 8x8 blocks of the SATD estimates
+
+  TEncPicStatistics() : bValid(false), intraSatd(0), interSatd(0), bInterSatdValid(false), numBlocks(0) {}
+};
+
 /// Picture class including local image characteristics information for QP adaptation
 class TEncPic : public TComPic
 {
 private:
   TEncPicQPAdaptationLayer* m_acAQLayer;
   UInt                      m_uiMaxAQDepth;
+  TEncPicStatistics         m_statistics;                      ///< written by the lookahead, read when the picture is compressed
+  const TEncRoiMap*         m_pcRoiMap;
+  std::atomic<UInt64>       m_roiRegionBits[NUM_ROI_REGIONS];  ///< coded bits of each region, added to by the tile threads concurrently
 
 public:
   TEncPic();
@@ -125,6 +145,17 @@ public:
 
   TEncPicQPAdaptationLayer* getAQLayer( UInt uiDepth )  { return &m_acAQLayer[uiDepth]; }
   UInt                      getMaxAQDepth()             { return m_uiMaxAQDepth;        }
+  TEncPicStatistics&        getStatistics()             { return m_statistics;          }
+  const TEncPicStatistics&  getStatistics() const       { return m_statistics;          }
+
+  Void                      setRoiMap( const TEncRoiMap* pcRoiMap ) { m_pcRoiMap = pcRoiMap; m_roiRegionBits[ROI_REGION_BACKGROUND] = m_roiRegionBits[ROI_REGION_FOREGROUND] = 0; }
+  const TEncRoiMap*         getRoiMap() const           { return m_pcRoiMap;            }
+  /// true if an ROI mask is attached and the rectangle (in luma samples) lies entirely outside its foreground
+  Bool                      isRoiBackground( Int x, Int y, Int width, Int height ) const { return m_pcRoiMap != NULL && m_pcRoiMap->isActive() && !m_pcRoiMap->intersects( x, y, width, height ); }
+
+  /// bits written for the CUs of one region, accumulated while the final bitstream is written
+  Void                      addRoiRegionBits( RoiRegion region, UInt bits ) { m_roiRegionBits[region] += bits; }
+  UInt64                    getRoiRegionBits( RoiRegion region ) const      { return m_roiRegionBits[region]; }
 };
 
 //! \}
@@ -64,6 +64,12 @@ TEncRCSeq::TEncRCSeq()
   m_GOPID2Level         = NULL;
   m_picPara             = NULL;
   m_LCUPara             = NULL;
+  for ( Int i=0; i<NUM_ROI_REGIONS; i++ )
+  {
+    m_roiPara[i]        = NULL;
+  }
+  m_roiParaValid        = NULL;
+  m_roiQPOffset         = NULL;
   m_numberOfPixel       = 0;
   m_framesLeft          = 0;
   m_bitsLeft            = 0;
@@ -177,6 +183,30 @@ Void TEncRCSeq::create( Int totalFrames, Int targetBitrate, Int frameRate, Int G
     }
   }
 
+  // the region models use the inter picture model at all levels, they are updated from the region bits after each picture
+  m_roiParaValid = new Bool[m_numberOfLevel];
+  m_roiQPOffset  = new Int[m_numberOfLevel];
+  for ( Int i=0; i<m_numberOfLevel; i++ )
+  {
+    m_roiParaValid[i] = false;
+    m_roiQPOffset[i]  = 0;
+  }
+  for ( Int r=0; r<NUM_ROI_REGIONS; r++ )
+  {
+    m_roiPara[r] = new TRCParameter[m_numberOfLevel];
+    for ( Int i=0; i<m_numberOfLevel; i++ )
+    {
+      m_roiPara[r][i].m_alpha = 3.2003;
+      m_roiPara[r][i].m_beta  = -1.367;
+#if JVET_K0390_RATE_CTRL
+      m_roiPara[r][i].m_validPix = -1;
+#endif
+#if JVET_M0600_RATE_CTRL
+      m_roiPara[r][i].m_skipRatio = 0.0;
+#endif
+    }
+  }
+
   m_framesLeft = m_totalFrames;
   m_bitsLeft   = m_targetBits;
   m_adaptiveBit = adaptiveBit;
@@ -212,6 +242,27 @@ Void TEncRCSeq::destroy()
     delete[] m_LCUPara;
     m_LCUPara = NULL;
   }
+
+  for ( Int i=0; i<NUM_ROI_REGIONS; i++ )
+  {
+    if ( m_roiPara[i] != NULL )
+    {
+      delete[] m_roiPara[i];
+      m_roiPara[i] = NULL;
+    }
+  }
+
+  if ( m_roiParaValid != NULL )
+  {
+    delete[] m_roiParaValid;
+    m_roiParaValid = NULL;
+  }
+
+  if ( m_roiQPOffset != NULL )
+  {
+    delete[] m_roiQPOffset;
+    m_roiQPOffset = NULL;
+  }
 }
 
 Void TEncRCSeq::initBitsRatio( Int bitsRatio[])
@@ -618,6 +669,10 @@ TEncRCPic::TEncRCPic()
   m_picMSE = 0.0;
   m_validPixelsInPic = 0;
 #endif
+  m_roiEnabled          = false;
+  m_roiQPOffset         = 0;
+  m_roiLambdaRatio      = 1.0;
+  m_roiForegroundPixels = 0.0;
 }
 
 TEncRCPic::~TEncRCPic()
@@ -779,6 +834,8 @@ Void TEncRCPic::create( TEncRCSeq* encRCSeq, TEncRCGOP* encRCGOP, Int frameLevel
       m_LCUs[LCUIdx].m_lambda     = 0.0;
       m_LCUs[LCUIdx].m_targetBits = 0;
       m_LCUs[LCUIdx].m_bitWeight  = 1.0;
+      m_LCUs[LCUIdx].m_roiCoverage = 0.0;
+      m_LCUs[LCUIdx].m_roiWeight   = 1.0;
       Int currWidth  = ( (i == picWidthInLCU -1) ? picWidth  - LCUWidth *(picWidthInLCU -1) : LCUWidth  );
       Int currHeight = ( (j == picHeightInLCU-1) ? picHeight - LCUHeight*(picHeightInLCU-1) : LCUHeight );
       m_LCUs[LCUIdx].m_numberOfPixel = currWidth * currHeight;
@@ -788,6 +845,10 @@ Void TEncRCPic::create( TEncRCSeq* encRCSeq, TEncRCGOP* encRCGOP, Int frameLevel
   m_picActualBits       = 0;
   m_picQP               = 0;
   m_picLambda           = 0.0;
+  m_roiEnabled          = false;
+  m_roiQPOffset         = 0;
+  m_roiLambdaRatio      = 1.0;
+  m_roiForegroundPixels = 0.0;
 }
 
 Void TEncRCPic::destroy()
@@ -989,7 +1050,7 @@ Double TEncRCPic::getLCUTargetBpp(SliceType eSliceType)
     avgBits = 1;
   }
 
-  bpp = ( Double )avgBits/( Double )m_LCUs[ LCUIdx ].m_numberOfPixel;
+  bpp = ( Double )avgBits/( ( Double )m_LCUs[ LCUIdx ].m_numberOfPixel * m_LCUs[ LCUIdx ].m_roiWeight );
   m_LCUs[ LCUIdx ].m_targetBits = avgBits;
 
   return bpp;
@@ -1109,7 +1170,7 @@ Void TEncRCPic::updateAfterCTU( Int LCUIdx, Int bits, Int QP, Double lambda, Boo
 
   Int LCUActualBits   = m_LCUs[LCUIdx].m_actualBits;
   Int LCUTotalPixels  = m_LCUs[LCUIdx].m_numberOfPixel;
-  Double bpp         = ( Double )LCUActualBits/( Double )LCUTotalPixels;
+  Double bpp         = ( Double )LCUActualBits/( ( Double )LCUTotalPixels * m_LCUs[LCUIdx].m_roiWeight );
   Double calLambda   = alpha * pow( bpp, beta );
   Double inputLambda = m_LCUs[LCUIdx].m_lambda;
 
@@ -1409,6 +1470,135 @@ Void TEncRCPic::updateAfterPicture( Int actualHeaderBits, Int actualTotalBits, D
   }
 }
 
+/** set up the ROI rate control of the picture
+ * \param coverage              fraction of the foreground samples of each CTU in raster order
+ * \param foregroundBitShare    share of the data bits given to the foreground, 0 to use foregroundLambdaRatio
+ * \param foregroundLambdaRatio ratio of the foreground to the background lambda
+ * \param picLambda             estimated lambda of the picture
+ *
+ * The CTU lambda and QP of the rate control apply to the background, foreground CUs add the QP offset of the region lambda ratio.
+ * A CTU counts as (1-c) + c*w background samples per sample, where c is its foreground coverage and w the foreground to background
+ * bit density ratio, so that the CTU bit allocation follows the coverage and the CTU R-lambda model describes the background.
+ */
+Void TEncRCPic::initRoiAllocation( const std::vector<Double>& coverage, Double foregroundBitShare, Double foregroundLambdaRatio, Double picLambda )
+{
+  assert( (Int)coverage.size() == m_numberOfLCU );
+
+  m_roiForegroundPixels = 0.0;
+  for ( Int i=0; i<m_numberOfLCU; i++ )
+  {
+    m_LCUs[i].m_roiCoverage = Clip3( 0.0, 1.0, coverage[i] );
+    m_LCUs[i].m_roiWeight   = 1.0;
+    m_roiForegroundPixels  += m_LCUs[i].m_roiCoverage * m_LCUs[i].m_numberOfPixel;
+  }
+  const Double backgroundPixels = m_numberOfPixel - m_roiForegroundPixels;
+
+  m_roiEnabled     = m_roiForegroundPixels >= 1.0 && backgroundPixels >= 1.0;
+  m_roiQPOffset    = 0;
+  m_roiLambdaRatio = 1.0;
+  if ( !m_roiEnabled )
+  {
+    return;
+  }
+
+  const TRCParameter foregroundPara = m_encRCSeq->getRoiPara( ROI_REGION_FOREGROUND, m_frameLevel );
+  const TRCParameter backgroundPara = m_encRCSeq->getRoiPara( ROI_REGION_BACKGROUND, m_frameLevel );
+
+  Double lambdaRatio  = foregroundLambdaRatio;
+  Double densityRatio = 1.0;
+  if ( foregroundBitShare > 0.0 && !m_encRCSeq->getRoiParaValid( m_frameLevel ) )
+  {
+    // the first picture of a level is coded with a common lambda to fit the region models
+    lambdaRatio  = 1.0;
+  }
+  else if ( foregroundBitShare > 0.0 )
+  {
+    // split the data bits between the regions and derive the lambda of each region from its own model
+    const Double dataBits      = max( 1.0, (Double)m_bitsLeft );
+    const Double foregroundBpp = foregroundBitShare * dataBits / m_roiForegroundPixels;
+    const Double backgroundBpp = ( 1.0 - foregroundBitShare ) * dataBits / backgroundPixels;
+    lambdaRatio  = ( foregroundPara.m_alpha * pow( foregroundBpp, foregroundPara.m_beta ) ) / ( backgroundPara.m_alpha * pow( backgroundBpp, backgroundPara.m_beta ) );
+    densityRatio = foregroundBpp / backgroundBpp;
+  }
+
+  m_roiQPOffset    = Clip3( -g_RCRoiMaxQPOffset, g_RCRoiMaxQPOffset, Int( floor( 4.2005 * log( lambdaRatio ) + 0.5 ) ) );
+  if ( foregroundBitShare > 0.0 && m_encRCSeq->getRoiParaValid( m_frameLevel ) )
+  {
+    // the offset follows the region models gradually, a jump would move the bits between the regions faster than the
+    // CTU models of the background can follow
+    const Int lastQPOffset = m_encRCSeq->getRoiQPOffset( m_frameLevel );
+    m_roiQPOffset = Clip3( lastQPOffset - g_RCRoiMaxQPOffsetChange, lastQPOffset + g_RCRoiMaxQPOffsetChange, m_roiQPOffset );
+  }
+  m_encRCSeq->setRoiQPOffset( m_frameLevel, m_roiQPOffset );
+  m_roiLambdaRatio = exp( m_roiQPOffset / 4.2005 );
+
+  if ( foregroundBitShare <= 0.0 || !m_encRCSeq->getRoiParaValid( m_frameLevel ) )
+  {
+    const Double lambda        = Clip3( 0.1, 10000.0, picLambda );
+    const Double foregroundBpp = pow( m_roiLambdaRatio * lambda / foregroundPara.m_alpha, 1.0 / foregroundPara.m_beta );
+    const Double backgroundBpp = pow( lambda / backgroundPara.m_alpha, 1.0 / backgroundPara.m_beta );
+    densityRatio = foregroundBpp / backgroundBpp;
+  }
+  densityRatio = Clip3( 1.0 / 16.0, 16.0, densityRatio );
+
+  // redistribute the CTU bit allocation by the background-equivalent number of samples
+  Double totalWeight    = 0.0;
+  Double totalRoiWeight = 0.0;
+  for ( Int i=0; i<m_numberOfLCU; i++ )
+  {
+    m_LCUs[i].m_roiWeight = 1.0 + m_LCUs[i].m_roiCoverage * ( densityRatio - 1.0 );
+    totalWeight    += m_LCUs[i].m_bitWeight;
+    totalRoiWeight += m_LCUs[i].m_bitWeight * m_LCUs[i].m_roiWeight;
+  }
+  for ( Int i=0; i<m_numberOfLCU; i++ )
+  {
+    m_LCUs[i].m_bitWeight *= m_LCUs[i].m_roiWeight * totalWeight / totalRoiWeight;
+  }
+}
+
+/** update the region models with the bits spent in each region of the coded picture
+ */
+Void TEncRCPic::updateRoiAfterPicture( Double foregroundBits, Double backgroundBits, Double averageLambda )
+{
+  if ( !m_roiEnabled || averageLambda <= 0.0 )
+  {
+    return;
+  }
+  xUpdateRoiPara( ROI_REGION_FOREGROUND, foregroundBits, m_roiForegroundPixels, m_roiLambdaRatio * averageLambda );
+  xUpdateRoiPara( ROI_REGION_BACKGROUND, backgroundBits, m_numberOfPixel - m_roiForegroundPixels, averageLambda );
+  if ( foregroundBits > 0.0 && backgroundBits > 0.0 )
+  {
+    m_encRCSeq->setRoiParaValid( m_frameLevel );
+  }
+}
+
+Void TEncRCPic::xUpdateRoiPara( RoiRegion region, Double bits, Double pixels, Double lambda )
+{
+  TRCParameter rcPara = m_encRCSeq->getRoiPara( region, m_frameLevel );
+
+  Double bpp = bits / pixels;
+  if ( lambda < 0.01 || bpp < 0.0001 )
+  {
+    return;
+  }
+  Double calLambda = rcPara.m_alpha * pow( bpp, rcPara.m_beta );
+  calLambda = Clip3( lambda / 10.0, lambda * 10.0, calLambda );
+
+  // the first picture of a level fits alpha, later pictures move alpha part of the way and beta with the damping of the
+  // picture model, as a single picture says little about the slope of the region model
+  if ( m_encRCSeq->getRoiParaValid( m_frameLevel ) )
+  {
+    const Double lnbpp = Clip3( -5.0, -0.1, log( bpp ) );
+    rcPara.m_beta  = Clip3( g_RCBetaMinValue, g_RCBetaMaxValue, rcPara.m_beta + m_encRCSeq->getBetaUpdate() * ( log( lambda ) - log( calLambda ) ) * lnbpp );
+    rcPara.m_alpha = Clip3( g_RCAlphaMinValue, g_RCAlphaMaxValue, rcPara.m_alpha * pow( lambda / calLambda, g_RCRoiAlphaUpdate ) );
+  }
+  else
+  {
+    rcPara.m_alpha = Clip3( g_RCAlphaMinValue, g_RCAlphaMaxValue, rcPara.m_alpha * lambda / calLambda );
+  }
+  m_encRCSeq->setRoiPara( region, m_frameLevel, rcPara );
+}
+
 Int TEncRCPic::getRefineBitsForIntra( Int orgBits )
 {
   Double alpha=0.25, beta=0.5582;
@@ -76,6 +76,9 @@ const Double g_RCAlphaMinValue = 0.05;
 const Double g_RCAlphaMaxValue = 500.0;
 const Double g_RCBetaMinValue  = -3.0;
 const Double g_RCBetaMaxValue  = -0.1;
+const Int g_RCRoiMaxQPOffset = 12;
+const Double g_RCRoiAlphaUpdate = 0.5;
+const Int g_RCRoiMaxQPOffsetChange = 2;
 #if JVET_K0390_RATE_CTRL
 const Int LAMBDA_PREC = 1000000;
 #endif
@@ -98,6 +101,8 @@ struct TRCLCU
   Double m_actualSSE;
   Double m_actualMSE;
 #endif
+  Double m_roiCoverage;   ///< fraction of the CTU samples in the ROI foreground
+  Double m_roiWeight;     ///< number of background-equivalent samples per CTU sample, used for bit allocation and the CTU R-lambda model
 };
 
 struct TRCParameter
@@ -163,6 +168,12 @@ public:
   TRCParameter*  getLCUPara( Int level )                        { assert( level < m_numberOfLevel ); return m_LCUPara[level]; }
   TRCParameter   getLCUPara( Int level, Int LCUIdx )            { assert( LCUIdx  < m_numberOfLCU ); return getLCUPara(level)[LCUIdx]; }
   Void           setLCUPara( Int level, Int LCUIdx, TRCParameter para ) { assert( level < m_numberOfLevel ); assert( LCUIdx  < m_numberOfLCU ); m_LCUPara[level][LCUIdx] = para; }
+  TRCParameter   getRoiPara( RoiRegion region, Int level )                    { assert( level < m_numberOfLevel ); return m_roiPara[region][level]; }
+  Void           setRoiPara( RoiRegion region, Int level, TRCParameter para ) { assert( level < m_numberOfLevel ); m_roiPara[region][level] = para; }
+  Bool           getRoiParaValid( Int level )                                 { assert( level < m_numberOfLevel ); return m_roiParaValid[level]; }
+  Void           setRoiParaValid( Int level )                                 { assert( level < m_numberOfLevel ); m_roiParaValid[level] = true; }
+  Int            getRoiQPOffset( Int level )                                  { assert( level < m_numberOfLevel ); return m_roiQPOffset[level]; }
+  Void           setRoiQPOffset( Int level, Int offset )                      { assert( level < m_numberOfLevel ); m_roiQPOffset[level] = offset; }
 
   Int  getFramesLeft()                  { return m_framesLeft; }
   Int64  getBitsLeft()                  { return m_bitsLeft; }
@@ -197,6 +208,9 @@ private:
   Int* m_GOPID2Level;
   TRCParameter*  m_picPara;
   TRCParameter** m_LCUPara;
+  TRCParameter*  m_roiPara[NUM_ROI_REGIONS];  ///< R-lambda model of each ROI region per level
+  Bool*          m_roiParaValid;              ///< the region models of the level have been fitted to a coded picture
+  Int*           m_roiQPOffset;               ///< foreground QP offset of the last picture of the level
 
   Int m_framesLeft;
   Int64 m_bitsLeft;
@@ -277,6 +291,9 @@ public:
 #endif
   Void updateAfterPicture( Int actualHeaderBits, Int actualTotalBits, Double averageQP, Double averageLambda, SliceType eSliceType);
 
+  Void initRoiAllocation( const std::vector<Double>& coverage, Double foregroundBitShare, Double foregroundLambdaRatio, Double picLambda );
+  Void updateRoiAfterPicture( Double foregroundBits, Double backgroundBits, Double averageLambda );
+
   Void addToPictureLsit( list<TEncRCPic*>& listPreviousPictures );
   Double calAverageQP();
   Double calAverageLambda();
@@ -285,6 +302,7 @@ private:
   Int xEstPicTargetBits( TEncRCSeq* encRCSeq, TEncRCGOP* encRCGOP );
   Int xEstPicHeaderBits( list<TEncRCPic*>& listPreviousPictures, Int frameLevel );
   Int xEstPicLowerBound( TEncRCSeq* encRCSeq, TEncRCGOP* encRCGOP );
+  Void xUpdateRoiPara( RoiRegion region, Double bits, Double pixels, Double lambda );
 
 public:
   TEncRCSeq*      getRCSequence()                         { return m_encRCSeq; }
@@ -317,6 +335,10 @@ public:
   Double getPicEstLambda()                                { return m_estPicLambda; }
   Void setPicEstLambda( Double lambda )                   { m_picLambda = lambda; }
 
+  Bool getRoiEnabled()                                    { return m_roiEnabled; }
+  Int  getRoiQPOffset()                                   { return m_roiQPOffset; }
+  Double getRoiLambdaRatio()                              { return m_roiLambdaRatio; }
+
 #if JVET_K0390_RATE_CTRL
   Double getPicMSE()                                      { return m_picMSE; }
   void  setPicMSE(Double avgMSE)                           { m_picMSE = avgMSE; }
@@ -350,6 +372,10 @@ private:
   Double m_picMSE;
   Int m_validPixelsInPic;
 #endif
+  Bool m_roiEnabled;              ///< the picture has foreground and background samples and uses ROI rate control
+  Int m_roiQPOffset;              ///< QP offset of the foreground CUs against the CTU QP
+  Double m_roiLambdaRatio;        ///< foreground to background lambda ratio matching m_roiQPOffset
+  Double m_roiForegroundPixels;
 };
 
 class TEncRateCtrl
@@ -0,0 +1,513 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2022, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TEncRoiMap.cpp
+    \brief    region-of-interest mask for ROI-based QP selection
+*/
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include "TEncRoiMap.h"
+
+#include <algorithm>
+#include <iostream>
+
+//! \ingroup TLibEncoder
+//! \{
+
+const Int  TEncRoiMap::s_foregroundThreshold = 128;
+const UInt TEncRoiMap::s_maxObjects          = 127;   // objects plus cancellations stay below the 256 updates of one SEI
+
+/// root of a label in the union-find forest of provisional labels, with path halving
+static inline UInt findRootLabel( std::vector<UInt> &parent, UInt label )
+{
+  while ( parent[label] != label )
+  {
+    parent[label] = parent[parent[label]];
+    label = parent[label];
+  }
+  return label;
+}
+
+TEncRoiMap::TEncRoiMap()
+: m_active      (false)
+, m_picWidth    (0)
+, m_picHeight   (0)
+, m_log2BlkSize (0)
+, m_widthInBlks (0)
+, m_heightInBlks(0)
+{
+}
+
+TEncRoiMap::~TEncRoiMap()
+{
+  destroy();
+}
+
+/** Allocate the block grid covering the picture
+ * \param picWidth    picture width in luma samples
+ * \param picHeight   picture height in luma samples
+ * \param log2BlkSize log2 of the block size, normally the minimum CU size
+ */
+Void TEncRoiMap::create( Int picWidth, Int picHeight, UInt log2BlkSize )
+{
+  m_picWidth     = picWidth;
+  m_picHeight    = picHeight;
+  m_log2BlkSize  = log2BlkSize;
+  m_widthInBlks  = ( picWidth  + ( 1 << log2BlkSize ) - 1 ) >> log2BlkSize;
+  m_heightInBlks = ( picHeight + ( 1 << log2BlkSize ) - 1 ) >> log2BlkSize;
+
+  m_occupancy.assign    ( std::size_t( m_widthInBlks * m_heightInBlks ), 0 );
+  m_integral.assign     ( std::size_t( ( m_widthInBlks + 1 ) * ( m_heightInBlks + 1 ) ), 0 );
+  m_blkLevelSum.assign  ( std::size_t( m_widthInBlks * m_heightInBlks ), 0 );
+  m_levelIntegral.assign( std::size_t( ( m_widthInBlks + 1 ) * ( m_heightInBlks + 1 ) ), 0 );
+
+  const Int numLevels = std::max( 1, MAX_CU_DEPTH - Int( log2BlkSize ) + 1 );
+  m_maxLevel.resize( numLevels );
+  for ( Int i = 0; i < numLevels; i++ )
+  {
+    const Int widthInBlks  = ( m_widthInBlks  + ( 1 << i ) - 1 ) >> i;
+    const Int heightInBlks = ( m_heightInBlks + ( 1 << i ) - 1 ) >> i;
+    m_maxLevel[i].assign( std::size_t( widthInBlks * heightInBlks ), 0 );
+  }
+  m_active = false;
+}
+
+Void TEncRoiMap::destroy()
+{
+  m_occupancy.clear();
+  m_integral.clear();
+  m_blkLevelSum.clear();
+  m_levelIntegral.clear();
+  m_maxLevel.clear();
+  m_objects.clear();
+  m_cancelledObjects.clear();
+  m_active = false;
+}
+
+/** Decode a mask image and rebuild the occupancy map
+ * \param fileName 8-bit mask image (any format readable by stb_image)
+ * \returns true on success
+ */
+Bool TEncRoiMap::loadMask( const std::string &fileName )
+{
+  Int maskWidth, maskHeight, channels;
+  UChar *data = stbi_load( fileName.c_str(), &maskWidth, &maskHeight, &channels, STBI_grey );
+  if ( data == NULL )
+  {
+    std::cerr << "Could not open or find the ROI mask image '" << fileName << "'" << std::endl;
+    return false;
+  }
+  setMask( data, maskWidth, maskHeight, maskWidth );
+  stbi_image_free( data );
+  return true;
+}
+
+/** Downsample an 8-bit mask to the block grid.
+ * Each block keeps the maximum and the sum of its mask samples; blocks whose maximum is above the foreground threshold
+ * are foreground. Samples outside the picture are ignored and picture areas not covered by the mask are background.
+ */
+Void TEncRoiMap::setMask( const UChar *samples, Int maskWidth, Int maskHeight, Int stride )
+{
+  std::vector<UChar> &blkMax = m_maxLevel[0];
+  std::fill( blkMax.begin(),        blkMax.end(),        0 );
+  std::fill( m_blkLevelSum.begin(), m_blkLevelSum.end(), 0 );
+
+  const Int width  = std::min( maskWidth,  m_picWidth  );
+  const Int height = std::min( maskHeight, m_picHeight );
+  for ( Int y = 0; y < height; y++ )
+  {
+    const UChar *pLine = samples + y * stride;
+    UChar *pBlkMax = &blkMax[( y >> m_log2BlkSize ) * m_widthInBlks];
+    UInt  *pBlkSum = &m_blkLevelSum[( y >> m_log2BlkSize ) * m_widthInBlks];
+    for ( Int x = 0; x < width; x++ )
+    {
+      const Int bx = x >> m_log2BlkSize;
+      pBlkMax[bx] = std::max( pBlkMax[bx], pLine[x] );
+      pBlkSum[bx] += pLine[x];
+    }
+  }
+
+  for ( std::size_t i = 0; i < m_occupancy.size(); i++ )
+  {
+    m_occupancy[i] = blkMax[i] > s_foregroundThreshold ? 1 : 0;
+  }
+
+  xBuildIntegral();
+  xBuildMaxPyramid();
+  xLabelObjects();
+  m_active = true;
+}
+
+Bool TEncRoiMap::intersects( Int x, Int y, Int width, Int height ) const
+{
+  return getNumForegroundBlocks( x, y, width, height ) > 0;
+}
+
+UInt TEncRoiMap::getNumForegroundBlocks( Int x, Int y, Int width, Int height ) const
+{
+  if ( !m_active )
+  {
+    return 0;
+  }
+  const Int blkSize = 1 << m_log2BlkSize;
+  const Int x0 = Clip3( 0, m_widthInBlks,  x >> m_log2BlkSize );
+  const Int y0 = Clip3( 0, m_heightInBlks, y >> m_log2BlkSize );
+  const Int x1 = Clip3( 0, m_widthInBlks,  ( x + width  + blkSize - 1 ) >> m_log2BlkSize );
+  const Int y1 = Clip3( 0, m_heightInBlks, ( y + height + blkSize - 1 ) >> m_log2BlkSize );
+  if ( x0 >= x1 || y0 >= y1 )
+  {
+    return 0;
+  }
+  const Int stride = m_widthInBlks + 1;
+  return m_integral[y1 * stride + x1] - m_integral[y0 * stride + x1] - m_integral[y1 * stride + x0] + m_integral[y0 * stride + x0];
+}
+
+/** Importance levels are taken from the coarsest pyramid level whose blocks tile the rectangle exactly,
+ * so a CU aligned to its own size needs a single lookup.
+ */
+Int TEncRoiMap::getMaxLevel( Int x, Int y, Int width, Int height ) const
+{
+  if ( !m_active )
+  {
+    return 0;
+  }
+  const Int extentX = m_widthInBlks  << m_log2BlkSize;
+  const Int extentY = m_heightInBlks << m_log2BlkSize;
+  const Int x0 = Clip3( 0, extentX, x );
+  const Int y0 = Clip3( 0, extentY, y );
+  const Int x1 = Clip3( 0, extentX, x + width );
+  const Int y1 = Clip3( 0, extentY, y + height );
+  if ( x0 >= x1 || y0 >= y1 )
+  {
+    return 0;
+  }
+
+  UInt level = 0;
+  while ( level + 1 < m_maxLevel.size() )
+  {
+    const Int mask = ( 1 << ( m_log2BlkSize + level + 1 ) ) - 1;
+    if ( ( x0 & mask ) || ( y0 & mask ) || ( ( x1 & mask ) && x1 != extentX ) || ( ( y1 & mask ) && y1 != extentY ) )
+    {
+      break;
+    }
+    level++;
+  }
+
+  const UInt log2Size   = m_log2BlkSize + level;
+  const Int  stride     = ( m_widthInBlks + ( 1 << level ) - 1 ) >> level;
+  const std::vector<UChar> &levelMax = m_maxLevel[level];
+  Int maxLevel = 0;
+  for ( Int by = y0 >> log2Size; by <= ( y1 - 1 ) >> log2Size; by++ )
+  {
+    for ( Int bx = x0 >> log2Size; bx <= ( x1 - 1 ) >> log2Size; bx++ )
+    {
+      maxLevel = std::max( maxLevel, Int( levelMax[by * stride + bx] ) );
+    }
+  }
+  return maxLevel;
+}
+
+Int TEncRoiMap::getMeanLevel( Int x, Int y, Int width, Int height ) const
+{
+  if ( !m_active )
+  {
+    return 0;
+  }
+  const Int blkSize = 1 << m_log2BlkSize;
+  const Int x0 = Clip3( 0, m_widthInBlks,  x >> m_log2BlkSize );
+  const Int y0 = Clip3( 0, m_heightInBlks, y >> m_log2BlkSize );
+  const Int x1 = Clip3( 0, m_widthInBlks,  ( x + width  + blkSize - 1 ) >> m_log2BlkSize );
+  const Int y1 = Clip3( 0, m_heightInBlks, ( y + height + blkSize - 1 ) >> m_log2BlkSize );
+  if ( x0 >= x1 || y0 >= y1 )
+  {
+    return 0;
+  }
+  const Int stride = m_widthInBlks + 1;
+  const UInt64 sum = m_levelIntegral[y1 * stride + x1] - m_levelIntegral[y0 * stride + x1] - m_levelIntegral[y1 * stride + x0] + m_levelIntegral[y0 * stride + x0];
+  const UInt64 area = UInt64( std::min( x1 << m_log2BlkSize, m_picWidth  ) - ( x0 << m_log2BlkSize ) )
+                    * UInt64( std::min( y1 << m_log2BlkSize, m_picHeight ) - ( y0 << m_log2BlkSize ) );
+  return area > 0 ? Int( ( sum + ( area >> 1 ) ) / area ) : 0;
+}
+
+Void TEncRoiMap::xBuildIntegral()
+{
+  const Int stride = m_widthInBlks + 1;
+  std::fill( m_integral.begin(),      m_integral.begin()      + stride, 0 );
+  std::fill( m_levelIntegral.begin(), m_levelIntegral.begin() + stride, 0 );
+  for ( Int by = 0; by < m_heightInBlks; by++ )
+  {
+    const UChar  *pBlkLine    = &m_occupancy[by * m_widthInBlks];
+    const UInt   *pBlkSumLine = &m_blkLevelSum[by * m_widthInBlks];
+    const UInt   *pAbove      = &m_integral[by * stride];
+    const UInt64 *pSumAbove   = &m_levelIntegral[by * stride];
+    UInt         *pCur        = &m_integral[( by + 1 ) * stride];
+    UInt64       *pSumCur     = &m_levelIntegral[( by + 1 ) * stride];
+    UInt   rowSum      = 0;
+    UInt64 rowLevelSum = 0;
+    pCur[0]    = 0;
+    pSumCur[0] = 0;
+    for ( Int bx = 0; bx < m_widthInBlks; bx++ )
+    {
+      rowSum      += pBlkLine[bx];
+      rowLevelSum += pBlkSumLine[bx];
+      pCur[bx + 1]    = pAbove[bx + 1] + rowSum;
+      pSumCur[bx + 1] = pSumAbove[bx + 1] + rowLevelSum;
+    }
+  }
+}
+
+/** Each pyramid level holds the maximum of 2x2 blocks of the level below
+ */
+Void TEncRoiMap::xBuildMaxPyramid()
+{
+  for ( std::size_t level = 1; level < m_maxLevel.size(); level++ )
+  {
+    const std::vector<UChar> &src = m_maxLevel[level - 1];
+    std::vector<UChar>       &dst = m_maxLevel[level];
+    const Int srcWidth  = ( m_widthInBlks  + ( 1 << ( level - 1 ) ) - 1 ) >> ( level - 1 );
+    const Int srcHeight = ( m_heightInBlks + ( 1 << ( level - 1 ) ) - 1 ) >> ( level - 1 );
+    const Int dstWidth  = ( srcWidth  + 1 ) >> 1;
+    const Int dstHeight = ( srcHeight + 1 ) >> 1;
+    for ( Int by = 0; by < dstHeight; by++ )
+    {
+      for ( Int bx = 0; bx < dstWidth; bx++ )
+      {
+        const Int sx0 = 2 * bx, sx1 = std::min( 2 * bx + 1, srcWidth  - 1 );
+        const Int sy0 = 2 * by, sy1 = std::min( 2 * by + 1, srcHeight - 1 );
+        dst[by * dstWidth + bx] = std::max( std::max( src[sy0 * srcWidth + sx0], src[sy0 * srcWidth + sx1] ),
+                                            std::max( src[sy1 * srcWidth + sx0], src[sy1 * srcWidth + sx1] ) );
+      }
+    }
+  }
+}
+
+/** Greedy matching by overlap area: the object pair with the largest overlap is matched first. Matched objects keep the
+ * index of the previous object, new objects take the lowest index not used by the previous picture, so that a
+ * cancelled index is not reused in the same update.
+ */
+Void TEncRoiMap::trackObjects( const TEncRoiMap &prevMap )
+{
+  const std::vector<RoiObject> &prevObjects = prevMap.m_objects;
+  std::vector< std::pair<Int, std::pair<UInt, UInt> > > overlaps;
+  for ( UInt i = 0; i < m_objects.size(); i++ )
+  {
+    const RoiObject &cur = m_objects[i];
+    for ( UInt j = 0; j < prevObjects.size(); j++ )
+    {
+      const RoiObject &prev = prevObjects[j];
+      const Int w = std::min( cur.left + cur.width,  prev.left + prev.width  ) - std::max( cur.left, prev.left );
+      const Int h = std::min( cur.top  + cur.height, prev.top  + prev.height ) - std::max( cur.top,  prev.top  );
+      if ( w > 0 && h > 0 )
+      {
+        overlaps.push_back( std::make_pair( -w * h, std::make_pair( i, j ) ) );
+      }
+    }
+  }
+  std::sort( overlaps.begin(), overlaps.end() );
+
+  std::vector<Int>  prevOfObject( m_objects.size(), -1 );
+  std::vector<Bool> prevMatched ( prevObjects.size(), false );
+  for ( std::size_t k = 0; k < overlaps.size(); k++ )
+  {
+    const UInt i = overlaps[k].second.first;
+    const UInt j = overlaps[k].second.second;
+    if ( prevOfObject[i] < 0 && !prevMatched[j] )
+    {
+      prevOfObject[i] = j;
+      prevMatched[j]  = true;
+    }
+  }
+
+  std::vector<Bool> idxUsed( 2 * s_maxObjects + 1, false );
+  for ( std::size_t j = 0; j < prevObjects.size(); j++ )
+  {
+    idxUsed[prevObjects[j].idx] = true;
+  }
+  UInt nextIdx = 0;
+  for ( std::size_t i = 0; i < m_objects.size(); i++ )
+  {
+    RoiObject &cur = m_objects[i];
+    if ( prevOfObject[i] >= 0 )
+    {
+      const RoiObject &prev = prevObjects[prevOfObject[i]];
+      cur.idx     = prev.idx;
+      cur.changed = cur.left != prev.left || cur.top != prev.top || cur.width != prev.width || cur.height != prev.height;
+    }
+    else
+    {
+      while ( idxUsed[nextIdx] )
+      {
+        nextIdx++;
+      }
+      idxUsed[nextIdx] = true;
+      cur.idx     = nextIdx;
+      cur.changed = true;
+    }
+  }
+
+  m_cancelledObjects.clear();
+  for ( std::size_t j = 0; j < prevObjects.size(); j++ )
+  {
+    if ( !prevMatched[j] )
+    {
+      m_cancelledObjects.push_back( prevObjects[j].idx );
+    }
+  }
+}
+
+Void TEncRoiMap::clearObjectUpdates()
+{
+  for ( std::size_t i = 0; i < m_objects.size(); i++ )
+  {
+    m_objects[i].changed = false;
+  }
+  m_cancelledObjects.clear();
+}
+
+/** Two-pass connected component labelling of the foreground blocks with 8-connectivity.
+ * The first pass gives each block the smallest root label of its causal neighbours and merges their trees, the second
+ * pass resolves the roots and accumulates the bounding boxes, so the cost is linear in the number of blocks.
+ * Objects are numbered in raster order of their first block, the first picture of a sequence sends all of them as new.
+ */
+Void TEncRoiMap::xLabelObjects()
+{
+  m_objects.clear();
+  m_cancelledObjects.clear();
+
+  std::vector<UInt> labels( m_occupancy.size(), 0 );
+  std::vector<UInt> parent( 1, 0 );   // label 0 is the background
+  for ( Int by = 0; by < m_heightInBlks; by++ )
+  {
+    for ( Int bx = 0; bx < m_widthInBlks; bx++ )
+    {
+      const Int pos = by * m_widthInBlks + bx;
+      if ( !m_occupancy[pos] )
+      {
+        continue;
+      }
+      const Int numNeighbours = 4;
+      const Int neighbour[numNeighbours] =
+      {
+        bx > 0                                ? pos - 1                   : -1,
+        by > 0 && bx > 0                      ? pos - m_widthInBlks - 1   : -1,
+        by > 0                                ? pos - m_widthInBlks       : -1,
+        by > 0 && bx + 1 < m_widthInBlks      ? pos - m_widthInBlks + 1   : -1
+      };
+      UInt label = 0;
+      for ( Int n = 0; n < numNeighbours; n++ )
+      {
+        if ( neighbour[n] < 0 || labels[neighbour[n]] == 0 )
+        {
+          continue;
+        }
+        const UInt root = findRootLabel( parent, labels[neighbour[n]] );
+        if ( label == 0 )
+        {
+          label = root;
+        }
+        else if ( root != label )
+        {
+          parent[std::max( root, label )] = std::min( root, label );
+          label = std::min( root, label );
+        }
+      }
+      if ( label == 0 )
+      {
+        label = UInt( parent.size() );
+        parent.push_back( label );
+      }
+      labels[pos] = label;
+    }
+  }
+
+  std::vector<Int> objectOfRoot( parent.size(), -1 );
+  std::vector<Int> blkRight, blkBottom;
+  for ( Int by = 0; by < m_heightInBlks; by++ )
+  {
+    for ( Int bx = 0; bx < m_widthInBlks; bx++ )
+    {
+      const UInt label = labels[by * m_widthInBlks + bx];
+      if ( label == 0 )
+      {
+        continue;
+      }
+      const UInt root = findRootLabel( parent, label );
+      if ( objectOfRoot[root] < 0 )
+      {
+        objectOfRoot[root] = Int( m_objects.size() );
+        RoiObject object;
+        object.idx       = UInt( m_objects.size() );
+        object.left      = bx;
+        object.top       = by;
+        object.width     = 0;
+        object.height    = 0;
+        object.numBlocks = 0;
+        object.changed   = true;
+        m_objects.push_back( object );
+        blkRight.push_back ( bx );
+        blkBottom.push_back( by );
+      }
+      const Int i = objectOfRoot[root];
+      m_objects[i].left = std::min( m_objects[i].left, bx );
+      blkRight[i]       = std::max( blkRight[i], bx );
+      blkBottom[i]      = by;
+      m_objects[i].numBlocks++;
+    }
+  }
+
+  for ( std::size_t i = 0; i < m_objects.size(); i++ )
+  {
+    RoiObject &object = m_objects[i];
+    const Int right  = std::min( ( blkRight[i]  + 1 ) << m_log2BlkSize, m_picWidth  );
+    const Int bottom = std::min( ( blkBottom[i] + 1 ) << m_log2BlkSize, m_picHeight );
+    object.left   <<= m_log2BlkSize;
+    object.top    <<= m_log2BlkSize;
+    object.width    = right  - object.left;
+    object.height   = bottom - object.top;
+  }
+
+  if ( m_objects.size() > s_maxObjects )
+  {
+    std::stable_sort( m_objects.begin(), m_objects.end(), []( const RoiObject &a, const RoiObject &b ) { return a.numBlocks > b.numBlocks; } );
+    m_objects.resize( s_maxObjects );
+    std::sort( m_objects.begin(), m_objects.end(), []( const RoiObject &a, const RoiObject &b ) { return a.idx < b.idx; } );
+    for ( UInt i = 0; i < m_objects.size(); i++ )
+    {
+      m_objects[i].idx = i;
+    }
+  }
+}
+
+//! \}
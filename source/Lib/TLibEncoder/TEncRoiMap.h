@@ -0,0 +1,137 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2022, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TEncRoiMap.h
+    \brief    region-of-interest mask for ROI-based QP selection (header)
+*/
+
+#ifndef __TENCROIMAP__
+#define __TENCROIMAP__
+
+#include "TLibCommon/CommonDef.h"
+#include <string>
+#include <vector>
+
+//! \ingroup TLibEncoder
+//! \{
+
+// ====================================================================================================================
+// Class definition
+// ====================================================================================================================
+
+/// ROI mask decoded once and stored as occupancy and importance maps aligned to the minimum CU size
+class TEncRoiMap
+{
+public:
+  /// connected foreground region of the mask, as carried by the annotated regions SEI
+  struct RoiObject
+  {
+    UInt  idx;        ///< object index, kept for the same region across a mask sequence
+    Int   left;       ///< bounding box in luma samples
+    Int   top;
+    Int   width;
+    Int   height;
+    UInt  numBlocks;  ///< number of foreground blocks of the region
+    Bool  changed;    ///< new, or bounding box moved since the previous picture in output order
+  };
+
+  static const UInt s_maxObjects;
+
+  TEncRoiMap();
+  virtual ~TEncRoiMap();
+
+  Void  create          ( Int picWidth, Int picHeight, UInt log2BlkSize );
+  Void  destroy         ();
+
+  /// decode an 8-bit mask image and rebuild the occupancy map, returns false if the image cannot be read
+  Bool  loadMask        ( const std::string &fileName );
+  /// rebuild the occupancy map from 8-bit mask samples
+  Void  setMask         ( const UChar *samples, Int maskWidth, Int maskHeight, Int stride );
+
+  Bool  isActive        () const { return m_active; }
+
+  /// true if the rectangle (in luma samples) covers at least one foreground block
+  Bool  intersects      ( Int x, Int y, Int width, Int height ) const;
+
+  /// number of foreground blocks covered by the rectangle (in luma samples)
+  UInt  getNumForegroundBlocks( Int x, Int y, Int width, Int height ) const;
+
+  /// maximum importance level (0..255) of the mask samples covered by the rectangle, a single lookup for aligned CUs
+  Int   getMaxLevel     ( Int x, Int y, Int width, Int height ) const;
+  /// area-weighted mean importance level (0..255) of the mask samples covered by the rectangle
+  Int   getMeanLevel    ( Int x, Int y, Int width, Int height ) const;
+
+  /// occupancy of one row of blocks, one entry (0 or 1) per block
+  const UChar* getOccupancyRow( Int blkY ) const { return &m_occupancy[blkY * m_widthInBlks]; }
+  /// maximum mask sample of each block of one row of blocks
+  const UChar* getMaxLevelRow ( Int blkY ) const { return &m_maxLevel[0][blkY * m_widthInBlks]; }
+
+  /// connected foreground regions in raster order of their first block, at most s_maxObjects (the largest ones)
+  const std::vector<RoiObject>& getObjects         () const { return m_objects; }
+  /// indices of the objects of the previous picture in output order that no longer exist
+  const std::vector<UInt>&      getCancelledObjects() const { return m_cancelledObjects; }
+
+  /// give the objects the indices of the best overlapping objects of the previous picture and mark the changes
+  Void  trackObjects    ( const TEncRoiMap &prevMap );
+  /// mark the objects as unchanged, for a mask that is held for the following pictures
+  Void  clearObjectUpdates();
+
+  UInt  getLog2BlkSize  () const { return m_log2BlkSize; }
+  Int   getWidthInBlks  () const { return m_widthInBlks; }
+  Int   getHeightInBlks () const { return m_heightInBlks; }
+
+private:
+  Void  xBuildIntegral  ();
+  Void  xBuildMaxPyramid();
+  Void  xLabelObjects   ();
+
+  static const Int    s_foregroundThreshold;
+
+  Bool                m_active;
+  Int                 m_picWidth;
+  Int                 m_picHeight;
+  UInt                m_log2BlkSize;
+  Int                 m_widthInBlks;
+  Int                 m_heightInBlks;
+  std::vector<UChar>  m_occupancy;        ///< one entry per block, 1 if any mask sample in the block is foreground
+  std::vector<UInt>   m_integral;         ///< summed-area table of m_occupancy, (m_widthInBlks+1) x (m_heightInBlks+1)
+  std::vector<UInt>   m_blkLevelSum;      ///< one entry per block, sum of the mask samples in the block
+  std::vector<UInt64> m_levelIntegral;    ///< summed-area table of m_blkLevelSum, (m_widthInBlks+1) x (m_heightInBlks+1)
+  std::vector< std::vector<UChar> > m_maxLevel; ///< [i] maximum mask sample per block of size 1<<(m_log2BlkSize+i), up to MAX_CU_SIZE
+  std::vector<RoiObject> m_objects;       ///< 8-connected components of m_occupancy
+  std::vector<UInt>   m_cancelledObjects;
+};
+
+//! \}
+
+#endif // __TENCROIMAP__
@@ -0,0 +1,472 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2022, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TEncRoiMaskReader.cpp
+    \brief    ROI mask sequence reader with asynchronous prefetch
+*/
+
+#include "TEncRoiMaskReader.h"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+//! \ingroup TLibEncoder
+//! \{
+
+static const Int s_maxFileNameLength = 4096;
+
+TEncRoiMaskReader::TEncRoiMaskReader()
+: m_isOpen        (false)
+, m_isPattern     (false)
+, m_format        (ROI_MASK_FORMAT_AUTO)
+, m_picWidth      (0)
+, m_picHeight     (0)
+, m_maskWidth     (0)
+, m_maskHeight    (0)
+, m_log2BlkSize   (0)
+, m_firstFrame    (0)
+, m_frameStep     (1)
+, m_maskInterval  (1)
+, m_numPictures   (0)
+, m_prefetchDepth (1)
+, m_y4mDataStart  (0)
+, m_y4mChromaSize (0)
+, m_fileFrameIdx  (0)
+, m_nextPoc       (0)
+, m_endOfSequence (false)
+, m_stop          (false)
+{
+}
+
+TEncRoiMaskReader::~TEncRoiMaskReader()
+{
+  close();
+}
+
+Bool TEncRoiMaskReader::open( const std::string &fileName, RoiMaskFormat format, Int picWidth, Int picHeight, Int maskWidth, Int maskHeight,
+                              UInt log2BlkSize, Int firstFrame, Int frameStep, Int maskInterval, Int numPictures, Int prefetchDepth )
+{
+  close();
+
+  m_fileName      = fileName;
+  m_picWidth      = picWidth;
+  m_picHeight     = picHeight;
+  m_maskWidth     = maskWidth;
+  m_maskHeight    = maskHeight;
+  m_log2BlkSize   = log2BlkSize;
+  m_firstFrame    = firstFrame;
+  m_frameStep     = std::max( 1, frameStep );
+  m_maskInterval  = std::max( 1, maskInterval );
+  m_numPictures   = numPictures;
+  m_prefetchDepth = std::max( 1, prefetchDepth );
+  m_isPattern     = fileName.find( '%' ) != std::string::npos;
+  m_format        = format;
+
+  if ( m_format == ROI_MASK_FORMAT_AUTO )
+  {
+    const std::string::size_type dot = fileName.find_last_of( '.' );
+    std::string ext = dot == std::string::npos ? std::string() : fileName.substr( dot + 1 );
+    for ( std::string::iterator it = ext.begin(); it != ext.end(); it++ )
+    {
+      *it = (TChar)tolower( *it );
+    }
+    m_format = ext == "y4m" ? ROI_MASK_FORMAT_Y4M : ext == "yuv" ? ROI_MASK_FORMAT_YUV400 : ROI_MASK_FORMAT_IMAGE;
+  }
+
+  m_staticMap.create( m_picWidth, m_picHeight, m_log2BlkSize );
+  m_lastMap.create  ( m_picWidth, m_picHeight, m_log2BlkSize );
+
+  if ( !isSequence() )
+  {
+    m_isOpen = m_staticMap.loadMask( m_fileName );
+    // the objects of a static mask never change, they are sent at the refresh pictures only
+    m_staticMap.clearObjectUpdates();
+    return m_isOpen;
+  }
+
+  if ( !xOpenFile() )
+  {
+    return false;
+  }
+
+  m_nextPoc       = 0;
+  m_endOfSequence = false;
+  m_stop          = false;
+  m_isOpen        = true;
+  m_thread        = std::thread( &TEncRoiMaskReader::xPrefetch, this );
+  return true;
+}
+
+Void TEncRoiMaskReader::close()
+{
+  if ( m_thread.joinable() )
+  {
+    {
+      std::lock_guard<std::mutex> lock( m_mutex );
+      m_stop = true;
+    }
+    m_spaceAvailable.notify_all();
+    m_thread.join();
+  }
+
+  for ( std::map<Int, TEncRoiMap*>::iterator it = m_maps.begin(); it != m_maps.end(); it++ )
+  {
+    delete it->second;
+  }
+  m_maps.clear();
+
+  if ( m_file.is_open() )
+  {
+    m_file.close();
+  }
+  m_staticMap.destroy();
+  m_lastMap.destroy();
+  m_isOpen = false;
+}
+
+const TEncRoiMap* TEncRoiMaskReader::getMap( Int poc )
+{
+  if ( !isSequence() )
+  {
+    return &m_staticMap;
+  }
+
+  std::unique_lock<std::mutex> lock( m_mutex );
+  m_mapReady.wait( lock, [&]{ return m_maps.count( poc ) > 0 || m_endOfSequence; } );
+
+  std::map<Int, TEncRoiMap*>::iterator it = m_maps.find( poc );
+  if ( it != m_maps.end() )
+  {
+    return it->second;
+  }
+
+  // the mask sequence ended before this picture: hold the last mask
+  TEncRoiMap *pcMap = new TEncRoiMap( m_lastMap );
+  pcMap->clearObjectUpdates();
+  m_maps[poc] = pcMap;
+  return pcMap;
+}
+
+Void TEncRoiMaskReader::releaseMap( Int poc )
+{
+  if ( !isSequence() )
+  {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock( m_mutex );
+    std::map<Int, TEncRoiMap*>::iterator it = m_maps.find( poc );
+    if ( it == m_maps.end() )
+    {
+      return;
+    }
+    delete it->second;
+    m_maps.erase( it );
+  }
+  m_spaceAvailable.notify_one();
+}
+
+/** Prefetch thread: decodes masks in POC order, staying at most m_prefetchDepth masks ahead of the encoder.
+ * The window must cover a whole GOP because the encoder consumes masks in coding order.
+ * The mask objects are tracked here as well, since the annotated regions SEI describes their changes in output order.
+ */
+Void TEncRoiMaskReader::xPrefetch()
+{
+  TEncRoiMap lastMap;
+  Bool       haveLastMap = false;
+
+  for ( Int poc = 0; poc < m_numPictures; poc++ )
+  {
+    if ( !hasMask( poc ) )
+    {
+      continue;
+    }
+    {
+      std::unique_lock<std::mutex> lock( m_mutex );
+      m_spaceAvailable.wait( lock, [&]{ return m_stop || (Int)m_maps.size() < m_prefetchDepth; } );
+      if ( m_stop )
+      {
+        return;
+      }
+    }
+
+    TEncRoiMap *pcMap = new TEncRoiMap;
+    pcMap->create( m_picWidth, m_picHeight, m_log2BlkSize );
+    if ( !xReadFrame( xGetMaskFrame( poc ), *pcMap ) )
+    {
+      delete pcMap;
+      std::cerr << "Warning: ROI mask sequence '" << m_fileName << "' ends before POC " << poc << ", holding the last mask" << std::endl;
+      break;
+    }
+    if ( haveLastMap )
+    {
+      pcMap->trackObjects( lastMap );
+    }
+    lastMap     = *pcMap;
+    haveLastMap = true;
+
+    {
+      std::lock_guard<std::mutex> lock( m_mutex );
+      m_maps[poc] = pcMap;
+      m_nextPoc   = poc + 1;
+    }
+    m_mapReady.notify_all();
+  }
+
+  {
+    std::lock_guard<std::mutex> lock( m_mutex );
+    if ( haveLastMap )
+    {
+      m_lastMap = lastMap;
+    }
+    m_endOfSequence = true;
+  }
+  m_mapReady.notify_all();
+}
+
+Bool TEncRoiMaskReader::xOpenFile()
+{
+  if ( m_format == ROI_MASK_FORMAT_IMAGE )
+  {
+    // numbered image series: check that the first image exists
+    FILE *fp = fopen( xGetImageName( xGetMaskFrame( 0 ) ).c_str(), "rb" );
+    if ( fp == NULL )
+    {
+      std::cerr << "Could not open the first ROI mask image '" << xGetImageName( xGetMaskFrame( 0 ) ) << "'" << std::endl;
+      return false;
+    }
+    fclose( fp );
+    return true;
+  }
+
+  m_file.open( m_fileName.c_str(), std::ios::binary | std::ios::in );
+  if ( !m_file.is_open() )
+  {
+    std::cerr << "Could not open the ROI mask file '" << m_fileName << "'" << std::endl;
+    return false;
+  }
+  m_fileFrameIdx = 0;
+
+  if ( m_format == ROI_MASK_FORMAT_Y4M )
+  {
+    return xReadY4MHeader();
+  }
+  if ( m_maskWidth <= 0 || m_maskHeight <= 0 )
+  {
+    std::cerr << "Invalid ROI mask frame size " << m_maskWidth << "x" << m_maskHeight << std::endl;
+    return false;
+  }
+  return true;
+}
+
+/** Parse the Y4M stream header. Only 8-bit streams are supported; chroma planes are skipped.
+ */
+Bool TEncRoiMaskReader::xReadY4MHeader()
+{
+  std::string header;
+  std::getline( m_file, header );
+  if ( !m_file.good() || header.compare( 0, 9, "YUV4MPEG2" ) != 0 )
+  {
+    std::cerr << "'" << m_fileName << "' is not a Y4M file" << std::endl;
+    return false;
+  }
+
+  std::string chroma = "420";
+  std::istringstream tokens( header.substr( 9 ) );
+  std::string token;
+  while ( tokens >> token )
+  {
+    switch ( token[0] )
+    {
+      case 'W': m_maskWidth  = atoi( token.c_str() + 1 ); break;
+      case 'H': m_maskHeight = atoi( token.c_str() + 1 ); break;
+      case 'C': chroma       = token.substr( 1 );         break;
+      default:                                            break;
+    }
+  }
+
+  const Int chromaWidth  = ( m_maskWidth  + 1 ) >> 1;
+  const Int chromaHeight = ( m_maskHeight + 1 ) >> 1;
+  if ( chroma == "mono" )
+  {
+    m_y4mChromaSize = 0;
+  }
+  else if ( chroma.compare( 0, 3, "420" ) == 0 && chroma.find( 'p' ) == std::string::npos )
+  {
+    m_y4mChromaSize = 2 * chromaWidth * chromaHeight;
+  }
+  else if ( chroma == "422" )
+  {
+    m_y4mChromaSize = 2 * chromaWidth * m_maskHeight;
+  }
+  else if ( chroma == "444" )
+  {
+    m_y4mChromaSize = 2 * m_maskWidth * m_maskHeight;
+  }
+  else
+  {
+    std::cerr << "Unsupported Y4M colour space 'C" << chroma << "' in ROI mask file, only 8-bit streams are supported" << std::endl;
+    return false;
+  }
+
+  if ( m_maskWidth <= 0 || m_maskHeight <= 0 )
+  {
+    std::cerr << "Invalid Y4M frame size in ROI mask file '" << m_fileName << "'" << std::endl;
+    return false;
+  }
+  m_y4mDataStart = m_file.tellg();
+  return true;
+}
+
+Bool TEncRoiMaskReader::xReadFrame( Int frameIdx, TEncRoiMap &map )
+{
+  switch ( m_format )
+  {
+    case ROI_MASK_FORMAT_IMAGE:
+      {
+        FILE *fp = fopen( xGetImageName( frameIdx ).c_str(), "rb" );
+        if ( fp == NULL )
+        {
+          return false;
+        }
+        fclose( fp );
+        return map.loadMask( xGetImageName( frameIdx ) );
+      }
+    case ROI_MASK_FORMAT_Y4M:
+      return xReadY4MFrame( frameIdx, map );
+    case ROI_MASK_FORMAT_YUV400:
+    case ROI_MASK_FORMAT_PACKED1BIT:
+      return xReadRawFrame( frameIdx, map );
+    default:
+      return false;
+  }
+}
+
+/** Read one frame of a raw 8-bit luma-only mask video, or of a packed mask with one bit per sample
+ * (rows padded to a whole byte, most significant bit first, 1 = foreground).
+ */
+Bool TEncRoiMaskReader::xReadRawFrame( Int frameIdx, TEncRoiMap &map )
+{
+  const Bool packed   = m_format == ROI_MASK_FORMAT_PACKED1BIT;
+  const Int  rowBytes = packed ? ( m_maskWidth + 7 ) >> 3 : m_maskWidth;
+  const std::streamoff frameBytes = std::streamoff( rowBytes ) * m_maskHeight;
+
+  m_file.clear();
+  m_file.seekg( frameBytes * frameIdx, std::ios::beg );
+  m_frameBuf.resize( std::size_t( m_maskWidth ) * m_maskHeight );
+
+  if ( !packed )
+  {
+    m_file.read( reinterpret_cast<TChar*>( &m_frameBuf[0] ), frameBytes );
+    if ( m_file.gcount() != frameBytes )
+    {
+      return false;
+    }
+  }
+  else
+  {
+    m_rowBuf.resize( rowBytes );
+    for ( Int y = 0; y < m_maskHeight; y++ )
+    {
+      m_file.read( reinterpret_cast<TChar*>( &m_rowBuf[0] ), rowBytes );
+      if ( m_file.gcount() != rowBytes )
+      {
+        return false;
+      }
+      UChar *pDst = &m_frameBuf[std::size_t( y ) * m_maskWidth];
+      for ( Int x = 0; x < m_maskWidth; x++ )
+      {
+        pDst[x] = ( m_rowBuf[x >> 3] >> ( 7 - ( x & 7 ) ) ) & 1 ? 255 : 0;
+      }
+    }
+  }
+
+  map.setMask( &m_frameBuf[0], m_maskWidth, m_maskHeight, m_maskWidth );
+  return true;
+}
+
+Bool TEncRoiMaskReader::xReadY4MFrame( Int frameIdx, TEncRoiMap &map )
+{
+  if ( frameIdx < m_fileFrameIdx )
+  {
+    m_file.clear();
+    m_file.seekg( m_y4mDataStart, std::ios::beg );
+    m_fileFrameIdx = 0;
+  }
+
+  const std::streamoff lumaSize = std::streamoff( m_maskWidth ) * m_maskHeight;
+  m_frameBuf.resize( std::size_t( lumaSize ) );
+
+  while ( m_fileFrameIdx <= frameIdx )
+  {
+    std::string frameHeader;
+    std::getline( m_file, frameHeader );
+    if ( !m_file.good() || frameHeader.compare( 0, 5, "FRAME" ) != 0 )
+    {
+      return false;
+    }
+    if ( m_fileFrameIdx < frameIdx )
+    {
+      m_file.seekg( lumaSize + m_y4mChromaSize, std::ios::cur );
+    }
+    else
+    {
+      m_file.read( reinterpret_cast<TChar*>( &m_frameBuf[0] ), lumaSize );
+      if ( m_file.gcount() != lumaSize )
+      {
+        return false;
+      }
+      m_file.seekg( m_y4mChromaSize, std::ios::cur );
+    }
+    m_fileFrameIdx++;
+  }
+
+  map.setMask( &m_frameBuf[0], m_maskWidth, m_maskHeight, m_maskWidth );
+  return true;
+}
+
+std::string TEncRoiMaskReader::xGetImageName( Int frameIdx ) const
+{
+  if ( !m_isPattern )
+  {
+    return m_fileName;
+  }
+  TChar name[s_maxFileNameLength];
+  snprintf( name, s_maxFileNameLength, m_fileName.c_str(), frameIdx );
+  return std::string( name );
+}
+
+//! \}
@@ -0,0 +1,143 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2022, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TEncRoiMaskReader.h
+    \brief    ROI mask sequence reader with asynchronous prefetch (header)
+*/
+
+#ifndef __TENCROIMASKREADER__
+#define __TENCROIMASKREADER__
+
+#include "TLibCommon/CommonDef.h"
+#include "TEncRoiMap.h"
+
+#include <condition_variable>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+//! \ingroup TLibEncoder
+//! \{
+
+// ====================================================================================================================
+// Class definition
+// ====================================================================================================================
+
+/// Provides one ROI map per picture, either from a single static mask or from a mask sequence decoded ahead of the encoder
+class TEncRoiMaskReader
+{
+public:
+  TEncRoiMaskReader();
+  virtual ~TEncRoiMaskReader();
+
+  /** open a mask source
+   * \param fileName      mask image, printf-style numbered image pattern, or mask video file
+   * \param format        mask format, ROI_MASK_FORMAT_AUTO derives it from the file name
+   * \param picWidth      picture width in luma samples (including padding)
+   * \param picHeight     picture height in luma samples (including padding)
+   * \param maskWidth     width of raw mask frames (YUV400 and packed 1-bit formats)
+   * \param maskHeight    height of raw mask frames (YUV400 and packed 1-bit formats)
+   * \param log2BlkSize   log2 of the ROI map block size
+   * \param firstFrame    index of the input frame belonging to POC 0
+   * \param frameStep     number of input frames per POC
+   * \param maskInterval  number of input frames per mask frame of a mask sequence
+   * \param numPictures   number of pictures to be encoded
+   * \param prefetchDepth maximum number of decoded masks held ahead of the encoder
+   * \returns false if the mask source cannot be opened
+   */
+  Bool  open            ( const std::string &fileName, RoiMaskFormat format, Int picWidth, Int picHeight, Int maskWidth, Int maskHeight,
+                          UInt log2BlkSize, Int firstFrame, Int frameStep, Int maskInterval, Int numPictures, Int prefetchDepth );
+  Void  close           ();
+
+  Bool  isOpen          () const { return m_isOpen; }
+  Bool  isSequence      () const { return m_format != ROI_MASK_FORMAT_IMAGE || m_isPattern; }
+  /// true if the mask sequence has a mask for the given POC, the first POC always has one
+  Bool  hasMask         ( Int poc ) const { return !isSequence() || poc == 0 || ( m_firstFrame + poc * m_frameStep ) % m_maskInterval == 0; }
+
+  /// mask of the given POC, blocks until the prefetch thread has decoded it
+  const TEncRoiMap* getMap    ( Int poc );
+  /// signal that the encoder no longer needs the mask of the given POC
+  Void              releaseMap( Int poc );
+
+private:
+  Void  xPrefetch       ();
+  Bool  xOpenFile       ();
+  Bool  xReadY4MHeader  ();
+  Bool  xReadFrame      ( Int frameIdx, TEncRoiMap &map );
+  Bool  xReadRawFrame   ( Int frameIdx, TEncRoiMap &map );
+  Bool  xReadY4MFrame   ( Int frameIdx, TEncRoiMap &map );
+  std::string xGetImageName( Int frameIdx ) const;
+  Int   xGetMaskFrame   ( Int poc ) const { return ( m_firstFrame + poc * m_frameStep ) / m_maskInterval; }
+
+  Bool                        m_isOpen;
+  Bool                        m_isPattern;
+  RoiMaskFormat               m_format;
+  std::string                 m_fileName;
+  Int                         m_picWidth;
+  Int                         m_picHeight;
+  Int                         m_maskWidth;
+  Int                         m_maskHeight;
+  UInt                        m_log2BlkSize;
+  Int                         m_firstFrame;
+  Int                         m_frameStep;
+  Int                         m_maskInterval;
+  Int                         m_numPictures;
+  Int                         m_prefetchDepth;
+
+  // mask file state, only accessed by the prefetch thread once it is running
+  std::ifstream               m_file;
+  std::streamoff              m_y4mDataStart;
+  Int                         m_y4mChromaSize;
+  Int                         m_fileFrameIdx;
+  std::vector<UChar>          m_frameBuf;
+  std::vector<UChar>          m_rowBuf;
+
+  TEncRoiMap                  m_staticMap;      ///< used when a single mask image is given
+  TEncRoiMap                  m_lastMap;        ///< last decoded mask, held for pictures beyond the end of the mask sequence
+
+  std::thread                 m_thread;
+  std::mutex                  m_mutex;
+  std::condition_variable     m_mapReady;
+  std::condition_variable     m_spaceAvailable;
+  std::map<Int, TEncRoiMap*>  m_maps;
+  Int                         m_nextPoc;
+  Bool                        m_endOfSequence;
+  Bool                        m_stop;
+};
+
+//! \}
+
+#endif // __TENCROIMASKREADER__
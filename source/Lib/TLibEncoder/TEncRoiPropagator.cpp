@@ -0,0 +1,368 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2022, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/** \file     TEncRoiPropagator.cpp
+    \brief    motion-compensated propagation of the ROI mask between mask frames
+*/
+
+#include "TEncRoiPropagator.h"
+
+#include <algorithm>
+
+//! \ingroup TLibEncoder
+//! \{
+
+const Int TEncRoiPropagator::s_blkSize[s_numLevels] = { 16, 8, 8 };   ///< block size per pyramid level, 16x16, 16x16 and 32x32 luma samples
+const Int TEncRoiPropagator::s_searchRange = 8;    ///< full search range at the coarsest level, +-32 luma samples
+const Int TEncRoiPropagator::s_refineRange = 2;    ///< refinement range at the finer levels
+const Int TEncRoiPropagator::s_mvCost      = 16;   ///< cost per sample of vector length, keeps flat areas at the zero vector
+
+TEncRoiPropagator::TEncRoiPropagator()
+: m_active      (false)
+, m_picWidth    (0)
+, m_picHeight   (0)
+, m_log2BlkSize (0)
+, m_dilation    (0)
+, m_haveLastMap (false)
+{
+  for ( Int level = 0; level < s_numLevels; level++ )
+  {
+    m_numBlksX[level] = 0;
+    m_numBlksY[level] = 0;
+  }
+}
+
+TEncRoiPropagator::~TEncRoiPropagator()
+{
+  destroy();
+}
+
+/** Allocate the propagation buffers
+ * \param picWidth    picture width in luma samples
+ * \param picHeight   picture height in luma samples
+ * \param dilation    margin in luma samples added around the propagated mask
+ */
+Void TEncRoiPropagator::create( Int picWidth, Int picHeight, Int dilation )
+{
+  m_picWidth    = picWidth;
+  m_picHeight   = picHeight;
+  m_dilation    = dilation;
+
+  Int width  = picWidth;
+  Int height = picHeight;
+  for ( Int level = 0; level < s_numLevels; level++ )
+  {
+    m_numBlksX[level] = ( width  + s_blkSize[level] - 1 ) / s_blkSize[level];
+    m_numBlksY[level] = ( height + s_blkSize[level] - 1 ) / s_blkSize[level];
+    m_mvs[level].assign( std::size_t( 2 * m_numBlksX[level] * m_numBlksY[level] ), 0 );
+    width  = ( width  + 1 ) >> 1;
+    height = ( height + 1 ) >> 1;
+  }
+  m_mask.assign       ( std::size_t( picWidth * picHeight ), 0 );
+  m_warpedMask.assign ( std::size_t( picWidth * picHeight ), 0 );
+  m_dilatedMask.assign( std::size_t( picWidth * picHeight ), 0 );
+  m_haveLastMap = false;
+  m_active      = true;
+}
+
+Void TEncRoiPropagator::destroy()
+{
+  for ( std::map<Int, TEncRoiMap*>::iterator it = m_maps.begin(); it != m_maps.end(); it++ )
+  {
+    delete it->second;
+  }
+  m_maps.clear();
+  for ( Int level = 0; level < s_numLevels; level++ )
+  {
+    m_mvs[level].clear();
+    m_refLuma.plane[level].clear();
+    m_curLuma.plane[level].clear();
+  }
+  m_mask.clear();
+  m_warpedMask.clear();
+  m_dilatedMask.clear();
+  m_lastMap.destroy();
+  m_haveLastMap = false;
+  m_active      = false;
+}
+
+/** The mask is rebuilt in luma samples from the block maxima of the map, which is the resolution the encoder uses. */
+Void TEncRoiPropagator::reset( Int poc, const TEncRoiMap &map, const TComPicYuv &orgPic )
+{
+  m_log2BlkSize = map.getLog2BlkSize();
+  for ( Int y = 0; y < m_picHeight; y++ )
+  {
+    const UChar *pBlkMax = map.getMaxLevelRow( y >> m_log2BlkSize );
+    UChar       *pMask   = &m_mask[y * m_picWidth];
+    for ( Int x = 0; x < m_picWidth; x++ )
+    {
+      pMask[x] = pBlkMax[x >> m_log2BlkSize];
+    }
+  }
+  xBuildPyramid( orgPic, m_refLuma );
+  xStoreMap( poc, new TEncRoiMap( map ) );
+}
+
+Void TEncRoiPropagator::propagate( Int poc, const TComPicYuv &orgPic )
+{
+  assert( m_haveLastMap );
+  xBuildPyramid( orgPic, m_curLuma );
+  for ( Int level = s_numLevels - 1; level >= 0; level-- )
+  {
+    xEstimateMotion( level );
+  }
+  xWarpMask();
+  xDilateMask();
+  std::swap( m_refLuma, m_curLuma );
+
+  TEncRoiMap *pcMap = new TEncRoiMap;
+  pcMap->create( m_picWidth, m_picHeight, m_log2BlkSize );
+  pcMap->setMask( &m_dilatedMask[0], m_picWidth, m_picHeight, m_picWidth );
+  xStoreMap( poc, pcMap );
+}
+
+const TEncRoiMap* TEncRoiPropagator::getMap( Int poc ) const
+{
+  std::map<Int, TEncRoiMap*>::const_iterator it = m_maps.find( poc );
+  return it != m_maps.end() ? it->second : NULL;
+}
+
+Void TEncRoiPropagator::releaseMap( Int poc )
+{
+  std::map<Int, TEncRoiMap*>::iterator it = m_maps.find( poc );
+  if ( it != m_maps.end() )
+  {
+    delete it->second;
+    m_maps.erase( it );
+  }
+}
+
+Void TEncRoiPropagator::xBuildPyramid( const TComPicYuv &orgPic, LumaPyramid &pyramid ) const
+{
+  const Pel *pOrg      = orgPic.getAddr( COMPONENT_Y );
+  const Int  orgStride = orgPic.getStride( COMPONENT_Y );
+  pyramid.width[0]  = std::min( m_picWidth,  orgPic.getWidth ( COMPONENT_Y ) );
+  pyramid.height[0] = std::min( m_picHeight, orgPic.getHeight( COMPONENT_Y ) );
+  pyramid.plane[0].resize( std::size_t( pyramid.width[0] * pyramid.height[0] ) );
+  for ( Int y = 0; y < pyramid.height[0]; y++ )
+  {
+    std::copy( pOrg + y * orgStride, pOrg + y * orgStride + pyramid.width[0], &pyramid.plane[0][y * pyramid.width[0]] );
+  }
+
+  for ( Int level = 1; level < s_numLevels; level++ )
+  {
+    const Int  srcWidth  = pyramid.width[level - 1];
+    const Int  srcHeight = pyramid.height[level - 1];
+    const Int  width     = ( srcWidth  + 1 ) >> 1;
+    const Int  height    = ( srcHeight + 1 ) >> 1;
+    pyramid.width[level]  = width;
+    pyramid.height[level] = height;
+    pyramid.plane[level].resize( std::size_t( width * height ) );
+    const Pel *pSrc = &pyramid.plane[level - 1][0];
+    Pel       *pDst = &pyramid.plane[level][0];
+    for ( Int y = 0; y < height; y++ )
+    {
+      const Pel *pLine0 = pSrc + ( 2 * y ) * srcWidth;
+      const Pel *pLine1 = pSrc + std::min( 2 * y + 1, srcHeight - 1 ) * srcWidth;
+      for ( Int x = 0; x < width; x++ )
+      {
+        const Int x1 = std::min( 2 * x + 1, srcWidth - 1 );
+        pDst[y * width + x] = ( pLine0[2 * x] + pLine0[x1] + pLine1[2 * x] + pLine1[x1] + 2 ) >> 2;
+      }
+    }
+  }
+}
+
+/** SAD of a block of the current picture against the displaced block of the previous picture plus the vector cost.
+ * Reference samples outside the picture are padded, the sum stops early once it exceeds bestCost.
+ */
+Int TEncRoiPropagator::xBlockCost( Int level, Int x, Int y, Int mvX, Int mvY, Int bestCost ) const
+{
+  const Int  width  = m_curLuma.width[level];
+  const Int  height = m_curLuma.height[level];
+  const Pel *pCur   = &m_curLuma.plane[level][0];
+  const Pel *pRef   = &m_refLuma.plane[level][0];
+  const Int  blkW   = std::min( s_blkSize[level], width  - x );
+  const Int  blkH   = std::min( s_blkSize[level], height - y );
+  Int cost = s_mvCost * ( abs( mvX ) + abs( mvY ) );
+  for ( Int j = 0; j < blkH && cost < bestCost; j++ )
+  {
+    const Pel *pCurLine = pCur + ( y + j ) * width + x;
+    const Pel *pRefLine = pRef + Clip3( 0, height - 1, y + j + mvY ) * width;
+    for ( Int i = 0; i < blkW; i++ )
+    {
+      cost += abs( pCurLine[i] - pRefLine[Clip3( 0, width - 1, x + i + mvX )] );
+    }
+  }
+  return cost;
+}
+
+/** Block motion search from the current picture towards the previous one at one pyramid level. The coarsest level is
+ * searched in full around the zero vector. The finer levels test the zero vector, the scaled vector of the coarser
+ * level and the vectors of the left and above blocks, and refine the best of them.
+ */
+Void TEncRoiPropagator::xEstimateMotion( Int level )
+{
+  std::vector<Int> &mvs    = m_mvs[level];
+  const Int         blkSize = s_blkSize[level];
+  for ( Int by = 0; by < m_numBlksY[level]; by++ )
+  {
+    for ( Int bx = 0; bx < m_numBlksX[level]; bx++ )
+    {
+      const Int x = bx * blkSize;
+      const Int y = by * blkSize;
+      Int centreX = 0, centreY = 0;
+      Int bestCost = xBlockCost( level, x, y, 0, 0, MAX_INT );
+      Int range    = s_searchRange;
+      if ( level + 1 < s_numLevels )
+      {
+        const Int parentBlkSize = 2 * s_blkSize[level + 1];
+        const Int parentIdx = std::min( y / parentBlkSize, m_numBlksY[level + 1] - 1 ) * m_numBlksX[level + 1] + std::min( x / parentBlkSize, m_numBlksX[level + 1] - 1 );
+        Int candidates[3][2] = { { 2 * m_mvs[level + 1][2 * parentIdx], 2 * m_mvs[level + 1][2 * parentIdx + 1] }, { 0, 0 }, { 0, 0 } };
+        Int numCandidates = 1;
+        if ( bx > 0 )
+        {
+          candidates[numCandidates][0] = mvs[2 * ( by * m_numBlksX[level] + bx - 1 )];
+          candidates[numCandidates][1] = mvs[2 * ( by * m_numBlksX[level] + bx - 1 ) + 1];
+          numCandidates++;
+        }
+        if ( by > 0 )
+        {
+          candidates[numCandidates][0] = mvs[2 * ( ( by - 1 ) * m_numBlksX[level] + bx )];
+          candidates[numCandidates][1] = mvs[2 * ( ( by - 1 ) * m_numBlksX[level] + bx ) + 1];
+          numCandidates++;
+        }
+        for ( Int c = 0; c < numCandidates; c++ )
+        {
+          const Int cost = xBlockCost( level, x, y, candidates[c][0], candidates[c][1], bestCost );
+          if ( cost < bestCost )
+          {
+            bestCost = cost;
+            centreX  = candidates[c][0];
+            centreY  = candidates[c][1];
+          }
+        }
+        range = s_refineRange;
+      }
+
+      Int bestX = centreX, bestY = centreY;
+      for ( Int dy = centreY - range; dy <= centreY + range; dy++ )
+      {
+        for ( Int dx = centreX - range; dx <= centreX + range; dx++ )
+        {
+          const Int cost = xBlockCost( level, x, y, dx, dy, bestCost );
+          if ( cost < bestCost )
+          {
+            bestCost = cost;
+            bestX    = dx;
+            bestY    = dy;
+          }
+        }
+      }
+      const Int idx = by * m_numBlksX[level] + bx;
+      mvs[2 * idx]     = bestX;
+      mvs[2 * idx + 1] = bestY;
+    }
+  }
+}
+
+/// backward warping: every sample of the current picture takes the mask sample its block vector points to
+Void TEncRoiPropagator::xWarpMask()
+{
+  const std::vector<Int> &mvs = m_mvs[0];
+  for ( Int y = 0; y < m_picHeight; y++ )
+  {
+    const Int by = std::min( y / s_blkSize[0], m_numBlksY[0] - 1 );
+    UChar *pDst = &m_warpedMask[y * m_picWidth];
+    for ( Int x = 0; x < m_picWidth; x++ )
+    {
+      const Int idx  = by * m_numBlksX[0] + std::min( x / s_blkSize[0], m_numBlksX[0] - 1 );
+      const Int srcX = Clip3( 0, m_picWidth  - 1, x + mvs[2 * idx]     );
+      const Int srcY = Clip3( 0, m_picHeight - 1, y + mvs[2 * idx + 1] );
+      pDst[x] = m_mask[srcY * m_picWidth + srcX];
+    }
+  }
+  std::swap( m_mask, m_warpedMask );
+}
+
+/// separable maximum filter over a square of +-m_dilation samples
+Void TEncRoiPropagator::xDilateMask()
+{
+  if ( m_dilation <= 0 )
+  {
+    m_dilatedMask = m_mask;
+    return;
+  }
+  for ( Int y = 0; y < m_picHeight; y++ )
+  {
+    const UChar *pSrc = &m_mask[y * m_picWidth];
+    UChar       *pDst = &m_warpedMask[y * m_picWidth];
+    for ( Int x = 0; x < m_picWidth; x++ )
+    {
+      const Int x0 = std::max( 0, x - m_dilation );
+      const Int x1 = std::min( m_picWidth - 1, x + m_dilation );
+      pDst[x] = *std::max_element( pSrc + x0, pSrc + x1 + 1 );
+    }
+  }
+  for ( Int y = 0; y < m_picHeight; y++ )
+  {
+    const Int y0 = std::max( 0, y - m_dilation );
+    const Int y1 = std::min( m_picHeight - 1, y + m_dilation );
+    UChar *pDst = &m_dilatedMask[y * m_picWidth];
+    std::copy( &m_warpedMask[y0 * m_picWidth], &m_warpedMask[y0 * m_picWidth] + m_picWidth, pDst );
+    for ( Int j = y0 + 1; j <= y1; j++ )
+    {
+      const UChar *pSrc = &m_warpedMask[j * m_picWidth];
+      for ( Int x = 0; x < m_picWidth; x++ )
+      {
+        pDst[x] = std::max( pDst[x], pSrc[x] );
+      }
+    }
+  }
+}
+
+/// track the objects against the previous picture in output order and hand the map over to the encoder
+Void TEncRoiPropagator::xStoreMap( Int poc, TEncRoiMap *pcMap )
+{
+  if ( m_haveLastMap )
+  {
+    pcMap->trackObjects( m_lastMap );
+  }
+  m_lastMap     = *pcMap;
+  m_haveLastMap = true;
+  releaseMap( poc );
+  m_maps[poc] = pcMap;
+}
+
+//! \}
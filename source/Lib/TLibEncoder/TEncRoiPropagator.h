@@ -0,0 +1,125 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2022, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/** \file     TEncRoiPropagator.h
+    \brief    motion-compensated propagation of the ROI mask between mask frames (header)
+*/
+
+#ifndef __TENCROIPROPAGATOR__
+#define __TENCROIPROPAGATOR__
+
+#include "TLibCommon/CommonDef.h"
+#include "TLibCommon/TComPicYuv.h"
+#include "TEncRoiMap.h"
+
+#include <map>
+#include <vector>
+
+//! \ingroup TLibEncoder
+//! \{
+
+// ====================================================================================================================
+// Class definition
+// ====================================================================================================================
+
+/// Carries the last ROI mask forward through the pictures without a mask, following the motion of the original pictures
+class TEncRoiPropagator
+{
+public:
+  TEncRoiPropagator();
+  virtual ~TEncRoiPropagator();
+
+  Void  create          ( Int picWidth, Int picHeight, Int dilation );
+  Void  destroy         ();
+  Bool  isActive        () const { return m_active; }
+
+  /** start again from a fresh mask, pictures must be given in output order
+   * \param poc    POC of the picture the mask belongs to
+   * \param map    decoded mask of the picture
+   * \param orgPic original picture
+   */
+  Void  reset           ( Int poc, const TEncRoiMap &map, const TComPicYuv &orgPic );
+  /// warp the mask of the previous picture in output order to this picture and widen it by the dilation margin
+  Void  propagate       ( Int poc, const TComPicYuv &orgPic );
+
+  /// mask of the given POC, NULL if it has not been produced
+  const TEncRoiMap* getMap    ( Int poc ) const;
+  /// signal that the encoder no longer needs the mask of the given POC
+  Void              releaseMap( Int poc );
+
+private:
+  static const Int    s_numLevels = 3;
+
+  /// luma of one picture at full resolution and subsampled by 2 and 4, for the block motion search
+  struct LumaPyramid
+  {
+    Int               width[s_numLevels];
+    Int               height[s_numLevels];
+    std::vector<Pel>  plane[s_numLevels];
+  };
+
+  Void  xBuildPyramid   ( const TComPicYuv &orgPic, LumaPyramid &pyramid ) const;
+  Int   xBlockCost      ( Int level, Int x, Int y, Int mvX, Int mvY, Int bestCost ) const;
+  Void  xEstimateMotion ( Int level );
+  Void  xWarpMask       ();
+  Void  xDilateMask     ();
+  Void  xStoreMap       ( Int poc, TEncRoiMap *pcMap );
+
+  static const Int    s_blkSize[s_numLevels];
+  static const Int    s_searchRange;
+  static const Int    s_refineRange;
+  static const Int    s_mvCost;
+
+  Bool                m_active;
+  Int                 m_picWidth;
+  Int                 m_picHeight;
+  UInt                m_log2BlkSize;
+  Int                 m_dilation;
+
+  LumaPyramid         m_refLuma;          ///< previous picture in output order
+  LumaPyramid         m_curLuma;
+  std::vector<Int>    m_mvs[s_numLevels]; ///< motion of each block of the current picture towards the previous one, per pyramid level
+  Int                 m_numBlksX[s_numLevels];
+  Int                 m_numBlksY[s_numLevels];
+  std::vector<UChar>  m_mask;             ///< propagated mask in luma samples, without the dilation margin
+  std::vector<UChar>  m_warpedMask;
+  std::vector<UChar>  m_dilatedMask;
+  TEncRoiMap          m_lastMap;          ///< map of the previous picture in output order, for the object tracking
+  Bool                m_haveLastMap;
+  std::map<Int, TEncRoiMap*> m_maps;
+};
+
+//! \}
+
+#endif // __TENCROIPROPAGATOR__
@@ -64,6 +64,8 @@ TEncSampleAdaptiveOffset::TEncSampleAdaptiveOffset()
   m_pppcBinCoderCABAC = NULL;
   m_statData = NULL;
   m_preDBFstatData = NULL;
+  m_reconParams = NULL;
+  m_totalCost = 0;
 }
 
 TEncSampleAdaptiveOffset::~TEncSampleAdaptiveOffset()
@@ -225,6 +227,7 @@ Void TEncSampleAdaptiveOffset::destroyEncData()
     }
     delete[] m_preDBFstatData; m_preDBFstatData = NULL;
   }
+  delete[] m_reconParams; m_reconParams = NULL;
 }
 
 Void TEncSampleAdaptiveOffset::initRDOCabacCoder(TEncSbac* pcRDGoOnSbacCoder, TComSlice* pcSlice)
@@ -248,28 +251,103 @@ Void TEncSampleAdaptiveOffset::SAOProcess(TComPic* pPic, Bool* sliceEnabled, con
   srcYuv->extendPicBorder();
 
   //collect statistics
-  getStatistics(m_statData, orgYuv, srcYuv, pPic);
+  getStatistics(m_statData, orgYuv, srcYuv, pPic, 0, m_numCTUsPic);
   if(isPreDBFSamplesUsed)
   {
-    addPreDBFStatistics(m_statData);
+    addPreDBFStatistics(m_statData, 0, m_numCTUsPic);
   }
 
   //slice on/off
   decidePicParams(sliceEnabled, pPic, saoEncodingRate, saoEncodingRateChroma);
   //block on/off
   SAOBlkParam* reconParams = new SAOBlkParam[m_numCTUsPic]; //temporary parameter buffer for storing reconstructed SAO parameters
-  decideBlkParams(pPic, sliceEnabled, m_statData, srcYuv, resYuv, reconParams, pPic->getPicSym()->getSAOBlkParam(), bTestSAODisableAtPictureLevel, saoEncodingRate, saoEncodingRateChroma);
+  m_pcRDGoOnSbacCoder->load(m_pppcRDSbacCoder[ SAO_CABACSTATE_PIC_INIT ]);
+  m_totalCost = 0;
+  decideBlkParams(pPic, sliceEnabled, m_statData, srcYuv, resYuv, reconParams, pPic->getPicSym()->getSAOBlkParam(), 0, m_numCTUsPic);
+  finishBlkParams(pPic, sliceEnabled, reconParams, pPic->getPicSym()->getSAOBlkParam(), bTestSAODisableAtPictureLevel, saoEncodingRate, saoEncodingRateChroma);
   delete[] reconParams;
 }
 
 Void TEncSampleAdaptiveOffset::getPreDBFStatistics(TComPic* pPic)
 {
-  getStatistics(m_preDBFstatData, pPic->getPicYuvOrg(), pPic->getPicYuvRec(), pPic, true);
+  getStatistics(m_preDBFstatData, pPic->getPicYuvOrg(), pPic->getPicYuvRec(), pPic, 0, m_numCTUsPic, true);
 }
 
-Void TEncSampleAdaptiveOffset::addPreDBFStatistics(SAOStatData*** blkStats)
+/** Start the SAO of a picture whose CTU rows are decided one at a time, as SAOProcess() does for the whole picture.
+ * The decision of a CTU row needs the deblocked samples of the CTU rows above and below it, which are taken over with
+ * SAOCopyCtuRow() once their deblocking is finished.
+ * \param pPic                   picture
+ * \param sliceEnabled           returns the slice-level on/off flags of the components
+ * \param lambdas                lambdas of the components
+ * \param saoEncodingRate        SAO encoding rate of luma
+ * \param saoEncodingRateChroma  SAO encoding rate of chroma
+ */
+Void TEncSampleAdaptiveOffset::SAOStartPicture(TComPic* pPic, Bool* sliceEnabled, const Double *lambdas, const Double saoEncodingRate, const Double saoEncodingRateChroma)
 {
-  for(Int n=0; n< m_numCTUsPic; n++)
+  memcpy(m_lambda, lambdas, sizeof(m_lambda));
+
+  //slice on/off
+  decidePicParams(sliceEnabled, pPic, saoEncodingRate, saoEncodingRateChroma);
+  for(Int compIdx = 0; compIdx < MAX_NUM_COMPONENT; compIdx++)
+  {
+    m_picSAOEnabled[compIdx] = sliceEnabled[compIdx];
+  }
+
+  delete[] m_reconParams;
+  m_reconParams = new SAOBlkParam[m_numCTUsPic];
+  m_pcRDGoOnSbacCoder->load(m_pppcRDSbacCoder[ SAO_CABACSTATE_PIC_INIT ]);
+  m_totalCost = 0;
+}
+
+/** Collect the statistics of the non-deblocked samples of a CTU row, as getPreDBFStatistics() does for the whole picture.
+ * \param pPic    picture, of which the CTU row and the rows above and below it are not deblocked yet
+ * \param ctuRow  CTU row
+ */
+Void TEncSampleAdaptiveOffset::getPreDBFStatisticsCtuRow(TComPic* pPic, Int ctuRow)
+{
+  const Int firstCtuRsAddr = ctuRow*m_numCTUInWidth;
+  getStatistics(m_preDBFstatData, pPic->getPicYuvOrg(), pPic->getPicYuvRec(), pPic, firstCtuRsAddr, firstCtuRsAddr + m_numCTUInWidth, true);
+}
+
+/** Decide the SAO parameters of a CTU row and apply them to the reconstruction.
+ * \param pPic                 picture
+ * \param sliceEnabled         slice-level on/off flags of the components
+ * \param ctuRow               CTU row, SAOCopyCtuRow() must have been called for it and the CTU rows above and below it
+ * \param isPreDBFSamplesUsed  add the statistics of the non-deblocked samples
+ */
+Void TEncSampleAdaptiveOffset::SAODecideCtuRow(TComPic* pPic, Bool* sliceEnabled, Int ctuRow, const Bool isPreDBFSamplesUsed)
+{
+  const Int firstCtuRsAddr = ctuRow*m_numCTUInWidth;
+  const Int endCtuRsAddr   = firstCtuRsAddr + m_numCTUInWidth;
+
+  if (!xIsAllDisabled())
+  {
+    getStatistics(m_statData, pPic->getPicYuvOrg(), m_tempPicYuv, pPic, firstCtuRsAddr, endCtuRsAddr);
+    if(isPreDBFSamplesUsed)
+    {
+      addPreDBFStatistics(m_statData, firstCtuRsAddr, endCtuRsAddr);
+    }
+  }
+  decideBlkParams(pPic, sliceEnabled, m_statData, m_tempPicYuv, pPic->getPicYuvRec(), m_reconParams, pPic->getPicSym()->getSAOBlkParam(), firstCtuRsAddr, endCtuRsAddr);
+}
+
+/** Finish the SAO of a picture whose CTU rows have all been decided.
+ * \param pPic                           picture
+ * \param sliceEnabled                   slice-level on/off flags of the components, cleared if SAO is disabled for the picture
+ * \param bTestSAODisableAtPictureLevel  disable SAO for the picture if it does not reduce the cost
+ * \param saoEncodingRate                SAO encoding rate of luma
+ * \param saoEncodingRateChroma          SAO encoding rate of chroma
+ */
+Void TEncSampleAdaptiveOffset::SAOFinishPicture(TComPic* pPic, Bool* sliceEnabled, const Bool bTestSAODisableAtPictureLevel, const Double saoEncodingRate, const Double saoEncodingRateChroma)
+{
+  finishBlkParams(pPic, sliceEnabled, m_reconParams, pPic->getPicSym()->getSAOBlkParam(), bTestSAODisableAtPictureLevel, saoEncodingRate, saoEncodingRateChroma);
+  delete[] m_reconParams;
+  m_reconParams = NULL;
+}
+
+Void TEncSampleAdaptiveOffset::addPreDBFStatistics(SAOStatData*** blkStats, Int firstCtuRsAddr, Int endCtuRsAddr)
+{
+  for(Int n=firstCtuRsAddr; n< endCtuRsAddr; n++)
   {
     for(Int compIdx=0; compIdx < MAX_NUM_COMPONENT; compIdx++)
     {
@@ -281,13 +359,13 @@ Void TEncSampleAdaptiveOffset::addPreDBFStatistics(SAOStatData*** blkStats)
   }
 }
 
-Void TEncSampleAdaptiveOffset::getStatistics(SAOStatData*** blkStats, TComPicYuv* orgYuv, TComPicYuv* srcYuv, TComPic* pPic, Bool isCalculatePreDeblockSamples)
+Void TEncSampleAdaptiveOffset::getStatistics(SAOStatData*** blkStats, TComPicYuv* orgYuv, TComPicYuv* srcYuv, TComPic* pPic, Int firstCtuRsAddr, Int endCtuRsAddr, Bool isCalculatePreDeblockSamples)
 {
   Bool isLeftAvail,isRightAvail,isAboveAvail,isBelowAvail,isAboveLeftAvail,isAboveRightAvail,isBelowLeftAvail,isBelowRightAvail;
 
   const Int numberOfComponents = getNumberValidComponents(m_chromaFormatIDC);
 
-  for(Int ctuRsAddr= 0; ctuRsAddr < m_numCTUsPic; ctuRsAddr++)
+  for(Int ctuRsAddr= firstCtuRsAddr; ctuRsAddr < endCtuRsAddr; ctuRsAddr++)
   {
     Int yPos   = (ctuRsAddr / m_numCTUInWidth)*m_maxCUHeight;
     Int xPos   = (ctuRsAddr % m_numCTUInWidth)*m_maxCUWidth;
@@ -772,9 +850,12 @@ Void TEncSampleAdaptiveOffset::deriveModeMergeRDO(const BitDepths &bitDepths, In
   m_pcRDGoOnSbacCoder->load(cabacCoderRDO[SAO_CABACSTATE_BLK_TEMP]);
 }
 
+/** Decide the SAO parameters of a range of CTUs in raster scan order and apply them to the reconstruction. The ranges of
+ * a picture are decided in order, starting with the RD SBAC coder in the SAO_CABACSTATE_PIC_INIT state and m_totalCost
+ * cleared, and are followed by finishBlkParams().
+ */
 Void TEncSampleAdaptiveOffset::decideBlkParams(TComPic* pic, Bool* sliceEnabled, SAOStatData*** blkStats, TComPicYuv* srcYuv, TComPicYuv* resYuv,
-                                               SAOBlkParam* reconParams, SAOBlkParam* codedParams, const Bool bTestSAODisableAtPictureLevel,
-                                               const Double saoEncodingRate, const Double saoEncodingRateChroma)
+                                               SAOBlkParam* reconParams, SAOBlkParam* codedParams, Int firstCtuRsAddr, Int endCtuRsAddr)
 {
   Bool allBlksDisabled = true;
   const Int numberOfComponents = getNumberValidComponents(m_chromaFormatIDC);
@@ -786,15 +867,10 @@ Void TEncSampleAdaptiveOffset::decideBlkParams(TComPic* pic, Bool* sliceEnabled,
     }
   }
 
-  m_pcRDGoOnSbacCoder->load(m_pppcRDSbacCoder[ SAO_CABACSTATE_PIC_INIT ]);
-
   SAOBlkParam modeParam;
   Double minCost, modeCost;
 
-
-  Double totalCost = 0; // Used if bTestSAODisableAtPictureLevel==true
-
-  for(Int ctuRsAddr=0; ctuRsAddr< m_numCTUsPic; ctuRsAddr++)
+  for(Int ctuRsAddr=firstCtuRsAddr; ctuRsAddr< endCtuRsAddr; ctuRsAddr++)
   {
     if(allBlksDisabled)
     {
@@ -845,7 +921,7 @@ Void TEncSampleAdaptiveOffset::decideBlkParams(TComPic* pic, Bool* sliceEnabled,
       }
     } //mode
 
-    totalCost += minCost;
+    m_totalCost += minCost;
 
     m_pcRDGoOnSbacCoder->load(m_pppcRDSbacCoder[ SAO_CABACSTATE_BLK_NEXT ]);
 
@@ -854,8 +930,24 @@ Void TEncSampleAdaptiveOffset::decideBlkParams(TComPic* pic, Bool* sliceEnabled,
     reconstructBlkSAOParam(reconParams[ctuRsAddr], mergeList);
     offsetCTU(ctuRsAddr, srcYuv, resYuv, reconParams[ctuRsAddr], pic);
   } //ctuRsAddr
+}
+
+/** Picture-level part of the block decisions, once all CTUs of the picture are decided with decideBlkParams().
+ */
+Void TEncSampleAdaptiveOffset::finishBlkParams(TComPic* pic, Bool* sliceEnabled, SAOBlkParam* reconParams, SAOBlkParam* codedParams,
+                                               const Bool bTestSAODisableAtPictureLevel, const Double saoEncodingRate, const Double saoEncodingRateChroma)
+{
+  Bool allBlksDisabled = true;
+  const Int numberOfComponents = getNumberValidComponents(m_chromaFormatIDC);
+  for(Int compId = COMPONENT_Y; compId < numberOfComponents; compId++)
+  {
+    if (sliceEnabled[compId])
+    {
+      allBlksDisabled = false;
+    }
+  }
 
-  if (!allBlksDisabled && (totalCost >= 0) && bTestSAODisableAtPictureLevel) //SAO has not beneficial in this case - disable it
+  if (!allBlksDisabled && (m_totalCost >= 0) && bTestSAODisableAtPictureLevel) //SAO has not beneficial in this case - disable it
   {
     for(Int ctuRsAddr = 0; ctuRsAddr < m_numCTUsPic; ctuRsAddr++)
     {
@@ -106,10 +106,17 @@ public:
   Void SAOProcess(TComPic* pPic, Bool* sliceEnabled, const Double *lambdas, const Bool bTestSAODisableAtPictureLevel, const Double saoEncodingRate, const Double saoEncodingRateChroma, const Bool isPreDBFSamplesUsed);
 public: //methods
   Void getPreDBFStatistics(TComPic* pPic);
+
+  // CTU-row based SAO, for pictures whose CTU rows are filtered while the rows below are still being compressed
+  Void SAOStartPicture(TComPic* pPic, Bool* sliceEnabled, const Double *lambdas, const Double saoEncodingRate, const Double saoEncodingRateChroma);
+  Void getPreDBFStatisticsCtuRow(TComPic* pPic, Int ctuRow);
+  Void SAODecideCtuRow(TComPic* pPic, Bool* sliceEnabled, Int ctuRow, const Bool isPreDBFSamplesUsed);
+  Void SAOFinishPicture(TComPic* pPic, Bool* sliceEnabled, const Bool bTestSAODisableAtPictureLevel, const Double saoEncodingRate, const Double saoEncodingRateChroma);
 private: //methods
-  Void getStatistics(SAOStatData*** blkStats, TComPicYuv* orgYuv, TComPicYuv* srcYuv,TComPic* pPic, Bool isCalculatePreDeblockSamples = false);
+  Void getStatistics(SAOStatData*** blkStats, TComPicYuv* orgYuv, TComPicYuv* srcYuv,TComPic* pPic, Int firstCtuRsAddr, Int endCtuRsAddr, Bool isCalculatePreDeblockSamples = false);
   Void decidePicParams(Bool* sliceEnabled, const TComPic* pic, const Double saoEncodingRate, const Double saoEncodingRateChroma);
-  Void decideBlkParams(TComPic* pic, Bool* sliceEnabled, SAOStatData*** blkStats, TComPicYuv* srcYuv, TComPicYuv* resYuv, SAOBlkParam* reconParams, SAOBlkParam* codedParams, const Bool bTestSAODisableAtPictureLevel, const Double saoEncodingRate, const Double saoEncodingRateChroma);
+  Void decideBlkParams(TComPic* pic, Bool* sliceEnabled, SAOStatData*** blkStats, TComPicYuv* srcYuv, TComPicYuv* resYuv, SAOBlkParam* reconParams, SAOBlkParam* codedParams, Int firstCtuRsAddr, Int endCtuRsAddr);
+  Void finishBlkParams(TComPic* pic, Bool* sliceEnabled, SAOBlkParam* reconParams, SAOBlkParam* codedParams, const Bool bTestSAODisableAtPictureLevel, const Double saoEncodingRate, const Double saoEncodingRateChroma);
   Void getBlkStats(const ComponentID compIdx, const Int channelBitDepth, SAOStatData* statsDataTypes, Pel* srcBlk, Pel* orgBlk, Int srcStride, Int orgStride, Int width, Int height, Bool isLeftAvail,  Bool isRightAvail, Bool isAboveAvail, Bool isBelowAvail, Bool isAboveLeftAvail, Bool isAboveRightAvail, Bool isCalculatePreDeblockSamples);
   Void deriveModeNewRDO(const BitDepths &bitDepths, Int ctuRsAddr, SAOBlkParam* mergeList[NUM_SAO_MERGE_TYPES], Bool* sliceEnabled, SAOStatData*** blkStats, SAOBlkParam& modeParam, Double& modeNormCost, TEncSbac** cabacCoderRDO, Int inCabacLabel);
   Void deriveModeMergeRDO(const BitDepths &bitDepths, Int ctuRsAddr, SAOBlkParam* mergeList[NUM_SAO_MERGE_TYPES], Bool* sliceEnabled, SAOStatData*** blkStats, SAOBlkParam& modeParam, Double& modeNormCost, TEncSbac** cabacCoderRDO, Int inCabacLabel);
@@ -117,7 +124,7 @@ private: //methods
   Void deriveOffsets(ComponentID compIdx, const Int channelBitDepth, Int typeIdc, SAOStatData& statData, Int* quantOffsets, Int& typeAuxInfo);
   inline Int64 estSaoDist(Int64 count, Int64 offset, Int64 diffSum, Int shift);
   inline Int estIterOffset(Int typeIdx, Double lambda, Int offsetInput, Int64 count, Int64 diffSum, Int shift, Int bitIncrease, Int64& bestDist, Double& bestCost, Int offsetTh );
-  Void addPreDBFStatistics(SAOStatData*** blkStats);
+  Void addPreDBFStatistics(SAOStatData*** blkStats, Int firstCtuRsAddr, Int endCtuRsAddr);
 private: //members
   //for RDO
   TEncSbac**             m_pppcRDSbacCoder;
@@ -135,6 +142,10 @@ private: //members
   Double                 m_saoDisabledRate[MAX_NUM_COMPONENT][MAX_TLAYER];
   Int                    m_skipLinesR[MAX_NUM_COMPONENT][NUM_SAO_NEW_TYPES];
   Int                    m_skipLinesB[MAX_NUM_COMPONENT][NUM_SAO_NEW_TYPES];
+
+  //block decisions
+  SAOBlkParam*           m_reconParams;   //reconstructed parameters of the picture being decided
+  Double                 m_totalCost;     //cost of the decided blocks, used if bTestSAODisableAtPictureLevel==true
 };
 
 
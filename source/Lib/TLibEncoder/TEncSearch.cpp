@@ -39,6 +39,7 @@
 #include "TLibCommon/TComRom.h"
 #include "TLibCommon/TComMotionInfo.h"
 #include "TEncSearch.h"
+#include "TEncPic.h"
 #include "TLibCommon/TComTU.h"
 #include "TLibCommon/Debug.h"
 #include <math.h>
@@ -107,6 +108,7 @@ static Void offsetSubTUCBFs(TComTU &rTu, const ComponentID compID)
 TEncSearch::TEncSearch()
 : m_puhQTTempTrIdx(NULL)
 , m_pcQTTempTComYuv(NULL)
+, m_pIntraModePred(NULL)
 , m_pcEncCfg (NULL)
 , m_pcTrQuant (NULL)
 , m_pcRdCost (NULL)
@@ -185,6 +187,7 @@ Void TEncSearch::destroy()
 
   delete[] m_puhQTTempTrIdx;
   delete[] m_pcQTTempTComYuv;
+  delete[] m_pIntraModePred;
 
   for (UInt ch=0; ch<MAX_NUM_COMPONENT; ch++)
   {
@@ -297,6 +300,7 @@ Void TEncSearch::init(TEncCfg*       pcEncCfg,
     m_puhQTTempTransformSkipFlag[ch]               = new UChar [uiNumPartitions];
   }
   m_puhQTTempTrIdx   = new UChar  [uiNumPartitions];
+  m_pIntraModePred   = new Pel    [(NUM_INTRA_MODE-1)*MAX_CU_SIZE*MAX_CU_SIZE];
   m_pcQTTempTComYuv  = new TComYuv[uiNumLayersToAllocate];
   for( UInt ui = 0; ui < uiNumLayersToAllocate; ++ui )
   {
@@ -307,6 +311,17 @@ Void TEncSearch::init(TEncCfg*       pcEncCfg,
   m_isInitialized = true;
 }
 
+Void TEncSearch::resetIntegerMv2Nx2N()
+{
+  for (UInt refList = 0; refList < NUM_REF_PIC_LIST_01; refList++)
+  {
+    for (UInt refIdx = 0; refIdx < MAX_NUM_REF; refIdx++)
+    {
+      m_integerMv2Nx2N[refList][refIdx].setZero();
+    }
+  }
+}
+
 
 __inline Void TEncSearch::xTZSearchHelp( const TComPattern* const pcPatternKey, IntTZSearchStruct& rcStruct, const Int iSearchX, const Int iSearchY, const UChar ucPointNr, const UInt uiDistance )
 {
@@ -2267,6 +2282,14 @@ TEncSearch::estIntraPredLumaQT(TComDataCU* pcCU,
     Int numModesAvailable     = 35; //total number of Intra modes
     UInt uiRdModeList[FAST_UDI_MAX_RDMODE_NUM];
     Int numModesForFullRD = m_pcEncCfg->getFastUDIUseMPMEnabled()?g_aucIntraModeNumFast_UseMPM[ uiWidthBit ] : g_aucIntraModeNumFast_NotUseMPM[ uiWidthBit ];
+    // PUs of CUs entirely outside the ROI mask only give the best few SATD candidates a full RD check
+    const TEncPic* pcEPic = dynamic_cast<const TEncPic*>(pcCU->getPic());
+    const Bool bRoiBackground = m_pcEncCfg->getRoiBackgroundFastDecision() && pcEPic != NULL &&
+                                pcEPic->isRoiBackground(pcCU->getCUPelX(), pcCU->getCUPelY(), pcCU->getWidth(0), pcCU->getHeight(0));
+    if (bRoiBackground)
+    {
+      numModesForFullRD = std::min(numModesForFullRD, m_pcEncCfg->getRoiBackgroundIntraModes());
+    }
 
     // this should always be true
     assert (tuRecurseWithPU.ProcessComponentSection(COMPONENT_Y));
@@ -2287,20 +2310,35 @@ TEncSearch::estIntraPredLumaQT(TComDataCU* pcCU,
       const UInt uiAbsPartIdx=tuRecurseWithPU.GetAbsPartIdxTU();
 
       Pel* piOrg         = pcOrgYuv ->getAddr( COMPONENT_Y, uiAbsPartIdx );
-      Pel* piPred        = pcPredYuv->getAddr( COMPONENT_Y, uiAbsPartIdx );
       UInt uiStride      = pcPredYuv->getStride( COMPONENT_Y );
+
+      // predict all the modes in one go, from reference samples loaded once
+      UInt uiModes[NUM_INTRA_MODE-1];
+      Pel* piModePred[NUM_INTRA_MODE-1];
+      const UInt uiModePredStride = puRect.width;
+      for( Int modeIdx = 0; modeIdx < numModesAvailable; modeIdx++ )
+      {
+        uiModes[modeIdx]    = modeIdx;
+        piModePred[modeIdx] = m_pIntraModePred + modeIdx * puRect.width * puRect.height;
+      }
+      predIntraAngModes( COMPONENT_Y, uiModes, numModesAvailable, piModePred, uiModePredStride, tuRecurseWithPU );
+
       DistParam distParam;
       const Bool bUseHadamard=pcCU->getCUTransquantBypass(0) == 0;
-      m_pcRdCost->setDistParam(distParam, sps.getBitDepth(CHANNEL_TYPE_LUMA), piOrg, uiStride, piPred, uiStride, puRect.width, puRect.height, bUseHadamard);
+      m_pcRdCost->setDistParam(distParam, sps.getBitDepth(CHANNEL_TYPE_LUMA), piOrg, uiStride, piModePred[0], uiModePredStride, puRect.width, puRect.height, bUseHadamard);
       distParam.bApplyWeight = false;
       for( Int modeIdx = 0; modeIdx < numModesAvailable; modeIdx++ )
       {
         UInt       uiMode = modeIdx;
         Distortion uiSad  = 0;
 
-        const Bool bUseFilter=TComPrediction::filteringIntraReferenceSamples(COMPONENT_Y, uiMode, puRect.width, puRect.height, chFmt, sps.getSpsRangeExtension().getIntraSmoothingDisabledFlag());
+        if (TComPrediction::UseDPCMForFirstPassIntraEstimation(tuRecurseWithPU, uiMode))
+        {
+          const Bool bUseFilter=TComPrediction::filteringIntraReferenceSamples(COMPONENT_Y, uiMode, puRect.width, puRect.height, chFmt, sps.getSpsRangeExtension().getIntraSmoothingDisabledFlag());
 
-        predIntraAng( COMPONENT_Y, uiMode, piOrg, uiStride, piPred, uiStride, tuRecurseWithPU, bUseFilter, TComPrediction::UseDPCMForFirstPassIntraEstimation(tuRecurseWithPU, uiMode) );
+          predIntraAng( COMPONENT_Y, uiMode, piOrg, uiStride, piModePred[modeIdx], uiModePredStride, tuRecurseWithPU, bUseFilter, true );
+        }
+        distParam.pCur = piModePred[modeIdx];
 
         // use hadamard transform here
         uiSad+=distParam.DistFunc(&distParam);
@@ -2320,7 +2358,7 @@ TEncSearch::estIntraPredLumaQT(TComDataCU* pcCU,
       }
       (Void)CandNum; // Avoid compiler warning: CandNum is never used
 
-      if (m_pcEncCfg->getFastUDIUseMPMEnabled())
+      if (m_pcEncCfg->getFastUDIUseMPMEnabled() && !bRoiBackground)
       {
         Int uiPreds[NUM_MOST_PROBABLE_MODES] = {-1, -1, -1};
 
@@ -3756,7 +3794,22 @@ Void TEncSearch::xMotionEstimation( TComDataCU* pcCU, TComYuv* pcYuvOrg, Int iPa
   assert(eRefPicList < MAX_NUM_REF_LIST_ADAPT_SR && iRefIdxPred<Int(MAX_IDX_ADAPT_SR));
   m_iSearchRange = m_aaiAdaptSR[eRefPicList][iRefIdxPred];
 
-  Int           iSrchRng      = ( bBi ? m_bipredSearchRange : m_iSearchRange );
+  // ROI-adaptive search budget: background PUs use a small window and may skip the fractional refinement,
+  // foreground PUs may use the extended TZ search settings
+  Int iPUPosX, iPUPosY, iPUWidth, iPUHeight;
+  pcCU->getPartPosition( iPartIdx, iPUPosX, iPUPosY, iPUWidth, iPUHeight );
+  const TEncPic* pcEPic        = dynamic_cast<const TEncPic*>( pcCU->getPic() );
+  const Bool     bRoiActive    = pcEPic != NULL && pcEPic->getRoiMap() != NULL && pcEPic->getRoiMap()->isActive();
+  const Bool     bRoiBackground = bRoiActive && pcEPic->isRoiBackground( iPUPosX, iPUPosY, iPUWidth, iPUHeight );
+  const Bool     bExtendedSearch = bRoiActive && !bRoiBackground && m_pcEncCfg->getRoiForegroundExtendedSearch();
+  Int            iBipredSrchRng = m_bipredSearchRange;
+  if ( bRoiBackground && m_pcEncCfg->getRoiBackgroundSearchRange() > 0 )
+  {
+    m_iSearchRange = std::min( m_iSearchRange, m_pcEncCfg->getRoiBackgroundSearchRange() );
+    iBipredSrchRng = std::min( iBipredSrchRng, m_pcEncCfg->getRoiBackgroundSearchRange() );
+  }
+
+  Int           iSrchRng      = ( bBi ? iBipredSrchRng : m_iSearchRange );
   TComPattern   cPattern;
 
   Double        fWeight       = 1.0;
@@ -3840,7 +3893,7 @@ Void TEncSearch::xMotionEstimation( TComDataCU* pcCU, TComYuv* pcYuvOrg, Int iPa
     {
       pIntegerMv2Nx2NPred = &(m_integerMv2Nx2N[eRefPicList][iRefIdxPred]);
     }
-    xPatternSearchFast  ( pcCU, &cPattern, piRefY, iRefStride, &cMvSrchRngLT, &cMvSrchRngRB, rcMv, ruiCost, pIntegerMv2Nx2NPred );
+    xPatternSearchFast  ( pcCU, &cPattern, piRefY, iRefStride, &cMvSrchRngLT, &cMvSrchRngRB, rcMv, ruiCost, pIntegerMv2Nx2NPred, bExtendedSearch );
     if (pcCU->getPartitionSize(0) == SIZE_2Nx2N)
     {
       m_integerMv2Nx2N[eRefPicList][iRefIdxPred] = rcMv;
@@ -3851,7 +3904,17 @@ Void TEncSearch::xMotionEstimation( TComDataCU* pcCU, TComYuv* pcYuvOrg, Int iPa
   m_pcRdCost->setCostScale ( 1 );
 
   const Bool bIsLosslessCoded = pcCU->getCUTransquantBypass(uiPartAddr) != 0;
-  xPatternSearchFracDIF( bIsLosslessCoded, &cPattern, piRefY, iRefStride, &rcMv, cMvHalf, cMvQter, ruiCost );
+  const UInt uiFracSkipThreshold = m_pcEncCfg->getRoiBackgroundFracSkipThreshold();
+  if ( bRoiBackground && uiFracSkipThreshold > 0 && ruiCost < Distortion( uiFracSkipThreshold ) * iRoiWidth * iRoiHeight )
+  {
+    // integer-pel match is already good enough for the background
+    cMvHalf.setZero();
+    cMvQter.setZero();
+  }
+  else
+  {
+    xPatternSearchFracDIF( bIsLosslessCoded, &cPattern, piRefY, iRefStride, &rcMv, cMvHalf, cMvQter, ruiCost );
+  }
 
   m_pcRdCost->setCostScale( 0 );
   rcMv <<= 2;
@@ -4016,7 +4079,8 @@ Void TEncSearch::xPatternSearchFast( const TComDataCU* const  pcCU,
                                      const TComMv* const      pcMvSrchRngRB,
                                      TComMv&                  rcMv,
                                      Distortion&              ruiSAD,
-                                     const TComMv* const      pIntegerMv2Nx2NPred )
+                                     const TComMv* const      pIntegerMv2Nx2NPred,
+                                     const Bool               bExtendedSearch )
 {
   assert (MD_LEFT < NUM_MV_PREDICTORS);
   pcCU->getMvPredLeft       ( m_acMvPredictors[MD_LEFT] );
@@ -4028,7 +4092,7 @@ Void TEncSearch::xPatternSearchFast( const TComDataCU* const  pcCU,
   switch ( m_motionEstimationSearchMethod )
   {
     case MESEARCH_DIAMOND:
-      xTZSearch( pcCU, pcPatternKey, piRefY, iRefStride, pcMvSrchRngLT, pcMvSrchRngRB, rcMv, ruiSAD, pIntegerMv2Nx2NPred, false );
+      xTZSearch( pcCU, pcPatternKey, piRefY, iRefStride, pcMvSrchRngLT, pcMvSrchRngRB, rcMv, ruiSAD, pIntegerMv2Nx2NPred, bExtendedSearch );
       break;
 
     case MESEARCH_SELECTIVE:
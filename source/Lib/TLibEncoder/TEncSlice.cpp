@@ -37,7 +37,10 @@
 
 #include "TEncTop.h"
 #include "TEncSlice.h"
+#include "TEncCtuWorker.h"
 #include <math.h>
+#include <chrono>
+#include <thread>
 
 //! \ingroup TLibEncoder
 //! \{
@@ -48,6 +51,13 @@
 
 TEncSlice::TEncSlice()
  : m_encCABACTableIdx(I_SLICE)
+ , m_numCtuRows(0)
+ , m_wavefrontSyncContextStates(NULL)
+ , m_wavefrontFirstRow(0)
+ , m_wavefrontNextRow(0)
+ , m_tileNextIdx(0)
+ , m_tileBinsCoded(0)
+ , m_pcLastTileCoder(NULL)
 {
 }
 
@@ -63,6 +73,10 @@ Void TEncSlice::create( Int iWidth, Int iHeight, ChromaFormat chromaFormat, UInt
 
   // create residual picture
   m_picYuvResi.create( iWidth, iHeight, chromaFormat, iMaxCUWidth, iMaxCUHeight, uhTotalDepth, true );
+
+  // context storage of the wavefront threads
+  m_numCtuRows                 = ( iHeight + iMaxCUHeight - 1 ) / iMaxCUHeight;
+  m_wavefrontSyncContextStates = new TEncSbac[m_numCtuRows];
 }
 
 Void TEncSlice::destroy()
@@ -70,6 +84,10 @@ Void TEncSlice::destroy()
   m_picYuvPred.destroy();
   m_picYuvResi.destroy();
 
+  delete [] m_wavefrontSyncContextStates;
+  m_wavefrontSyncContextStates = NULL;
+  m_numCtuRows                 = 0;
+
   // free lambda and QP arrays
   m_vdRdPicLambda.clear();
   m_vdRdPicQp.clear();
@@ -99,6 +117,35 @@ Void TEncSlice::init( TEncTop* pcEncTop )
   m_vdRdPicQp.resize(    m_pcCfg->getDeltaQpRD() * 2 + 1 );
   m_viRdPicQp.resize(    m_pcCfg->getDeltaQpRD() * 2 + 1 );
   m_pcRateCtrl        = pcEncTop->getRateCtrl();
+
+  m_ctuWorkers.resize( pcEncTop->getNumCtuWorkers() );
+  for ( UInt i = 0; i < pcEncTop->getNumCtuWorkers(); i++ )
+  {
+    m_ctuWorkers[i] = pcEncTop->getCtuWorker( i );
+  }
+}
+
+/** Initialise a slice encoder that prepares and compresses pictures with the coding objects of a worker instead of the
+ * ones of the encoder, so that it can run next to the encoder's own slice encoder. The slices are still entropy coded by
+ * the encoder's slice encoder, and the CTUs of a picture are compressed on a single thread.
+ * \param pcEncTop  encoder
+ * \param pcWorker  coding objects of the slice encoder
+ */
+Void TEncSlice::init( TEncTop* pcEncTop, TEncCtuWorker* pcWorker )
+{
+  init( pcEncTop );
+
+  m_pcCuEncoder       = pcWorker->getCuEncoder();
+  m_pcPredSearch      = pcWorker->getPredSearch();
+  m_pcEntropyCoder    = pcWorker->getEntropyCoder();
+  m_pcSbacCoder       = pcWorker->getSbacCoder();
+  m_pcBinCABAC        = pcWorker->getBinCABAC();
+  m_pcTrQuant         = pcWorker->getTrQuant();
+  m_pcRdCost          = pcWorker->getRdCost();
+  m_pppcRDSbacCoder   = pcWorker->getRDSbacCoder();
+  m_pcRDGoOnSbacCoder = pcWorker->getRDGoOnSbacCoder();
+
+  m_ctuWorkers.clear();
 }
 
 Void TEncSlice::updateLambda(TComSlice* pSlice, Double dQP)
@@ -160,6 +207,7 @@ Void TEncSlice::initEncSlice( TComPic* pcPic, const Int pocLast, const Int pocCu
 {
   Double dQP;
   Double dLambda;
+  const Int intraPeriodStart = m_pcGOPEncoder->getIntraPeriodStart();   // 0, or the POC of the last scene cut
 
   rpcSlice = pcPic->getSlice(0);
   rpcSlice->setSliceBits(0);
@@ -180,7 +228,7 @@ Void TEncSlice::initEncSlice( TComPic* pcPic, const Int pocLast, const Int pocCu
     }
     else
     {
-      poc = poc % m_pcCfg->getGOPSize();   
+      poc = (poc - intraPeriodStart) % m_pcCfg->getGOPSize();
     }
 
     if ( poc == 0 )
@@ -223,11 +271,11 @@ Void TEncSlice::initEncSlice( TComPic* pcPic, const Int pocLast, const Int pocCu
   {
     if(m_pcCfg->getDecodingRefreshType() == 3)
     {
-      eSliceType = (pocLast == 0 || pocCurr % m_pcCfg->getIntraPeriod() == 0             || m_pcGOPEncoder->getGOPSize() == 0) ? I_SLICE : eSliceType;
+      eSliceType = (pocLast == intraPeriodStart || (pocCurr - intraPeriodStart) % m_pcCfg->getIntraPeriod() == 0             || m_pcGOPEncoder->getGOPSize() == 0) ? I_SLICE : eSliceType;
     }
     else
     {
-      eSliceType = (pocLast == 0 || (pocCurr - (isField ? 1 : 0)) % m_pcCfg->getIntraPeriod() == 0 || m_pcGOPEncoder->getGOPSize() == 0) ? I_SLICE : eSliceType;
+      eSliceType = (pocLast == intraPeriodStart || (pocCurr - (isField ? 1 : 0) - intraPeriodStart) % m_pcCfg->getIntraPeriod() == 0 || m_pcGOPEncoder->getGOPSize() == 0) ? I_SLICE : eSliceType;
     }
   }
 
@@ -237,7 +285,7 @@ Void TEncSlice::initEncSlice( TComPic* pcPic, const Int pocLast, const Int pocCu
   // Non-referenced frame marking
   // ------------------------------------------------------------------------------------------------------------------
 
-  if(pocLast == 0)
+  if(pocLast == intraPeriodStart)
   {
     rpcSlice->setTemporalLayerNonReferenceFlag(false);
   }
@@ -309,11 +357,11 @@ Void TEncSlice::initEncSlice( TComPic* pcPic, const Int pocLast, const Int pocCu
     {
       if(m_pcCfg->getDecodingRefreshType() == 3)
       {
-        eSliceType = (pocLast == 0 || (pocCurr)                     % m_pcCfg->getIntraPeriod() == 0 || m_pcGOPEncoder->getGOPSize() == 0) ? I_SLICE : eSliceType;
+        eSliceType = (pocLast == intraPeriodStart || (pocCurr - intraPeriodStart)    % m_pcCfg->getIntraPeriod() == 0 || m_pcGOPEncoder->getGOPSize() == 0) ? I_SLICE : eSliceType;
       }
       else
       {
-        eSliceType = (pocLast == 0 || (pocCurr - (isField ? 1 : 0)) % m_pcCfg->getIntraPeriod() == 0 || m_pcGOPEncoder->getGOPSize() == 0) ? I_SLICE : eSliceType;
+        eSliceType = (pocLast == intraPeriodStart || (pocCurr - (isField ? 1 : 0) - intraPeriodStart) % m_pcCfg->getIntraPeriod() == 0 || m_pcGOPEncoder->getGOPSize() == 0) ? I_SLICE : eSliceType;
       }
     }
 
@@ -503,6 +551,10 @@ Void TEncSlice::setSearchRange( TComSlice* pcSlice )
       iRefPOC = pcSlice->getRefPic(e, iRefIdx)->getPOC();
       Int newSearchRange = Clip3(m_pcCfg->getMinSearchWindow(), iMaxSR, (iMaxSR*ADAPT_SR_SCALE*abs(iCurrPOC - iRefPOC)+iOffset)/iGOPSize);
       m_pcPredSearch->setAdaptiveSearchRange(iDir, iRefIdx, newSearchRange);
+      for ( std::size_t i = 0; i < m_ctuWorkers.size(); i++ )
+      {
+        m_ctuWorkers[i]->getPredSearch()->setAdaptiveSearchRange(iDir, iRefIdx, newSearchRange);
+      }
     }
   }
 }
@@ -730,6 +782,17 @@ Void TEncSlice::compressSlice( TComPic* pcPic, const Bool bCompressEntireSlice,
     }
   }
 
+  if ( xUseWaveFrontThreads( pcPic ) )
+  {
+    xCompressSliceWaveFront( pcPic, startCtuTsAddr, boundingCtuTsAddr, bFastDeltaQP );
+    return;
+  }
+  if ( xUseTileThreads( pcPic ) )
+  {
+    xCompressSliceTiles( pcPic, startCtuTsAddr, boundingCtuTsAddr, bFastDeltaQP );
+    return;
+  }
+
   // for every CTU in the slice segment (may terminate sooner if there is a byte limit on the slice-segment)
 
   for( UInt ctuTsAddr = startCtuTsAddr; ctuTsAddr < boundingCtuTsAddr; ++ctuTsAddr )
@@ -765,6 +828,13 @@ Void TEncSlice::compressSlice( TComPic* pcPic, const Bool bCompressEntireSlice,
       }
     }
 
+    // with wavefronts or tiles, each CTU row or tile starts the motion search from the same state, whichever thread compresses it
+    if ( ( m_pcCfg->getEntropyCodingSyncEnabledFlag() || pcPic->getPicSym()->getNumTiles() > 1 ) &&
+         ( ctuTsAddr == startCtuTsAddr || ctuRsAddr == firstCtuRsAddrOfTile || ( ctuXPosInCtus == tileXPosInCtus && m_pcCfg->getEntropyCodingSyncEnabledFlag() ) ) )
+    {
+      m_pcPredSearch->resetIntegerMv2Nx2N();
+    }
+
     // set go-on entropy coder (used for all trial encodings - the cu encoder and encoder search also have a copy of the same pointer)
     m_pcEntropyCoder->setEntropyCoder ( m_pcRDGoOnSbacCoder );
     m_pcEntropyCoder->setBitstream( &tempBitCounter );
@@ -860,6 +930,7 @@ Void TEncSlice::compressSlice( TComPic* pcPic, const Bool bCompressEntireSlice,
     {
       break;
     }
+    m_pcGOPEncoder->setCtuCompressed( pcPic, ctuRsAddr );
 
     pcSlice->setSliceBits( (UInt)(pcSlice->getSliceBits() + numberOfWrittenBits) );
     pcSlice->setSliceSegmentBits(pcSlice->getSliceSegmentBits()+numberOfWrittenBits);
@@ -904,6 +975,10 @@ Void TEncSlice::compressSlice( TComPic* pcPic, const Bool bCompressEntireSlice,
       {
         actualQP = g_RCInvalidQPValue;
       }
+      else if ( m_pcRateCtrl->getRCPic()->getRoiEnabled() )
+      {
+        actualQP = m_pcRateCtrl->getRCQP(); // foreground CUs are offset from the background QP of the CTU
+      }
       else
       {
         actualQP = pCtu->getQP( 0 );
@@ -948,6 +1023,577 @@ Void TEncSlice::compressSlice( TComPic* pcPic, const Bool bCompressEntireSlice,
   //}
 }
 
+/** Check whether the per-CTU state of the encoder configuration allows several threads to compress CTUs of the slice.
+ * This needs a slice segment whose end is known in advance. Rate control, adaptive QP selection and the luma-level or
+ * smoothness QP adaptation update state from one CTU to the next, so they stay on a single thread.
+ * \param pcPic  picture class
+ */
+Bool TEncSlice::xUseCtuWorkers( TComPic* pcPic )
+{
+  if ( m_ctuWorkers.empty() )
+  {
+    return false;
+  }
+  const TComSlice* pcSlice = pcPic->getSlice(getSliceIdx());
+  return pcSlice->getSliceMode() != FIXED_NUMBER_OF_BYTES
+      && pcSlice->getSliceSegmentMode() != FIXED_NUMBER_OF_BYTES
+      && !pcSlice->getPPS()->getDependentSliceSegmentsEnabledFlag()
+      && !m_pcCfg->getUseRateCtrl()
+#if ADAPTIVE_QP_SELECTION
+      && !m_pcCfg->getUseAdaptQpSelect()
+#endif
+#if JVET_V0078
+      && !m_pcCfg->getSmoothQPReductionEnable()
+#endif
+#if JVET_Y0077_BIM
+      && !m_pcCfg->getBIM()
+#endif
+      && !m_pcCfg->getLumaLevelToDeltaQPMapping().isEnabled();
+}
+
+/** Check whether the CTUs of the current slice segment can be compressed by the wavefront threads, which needs a single tile.
+ * \param pcPic  picture class
+ */
+Bool TEncSlice::xUseWaveFrontThreads( TComPic* pcPic )
+{
+  return m_pcCfg->getEntropyCodingSyncEnabledFlag() && m_pcCfg->getNumWaveFrontThreads() > 1
+      && pcPic->getPicSym()->getNumTiles() == 1
+      && xUseCtuWorkers( pcPic );
+}
+
+/** Check whether the tiles of the current slice segment can be compressed and entropy coded by the tile threads.
+ * Tiles combined with wavefronts are left to the single-threaded loop.
+ * \param pcPic  picture class
+ */
+Bool TEncSlice::xUseTileThreads( TComPic* pcPic )
+{
+#if ENC_DEC_TRACE
+  return false; // the trace of the tiles would be interleaved
+#else
+  return m_pcCfg->getNumTileThreads() > 1
+      && pcPic->getPicSym()->getNumTiles() > 1
+      && !m_pcCfg->getEntropyCodingSyncEnabledFlag()
+      && xUseCtuWorkers( pcPic );
+#endif
+}
+
+/** Hand the slice-level state of the encoder's own coding objects to the coding objects of the threads.
+ * \param pcSlice       slice to be compressed
+ * \param bFastDeltaQP  use the fast delta QP decision
+ */
+Void TEncSlice::xInitCtuWorkers( const TComSlice* pcSlice, const Bool bFastDeltaQP )
+{
+  for ( std::size_t i = 0; i < m_ctuWorkers.size(); i++ )
+  {
+    *m_ctuWorkers[i]->getRdCost() = *m_pcRdCost;
+#if RDOQ_CHROMA_LAMBDA
+    m_ctuWorkers[i]->getTrQuant()->setLambdas( pcSlice->getLambdas() );
+#else
+    m_ctuWorkers[i]->getTrQuant()->setLambda( pcSlice->getLambdas()[0] );
+#endif
+    m_ctuWorkers[i]->getCuEncoder()->setFastDeltaQp( bFastDeltaQP );
+  }
+}
+
+/** Compress one CTU with the coding objects of a thread, as in the CTU loop of compressSlice. The contexts of the thread
+ * must be set up for the CTU; the true encode following the trial encodes brings them into the state after the CTU.
+ * \param pcWorker  coding objects of the thread
+ * \param pCtu      CTU to compress
+ * \returns number of bits of the CTU
+ */
+UInt TEncSlice::xCompressCtu( TEncCtuWorker* pcWorker, TComDataCU* pCtu )
+{
+  TEncCu*          pcCuEncoder      = pcWorker->getCuEncoder();
+  TEncEntropy*     pcEntropyCoder   = pcWorker->getEntropyCoder();
+  TEncSbac*        pcRDSbacCoder    = pcWorker->getRDSbacCoder()[0][CI_CURR_BEST];
+  TEncSbac*        pcRDGoOnSbacCoder= pcWorker->getRDGoOnSbacCoder();
+  TComBitCounter*  pcBitCounter     = pcWorker->getBitCounter();
+  TEncBinCABAC*    pRDSbacBinCoder  = (TEncBinCABAC *) pcRDSbacCoder->getEncBinIf();
+
+  // set go-on entropy coder (used for all trial encodings - the cu encoder and encoder search also have a copy of the same pointer)
+  pcEntropyCoder->setEntropyCoder( pcRDGoOnSbacCoder );
+  pcEntropyCoder->setBitstream( pcBitCounter );
+  pcBitCounter->resetBits();
+  pcRDGoOnSbacCoder->load( pcRDSbacCoder );
+  ((TEncBinCABAC*)pcRDGoOnSbacCoder->getEncBinIf())->setBinCountingEnableFlag( true );
+
+  // run CTU trial encoder
+  pcCuEncoder->compressCtu( pCtu );
+
+  // true encode of the CTU, to bring the contexts into the state for the next CTU
+  pcEntropyCoder->setEntropyCoder( pcRDSbacCoder );
+  pcEntropyCoder->setBitstream( pcBitCounter );
+  pRDSbacBinCoder->setBinCountingEnableFlag( true );
+  pcRDSbacCoder->resetBits();
+  pRDSbacBinCoder->setBinsCoded( 0 );
+
+  pcCuEncoder->encodeCtu( pCtu );
+
+  pRDSbacBinCoder->setBinCountingEnableFlag( false );
+
+  return pcEntropyCoder->getNumberOfWrittenBits();
+}
+
+/** Compress the CTUs of a slice segment with the wavefront threads.
+ * The CTU rows are handed out to the threads in order. A CTU is compressed once the CTU above and to its right is done,
+ * which also provides the contexts at the start of the row, so every CTU sees the same state as in the serial loop.
+ * \param pcPic              picture class
+ * \param startCtuTsAddr     first CTU of the slice segment
+ * \param boundingCtuTsAddr  CTU after the end of the slice segment
+ * \param bFastDeltaQP       use the fast delta QP decision
+ */
+Void TEncSlice::xCompressSliceWaveFront( TComPic* pcPic, const UInt startCtuTsAddr, const UInt boundingCtuTsAddr, const Bool bFastDeltaQP )
+{
+  const UInt frameWidthInCtus = pcPic->getPicSym()->getFrameWidthInCtus();
+
+  // the threads take the slice-level lambdas from the encoder's own coding objects
+  xInitCtuWorkers( pcPic->getSlice(getSliceIdx()), bFastDeltaQP );
+
+  // with a single tile, the tile scan is the raster scan
+  m_wavefrontFirstRow = startCtuTsAddr / frameWidthInCtus;
+  m_wavefrontNextRow  = m_wavefrontFirstRow;
+  m_wavefrontRowProgress.assign( m_numCtuRows, 0 );
+  m_wavefrontRowProgress[m_wavefrontFirstRow] = startCtuTsAddr % frameWidthInCtus;
+
+  std::vector<std::thread> threads;
+  for ( std::size_t i = 1; i < m_ctuWorkers.size(); i++ )
+  {
+    threads.push_back( std::thread( &TEncSlice::xCompressCtuRows, this, m_ctuWorkers[i], pcPic, startCtuTsAddr, boundingCtuTsAddr ) );
+  }
+  xCompressCtuRows( m_ctuWorkers[0], pcPic, startCtuTsAddr, boundingCtuTsAddr );
+  for ( std::size_t i = 0; i < threads.size(); i++ )
+  {
+    threads[i].join();
+  }
+}
+
+/** Compress CTU rows handed out by xCompressSliceWaveFront until all rows of the slice segment are taken.
+ * \param pcWorker           coding objects of the thread
+ * \param pcPic              picture class
+ * \param startCtuTsAddr     first CTU of the slice segment
+ * \param boundingCtuTsAddr  CTU after the end of the slice segment
+ */
+Void TEncSlice::xCompressCtuRows( TEncCtuWorker* pcWorker, TComPic* pcPic, const UInt startCtuTsAddr, const UInt boundingCtuTsAddr )
+{
+  TComSlice* const pcSlice          = pcPic->getSlice(getSliceIdx());
+  const UInt       frameWidthInCtus = pcPic->getPicSym()->getFrameWidthInCtus();
+  TEncSbac*        pcRDSbacCoder    = pcWorker->getRDSbacCoder()[0][CI_CURR_BEST];
+  TEncBinCABAC*    pRDSbacBinCoder  = (TEncBinCABAC *) pcRDSbacCoder->getEncBinIf();
+
+  pRDSbacBinCoder->setBinCountingEnableFlag( false );
+  pRDSbacBinCoder->setBinsCoded( 0 );
+
+  UInt64 sliceBits    = 0;
+  UInt64 picTotalBits = 0;
+  UInt64 picDist      = 0;
+  Double picRdCost    = 0;
+
+  for ( ; ; )
+  {
+    UInt row;
+    {
+      std::lock_guard<std::mutex> lock( m_wavefrontMutex );
+      row = m_wavefrontNextRow++;
+    }
+    const UInt rowStartCtuTsAddr    = std::max( startCtuTsAddr, row * frameWidthInCtus );
+    const UInt rowBoundingCtuTsAddr = std::min( boundingCtuTsAddr, ( row + 1 ) * frameWidthInCtus );
+    if ( rowStartCtuTsAddr >= rowBoundingCtuTsAddr )
+    {
+      break;
+    }
+
+    for( UInt ctuTsAddr = rowStartCtuTsAddr; ctuTsAddr < rowBoundingCtuTsAddr; ++ctuTsAddr )
+    {
+      const UInt ctuRsAddr     = pcPic->getPicSym()->getCtuTsToRsAddrMap(ctuTsAddr);
+      const UInt ctuXPosInCtus = ctuRsAddr % frameWidthInCtus;
+
+      // wait for the CTU above and to the right (above for the last CTU of the row)
+      if ( row > m_wavefrontFirstRow )
+      {
+        const UInt requiredProgress = std::min( ctuXPosInCtus + 2, frameWidthInCtus );
+        std::unique_lock<std::mutex> lock( m_wavefrontMutex );
+        while ( m_wavefrontRowProgress[row - 1] < requiredProgress )
+        {
+          m_wavefrontProgressCond.wait( lock );
+        }
+      }
+
+      // initialize CTU encoder
+      TComDataCU* pCtu = pcPic->getCtu( ctuRsAddr );
+      pCtu->initCtu( pcPic, ctuRsAddr );
+
+      // update CABAC state: the slice segment and every row start from the initial contexts (and a cleared motion
+      // search state), rows then take over the contexts at the end of the top-right CTU (if within current slice)
+      if ( ctuTsAddr == startCtuTsAddr || ctuXPosInCtus == 0 )
+      {
+        pcRDSbacCoder->resetEntropy( pcSlice );
+        pcWorker->getPredSearch()->resetIntegerMv2Nx2N();
+      }
+      if ( ctuXPosInCtus == 0 )
+      {
+        TComDataCU *pCtuUp = pCtu->getCtuAbove();
+        if ( pCtuUp && ( ctuXPosInCtus + 1 ) < frameWidthInCtus )
+        {
+          TComDataCU *pCtuTR = pcPic->getCtu( ctuRsAddr - frameWidthInCtus + 1 );
+          if ( pCtu->CUIsFromSameSliceAndTile( pCtuTR ) )
+          {
+            pcRDSbacCoder->loadContexts( &m_wavefrontSyncContextStates[row - 1] );
+          }
+        }
+      }
+
+      sliceBits += xCompressCtu( pcWorker, pCtu );
+      m_pcGOPEncoder->setCtuCompressed( pcPic, ctuRsAddr );
+
+      // Store probabilities of second CTU in line into buffer, for the start of the next row
+      if ( ctuXPosInCtus == 1 )
+      {
+        m_wavefrontSyncContextStates[row].loadContexts( pcRDSbacCoder );
+      }
+
+      picTotalBits += pCtu->getTotalBits();
+      picRdCost    += pCtu->getTotalCost();
+      picDist      += pCtu->getTotalDistortion();
+
+      {
+        std::lock_guard<std::mutex> lock( m_wavefrontMutex );
+        m_wavefrontRowProgress[row] = ctuXPosInCtus + 1;
+      }
+      m_wavefrontProgressCond.notify_all();
+    }
+  }
+
+  // stop use of the bit counter object.
+  pcRDSbacCoder->setBitstream( NULL );
+  pcWorker->getRDGoOnSbacCoder()->setBitstream( NULL );
+
+  std::lock_guard<std::mutex> lock( m_wavefrontMutex );
+  pcSlice->setSliceBits( (UInt)( pcSlice->getSliceBits() + sliceBits ) );
+  pcSlice->setSliceSegmentBits( (UInt)( pcSlice->getSliceSegmentBits() + sliceBits ) );
+  m_uiPicTotalBits += picTotalBits;
+  m_dPicRdCost     += picRdCost;
+  m_uiPicDist      += picDist;
+}
+
+/** Hand out the next tile of the slice segment to a tile thread.
+ * \param pcPic                  picture class
+ * \param startCtuTsAddr         first CTU of the slice segment
+ * \param boundingCtuTsAddr      CTU after the end of the slice segment
+ * \param tileIdx                returns the index of the tile
+ * \param tileStartCtuTsAddr     returns the first CTU of the slice segment in the tile
+ * \param tileBoundingCtuTsAddr  returns the CTU after the last CTU of the slice segment in the tile
+ * \returns false when all tiles of the slice segment have been handed out
+ */
+Bool TEncSlice::xGetNextTile( TComPic* pcPic, const UInt startCtuTsAddr, const UInt boundingCtuTsAddr, UInt &tileIdx, UInt &tileStartCtuTsAddr, UInt &tileBoundingCtuTsAddr )
+{
+  {
+    std::lock_guard<std::mutex> lock( m_tileMutex );
+    tileIdx = m_tileNextIdx++;
+  }
+  if ( tileIdx >= pcPic->getPicSym()->getNumTiles() )
+  {
+    return false;
+  }
+  // the CTUs of a tile are consecutive in tile scan
+  const TComTile *pTile           = pcPic->getPicSym()->getTComTile( tileIdx );
+  const UInt      firstCtuTsAddr  = pcPic->getPicSym()->getCtuRsToTsAddrMap( pTile->getFirstCtuRsAddr() );
+  tileStartCtuTsAddr    = std::max( startCtuTsAddr, firstCtuTsAddr );
+  tileBoundingCtuTsAddr = std::min( boundingCtuTsAddr, firstCtuTsAddr + pTile->getTileWidthInCtus() * pTile->getTileHeightInCtus() );
+  return tileStartCtuTsAddr < tileBoundingCtuTsAddr;
+}
+
+/** Compress the CTUs of a slice segment with the tile threads, handing out one tile at a time.
+ * \param pcPic              picture class
+ * \param startCtuTsAddr     first CTU of the slice segment
+ * \param boundingCtuTsAddr  CTU after the end of the slice segment
+ * \param bFastDeltaQP       use the fast delta QP decision
+ */
+Void TEncSlice::xCompressSliceTiles( TComPic* pcPic, const UInt startCtuTsAddr, const UInt boundingCtuTsAddr, const Bool bFastDeltaQP )
+{
+  xInitCtuWorkers( pcPic->getSlice(getSliceIdx()), bFastDeltaQP );
+
+  m_tileNextIdx = pcPic->getPicSym()->getTileIdxMap( pcPic->getPicSym()->getCtuTsToRsAddrMap( startCtuTsAddr ) );
+  if ( m_tileStats.size() < pcPic->getPicSym()->getNumTiles() )
+  {
+    m_tileStats.resize( pcPic->getPicSym()->getNumTiles() );
+  }
+
+  // initialise all CTUs up front: the neighbour derivation compares the slice of a CTU in another tile
+  // before rejecting it for the tile, so that slice must be set before any thread starts
+  for( UInt ctuTsAddr = startCtuTsAddr; ctuTsAddr < boundingCtuTsAddr; ++ctuTsAddr )
+  {
+    const UInt ctuRsAddr = pcPic->getPicSym()->getCtuTsToRsAddrMap(ctuTsAddr);
+    pcPic->getCtu( ctuRsAddr )->initCtu( pcPic, ctuRsAddr );
+  }
+
+  std::vector<std::thread> threads;
+  for ( std::size_t i = 1; i < m_ctuWorkers.size(); i++ )
+  {
+    threads.push_back( std::thread( &TEncSlice::xCompressTiles, this, m_ctuWorkers[i], pcPic, startCtuTsAddr, boundingCtuTsAddr ) );
+  }
+  xCompressTiles( m_ctuWorkers[0], pcPic, startCtuTsAddr, boundingCtuTsAddr );
+  for ( std::size_t i = 0; i < threads.size(); i++ )
+  {
+    threads[i].join();
+  }
+}
+
+/** Compress tiles handed out by xGetNextTile until all tiles of the slice segment are taken.
+ * Every tile starts from the initial contexts and a cleared motion search state, as in the serial loop.
+ * \param pcWorker           coding objects of the thread
+ * \param pcPic              picture class
+ * \param startCtuTsAddr     first CTU of the slice segment
+ * \param boundingCtuTsAddr  CTU after the end of the slice segment
+ */
+Void TEncSlice::xCompressTiles( TEncCtuWorker* pcWorker, TComPic* pcPic, const UInt startCtuTsAddr, const UInt boundingCtuTsAddr )
+{
+  TComSlice* const pcSlice          = pcPic->getSlice(getSliceIdx());
+  const TEncPic*   pcEPic           = dynamic_cast<const TEncPic*>( pcPic );
+  const TEncRoiMap* pcRoiMap        = ( pcEPic != NULL && pcEPic->getRoiMap() != NULL && pcEPic->getRoiMap()->isActive() ) ? pcEPic->getRoiMap() : NULL;
+  TEncSbac*        pcRDSbacCoder    = pcWorker->getRDSbacCoder()[0][CI_CURR_BEST];
+  TEncBinCABAC*    pRDSbacBinCoder  = (TEncBinCABAC *) pcRDSbacCoder->getEncBinIf();
+
+  pRDSbacBinCoder->setBinCountingEnableFlag( false );
+  pRDSbacBinCoder->setBinsCoded( 0 );
+
+  UInt64 sliceBits    = 0;
+  UInt64 picTotalBits = 0;
+  UInt64 picDist      = 0;
+  Double picRdCost    = 0;
+
+  UInt tileIdx;
+  UInt tileStartCtuTsAddr;
+  UInt tileBoundingCtuTsAddr;
+  while ( xGetNextTile( pcPic, startCtuTsAddr, boundingCtuTsAddr, tileIdx, tileStartCtuTsAddr, tileBoundingCtuTsAddr ) )
+  {
+    const std::chrono::steady_clock::time_point tileStartTime = std::chrono::steady_clock::now();
+
+    for( UInt ctuTsAddr = tileStartCtuTsAddr; ctuTsAddr < tileBoundingCtuTsAddr; ++ctuTsAddr )
+    {
+      const UInt ctuRsAddr = pcPic->getPicSym()->getCtuTsToRsAddrMap(ctuTsAddr);
+      TComDataCU* pCtu     = pcPic->getCtu( ctuRsAddr );
+
+      if ( ctuTsAddr == tileStartCtuTsAddr )
+      {
+        pcRDSbacCoder->resetEntropy( pcSlice );
+        pcWorker->getPredSearch()->resetIntegerMv2Nx2N();
+      }
+
+      sliceBits    += xCompressCtu( pcWorker, pCtu );
+      m_pcGOPEncoder->setCtuCompressed( pcPic, ctuRsAddr );
+      picTotalBits += pCtu->getTotalBits();
+      picRdCost    += pCtu->getTotalCost();
+      picDist      += pCtu->getTotalDistortion();
+    }
+
+    // time and foreground coverage of the coded part of the tile
+    TileThreadStats &stats = m_tileStats[tileIdx];
+    stats.compressTime += std::chrono::duration<Double>( std::chrono::steady_clock::now() - tileStartTime ).count();
+    stats.numCtus      += tileBoundingCtuTsAddr - tileStartCtuTsAddr;
+    if ( pcRoiMap != NULL )
+    {
+      const UInt blkArea = 1 << ( 2 * pcRoiMap->getLog2BlkSize() );
+      for( UInt ctuTsAddr = tileStartCtuTsAddr; ctuTsAddr < tileBoundingCtuTsAddr; ++ctuTsAddr )
+      {
+        const TComDataCU* pCtu = pcPic->getCtu( pcPic->getPicSym()->getCtuTsToRsAddrMap(ctuTsAddr) );
+        const Int ctuWidth  = std::min<Int>( pcSlice->getSPS()->getMaxCUWidth(),  pcSlice->getSPS()->getPicWidthInLumaSamples()  - pCtu->getCUPelX() );
+        const Int ctuHeight = std::min<Int>( pcSlice->getSPS()->getMaxCUHeight(), pcSlice->getSPS()->getPicHeightInLumaSamples() - pCtu->getCUPelY() );
+        stats.foregroundArea += std::min<UInt64>( (UInt64)blkArea * pcRoiMap->getNumForegroundBlocks( pCtu->getCUPelX(), pCtu->getCUPelY(), ctuWidth, ctuHeight ), ctuWidth * ctuHeight );
+        stats.maskedArea     += ctuWidth * ctuHeight;
+      }
+    }
+  }
+
+  // stop use of the bit counter object.
+  pcRDSbacCoder->setBitstream( NULL );
+  pcWorker->getRDGoOnSbacCoder()->setBitstream( NULL );
+
+  std::lock_guard<std::mutex> lock( m_tileMutex );
+  pcSlice->setSliceBits( (UInt)( pcSlice->getSliceBits() + sliceBits ) );
+  pcSlice->setSliceSegmentBits( (UInt)( pcSlice->getSliceSegmentBits() + sliceBits ) );
+  m_uiPicTotalBits += picTotalBits;
+  m_dPicRdCost     += picRdCost;
+  m_uiPicDist      += picDist;
+}
+
+/** Code the SAO parameters of a CTU, if SAO is enabled in the slice.
+ * \param pcEntropyCoder  entropy coder writing the substream of the CTU
+ * \param pcPic           picture class
+ * \param pcSlice         slice of the CTU
+ * \param ctuRsAddr       raster scan address of the CTU
+ */
+Void TEncSlice::xEncodeSAOBlkParam( TEncEntropy* pcEntropyCoder, TComPic* pcPic, const TComSlice* pcSlice, const UInt ctuRsAddr )
+{
+  if ( pcSlice->getSPS()->getUseSAO() )
+  {
+    const UInt frameWidthInCtus = pcPic->getPicSym()->getFrameWidthInCtus();
+    Bool bIsSAOSliceEnabled = false;
+    Bool sliceEnabled[MAX_NUM_COMPONENT];
+    for(Int comp=0; comp < MAX_NUM_COMPONENT; comp++)
+    {
+      ComponentID compId=ComponentID(comp);
+      sliceEnabled[compId] = pcSlice->getSaoEnabledFlag(toChannelType(compId)) && (comp < pcPic->getNumberValidComponents());
+      if (sliceEnabled[compId])
+      {
+        bIsSAOSliceEnabled=true;
+      }
+    }
+    if (bIsSAOSliceEnabled)
+    {
+      SAOBlkParam& saoblkParam = (pcPic->getPicSym()->getSAOBlkParam())[ctuRsAddr];
+
+      Bool leftMergeAvail = false;
+      Bool aboveMergeAvail= false;
+      //merge left condition
+      Int rx = (ctuRsAddr % frameWidthInCtus);
+      if(rx > 0)
+      {
+        leftMergeAvail = pcPic->getSAOMergeAvailability(ctuRsAddr, ctuRsAddr-1);
+      }
+
+      //merge up condition
+      Int ry = (ctuRsAddr / frameWidthInCtus);
+      if(ry > 0)
+      {
+        aboveMergeAvail = pcPic->getSAOMergeAvailability(ctuRsAddr, ctuRsAddr-frameWidthInCtus);
+      }
+
+      pcEntropyCoder->encodeSAOBlkParam(saoblkParam, pcPic->getPicSym()->getSPS().getBitDepths(), sliceEnabled, leftMergeAvail, aboveMergeAvail);
+    }
+  }
+}
+
+/** Entropy code the tiles of a slice segment with the tile threads, each tile into its own substream.
+ * The substream sizes are added to the slice in tile order once all tiles are coded.
+ * \param pcPic              picture class
+ * \param pcSubstreams       substreams of the picture, one per tile
+ * \param startCtuTsAddr     first CTU of the slice segment
+ * \param boundingCtuTsAddr  CTU after the end of the slice segment
+ * \param numBinsCoded       returns the number of bins coded in the slice segment
+ */
+Void TEncSlice::xEncodeSliceTiles( TComPic* pcPic, TComOutputBitstream* pcSubstreams, const UInt startCtuTsAddr, const UInt boundingCtuTsAddr, UInt &numBinsCoded )
+{
+  TComSlice* const pcSlice = pcPic->getSlice(getSliceIdx());
+
+  m_tileNextIdx      = pcPic->getPicSym()->getTileIdxMap( pcPic->getPicSym()->getCtuTsToRsAddrMap( startCtuTsAddr ) );
+  m_tileBinsCoded    = 0;
+  m_pcLastTileCoder  = NULL;
+
+  std::vector<std::thread> threads;
+  for ( std::size_t i = 1; i < m_ctuWorkers.size(); i++ )
+  {
+    threads.push_back( std::thread( &TEncSlice::xEncodeTiles, this, m_ctuWorkers[i], pcPic, pcSubstreams, startCtuTsAddr, boundingCtuTsAddr ) );
+  }
+  xEncodeTiles( m_ctuWorkers[0], pcPic, pcSubstreams, startCtuTsAddr, boundingCtuTsAddr );
+  for ( std::size_t i = 0; i < threads.size(); i++ )
+  {
+    threads[i].join();
+  }
+
+  // write sub-stream sizes, for all tiles but the last one of the slice segment
+  const UInt firstTileIdx = pcPic->getPicSym()->getTileIdxMap( pcPic->getPicSym()->getCtuTsToRsAddrMap( startCtuTsAddr ) );
+  const UInt lastTileIdx  = pcPic->getPicSym()->getTileIdxMap( pcPic->getPicSym()->getCtuTsToRsAddrMap( boundingCtuTsAddr - 1 ) );
+  for ( UInt tileIdx = firstTileIdx; tileIdx < lastTileIdx; tileIdx++ )
+  {
+    pcSlice->addSubstreamSize( (pcSubstreams[tileIdx].getNumberOfWrittenBits() >> 3) + pcSubstreams[tileIdx].countStartCodeEmulations() );
+  }
+
+  // the CABAC table decision is made on the contexts at the end of the slice segment
+  m_pcSbacCoder->loadContexts( m_pcLastTileCoder );
+  if (pcSlice->getPPS()->getCabacInitPresentFlag())
+  {
+    m_encCABACTableIdx = m_pcEntropyCoder->determineCabacInitIdx(pcSlice);
+  }
+  else
+  {
+    m_encCABACTableIdx = pcSlice->getSliceType();
+  }
+
+  numBinsCoded = m_pcBinCABAC->getBinsCoded() + m_tileBinsCoded;
+}
+
+/** Entropy code tiles handed out by xGetNextTile until all tiles of the slice segment are taken.
+ * \param pcWorker           coding objects of the thread
+ * \param pcPic              picture class
+ * \param pcSubstreams       substreams of the picture, one per tile
+ * \param startCtuTsAddr     first CTU of the slice segment
+ * \param boundingCtuTsAddr  CTU after the end of the slice segment
+ */
+Void TEncSlice::xEncodeTiles( TEncCtuWorker* pcWorker, TComPic* pcPic, TComOutputBitstream* pcSubstreams, const UInt startCtuTsAddr, const UInt boundingCtuTsAddr )
+{
+  TComSlice* const pcSlice        = pcPic->getSlice(getSliceIdx());
+  TEncEntropy*     pcEntropyCoder = pcWorker->getEntropyCoder();
+  TEncSbac*        pcSbacCoder    = pcWorker->getSbacCoder();
+  TEncBinCABAC*    pcBinCABAC     = pcWorker->getBinCABAC();
+
+  pcBinCABAC->setBinCountingEnableFlag( true );
+  pcBinCABAC->setBinsCoded( 0 );
+
+  UInt tileIdx;
+  UInt tileStartCtuTsAddr;
+  UInt tileBoundingCtuTsAddr;
+  while ( xGetNextTile( pcPic, startCtuTsAddr, boundingCtuTsAddr, tileIdx, tileStartCtuTsAddr, tileBoundingCtuTsAddr ) )
+  {
+    const std::chrono::steady_clock::time_point tileStartTime = std::chrono::steady_clock::now();
+
+    pcEntropyCoder->setEntropyCoder( pcSbacCoder );
+    pcEntropyCoder->setBitstream( &pcSubstreams[tileIdx] );
+    pcEntropyCoder->resetEntropy( pcSlice );
+
+    for( UInt ctuTsAddr = tileStartCtuTsAddr; ctuTsAddr < tileBoundingCtuTsAddr; ++ctuTsAddr )
+    {
+      const UInt ctuRsAddr = pcPic->getPicSym()->getCtuTsToRsAddrMap(ctuTsAddr);
+
+      xEncodeSAOBlkParam( pcEntropyCoder, pcPic, pcSlice, ctuRsAddr );
+      pcWorker->getCuEncoder()->encodeCtu( pcPic->getCtu( ctuRsAddr ), true );
+    }
+
+    // terminate the sub-stream at the end of the tile or slice segment
+    pcEntropyCoder->encodeTerminatingBit(1);
+    pcEntropyCoder->encodeSliceFinish();
+    pcSubstreams[tileIdx].writeByteAlignment();
+
+    m_tileStats[tileIdx].encodeTime += std::chrono::duration<Double>( std::chrono::steady_clock::now() - tileStartTime ).count();
+
+    if ( tileBoundingCtuTsAddr == boundingCtuTsAddr )
+    {
+      m_pcLastTileCoder = pcSbacCoder;
+    }
+  }
+
+  pcBinCABAC->setBinCountingEnableFlag( false );
+
+  std::lock_guard<std::mutex> lock( m_tileMutex );
+  m_tileBinsCoded += pcBinCABAC->getBinsCoded();
+}
+
+/** Print the time spent on each tile by the tile threads, and the share of the tile covered by the ROI mask, summed
+ * over all pictures.
+ */
+Void TEncSlice::printTileStats()
+{
+  if ( m_tileStats.empty() )
+  {
+    return;
+  }
+  printf( "\n\nTiles ----------------------------------------------------------\n" );
+  printf( "\tTile |   CTUs   | Foreground | Compress (s) | ms/CTU  | Entropy (s)\n" );
+  for ( std::size_t tileIdx = 0; tileIdx < m_tileStats.size(); tileIdx++ )
+  {
+    const TileThreadStats &stats = m_tileStats[tileIdx];
+    printf( "\t%4d | %8d |", (Int)tileIdx, stats.numCtus );
+    if ( stats.maskedArea > 0 )
+    {
+      printf( "   %6.2f %% |", 100.0 * stats.foregroundArea / stats.maskedArea );
+    }
+    else
+    {
+      printf( "          - |" );
+    }
+    printf( " %12.3f | %7.3f | %11.3f\n", stats.compressTime, stats.numCtus > 0 ? 1000.0 * stats.compressTime / stats.numCtus : 0.0, stats.encodeTime );
+  }
+}
+
 Void TEncSlice::encodeSlice   ( TComPic* pcPic, TComOutputBitstream* pcSubstreams, UInt &numBinsCoded )
 {
   TComSlice *const pcSlice           = pcPic->getSlice(getSliceIdx());
@@ -997,6 +1643,12 @@ Void TEncSlice::encodeSlice   ( TComPic* pcPic, TComOutputBitstream* pcSubstream
     }
   }
 
+  if ( xUseTileThreads( pcPic ) )
+  {
+    xEncodeSliceTiles( pcPic, pcSubstreams, startCtuTsAddr, boundingCtuTsAddr, numBinsCoded );
+    return;
+  }
+
   // for every CTU in the slice segment...
 
   for( UInt ctuTsAddr = startCtuTsAddr; ctuTsAddr < boundingCtuTsAddr; ++ctuTsAddr )
@@ -1041,47 +1693,12 @@ Void TEncSlice::encodeSlice   ( TComPic* pcPic, TComOutputBitstream* pcSubstream
     }
 
 
-    if ( pcSlice->getSPS()->getUseSAO() )
-    {
-      Bool bIsSAOSliceEnabled = false;
-      Bool sliceEnabled[MAX_NUM_COMPONENT];
-      for(Int comp=0; comp < MAX_NUM_COMPONENT; comp++)
-      {
-        ComponentID compId=ComponentID(comp);
-        sliceEnabled[compId] = pcSlice->getSaoEnabledFlag(toChannelType(compId)) && (comp < pcPic->getNumberValidComponents());
-        if (sliceEnabled[compId])
-        {
-          bIsSAOSliceEnabled=true;
-        }
-      }
-      if (bIsSAOSliceEnabled)
-      {
-        SAOBlkParam& saoblkParam = (pcPic->getPicSym()->getSAOBlkParam())[ctuRsAddr];
-
-        Bool leftMergeAvail = false;
-        Bool aboveMergeAvail= false;
-        //merge left condition
-        Int rx = (ctuRsAddr % frameWidthInCtus);
-        if(rx > 0)
-        {
-          leftMergeAvail = pcPic->getSAOMergeAvailability(ctuRsAddr, ctuRsAddr-1);
-        }
-
-        //merge up condition
-        Int ry = (ctuRsAddr / frameWidthInCtus);
-        if(ry > 0)
-        {
-          aboveMergeAvail = pcPic->getSAOMergeAvailability(ctuRsAddr, ctuRsAddr-frameWidthInCtus);
-        }
-
-        m_pcEntropyCoder->encodeSAOBlkParam(saoblkParam, pcPic->getPicSym()->getSPS().getBitDepths(), sliceEnabled, leftMergeAvail, aboveMergeAvail);
-      }
-    }
+    xEncodeSAOBlkParam( m_pcEntropyCoder, pcPic, pcSlice, ctuRsAddr );
 
 #if ENC_DEC_TRACE
     g_bJustDoIt = g_bEncDecTraceEnable;
 #endif
-      m_pcCuEncoder->encodeCtu( pCtu );
+      m_pcCuEncoder->encodeCtu( pCtu, true );
 #if ENC_DEC_TRACE
     g_bJustDoIt = g_bEncDecTraceDisable;
 #endif
@@ -47,16 +47,33 @@
 #include "WeightPredAnalysis.h"
 #include "TEncRateCtrl.h"
 
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
 //! \ingroup TLibEncoder
 //! \{
 
 class TEncTop;
 class TEncGOP;
+class TEncCtuWorker;
 
 // ====================================================================================================================
 // Class definition
 // ====================================================================================================================
 
+/// time spent on a tile by the tile threads and its ROI mask coverage, summed over the pictures
+struct TileThreadStats
+{
+  UInt    numCtus;              ///< number of compressed CTUs
+  UInt64  foregroundArea;       ///< luma samples covered by the foreground of the ROI mask
+  UInt64  maskedArea;           ///< luma samples of the pictures with an ROI mask
+  Double  compressTime;         ///< seconds spent on the analysis stage
+  Double  encodeTime;           ///< seconds spent on entropy coding
+
+  TileThreadStats() : numCtus(0), foregroundArea(0), maskedArea(0), compressTime(0), encodeTime(0) {}
+};
+
 /// slice encoder class
 class TEncSlice
   : public WeightPredAnalysis
@@ -100,9 +117,37 @@ private:
   SliceType               m_encCABACTableIdx;
   Int                     m_gopID;
 
+  // wavefront and tile threads
+  std::vector<TEncCtuWorker*> m_ctuWorkers;                     ///< coding objects of the threads compressing CTU rows or tiles in parallel
+  UInt                    m_numCtuRows;                         ///< number of CTU rows of the picture
+  TEncSbac*               m_wavefrontSyncContextStates;         ///< state of contexts at the second CTU of each CTU row
+  std::mutex              m_wavefrontMutex;                     ///< protects the row hand-out and progress below
+  std::condition_variable m_wavefrontProgressCond;              ///< signalled when a CTU row has made progress
+  UInt                    m_wavefrontFirstRow;                  ///< first CTU row of the slice segment
+  UInt                    m_wavefrontNextRow;                   ///< next CTU row to be handed to a thread
+  std::vector<UInt>       m_wavefrontRowProgress;               ///< number of compressed CTU columns in each row
+  std::mutex              m_tileMutex;                          ///< protects the tile hand-out and the slice totals of the tile threads
+  UInt                    m_tileNextIdx;                        ///< next tile to be handed to a thread
+  UInt                    m_tileBinsCoded;                      ///< bins coded by the tile threads in the current slice segment
+  const TEncSbac*         m_pcLastTileCoder;                    ///< SBAC encoder that coded the last tile of the slice segment
+  std::vector<TileThreadStats> m_tileStats;                     ///< statistics of each tile
+
   Double   calculateLambda( const TComSlice* pSlice, const Int GOPid, const Int depth, const Double refQP, const Double dQP, Int &iQP );
   Void     setUpLambda(TComSlice* slice, const Double dLambda, Int iQP);
   Void     calculateBoundingCtuTsAddrForSlice(UInt &startCtuTSAddrSlice, UInt &boundingCtuTSAddrSlice, Bool &haveReachedTileBoundary, TComPic* pcPic, const Int sliceMode, const Int sliceArgument);
+  Bool     xUseCtuWorkers( TComPic* pcPic );
+  Bool     xUseWaveFrontThreads( TComPic* pcPic );
+  Bool     xUseTileThreads( TComPic* pcPic );
+  Void     xInitCtuWorkers( const TComSlice* pcSlice, const Bool bFastDeltaQP );
+  UInt     xCompressCtu( TEncCtuWorker* pcWorker, TComDataCU* pCtu );
+  Void     xCompressSliceWaveFront( TComPic* pcPic, const UInt startCtuTsAddr, const UInt boundingCtuTsAddr, const Bool bFastDeltaQP );
+  Void     xCompressCtuRows( TEncCtuWorker* pcWorker, TComPic* pcPic, const UInt startCtuTsAddr, const UInt boundingCtuTsAddr );
+  Bool     xGetNextTile( TComPic* pcPic, const UInt startCtuTsAddr, const UInt boundingCtuTsAddr, UInt &tileIdx, UInt &tileStartCtuTsAddr, UInt &tileBoundingCtuTsAddr );
+  Void     xCompressSliceTiles( TComPic* pcPic, const UInt startCtuTsAddr, const UInt boundingCtuTsAddr, const Bool bFastDeltaQP );
+  Void     xCompressTiles( TEncCtuWorker* pcWorker, TComPic* pcPic, const UInt startCtuTsAddr, const UInt boundingCtuTsAddr );
+  Void     xEncodeSAOBlkParam( TEncEntropy* pcEntropyCoder, TComPic* pcPic, const TComSlice* pcSlice, const UInt ctuRsAddr );
+  Void     xEncodeSliceTiles( TComPic* pcPic, TComOutputBitstream* pcSubstreams, const UInt startCtuTsAddr, const UInt boundingCtuTsAddr, UInt &numBinsCoded );
+  Void     xEncodeTiles( TEncCtuWorker* pcWorker, TComPic* pcPic, TComOutputBitstream* pcSubstreams, const UInt startCtuTsAddr, const UInt boundingCtuTsAddr );
 
 public:
   TEncSlice();
@@ -111,6 +156,7 @@ public:
   Void    create              ( Int iWidth, Int iHeight, ChromaFormat chromaFormat, UInt iMaxCUWidth, UInt iMaxCUHeight, UChar uhTotalDepth );
   Void    destroy             ();
   Void    init                ( TEncTop* pcEncTop );
+  Void    init                ( TEncTop* pcEncTop, TEncCtuWorker* pcWorker ); ///< compress with the coding objects of a worker, for pictures compressed in parallel
   Void    resetEncoderDecisions() { m_encCABACTableIdx = I_SLICE; }
 
   /// preparation of slice encoding (reference marking, QP and lambda)
@@ -126,6 +172,7 @@ public:
   Void    compressSlice       ( TComPic* pcPic, const Bool bCompressEntireSlice, const Bool bFastDeltaQP );      ///< analysis stage of slice
   Void    calCostSliceI       ( TComPic* pcPic );
   Void    encodeSlice         ( TComPic* pcPic, TComOutputBitstream* pcSubstreams, UInt &numBinsCoded );
+  Void    printTileStats      ();                                                      ///< print the time spent on each tile by the tile threads
 
   // misc. functions
   Void    setSearchRange      ( TComSlice* pcSlice  );                                  ///< set ME range adaptively
@@ -36,6 +36,45 @@
 */
 #include "TEncTemporalFilter.h"
 #include <math.h>
+#include <atomic>
+
+/** Run jobs 0 .. numJobs-1 on up to numThreads threads, the calling thread included.
+ * \param numThreads  maximum number of threads
+ * \param numJobs     number of jobs
+ * \param job         function running one job
+ */
+static Void runJobs(const Int numThreads, const Int numJobs, const std::function<Void(Int)> &job)
+{
+  const Int numJobThreads = std::min(numThreads, numJobs);
+  if (numJobThreads <= 1)
+  {
+    for (Int i = 0; i < numJobs; i++)
+    {
+      job(i);
+    }
+    return;
+  }
+
+  std::atomic<Int> nextJob(0);
+  auto runNextJobs = [&job, &nextJob, numJobs]()
+  {
+    for (Int i = nextJob++; i < numJobs; i = nextJob++)
+    {
+      job(i);
+    }
+  };
+  std::vector<std::thread> threads;
+  for (Int i = 1; i < numJobThreads; i++)
+  {
+    threads.push_back(std::thread(runNextJobs));
+  }
+  runNextJobs();
+  for (std::size_t i = 0; i < threads.size(); i++)
+  {
+    threads[i].join();
+  }
+}
+
 
 
 // ====================================================================================================================
@@ -96,9 +135,35 @@ TEncTemporalFilter::TEncTemporalFilter() :
   m_GOPSize(0),
   m_framesToBeEncoded(0),
   m_bClipInputVideoToRec709Range(false),
-  m_inputColourSpaceConvert(NUMBER_INPUT_COLOUR_SPACE_CONVERSIONS)
+  m_inputColourSpaceConvert(NUMBER_INPUT_COLOUR_SPACE_CONVERSIONS),
+  m_numThreads(1),
+  m_lookahead(0),
+  m_lookaheadInputPoc(0),
+  m_lookaheadStop(false)
 {}
 
+TEncTemporalFilter::~TEncTemporalFilter()
+{
+  if (m_lookaheadThread.joinable())
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_lookaheadMutex);
+      m_lookaheadStop = true;
+    }
+    m_lookaheadCond.notify_all();
+    m_lookaheadThread.join();
+  }
+  for (std::map<Int, TemporalFilterResult>::iterator it = m_lookaheadResults.begin(); it != m_lookaheadResults.end(); ++it)
+  {
+    if (it->second.filteredPic != NULL)
+    {
+      it->second.filteredPic->destroy();
+      delete it->second.filteredPic;
+    }
+    delete[] it->second.qpMap;
+  }
+}
+
 void TEncTemporalFilter::init(const Int frameSkip,
                               const Int inputBitDepth[MAX_NUM_CHANNEL_TYPE],
                               const Int MSBExtendedBitDepth[MAX_NUM_CHANNEL_TYPE],
@@ -116,6 +181,8 @@ void TEncTemporalFilter::init(const Int frameSkip,
                               const std::map<Int, Double> &temporalFilterStrengths,
                               const Int pastRefs,
                               const Int futureRefs,
+                              const Int numThreads,
+                              const Int lookahead,
                               const Int firstValidFrame,
 #if !JVET_Y0077_BIM
                               const Int lastValidFrame)
@@ -140,7 +207,7 @@ void TEncTemporalFilter::init(const Int frameSkip,
   {
     m_sourcePadding[i] = padding[i];
   }
-  m_framesToBeEncoded = frames; // NOT USED.
+  m_framesToBeEncoded = frames;
   m_bClipInputVideoToRec709Range = Rec709;
   m_inputFileName = filename;
   m_chromaFormatIDC = inputChromaFormatIDC;
@@ -159,6 +226,13 @@ void TEncTemporalFilter::init(const Int frameSkip,
   m_numCTU = ((width + 63) / 64) * ((height + 63) / 64);
   m_ctuAdaptQP = adaptQPmap;
 #endif
+  m_numThreads = std::max(1, numThreads);
+  m_lookahead = std::max(0, lookahead);
+
+  if (m_lookahead > 0)
+  {
+    m_lookaheadThread = std::thread(&TEncTemporalFilter::lookaheadFrames, this);
+  }
 }
 
 // ====================================================================================================================
@@ -167,177 +241,275 @@ void TEncTemporalFilter::init(const Int frameSkip,
 
 Bool TEncTemporalFilter::filter(TComPicYuv *orgPic, Int receivedPoc)
 {
-  Bool isFilterThisFrame = false;
+  if (m_lookahead > 0)
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_lookaheadMutex);
+      m_lookaheadInputPoc = receivedPoc;
+    }
+    m_lookaheadCond.notify_all();
+  }
+
+  if (!isFilteredFrame(receivedPoc))
+  {
+    return false;
+  }
+
+  TemporalFilterResult result;
+  if (m_lookahead > 0)
+  {
+    std::unique_lock<std::mutex> lock(m_lookaheadMutex);
+    m_lookaheadCond.wait(lock, [this, receivedPoc]() { return m_lookaheadResults.count(receivedPoc) > 0; });
+    result = m_lookaheadResults[receivedPoc];
+    m_lookaheadResults.erase(receivedPoc);
+  }
+  else
+  {
+    filterFrame(orgPic, receivedPoc, result);
+  }
+
+#if JVET_Y0077_BIM
+  if (result.qpMap != NULL)
+  {
+    m_ctuAdaptQP->insert({ receivedPoc, result.qpMap });
+  }
+#endif
+  if (result.filteredPic != NULL)
+  {
+    // move filtered to orgPic
+    result.filteredPic->copyToPic(orgPic);
+    result.filteredPic->destroy();
+    delete result.filteredPic;
+  }
+  return true;
+}
+
+// ====================================================================================================================
+// Private member functions
+// ====================================================================================================================
+
+Bool TEncTemporalFilter::isFilteredFrame(const Int receivedPoc) const
+{
   if (m_QP >= 17)  // disable filter for QP < 17
   {
-    for (map<Int, Double>::iterator it = m_temporalFilterStrengths.begin(); it != m_temporalFilterStrengths.end(); ++it)
+    for (map<Int, Double>::const_iterator it = m_temporalFilterStrengths.begin(); it != m_temporalFilterStrengths.end(); ++it)
     {
       Int filteredFrame = it->first;
       if (receivedPoc % filteredFrame == 0)
       {
-        isFilterThisFrame = true;
-        break;
+        return true;
       }
     }
   }
+  return false;
+}
 
-  if (isFilterThisFrame)
-  {
-    const Int currentFilePoc = receivedPoc + m_FrameSkip;
-    const Int firstFrame = std::max(currentFilePoc - m_pastRefs, m_firstValidFrame);
-    const Int lastFrame = std::min(currentFilePoc + m_futureRefs, m_lastValidFrame);
+/** Filter a frame and derive its block importance map.
+ * \param orgPic       frame to be filtered, or NULL to read it from the input file
+ * \param receivedPoc  received POC of the frame
+ * \param result       filtered frame and QP offsets, allocated here
+ * \returns false if the frame could not be read
+ */
+Bool TEncTemporalFilter::filterFrame(const TComPicYuv *orgPic, const Int receivedPoc, TemporalFilterResult &result)
+{
+  const Int currentFilePoc = receivedPoc + m_FrameSkip;
+  const Int firstFrame = std::max(currentFilePoc - m_pastRefs, m_firstValidFrame);
+  const Int lastFrame = std::min(currentFilePoc + m_futureRefs, m_lastValidFrame);
 
-    TVideoIOYuv yuvFrames;
-    yuvFrames.open(m_inputFileName, false, m_inputBitDepth, m_MSBExtendedBitDepth, m_internalBitDepth);
-    yuvFrames.skipFrames(firstFrame, m_sourceWidth - m_sourcePadding[0], m_sourceHeight - m_sourcePadding[1], m_chromaFormatIDC);
+  TVideoIOYuv yuvFrames;
+  yuvFrames.open(m_inputFileName, false, m_inputBitDepth, m_MSBExtendedBitDepth, m_internalBitDepth);
+  yuvFrames.skipFrames(firstFrame, m_sourceWidth - m_sourcePadding[0], m_sourceHeight - m_sourcePadding[1], m_chromaFormatIDC);
 
 
-    std::deque<TemporalFilterSourcePicInfo> srcFrameInfo;
+  std::deque<TemporalFilterSourcePicInfo> srcFrameInfo;
 
-    // subsample original picture so it only needs to be done once
-    TComPicYuv origPadded;
+  // subsample original picture so it only needs to be done once
+  TComPicYuv origPadded;
 
-    origPadded.createWithoutCUInfo(m_sourceWidth, m_sourceHeight, m_chromaFormatIDC, true, s_padding, s_padding);
+  origPadded.createWithoutCUInfo(m_sourceWidth, m_sourceHeight, m_chromaFormatIDC, true, s_padding, s_padding);
+  if (orgPic != NULL)
+  {
     orgPic->copyToPic(&origPadded);
-    origPadded.extendPicBorder();
-
-    TComPicYuv origSubsampled2;
-    TComPicYuv origSubsampled4;
-
-    subsampleLuma(origPadded, origSubsampled2);
-    subsampleLuma(origSubsampled2, origSubsampled4);
+  }
 
-    // determine motion vectors
-    for (Int poc = firstFrame; poc <= lastFrame; poc++)
-    {
-      if (poc == currentFilePoc)
-      { // hop over frame that will be filtered
+  // read the references
+  for (Int poc = firstFrame; poc <= lastFrame; poc++)
+  {
+    if (poc == currentFilePoc)
+    { // hop over frame that will be filtered
+      if (orgPic != NULL)
+      {
         yuvFrames.skipFrames(1, m_sourceWidth - m_sourcePadding[0], m_sourceHeight - m_sourcePadding[1], m_chromaFormatIDC);
-        continue;
       }
-      srcFrameInfo.push_back(TemporalFilterSourcePicInfo());
-      TemporalFilterSourcePicInfo &srcPic=srcFrameInfo.back();
-
-      TComPicYuv     dummyPicBufferTO; // Only used temporary in yuvFrames.read
-      srcPic.picBuffer.createWithoutCUInfo(m_sourceWidth, m_sourceHeight, m_chromaFormatIDC, true, s_padding, s_padding);
-      dummyPicBufferTO.createWithoutCUInfo(m_sourceWidth, m_sourceHeight, m_chromaFormatIDC, true, s_padding, s_padding);
-      if (!yuvFrames.read(&srcPic.picBuffer, &dummyPicBufferTO, m_inputColourSpaceConvert, m_sourcePadding, m_chromaFormatIDC, m_bClipInputVideoToRec709Range))
+      else
       {
-        // eof or read fail
-        srcPic.picBuffer.destroy();
-        srcFrameInfo.pop_back();
-        break;
+        TComPicYuv dummyPicBufferTO;
+        dummyPicBufferTO.createWithoutCUInfo(m_sourceWidth, m_sourceHeight, m_chromaFormatIDC, true, s_padding, s_padding);
+        if (!yuvFrames.read(&origPadded, &dummyPicBufferTO, m_inputColourSpaceConvert, m_sourcePadding, m_chromaFormatIDC, m_bClipInputVideoToRec709Range))
+        {
+          yuvFrames.close();
+          return false;
+        }
       }
-      srcPic.picBuffer.extendPicBorder();
-      srcPic.mvs.allocate(m_sourceWidth / 4, m_sourceHeight / 4);
+      continue;
+    }
+    srcFrameInfo.push_back(TemporalFilterSourcePicInfo());
+    TemporalFilterSourcePicInfo &srcPic=srcFrameInfo.back();
 
-      motionEstimation(srcPic.mvs, origPadded, srcPic.picBuffer, origSubsampled2, origSubsampled4);
-      srcPic.origOffset = poc - currentFilePoc;
+    TComPicYuv     dummyPicBufferTO; // Only used temporary in yuvFrames.read
+    srcPic.picBuffer.createWithoutCUInfo(m_sourceWidth, m_sourceHeight, m_chromaFormatIDC, true, s_padding, s_padding);
+    dummyPicBufferTO.createWithoutCUInfo(m_sourceWidth, m_sourceHeight, m_chromaFormatIDC, true, s_padding, s_padding);
+    if (!yuvFrames.read(&srcPic.picBuffer, &dummyPicBufferTO, m_inputColourSpaceConvert, m_sourcePadding, m_chromaFormatIDC, m_bClipInputVideoToRec709Range))
+    {
+      // eof or read fail
+      srcPic.picBuffer.destroy();
+      srcFrameInfo.pop_back();
+      break;
     }
+    srcPic.picBuffer.extendPicBorder();
+    srcPic.mvs.allocate(m_sourceWidth / 4, m_sourceHeight / 4);
+    srcPic.origOffset = poc - currentFilePoc;
+  }
+  yuvFrames.close();
+
+  origPadded.extendPicBorder();
+
+  TComPicYuv origSubsampled2;
+  TComPicYuv origSubsampled4;
+
+  subsampleLuma(origPadded, origSubsampled2);
+  subsampleLuma(origSubsampled2, origSubsampled4);
+
+  // determine motion vectors, the references on parallel threads and the remaining threads on the block rows of a reference
+  const int numRefs = Int(srcFrameInfo.size());
+  const Int numRefThreads = std::max(1, std::min(m_numThreads, numRefs));
+  const Int numRowThreads = std::max(1, m_numThreads / numRefThreads);
+  runJobs(numRefThreads, numRefs, [&](Int i)
+  {
+    motionEstimation(srcFrameInfo[i].mvs, origPadded, srcFrameInfo[i].picBuffer, origSubsampled2, origSubsampled4, numRowThreads);
+  });
 
-    // filter
-    TComPicYuv newOrgPic;
-    newOrgPic.createWithoutCUInfo(m_sourceWidth, m_sourceHeight, m_chromaFormatIDC, true, s_padding, s_padding);
-    Double overallStrength = -1.0;
-    for (map<Int, Double>::iterator it = m_temporalFilterStrengths.begin(); it != m_temporalFilterStrengths.end(); ++it)
+  // filter
+  Double overallStrength = -1.0;
+  for (map<Int, Double>::const_iterator it = m_temporalFilterStrengths.begin(); it != m_temporalFilterStrengths.end(); ++it)
+  {
+    Int frame = it->first;
+    Double strength = it->second;
+    if (receivedPoc % frame == 0)
     {
-      Int frame = it->first;
-      Double strength = it->second;
-      if (receivedPoc % frame == 0)
-      {
-        overallStrength = strength;
-      }
+      overallStrength = strength;
     }
+  }
 #if JVET_Y0077_BIM
-    const int numRefs = Int(srcFrameInfo.size());
-    if ( m_bimEnabled && ( numRefs > 0 ) )
-    {
-      const Int bimFirstFrame = std::max(currentFilePoc - 2, firstFrame);
-      const Int bimLastFrame = std::min(currentFilePoc + 2, lastFrame);
-      std::vector<Double> sumError(m_numCTU * 2, 0);
-      std::vector<Int>    blkCount(m_numCTU * 2, 0);
+  if ( m_bimEnabled && ( numRefs > 0 ) )
+  {
+    const Int bimFirstFrame = std::max(currentFilePoc - 2, firstFrame);
+    const Int bimLastFrame = std::min(currentFilePoc + 2, lastFrame);
+    std::vector<Double> sumError(m_numCTU * 2, 0);
+    std::vector<Int>    blkCount(m_numCTU * 2, 0);
 
-      int frameIndex = bimFirstFrame - firstFrame;
+    int frameIndex = bimFirstFrame - firstFrame;
 
-      Int distFactor[2] = {3,3};
+    Int distFactor[2] = {3,3};
 
-      Int* qpMap = new Int[m_numCTU];
-      for (int poc = bimFirstFrame; poc <= bimLastFrame; poc++)
+    Int* qpMap = new Int[m_numCTU];
+    for (int poc = bimFirstFrame; poc <= bimLastFrame; poc++)
+    {
+      if ((poc < 0) || (poc == currentFilePoc) || (frameIndex >= numRefs))
       {
-        if ((poc < 0) || (poc == currentFilePoc) || (frameIndex >= numRefs))
-        {
-          continue;
-        }
-        Int dist = abs(poc - currentFilePoc) - 1;
-        distFactor[dist]--;
+        continue;
+      }
+      Int dist = abs(poc - currentFilePoc) - 1;
+      distFactor[dist]--;
 
-        TemporalFilterSourcePicInfo &srcPic = srcFrameInfo.at(frameIndex);
-        for (Int y = 0; y < srcPic.mvs.h() / 2; y++) // going over in 8x8 block steps
+      TemporalFilterSourcePicInfo &srcPic = srcFrameInfo.at(frameIndex);
+      for (Int y = 0; y < srcPic.mvs.h() / 2; y++) // going over in 8x8 block steps
+      {
+        for (Int x = 0; x < srcPic.mvs.w() / 2; x++)
         {
-          for (Int x = 0; x < srcPic.mvs.w() / 2; x++)
-          {
-            Int blocksPerRow = (srcPic.mvs.w() / 2 + 7) / 8;
-            Int ctuX = x / 8;
-            Int ctuY = y / 8;
-            Int ctuId = ctuY * blocksPerRow + ctuX;
-            sumError[dist * m_numCTU + ctuId] += srcPic.mvs.get(x, y).error;
-            blkCount[dist * m_numCTU + ctuId] += 1;
-          }
+          Int blocksPerRow = (srcPic.mvs.w() / 2 + 7) / 8;
+          Int ctuX = x / 8;
+          Int ctuY = y / 8;
+          Int ctuId = ctuY * blocksPerRow + ctuX;
+          sumError[dist * m_numCTU + ctuId] += srcPic.mvs.get(x, y).error;
+          blkCount[dist * m_numCTU + ctuId] += 1;
         }
-        frameIndex++;
       }
-      Double weight = (receivedPoc % 16) ? 0.6 : 1;
-      const Double center = 45.0;
-      for (Int i = 0; i < m_numCTU; i++)
+      frameIndex++;
+    }
+    Double weight = (receivedPoc % 16) ? 0.6 : 1;
+    const Double center = 45.0;
+    for (Int i = 0; i < m_numCTU; i++)
+    {
+      Int avgErrD1 = (Int)((sumError[i] / blkCount[i]) * distFactor[0]);
+      Int avgErrD2 = (Int)((sumError[i + m_numCTU] / blkCount[i + m_numCTU]) * distFactor[1]);
+      Int weightedErr = std::max(avgErrD1, avgErrD2) + abs(avgErrD2 - avgErrD1) * 3;
+      weightedErr = (Int)(weightedErr * weight + (1 - weight) * center);
+      if (weightedErr > s_cuTreeThresh[0])
       {
-        Int avgErrD1 = (Int)((sumError[i] / blkCount[i]) * distFactor[0]);
-        Int avgErrD2 = (Int)((sumError[i + m_numCTU] / blkCount[i + m_numCTU]) * distFactor[1]);
-        Int weightedErr = std::max(avgErrD1, avgErrD2) + abs(avgErrD2 - avgErrD1) * 3;
-        weightedErr = (Int)(weightedErr * weight + (1 - weight) * center);
-        if (weightedErr > s_cuTreeThresh[0])
-        {
-          qpMap[i] = 2;
-        }
-        else if (weightedErr > s_cuTreeThresh[1])
-        {
-          qpMap[i] = 1;
-        }
-        else if (weightedErr < s_cuTreeThresh[3])
-        {
-          qpMap[i] = -2;
-        }
-        else if (weightedErr < s_cuTreeThresh[2])
-        {
-          qpMap[i] = -1;
-        }
-        else
-        {
-          qpMap[i] = 0;
-        }
+        qpMap[i] = 2;
+      }
+      else if (weightedErr > s_cuTreeThresh[1])
+      {
+        qpMap[i] = 1;
+      }
+      else if (weightedErr < s_cuTreeThresh[3])
+      {
+        qpMap[i] = -2;
+      }
+      else if (weightedErr < s_cuTreeThresh[2])
+      {
+        qpMap[i] = -1;
+      }
+      else
+      {
+        qpMap[i] = 0;
       }
-      m_ctuAdaptQP->insert({ receivedPoc, qpMap });
     }
+    result.qpMap = qpMap;
+  }
 
-    if ( m_mctfEnabled && ( numRefs > 0 ) )
-    {
+  if ( m_mctfEnabled && ( numRefs > 0 ) )
+  {
 #endif
-    bilateralFilter(origPadded, srcFrameInfo, newOrgPic, overallStrength);
-
-    // move filtered to orgPic
-    newOrgPic.copyToPic(orgPic);
+  result.filteredPic = new TComPicYuv;
+  result.filteredPic->createWithoutCUInfo(m_sourceWidth, m_sourceHeight, m_chromaFormatIDC, true, s_padding, s_padding);
+  bilateralFilter(origPadded, srcFrameInfo, *result.filteredPic, overallStrength);
 #if JVET_Y0077_BIM
-    }
+  }
 #endif
 
-    yuvFrames.close();
-    return true;
-  }
-  return false;
+  return true;
 }
 
-// ====================================================================================================================
-// Private member functions
-// ====================================================================================================================
+/** Filter the frames ahead of the input frame on a background thread, until the destructor stops it.
+ */
+Void TEncTemporalFilter::lookaheadFrames()
+{
+  for (Int receivedPoc = 0; receivedPoc < m_framesToBeEncoded; receivedPoc++)
+  {
+    if (!isFilteredFrame(receivedPoc))
+    {
+      continue;
+    }
+    {
+      std::unique_lock<std::mutex> lock(m_lookaheadMutex);
+      m_lookaheadCond.wait(lock, [this, receivedPoc]() { return m_lookaheadStop || receivedPoc <= m_lookaheadInputPoc + m_lookahead; });
+      if (m_lookaheadStop)
+      {
+        return;
+      }
+    }
+
+    TemporalFilterResult result;
+    filterFrame(NULL, receivedPoc, result);
+    {
+      std::lock_guard<std::mutex> lock(m_lookaheadMutex);
+      m_lookaheadResults[receivedPoc] = result;
+    }
+    m_lookaheadCond.notify_all();
+  }
+}
 
 Void TEncTemporalFilter::subsampleLuma(const TComPicYuv &input, TComPicYuv &output, const Int factor) const
 {
@@ -381,10 +553,15 @@ Int TEncTemporalFilter::motionErrorLuma(const TComPicYuv &orig,
   const Pel *buffOrigin = buffer.getAddr(COMPONENT_Y);
   const Int buffStride  = buffer.getStride(COMPONENT_Y);
   Int error = 0;// dx * 10 + dy * 10;
+  const Bool useKernel = (bs & 7) == 0 && bs <= 64 && m_internalBitDepth[CHANNEL_TYPE_LUMA] <= 10;
   if (((dx | dy) & 0xF) == 0)
   {
     dx /= s_motionVectorFactor;
     dy /= s_motionVectorFactor;
+    if (useKernel && m_kernels.m_motionErrorFullPel != NULL)
+    {
+      return m_kernels.m_motionErrorFullPel(origOrigin + y*origStride + x, origStride, buffOrigin + (y+dy)*buffStride + (x+dx), buffStride, bs, besterror);
+    }
     for (Int y1 = 0; y1 < bs; y1++)
     {
       const Pel* origRowStart = origOrigin + (y+y1)*origStride + x;
@@ -406,6 +583,11 @@ Int TEncTemporalFilter::motionErrorLuma(const TComPicYuv &orig,
   {
     const Int *xFilter = s_interpolationFilter[dx & 0xF];
     const Int *yFilter = s_interpolationFilter[dy & 0xF];
+    if (useKernel && m_kernels.m_motionErrorFracPel != NULL)
+    {
+      return m_kernels.m_motionErrorFracPel(origOrigin + y*origStride + x, origStride, buffOrigin + (y + (dy >> 4) - 3)*buffStride + x + (dx >> 4) - 3, buffStride, bs,
+                                            xFilter, yFilter, (1<<m_internalBitDepth[CHANNEL_TYPE_LUMA])-1, besterror);
+    }
     Int tempArray[64 + 8][64];
 
     Int iSum, iBase;
@@ -458,161 +640,195 @@ Int TEncTemporalFilter::motionErrorLuma(const TComPicYuv &orig,
   return error;
 }
 
-Void TEncTemporalFilter::motionEstimationLuma(Array2D<MotionVector> &mvs, const TComPicYuv &orig, const TComPicYuv &buffer, const Int blockSize,
-    const Array2D<MotionVector> *previous, const Int factor, const Bool doubleRes) const
+Void TEncTemporalFilter::motionEstimationBlock(Array2D<MotionVector> &mvs, const TComPicYuv &orig, const TComPicYuv &buffer, const Int blockSize,
+    const Array2D<MotionVector> *previous, const Int factor, const Bool doubleRes, const Int blockX, const Int blockY) const
 {
 #if JVET_V0056_MCTF || JVET_Y0077_BIM
-  Int range = doubleRes ? 0 : 5;
+  const Int range = previous == NULL ? 8 : (doubleRes ? 0 : 5);
 #else
-  Int range = 5;
+  const Int range = previous == NULL ? 8 : 5;
 #endif
   const Int stepSize = blockSize;
 
   const Int origWidth  = orig.getWidth(COMPONENT_Y);
   const Int origHeight = orig.getHeight(COMPONENT_Y);
 
-#if JVET_V0056_MCTF || JVET_Y0077_BIM
-  for (Int blockY = 0; blockY + blockSize <= origHeight; blockY += stepSize)
-  {
-    for (Int blockX = 0; blockX + blockSize <= origWidth; blockX += stepSize)
-#else
-  for (Int blockY = 0; blockY + blockSize < origHeight; blockY += stepSize)
-  {
-    for (Int blockX = 0; blockX + blockSize < origWidth; blockX += stepSize)
-#endif
-    {
-      MotionVector best;
+  MotionVector best;
 
-      if (previous == NULL)
-      {
-        range = 8;
-      }
-      else
-      {
+  if (previous != NULL)
+  {
 #if JVET_V0056_MCTF || JVET_Y0077_BIM
-        for (Int py = -1; py <= 1; py++)
+    for (Int py = -1; py <= 1; py++)
 #else
-        for (Int py = -2; py <= 2; py++)
+    for (Int py = -2; py <= 2; py++)
 #endif
-        {
-          Int testy = blockY / (2 * blockSize) + py;
+    {
+      Int testy = blockY / (2 * blockSize) + py;
 #if JVET_V0056_MCTF || JVET_Y0077_BIM
-          for (Int px = -1; px <= 1; px++)
+      for (Int px = -1; px <= 1; px++)
 #else
-          for (Int px = -2; px <= 2; px++)
-#endif
-          {
-            Int testx = blockX / (2 * blockSize) + px;
-            if ((testx >= 0) && (testx < origWidth / (2 * blockSize)) && (testy >= 0) && (testy < origHeight / (2 * blockSize)))
-            {
-              MotionVector old = previous->get(testx, testy);
-              Int error = motionErrorLuma(orig, buffer, blockX, blockY, old.x * factor, old.y * factor, blockSize, best.error);
-              if (error < best.error)
-              {
-                best.set(old.x * factor, old.y * factor, error);
-              }
-            }
-          }
-        }
-#if JVET_V0056_MCTF || JVET_Y0077_BIM
-        Int error = motionErrorLuma(orig, buffer, blockX, blockY, 0, 0, blockSize, best.error);
-        if (error < best.error)
-        {
-          best.set(0, 0, error);
-        }
+      for (Int px = -2; px <= 2; px++)
 #endif
-      }
-      MotionVector prevBest = best;
-      for (Int y2 = prevBest.y / s_motionVectorFactor - range; y2 <= prevBest.y / s_motionVectorFactor + range; y2++)
       {
-        for (Int x2 = prevBest.x / s_motionVectorFactor - range; x2 <= prevBest.x / s_motionVectorFactor + range; x2++)
+        Int testx = blockX / (2 * blockSize) + px;
+        if ((testx >= 0) && (testx < origWidth / (2 * blockSize)) && (testy >= 0) && (testy < origHeight / (2 * blockSize)))
         {
-          Int error = motionErrorLuma(orig, buffer, blockX, blockY, x2 * s_motionVectorFactor, y2 * s_motionVectorFactor, blockSize, best.error);
+          MotionVector old = previous->get(testx, testy);
+          Int error = motionErrorLuma(orig, buffer, blockX, blockY, old.x * factor, old.y * factor, blockSize, best.error);
           if (error < best.error)
           {
-            best.set(x2 * s_motionVectorFactor, y2 * s_motionVectorFactor, error);
-          }
-        }
-      }
-      if (doubleRes)
-      { // merge into one loop, probably with precision array (here [12, 3] or maybe [4, 1]) with setable number of iterations
-        prevBest = best;
-        Int doubleRange = 3 * 4;
-        for (Int y2 = prevBest.y - doubleRange; y2 <= prevBest.y + doubleRange; y2 += 4)
-        {
-          for (Int x2 = prevBest.x - doubleRange; x2 <= prevBest.x + doubleRange; x2 += 4)
-          {
-            Int error = motionErrorLuma(orig, buffer, blockX, blockY, x2, y2, blockSize, best.error);
-            if (error < best.error)
-            {
-              best.set(x2, y2, error);
-            }
-          }
-        }
-
-        prevBest = best;
-        doubleRange = 3;
-        for (Int y2 = prevBest.y - doubleRange; y2 <= prevBest.y + doubleRange; y2++)
-        {
-          for (Int x2 = prevBest.x - doubleRange; x2 <= prevBest.x + doubleRange; x2++)
-          {
-            Int error = motionErrorLuma(orig, buffer, blockX, blockY, x2, y2, blockSize, best.error);
-            if (error < best.error)
-            {
-              best.set(x2, y2, error);
-            }
+            best.set(old.x * factor, old.y * factor, error);
           }
         }
       }
+    }
 #if JVET_V0056_MCTF || JVET_Y0077_BIM
-      if (blockY > 0)
+    Int error = motionErrorLuma(orig, buffer, blockX, blockY, 0, 0, blockSize, best.error);
+    if (error < best.error)
+    {
+      best.set(0, 0, error);
+    }
+#endif
+  }
+  MotionVector prevBest = best;
+  for (Int y2 = prevBest.y / s_motionVectorFactor - range; y2 <= prevBest.y / s_motionVectorFactor + range; y2++)
+  {
+    for (Int x2 = prevBest.x / s_motionVectorFactor - range; x2 <= prevBest.x / s_motionVectorFactor + range; x2++)
+    {
+      Int error = motionErrorLuma(orig, buffer, blockX, blockY, x2 * s_motionVectorFactor, y2 * s_motionVectorFactor, blockSize, best.error);
+      if (error < best.error)
       {
-        MotionVector aboveMV = mvs.get(blockX / stepSize, (blockY - stepSize) / stepSize);
-        int error = motionErrorLuma(orig, buffer, blockX, blockY, aboveMV.x, aboveMV.y, blockSize, best.error);
-        if (error < best.error)
-        {
-          best.set(aboveMV.x, aboveMV.y, error);
-        }
+        best.set(x2 * s_motionVectorFactor, y2 * s_motionVectorFactor, error);
       }
-      if (blockX > 0)
+    }
+  }
+  if (doubleRes)
+  { // merge into one loop, probably with precision array (here [12, 3] or maybe [4, 1]) with setable number of iterations
+    prevBest = best;
+    Int doubleRange = 3 * 4;
+    for (Int y2 = prevBest.y - doubleRange; y2 <= prevBest.y + doubleRange; y2 += 4)
+    {
+      for (Int x2 = prevBest.x - doubleRange; x2 <= prevBest.x + doubleRange; x2 += 4)
       {
-        MotionVector leftMV = mvs.get((blockX - stepSize) / stepSize, blockY / stepSize);
-        int error = motionErrorLuma(orig, buffer, blockX, blockY, leftMV.x, leftMV.y, blockSize, best.error);
+        Int error = motionErrorLuma(orig, buffer, blockX, blockY, x2, y2, blockSize, best.error);
         if (error < best.error)
         {
-          best.set(leftMV.x, leftMV.y, error);
+          best.set(x2, y2, error);
         }
       }
+    }
 
-      // calculate average
-      double avg = 0.0;
-      for (int x1 = 0; x1 < blockSize; x1++)
+    prevBest = best;
+    doubleRange = 3;
+    for (Int y2 = prevBest.y - doubleRange; y2 <= prevBest.y + doubleRange; y2++)
+    {
+      for (Int x2 = prevBest.x - doubleRange; x2 <= prevBest.x + doubleRange; x2++)
       {
-        for (int y1 = 0; y1 < blockSize; y1++)
+        Int error = motionErrorLuma(orig, buffer, blockX, blockY, x2, y2, blockSize, best.error);
+        if (error < best.error)
         {
-          avg = avg + *(orig.getAddr(COMPONENT_Y) + (blockX + x1 + orig.getStride(COMPONENT_Y) * (blockY + y1)));
+          best.set(x2, y2, error);
         }
       }
-      avg = avg / (blockSize * blockSize);
+    }
+  }
+#if JVET_V0056_MCTF || JVET_Y0077_BIM
+  if (blockY > 0)
+  {
+    MotionVector aboveMV = mvs.get(blockX / stepSize, (blockY - stepSize) / stepSize);
+    int error = motionErrorLuma(orig, buffer, blockX, blockY, aboveMV.x, aboveMV.y, blockSize, best.error);
+    if (error < best.error)
+    {
+      best.set(aboveMV.x, aboveMV.y, error);
+    }
+  }
+  if (blockX > 0)
+  {
+    MotionVector leftMV = mvs.get((blockX - stepSize) / stepSize, blockY / stepSize);
+    int error = motionErrorLuma(orig, buffer, blockX, blockY, leftMV.x, leftMV.y, blockSize, best.error);
+    if (error < best.error)
+    {
+      best.set(leftMV.x, leftMV.y, error);
+    }
+  }
+
+  // calculate average
+  double avg = 0.0;
+  for (int x1 = 0; x1 < blockSize; x1++)
+  {
+    for (int y1 = 0; y1 < blockSize; y1++)
+    {
+      avg = avg + *(orig.getAddr(COMPONENT_Y) + (blockX + x1 + orig.getStride(COMPONENT_Y) * (blockY + y1)));
+    }
+  }
+  avg = avg / (blockSize * blockSize);
+
+  // calculate variance
+  double variance = 0;
+  for (int x1 = 0; x1 < blockSize; x1++)
+  {
+    for (int y1 = 0; y1 < blockSize; y1++)
+    {
+      int pix = *(orig.getAddr(COMPONENT_Y) + (blockX + x1 + orig.getStride(COMPONENT_Y) * (blockY + y1)));
+      variance = variance + (pix - avg) * (pix - avg);
+    }
+  }
+  best.error = (Int) (20 * ((best.error + 5.0) / (variance + 5.0)) + (best.error / (blockSize * blockSize)) / 50);
+#endif
+  mvs.get(blockX / stepSize, blockY / stepSize) = best;
+}
+
+/** Estimate the motion of the blocks of a picture. With several threads, the block rows are processed as a wavefront:
+ * a block uses the vector of the block above, so it waits until that block is done.
+ */
+Void TEncTemporalFilter::motionEstimationLuma(Array2D<MotionVector> &mvs, const TComPicYuv &orig, const TComPicYuv &buffer, const Int blockSize,
+    const Array2D<MotionVector> *previous, const Int factor, const Bool doubleRes, const Int numThreads) const
+{
+  const Int origWidth  = orig.getWidth(COMPONENT_Y);
+  const Int origHeight = orig.getHeight(COMPONENT_Y);
+#if JVET_V0056_MCTF || JVET_Y0077_BIM
+  const Int numBlocksX = origWidth / blockSize;
+  const Int numBlocksY = origHeight / blockSize;
+#else
+  const Int numBlocksX = (origWidth - 1) / blockSize;
+  const Int numBlocksY = (origHeight - 1) / blockSize;
+#endif
 
-      // calculate variance
-      double variance = 0;
-      for (int x1 = 0; x1 < blockSize; x1++)
+  if (numThreads <= 1 || numBlocksY <= 1)
+  {
+    for (Int blockY = 0; blockY < numBlocksY; blockY++)
+    {
+      for (Int blockX = 0; blockX < numBlocksX; blockX++)
       {
-        for (int y1 = 0; y1 < blockSize; y1++)
-        {
-          int pix = *(orig.getAddr(COMPONENT_Y) + (blockX + x1 + orig.getStride(COMPONENT_Y) * (blockY + y1)));
-          variance = variance + (pix - avg) * (pix - avg);
-        }
+        motionEstimationBlock(mvs, orig, buffer, blockSize, previous, factor, doubleRes, blockX * blockSize, blockY * blockSize);
       }
-      best.error = (Int) (20 * ((best.error + 5.0) / (variance + 5.0)) + (best.error / (blockSize * blockSize)) / 50);
-#endif
-      mvs.get(blockX / stepSize, blockY / stepSize) = best;
     }
+    return;
   }
+
+  std::mutex              progressMutex;
+  std::condition_variable progressCond;
+  std::vector<Int>        numBlocksDone(numBlocksY, 0);
+  runJobs(numThreads, numBlocksY, [&](Int blockY)
+  {
+    for (Int blockX = 0; blockX < numBlocksX; blockX++)
+    {
+      if (blockY > 0)
+      {
+        std::unique_lock<std::mutex> lock(progressMutex);
+        progressCond.wait(lock, [&]() { return numBlocksDone[blockY - 1] > blockX; });
+      }
+      motionEstimationBlock(mvs, orig, buffer, blockSize, previous, factor, doubleRes, blockX * blockSize, blockY * blockSize);
+      {
+        std::lock_guard<std::mutex> lock(progressMutex);
+        numBlocksDone[blockY] = blockX + 1;
+      }
+      progressCond.notify_all();
+    }
+  });
 }
 
-Void TEncTemporalFilter::motionEstimation(Array2D<MotionVector> &mv, const TComPicYuv &orgPic, const TComPicYuv &buffer, const TComPicYuv &origSubsampled2, const TComPicYuv &origSubsampled4) const
+Void TEncTemporalFilter::motionEstimation(Array2D<MotionVector> &mv, const TComPicYuv &orgPic, const TComPicYuv &buffer, const TComPicYuv &origSubsampled2, const TComPicYuv &origSubsampled4, const Int numThreads) const
 {
   const Int width = m_sourceWidth;
   const Int height = m_sourceHeight;
@@ -626,11 +842,11 @@ Void TEncTemporalFilter::motionEstimation(Array2D<MotionVector> &mv, const TComP
   subsampleLuma(buffer, bufferSub2);
   subsampleLuma(bufferSub2, bufferSub4);
 
-  motionEstimationLuma(mv_0, origSubsampled4, bufferSub4, 16);
-  motionEstimationLuma(mv_1, origSubsampled2, bufferSub2, 16, &mv_0, 2);
-  motionEstimationLuma(mv_2, orgPic, buffer, 16, &mv_1, 2);
+  motionEstimationLuma(mv_0, origSubsampled4, bufferSub4, 16, NULL, 1, false, numThreads);
+  motionEstimationLuma(mv_1, origSubsampled2, bufferSub2, 16, &mv_0, 2, false, numThreads);
+  motionEstimationLuma(mv_2, orgPic, buffer, 16, &mv_1, 2, false, numThreads);
 
-  motionEstimationLuma(mv, orgPic, buffer, 8, &mv_2, 1, true);
+  motionEstimationLuma(mv, orgPic, buffer, 8, &mv_2, 1, true, numThreads);
 }
 
 Void TEncTemporalFilter::applyMotion(const Array2D<MotionVector> &mvs, const TComPicYuv &input, TComPicYuv &output) const
@@ -729,11 +945,11 @@ Void TEncTemporalFilter::bilateralFilter(const TComPicYuv &orgPic,
 {
   const int numRefs = Int(srcFrameInfo.size());
   std::vector<TComPicYuv> correctedPics(numRefs);
-  for (Int i = 0; i < numRefs; i++)
+  runJobs(m_numThreads, numRefs, [&](Int i)
   {
     correctedPics[i].createWithoutCUInfo( m_sourceWidth, m_sourceHeight, orgPic.getChromaFormat(), true, s_padding, s_padding );
     applyMotion(srcFrameInfo[i].mvs, srcFrameInfo[i].picBuffer, correctedPics[i]);
-  }
+  });
 
   const Int refStrengthRow = m_futureRefs > 0 ? 0 : 1;
 
@@ -745,113 +961,150 @@ Void TEncTemporalFilter::bilateralFilter(const TComPicYuv &orgPic,
     const ComponentID compID=(ComponentID)c;
     const Int height = orgPic.getHeight(compID);
     const Int width  = orgPic.getWidth(compID);
-    const Pel *srcPelRow = orgPic.getAddr(compID);
     const Int srcStride = orgPic.getStride(compID);
-          Pel *dstPelRow = newOrgPic.getAddr(compID);
     const Int dstStride = newOrgPic.getStride(compID);
     const Double sigmaSq = isChroma(compID)? chromaSigmaSq : lumaSigmaSq;
     const Double weightScaling = overallStrength * (isChroma(compID) ? s_chromaFactor : 0.4);
     const Pel maxSampleValue = (1<<m_internalBitDepth[toChannelType(compID)])-1;
     const Double bitDepthDiffWeighting=1024.0 / (maxSampleValue+1);
-#if JVET_V0056_MCTF || JVET_Y0077_BIM
     static const Int lumaBlockSize=8;    
     const Int csx=getComponentScaleX(compID, m_chromaFormatIDC);
     const Int csy=getComponentScaleY(compID, m_chromaFormatIDC);
     const Int blkSizeX = lumaBlockSize>>csx;
     const Int blkSizeY = lumaBlockSize>>csy;    
-#endif
+    const Bool useKernel = (blkSizeX == 4 || blkSizeX == 8) && m_internalBitDepth[toChannelType(compID)] <= 10 && m_kernels.m_blockNoiseStatistics != NULL;
 
-    for (Int y = 0; y < height; y++, srcPelRow+=srcStride, dstPelRow+=dstStride)
+    // exp() of the weighting only depends on the absolute difference to the reference sample and, with
+    // JVET_V0056_MCTF, on the noise and error class of the block: look it up instead of calling exp() per sample
+#if JVET_V0056_MCTF || JVET_Y0077_BIM
+    static const Int numSigmaWeights = 4;
+#else
+    static const Int numSigmaWeights = 1;
+#endif
+    std::vector<Double> expWeights[numSigmaWeights];
+    for (Int swIdx = 0; swIdx < numSigmaWeights; swIdx++)
     {
-      const Pel *srcPel=srcPelRow;
-            Pel *dstPel=dstPelRow;
-      for (Int x = 0; x < width; x++, srcPel++, dstPel++)
+      expWeights[swIdx].resize(maxSampleValue + 1);
+      for (Int absDiff = 0; absDiff <= maxSampleValue; absDiff++)
       {
-        const Int orgVal = (Int) *srcPel;
-        Double temporalWeightSum = 1.0;
-        Double newVal = (Double) orgVal;
+        Double diff = (Double)absDiff;
+        diff *= bitDepthDiffWeighting;
+        Double diffSq = diff * diff;
 #if JVET_V0056_MCTF || JVET_Y0077_BIM
-        if ((y % blkSizeY == 0) && (x % blkSizeX == 0))
+        Double sw = 1;
+        sw *= (swIdx < 2) ? 1.3 : 0.8;
+        sw *= (swIdx & 1) ? 1 : 1.3;
+        expWeights[swIdx][absDiff] = exp(-diffSq / (2 * sw * sigmaSq));
+#else
+        expWeights[swIdx][absDiff] = exp(-diffSq / (2 * sigmaSq));
+#endif
+      }
+    }
+
+    // the block rows are independent: the noise of a block is derived at its top-left sample
+    const Int numBlockRows = (height + blkSizeY - 1) / blkSizeY;
+    runJobs(m_numThreads, numBlockRows, [&](Int blockRow)
+    {
+      const Int yStart = blockRow * blkSizeY;
+      const Int yEnd   = std::min(height, yStart + blkSizeY);
+      const Pel *srcPelRow = orgPic.getAddr(compID) + yStart * srcStride;
+            Pel *dstPelRow = newOrgPic.getAddr(compID) + yStart * dstStride;
+      for (Int y = yStart; y < yEnd; y++, srcPelRow+=srcStride, dstPelRow+=dstStride)
+      {
+        const Pel *srcPel=srcPelRow;
+              Pel *dstPel=dstPelRow;
+        for (Int x = 0; x < width; x++, srcPel++, dstPel++)
         {
-          for (Int i = 0; i < numRefs; i++)
+          const Int orgVal = (Int) *srcPel;
+          Double temporalWeightSum = 1.0;
+          Double newVal = (Double) orgVal;
+#if JVET_V0056_MCTF || JVET_Y0077_BIM
+          if ((y % blkSizeY == 0) && (x % blkSizeX == 0))
           {
-            Double variance = 0, diffsum = 0;
-            const ptrdiff_t refStride = correctedPics[i].getStride(compID);
-            const Pel *refPel = correctedPics[i].getAddr(compID) + y * refStride + x;
-
-            for (Int y1 = 0; y1 < blkSizeY; y1++)
+            for (Int i = 0; i < numRefs; i++)
             {
-              for (Int x1 = 0; x1 < blkSizeX; x1++)
-              {
-                const Pel pix  = *(srcPel + srcStride * y1 + x1);
-                const Pel ref  = *(refPel + refStride * y1 + x1);
-                const Int diff = pix - ref;
+              Double variance = 0, diffsum = 0;
+              const ptrdiff_t refStride = correctedPics[i].getStride(compID);
+              const Pel *refPel = correctedPics[i].getAddr(compID) + y * refStride + x;
 
-                variance += diff * diff;
-
-                if (x1 != blkSizeX - 1)
-                {
-                  const Pel pixR  = *(srcPel + srcStride * y1 + x1 + 1);
-                  const Pel refR  = *(refPel + refStride * y1 + x1 + 1);
-                  const Int diffR = pixR - refR;
-                  diffsum += (diffR - diff) * (diffR - diff);
-                }
-                if (y1 != blkSizeY - 1)
+              if (useKernel)
+              {
+                m_kernels.m_blockNoiseStatistics(srcPel, srcStride, refPel, Int(refStride), blkSizeX, blkSizeY, variance, diffsum);
+              }
+              else
+              {
+                for (Int y1 = 0; y1 < blkSizeY; y1++)
                 {
-                  const Pel pixD  = *(srcPel + srcStride * y1 + x1 + srcStride);
-                  const Pel refD  = *(refPel + refStride * y1 + x1 + refStride);
-                  const Int diffD = pixD - refD;
-                  diffsum += (diffD - diff) * (diffD - diff);
+                  for (Int x1 = 0; x1 < blkSizeX; x1++)
+                  {
+                    const Pel pix  = *(srcPel + srcStride * y1 + x1);
+                    const Pel ref  = *(refPel + refStride * y1 + x1);
+                    const Int diff = pix - ref;
+
+                    variance += diff * diff;
+
+                    if (x1 != blkSizeX - 1)
+                    {
+                      const Pel pixR  = *(srcPel + srcStride * y1 + x1 + 1);
+                      const Pel refR  = *(refPel + refStride * y1 + x1 + 1);
+                      const Int diffR = pixR - refR;
+                      diffsum += (diffR - diff) * (diffR - diff);
+                    }
+                    if (y1 != blkSizeY - 1)
+                    {
+                      const Pel pixD  = *(srcPel + srcStride * y1 + x1 + srcStride);
+                      const Pel refD  = *(refPel + refStride * y1 + x1 + refStride);
+                      const Int diffD = pixD - refD;
+                      diffsum += (diffD - diff) * (diffD - diff);
+                    }
+                  }
                 }
               }
-            }
 
-            const int cntV = blkSizeX * blkSizeY;
-            const int cntD = 2 * cntV - blkSizeX - blkSizeY;
-            srcFrameInfo[i].mvs.get(x / blkSizeX, y / blkSizeY).noise =
-              (int) round((15.0 * cntD / cntV * variance + 5.0) / (diffsum + 5.0));
+              const int cntV = blkSizeX * blkSizeY;
+              const int cntD = 2 * cntV - blkSizeX - blkSizeY;
+              srcFrameInfo[i].mvs.get(x / blkSizeX, y / blkSizeY).noise =
+                (int) round((15.0 * cntD / cntV * variance + 5.0) / (diffsum + 5.0));
+            }
           }
-        }
 
-        Double minError = 9999999;
-        for (Int i = 0; i < numRefs; i++)
-        {
-          minError = std::min(minError, (Double) srcFrameInfo[i].mvs.get(x / blkSizeX, y / blkSizeY).error);
-        }
+          Double minError = 9999999;
+          for (Int i = 0; i < numRefs; i++)
+          {
+            minError = std::min(minError, (Double) srcFrameInfo[i].mvs.get(x / blkSizeX, y / blkSizeY).error);
+          }
 #endif
-        for (Int i = 0; i < numRefs; i++)
-        {
+          for (Int i = 0; i < numRefs; i++)
+          {
 #if JVET_V0056_MCTF || JVET_Y0077_BIM
-          const Int error = srcFrameInfo[i].mvs.get(x / blkSizeX, y / blkSizeY).error;
-          const Int noise = srcFrameInfo[i].mvs.get(x / blkSizeX, y / blkSizeY).noise;
+            const Int error = srcFrameInfo[i].mvs.get(x / blkSizeX, y / blkSizeY).error;
+            const Int noise = srcFrameInfo[i].mvs.get(x / blkSizeX, y / blkSizeY).noise;
 #endif
-          const Pel *pCorrectedPelPtr=correctedPics[i].getAddr(compID)+(y*correctedPics[i].getStride(compID)+x);
-          const Int refVal = (Int) *pCorrectedPelPtr;
-          Double diff = (Double)(refVal - orgVal);
-          diff *= bitDepthDiffWeighting;
-          Double diffSq = diff * diff;
+            const Pel *pCorrectedPelPtr=correctedPics[i].getAddr(compID)+(y*correctedPics[i].getStride(compID)+x);
+            const Int refVal = (Int) *pCorrectedPelPtr;
+            const Int absDiff = std::abs(refVal - orgVal);
 #if JVET_V0056_MCTF || JVET_Y0077_BIM
-          const Int index = std::min(3, std::abs(srcFrameInfo[i].origOffset) - 1);
-          Double ww = 1, sw = 1;
-          ww *= (noise < 25) ? 1 : 1.2;
-          sw *= (noise < 25) ? 1.3 : 0.8;
-          ww *= (error < 50) ? 1.2 : ((error > 100) ? 0.8 : 1);
-          sw *= (error < 50) ? 1.3 : 1;
-          ww *= ((minError + 1) / (error + 1));
-          const Double weight = weightScaling * s_refStrengths[refStrengthRow][index] * ww * exp(-diffSq / (2 * sw * sigmaSq));
+            const Int index = std::min(3, std::abs(srcFrameInfo[i].origOffset) - 1);
+            Double ww = 1;
+            ww *= (noise < 25) ? 1 : 1.2;
+            ww *= (error < 50) ? 1.2 : ((error > 100) ? 0.8 : 1);
+            ww *= ((minError + 1) / (error + 1));
+            const Int swIdx = ((noise < 25) ? 0 : 2) + ((error < 50) ? 0 : 1);
+            const Double weight = weightScaling * s_refStrengths[refStrengthRow][index] * ww * expWeights[swIdx][absDiff];
 #else
-          const Int index = std::min(1, std::abs(srcFrameInfo[i].origOffset) - 1);
-          const Double weight = weightScaling * s_refStrengths[refStrengthRow][index] * exp(-diffSq / (2 * sigmaSq));
+            const Int index = std::min(1, std::abs(srcFrameInfo[i].origOffset) - 1);
+            const Double weight = weightScaling * s_refStrengths[refStrengthRow][index] * expWeights[0][absDiff];
 #endif
-          newVal += weight * refVal;
-          temporalWeightSum += weight;
+            newVal += weight * refVal;
+            temporalWeightSum += weight;
+          }
+          newVal /= temporalWeightSum;
+          Pel sampleVal = (Pel)round(newVal);
+          sampleVal=(sampleVal<0?0 : (sampleVal>maxSampleValue ? maxSampleValue : sampleVal));
+          *dstPel = sampleVal;
         }
-        newVal /= temporalWeightSum;
-        Pel sampleVal = (Pel)round(newVal);
-        sampleVal=(sampleVal<0?0 : (sampleVal>maxSampleValue ? maxSampleValue : sampleVal));
-        *dstPel = sampleVal;
       }
-    }
+    });
   }
 }
 
@@ -38,10 +38,15 @@
 #ifndef __TEMPORAL_FILTER__
 #define __TEMPORAL_FILTER__
 #include "TLibCommon/TComPicYuv.h"
+#include "TLibCommon/TComTemporalFilterKernels.h"
 #include "Utilities/TVideoIOYuv.h"
 #include <sstream>
 #include <map>
 #include <deque>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
 
  //! \ingroup EncoderLib
  //! \{
@@ -102,6 +107,13 @@ struct TemporalFilterSourcePicInfo
   Int                   origOffset;
 };
 
+struct TemporalFilterResult
+{
+  TemporalFilterResult() : filteredPic(NULL), qpMap(NULL) { }
+  TComPicYuv *filteredPic;  ///< filtered picture, NULL if the picture is not changed
+  Int        *qpMap;        ///< QP offsets of the CTUs from block importance mapping, NULL if not used
+};
+
 // ====================================================================================================================
 // Class definition
 // ====================================================================================================================
@@ -110,7 +122,7 @@ class TEncTemporalFilter
 {
 public:
    TEncTemporalFilter();
-  ~TEncTemporalFilter() {}
+  ~TEncTemporalFilter();
 
   void init(const Int frameSkip,
             const Int inputBitDepth[MAX_NUM_CHANNEL_TYPE],
@@ -128,6 +140,8 @@ public:
             const std::map<Int, Double> &temporalFilterStrengths,
             const Int pastRefs,
             const Int futureRefs,
+            const Int numThreads,
+            const Int lookahead,
             const Int firstValidFrame,
 #if !JVET_Y0077_BIM
             const Int lastValidFrame);
@@ -183,13 +197,27 @@ private:
   Int m_numCTU;
   std::map<Int, Int*> *m_ctuAdaptQP;
 #endif
+  Int m_numThreads;                                             ///< number of threads of the motion estimation and the filtering
+  TComTemporalFilterKernels m_kernels;                          ///< vector kernels of the motion search and the noise statistics
+  Int m_lookahead;                                              ///< number of frames the background thread may filter ahead of the input (0: no background thread)
+  std::thread m_lookaheadThread;
+  std::mutex m_lookaheadMutex;
+  std::condition_variable m_lookaheadCond;
+  std::map<Int, TemporalFilterResult> m_lookaheadResults;       ///< pictures filtered by the background thread, by received POC
+  Int m_lookaheadInputPoc;                                      ///< received POC of the latest input frame
+  Bool m_lookaheadStop;
 
   // Private functions
+  Bool isFilteredFrame(const Int receivedPoc) const;
+  Bool filterFrame(const TComPicYuv *orgPic, const Int receivedPoc, TemporalFilterResult &result);
+  Void lookaheadFrames();
   Void subsampleLuma(const TComPicYuv &input, TComPicYuv &output, const Int factor = 2) const;
   Int motionErrorLuma(const TComPicYuv &orig, const TComPicYuv &buffer, const Int x, const Int y, Int dx, Int dy, const Int bs, const Int besterror = 8 * 8 * 1024 * 1024) const;
+  Void motionEstimationBlock(Array2D<MotionVector> &mvs, const TComPicYuv &orig, const TComPicYuv &buffer, const Int bs,
+      const Array2D<MotionVector> *previous, const Int factor, const Bool doubleRes, const Int blockX, const Int blockY) const;
   Void motionEstimationLuma(Array2D<MotionVector> &mvs, const TComPicYuv &orig, const TComPicYuv &buffer, const Int bs,
-      const Array2D<MotionVector> *previous=0, const Int factor = 1, const Bool doubleRes = false) const;
-  Void motionEstimation(Array2D<MotionVector> &mvs, const TComPicYuv &orgPic, const TComPicYuv &buffer, const TComPicYuv &origSubsampled2, const TComPicYuv &origSubsampled4) const;
+      const Array2D<MotionVector> *previous=0, const Int factor = 1, const Bool doubleRes = false, const Int numThreads = 1) const;
+  Void motionEstimation(Array2D<MotionVector> &mvs, const TComPicYuv &orgPic, const TComPicYuv &buffer, const TComPicYuv &origSubsampled2, const TComPicYuv &origSubsampled4, const Int numThreads) const;
 
 #if JVET_V0056_MCTF
   Void bilateralFilter(const TComPicYuv &orgPic, std::deque<TemporalFilterSourcePicInfo> &srcFrameInfo, TComPicYuv &newOrgPic, Double overallStrength) const;
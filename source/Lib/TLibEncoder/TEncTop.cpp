@@ -108,6 +108,7 @@ Void TEncTop::create ()
 #endif
 
   m_cLoopFilter.create( m_maxTotalCUDepth );
+  m_cLookahead.create( m_lookaheadThreads, m_lookaheadDepth, m_bUseAdaptiveQP, m_lookaheadThreads > 0 || m_sceneCutDetection );
 
   if ( m_RCEnableRateControl )
   {
@@ -148,11 +149,25 @@ Void TEncTop::create ()
       m_pppcRDSbacCoder   [iDepth][iCIIdx]->init( m_pppcBinCoderCABAC [iDepth][iCIIdx] );
     }
   }
+
+  // with several wavefront or tile threads, every thread compresses CTUs with its own coding objects
+  const Int numCtuWorkers = std::max( m_entropyCodingSyncEnabledFlag ? m_numWaveFrontThreads : 1,
+                                      ( m_iNumColumnsMinus1 > 0 || m_iNumRowsMinus1 > 0 ) ? m_numTileThreads : 1 );
+  if ( numCtuWorkers > 1 )
+  {
+    m_ctuWorkers.resize( numCtuWorkers );
+    for ( std::size_t i = 0; i < m_ctuWorkers.size(); i++ )
+    {
+      m_ctuWorkers[i] = new TEncCtuWorker;
+      m_ctuWorkers[i]->create( m_maxTotalCUDepth, m_maxCUWidth, m_maxCUHeight, m_chromaFormatIDC );
+    }
+  }
 }
 
 Void TEncTop::destroy ()
 {
   // destroy processing unit classes
+  m_cLookahead.         destroy();
   m_cGOPEncoder.        destroy();
   m_cSliceEncoder.      destroy();
   m_cCuEncoder.         destroy();
@@ -161,6 +176,22 @@ Void TEncTop::destroy ()
   m_cLoopFilter.        destroy();
   m_cRateCtrl.          destroy();
   m_cSearch.            destroy();
+  m_cRoiMaskReader.     close();
+  for ( std::size_t i = 0; i < m_ctuWorkers.size(); i++ )
+  {
+    m_ctuWorkers[i]->destroy();
+    delete m_ctuWorkers[i];
+  }
+  m_ctuWorkers.clear();
+  for ( std::size_t i = 0; i < m_frameSliceEncoders.size(); i++ )
+  {
+    m_frameSliceEncoders[i]->destroy();
+    delete m_frameSliceEncoders[i];
+    m_frameWorkers[i]->destroy();
+    delete m_frameWorkers[i];
+  }
+  m_frameSliceEncoders.clear();
+  m_frameWorkers.clear();
   Int iDepth;
   for ( iDepth = 0; iDepth < m_maxTotalCUDepth+1; iDepth++ )
   {
@@ -213,6 +244,18 @@ Void TEncTop::init(Bool isFieldCoding)
     xInitScalingLists(sps0, pps1);
   }
 
+  if (getUseAdaptiveQP() && !m_roiMaskPath.empty())
+  {
+    // masks are consumed in coding order, so keep at least one GOP of decoded masks ahead of the encoder
+    if (!m_cRoiMaskReader.open( m_roiMaskPath, m_roiMaskFormat, getSourceWidth(), getSourceHeight(),
+                                getSourceWidth() - getSourcePadding(0), getSourceHeight() - getSourcePadding(1),
+                                sps0.getLog2MinCodingBlockSize(), m_FrameSkip, m_temporalSubsampleRatio, m_roiMaskInterval,
+                                m_framesToBeEncoded, 2 * m_iGOPSize ))
+    {
+      exit(EXIT_FAILURE);
+    }
+  }
+
   // initialize processing unit classes
   m_cGOPEncoder.  init( this );
   m_cSliceEncoder.init( this );
@@ -236,9 +279,73 @@ Void TEncTop::init(Bool isFieldCoding)
   // initialize encoder search class
   m_cSearch.init( this, &m_cTrQuant, m_iSearchRange, m_bipredSearchRange, m_motionEstimationSearchMethod, m_maxCUWidth, m_maxCUHeight, m_maxTotalCUDepth, &m_cEntropyCoder, &m_cRdCost, getRDSbacCoder(), getRDGoOnSbacCoder() );
 
+  for ( std::size_t i = 0; i < m_ctuWorkers.size(); i++ )
+  {
+    xInitCtuWorker( *m_ctuWorkers[i], sps0 );
+  }
+
   m_iMaxRefPicNum = 0;
 }
 
+Void TEncTop::xInitCtuWorker( TEncCtuWorker &worker, TComSPS &sps )
+{
+  worker.getRdCost()->setCostMode( m_costMode );
+
+  worker.getTrQuant()->init( 1 << m_uiQuadtreeTULog2MaxSize,
+                             m_useRDOQ,
+                             m_useRDOQTS,
+                             m_useSelectiveRDOQ,
+                             true
+                            ,m_useTransformSkipFast
+#if ADAPTIVE_QP_SELECTION
+                            ,m_bUseAdaptQpSelect
+#endif
+                            );
+
+  // same scaling lists as set up by xInitScalingLists
+  const Int maxLog2TrDynamicRange[MAX_NUM_CHANNEL_TYPE] =
+  {
+      sps.getMaxLog2TrDynamicRange(CHANNEL_TYPE_LUMA),
+      sps.getMaxLog2TrDynamicRange(CHANNEL_TYPE_CHROMA)
+  };
+  if ( getUseScalingListId() == SCALING_LIST_OFF )
+  {
+    worker.getTrQuant()->setFlatScalingList( maxLog2TrDynamicRange, sps.getBitDepths() );
+    worker.getTrQuant()->setUseScalingList( false );
+  }
+  else
+  {
+    worker.getTrQuant()->setScalingList( &(sps.getScalingList()), maxLog2TrDynamicRange, sps.getBitDepths() );
+    worker.getTrQuant()->setUseScalingList( true );
+  }
+
+  worker.getPredSearch()->init( this, worker.getTrQuant(), m_iSearchRange, m_bipredSearchRange, m_motionEstimationSearchMethod, m_maxCUWidth, m_maxCUHeight, m_maxTotalCUDepth,
+                                worker.getEntropyCoder(), worker.getRdCost(), worker.getRDSbacCoder(), worker.getRDGoOnSbacCoder() );
+
+  worker.getCuEncoder()->init( this, worker.getPredSearch(), worker.getTrQuant(), worker.getRdCost(),
+                               worker.getEntropyCoder(), worker.getRDSbacCoder(), worker.getRDGoOnSbacCoder() );
+  worker.getCuEncoder()->setSliceEncoder( &m_cSliceEncoder );
+}
+
+TEncSlice* TEncTop::getFrameSliceEncoder( UInt idx )
+{
+  while ( m_frameSliceEncoders.size() <= idx )
+  {
+    TEncCtuWorker *pcWorker = new TEncCtuWorker;
+    pcWorker->create( m_maxTotalCUDepth, m_maxCUWidth, m_maxCUHeight, m_chromaFormatIDC );
+    xInitCtuWorker( *pcWorker, *m_spsMap.getFirstPS() );
+
+    TEncSlice *pcSliceEncoder = new TEncSlice;
+    pcSliceEncoder->create( getSourceWidth(), getSourceHeight(), m_chromaFormatIDC, m_maxCUWidth, m_maxCUHeight, m_maxTotalCUDepth );
+    pcSliceEncoder->init( this, pcWorker );
+    pcWorker->getCuEncoder()->setSliceEncoder( pcSliceEncoder );
+
+    m_frameWorkers.push_back( pcWorker );
+    m_frameSliceEncoders.push_back( pcSliceEncoder );
+  }
+  return m_frameSliceEncoders[idx];
+}
+
 Void TEncTop::xInitScalingLists(TComSPS &sps, TComPPS &pps)
 {
   // Initialise scaling lists
@@ -367,10 +474,7 @@ Void TEncTop::encode( Bool flush, TComPicYuv* pcPicYuvOrg, TComPicYuv* pcPicYuvT
 #endif
 
     // compute image characteristics
-    if ( getUseAdaptiveQP() )
-    {
-      m_cPreanalyzer.xPreanalyze( dynamic_cast<TEncPic*>( pcPicCurr ) );
-    }
+    m_cLookahead.addPicture( dynamic_cast<TEncPic*>( pcPicCurr ) );
   }
 
   if ((m_iNumPicRcvd == 0) || (!flush && (m_iPOCLast != 0) && (m_iNumPicRcvd != m_iGOPSize) && (m_iGOPSize != 0)))
@@ -379,22 +483,120 @@ Void TEncTop::encode( Bool flush, TComPicYuv* pcPicYuvOrg, TComPicYuv* pcPicYuvT
     return;
   }
 
+  m_cLookahead.waitForPictures();
+
+  iNumEncoded = 0;
+  if ( m_sceneCutDetection )
+  {
+    // the pictures after a scene cut wait for the rest of their GOP, unless the encoder is flushed
+    Int sceneCutPOC = xFindSceneCut();
+    while ( sceneCutPOC >= 0 )
+    {
+      iNumEncoded += xCompressSceneCut( sceneCutPOC, flush ? m_iPOCLast - sceneCutPOC : 0, rcListPicYuvRecOut, accessUnitsOut, ipCSC, snrCSC );
+      sceneCutPOC  = flush ? xFindSceneCut() : -1;
+    }
+    if ( iNumEncoded > 0 && !flush )
+    {
+      return;
+    }
+  }
+
+  if ( m_iNumPicRcvd > 0 )
+  {
+    // compress GOP
+    xCompressGOP( m_iPOCLast, m_iNumPicRcvd, rcListPicYuvRecOut, accessUnitsOut, ipCSC, snrCSC );
+    iNumEncoded  += m_iNumPicRcvd;
+    m_iNumPicRcvd = 0;
+  }
+}
+
+Void TEncTop::xCompressGOP( Int iPOCLast, Int iNumPicRcvd, TComList<TComPicYuv*>& rcListPicYuvRecOut, std::list<AccessUnit>& accessUnitsOut, const InputColourSpaceConversion ipCSC, const InputColourSpaceConversion snrCSC )
+{
   if ( m_RCEnableRateControl )
   {
-    m_cRateCtrl.initRCGOP( m_iNumPicRcvd );
+    m_cRateCtrl.initRCGOP( iNumPicRcvd );
   }
 
-  // compress GOP
-  m_cGOPEncoder.compressGOP(m_iPOCLast, m_iNumPicRcvd, m_cListPic, rcListPicYuvRecOut, accessUnitsOut, false, false, ipCSC, snrCSC, getOutputLogControl());
+  m_cGOPEncoder.compressGOP(iPOCLast, iNumPicRcvd, m_cListPic, rcListPicYuvRecOut, accessUnitsOut, false, false, ipCSC, snrCSC, getOutputLogControl());
 
   if ( m_RCEnableRateControl )
   {
     m_cRateCtrl.destroyRCGOP();
   }
 
-  iNumEncoded         = m_iNumPicRcvd;
-  m_iNumPicRcvd       = 0;
-  m_uiNumAllPicCoded += iNumEncoded;
+  m_uiNumAllPicCoded += iNumPicRcvd;
+}
+
+/** Find the first received picture that starts a new scene.
+ * A picture is a scene cut when its inter SATD estimate from the lookahead is close to its intra SATD estimate,
+ * and it is far enough from the last IRAP picture.
+ * \returns the POC of the picture, or -1 if there is none
+ */
+Int TEncTop::xFindSceneCut()
+{
+  const Int intraPeriodStart = m_cGOPEncoder.getIntraPeriodStart();
+  const Int intraPeriod      = Int( m_uiIntraPeriod );
+
+  for ( Int poc = m_iPOCLast - m_iNumPicRcvd + 1; poc <= m_iPOCLast; poc++ )
+  {
+    Int lastIRAP = intraPeriodStart;
+    if ( intraPeriod > 0 && getDecodingRefreshType() != 3 )
+    {
+      lastIRAP += ( ( poc - intraPeriodStart ) / intraPeriod ) * intraPeriod;
+    }
+    if ( poc - lastIRAP < m_sceneCutMinDistance )
+    {
+      continue;
+    }
+
+    TComList<TComPic*>::iterator iterPic = m_cListPic.begin();
+    while ( iterPic != m_cListPic.end() && (*iterPic)->getPOC() != poc )
+    {
+      iterPic++;
+    }
+    assert( iterPic != m_cListPic.end() );
+
+    const TEncPicStatistics& statistics = dynamic_cast<TEncPic*>( *iterPic )->getStatistics();
+    if ( statistics.bValid && statistics.bInterSatdValid && statistics.intraSatd > 0
+      && Double( statistics.interSatd ) >= m_sceneCutThreshold * Double( statistics.intraSatd ) )
+    {
+      return poc;
+    }
+  }
+  return -1;
+}
+
+/** Compress the received pictures before a scene cut as a GOP of their own, then the scene cut as an IDR picture on its own.
+ * The intra periods and GOPs restart at the scene cut, as they do at POC 0.
+ * \param sceneCutPOC          POC of the scene cut
+ * \param numPicAfter          number of received pictures after the scene cut that are compressed in the same call of encode
+ * \retval rcListPicYuvRecOut  list of reconstruction YUV pictures, ending with numPicAfter pictures after the scene cut
+ * \retval accessUnitsOut      list of output access units
+ * \returns the number of compressed pictures
+ */
+Int TEncTop::xCompressSceneCut( Int sceneCutPOC, Int numPicAfter, TComList<TComPicYuv*>& rcListPicYuvRecOut, std::list<AccessUnit>& accessUnitsOut, const InputColourSpaceConversion ipCSC, const InputColourSpaceConversion snrCSC )
+{
+  const Int numPicBefore = m_iNumPicRcvd - ( m_iPOCLast - sceneCutPOC ) - 1;
+
+  // TEncGOP takes the reconstruction buffers of a GOP from the end of the list, and the application writes out the last ones
+  TComList<TComPicYuv*> cListPicYuvRec( rcListPicYuvRecOut );
+  for ( Int i = 0; i < numPicAfter; i++ )
+  {
+    cListPicYuvRec.pop_back();
+  }
+
+  if ( numPicBefore > 0 )
+  {
+    TComList<TComPicYuv*> cListPicYuvRecBefore( cListPicYuvRec );
+    cListPicYuvRecBefore.pop_back();
+    xCompressGOP( sceneCutPOC - 1, numPicBefore, cListPicYuvRecBefore, accessUnitsOut, ipCSC, snrCSC );
+  }
+
+  m_cGOPEncoder.setIntraPeriodStart( sceneCutPOC );
+  xCompressGOP( sceneCutPOC, 1, cListPicYuvRec, accessUnitsOut, ipCSC, snrCSC );
+
+  m_iNumPicRcvd -= numPicBefore + 1;
+  return numPicBefore + 1;
 }
 
 /**------------------------------------------------
@@ -480,14 +682,13 @@ Void TEncTop::encode(Bool flush, TComPicYuv* pcPicYuvOrg, TComPicYuv* pcPicYuvTr
       }
 
       // compute image characteristics
-      if ( getUseAdaptiveQP() )
-      {
-        m_cPreanalyzer.xPreanalyze( dynamic_cast<TEncPic*>( pcField ) );
-      }
+      m_cLookahead.addPicture( dynamic_cast<TEncPic*>( pcField ) );
     }
 
     if ( m_iNumPicRcvd && ((flush&&fieldNum==1) || (m_iPOCLast/2)==0 || m_iNumPicRcvd==m_iGOPSize ) )
     {
+      m_cLookahead.waitForPictures();
+
       // compress GOP
       m_cGOPEncoder.compressGOP(m_iPOCLast, m_iNumPicRcvd, m_cListPic, rcListPicYuvRecOut, accessUnitsOut, true, isTff, ipCSC, snrCSC, getOutputLogControl());
       iNumEncoded += m_iNumPicRcvd;
@@ -562,7 +763,7 @@ Void TEncTop::xGetNewPicBuffer ( TComPic*& rpcPic, Int ppsId )
 
   if (rpcPic==0)
   {
-    if ( getUseAdaptiveQP() )
+    if ( m_cLookahead.getAnalysePictures() )
     {
       TEncPic* pcEPic = new TEncPic;
 #if REDUCED_ENCODER_MEMORY
@@ -999,8 +1200,9 @@ Void TEncTop::xInitPPS(TComPPS &pps, const TComSPS &sps)
 
   if ( m_RCEnableRateControl )
   {
+    // ROI rate control offsets the QP of foreground CUs within the CTU
     pps.setUseDQP(true);
-    pps.setMaxCuDQPDepth( 0 );
+    pps.setMaxCuDQPDepth( getUseRoiRateCtrl() ? m_iMaxCuDQPDepth : 0 );
   }
   else if(bUseDQP)
   {
@@ -1300,7 +1502,7 @@ Void TEncTop::selectReferencePictureSet(TComSlice* slice, Int POCCurr, Int GOPid
   {
     if(m_uiIntraPeriod > 0 && getDecodingRefreshType() > 0)
     {
-      Int POCIndex = POCCurr%m_uiIntraPeriod;
+      Int POCIndex = (POCCurr - m_cGOPEncoder.getIntraPeriodStart())%m_uiIntraPeriod;
       if(POCIndex == 0)
       {
         POCIndex = m_uiIntraPeriod;
@@ -1312,7 +1514,7 @@ Void TEncTop::selectReferencePictureSet(TComSlice* slice, Int POCCurr, Int GOPid
     }
     else
     {
-      if(POCCurr==m_GOPList[extraNum].m_POC)
+      if(POCCurr - m_cGOPEncoder.getIntraPeriodStart()==m_GOPList[extraNum].m_POC)
       {
         slice->setRPSidx(extraNum);
       }
@@ -1336,7 +1538,7 @@ Int TEncTop::getReferencePictureSetIdxForSOP(Int POCCurr, Int GOPid )
   {
     if(m_uiIntraPeriod > 0 && getDecodingRefreshType() > 0)
     {
-      Int POCIndex = POCCurr%m_uiIntraPeriod;
+      Int POCIndex = (POCCurr - m_cGOPEncoder.getIntraPeriodStart())%m_uiIntraPeriod;
       if(POCIndex == 0)
       {
         POCIndex = m_uiIntraPeriod;
@@ -1348,7 +1550,7 @@ Int TEncTop::getReferencePictureSetIdxForSOP(Int POCCurr, Int GOPid )
     }
     else
     {
-      if(POCCurr==m_GOPList[extraNum].m_POC)
+      if(POCCurr - m_cGOPEncoder.getIntraPeriodStart()==m_GOPList[extraNum].m_POC)
       {
         rpsIdx = extraNum;
       }
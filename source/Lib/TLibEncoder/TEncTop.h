@@ -55,8 +55,10 @@
 #include "TEncSbac.h"
 #include "TEncSearch.h"
 #include "TEncSampleAdaptiveOffset.h"
-#include "TEncPreanalyzer.h"
+#include "TEncLookahead.h"
 #include "TEncRateCtrl.h"
+#include "TEncRoiMaskReader.h"
+#include "TEncCtuWorker.h"
 //! \ingroup TLibEncoder
 //! \{
 
@@ -107,9 +109,13 @@ private:
 #endif
 
   // quality control
-  TEncPreanalyzer         m_cPreanalyzer;                 ///< image characteristics analyzer for TM5-step3-like adaptive QP
+  TEncLookahead           m_cLookahead;                   ///< analysis of the received pictures: adaptive QP activities and picture statistics
 
   TEncRateCtrl            m_cRateCtrl;                    ///< Rate control class
+  TEncRoiMaskReader       m_cRoiMaskReader;               ///< ROI mask source for ROI-based QP selection
+  std::vector<TEncCtuWorker*> m_ctuWorkers;               ///< coding objects of the threads compressing CTU rows in parallel
+  std::vector<TEncSlice*>     m_frameSliceEncoders;       ///< slice encoders of the pictures compressed in parallel
+  std::vector<TEncCtuWorker*> m_frameWorkers;             ///< coding objects of the slice encoders of the pictures compressed in parallel
 
 protected:
   Void  xGetNewPicBuffer  ( TComPic*& rpcPic, Int ppsId ); ///< get picture buffer which will be processed. If ppsId<0, then the ppsMap will be queried for the first match.
@@ -121,6 +127,13 @@ protected:
 
   Void  xInitPPSforTiles  (TComPPS &pps);
   Void  xInitRPS          (TComSPS &sps, Bool isFieldCoding);           ///< initialize PPS from encoder options
+  Void  xInitCtuWorker    (TEncCtuWorker &worker, TComSPS &sps);      ///< initialize the coding objects of a CTU encoding thread like the ones of the encoder
+
+  Void  xCompressGOP      ( Int iPOCLast, Int iNumPicRcvd, TComList<TComPicYuv*>& rcListPicYuvRecOut, std::list<AccessUnit>& accessUnitsOut,
+                            const InputColourSpaceConversion ipCSC, const InputColourSpaceConversion snrCSC );
+  Int   xFindSceneCut     ();                              ///< POC of the first received picture at a scene cut, -1 if there is none
+  Int   xCompressSceneCut ( Int sceneCutPOC, Int numPicAfter, TComList<TComPicYuv*>& rcListPicYuvRecOut, std::list<AccessUnit>& accessUnitsOut,
+                            const InputColourSpaceConversion ipCSC, const InputColourSpaceConversion snrCSC );
 
 public:
   TEncTop();
@@ -153,6 +166,10 @@ public:
   TEncSbac***             getRDSbacCoder        () { return  m_pppcRDSbacCoder;       }
   TEncSbac*               getRDGoOnSbacCoder    () { return  &m_cRDGoOnSbacCoder;     }
   TEncRateCtrl*           getRateCtrl           () { return &m_cRateCtrl;             }
+  TEncRoiMaskReader*      getRoiMaskReader      () { return &m_cRoiMaskReader;        }
+  UInt                    getNumCtuWorkers      () const { return (UInt)m_ctuWorkers.size(); }
+  TEncCtuWorker*          getCtuWorker          ( UInt idx ) { return m_ctuWorkers[idx]; }
+  TEncSlice*              getFrameSliceEncoder  ( UInt idx ); ///< slice encoder of the idx-th picture compressed in parallel, created on first use
   Void selectReferencePictureSet(TComSlice* slice, Int POCCurr, Int GOPid );
   Int getReferencePictureSetIdxForSOP(Int POCCurr, Int GOPid );
 
@@ -198,6 +215,7 @@ public:
     outputLogCtrl.printSequenceMSE=m_printSequenceMSE;
     outputLogCtrl.printXPSNR=m_bXPSNREnableFlag;
     outputLogCtrl.printHexPerPOCPSNRs=m_printHexPsnr;
+    outputLogCtrl.printRoiStats=m_cRoiMaskReader.isOpen();
     return outputLogCtrl;
   }
 
@@ -39,6 +39,7 @@
 #include "../TLibCommon/TComSlice.h"
 #include "../TLibCommon/TComPic.h"
 #include "../TLibCommon/TComPicYuv.h"
+#include "TEncPic.h"
 #include "WeightPredAnalysis.h"
 #include <limits>
 
@@ -247,6 +248,8 @@ Void WeightPredAnalysis::xCalcACDCParamSlice(TComSlice *const slice)
 {
   //===== calculate AC/DC value =====
   TComPicYuv*   pPic = slice->getPic()->getPicYuvOrg();
+  const TEncPic* pcEncPic = dynamic_cast<const TEncPic*>(slice->getPic());
+  const Bool bAnalysed = pcEncPic != NULL && pcEncPic->getStatistics().bValid;   // sums computed by TEncLookahead
 
   WPACDCParam weightACDCParam[MAX_NUM_COMPONENT];
 
@@ -262,6 +265,14 @@ Void WeightPredAnalysis::xCalcACDCParamSlice(TComSlice *const slice)
 
     const Int sample = width*height;
 
+    if (bAnalysed)
+    {
+      const Int fixedBitShift = (slice->getSPS()->getSpsRangeExtension().getHighPrecisionOffsetsEnabledFlag())?RExt__PREDICTION_WEIGHTING_ANALYSIS_DC_PRECISION:0;
+      weightACDCParam[compID].iDC = (((pcEncPic->getStatistics().orgDC[compID]<<fixedBitShift)+(sample>>1)) / sample);
+      weightACDCParam[compID].iAC = pcEncPic->getStatistics().orgAC[compID];
+      continue;
+    }
+
     Int64 orgDC = 0;
     {
       const Pel *pPel = pPic->getAddr(compID);
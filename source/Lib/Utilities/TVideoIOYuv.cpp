@@ -116,8 +116,9 @@ copyPlane(const TComPicYuv &src, const ComponentID srcPlane, TComPicYuv &dest, c
  * \param fileBitDepth     bit-depth array of input/output file data.
  * \param MSBExtendedBitDepth
  * \param internalBitDepth bit-depth array to scale image data to/from when reading/writing.
+ * \param bUpdate          in write mode, write into the existing file instead of truncating it
  */
-Void TVideoIOYuv::open( const std::string &fileName, Bool bWriteMode, const Int fileBitDepth[MAX_NUM_CHANNEL_TYPE], const Int MSBExtendedBitDepth[MAX_NUM_CHANNEL_TYPE], const Int internalBitDepth[MAX_NUM_CHANNEL_TYPE] )
+Void TVideoIOYuv::open( const std::string &fileName, Bool bWriteMode, const Int fileBitDepth[MAX_NUM_CHANNEL_TYPE], const Int MSBExtendedBitDepth[MAX_NUM_CHANNEL_TYPE], const Int internalBitDepth[MAX_NUM_CHANNEL_TYPE], const Bool bUpdate )
 {
   //NOTE: files cannot have bit depth greater than 16
   for(UInt ch=0; ch<MAX_NUM_CHANNEL_TYPE; ch++)
@@ -142,7 +143,7 @@ Void TVideoIOYuv::open( const std::string &fileName, Bool bWriteMode, const Int
 
   if ( bWriteMode )
   {
-    m_cHandle.open( fileName.c_str(), ios::binary | ios::out );
+    m_cHandle.open( fileName.c_str(), bUpdate ? ios::binary | ios::in | ios::out : ios::binary | ios::out );
 
     if( m_cHandle.fail() )
     {
@@ -180,7 +181,7 @@ Bool TVideoIOYuv::isFail()
 }
 
 /**
- * Skip numFrames in input.
+ * Skip numFrames in input, or in a file opened for update.
  *
  * This function correctly handles cases where the input file is not
  * seekable, by consuming bytes.